@@ -41,27 +41,376 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <csignal>
 
 #include "DeckLinkAPI.h"
+#include "AVSync.h"
+#include "CEA708_Decoder.h"
 #include "Capture.h"
+#include "ClipIndex.h"
 #include "Config.h"
+#include "Deinterlacer.h"
+#include "LTC.h"
+#include "Stereo3D.h"
+#include "ThumbnailWriter.h"
 
 static pthread_mutex_t	g_sleepMutex;
 static pthread_cond_t	g_sleepCond;
 static int				g_videoOutputFile = -1;
 static int				g_audioOutputFile = -1;
+static int				g_indexOutputFile = -1;
 static bool				g_do_exit = false;
 
 static BMDConfig		g_config;
 
 static IDeckLinkInput*	g_deckLinkInput = NULL;
+static ThumbnailWriter*	g_thumbnailWriter = NULL;
 
 static unsigned long	g_frameCount = 0;
 
+// Clip index state, see ClipIndex.h
+static bool				g_indexHeaderWritten = false;
+static ClipIndexHeader	g_indexHeader;
+static uint64_t			g_videoFileOffset = 0;
+static uint64_t			g_audioSampleOffset = 0;
+static BMDDisplayMode	g_currentDisplayMode = bmdModeUnknown;
+static BMDTimeValue		g_currentFrameDuration = 0;
+static BMDTimeScale		g_currentTimeScale = 0;
+static BMDFieldDominance	g_currentFieldDominance = bmdUnknownFieldDominance;
+
+// Deinterlacer state, each input frame is held until the next frame arrives
+static Deinterlacer*		g_deinterlacer = NULL;
+static IDeckLinkVideoFrame*	g_previousFrame = NULL;
+static IDeckLinkVideoFrame*	g_heldFrame = NULL;
+static uint8_t*				g_deinterlacedFrame = NULL;
+
+// 3D packer state, the left and right eye frames are written as a single packed frame
+// The format of the last 3D frames is kept so that a format which can not be packed is reported once
+static Stereo3DPacker*		g_stereo3DPacker = NULL;
+static uint8_t*				g_packedFrame = NULL;
+static uint32_t				g_stereo3DWidth = 0;
+static uint32_t				g_stereo3DHeight = 0;
+static BMDPixelFormat		g_stereo3DPixelFormat = 0;
+
+// A/V sync analyzer of the flash and beep test signal, see AVSync.h
+static AVSyncAnalyzer*		g_avSyncAnalyzer = NULL;
+
+// LTC decoder of the LTC channel, see LTC.h
+static LTCDecoder*			g_ltcDecoder = NULL;
+
+// CEA-708 caption decoder of the ancillary caption distribution packets, see CEA708_Decoder.h
+// with an optional CEA-608 decoder of their compatibility bytes, see CEA608_Decoder.h
+static const uint8_t		kCaptionDistributionPacketDID = 0x61;
+static const uint8_t		kCaptionDistributionPacketSDID = 0x01;
+
+class CaptionPrinter : public CEA708::DecoderListener, public CEA608::DecoderListener
+{
+public:
+	void captionsChanged(uint8_t serviceNumber, const CEA708::ServiceDecoder& service) override;
+	void captionsChanged(CEA608::Channel channel, const CEA608::Decoder& decoder) override;
+};
+
+static CaptionPrinter		g_captionPrinter;
+static CEA708::Decoder*		g_captionDecoder = NULL;
+static CEA608::Decoder*		g_cea608Decoder = NULL;
+
+static void SetCurrentDisplayMode(IDeckLinkDisplayMode* displayMode)
+{
+	g_currentDisplayMode = displayMode->GetDisplayMode();
+	g_currentFieldDominance = displayMode->GetFieldDominance();
+	displayMode->GetFrameRate(&g_currentFrameDuration, &g_currentTimeScale);
+}
+
+static bool IsDeinterlacing(void)
+{
+	return (g_config.m_deinterlace != 0) &&
+		((g_currentFieldDominance == bmdLowerFieldFirst) || (g_currentFieldDominance == bmdUpperFieldFirst));
+}
+
+static void ReleaseDeinterlacedFrames(void)
+{
+	if (g_previousFrame != NULL)
+		g_previousFrame->Release();
+
+	if (g_heldFrame != NULL)
+		g_heldFrame->Release();
+
+	g_previousFrame = NULL;
+	g_heldFrame = NULL;
+}
+
+// Write the held frame deinterlaced, with nextFrame after it, then hold nextFrame.  Called with NULL at the
+// end of a sequence to write the last held frame.
+static void WriteDeinterlacedFrames(IDeckLinkVideoFrame* nextFrame)
+{
+	IDeckLinkVideoFrame*	currentFrame = g_heldFrame;
+	void*					previousBytes = NULL;
+	void*					currentBytes;
+	void*					nextBytes = NULL;
+	long					rowBytes;
+
+	if (nextFrame != NULL)
+		nextFrame->AddRef();
+
+	g_heldFrame = nextFrame;
+
+	if (currentFrame == NULL)
+		return;
+
+	rowBytes = currentFrame->GetRowBytes();
+
+	// A neighbouring frame of another format, at a format change, is replaced by the current frame
+	if ((g_previousFrame != NULL) && (g_previousFrame->GetRowBytes() == rowBytes) && (g_previousFrame->GetHeight() == currentFrame->GetHeight()) &&
+		(g_previousFrame->GetPixelFormat() == currentFrame->GetPixelFormat()))
+		g_previousFrame->GetBytes(&previousBytes);
+
+	if ((nextFrame != NULL) && (nextFrame->GetRowBytes() == rowBytes) && (nextFrame->GetHeight() == currentFrame->GetHeight()) &&
+		(nextFrame->GetPixelFormat() == currentFrame->GetPixelFormat()))
+		nextFrame->GetBytes(&nextBytes);
+
+	if ((g_deinterlacer == NULL) || (g_deinterlacer->GetWidth() != (uint32_t)currentFrame->GetWidth()) ||
+		(g_deinterlacer->GetHeight() != (uint32_t)currentFrame->GetHeight()) || (g_deinterlacer->GetPixelFormat() != currentFrame->GetPixelFormat()))
+	{
+		delete g_deinterlacer;
+		free(g_deinterlacedFrame);
+
+		g_deinterlacer = new Deinterlacer((uint32_t)currentFrame->GetWidth(), (uint32_t)currentFrame->GetHeight(), currentFrame->GetPixelFormat(),
+										  g_currentFieldDominance, (g_config.m_deinterlace == 2) ? kDeinterlacerDoubleRate : kDeinterlacerSingleRate);
+		g_deinterlacedFrame = (uint8_t*)malloc(rowBytes * currentFrame->GetHeight());
+	}
+
+	currentFrame->GetBytes(&currentBytes);
+
+	for (uint32_t outputIndex = 0; outputIndex < g_deinterlacer->GetOutputFrameCount(); outputIndex++)
+	{
+		if (g_deinterlacer->DeinterlaceFrame(previousBytes, currentBytes, nextBytes, rowBytes, outputIndex, g_deinterlacedFrame, rowBytes) != S_OK)
+		{
+			fprintf(stderr, "Could not deinterlace frame\n");
+			break;
+		}
+
+		write(g_videoOutputFile, g_deinterlacedFrame, rowBytes * currentFrame->GetHeight());
+		g_videoFileOffset += rowBytes * currentFrame->GetHeight();
+	}
+
+	if (g_previousFrame != NULL)
+		g_previousFrame->Release();
+
+	g_previousFrame = currentFrame;
+}
+
+// Returns the packer for frames of the format of the left eye frame, or NULL if they can not be packed
+static Stereo3DPacker* GetStereo3DPacker(IDeckLinkVideoFrame* videoFrame)
+{
+	const uint32_t			width = (uint32_t)videoFrame->GetWidth();
+	const uint32_t			height = (uint32_t)videoFrame->GetHeight();
+	const BMDPixelFormat	pixelFormat = videoFrame->GetPixelFormat();
+	const Stereo3DLayout	layout = (Stereo3DLayout)(g_config.m_pack3D - 1);
+
+	if ((g_stereo3DWidth == width) && (g_stereo3DHeight == height) && (g_stereo3DPixelFormat == pixelFormat))
+		return g_stereo3DPacker;
+
+	delete g_stereo3DPacker;
+	free(g_packedFrame);
+	g_stereo3DPacker = NULL;
+	g_packedFrame = NULL;
+	g_stereo3DWidth = width;
+	g_stereo3DHeight = height;
+	g_stereo3DPixelFormat = pixelFormat;
+
+	if (!Stereo3DPacker::IsSupported(width, height, pixelFormat, layout))
+	{
+		fprintf(stderr, "3D frames of this format can not be packed, they are written unpacked\n");
+		return NULL;
+	}
+
+	g_stereo3DPacker = new Stereo3DPacker(width, height, pixelFormat, layout);
+	g_packedFrame = (uint8_t*)malloc(videoFrame->GetRowBytes() * g_stereo3DPacker->GetPackedHeight());
+	return g_stereo3DPacker;
+}
+
+// Test the frame and its audio for the A/V sync test signal, and print the offset of each beep from its flash
+static void AnalyzeAVSync(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
+{
+	AVSyncMeasurement	measurement;
+	BMDTimeValue		frameTime;
+	BMDTimeValue		frameDuration;
+	BMDTimeValue		packetTime;
+	void*				audioFrameBytes;
+
+	if ((videoFrame != NULL) && !(videoFrame->GetFlags() & bmdFrameHasNoInputSource) &&
+		(videoFrame->GetStreamTime(&frameTime, &frameDuration, g_currentTimeScale) == S_OK))
+		g_avSyncAnalyzer->AnalyzeVideoFrame(videoFrame, frameTime, g_currentTimeScale);
+
+	// Packet times in samples are sample accurate
+	if ((audioFrame != NULL) && (audioFrame->GetBytes(&audioFrameBytes) == S_OK) &&
+		(audioFrame->GetPacketTime(&packetTime, kAVSyncSampleRate) == S_OK))
+		g_avSyncAnalyzer->AnalyzeAudioSamples(audioFrameBytes, (uint32_t)audioFrame->GetSampleFrameCount(), packetTime);
+
+	while (g_avSyncAnalyzer->GetMeasurement(measurement))
+		printf("A/V sync: audio %s by %.3f ms at %.3f s\n", (measurement.offset < 0.0) ? "leads" : "lags", fabs(measurement.offset), measurement.videoTime);
+}
+
+// Decode LTC from the audio, and print each timecode with the phase of its word against the video frames
+static void DecodeLTC(IDeckLinkAudioInputPacket* audioFrame)
+{
+	LTCFrame		frame;
+	BMDTimeValue	packetTime;
+	void*			audioFrameBytes;
+
+	if ((audioFrame == NULL) || (audioFrame->GetBytes(&audioFrameBytes) != S_OK) ||
+		(audioFrame->GetPacketTime(&packetTime, bmdAudioSampleRate48kHz) != S_OK))
+		return;
+
+	g_ltcDecoder->Decode(audioFrameBytes, (uint32_t)audioFrame->GetSampleFrameCount(), packetTime);
+
+	while (g_ltcDecoder->GetFrame(frame))
+	{
+		// Phase of the start of the word from the nearest frame start, in frames
+		double	frames	= (frame.startTime / bmdAudioSampleRate48kHz) * g_currentTimeScale / g_currentFrameDuration;
+
+		printf("LTC %02u:%02u:%02u%c%02u at %.3f s, %+.3f frames from the video frame\n", frame.timecode.hours, frame.timecode.minutes,
+			   frame.timecode.seconds, frame.timecode.dropFrame ? ';' : ':', frame.timecode.frames,
+			   frame.startTime / bmdAudioSampleRate48kHz, frames - floor(frames + 0.5));
+	}
+}
+
+// Print the text of the visible windows of the caption service
+void CaptionPrinter::captionsChanged(uint8_t serviceNumber, const CEA708::ServiceDecoder& service)
+{
+	char	text[CEA708::DecodedWindow::kMaxColumns * 3 + 1];
+	bool	visible = false;
+
+	printf("Captions service %u (#%lu):\n", serviceNumber, g_frameCount);
+
+	for (uint8_t windowID = 0; windowID < 8; windowID++)
+	{
+		const CEA708::DecodedWindow& window = service.window(windowID);
+
+		if (!window.defined || !window.visible)
+			continue;
+
+		for (uint8_t row = 0; row < window.rowCount; row++)
+		{
+			if (service.rowText(windowID, row, text, sizeof(text)) > 0)
+				printf("  %u.%u: %s\n", windowID, row, text);
+		}
+		visible = true;
+	}
+
+	if (!visible)
+		printf("  No captions displayed\n");
+}
+
+// Print the rows of the displayed memory of the CEA-608 channel
+void CaptionPrinter::captionsChanged(CEA608::Channel channel, const CEA608::Decoder& decoder)
+{
+	char	text[CEA608::Decoder::kColumns * 3 + 1];
+	bool	visible = false;
+
+	printf("Captions CC%u (#%lu):\n", channel + 1, g_frameCount);
+
+	for (uint8_t row = 0; row < CEA608::Decoder::kRows; row++)
+	{
+		if (decoder.rowText(row, text, sizeof(text)) > 0)
+		{
+			printf("  %u: %s\n", row + 1, text);
+			visible = true;
+		}
+	}
+
+	if (!visible)
+		printf("  No captions displayed\n");
+}
+
+// Decode the caption distribution packet of the frame, the decoder prints the captions when they change
+static void DecodeCaptions(IDeckLinkVideoInputFrame* videoFrame)
+{
+	IDeckLinkVideoFrameAncillaryPackets*	ancillaryPackets = NULL;
+	IDeckLinkAncillaryPacket*				packet = NULL;
+	const void*								data;
+	uint32_t								size;
+
+	if (videoFrame->QueryInterface(IID_IDeckLinkVideoFrameAncillaryPackets, (void**)&ancillaryPackets) != S_OK)
+		return;
+
+	if (ancillaryPackets->GetFirstPacketByID(kCaptionDistributionPacketDID, kCaptionDistributionPacketSDID, &packet) == S_OK)
+	{
+		if (packet->GetBytes(bmdAncillaryPacketFormatUInt8, &data, &size) == S_OK)
+			g_captionDecoder->decode((const uint8_t*)data, size);
+
+		packet->Release();
+	}
+
+	ancillaryPackets->Release();
+}
+
+static void WriteClipIndexEntry(IDeckLinkVideoInputFrame* videoFrame, bool hasRightEye, const Stereo3DPacker* packer, uint64_t audioSampleOffset, uint32_t audioSampleCount)
+{
+	static const uint32_t kPackedFlags[] = { kClipIndexFlagSideBySide3D, kClipIndexFlagTopBottom3D, kClipIndexFlagFramePacked3D };
+
+	ClipIndexEntry	entry;
+	BMDTimeValue	frameTime = 0;
+	BMDTimeValue	frameDuration;
+	uint32_t		height = (packer != NULL) ? packer->GetPackedHeight() : (uint32_t)videoFrame->GetHeight();
+
+	if (!g_indexHeaderWritten)
+	{
+		memset(&g_indexHeader, 0, sizeof(g_indexHeader));
+		memcpy(g_indexHeader.magic, CLIP_INDEX_MAGIC, sizeof(g_indexHeader.magic));
+		g_indexHeader.version			= CLIP_INDEX_VERSION;
+		g_indexHeader.flags				= (packer != NULL) ? kPackedFlags[packer->GetLayout()] : hasRightEye ? kClipIndexFlagDualStream3D : 0;
+		g_indexHeader.displayMode		= g_currentDisplayMode;
+		g_indexHeader.pixelFormat		= videoFrame->GetPixelFormat();
+		g_indexHeader.width				= (uint32_t)videoFrame->GetWidth();
+		g_indexHeader.height			= height;
+		g_indexHeader.rowBytes			= (uint32_t)videoFrame->GetRowBytes();
+		g_indexHeader.audioChannels		= (g_audioOutputFile != -1) ? g_config.m_audioChannels : 0;
+		g_indexHeader.audioSampleDepth	= g_config.m_audioSampleDepth;
+		g_indexHeader.frameDuration		= g_currentFrameDuration;
+		g_indexHeader.timeScale			= g_currentTimeScale;
+
+		if (write(g_indexOutputFile, &g_indexHeader, sizeof(g_indexHeader)) != sizeof(g_indexHeader))
+		{
+			fprintf(stderr, "Could not write clip index header, indexing disabled\n");
+			close(g_indexOutputFile);
+			g_indexOutputFile = -1;
+			return;
+		}
+		g_indexHeaderWritten = true;
+	}
+	else if ((g_indexHeader.displayMode != (uint32_t)g_currentDisplayMode) ||
+			 (g_indexHeader.pixelFormat != (uint32_t)videoFrame->GetPixelFormat()) ||
+			 (g_indexHeader.rowBytes != (uint32_t)videoFrame->GetRowBytes()) ||
+			 (g_indexHeader.height != height))
+	{
+		// A clip index describes frames of a single format only
+		fprintf(stderr, "Video format changed during capture, clip index is incomplete\n");
+		close(g_indexOutputFile);
+		g_indexOutputFile = -1;
+		return;
+	}
+
+	videoFrame->GetStreamTime(&frameTime, &frameDuration, g_indexHeader.timeScale);
+
+	memset(&entry, 0, sizeof(entry));
+	entry.videoOffset		= g_videoFileOffset;
+	entry.audioSampleOffset	= audioSampleOffset;
+	entry.audioSampleCount	= audioSampleCount;
+	entry.streamTime		= frameTime;
+
+	if (write(g_indexOutputFile, &entry, sizeof(entry)) != sizeof(entry))
+	{
+		fprintf(stderr, "Could not write clip index entry, indexing disabled\n");
+		close(g_indexOutputFile);
+		g_indexOutputFile = -1;
+	}
+}
+
 DeckLinkCaptureDelegate::DeckLinkCaptureDelegate() : 
 	m_refCount(1),
 	m_pixelFormat(g_config.m_pixelFormat)
@@ -90,6 +439,11 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
 	IDeckLinkVideoFrame3DExtensions*	threeDExtensions = NULL;
 	void*								frameBytes;
 	void*								audioFrameBytes;
+	uint64_t							audioSampleOffset = g_audioSampleOffset;
+	uint32_t							audioSampleCount = 0;
+
+	if (audioFrame && g_audioOutputFile != -1)
+		audioSampleCount = (uint32_t)audioFrame->GetSampleFrameCount();
 
 	// Handle Video Frame
 	if (videoFrame)
@@ -130,15 +484,60 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
 			if (timecodeString)
 				free((void*)timecodeString);
 
+			// Thumbnails are downscaled here, so the frame is not held for the JPEG worker thread
+			if (g_thumbnailWriter != NULL && (g_frameCount % g_config.m_thumbnailInterval) == 0)
+				g_thumbnailWriter->SubmitFrame(videoFrame, g_frameCount);
+
+			if (g_captionDecoder != NULL)
+				DecodeCaptions(videoFrame);
+
 			if (g_videoOutputFile != -1)
 			{
-				videoFrame->GetBytes(&frameBytes);
-				write(g_videoOutputFile, frameBytes, videoFrame->GetRowBytes() * videoFrame->GetHeight());
+				Stereo3DPacker* packer = NULL;
+
+				if ((rightEyeFrame != NULL) && (g_config.m_pack3D != 0))
+					packer = GetStereo3DPacker(videoFrame);
+
+				if (g_indexOutputFile != -1)
+					WriteClipIndexEntry(videoFrame, rightEyeFrame != NULL, packer, audioSampleOffset, audioSampleCount);
+
+				if (IsDeinterlacing())
+				{
+					// Output is one frame behind input, the held frame is written when its next frame arrives
+					WriteDeinterlacedFrames(videoFrame);
+				}
+				else
+				{
+					// Write any frame held before a change to a progressive mode
+					WriteDeinterlacedFrames(NULL);
+					ReleaseDeinterlacedFrames();
+
+					videoFrame->GetBytes(&frameBytes);
+					if (packer != NULL)
+					{
+						void*	rightEyeBytes;
+						long	rowBytes = videoFrame->GetRowBytes();
+
+						// Both eyes are written as one frame of the packed height
+						rightEyeFrame->GetBytes(&rightEyeBytes);
+						if (packer->PackFrame(frameBytes, rightEyeBytes, rowBytes, g_packedFrame, rowBytes) != S_OK)
+							fprintf(stderr, "Could not pack 3D frame\n");
+
+						write(g_videoOutputFile, g_packedFrame, rowBytes * packer->GetPackedHeight());
+						g_videoFileOffset += rowBytes * packer->GetPackedHeight();
+					}
+					else
+					{
+						write(g_videoOutputFile, frameBytes, videoFrame->GetRowBytes() * videoFrame->GetHeight());
+						g_videoFileOffset += videoFrame->GetRowBytes() * videoFrame->GetHeight();
+					}
+				}
 
-				if (rightEyeFrame)
+				if (rightEyeFrame && (packer == NULL))
 				{
 					rightEyeFrame->GetBytes(&frameBytes);
 					write(g_videoOutputFile, frameBytes, videoFrame->GetRowBytes() * videoFrame->GetHeight());
+					g_videoFileOffset += videoFrame->GetRowBytes() * videoFrame->GetHeight();
 				}
 			}
 		}
@@ -149,6 +548,12 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
 		g_frameCount++;
 	}
 
+	if (g_avSyncAnalyzer != NULL)
+		AnalyzeAVSync(videoFrame, audioFrame);
+
+	if (g_ltcDecoder != NULL)
+		DecodeLTC(audioFrame);
+
 	// Handle Audio Frame
 	if (audioFrame)
 	{
@@ -156,6 +561,7 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
 		{
 			audioFrame->GetBytes(&audioFrameBytes);
 			write(g_audioOutputFile, audioFrameBytes, audioFrame->GetSampleFrameCount() * g_config.m_audioChannels * (g_config.m_audioSampleDepth / 8));
+			g_audioSampleOffset += audioSampleCount;
 		}
 	}
 
@@ -200,6 +606,11 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFormatChanged(BMDVideoInputFormatChan
 		{
 			g_deckLinkInput->StopStreams();
 
+			// The held frame is written before frames of the new format
+			if (g_videoOutputFile != -1)
+				WriteDeinterlacedFrames(NULL);
+			ReleaseDeinterlacedFrames();
+
 			result = g_deckLinkInput->EnableVideoInput(mode->GetDisplayMode(), pixelFormat, g_config.m_inputFlags);
 			if (result != S_OK)
 			{
@@ -211,6 +622,7 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFormatChanged(BMDVideoInputFormatChan
 		}
 
 		m_pixelFormat = pixelFormat;
+		SetCurrentDisplayMode(mode);
 	}
 
 bail:
@@ -345,6 +757,8 @@ int main(int argc, char *argv[])
 	delegate = new DeckLinkCaptureDelegate();
 	g_deckLinkInput->SetCallback(delegate);
 
+	SetCurrentDisplayMode(displayMode);
+
 	// Open output files
 	if (g_config.m_videoOutputFile != NULL)
 	{
@@ -366,6 +780,35 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (g_config.m_indexOutputFile != NULL)
+	{
+		g_indexOutputFile = open(g_config.m_indexOutputFile, O_WRONLY|O_CREAT|O_TRUNC, 0664);
+		if (g_indexOutputFile < 0)
+		{
+			fprintf(stderr, "Could not open clip index file \"%s\"\n", g_config.m_indexOutputFile);
+			goto bail;
+		}
+	}
+
+	if (g_config.m_thumbnailPrefix != NULL || g_config.m_thumbnailSlot != NULL)
+	{
+		g_thumbnailWriter = new ThumbnailWriter(g_config.m_thumbnailWidth, g_config.m_thumbnailQuality);
+		if (!g_thumbnailWriter->Start(g_config.m_thumbnailPrefix, g_config.m_thumbnailSlot))
+			goto bail;
+	}
+
+	if (g_config.m_avSyncChannel != 0)
+		g_avSyncAnalyzer = new AVSyncAnalyzer(g_config.m_audioChannels, g_config.m_audioSampleDepth, g_config.m_avSyncChannel - 1);
+
+	if (g_config.m_ltcChannel != 0)
+		g_ltcDecoder = new LTCDecoder(g_config.m_audioChannels, g_config.m_audioSampleDepth, g_config.m_ltcChannel - 1);
+
+	if (g_config.m_captionChannel != 0)
+		g_cea608Decoder = new CEA608::Decoder(&g_captionPrinter, (CEA608::Channel)(g_config.m_captionChannel - 1));
+
+	if (g_config.m_captionService != 0 || g_cea608Decoder != NULL)
+		g_captionDecoder = new CEA708::Decoder(&g_captionPrinter, (g_config.m_captionService != 0) ? 1ULL << g_config.m_captionService : 0, g_cea608Decoder);
+
 	// Block main thread until signal occurs
 	while (!g_do_exit)
 	{
@@ -396,15 +839,57 @@ int main(int argc, char *argv[])
 		g_deckLinkInput->StopStreams();
 		g_deckLinkInput->DisableAudioInput();
 		g_deckLinkInput->DisableVideoInput();
+
+		if (g_videoOutputFile != -1)
+			WriteDeinterlacedFrames(NULL);
+		ReleaseDeinterlacedFrames();
 	}
 
 bail:
+	ReleaseDeinterlacedFrames();
+
+	if (g_deinterlacer != NULL)
+		delete g_deinterlacer;
+
+	if (g_deinterlacedFrame != NULL)
+		free(g_deinterlacedFrame);
+
+	if (g_stereo3DPacker != NULL)
+		delete g_stereo3DPacker;
+
+	if (g_packedFrame != NULL)
+		free(g_packedFrame);
+
+	if (g_avSyncAnalyzer != NULL)
+		delete g_avSyncAnalyzer;
+
+	if (g_ltcDecoder != NULL)
+		delete g_ltcDecoder;
+
+	if (g_captionDecoder != NULL)
+		delete g_captionDecoder;
+
+	if (g_cea608Decoder != NULL)
+		delete g_cea608Decoder;
+
 	if (g_videoOutputFile != 0)
 		close(g_videoOutputFile);
 
 	if (g_audioOutputFile != 0)
 		close(g_audioOutputFile);
 
+	if (g_indexOutputFile > 0)
+		close(g_indexOutputFile);
+
+	if (g_thumbnailWriter != NULL)
+	{
+		g_thumbnailWriter->Stop();
+		fprintf(stderr, "Wrote %lu thumbnails\n", g_thumbnailWriter->GetWrittenCount());
+
+		delete g_thumbnailWriter;
+		g_thumbnailWriter = NULL;
+	}
+
 	if (displayModeName != NULL)
 		free(displayModeName);
 
@@ -0,0 +1,94 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#ifndef __CLIP_INDEX_H__
+#define __CLIP_INDEX_H__
+
+#include <stdint.h>
+
+/* A clip index is a sidecar file written alongside a raw video capture.  It allows
+ * a player to seek directly to any captured frame (and its audio) without reading
+ * the preceding frames.
+ *
+ * The file consists of a single ClipIndexHeader followed by one ClipIndexEntry per
+ * frame written to the raw video file.  All fields are stored in host byte order. */
+
+#define CLIP_INDEX_MAGIC		"BMDCLIDX"
+#define CLIP_INDEX_VERSION		1
+
+enum ClipIndexFlags
+{
+	kClipIndexFlagDualStream3D	= 1 << 0,	// Each video frame is followed by its right eye frame
+	kClipIndexFlagSideBySide3D	= 1 << 1,	// Each video frame holds both eyes side-by-side, see Stereo3D.h
+	kClipIndexFlagTopBottom3D	= 1 << 2,	// Each video frame holds both eyes top-bottom
+	kClipIndexFlagFramePacked3D	= 1 << 3	// Each video frame holds both eyes frame packed, height is of the packed frame
+};
+
+#pragma pack(push, 1)
+
+struct ClipIndexHeader
+{
+	char		magic[8];				// CLIP_INDEX_MAGIC
+	uint32_t	version;				// CLIP_INDEX_VERSION
+	uint32_t	flags;					// ClipIndexFlags
+	uint32_t	displayMode;			// BMDDisplayMode of the captured frames
+	uint32_t	pixelFormat;			// BMDPixelFormat of the captured frames
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	rowBytes;
+	uint32_t	audioChannels;			// 0 if no audio file was captured
+	uint32_t	audioSampleDepth;		// bits per sample, 16 or 32
+	uint32_t	reserved;
+	int64_t		frameDuration;
+	int64_t		timeScale;
+};
+
+struct ClipIndexEntry
+{
+	uint64_t	videoOffset;			// Byte offset of the frame in the raw video file
+	uint64_t	audioSampleOffset;		// Sample frame offset of the audio delivered with this frame
+	uint32_t	audioSampleCount;		// Number of audio sample frames delivered with this frame
+	uint32_t	reserved;
+	int64_t		streamTime;				// Input stream time of the frame, in header timeScale units
+};
+
+#pragma pack(pop)
+
+#endif
@@ -42,6 +42,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <pthread.h>
+#include <strings.h>
 #include <unistd.h>
 #include "Config.h"
 
@@ -56,6 +57,18 @@ BMDConfig::BMDConfig() :
 	m_timecodeFormat(),
 	m_videoOutputFile(),
 	m_audioOutputFile(),
+	m_indexOutputFile(),
+	m_thumbnailPrefix(),
+	m_thumbnailSlot(),
+	m_thumbnailInterval(25),
+	m_thumbnailWidth(320),
+	m_thumbnailQuality(75),
+	m_deinterlace(0),
+	m_pack3D(0),
+	m_avSyncChannel(0),
+	m_ltcChannel(0),
+	m_captionService(0),
+	m_captionChannel(0),
 	m_deckLinkName(),
 	m_displayModeName()
 {
@@ -75,7 +88,7 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 	int		ch;
 	bool	displayHelp = false;
 
-	while ((ch = getopt(argc, argv, "d:?h3c:s:v:a:m:n:p:t:")) != -1)
+	while ((ch = getopt(argc, argv, "d:?h3c:s:v:a:x:m:n:p:t:j:k:i:w:q:D:P:S:L:C:")) != -1)
 	{
 		switch (ch)
 		{
@@ -115,14 +128,109 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 				m_audioOutputFile = optarg;
 				break;
 
+			case 'x':
+				m_indexOutputFile = optarg;
+				break;
+
 			case 'n':
 				m_maxFrames = atoi(optarg);
 				break;
 
+			case 'j':
+				m_thumbnailPrefix = optarg;
+				break;
+
+			case 'k':
+				m_thumbnailSlot = optarg;
+				break;
+
+			case 'i':
+				m_thumbnailInterval = atoi(optarg);
+				if (m_thumbnailInterval < 1)
+				{
+					fprintf(stderr, "Invalid argument: Thumbnail interval must be at least 1 frame\n");
+					return false;
+				}
+				break;
+
+			case 'w':
+				m_thumbnailWidth = atoi(optarg);
+				if (m_thumbnailWidth < 16 || m_thumbnailWidth > 1920)
+				{
+					fprintf(stderr, "Invalid argument: Thumbnail width must be between 16 and 1920\n");
+					return false;
+				}
+				break;
+
+			case 'q':
+				m_thumbnailQuality = atoi(optarg);
+				if (m_thumbnailQuality < 1 || m_thumbnailQuality > 100)
+				{
+					fprintf(stderr, "Invalid argument: Thumbnail quality must be between 1 and 100\n");
+					return false;
+				}
+				break;
+
 			case '3':
 				m_inputFlags |= bmdVideoInputDualStream3D;
 				break;
 
+			case 'D':
+				m_deinterlace = atoi(optarg);
+				if (m_deinterlace < 0 || m_deinterlace > 2)
+				{
+					fprintf(stderr, "Invalid argument: Deinterlace mode must be 0, 1 or 2\n");
+					return false;
+				}
+				break;
+
+			case 'P':
+				m_pack3D = atoi(optarg);
+				if (m_pack3D < 0 || m_pack3D > 3)
+				{
+					fprintf(stderr, "Invalid argument: 3D packing must be 0, 1, 2 or 3\n");
+					return false;
+				}
+				break;
+
+			case 'S':
+				m_avSyncChannel = atoi(optarg);
+				if (m_avSyncChannel < 1)
+				{
+					fprintf(stderr, "Invalid argument: A/V sync beep channel must be 1 or more\n");
+					return false;
+				}
+				break;
+
+			case 'L':
+				m_ltcChannel = atoi(optarg);
+				if (m_ltcChannel < 1)
+				{
+					fprintf(stderr, "Invalid argument: LTC channel must be 1 or more\n");
+					return false;
+				}
+				break;
+
+			case 'C':
+				// CC1-CC4 selects a CEA-608 channel, otherwise a CEA-708 service
+				if (strncasecmp(optarg, "CC", 2) == 0)
+				{
+					m_captionChannel = atoi(optarg + 2);
+					if (m_captionChannel < 1 || m_captionChannel > 4)
+					{
+						fprintf(stderr, "Invalid argument: Caption channel must be CC1 to CC4\n");
+						return false;
+					}
+					break;
+				}
+				m_captionService = atoi(optarg);
+				if (m_captionService < 1 || m_captionService > 6)
+				{
+					fprintf(stderr, "Invalid argument: Caption service must be 1 to 6\n");
+					return false;
+				}
+				break;
+
 			case 'p':
 				switch(atoi(optarg))
 				{
@@ -167,6 +275,48 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 		DisplayUsage(1);
 	}
 
+	if (m_indexOutputFile != NULL && m_videoOutputFile == NULL)
+	{
+		fprintf(stderr, "A clip index can only be written with a video output file\n");
+		DisplayUsage(1);
+	}
+
+	if (m_thumbnailPrefix != NULL && m_thumbnailSlot != NULL)
+	{
+		fprintf(stderr, "Thumbnails can be written to files or a shared memory slot, not both\n");
+		DisplayUsage(1);
+	}
+
+	if (m_deinterlace != 0 && m_indexOutputFile != NULL)
+	{
+		fprintf(stderr, "A clip index can not be written with deinterlaced video\n");
+		DisplayUsage(1);
+	}
+
+	if (m_deinterlace != 0 && ((m_inputFlags & bmdVideoInputDualStream3D) || m_pixelFormat == bmdFormat10BitRGB))
+	{
+		fprintf(stderr, "Deinterlacing requires 2D capture in a YUV pixel format\n");
+		DisplayUsage(1);
+	}
+
+	if (m_pack3D != 0 && !(m_inputFlags & bmdVideoInputDualStream3D))
+	{
+		fprintf(stderr, "3D packing requires stereoscopic 3D capture\n");
+		DisplayUsage(1);
+	}
+
+	if (m_avSyncChannel > m_audioChannels)
+	{
+		fprintf(stderr, "The A/V sync beep channel must be one of the captured audio channels\n");
+		DisplayUsage(1);
+	}
+
+	if (m_ltcChannel > m_audioChannels)
+	{
+		fprintf(stderr, "The LTC channel must be one of the captured audio channels\n");
+		DisplayUsage(1);
+	}
+
 	if (displayHelp)
 		DisplayUsage(0);
 
@@ -444,15 +594,62 @@ bail:
 		"         serial: Serial Timecode\n"
 		"    -v <filename>        Filename raw video will be written to\n"
 		"    -a <filename>        Filename raw audio will be written to\n"
+		"    -x <filename>        Filename clip index will be written to (for use with PlaybackClip)\n"
 		"    -c <channels>        Audio Channels (2, 8 or 16 - default is 2)\n"
 		"    -s <depth>           Audio Sample Depth (16 or 32 - default is 16)\n"
 		"    -n <frames>          Number of frames to capture (default is unlimited)\n"
 		"    -3                   Capture Stereoscopic 3D (Requires 3D Hardware support)\n"
+		"    -j <prefix>          Write JPEG thumbnails to files named <prefix><frame number>.jpg (YUV only)\n"
+		"    -k <name>            Write the latest JPEG thumbnail to shared memory slot <name>, eg /capture0\n"
+		"    -i <interval>        Thumbnail every <interval> frames (default is 25)\n"
+		"    -w <width>           Thumbnail width in pixels (default is 320)\n"
+		"    -q <quality>         Thumbnail JPEG quality 1-100 (default is 75)\n"
+		"    -D <mode>            Deinterlace interlaced video written to the video file (YUV only)\n"
+		"         0:  Off (default)\n"
+		"         1:  Single rate, one frame per input frame\n"
+		"         2:  Double rate, one frame per field\n"
+		"    -P <layout>          Pack the left and right eyes into one frame written to the video file (requires -3)\n"
+		"         0:  Off, the right eye frame follows the left (default)\n"
+		"         1:  Side-by-side, half horizontal resolution\n"
+		"         2:  Top-bottom, half vertical resolution\n"
+		"         3:  Frame packed, full resolution with active space between the eyes\n"
+		"    -S <channel>         Measure the A/V offset of the A/V sync test signal of TestPattern -S, with the beep on <channel>\n"
+		"    -L <channel>         Decode LTC on audio <channel>, and print each timecode and its phase against the video frames\n"
+		"    -C <service>         Decode CEA-708 caption <service> 1-6 from the caption distribution packets, and print each change\n"
+		"                         or CEA-608 channel CC1-CC4 from their compatibility bytes, -C may be given for both\n"
 		"\n"
 		"Capture video and/or audio to a file. Raw video and/or audio can be viewed with mplayer eg:\n"
 		"\n"
 		"    Capture -d 0 -m 2 -n 50 -v video.raw -a audio.raw\n"
 		"    mplayer video.raw -demuxer rawvideo -rawvideo pal:uyvy -audiofile audio.raw -audio-demuxer 20 -rawaudio rate=48000\n"
+		"\n"
+		"Capture with a clip index for variable-speed playback with PlaybackClip eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -v video.raw -a audio.raw -x video.idx\n"
+		"\n"
+		"Capture JPEG thumbnails once per second of 25 fps input for a monitoring wall eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -p 1 -j thumbs/input0_ -i 25 -w 320\n"
+		"\n"
+		"Capture interlaced input as progressive video, one frame per field eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -p 1 -D 2 -v video.raw\n"
+		"\n"
+		"Capture stereoscopic 3D input as a single side-by-side stream eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -p 1 -3 -P 1 -v video.raw -x video.idx\n"
+		"\n"
+		"Measure lip-sync through a chain, of a flash and a beep on audio channel 1 output by TestPattern -S eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -S 1\n"
+		"\n"
+		"Decode LTC on audio channel 8, output by TestPattern -l 8 eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -c 8 -L 8\n"
+		"\n"
+		"Decode the primary caption service, output by ClosedCaptions eg:\n"
+		"\n"
+		"    Capture -d 0 -m 2 -C 1 -C CC1\n"
 	);
 
 	if (deckLinkIterator != NULL)
@@ -480,13 +677,23 @@ void BMDConfig::DisplayConfiguration()
 		" - Video mode: %s %s\n"
 		" - Pixel format: %s\n"
 		" - Audio channels: %u\n"
-		" - Audio sample depth: %u bit \n",
+		" - Audio sample depth: %u bit \n"
+		" - Deinterlace: %s\n"
+		" - 3D packing: %s\n"
+		" - A/V sync analysis: %s\n"
+		" - LTC decoding: %s\n"
+		" - Caption decoding: %s\n",
 		m_deckLinkName,
 		m_displayModeName,
 		(m_inputFlags & bmdVideoInputDualStream3D) ? "3D" : "",
 		GetPixelFormatName(m_pixelFormat),
 		m_audioChannels,
-		m_audioSampleDepth
+		m_audioSampleDepth,
+		(m_deinterlace == 2) ? "double rate" : (m_deinterlace == 1) ? "single rate" : "off",
+		(m_pack3D == 3) ? "frame packed" : (m_pack3D == 2) ? "top-bottom" : (m_pack3D == 1) ? "side-by-side" : "off",
+		(m_avSyncChannel != 0) ? "on" : "off",
+		(m_ltcChannel != 0) ? "on" : "off",
+		(m_captionService != 0 || m_captionChannel != 0) ? "on" : "off"
 	);
 }
 
@@ -67,6 +67,20 @@ public:
 
 	const char*				m_videoOutputFile;
 	const char*				m_audioOutputFile;
+	const char*				m_indexOutputFile;
+
+	const char*				m_thumbnailPrefix;
+	const char*				m_thumbnailSlot;
+	int						m_thumbnailInterval;
+	int						m_thumbnailWidth;
+	int						m_thumbnailQuality;
+
+	int						m_deinterlace;		// 0 off, 1 single rate, 2 double rate
+	int						m_pack3D;			// 0 off, 1 side-by-side, 2 top-bottom, 3 frame packed
+	int						m_avSyncChannel;	// Audio channel of the beep of the A/V sync test signal from 1, 0 off
+	int						m_ltcChannel;		// Audio channel of LTC from 1, 0 off
+	int						m_captionService;	// CEA-708 caption service 1-6, 0 off
+	int						m_captionChannel;	// CEA-608 caption channel CC1-CC4 as 1-4, 0 off
 
 	IDeckLink* GetSelectedDeckLink(void);
 	IDeckLinkDisplayMode* GetSelectedDeckLinkDisplayMode(IDeckLink* deckLink);
@@ -0,0 +1,75 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#ifndef __THUMBNAIL_SLOT_H__
+#define __THUMBNAIL_SLOT_H__
+
+#include <stdint.h>
+
+/* A thumbnail slot is a POSIX shared memory object holding the most recent JPEG
+ * thumbnail of a capture, for monitoring applications that poll rather than watch
+ * for files.
+ *
+ * The object consists of a ThumbnailSlotHeader followed by capacity bytes of JPEG
+ * data.  The writer increments sequence before and after updating the slot, so the
+ * value is odd while an update is in progress.  A reader copies the JPEG data, then
+ * checks that sequence was even and unchanged across the copy, otherwise it retries.
+ * All fields are stored in host byte order. */
+
+#define THUMBNAIL_SLOT_MAGIC		"BMDTHUMB"
+#define THUMBNAIL_SLOT_VERSION		1
+
+#pragma pack(push, 1)
+
+struct ThumbnailSlotHeader
+{
+	char		magic[8];				// THUMBNAIL_SLOT_MAGIC
+	uint32_t	version;				// THUMBNAIL_SLOT_VERSION
+	uint32_t	capacity;				// Size of the JPEG data area following the header
+	uint32_t	sequence;				// Odd while the writer is updating the slot
+	uint32_t	jpegSize;				// Size of the current JPEG image
+	uint32_t	width;
+	uint32_t	height;
+	uint64_t	frameNumber;			// Capture frame number of the thumbnail
+};
+
+#pragma pack(pop)
+
+#endif
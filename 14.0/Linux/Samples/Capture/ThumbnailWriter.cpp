@@ -0,0 +1,623 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <jpeglib.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define TARGET_SSE2	__attribute__((target("sse2")))
+#endif
+
+#include "ThumbnailWriter.h"
+
+// Accumulators are 16-bit, which holds the sum of 64 10-bit samples
+static const uint32_t	kMaxBoxHeight		= 64;
+static const int		kScaleShift			= 24;
+
+// v210 packs 6 pixels in 4 words {Cb0 Y0 Cr0} {Y1 Cb1 Y2} {Cr1 Y3 Cb2} {Y4 Cr2 Y5}.  Each block is accumulated as
+// 12 samples, the low 10 bits of each word, then the middle, then the high.  These tables give the position in the
+// accumulated block of each luma sample, and of each chroma sample in Cb0 Cr0 Cb1 Cr1 Cb2 Cr2 order.
+static const uint32_t	kV210LumaOrder[6]	= { 4, 1, 9, 6, 3, 11 };
+static const uint32_t	kV210ChromaOrder[6]	= { 0, 8, 5, 2, 10, 7 };
+
+struct JPEGErrorManager
+{
+	struct jpeg_error_mgr	errorManager;
+	jmp_buf					jumpBuffer;
+};
+
+static void JPEGErrorExit(j_common_ptr cinfo)
+{
+	JPEGErrorManager* errorManager = (JPEGErrorManager*)cinfo->err;
+
+	(*cinfo->err->output_message)(cinfo);
+	longjmp(errorManager->jumpBuffer, 1);
+}
+
+static inline uint8_t ClampToByte(int64_t value)
+{
+	return (uint8_t)((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Add a row of 2vuy to the accumulator, in byte order
+TARGET_SSE2 static void AccumulateRow2vuy(const uint8_t* source, uint16_t* accumulator, uint32_t byteCount)
+{
+	const __m128i	zero	= _mm_setzero_si128();
+	uint32_t		i		= 0;
+
+	for (; i + 16 <= byteCount; i += 16)
+	{
+		__m128i bytes	= _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i lo		= _mm_loadu_si128((const __m128i*)(accumulator + i));
+		__m128i hi		= _mm_loadu_si128((const __m128i*)(accumulator + i + 8));
+
+		_mm_storeu_si128((__m128i*)(accumulator + i), _mm_add_epi16(lo, _mm_unpacklo_epi8(bytes, zero)));
+		_mm_storeu_si128((__m128i*)(accumulator + i + 8), _mm_add_epi16(hi, _mm_unpackhi_epi8(bytes, zero)));
+	}
+
+	for (; i < byteCount; i++)
+		accumulator[i] += source[i];
+}
+
+// Add a row of v210 to the accumulator, 12 samples per 4 word block in the order described above
+TARGET_SSE2 static void AccumulateRowV210(const uint32_t* source, uint16_t* accumulator, uint32_t blockCount)
+{
+	const __m128i	mask10	= _mm_set1_epi32(0x3FF);
+
+	for (uint32_t i = 0; i < blockCount; i++)
+	{
+		__m128i words	= _mm_loadu_si128((const __m128i*)(source + i * 4));
+		__m128i a		= _mm_and_si128(words, mask10);
+		__m128i b		= _mm_and_si128(_mm_srli_epi32(words, 10), mask10);
+		__m128i c		= _mm_and_si128(_mm_srli_epi32(words, 20), mask10);
+		__m128i ab		= _mm_packs_epi32(a, b);
+		__m128i cc		= _mm_packs_epi32(c, c);
+		uint16_t* sums	= accumulator + i * 12;
+
+		_mm_storeu_si128((__m128i*)sums, _mm_add_epi16(_mm_loadu_si128((const __m128i*)sums), ab));
+		_mm_storel_epi64((__m128i*)(sums + 8), _mm_add_epi16(_mm_loadl_epi64((const __m128i*)(sums + 8)), cc));
+	}
+}
+
+#else
+
+// Add a row of 2vuy to the accumulator, in byte order
+static void AccumulateRow2vuy(const uint8_t* source, uint16_t* accumulator, uint32_t byteCount)
+{
+	for (uint32_t i = 0; i < byteCount; i++)
+		accumulator[i] += source[i];
+}
+
+// Add a row of v210 to the accumulator, 12 samples per 4 word block in the order described above
+static void AccumulateRowV210(const uint32_t* source, uint16_t* accumulator, uint32_t blockCount)
+{
+	for (uint32_t i = 0; i < blockCount; i++)
+	{
+		uint16_t* sums = accumulator + i * 12;
+
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			const uint32_t word = source[i * 4 + j];
+
+			sums[j]		+= word & 0x3FF;
+			sums[j + 4]	+= (word >> 10) & 0x3FF;
+			sums[j + 8]	+= (word >> 20) & 0x3FF;
+		}
+	}
+}
+
+#endif
+
+ThumbnailWriter::ThumbnailWriter(uint32_t thumbnailWidth, int quality) :
+	m_thumbnailWidth(thumbnailWidth & ~1),
+	m_quality(quality),
+	m_filenamePrefix(NULL),
+	m_slot(NULL),
+	m_slotSize(0),
+	m_sourcePixelFormat(0),
+	m_sourceWidth(0),
+	m_sourceHeight(0),
+	m_boxWidth(1),
+	m_boxHeight(1),
+	m_lumaScale(0),
+	m_chromaScale(0),
+	m_lumaBlackSum(0),
+	m_chromaZeroSum(0),
+	m_fillIndex(0),
+	m_pendingIndex(1),
+	m_encodeIndex(2),
+	m_pendingValid(false),
+	m_stopWorker(false),
+	m_workerRunning(false),
+	m_reportedUnsupported(false),
+	m_writtenCount(0),
+	m_replacedCount(0)
+{
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_condition, NULL);
+}
+
+ThumbnailWriter::~ThumbnailWriter()
+{
+	Stop();
+
+	if (m_slot != NULL)
+		munmap(m_slot, m_slotSize);
+
+	pthread_cond_destroy(&m_condition);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+bool ThumbnailWriter::Start(const char* filenamePrefix, const char* slotName)
+{
+	if (filenamePrefix == NULL)
+	{
+		int fd = shm_open(slotName, O_RDWR | O_CREAT, 0664);
+		if (fd < 0)
+		{
+			fprintf(stderr, "Could not open thumbnail shared memory slot \"%s\"\n", slotName);
+			return false;
+		}
+
+		// Sized for the worst case JPEG of a square thumbnail, wider aspect ratios are smaller
+		m_slotSize = sizeof(ThumbnailSlotHeader) + (size_t)m_thumbnailWidth * m_thumbnailWidth * 2 + 65536;
+
+		if (ftruncate(fd, m_slotSize) == 0)
+			m_slot = (ThumbnailSlotHeader*)mmap(NULL, m_slotSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		close(fd);
+
+		if ((m_slot == NULL) || (m_slot == MAP_FAILED))
+		{
+			m_slot = NULL;
+			fprintf(stderr, "Could not map thumbnail shared memory slot \"%s\"\n", slotName);
+			return false;
+		}
+
+		memset(m_slot, 0, sizeof(ThumbnailSlotHeader));
+		memcpy(m_slot->magic, THUMBNAIL_SLOT_MAGIC, sizeof(m_slot->magic));
+		m_slot->version		= THUMBNAIL_SLOT_VERSION;
+		m_slot->capacity	= (uint32_t)(m_slotSize - sizeof(ThumbnailSlotHeader));
+	}
+
+	m_filenamePrefix = filenamePrefix;
+	m_stopWorker = false;
+
+	if (pthread_create(&m_workerThread, NULL, WorkerThreadFunc, this) != 0)
+	{
+		fprintf(stderr, "Could not start thumbnail worker thread\n");
+		return false;
+	}
+
+	m_workerRunning = true;
+	return true;
+}
+
+void ThumbnailWriter::Stop()
+{
+	if (!m_workerRunning)
+		return;
+
+	pthread_mutex_lock(&m_mutex);
+	m_stopWorker = true;
+	pthread_cond_signal(&m_condition);
+	pthread_mutex_unlock(&m_mutex);
+
+	pthread_join(m_workerThread, NULL);
+	m_workerRunning = false;
+}
+
+bool ThumbnailWriter::IsPixelFormatSupported(BMDPixelFormat pixelFormat)
+{
+	return (pixelFormat == bmdFormat8BitYUV) || (pixelFormat == bmdFormat10BitYUV);
+}
+
+bool ThumbnailWriter::SubmitFrame(IDeckLinkVideoFrame* videoFrame, uint64_t frameNumber)
+{
+	void*	frameBytes;
+
+	if (!IsPixelFormatSupported(videoFrame->GetPixelFormat()))
+	{
+		if (!m_reportedUnsupported)
+			fprintf(stderr, "Thumbnails require 8 or 10 bit YUV capture, thumbnails disabled\n");
+
+		m_reportedUnsupported = true;
+		return false;
+	}
+
+	if (videoFrame->GetBytes(&frameBytes) != S_OK)
+		return false;
+
+	if ((videoFrame->GetPixelFormat() != m_sourcePixelFormat) ||
+		((uint32_t)videoFrame->GetWidth() != m_sourceWidth) ||
+		((uint32_t)videoFrame->GetHeight() != m_sourceHeight))
+		ConfigureGeometry(videoFrame);
+
+	m_images[m_fillIndex].frameNumber = frameNumber;
+	DownscaleFrame((const uint8_t*)frameBytes, videoFrame->GetRowBytes(), m_images[m_fillIndex]);
+
+	// Hand the thumbnail to the worker, replacing any thumbnail it has not yet started on
+	pthread_mutex_lock(&m_mutex);
+
+	if (m_pendingValid)
+		m_replacedCount++;
+
+	int filledIndex = m_fillIndex;
+	m_fillIndex = m_pendingIndex;
+	m_pendingIndex = filledIndex;
+	m_pendingValid = true;
+
+	pthread_cond_signal(&m_condition);
+	pthread_mutex_unlock(&m_mutex);
+
+	return true;
+}
+
+void ThumbnailWriter::ConfigureGeometry(IDeckLinkVideoFrame* videoFrame)
+{
+	const BMDPixelFormat	pixelFormat		= videoFrame->GetPixelFormat();
+	const uint32_t			sourceWidth		= (uint32_t)videoFrame->GetWidth();
+	const uint32_t			sourceHeight	= (uint32_t)videoFrame->GetHeight();
+	const int				levelShift		= (pixelFormat == bmdFormat10BitYUV) ? 2 : 0;
+	uint32_t				width			= std::min(m_thumbnailWidth, sourceWidth & ~1);
+	uint32_t				height			= (uint32_t)(((uint64_t)width * sourceHeight / sourceWidth + 1) & ~1);
+	uint32_t				boxArea;
+
+	if (height < 2)
+		height = 2;
+
+	m_sourcePixelFormat	= pixelFormat;
+	m_sourceWidth		= sourceWidth;
+	m_sourceHeight		= sourceHeight;
+	m_boxWidth			= std::max(1u, sourceWidth / width);
+	m_boxHeight			= std::min(kMaxBoxHeight, std::max(1u, sourceHeight / height));
+
+	// Scale the box sums from video levels to the full range levels of JFIF
+	boxArea				= m_boxWidth * m_boxHeight;
+	m_lumaBlackSum		= (int32_t)((16 << levelShift) * boxArea);
+	m_chromaZeroSum		= (int32_t)((128 << levelShift) * boxArea);
+	m_lumaScale			= (((int64_t)255 << kScaleShift) + (219 << levelShift) * boxArea / 2) / ((int64_t)(219 << levelShift) * boxArea);
+	m_chromaScale		= (((int64_t)255 << kScaleShift) + (224 << levelShift) * boxArea / 2) / ((int64_t)(224 << levelShift) * boxArea);
+
+	m_sourceRows.resize(height);
+	for (uint32_t y = 0; y < height; y++)
+		m_sourceRows[y] = (uint32_t)((uint64_t)y * sourceHeight / height);
+
+	// Accumulator sample order differs between 2vuy and v210, so the horizontal box filter gathers
+	// its inputs through a table of accumulator indices for each output sample
+	m_lumaTaps.resize(width * m_boxWidth);
+	m_cbTaps.resize(width / 2 * m_boxWidth);
+	m_crTaps.resize(width / 2 * m_boxWidth);
+
+	for (uint32_t x = 0; x < width; x++)
+	{
+		uint32_t sourceX = (uint32_t)((uint64_t)x * sourceWidth / width);
+
+		for (uint32_t i = 0; i < m_boxWidth; i++)
+		{
+			uint32_t luma = sourceX + i;
+
+			m_lumaTaps[x * m_boxWidth + i] = (pixelFormat == bmdFormat10BitYUV) ?
+				(luma / 6) * 12 + kV210LumaOrder[luma % 6] :
+				luma * 2 + 1;
+		}
+	}
+
+	for (uint32_t x = 0; x < width / 2; x++)
+	{
+		uint32_t sourceChroma = (uint32_t)((uint64_t)x * 2 * sourceWidth / width) / 2;
+
+		for (uint32_t i = 0; i < m_boxWidth; i++)
+		{
+			// Chroma samples interleaved as Cb0 Cr0 Cb1 Cr1...
+			uint32_t cb = (sourceChroma + i) * 2;
+			uint32_t cr = cb + 1;
+
+			if (pixelFormat == bmdFormat10BitYUV)
+			{
+				m_cbTaps[x * m_boxWidth + i] = (cb / 6) * 12 + kV210ChromaOrder[cb % 6];
+				m_crTaps[x * m_boxWidth + i] = (cr / 6) * 12 + kV210ChromaOrder[cr % 6];
+			}
+			else
+			{
+				m_cbTaps[x * m_boxWidth + i] = cb * 2;
+				m_crTaps[x * m_boxWidth + i] = cr * 2;
+			}
+		}
+	}
+
+	m_accumulator.resize((pixelFormat == bmdFormat10BitYUV) ? ((sourceWidth + 5) / 6) * 12 : sourceWidth * 2);
+
+	fprintf(stderr, "Thumbnails %u x %u from %u x %u\n", width, height, sourceWidth, sourceHeight);
+}
+
+void ThumbnailWriter::DownscaleFrame(const uint8_t* frameBytes, long rowBytes, ThumbnailImage& image)
+{
+	const uint32_t	width			= (uint32_t)(m_lumaTaps.size() / m_boxWidth);
+	const uint32_t	height			= (uint32_t)m_sourceRows.size();
+	const uint32_t	chromaStride	= ((width + 15) & ~15) / 2;
+	const uint32_t	boxWidth		= m_boxWidth;
+	const uint16_t*	accumulator		= m_accumulator.data();
+
+	image.width			= width;
+	image.height		= height;
+	image.lumaStride	= chromaStride * 2;
+	image.paddedHeight	= (height + 7) & ~7;
+	image.luma.resize(image.lumaStride * image.paddedHeight);
+	image.cb.resize(chromaStride * image.paddedHeight);
+	image.cr.resize(chromaStride * image.paddedHeight);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		uint8_t*	luma	= &image.luma[y * image.lumaStride];
+		uint8_t*	cb		= &image.cb[y * chromaStride];
+		uint8_t*	cr		= &image.cr[y * chromaStride];
+
+		// Vertical box filter over the full source row width
+		memset(m_accumulator.data(), 0, m_accumulator.size() * sizeof(uint16_t));
+
+		for (uint32_t row = m_sourceRows[y]; row < m_sourceRows[y] + m_boxHeight; row++)
+		{
+			const uint8_t* source = frameBytes + row * rowBytes;
+
+			if (m_sourcePixelFormat == bmdFormat10BitYUV)
+				AccumulateRowV210((const uint32_t*)source, m_accumulator.data(), (uint32_t)(m_accumulator.size() / 12));
+			else
+				AccumulateRow2vuy(source, m_accumulator.data(), (uint32_t)m_accumulator.size());
+		}
+
+		// Horizontal box filter at thumbnail resolution
+		for (uint32_t x = 0; x < width; x++)
+		{
+			const uint32_t*	taps	= &m_lumaTaps[x * boxWidth];
+			int32_t			sum		= 0;
+
+			for (uint32_t i = 0; i < boxWidth; i++)
+				sum += accumulator[taps[i]];
+
+			luma[x] = ClampToByte(((sum - m_lumaBlackSum) * m_lumaScale + (1 << (kScaleShift - 1))) >> kScaleShift);
+		}
+
+		for (uint32_t x = 0; x < width / 2; x++)
+		{
+			const uint32_t*	cbTaps	= &m_cbTaps[x * boxWidth];
+			const uint32_t*	crTaps	= &m_crTaps[x * boxWidth];
+			int32_t			cbSum	= 0;
+			int32_t			crSum	= 0;
+
+			for (uint32_t i = 0; i < boxWidth; i++)
+			{
+				cbSum += accumulator[cbTaps[i]];
+				crSum += accumulator[crTaps[i]];
+			}
+
+			cb[x] = ClampToByte(128 + (((cbSum - m_chromaZeroSum) * m_chromaScale + (1 << (kScaleShift - 1))) >> kScaleShift));
+			cr[x] = ClampToByte(128 + (((crSum - m_chromaZeroSum) * m_chromaScale + (1 << (kScaleShift - 1))) >> kScaleShift));
+		}
+
+		// Replicate the last column into the MCU padding
+		memset(luma + width, luma[width - 1], image.lumaStride - width);
+		memset(cb + width / 2, cb[width / 2 - 1], chromaStride - width / 2);
+		memset(cr + width / 2, cr[width / 2 - 1], chromaStride - width / 2);
+	}
+
+	// Replicate the last row into the MCU padding
+	for (uint32_t y = height; y < image.paddedHeight; y++)
+	{
+		memcpy(&image.luma[y * image.lumaStride], &image.luma[(height - 1) * image.lumaStride], image.lumaStride);
+		memcpy(&image.cb[y * chromaStride], &image.cb[(height - 1) * chromaStride], chromaStride);
+		memcpy(&image.cr[y * chromaStride], &image.cr[(height - 1) * chromaStride], chromaStride);
+	}
+}
+
+bool ThumbnailWriter::CompressImage(const ThumbnailImage& image, unsigned char** jpegData, unsigned long* jpegSize)
+{
+	struct jpeg_compress_struct	cinfo;
+	JPEGErrorManager			errorManager;
+	JSAMPROW					lumaRows[DCTSIZE];
+	JSAMPROW					cbRows[DCTSIZE];
+	JSAMPROW					crRows[DCTSIZE];
+	JSAMPARRAY					planes[3]		= { lumaRows, cbRows, crRows };
+	const uint32_t				chromaStride	= image.lumaStride / 2;
+
+	*jpegData = NULL;
+	*jpegSize = 0;
+
+	cinfo.err = jpeg_std_error(&errorManager.errorManager);
+	errorManager.errorManager.error_exit = JPEGErrorExit;
+
+	if (setjmp(errorManager.jumpBuffer))
+	{
+		jpeg_destroy_compress(&cinfo);
+		free(*jpegData);
+		*jpegData = NULL;
+		return false;
+	}
+
+	jpeg_create_compress(&cinfo);
+	jpeg_mem_dest(&cinfo, jpegData, jpegSize);
+
+	cinfo.image_width		= image.width;
+	cinfo.image_height		= image.height;
+	cinfo.input_components	= 3;
+	cinfo.in_color_space	= JCS_YCbCr;
+
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, m_quality, TRUE);
+
+	// Planes are already 4:2:2 YCbCr, write them without colour conversion or downsampling
+	cinfo.raw_data_in					= TRUE;
+	cinfo.dct_method					= JDCT_IFAST;
+	cinfo.comp_info[0].h_samp_factor	= 2;
+	cinfo.comp_info[0].v_samp_factor	= 1;
+	cinfo.comp_info[1].h_samp_factor	= 1;
+	cinfo.comp_info[1].v_samp_factor	= 1;
+	cinfo.comp_info[2].h_samp_factor	= 1;
+	cinfo.comp_info[2].v_samp_factor	= 1;
+
+	jpeg_start_compress(&cinfo, TRUE);
+
+	while (cinfo.next_scanline < cinfo.image_height)
+	{
+		for (int i = 0; i < DCTSIZE; i++)
+		{
+			uint32_t row = cinfo.next_scanline + i;
+
+			lumaRows[i]	= (JSAMPROW)&image.luma[row * image.lumaStride];
+			cbRows[i]	= (JSAMPROW)&image.cb[row * chromaStride];
+			crRows[i]	= (JSAMPROW)&image.cr[row * chromaStride];
+		}
+
+		jpeg_write_raw_data(&cinfo, planes, DCTSIZE);
+	}
+
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	return true;
+}
+
+bool ThumbnailWriter::WriteThumbnail(const ThumbnailImage& image, const unsigned char* jpegData, unsigned long jpegSize)
+{
+	if (m_filenamePrefix != NULL)
+	{
+		char	filename[1024];
+		char	tempFilename[1040];
+		FILE*	file;
+		bool	result;
+
+		// Write to a temporary name then rename, so that a watcher never reads a partial file
+		snprintf(filename, sizeof(filename), "%s%06llu.jpg", m_filenamePrefix, (unsigned long long)image.frameNumber);
+		snprintf(tempFilename, sizeof(tempFilename), "%s.tmp", filename);
+
+		file = fopen(tempFilename, "wb");
+		if (file == NULL)
+		{
+			fprintf(stderr, "Could not open thumbnail file \"%s\"\n", tempFilename);
+			return false;
+		}
+
+		result = (fwrite(jpegData, 1, jpegSize, file) == jpegSize);
+
+		if (fclose(file) != 0)
+			result = false;
+
+		if (result)
+			result = (rename(tempFilename, filename) == 0);
+		else
+			unlink(tempFilename);
+
+		return result;
+	}
+
+	if (jpegSize > m_slot->capacity)
+	{
+		fprintf(stderr, "Thumbnail of %lu bytes exceeds shared memory slot capacity\n", jpegSize);
+		return false;
+	}
+
+	// Sequence is odd while the slot is updated, see ThumbnailSlot.h
+	uint32_t sequence = __atomic_load_n(&m_slot->sequence, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&m_slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	memcpy(m_slot + 1, jpegData, jpegSize);
+	m_slot->jpegSize	= (uint32_t)jpegSize;
+	m_slot->width		= image.width;
+	m_slot->height		= image.height;
+	m_slot->frameNumber	= image.frameNumber;
+
+	__atomic_store_n(&m_slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+void* ThumbnailWriter::WorkerThreadFunc(void* arg)
+{
+	((ThumbnailWriter*)arg)->WorkerThread();
+	return NULL;
+}
+
+void ThumbnailWriter::WorkerThread()
+{
+	while (true)
+	{
+		unsigned char*	jpegData;
+		unsigned long	jpegSize;
+
+		pthread_mutex_lock(&m_mutex);
+
+		while (!m_pendingValid && !m_stopWorker)
+			pthread_cond_wait(&m_condition, &m_mutex);
+
+		if (!m_pendingValid)
+		{
+			pthread_mutex_unlock(&m_mutex);
+			break;
+		}
+
+		int pendingIndex = m_pendingIndex;
+		m_pendingIndex = m_encodeIndex;
+		m_encodeIndex = pendingIndex;
+		m_pendingValid = false;
+
+		pthread_mutex_unlock(&m_mutex);
+
+		const ThumbnailImage& image = m_images[m_encodeIndex];
+
+		if (CompressImage(image, &jpegData, &jpegSize))
+		{
+			if (WriteThumbnail(image, jpegData, jpegSize))
+				m_writtenCount++;
+
+			free(jpegData);
+		}
+	}
+}
@@ -0,0 +1,143 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#ifndef __THUMBNAIL_WRITER_H__
+#define __THUMBNAIL_WRITER_H__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "ThumbnailSlot.h"
+
+/* ThumbnailWriter produces a low resolution JPEG stream from captured frames.
+ *
+ * SubmitFrame() is called from the capture callback.  It box filters an 8-bit (2vuy)
+ * or 10-bit (v210) YUV frame straight into 8-bit 4:2:2 YCbCr planes, so the capture
+ * buffer is not held after the callback returns.  A worker thread compresses the planes
+ * with libjpeg raw data input, which skips colour conversion and chroma downsampling,
+ * and writes each thumbnail to a file or a shared memory slot (see ThumbnailSlot.h).
+ *
+ * The planes are triple buffered.  If the worker is still compressing when a new
+ * thumbnail is submitted, a thumbnail that is waiting to be compressed is replaced
+ * by the new one, so the capture callback never blocks. */
+
+class ThumbnailWriter
+{
+public:
+	ThumbnailWriter(uint32_t thumbnailWidth, int quality);
+	virtual ~ThumbnailWriter();
+
+	// Start the worker writing files named <filenamePrefix><frame number>.jpg, or to the
+	// shared memory object slotName if filenamePrefix is NULL
+	bool					Start(const char* filenamePrefix, const char* slotName);
+	void					Stop(void);
+
+	static bool				IsPixelFormatSupported(BMDPixelFormat pixelFormat);
+
+	// Downscale a frame into the next thumbnail, returns false if the pixel format is not supported
+	bool					SubmitFrame(IDeckLinkVideoFrame* videoFrame, uint64_t frameNumber);
+
+	unsigned long			GetWrittenCount(void) const { return m_writtenCount; }
+	unsigned long			GetReplacedCount(void) const { return m_replacedCount; }
+
+private:
+	struct ThumbnailImage
+	{
+		uint32_t				width;
+		uint32_t				height;
+		uint32_t				lumaStride;			// Padded to whole 16x8 JPEG MCUs
+		uint32_t				paddedHeight;
+		uint64_t				frameNumber;
+		std::vector<uint8_t>	luma;
+		std::vector<uint8_t>	cb;
+		std::vector<uint8_t>	cr;
+	};
+
+	uint32_t				m_thumbnailWidth;
+	int						m_quality;
+
+	// Output
+	const char*				m_filenamePrefix;
+	ThumbnailSlotHeader*	m_slot;
+	size_t					m_slotSize;
+
+	// Downscale geometry, recalculated when the source format changes
+	BMDPixelFormat			m_sourcePixelFormat;
+	uint32_t				m_sourceWidth;
+	uint32_t				m_sourceHeight;
+	uint32_t				m_boxWidth;
+	uint32_t				m_boxHeight;
+	int64_t					m_lumaScale;			// Fixed point video to full range scale, including 1/box area
+	int64_t					m_chromaScale;
+	int32_t					m_lumaBlackSum;			// Box sum of black and zero chroma levels
+	int32_t					m_chromaZeroSum;
+	std::vector<uint32_t>	m_sourceRows;			// First source row of each thumbnail row
+	std::vector<uint32_t>	m_lumaTaps;				// Accumulator indices summed for each thumbnail pixel
+	std::vector<uint32_t>	m_cbTaps;
+	std::vector<uint32_t>	m_crTaps;
+	std::vector<uint16_t>	m_accumulator;			// Vertical sum of a box of source rows, in source sample order
+
+	// Triple buffered thumbnails, owned by the capture callback, waiting, and being compressed
+	ThumbnailImage			m_images[3];
+	int						m_fillIndex;
+	int						m_pendingIndex;
+	int						m_encodeIndex;
+	bool					m_pendingValid;
+	bool					m_stopWorker;
+	bool					m_workerRunning;
+	bool					m_reportedUnsupported;
+	pthread_t				m_workerThread;
+	pthread_mutex_t			m_mutex;
+	pthread_cond_t			m_condition;
+
+	unsigned long			m_writtenCount;
+	unsigned long			m_replacedCount;
+
+	void					ConfigureGeometry(IDeckLinkVideoFrame* videoFrame);
+	void					DownscaleFrame(const uint8_t* frameBytes, long rowBytes, ThumbnailImage& image);
+	bool					CompressImage(const ThumbnailImage& image, unsigned char** jpegData, unsigned long* jpegSize);
+	bool					WriteThumbnail(const ThumbnailImage& image, const unsigned char* jpegData, unsigned long jpegSize);
+
+	static void*			WorkerThreadFunc(void* arg);
+	void					WorkerThread(void);
+};
+
+#endif
@@ -41,6 +41,8 @@
 //
 
 #include <stdio.h>
+#include <math.h>
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -53,6 +55,22 @@
 #include "DeckLinkInputDevice.h"
 #include "DeckLinkAPI.h"
 #include "ImageWriter.h"
+#include "ImageEncoderPool.h"
+#include "StagingVideoFrame.h"
+
+// Maximum frames waiting to be encoded, beyond this stills are dropped rather than blocking capture
+static const unsigned kMaxPendingEncodeFrames = 16;
+
+// PNG filter tuple encoding {PNGFilterStrategy enum, Filter option name}
+const std::vector<std::tuple<PNGFilterStrategy, std::string>> kSupportedPNGFilters
+{
+	std::make_tuple(kPNGFilterNone, "none"),
+	std::make_tuple(kPNGFilterSub, "sub"),
+	std::make_tuple(kPNGFilterUp, "up"),
+	std::make_tuple(kPNGFilterAverage, "average"),
+	std::make_tuple(kPNGFilterPaeth, "paeth"),
+	std::make_tuple(kPNGFilterAdaptive, "adaptive"),
+};
 
 // Pixel format tuple encoding {BMDPixelFormat enum, Pixel format display name}
 const std::vector<std::tuple<BMDPixelFormat, std::string>> kSupportedPixelFormats
@@ -72,8 +90,98 @@ enum {
 	kPixelFormatString
 };
 
+// Output file format tuple encoding {ImageFileFormat enum, Format option name, Filename extension}
+const std::vector<std::tuple<ImageFileFormat, std::string, std::string>> kSupportedFileFormats
+{
+	std::make_tuple(kImageFileFormatPNG, "png", ".png"),
+	std::make_tuple(kImageFileFormatTIFF, "tiff", ".tif"),
+};
+enum {
+	kFileFormatValue = 0,
+	kFileFormatString,
+	kFileFormatExtension
+};
+
+// Determine the YCbCr matrix of a captured frame from its metadata, otherwise assume Rec.601 for SD and Rec.709 for HD
+BMDColorspace GetFrameColorspace(IDeckLinkVideoFrame* videoFrame)
+{
+	IDeckLinkVideoFrameMetadataExtensions*	metadataExtensions	= NULL;
+	int64_t									colorspace			= 0;
+
+	if (videoFrame->QueryInterface(IID_IDeckLinkVideoFrameMetadataExtensions, (void**)&metadataExtensions) == S_OK)
+	{
+		if (metadataExtensions->GetInt(bmdDeckLinkFrameMetadataColorspace, &colorspace) != S_OK)
+			colorspace = 0;
+
+		metadataExtensions->Release();
+	}
+
+	if ((colorspace == bmdColorspaceRec601) || (colorspace == bmdColorspaceRec709) || (colorspace == bmdColorspaceRec2020))
+		return (BMDColorspace)colorspace;
+
+	return (videoFrame->GetHeight() <= 576) ? bmdColorspaceRec601 : bmdColorspaceRec709;
+}
+
+// Convert a captured frame to 8-bit BGRA for encoding, frames already in BGRA are AddRef'd
+HRESULT ConvertFrameToBgra32(IDeckLinkVideoConversion* deckLinkFrameConverter, IDeckLinkVideoFrame* videoFrame, IDeckLinkVideoFrame** bgra32Frame)
+{
+	HRESULT result;
+
+	if (videoFrame->GetPixelFormat() == bmdFormat8BitBGRA)
+	{
+		// Frame is already 8-bit BGRA - no conversion required
+		*bgra32Frame = videoFrame;
+		videoFrame->AddRef();
+		return S_OK;
+	}
+
+	*bgra32Frame = new Bgra32VideoFrame(videoFrame->GetWidth(), videoFrame->GetHeight(), videoFrame->GetFlags());
+
+	result = deckLinkFrameConverter->ConvertFrame(videoFrame, *bgra32Frame);
+	if (FAILED(result))
+	{
+		(*bgra32Frame)->Release();
+		*bgra32Frame = NULL;
+	}
+
+	return result;
+}
+
+// Prepare a captured frame for the encoder pool.  For 16-bit output, frames in a format the encoder unpacks
+// directly are passed without conversion to keep their full precision, copied first if the frame is a capture
+// buffer that must be returned to the driver.  All other frames are converted to 8-bit BGRA.
+HRESULT PrepareFrameForEncoding(IDeckLinkVideoConversion* deckLinkFrameConverter, IDeckLinkVideoFrame* videoFrame, unsigned bitDepth,
+								bool copyFrame, IDeckLinkVideoFrame** encodeFrame)
+{
+	StagingVideoFrame*	stagingFrame;
+	HRESULT				result;
+
+	if ((videoFrame->GetPixelFormat() == bmdFormat8BitBGRA) || !ImageEncoderPool::IsPixelFormatSupported(videoFrame->GetPixelFormat(), bitDepth))
+		return ConvertFrameToBgra32(deckLinkFrameConverter, videoFrame, encodeFrame);
+
+	if (!copyFrame)
+	{
+		*encodeFrame = videoFrame;
+		videoFrame->AddRef();
+		return S_OK;
+	}
+
+	stagingFrame = new StagingVideoFrame(videoFrame->GetWidth(), videoFrame->GetHeight(), videoFrame->GetRowBytes(), videoFrame->GetPixelFormat());
+
+	result = stagingFrame->CopyFrom(videoFrame);
+	if (FAILED(result))
+	{
+		stagingFrame->Release();
+		*encodeFrame = NULL;
+	}
+	else
+		*encodeFrame = stagingFrame;
+
+	return result;
+}
+
 void CaptureStills(DeckLinkInputDevice* deckLinkInput, const int captureInterval, const int framesToCapture,
-				   const std::string& captureDirectory, const std::string& filenamePrefix)
+				   FilenameAllocator& filenameAllocator, ImageEncoderPool* encoderPool, const unsigned bitDepth)
 {
 	int							captureFrameCount		= 0;
 	HRESULT						result					= S_OK;
@@ -81,7 +189,7 @@ void CaptureStills(DeckLinkInputDevice* deckLinkInput, const int captureInterval
 	
 	IDeckLinkVideoFrame*		receivedVideoFrame		= NULL;
 	IDeckLinkVideoConversion*	deckLinkFrameConverter	= NULL;
-	IDeckLinkVideoFrame*		bgra32Frame				= NULL;
+	IDeckLinkVideoFrame*		encodeFrame				= NULL;
 
 	// Create frame conversion instance
 	result = GetDeckLinkVideoConversion(&deckLinkFrameConverter);
@@ -102,49 +210,120 @@ void CaptureStills(DeckLinkInputDevice* deckLinkInput, const int captureInterval
 
 		else if ((++captureFrameCount % captureInterval) == 0)
 		{
-			std::string outputFileName;
-			result = ImageWriter::GetNextFilenameWithPrefix(captureDirectory, filenamePrefix, outputFileName);
-			if (result != S_OK)
+			std::string outputFileName = filenameAllocator.GetNextFilename();
+
+			fprintf(stderr, "Capturing frame #%d to %s\n", captureFrameCount, outputFileName.c_str());
+
+			result = PrepareFrameForEncoding(deckLinkFrameConverter, receivedVideoFrame, bitDepth, true, &encodeFrame);
+			if (FAILED(result))
 			{
-				fprintf(stderr, "Unable to get filename\n");
+				fprintf(stderr, "Frame conversion for encoding was unsuccessful\n");
 				captureRunning = false;
 			}
 			else
 			{
-				fprintf(stderr, "Capturing frame #%d to %s\n", captureFrameCount, outputFileName.c_str());
+				// Encoding is performed by the encoder pool, which holds a reference to the frame until the file is written
+				if (!encoderPool->EncodeFrame(encodeFrame, GetFrameColorspace(receivedVideoFrame), outputFileName, false))
+					fprintf(stderr, "Encoder busy, dropped still %s\n", outputFileName.c_str());
+
+				encodeFrame->Release();
+			}
+
+			if ((captureFrameCount / captureInterval) >= framesToCapture)
+			{
+				fprintf(stderr, "Completed Capture\n");
+				captureRunning = false;
+			}
+		}
+
+		if (receivedVideoFrame != NULL)
+		{
+			receivedVideoFrame->Release();
+			receivedVideoFrame = NULL;
+		}
+	}
 
-				if (receivedVideoFrame->GetPixelFormat() == bmdFormat8BitBGRA)
+	if (deckLinkFrameConverter != NULL)
+	{
+		deckLinkFrameConverter->Release();
+		deckLinkFrameConverter = NULL;
+	}
+
+	// Capture has completed, allow outstanding stills to finish encoding
+	encoderPool->WaitForCompletion();
+}
+
+void CaptureBurst(DeckLinkInputDevice* deckLinkInput, const int framesToCapture, const double burstSeconds,
+				  FilenameAllocator& filenameAllocator, ImageEncoderPool* encoderPool, const unsigned bitDepth)
+{
+	size_t								burstFrameCount			= 0;
+	HRESULT								result					= S_OK;
+	bool								captureRunning			= true;
+
+	IDeckLinkVideoFrame*				receivedVideoFrame		= NULL;
+	IDeckLinkVideoConversion*			deckLinkFrameConverter	= NULL;
+	std::vector<StagingVideoFrame*>		stagingFrames;
+	size_t								stagedFrameCount		= 0;
+	BMDColorspace						colorspace				= bmdColorspaceRec709;
+
+	// Create frame conversion instance
+	result = GetDeckLinkVideoConversion(&deckLinkFrameConverter);
+	if (result != S_OK)
+		return;
+
+	// During the burst, every frame is copied to RAM and the capture buffer returned immediately
+	while (captureRunning)
+	{
+		bool captureCancelled;
+		if (!deckLinkInput->WaitForVideoFrameArrived(&receivedVideoFrame, captureCancelled))
+		{
+			fprintf(stderr, "Timeout waiting for valid frame\n");
+			captureRunning = false;
+		}
+
+		else if (captureCancelled)
+			captureRunning = false;
+
+		else
+		{
+			if (stagingFrames.empty())
+			{
+				// Size the staging area from the first frame, as the mode may be auto-detected
+				IDeckLinkVideoInputFrame*	videoInputFrame;
+				BMDTimeValue				frameTime;
+				BMDTimeValue				frameDuration = 0;
+
+				if (receivedVideoFrame->QueryInterface(IID_IDeckLinkVideoInputFrame, (void**)&videoInputFrame) == S_OK)
 				{
-					// Frame is already 8-bit BGRA - no conversion required
-					bgra32Frame = receivedVideoFrame;
-					bgra32Frame->AddRef();
+					videoInputFrame->GetStreamTime(&frameTime, &frameDuration, 1000000);
+					videoInputFrame->Release();
 				}
+
+				if ((burstSeconds > 0.0) && (frameDuration > 0))
+					burstFrameCount = (size_t)ceil(burstSeconds * 1000000 / frameDuration);
 				else
-				{
-					bgra32Frame = new Bgra32VideoFrame(receivedVideoFrame->GetWidth(), receivedVideoFrame->GetHeight(), receivedVideoFrame->GetFlags());
-
-					result = deckLinkFrameConverter->ConvertFrame(receivedVideoFrame, bgra32Frame);
-					if (FAILED(result))
-					{
-						fprintf(stderr, "Frame conversion to BGRA was unsuccessful\n");
-						captureRunning = false;
-					}
-				}
+					burstFrameCount = framesToCapture;
 
-				result = ImageWriter::WriteBgra32VideoFrameToPNG(bgra32Frame, outputFileName);
-				if (FAILED(result))
-				{
-					fprintf(stderr, "Image encoding to file was unsuccessful\n");
-					captureRunning = false;
-				}
+				// Staged copies do not carry the frame metadata, so keep the colorspace of the first frame
+				colorspace = GetFrameColorspace(receivedVideoFrame);
 
-				bgra32Frame->Release();
-				
-				if ((captureFrameCount / captureInterval) >= framesToCapture)
-				{
-					fprintf(stderr, "Completed Capture\n");
-					captureRunning = false;
-				}
+				fprintf(stderr, "Staging %zu frames (%.1f MB) in memory\n", burstFrameCount,
+						(double)burstFrameCount * receivedVideoFrame->GetRowBytes() * receivedVideoFrame->GetHeight() / (1024 * 1024));
+
+				for (size_t i = 0; i < burstFrameCount; i++)
+					stagingFrames.push_back(new StagingVideoFrame(receivedVideoFrame->GetWidth(), receivedVideoFrame->GetHeight(),
+																  receivedVideoFrame->GetRowBytes(), receivedVideoFrame->GetPixelFormat()));
+			}
+
+			if (stagingFrames[stagedFrameCount]->CopyFrom(receivedVideoFrame) != S_OK)
+			{
+				fprintf(stderr, "Input format changed, ending burst\n");
+				captureRunning = false;
+			}
+			else if (++stagedFrameCount >= burstFrameCount)
+			{
+				fprintf(stderr, "Completed Capture\n");
+				captureRunning = false;
 			}
 		}
 
@@ -155,11 +334,41 @@ void CaptureStills(DeckLinkInputDevice* deckLinkInput, const int captureInterval
 		}
 	}
 
+	// Stop capture so that frames no longer queue while the staged frames are written
+	deckLinkInput->StopCapture();
+
+	fprintf(stderr, "Writing %zu staged frames\n", stagedFrameCount);
+
+	for (size_t i = 0; i < stagingFrames.size(); i++)
+	{
+		if (i < stagedFrameCount)
+		{
+			std::string				outputFileName = filenameAllocator.GetNextFilename();
+			IDeckLinkVideoFrame*	encodeFrame;
+
+			if (PrepareFrameForEncoding(deckLinkFrameConverter, stagingFrames[i], bitDepth, false, &encodeFrame) != S_OK)
+				fprintf(stderr, "Frame conversion for encoding was unsuccessful\n");
+			else
+			{
+				// Wait for space in the encoder queue, no frames are dropped after a burst
+				encoderPool->EncodeFrame(encodeFrame, colorspace, outputFileName, true);
+				encodeFrame->Release();
+			}
+		}
+
+		// Free each staged frame once queued to reduce peak memory use
+		stagingFrames[i]->Release();
+		stagingFrames[i] = NULL;
+	}
+
 	if (deckLinkFrameConverter != NULL)
 	{
 		deckLinkFrameConverter->Release();
 		deckLinkFrameConverter = NULL;
 	}
+
+	encoderPool->WaitForCompletion();
+	fprintf(stderr, "Wrote %lu stills\n", encoderPool->GetEncodedFrameCount());
 }
 
 void DisplayUsage(DeckLinkInputDevice* selectedDeckLinkInput, const std::vector<std::string>& deviceNames,
@@ -285,12 +494,22 @@ void DisplayUsage(DeckLinkInputDevice* selectedDeckLinkInput, const std::vector<
 	fprintf(stderr,
 		"    -n <frames>          Number of frames to capture (default is 1)\n"
 		"    -i <interval>        Capture frame interval rate (default is 1 - every frame)\n"
+		"    -b                   Burst mode, stage every frame in memory then write the stills\n"
+		"    -s <seconds>         Burst mode for a duration rather than a number of frames\n"
 		"    -f <prefix>          Filename prefix (default is \"image_\")\n"
+		"    -z <level>           PNG compression level 0-9 (default is 6)\n"
+		"    -e <filter>          PNG filter none|sub|up|average|paeth|adaptive (default is adaptive)\n"
+		"    -j <threads>         Number of encoder threads (default is number of CPUs)\n"
+		"    -o <format>          Output file format png|tiff (default is png)\n"
+		"    -c <bits>            Bits per component 8|16 (default is 8), 16-bit stills are unpacked\n"
+		"                         directly from 10-bit YUV, 10-bit RGB and 12-bit RGB frames\n"
 		"    <capturedirectory>\n"
 		"\n"
 		"Capture image stills to a specified directory. eg:\n"
 		"\n"
-		"    ./CaptureStills -d 0 -m 2 -n 10 -i 60 ~/Pictures/\n\n"
+		"    ./CaptureStills -d 0 -m 2 -n 10 -i 60 ~/Pictures/\n"
+		"    ./CaptureStills -d 0 -m 2 -s 2.5 ~/Pictures/\n"
+		"    ./CaptureStills -d 0 -m 2 -p 1 -c 16 -o tiff ~/Pictures/\n\n"
 		);
 }
 
@@ -303,8 +522,15 @@ int main(int argc, char* argv[])
 	int							displayModeIndex		= -2;
 	int							framesToCapture			= 1;
 	int							captureInterval			= 1;
+	bool						burstMode				= false;
+	double						burstSeconds			= 0.0;
 	int							pixelFormatIndex		= 0;
 	bool						enableFormatDetection	= false;
+	int							compressionLevel		= 6;
+	PNGFilterStrategy			filterStrategy			= kPNGFilterAdaptive;
+	int							encoderThreadCount		= (int)std::thread::hardware_concurrency();
+	int							fileFormatIndex			= kImageFileFormatPNG;
+	int							bitDepth				= 8;
 	std::string					filenamePrefix;
 	std::string					captureDirectory;
 
@@ -319,6 +545,8 @@ int main(int argc, char* argv[])
 	IDeckLinkIterator*			deckLinkIterator		= NULL;
 	IDeckLink*					deckLink				= NULL;
 	DeckLinkInputDevice*		selectedDeckLinkInput	= NULL;
+	ImageEncoderPool*			encoderPool				= NULL;
+	FilenameAllocator*			filenameAllocator		= NULL;
 
 	BMDDisplayMode				selectedDisplayMode		= bmdModeNTSC;
 	std::string					selectedDisplayModeName;
@@ -343,12 +571,58 @@ int main(int argc, char* argv[])
 		else if (strcmp(argv[i], "-n") == 0)
 			framesToCapture = atoi(argv[++i]);
 
+		else if (strcmp(argv[i], "-b") == 0)
+			burstMode = true;
+
+		else if (strcmp(argv[i], "-s") == 0)
+		{
+			burstMode = true;
+			burstSeconds = atof(argv[++i]);
+		}
+
 		else if (strcmp(argv[i], "-p") == 0)
 			pixelFormatIndex = atoi(argv[++i]);
 
 		else if (strcmp(argv[i], "-f") == 0)
 			filenamePrefix = argv[++i];
 
+		else if (strcmp(argv[i], "-z") == 0)
+			compressionLevel = atoi(argv[++i]);
+
+		else if (strcmp(argv[i], "-j") == 0)
+			encoderThreadCount = atoi(argv[++i]);
+
+		else if (strcmp(argv[i], "-e") == 0)
+		{
+			auto iter = std::find_if(kSupportedPNGFilters.begin(), kSupportedPNGFilters.end(),
+									 [&](const std::tuple<PNGFilterStrategy, std::string>& filter) { return std::get<1>(filter) == argv[i + 1]; });
+			if (iter == kSupportedPNGFilters.end())
+			{
+				fprintf(stderr, "Invalid PNG filter %s\n", argv[i + 1]);
+				displayHelp = true;
+			}
+			else
+				filterStrategy = std::get<0>(*iter);
+			i++;
+		}
+
+		else if (strcmp(argv[i], "-o") == 0)
+		{
+			auto iter = std::find_if(kSupportedFileFormats.begin(), kSupportedFileFormats.end(),
+									 [&](const std::tuple<ImageFileFormat, std::string, std::string>& format) { return std::get<kFileFormatString>(format) == argv[i + 1]; });
+			if (iter == kSupportedFileFormats.end())
+			{
+				fprintf(stderr, "Invalid output file format %s\n", argv[i + 1]);
+				displayHelp = true;
+			}
+			else
+				fileFormatIndex = (int)(iter - kSupportedFileFormats.begin());
+			i++;
+		}
+
+		else if (strcmp(argv[i], "-c") == 0)
+			bitDepth = atoi(argv[++i]);
+
 		else if ((strcmp(argv[i], "?") == 0) || (strcmp(argv[i], "-h") == 0))
 			displayHelp = true;
 
@@ -509,6 +783,21 @@ int main(int argc, char* argv[])
 		filenamePrefix = "image_";
 	}
 
+	if ((compressionLevel < 0) || (compressionLevel > 9))
+	{
+		fprintf(stderr, "PNG compression level must be between 0 and 9\n");
+		displayHelp = true;
+	}
+
+	if (encoderThreadCount <= 0)
+		encoderThreadCount = 1;
+
+	if ((bitDepth != 8) && (bitDepth != 16))
+	{
+		fprintf(stderr, "Bits per component must be 8 or 16\n");
+		displayHelp = true;
+	}
+
 	if (displayHelp)
 	{
 		DisplayUsage(selectedDeckLinkInput, deckLinkDeviceNames, deckLinkIndex, displayModeIndex, supportsFormatDetection);
@@ -525,24 +814,42 @@ int main(int argc, char* argv[])
 		" - Capture device: %s\n"
 		" - Video mode: %s\n"
 		" - Pixel format: %s\n"
+		" - Capture mode: %s\n"
 		" - Frames to capture: %d\n"
 		" - Capture interval: %d\n"
 		" - Filename prefix: %s\n"
-		" - Capture directory: %s\n",
+		" - Capture directory: %s\n"
+		" - Output format: %d-bit %s\n"
+		" - PNG compression level: %d\n"
+		" - PNG filter: %s\n"
+		" - Encoder threads: %d\n",
 		selectedDeckLinkInput->GetDeviceName().c_str(),
 		selectedDisplayModeName.c_str(),
 		std::get<kPixelFormatString>(kSupportedPixelFormats[pixelFormatIndex]).c_str(),
+		burstMode ? "Burst" : "Stills",
 		framesToCapture,
 		captureInterval,
 		filenamePrefix.c_str(),
-		captureDirectory.c_str()
+		captureDirectory.c_str(),
+		bitDepth,
+		std::get<kFileFormatString>(kSupportedFileFormats[fileFormatIndex]).c_str(),
+		compressionLevel,
+		std::get<1>(kSupportedPNGFilters[filterStrategy]).c_str(),
+		encoderThreadCount
 		);
 
+	encoderPool = new ImageEncoderPool(encoderThreadCount, std::get<kFileFormatValue>(kSupportedFileFormats[fileFormatIndex]), bitDepth,
+									   compressionLevel, filterStrategy, kMaxPendingEncodeFrames);
+	filenameAllocator = new FilenameAllocator(captureDirectory, filenamePrefix, std::get<kFileFormatExtension>(kSupportedFileFormats[fileFormatIndex]));
+
 	fprintf(stderr, "Starting capture, press <RETURN> to stop/exit\n");
 
 	// Start thread for capture processing
 	captureStillsThread = std::thread([&]{
-		CaptureStills(selectedDeckLinkInput, captureInterval, framesToCapture, captureDirectory, filenamePrefix);
+		if (burstMode)
+			CaptureBurst(selectedDeckLinkInput, framesToCapture, burstSeconds, *filenameAllocator, encoderPool, bitDepth);
+		else
+			CaptureStills(selectedDeckLinkInput, captureInterval, framesToCapture, *filenameAllocator, encoderPool, bitDepth);
 	});
 
 	keyPressThread = std::thread([&]{
@@ -560,6 +867,18 @@ int main(int argc, char* argv[])
 	exitStatus = 0;
 
 bail:
+	if (filenameAllocator != NULL)
+	{
+		delete filenameAllocator;
+		filenameAllocator = NULL;
+	}
+
+	if (encoderPool != NULL)
+	{
+		delete encoderPool;
+		encoderPool = NULL;
+	}
+
 	if (selectedDeckLinkInput != NULL)
 	{
 		selectedDeckLinkInput->Release();
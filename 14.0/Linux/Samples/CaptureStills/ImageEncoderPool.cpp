@@ -0,0 +1,615 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <zlib.h>
+#include "platform.h"
+#include "ImageEncoderPool.h"
+#include "Rgb48RowUnpacker.h"
+
+static const uint8_t	kPNGSignature[8]	= { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+static const uint32_t	kMinimumBandRows	= 64;		// Smaller bands cost compression ratio for little gain in parallelism
+
+// TIFF 6.0 tag and field type values
+enum
+{
+	kTIFFTagImageWidth					= 256,
+	kTIFFTagImageLength					= 257,
+	kTIFFTagBitsPerSample				= 258,
+	kTIFFTagCompression					= 259,
+	kTIFFTagPhotometricInterpretation	= 262,
+	kTIFFTagStripOffsets				= 273,
+	kTIFFTagSamplesPerPixel				= 277,
+	kTIFFTagRowsPerStrip				= 278,
+	kTIFFTagStripByteCounts				= 279,
+	kTIFFTagPlanarConfiguration			= 284,
+	kTIFFTagExtraSamples				= 338,
+
+	kTIFFTypeShort						= 3,
+	kTIFFTypeLong						= 4,
+};
+
+static inline void WriteBigEndian32(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)(value >> 24);
+	buffer[1] = (uint8_t)(value >> 16);
+	buffer[2] = (uint8_t)(value >> 8);
+	buffer[3] = (uint8_t)value;
+}
+
+static inline void WriteLittleEndian16(std::vector<uint8_t>& buffer, uint16_t value)
+{
+	buffer.push_back((uint8_t)value);
+	buffer.push_back((uint8_t)(value >> 8));
+}
+
+static inline void WriteLittleEndian32(std::vector<uint8_t>& buffer, uint32_t value)
+{
+	WriteLittleEndian16(buffer, (uint16_t)value);
+	WriteLittleEndian16(buffer, (uint16_t)(value >> 16));
+}
+
+// Convert a row of 8-bit BGRA pixels to RGBA byte order
+static void SwizzleBgraRow(const uint8_t* bgraRow, uint8_t* rgbaRow, uint32_t width)
+{
+	for (uint32_t x = 0; x < width; x++, bgraRow += 4, rgbaRow += 4)
+	{
+		rgbaRow[0] = bgraRow[2];
+		rgbaRow[1] = bgraRow[1];
+		rgbaRow[2] = bgraRow[0];
+		rgbaRow[3] = bgraRow[3];
+	}
+}
+
+static inline uint8_t PaethPredictor(int a, int b, int c)
+{
+	int p	= a + b - c;
+	int pa	= abs(p - a);
+	int pb	= abs(p - b);
+	int pc	= abs(p - c);
+
+	if ((pa <= pb) && (pa <= pc))
+		return (uint8_t)a;
+	else if (pb <= pc)
+		return (uint8_t)b;
+	return (uint8_t)c;
+}
+
+// Filter a row into filteredRow, where filteredRow[0] is the filter type byte
+static void FilterRow(PNGFilterStrategy filter, const uint8_t* row, const uint8_t* priorRow, uint8_t* filteredRow, uint32_t rowBytes, uint32_t bytesPerPixel)
+{
+	uint8_t* out = filteredRow + 1;
+
+	filteredRow[0] = (uint8_t)filter;
+
+	switch (filter)
+	{
+		case kPNGFilterSub:
+			for (uint32_t i = 0; i < rowBytes; i++)
+				out[i] = row[i] - ((i >= bytesPerPixel) ? row[i - bytesPerPixel] : 0);
+			break;
+
+		case kPNGFilterUp:
+			for (uint32_t i = 0; i < rowBytes; i++)
+				out[i] = row[i] - priorRow[i];
+			break;
+
+		case kPNGFilterAverage:
+			for (uint32_t i = 0; i < rowBytes; i++)
+				out[i] = row[i] - (uint8_t)((((i >= bytesPerPixel) ? row[i - bytesPerPixel] : 0) + priorRow[i]) >> 1);
+			break;
+
+		case kPNGFilterPaeth:
+			for (uint32_t i = 0; i < rowBytes; i++)
+			{
+				if (i >= bytesPerPixel)
+					out[i] = row[i] - PaethPredictor(row[i - bytesPerPixel], priorRow[i], priorRow[i - bytesPerPixel]);
+				else
+					out[i] = row[i] - priorRow[i];
+			}
+			break;
+
+		case kPNGFilterNone:
+		default:
+			memcpy(out, row, rowBytes);
+			break;
+	}
+}
+
+static uint64_t SumOfAbsoluteDifferences(const uint8_t* filteredRow, uint32_t rowBytes)
+{
+	uint64_t sum = 0;
+
+	for (uint32_t i = 1; i <= rowBytes; i++)
+		sum += abs((int8_t)filteredRow[i]);
+
+	return sum;
+}
+
+// Write a PNG chunk whose data is the concatenation of the given pieces
+static bool WriteChunk(FILE* pngFile, const char* chunkType, const std::vector<std::pair<const uint8_t*, size_t>>& pieces)
+{
+	uint8_t		lengthBytes[4];
+	uint8_t		crcBytes[4];
+	size_t		length = 0;
+	uLong		crc;
+
+	for (auto& piece : pieces)
+		length += piece.second;
+
+	WriteBigEndian32(lengthBytes, (uint32_t)length);
+	crc = crc32(0L, (const Bytef*)chunkType, 4);
+
+	if ((fwrite(lengthBytes, 1, 4, pngFile) != 4) || (fwrite(chunkType, 1, 4, pngFile) != 4))
+		return false;
+
+	for (auto& piece : pieces)
+	{
+		if (fwrite(piece.first, 1, piece.second, pngFile) != piece.second)
+			return false;
+		crc = crc32(crc, piece.first, (uInt)piece.second);
+	}
+
+	WriteBigEndian32(crcBytes, (uint32_t)crc);
+	return fwrite(crcBytes, 1, 4, pngFile) == 4;
+}
+
+static void WriteTIFFEntry(std::vector<uint8_t>& buffer, uint16_t tag, uint16_t type, uint32_t count, uint32_t value)
+{
+	WriteLittleEndian16(buffer, tag);
+	WriteLittleEndian16(buffer, type);
+	WriteLittleEndian32(buffer, count);
+
+	// Values that fit in 4 bytes are stored left-justified in the value field
+	if ((type == kTIFFTypeShort) && (count == 1))
+	{
+		WriteLittleEndian16(buffer, (uint16_t)value);
+		WriteLittleEndian16(buffer, 0);
+	}
+	else
+		WriteLittleEndian32(buffer, value);
+}
+
+ImageEncoderPool::ImageEncoderPool(unsigned threadCount, ImageFileFormat fileFormat, unsigned bitDepth, int compressionLevel, PNGFilterStrategy filterStrategy, unsigned maxPendingFrames) :
+	m_fileFormat(fileFormat),
+	m_bitDepth(bitDepth),
+	m_compressionLevel(compressionLevel),
+	m_filterStrategy(filterStrategy),
+	m_maxPendingFrames(std::max(maxPendingFrames, 1u)),
+	m_threadCount(std::max(threadCount, 1u)),
+	m_pendingFrames(0),
+	m_stopWorkers(false),
+	m_encodedFrameCount(0),
+	m_failedFrameCount(0)
+{
+	for (unsigned i = 0; i < m_threadCount; i++)
+		m_workerThreads.push_back(std::thread(&ImageEncoderPool::WorkerThread, this));
+}
+
+ImageEncoderPool::~ImageEncoderPool()
+{
+	WaitForCompletion();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopWorkers = true;
+	}
+	m_taskCondition.notify_all();
+
+	for (auto& workerThread : m_workerThreads)
+		workerThread.join();
+}
+
+bool ImageEncoderPool::IsPixelFormatSupported(BMDPixelFormat pixelFormat, unsigned bitDepth)
+{
+	if (bitDepth == 16)
+		return Rgb48RowUnpacker::IsPixelFormatSupported(pixelFormat);
+
+	return pixelFormat == bmdFormat8BitBGRA;
+}
+
+bool ImageEncoderPool::EncodeFrame(IDeckLinkVideoFrame* videoFrame, BMDColorspace colorspace, const std::string& filename, bool waitForQueue)
+{
+	std::shared_ptr<EncodeJob>	job;
+	uint32_t					height = (uint32_t)videoFrame->GetHeight();
+	uint32_t					bandCount;
+	uint32_t					firstRow = 0;
+
+	// Ensure video frame has expected pixel format
+	if (!IsPixelFormatSupported(videoFrame->GetPixelFormat(), m_bitDepth))
+	{
+		fprintf(stderr, "Video frame pixel format is not supported for %u-bit encoding\n", m_bitDepth);
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (waitForQueue)
+		m_completionCondition.wait(lock, [this]{ return m_pendingFrames < m_maxPendingFrames; });
+	else if (m_pendingFrames >= m_maxPendingFrames)
+		return false;
+
+	// Split the frame into one band per worker, unless the bands would be too small
+	bandCount = std::max(1u, std::min(m_threadCount, height / kMinimumBandRows));
+
+	job = std::make_shared<EncodeJob>();
+	job->videoFrame = videoFrame;
+	job->videoFrame->AddRef();
+	job->colorspace = colorspace;
+	job->filename = filename;
+	job->bands.resize(bandCount);
+	job->bandsRemaining = bandCount;
+
+	for (uint32_t i = 0; i < bandCount; i++)
+	{
+		uint32_t lastRow = (uint32_t)(((uint64_t)height * (i + 1)) / bandCount);
+
+		job->bands[i].firstRow = firstRow;
+		job->bands[i].rowCount = lastRow - firstRow;
+		job->bands[i].adler = 1;
+		job->bands[i].succeeded = false;
+		firstRow = lastRow;
+
+		m_bandTasks.push_back(BandTask(job, i));
+	}
+
+	m_pendingFrames++;
+	m_taskCondition.notify_all();
+
+	return true;
+}
+
+void ImageEncoderPool::WaitForCompletion()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_completionCondition.wait(lock, [this]{ return m_pendingFrames == 0; });
+}
+
+void ImageEncoderPool::WorkerThread()
+{
+	while (true)
+	{
+		BandTask task;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskCondition.wait(lock, [this]{ return m_stopWorkers || !m_bandTasks.empty(); });
+
+			if (m_bandTasks.empty())
+				break;
+
+			task = m_bandTasks.front();
+			m_bandTasks.pop_front();
+		}
+
+		EncodeJob& job = *task.first;
+
+		EncodeBandData(job, job.bands[task.second]);
+
+		if (--job.bandsRemaining == 0)
+		{
+			bool result;
+
+			// Last band of the frame completed on this thread, assemble the file
+			if (m_fileFormat == kImageFileFormatTIFF)
+				result = WriteTIFFFile(job);
+			else
+				result = WritePNGFile(job);
+
+			if (result)
+				++m_encodedFrameCount;
+			else
+			{
+				fprintf(stderr, "Image encoding to file %s was unsuccessful\n", job.filename.c_str());
+				++m_failedFrameCount;
+			}
+
+			job.videoFrame->Release();
+			job.videoFrame = NULL;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_pendingFrames--;
+			}
+			m_completionCondition.notify_all();
+		}
+	}
+}
+
+void ImageEncoderPool::EncodeBandData(EncodeJob& job, EncodeBand& band)
+{
+	const uint32_t			width			= (uint32_t)job.videoFrame->GetWidth();
+	const uint32_t			bytesPerPixel	= GetBytesPerPixel();
+	const uint32_t			rowBytes		= width * bytesPerPixel;
+	const long				frameRowBytes	= job.videoFrame->GetRowBytes();
+	const bool				lastBand		= (&band == &job.bands.back());
+	uint8_t*				frameBytes		= NULL;
+	std::vector<uint8_t>	priorRow(rowBytes, 0);
+	std::vector<uint8_t>	currentRow(rowBytes);
+	std::vector<uint8_t>	filteredRows[kPNGFilterAdaptive];
+	z_stream				stream;
+	uLong					adler			= adler32(0L, Z_NULL, 0);
+
+	// 16-bit samples are big-endian in PNG, TIFF files are written little-endian
+	Rgb48RowUnpacker		rgb48Unpacker(job.videoFrame->GetPixelFormat(), width, job.colorspace, m_fileFormat == kImageFileFormatPNG);
+
+	auto unpackRow = [&](uint32_t row, uint8_t* destination) {
+		if (m_bitDepth == 16)
+			rgb48Unpacker.UnpackRow(frameBytes + row * frameRowBytes, (uint16_t*)destination);
+		else
+			SwizzleBgraRow(frameBytes + row * frameRowBytes, destination, width);
+	};
+
+	if (job.videoFrame->GetBytes((void**)&frameBytes) != S_OK)
+		return;
+
+	if (m_fileFormat == kImageFileFormatTIFF)
+	{
+		// Uncompressed, rows are unpacked directly into the strip data
+		band.encodedData.resize((size_t)rowBytes * band.rowCount);
+		for (uint32_t row = 0; row < band.rowCount; row++)
+			unpackRow(band.firstRow + row, band.encodedData.data() + (size_t)row * rowBytes);
+
+		band.succeeded = true;
+		return;
+	}
+
+	memset(&stream, 0, sizeof(stream));
+
+	// Raw deflate, the zlib header and trailer for the whole image are written by WritePNGFile
+	if (deflateInit2(&stream, m_compressionLevel, Z_DEFLATED, -MAX_WBITS, 8,
+					 (m_filterStrategy == kPNGFilterNone) ? Z_DEFAULT_STRATEGY : Z_FILTERED) != Z_OK)
+		return;
+
+	band.encodedData.resize(deflateBound(&stream, (uLong)(rowBytes + 1) * band.rowCount) + 64);
+	stream.next_out = band.encodedData.data();
+	stream.avail_out = (uInt)band.encodedData.size();
+
+	for (auto& filteredRow : filteredRows)
+		filteredRow.resize(rowBytes + 1);
+
+	// Filters refer to the row above, which for the first row of a band lies in the previous band
+	if (band.firstRow > 0)
+		unpackRow(band.firstRow - 1, priorRow.data());
+
+	for (uint32_t row = band.firstRow; row < band.firstRow + band.rowCount; row++)
+	{
+		std::vector<uint8_t>*	filteredRow = &filteredRows[0];
+		int						flush = Z_NO_FLUSH;
+		int						zresult;
+
+		unpackRow(row, currentRow.data());
+
+		if (m_filterStrategy == kPNGFilterAdaptive)
+		{
+			uint64_t minimumSum = UINT64_MAX;
+
+			for (int filter = kPNGFilterNone; filter < kPNGFilterAdaptive; filter++)
+			{
+				uint64_t sum;
+
+				FilterRow((PNGFilterStrategy)filter, currentRow.data(), priorRow.data(), filteredRows[filter].data(), rowBytes, bytesPerPixel);
+				sum = SumOfAbsoluteDifferences(filteredRows[filter].data(), rowBytes);
+				if (sum < minimumSum)
+				{
+					minimumSum = sum;
+					filteredRow = &filteredRows[filter];
+				}
+			}
+		}
+		else
+		{
+			FilterRow(m_filterStrategy, currentRow.data(), priorRow.data(), filteredRow->data(), rowBytes, bytesPerPixel);
+		}
+
+		adler = adler32(adler, filteredRow->data(), rowBytes + 1);
+
+		// Bands other than the last end on a byte boundary without a final block, so they can be concatenated
+		if (row == band.firstRow + band.rowCount - 1)
+			flush = lastBand ? Z_FINISH : Z_SYNC_FLUSH;
+
+		stream.next_in = filteredRow->data();
+		stream.avail_in = rowBytes + 1;
+
+		do
+		{
+			if (stream.avail_out == 0)
+			{
+				size_t used = band.encodedData.size();
+				band.encodedData.resize(used * 2);
+				stream.next_out = band.encodedData.data() + used;
+				stream.avail_out = (uInt)used;
+			}
+			zresult = deflate(&stream, flush);
+		}
+		while ((zresult == Z_OK) && ((stream.avail_out == 0) || ((flush == Z_FINISH) && (zresult != Z_STREAM_END))));
+
+		if ((zresult != Z_OK) && (zresult != Z_STREAM_END) && (zresult != Z_BUF_ERROR))
+		{
+			deflateEnd(&stream);
+			return;
+		}
+
+		std::swap(priorRow, currentRow);
+	}
+
+	band.encodedData.resize(stream.total_out);
+	band.adler = (uint32_t)adler;
+	band.succeeded = true;
+
+	deflateEnd(&stream);
+}
+
+bool ImageEncoderPool::WritePNGFile(EncodeJob& job)
+{
+	const uint32_t	width		= (uint32_t)job.videoFrame->GetWidth();
+	const uint32_t	height		= (uint32_t)job.videoFrame->GetHeight();
+	uint8_t			header[13];
+	uint8_t			zlibHeader[2];
+	uint8_t			zlibTrailer[4];
+	uLong			adler		= adler32(0L, Z_NULL, 0);
+	int				compressionFlags;
+	bool			result;
+	FILE*			pngFile;
+	std::vector<std::pair<const uint8_t*, size_t>>	imageData;
+
+	for (auto& band : job.bands)
+	{
+		if (!band.succeeded)
+			return false;
+
+		adler = adler32_combine(adler, band.adler, (z_off_t)band.rowCount * (width * GetBytesPerPixel() + 1));
+	}
+
+	// IHDR: 8-bit RGBA or 16-bit RGB, deflate compression, adaptive filtering method, no interlace
+	WriteBigEndian32(&header[0], width);
+	WriteBigEndian32(&header[4], height);
+	header[8]	= (uint8_t)m_bitDepth;
+	header[9]	= (m_bitDepth == 16) ? 2 : 6;
+	header[10]	= 0;
+	header[11]	= 0;
+	header[12]	= 0;
+
+	// zlib header for a 32K window, FLEVEL reports the compression level
+	if (m_compressionLevel < 2)
+		compressionFlags = 0;
+	else if (m_compressionLevel < 6)
+		compressionFlags = 1;
+	else if (m_compressionLevel == 6 || m_compressionLevel == Z_DEFAULT_COMPRESSION)
+		compressionFlags = 2;
+	else
+		compressionFlags = 3;
+
+	zlibHeader[0] = 0x78;
+	zlibHeader[1] = (uint8_t)(compressionFlags << 6);
+	zlibHeader[1] += 31 - ((zlibHeader[0] << 8) + zlibHeader[1]) % 31;
+
+	WriteBigEndian32(zlibTrailer, (uint32_t)adler);
+
+	imageData.push_back(std::make_pair(zlibHeader, sizeof(zlibHeader)));
+	for (auto& band : job.bands)
+		imageData.push_back(std::make_pair(band.encodedData.data(), band.encodedData.size()));
+	imageData.push_back(std::make_pair(zlibTrailer, sizeof(zlibTrailer)));
+
+	pngFile = fopen(job.filename.c_str(), "wb");
+	if (!pngFile)
+	{
+		fprintf(stderr, "Could not open PNG file %s for writing\n", job.filename.c_str());
+		return false;
+	}
+
+	result = (fwrite(kPNGSignature, 1, sizeof(kPNGSignature), pngFile) == sizeof(kPNGSignature)) &&
+			 WriteChunk(pngFile, "IHDR", { std::make_pair(header, sizeof(header)) }) &&
+			 WriteChunk(pngFile, "IDAT", imageData) &&
+			 WriteChunk(pngFile, "IEND", {});
+
+	if (fclose(pngFile) != 0)
+		result = false;
+
+	return result;
+}
+
+bool ImageEncoderPool::WriteTIFFFile(EncodeJob& job)
+{
+	const uint32_t			width			= (uint32_t)job.videoFrame->GetWidth();
+	const uint32_t			height			= (uint32_t)job.videoFrame->GetHeight();
+	const uint16_t			samplesPerPixel	= (m_bitDepth == 16) ? 3 : 4;
+	const uint16_t			entryCount		= (samplesPerPixel == 4) ? 11 : 10;
+	const uint32_t			ifdOffset		= 8;
+	const uint32_t			bitsOffset		= ifdOffset + 2 + entryCount * 12 + 4;
+	const uint32_t			imageOffset		= bitsOffset + samplesPerPixel * 2;
+	const uint32_t			imageBytes		= width * height * GetBytesPerPixel();
+	std::vector<uint8_t>	header;
+	bool					result			= true;
+	FILE*					tiffFile;
+
+	for (auto& band : job.bands)
+	{
+		if (!band.succeeded)
+			return false;
+	}
+
+	// Little-endian TIFF with a single IFD and the whole image in one uncompressed strip, bands are
+	// written consecutively to form the strip
+	header.push_back('I');
+	header.push_back('I');
+	WriteLittleEndian16(header, 42);
+	WriteLittleEndian32(header, ifdOffset);
+
+	WriteLittleEndian16(header, entryCount);
+	WriteTIFFEntry(header, kTIFFTagImageWidth, kTIFFTypeLong, 1, width);
+	WriteTIFFEntry(header, kTIFFTagImageLength, kTIFFTypeLong, 1, height);
+	WriteTIFFEntry(header, kTIFFTagBitsPerSample, kTIFFTypeShort, samplesPerPixel, bitsOffset);
+	WriteTIFFEntry(header, kTIFFTagCompression, kTIFFTypeShort, 1, 1);
+	WriteTIFFEntry(header, kTIFFTagPhotometricInterpretation, kTIFFTypeShort, 1, 2);
+	WriteTIFFEntry(header, kTIFFTagStripOffsets, kTIFFTypeLong, 1, imageOffset);
+	WriteTIFFEntry(header, kTIFFTagSamplesPerPixel, kTIFFTypeShort, 1, samplesPerPixel);
+	WriteTIFFEntry(header, kTIFFTagRowsPerStrip, kTIFFTypeLong, 1, height);
+	WriteTIFFEntry(header, kTIFFTagStripByteCounts, kTIFFTypeLong, 1, imageBytes);
+	WriteTIFFEntry(header, kTIFFTagPlanarConfiguration, kTIFFTypeShort, 1, 1);
+	if (samplesPerPixel == 4)
+		WriteTIFFEntry(header, kTIFFTagExtraSamples, kTIFFTypeShort, 1, 2);		// Unassociated alpha
+	WriteLittleEndian32(header, 0);
+
+	for (uint16_t i = 0; i < samplesPerPixel; i++)
+		WriteLittleEndian16(header, (uint16_t)m_bitDepth);
+
+	tiffFile = fopen(job.filename.c_str(), "wb");
+	if (!tiffFile)
+	{
+		fprintf(stderr, "Could not open TIFF file %s for writing\n", job.filename.c_str());
+		return false;
+	}
+
+	result = (fwrite(header.data(), 1, header.size(), tiffFile) == header.size());
+
+	for (auto& band : job.bands)
+	{
+		if (result)
+			result = (fwrite(band.encodedData.data(), 1, band.encodedData.size(), tiffFile) == band.encodedData.size());
+	}
+
+	if (fclose(tiffFile) != 0)
+		result = false;
+
+	return result;
+}
@@ -0,0 +1,145 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeckLinkAPI.h"
+
+// File format written by ImageEncoderPool
+enum ImageFileFormat
+{
+	kImageFileFormatPNG = 0,
+	kImageFileFormatTIFF
+};
+
+// PNG row filter applied before compression, refer to PNG specification section 9
+enum PNGFilterStrategy
+{
+	kPNGFilterNone = 0,
+	kPNGFilterSub,
+	kPNGFilterUp,
+	kPNGFilterAverage,
+	kPNGFilterPaeth,
+	kPNGFilterAdaptive		// Select filter per row with minimum sum of absolute differences
+};
+
+// ImageEncoderPool encodes captured frames to PNG or uncompressed TIFF files on a pool of worker threads.
+//
+// With a bit depth of 8, frames must be 8-bit BGRA and are written as 8-bit RGBA.  With a bit depth
+// of 16, frames may also be v210, r210, R12B or R12L, which are unpacked directly to 16-bit RGB by
+// the workers (see Rgb48RowUnpacker).
+//
+// Each frame is divided into bands of rows that are unpacked, filtered and deflated independently, so
+// that a single large frame is encoded by all workers in parallel.  For PNG, each band except the last
+// is ended with a sync flush, so the compressed bands concatenate into a single valid zlib stream.
+// The worker that completes the last band of a frame writes the file.
+class ImageEncoderPool
+{
+public:
+	ImageEncoderPool(unsigned threadCount, ImageFileFormat fileFormat, unsigned bitDepth, int compressionLevel, PNGFilterStrategy filterStrategy, unsigned maxPendingFrames);
+	virtual ~ImageEncoderPool();
+
+	static bool			IsPixelFormatSupported(BMDPixelFormat pixelFormat, unsigned bitDepth);
+
+	// Queue a frame for encoding, the frame is AddRef'd until its file is written.  The colorspace selects
+	// the YCbCr matrix for v210 frames.  If maxPendingFrames frames are already waiting to be encoded,
+	// either wait for one to complete or return false.
+	bool				EncodeFrame(IDeckLinkVideoFrame* videoFrame, BMDColorspace colorspace, const std::string& filename, bool waitForQueue);
+
+	// Wait until all queued frames have been written
+	void				WaitForCompletion(void);
+
+	unsigned long		GetEncodedFrameCount(void) const { return m_encodedFrameCount; }
+	unsigned long		GetFailedFrameCount(void) const { return m_failedFrameCount; }
+
+private:
+	struct EncodeBand
+	{
+		uint32_t				firstRow;
+		uint32_t				rowCount;
+		std::vector<uint8_t>	encodedData;		// Deflated rows for PNG, unpacked rows for TIFF
+		uint32_t				adler;				// Adler-32 of the filtered (uncompressed) band data
+		bool					succeeded;
+	};
+
+	struct EncodeJob
+	{
+		IDeckLinkVideoFrame*	videoFrame;
+		BMDColorspace			colorspace;
+		std::string				filename;
+		std::vector<EncodeBand>	bands;
+		std::atomic<uint32_t>	bandsRemaining;
+	};
+
+	typedef std::pair<std::shared_ptr<EncodeJob>, uint32_t> BandTask;
+
+	ImageFileFormat				m_fileFormat;
+	unsigned					m_bitDepth;
+	int							m_compressionLevel;
+	PNGFilterStrategy			m_filterStrategy;
+	unsigned					m_maxPendingFrames;
+	unsigned					m_threadCount;
+
+	std::vector<std::thread>	m_workerThreads;
+	std::deque<BandTask>		m_bandTasks;
+	unsigned					m_pendingFrames;
+	bool						m_stopWorkers;
+	std::mutex					m_mutex;
+	std::condition_variable		m_taskCondition;
+	std::condition_variable		m_completionCondition;
+
+	std::atomic<unsigned long>	m_encodedFrameCount;
+	std::atomic<unsigned long>	m_failedFrameCount;
+
+	uint32_t					GetBytesPerPixel(void) const { return (m_bitDepth == 16) ? 6 : 4; }
+
+	void						WorkerThread(void);
+	void						EncodeBandData(EncodeJob& job, EncodeBand& band);
+	bool						WritePNGFile(EncodeJob& job);
+	bool						WriteTIFFFile(EncodeJob& job);
+};
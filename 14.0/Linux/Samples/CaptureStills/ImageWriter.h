@@ -40,13 +40,26 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <queue>
 #include <stdint.h>
 #include "DeckLinkAPI.h"
 
-namespace ImageWriter
+// FilenameAllocator names stills <path>/<prefix><sequence><extension>.  The directory is scanned once on
+// construction and the sequence continues from the highest existing number, so allocating a name
+// needs no filesystem access.  Sequence numbers are padded to at least 4 digits and are unbounded.
+class FilenameAllocator
 {
-	HRESULT GetNextFilenameWithPrefix(const std::string& path, const std::string& filenamePrefix, std::string& nextFileName);
-	HRESULT WriteBgra32VideoFrameToPNG(IDeckLinkVideoFrame* bgra32VideoFrame, const std::string& pngFilename);
+public:
+	FilenameAllocator(const std::string& path, const std::string& filenamePrefix, const std::string& extension);
+
+	// Safe to call from multiple threads
+	std::string				GetNextFilename(void);
+
+private:
+	std::string				m_path;
+	std::string				m_filenamePrefix;
+	std::string				m_extension;
+	std::atomic<uint64_t>	m_nextSequence;
 };
\ No newline at end of file
@@ -38,109 +38,58 @@
 ** -LICENSE-END-
 */
 
-#include <png.h>
+#include <dirent.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include "ImageWriter.h"
 
-static const uint32_t kPNGSignatureLength = 8;
-
-HRESULT ImageWriter::GetNextFilenameWithPrefix(const std::string& path, const std::string& filenamePrefix, std::string& nextFileName)
+FilenameAllocator::FilenameAllocator(const std::string& path, const std::string& filenamePrefix, const std::string& extension) :
+	m_path(path),
+	m_filenamePrefix(filenamePrefix),
+	m_extension(extension),
+	m_nextSequence(0)
 {
-	HRESULT	result = E_FAIL;
-	static int idx = 0;
-	struct stat buf;
-
-	while (idx < 10000)
-	{
-		std::stringstream pngFilenameStream;
-		pngFilenameStream << path << '/' << filenamePrefix << std::setfill('0') << std::setw(4) << idx++ << ".png";
-		nextFileName = pngFilenameStream.str();
-
-		// If file does not exist, return S_OK
-		if (stat(nextFileName.c_str(), &buf) != 0)
-		{
-			result = S_OK;
-			break;
-		}
-	}
-	
-	return result;
-}
+	const size_t	extensionLength = extension.length();
+	uint64_t		nextSequence = 0;
+	DIR*			directory;
+	struct dirent*	entry;
 
-HRESULT ImageWriter::WriteBgra32VideoFrameToPNG(IDeckLinkVideoFrame* bgra32VideoFrame, const std::string& pngFilename)
-{
-	bool        result         = E_FAIL;
-	png_structp pngDataPtr     = nullptr;
-	png_infop   pngInfoPtr     = nullptr;
-	png_bytep   deckLinkBuffer = nullptr;
-	png_bytepp  rowPtrs        = nullptr;
+	directory = opendir(path.c_str());
+	if (directory == NULL)
+		return;
 
-	// Ensure video frame has expected pixel format
-	if (bgra32VideoFrame->GetPixelFormat() != bmdFormat8BitBGRA)
-	{
-		fprintf(stderr, "Video frame is not in 8-Bit BGRA pixel format\n");
-		return E_FAIL;
-	}
-	
-	FILE *pngFile = fopen(pngFilename.c_str(), "wb");
-	if (!pngFile)
+	// Find the highest sequence number of files named <prefix><digits><extension>
+	while ((entry = readdir(directory)) != NULL)
 	{
-		fprintf(stderr, "Could not open PNG file %s for writing\n", pngFilename.c_str());
-		return false;
-	}
+		std::string	filename(entry->d_name);
+		size_t		digitCount;
 
-	pngDataPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-	if (!pngDataPtr)
-	{
-		fprintf(stderr, "Could not create PNG write struct\n");
-		goto bail;
-	}
+		if ((filename.length() <= filenamePrefix.length() + extensionLength) ||
+			(filename.compare(0, filenamePrefix.length(), filenamePrefix) != 0) ||
+			(filename.compare(filename.length() - extensionLength, extensionLength, extension) != 0))
+			continue;
 
-	pngInfoPtr = png_create_info_struct(pngDataPtr);
-	if (!pngInfoPtr)
-	{
-		fprintf(stderr, "Could not create PNG info struct\n");
-		goto bail;
-	}
-
-	if (setjmp(png_jmpbuf(pngDataPtr)))
-	{
-		fprintf(stderr, "Failed PNG write initialization\n");
-		goto bail;
-	}
-
-	png_init_io(pngDataPtr, pngFile);
+		digitCount = filename.length() - filenamePrefix.length() - extensionLength;
+		std::string digits = filename.substr(filenamePrefix.length(), digitCount);
 
-	png_set_IHDR(pngDataPtr, pngInfoPtr, bgra32VideoFrame->GetWidth(), bgra32VideoFrame->GetHeight(),
-					8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, 
-					PNG_FILTER_TYPE_BASE);
-	png_write_info(pngDataPtr, pngInfoPtr);
+		if (digits.find_first_not_of("0123456789") != std::string::npos)
+			continue;
 
-	png_set_bgr(pngDataPtr);
-
-	if (bgra32VideoFrame->GetBytes((void**)&deckLinkBuffer) != S_OK)
-	{
-		fprintf(stderr, "Could not get DeckLinkVideoFrame buffer pointer\n");
-		goto bail;
+		nextSequence = std::max<uint64_t>(nextSequence, strtoull(digits.c_str(), NULL, 10) + 1);
 	}
 
-	rowPtrs = (png_bytep*)malloc(sizeof(png_bytep) * bgra32VideoFrame->GetHeight());
-
-	// Set row pointers from the buffer
-	for (uint32_t row = 0; row < bgra32VideoFrame->GetHeight(); ++row)
-		rowPtrs[row] = &deckLinkBuffer[row * bgra32VideoFrame->GetRowBytes()];
+	closedir(directory);
 
-	png_write_image(pngDataPtr, rowPtrs);
-	png_write_end(pngDataPtr, NULL);
+	m_nextSequence = nextSequence;
+}
 
-	result = S_OK;
+std::string FilenameAllocator::GetNextFilename()
+{
+	std::stringstream filenameStream;
 
-bail:
-	fclose(pngFile);
-	png_destroy_write_struct(&pngDataPtr, &pngInfoPtr);
-	free(rowPtrs);
-	
-	return result;
+	filenameStream << m_path << '/' << m_filenamePrefix << std::setfill('0') << std::setw(4) << m_nextSequence++ << m_extension;
+	return filenameStream.str();
 }
@@ -0,0 +1,242 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include "platform.h"
+#include "Rgb48RowUnpacker.h"
+#include "VideoKernels.h"
+
+// Video range 10-bit RGB levels
+static const int32_t	kVideoBlack			= 64;
+static const int32_t	kVideoRange			= 940 - 64;
+
+static inline uint16_t SwapBytes16(uint16_t value)
+{
+	return (uint16_t)((value >> 8) | (value << 8));
+}
+
+static inline uint16_t Clamp16(int32_t value)
+{
+	return (uint16_t)((value < 0) ? 0 : ((value > 0xFFFF) ? 0xFFFF : value));
+}
+
+static void InterleaveRgb(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* rgbRow, uint32_t pixelCount, bool bigEndianOutput)
+{
+	if (bigEndianOutput)
+	{
+		for (uint32_t i = 0; i < pixelCount; i++)
+		{
+			*rgbRow++ = SwapBytes16(red[i]);
+			*rgbRow++ = SwapBytes16(green[i]);
+			*rgbRow++ = SwapBytes16(blue[i]);
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < pixelCount; i++)
+		{
+			*rgbRow++ = red[i];
+			*rgbRow++ = green[i];
+			*rgbRow++ = blue[i];
+		}
+	}
+}
+
+Rgb48RowUnpacker::Rgb48RowUnpacker(BMDPixelFormat pixelFormat, uint32_t width, BMDColorspace colorspace, bool bigEndianOutput) :
+	m_pixelFormat(pixelFormat),
+	m_width(width),
+	m_bigEndianOutput(bigEndianOutput)
+{
+	Colorimetry colorimetry;
+
+	switch (colorspace)
+	{
+		case bmdColorspaceRec601:
+			colorimetry.matrix = kColorimetryRec601;
+			break;
+
+		case bmdColorspaceRec2020:
+			colorimetry.matrix = kColorimetryRec2020;
+			break;
+
+		case bmdColorspaceRec709:
+		default:
+			colorimetry.matrix = kColorimetryRec709;
+			break;
+	}
+
+	// Narrow range YCbCr with co-sited chroma, to full range RGB
+	colorimetry.yuvRange		= kColorimetryNarrowRange;
+	colorimetry.rgbRange		= kColorimetryFullRange;
+	colorimetry.chromaSiting	= kChromaSitingCosited;
+
+	GetColorimetryCoefficients(colorimetry, m_colorimetry);
+
+	if (pixelFormat == bmdFormat10BitYUV)
+	{
+		m_lumaRow.resize(width);
+		m_cbRow.resize((width + 1) / 2);
+		m_crRow.resize((width + 1) / 2);
+	}
+
+	// Video range 10-bit RGB levels expanded to full range 16-bit
+	if (pixelFormat == bmdFormat10BitRGB)
+	{
+		m_r210Levels.resize(1024);
+		for (int32_t level = 0; level < 1024; level++)
+			m_r210Levels[level] = Clamp16((int32_t)lrint((level - kVideoBlack) * 65535.0 / kVideoRange));
+	}
+
+	m_redRow.resize(width);
+	m_greenRow.resize(width);
+	m_blueRow.resize(width);
+}
+
+bool Rgb48RowUnpacker::IsPixelFormatSupported(BMDPixelFormat pixelFormat)
+{
+	switch (pixelFormat)
+	{
+		case bmdFormat10BitYUV:
+		case bmdFormat10BitRGB:
+		case bmdFormat12BitRGB:
+		case bmdFormat12BitRGBLE:
+		case bmdFormat8BitBGRA:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void Rgb48RowUnpacker::UnpackRow(const void* sourceRow, uint16_t* rgbRow)
+{
+	switch (m_pixelFormat)
+	{
+		case bmdFormat10BitYUV:
+			UnpackV210Row((const uint32_t*)sourceRow, rgbRow);
+			break;
+
+		case bmdFormat10BitRGB:
+			UnpackR210Row((const uint32_t*)sourceRow, rgbRow);
+			break;
+
+		case bmdFormat12BitRGB:
+			UnpackR12Row((const uint8_t*)sourceRow, rgbRow, true);
+			break;
+
+		case bmdFormat12BitRGBLE:
+			UnpackR12Row((const uint8_t*)sourceRow, rgbRow, false);
+			break;
+
+		case bmdFormat8BitBGRA:
+			UnpackBgraRow((const uint8_t*)sourceRow, rgbRow);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void Rgb48RowUnpacker::UnpackV210Row(const uint32_t* sourceRow, uint16_t* rgbRow)
+{
+	uint16_t*	red		= m_redRow.data();
+	uint16_t*	green	= m_greenRow.data();
+	uint16_t*	blue	= m_blueRow.data();
+
+	::UnpackV210Row(sourceRow, m_lumaRow.data(), m_cbRow.data(), m_crRow.data(), m_width);
+	ConvertYUV422RowToRGB(m_lumaRow.data(), m_cbRow.data(), m_crRow.data(), red, green, blue, m_width, m_colorimetry);
+
+	InterleaveRgb(red, green, blue, rgbRow, m_width, m_bigEndianOutput);
+}
+
+void Rgb48RowUnpacker::UnpackR210Row(const uint32_t* sourceRow, uint16_t* rgbRow)
+{
+	const uint16_t*	levels	= m_r210Levels.data();
+	uint16_t*		red		= m_redRow.data();
+	uint16_t*		green	= m_greenRow.data();
+	uint16_t*		blue	= m_blueRow.data();
+
+	::UnpackR210Row(sourceRow, red, green, blue, m_width);
+
+	for (uint32_t x = 0; x < m_width; x++)
+	{
+		red[x]		= levels[red[x]];
+		green[x]	= levels[green[x]];
+		blue[x]		= levels[blue[x]];
+	}
+
+	InterleaveRgb(red, green, blue, rgbRow, m_width, m_bigEndianOutput);
+}
+
+void Rgb48RowUnpacker::UnpackR12Row(const uint8_t* sourceRow, uint16_t* rgbRow, bool bigEndianSource)
+{
+	uint16_t*	red		= m_redRow.data();
+	uint16_t*	green	= m_greenRow.data();
+	uint16_t*	blue	= m_blueRow.data();
+
+	::UnpackR12Row(sourceRow, red, green, blue, m_width, bigEndianSource);
+
+	// Scale full range 12-bit samples to 16 bits by replicating the high bits
+	for (uint32_t x = 0; x < m_width; x++)
+	{
+		red[x]		= (uint16_t)((red[x] << 4) | (red[x] >> 8));
+		green[x]	= (uint16_t)((green[x] << 4) | (green[x] >> 8));
+		blue[x]		= (uint16_t)((blue[x] << 4) | (blue[x] >> 8));
+	}
+
+	InterleaveRgb(red, green, blue, rgbRow, m_width, m_bigEndianOutput);
+}
+
+void Rgb48RowUnpacker::UnpackBgraRow(const uint8_t* sourceRow, uint16_t* rgbRow)
+{
+	uint16_t*	red		= m_redRow.data();
+	uint16_t*	green	= m_greenRow.data();
+	uint16_t*	blue	= m_blueRow.data();
+
+	// Scale 8-bit samples to 16 bits by replicating the byte
+	for (uint32_t x = 0; x < m_width; x++, sourceRow += 4)
+	{
+		red[x]		= (uint16_t)(sourceRow[2] * 257);
+		green[x]	= (uint16_t)(sourceRow[1] * 257);
+		blue[x]		= (uint16_t)(sourceRow[0] * 257);
+	}
+
+	InterleaveRgb(red, green, blue, rgbRow, m_width, m_bigEndianOutput);
+}
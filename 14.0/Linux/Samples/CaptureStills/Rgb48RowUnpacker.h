@@ -0,0 +1,92 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "DeckLinkAPI.h"
+#include "VideoKernels.h"
+
+// Rgb48RowUnpacker converts rows of high bit depth captured frames directly to 16-bit per
+// component RGB, without an 8-bit intermediate:
+// * 10-bit YUV (v210) is converted to full range RGB with the Rec.601, Rec.709 or Rec.2020 matrix of the
+//   VideoKernels colorimetry kernels, chroma is upsampled by interpolating co-sited samples,
+// * 10-bit RGB (r210) video levels are expanded to full range,
+// * 12-bit RGB (R12B/R12L) full range samples are scaled to 16 bits,
+// * 8-bit BGRA is scaled to 16 bits, for formats that are first converted with IDeckLinkVideoConversion.
+// Rows are unpacked to planes with the VideoKernels library, converted or scaled on the planes, then
+// interleaved.  r210 levels are expanded with a lookup table.
+class Rgb48RowUnpacker
+{
+public:
+	Rgb48RowUnpacker(BMDPixelFormat pixelFormat, uint32_t width, BMDColorspace colorspace, bool bigEndianOutput);
+
+	static bool					IsPixelFormatSupported(BMDPixelFormat pixelFormat);
+
+	// Unpack one row of width pixels to R, G, B 16-bit samples
+	void						UnpackRow(const void* sourceRow, uint16_t* rgbRow);
+
+private:
+	BMDPixelFormat				m_pixelFormat;
+	uint32_t					m_width;
+	bool						m_bigEndianOutput;
+
+	// YCbCr to full range RGB coefficients for v210
+	ColorimetryCoefficients		m_colorimetry;
+
+	// Planar scratch rows for v210
+	std::vector<uint16_t>		m_lumaRow;
+	std::vector<uint16_t>		m_cbRow;
+	std::vector<uint16_t>		m_crRow;
+
+	// Full range 16-bit level of each 10-bit r210 level
+	std::vector<uint16_t>		m_r210Levels;
+
+	// Planar RGB scratch rows
+	std::vector<uint16_t>		m_redRow;
+	std::vector<uint16_t>		m_greenRow;
+	std::vector<uint16_t>		m_blueRow;
+
+	void						UnpackV210Row(const uint32_t* sourceRow, uint16_t* rgbRow);
+	void						UnpackR210Row(const uint32_t* sourceRow, uint16_t* rgbRow);
+	void						UnpackR12Row(const uint8_t* sourceRow, uint16_t* rgbRow, bool bigEndianSource);
+	void						UnpackBgraRow(const uint8_t* sourceRow, uint16_t* rgbRow);
+};
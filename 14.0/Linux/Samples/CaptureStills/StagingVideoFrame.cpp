@@ -0,0 +1,120 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include "platform.h"
+#include "StagingVideoFrame.h"
+
+/* StagingVideoFrame class */
+
+// Constructor allocates the pixel buffer up front, so that no allocation or page faults occur while staging
+StagingVideoFrame::StagingVideoFrame(long width, long height, long rowBytes, BMDPixelFormat pixelFormat) : 
+	m_width(width), m_height(height), m_rowBytes(rowBytes), m_pixelFormat(pixelFormat), m_flags(bmdFrameFlagDefault), m_refCount(1)
+{
+	// Allocate pixel buffer
+	m_pixelBuffer.resize(m_rowBytes*m_height);
+}
+
+HRESULT StagingVideoFrame::CopyFrom(IDeckLinkVideoFrame* videoFrame)
+{
+	void* sourceBytes;
+
+	if ((videoFrame->GetWidth() != m_width) || (videoFrame->GetHeight() != m_height) ||
+		(videoFrame->GetRowBytes() != m_rowBytes) || (videoFrame->GetPixelFormat() != m_pixelFormat))
+		return E_INVALIDARG;
+
+	if (videoFrame->GetBytes(&sourceBytes) != S_OK)
+		return E_FAIL;
+
+	memcpy(m_pixelBuffer.data(), sourceBytes, m_pixelBuffer.size());
+	m_flags = videoFrame->GetFlags();
+
+	return S_OK;
+}
+
+HRESULT StagingVideoFrame::GetBytes(void **buffer)
+{
+	*buffer = (void*)m_pixelBuffer.data();
+	return S_OK;
+}
+
+HRESULT	STDMETHODCALLTYPE StagingVideoFrame::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	CFUUIDBytes		iunknown;
+	HRESULT 		result = E_NOINTERFACE;
+
+	if (ppv == NULL)
+		return E_INVALIDARG;
+
+	// Initialise the return result
+	*ppv = NULL;
+
+	// Obtain the IUnknown interface and compare it the provided REFIID
+	iunknown = CFUUIDGetUUIDBytes(IUnknownUUID);
+	if (memcmp(&iid, &iunknown, sizeof(REFIID)) == 0)
+	{
+		*ppv = this;
+		AddRef();
+		result = S_OK;
+	}
+	
+	else if (memcmp(&iid, &IID_IDeckLinkVideoFrame, sizeof(REFIID)) == 0)
+	{
+		*ppv = (IDeckLinkVideoFrame*)this;
+		AddRef();
+		result = S_OK;
+	}
+
+	return result;
+}
+
+ULONG STDMETHODCALLTYPE StagingVideoFrame::AddRef(void)
+{
+	return ++m_refCount;
+}
+
+ULONG STDMETHODCALLTYPE StagingVideoFrame::Release(void)
+{
+
+	ULONG newRefValue = --m_refCount;
+	if (newRefValue == 0)
+		delete this;
+
+	return newRefValue;
+}
@@ -39,6 +39,7 @@
 */
 
 #include "platform.h"
+#include "VideoConversion.h"
 
 HRESULT GetDeckLinkIterator(IDeckLinkIterator **deckLinkIterator)
 {
@@ -59,7 +60,8 @@ HRESULT GetDeckLinkVideoConversion(IDeckLinkVideoConversion **deckLinkVideoConve
 {
 	HRESULT result = S_OK;
 
-	*deckLinkVideoConversion = CreateVideoConversionInstance();
+	// Convert frames in software with a thread per CPU
+	*deckLinkVideoConversion = CreateSoftwareVideoConversionInstance();
 	if (*deckLinkVideoConversion == NULL)
 	{
 		fprintf(stderr, "A DeckLink video conversion interface could not be created.\n");
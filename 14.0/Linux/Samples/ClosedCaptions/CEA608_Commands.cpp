@@ -0,0 +1,142 @@
+/* -LICENSE-START-
+ ** Copyright (c) 2024 Blackmagic Design
+ **  
+ ** Permission is hereby granted, free of charge, to any person or organization 
+ ** obtaining a copy of the software and accompanying documentation (the 
+ ** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+ ** and transmit the Software, and to prepare derivative works of the Software, 
+ ** and to permit third-parties to whom the Software is furnished to do so, in 
+ ** accordance with:
+ ** 
+ ** (1) if the Software is obtained from Blackmagic Design, the End User License 
+ ** Agreement for the Software Development Kit (“EULA”) available at 
+ ** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+ ** 
+ ** (2) if the Software is obtained from any third party, such licensing terms 
+ ** as notified by that third party,
+ ** 
+ ** and all subject to the following:
+ ** 
+ ** (3) the copyright notices in the Software and this entire statement, 
+ ** including the above license grant, this restriction and the following 
+ ** disclaimer, must be included in all copies of the Software, in whole or in 
+ ** part, and all derivative works of the Software, unless such copies or 
+ ** derivative works are solely in the form of machine-executable object code 
+ ** generated by a source language processor.
+ ** 
+ ** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+ ** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ ** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ ** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ ** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ ** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ ** DEALINGS IN THE SOFTWARE.
+ ** 
+ ** A copy of the Software is available free of charge at 
+ ** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+ ** 
+ ** -LICENSE-END-
+ */
+
+#include "CEA608_Commands.h"
+
+namespace CEA608
+{
+
+// The first byte of a control code selects the second channel of the field with 0x08
+static uint8_t ChannelBit(Channel channel)
+{
+	return (channel == channel_CC2 || channel == channel_CC4) ? 0x08 : 0x00;
+}
+
+// Miscellaneous control codes are 0x14 in field 1 and 0x15 in field 2
+static ControlCode MiscellaneousControl(Channel channel, uint8_t code)
+{
+	ControlCode cmd;
+	cmd.field = ChannelField(channel);
+	cmd.data1 = (cmd.field == field_1 ? 0x14 : 0x15) | ChannelBit(channel);
+	cmd.data2 = code;
+	return cmd;
+}
+
+ControlCode ResumeCaptionLoading(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x20);
+}
+
+ControlCode Backspace(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x21);
+}
+
+ControlCode DeleteToEndOfRow(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x24);
+}
+
+ControlCode RollUpCaptions(Channel channel, uint8_t rows)
+{
+	if (rows < 2)
+		rows = 2;
+	else if (rows > 4)
+		rows = 4;
+	return MiscellaneousControl(channel, 0x25 + rows - 2);
+}
+
+ControlCode ResumeDirectCaptioning(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x29);
+}
+
+ControlCode EraseDisplayedMemory(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x2C);
+}
+
+ControlCode CarriageReturn(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x2D);
+}
+
+ControlCode EraseNonDisplayedMemory(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x2E);
+}
+
+ControlCode EndOfCaption(Channel channel)
+{
+	return MiscellaneousControl(channel, 0x2F);
+}
+
+ControlCode TabOffset(Channel channel, uint8_t columns)
+{
+	ControlCode cmd;
+	cmd.field = ChannelField(channel);
+	cmd.data1 = 0x17 | ChannelBit(channel);
+	cmd.data2 = 0x20 + (columns < 1 ? 1 : columns > 3 ? 3 : columns);
+	return cmd;
+}
+
+ControlCode PreambleAddress(Channel channel, uint8_t row, uint8_t indent, bool underline)
+{
+	// First byte and upper half (0x20) of the second byte for rows 1 to 15
+	static const uint8_t kRowCodes[15][2] =
+	{
+		{ 0x11, 0x00 }, { 0x11, 0x20 }, { 0x12, 0x00 }, { 0x12, 0x20 }, { 0x15, 0x00 },
+		{ 0x15, 0x20 }, { 0x16, 0x00 }, { 0x16, 0x20 }, { 0x17, 0x00 }, { 0x17, 0x20 },
+		{ 0x10, 0x00 }, { 0x13, 0x00 }, { 0x13, 0x20 }, { 0x14, 0x00 }, { 0x14, 0x20 }
+	};
+
+	if (row < 1)
+		row = 1;
+	else if (row > 15)
+		row = 15;
+
+	ControlCode cmd;
+	cmd.field = ChannelField(channel);
+	cmd.data1 = kRowCodes[row - 1][0] | ChannelBit(channel);
+	cmd.data2 = 0x40 | kRowCodes[row - 1][1] | 0x10 | (((indent / 4) & 0x7) << 1) | (underline ? 1 : 0);
+	return cmd;
+}
+
+}
@@ -0,0 +1,106 @@
+/* -LICENSE-START-
+ ** Copyright (c) 2024 Blackmagic Design
+ **  
+ ** Permission is hereby granted, free of charge, to any person or organization 
+ ** obtaining a copy of the software and accompanying documentation (the 
+ ** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+ ** and transmit the Software, and to prepare derivative works of the Software, 
+ ** and to permit third-parties to whom the Software is furnished to do so, in 
+ ** accordance with:
+ ** 
+ ** (1) if the Software is obtained from Blackmagic Design, the End User License 
+ ** Agreement for the Software Development Kit (“EULA”) available at 
+ ** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+ ** 
+ ** (2) if the Software is obtained from any third party, such licensing terms 
+ ** as notified by that third party,
+ ** 
+ ** and all subject to the following:
+ ** 
+ ** (3) the copyright notices in the Software and this entire statement, 
+ ** including the above license grant, this restriction and the following 
+ ** disclaimer, must be included in all copies of the Software, in whole or in 
+ ** part, and all derivative works of the Software, unless such copies or 
+ ** derivative works are solely in the form of machine-executable object code 
+ ** generated by a source language processor.
+ ** 
+ ** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+ ** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ ** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ ** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ ** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ ** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ ** DEALINGS IN THE SOFTWARE.
+ ** 
+ ** A copy of the Software is available free of charge at 
+ ** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+ ** 
+ ** -LICENSE-END-
+ */
+
+#ifndef __CEA608_COMMANDS_H__
+#define __CEA608_COMMANDS_H__
+#include <stdint.h>
+
+namespace CEA608
+{
+
+/* Defines the control codes of CEA-608 (line 21) captions, carried as compatibility bytes in the cc_data of a CDP.
+ * References below refer to CEA-608.
+ *
+ * Each field carries a pair of bytes per frame of 29.97 fps video.  Each byte has odd parity in its most significant
+ * bit, the codes below are 7-bit and the parity is added by the encoder.
+ */
+
+// 8.2 Data Channels, CC1 and CC2 are carried in field 1, CC3 and CC4 in field 2
+enum Field
+{
+	field_1 = 0,
+	field_2
+};
+
+enum Channel
+{
+	channel_CC1 = 0,
+	channel_CC2,
+	channel_CC3,
+	channel_CC4
+};
+
+inline Field ChannelField(Channel channel)
+{
+	return channel < channel_CC3 ? field_1 : field_2;
+}
+
+// Adds odd parity to a 7-bit code
+inline uint8_t AddOddParity(uint8_t code)
+{
+	return (code & 0x7F) | (__builtin_parity(code & 0x7F) ? 0x00 : 0x80);
+}
+
+// A control code of a data channel.  Control codes are sent twice, as decoders discard a repeated control code.
+struct ControlCode
+{
+	Field	field;
+	uint8_t	data1;
+	uint8_t	data2;
+};
+
+// Table 51 Miscellaneous Control Codes
+ControlCode ResumeCaptionLoading(Channel channel);			// RCL, pop-on captions
+ControlCode Backspace(Channel channel);						// BS
+ControlCode DeleteToEndOfRow(Channel channel);				// DER
+ControlCode RollUpCaptions(Channel channel, uint8_t rows);	// RU2, RU3 or RU4
+ControlCode ResumeDirectCaptioning(Channel channel);		// RDC, paint-on captions
+ControlCode EraseDisplayedMemory(Channel channel);			// EDM
+ControlCode CarriageReturn(Channel channel);				// CR
+ControlCode EraseNonDisplayedMemory(Channel channel);		// ENM
+ControlCode EndOfCaption(Channel channel);					// EOC, flips the memories
+ControlCode TabOffset(Channel channel, uint8_t columns);	// TO1, TO2 or TO3
+
+// Table 53 Preamble Address Codes, `row` is 1 to 15 and `indent` is 0 to 28 in steps of 4 columns
+ControlCode PreambleAddress(Channel channel, uint8_t row, uint8_t indent, bool underline);
+
+}
+
+#endif
@@ -0,0 +1,415 @@
+/* -LICENSE-START-
+ ** Copyright (c) 2024 Blackmagic Design
+ **  
+ ** Permission is hereby granted, free of charge, to any person or organization 
+ ** obtaining a copy of the software and accompanying documentation (the 
+ ** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+ ** and transmit the Software, and to prepare derivative works of the Software, 
+ ** and to permit third-parties to whom the Software is furnished to do so, in 
+ ** accordance with:
+ ** 
+ ** (1) if the Software is obtained from Blackmagic Design, the End User License 
+ ** Agreement for the Software Development Kit (“EULA”) available at 
+ ** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+ ** 
+ ** (2) if the Software is obtained from any third party, such licensing terms 
+ ** as notified by that third party,
+ ** 
+ ** and all subject to the following:
+ ** 
+ ** (3) the copyright notices in the Software and this entire statement, 
+ ** including the above license grant, this restriction and the following 
+ ** disclaimer, must be included in all copies of the Software, in whole or in 
+ ** part, and all derivative works of the Software, unless such copies or 
+ ** derivative works are solely in the form of machine-executable object code 
+ ** generated by a source language processor.
+ ** 
+ ** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+ ** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ ** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ ** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ ** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ ** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ ** DEALINGS IN THE SOFTWARE.
+ ** 
+ ** A copy of the Software is available free of charge at 
+ ** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+ ** 
+ ** -LICENSE-END-
+ */
+
+#include "CEA608_Decoder.h"
+#include <cstring>
+
+namespace CEA608
+{
+
+static const uint16_t	kSolidBlock = 0x2588;
+
+// Table 50 Character Set, the characters of 0x20 - 0x7F which differ from ASCII
+static uint16_t BasicCharacter(uint8_t code)
+{
+	switch (code)
+	{
+		case 0x2A:	return 0x00E1;		// á
+		case 0x5C:	return 0x00E9;		// é
+		case 0x5E:	return 0x00ED;		// í
+		case 0x5F:	return 0x00F3;		// ó
+		case 0x60:	return 0x00FA;		// ú
+		case 0x7B:	return 0x00E7;		// ç
+		case 0x7C:	return 0x00F7;		// ÷
+		case 0x7D:	return 0x00D1;		// Ñ
+		case 0x7E:	return 0x00F1;		// ñ
+		case 0x7F:	return kSolidBlock;
+	}
+	return code;
+}
+
+// Table 50 Special Characters, 0x11 0x30 - 0x3F, the transparent space is a space
+static const uint16_t kSpecialCharacters[16] =
+{
+	0x00AE, 0x00B0, 0x00BD, 0x00BF, 0x2122, 0x00A2, 0x00A3, 0x266A, 0x00E0, 0x0020, 0x00E8, 0x00E2, 0x00EA, 0x00EE, 0x00F4, 0x00FB
+};
+
+// Annex B Extended Characters, 0x12 0x20 - 0x3F and 0x13 0x20 - 0x3F
+static const uint16_t kExtendedCharacters[2][32] =
+{
+	{
+		0x00C1, 0x00C9, 0x00D3, 0x00DA, 0x00DC, 0x00FC, 0x2018, 0x00A1, 0x002A, 0x0027, 0x2014, 0x00A9, 0x2120, 0x2022, 0x201C, 0x201D,
+		0x00C0, 0x00C2, 0x00C7, 0x00C8, 0x00CA, 0x00CB, 0x00EB, 0x00CE, 0x00CF, 0x00EF, 0x00D4, 0x00D9, 0x00F9, 0x00DB, 0x00AB, 0x00BB
+	},
+	{
+		0x00C3, 0x00E3, 0x00CD, 0x00CC, 0x00EC, 0x00D2, 0x00F2, 0x00D5, 0x00F5, 0x007B, 0x007D, 0x005C, 0x005E, 0x005F, 0x007C, 0x007E,
+		0x00C4, 0x00E4, 0x00D6, 0x00F6, 0x00DF, 0x00A5, 0x00A4, 0x00A6, 0x00C5, 0x00E5, 0x00D8, 0x00F8, 0x250C, 0x2510, 0x2514, 0x2518
+	}
+};
+
+// Table 53 Preamble Address Codes, rows 1 to 15 of the first byte 0x10 - 0x17 and the upper half (0x20) of the second
+// byte, 0 is not a row
+static const uint8_t kPreambleRows[8][2] =
+{
+	{ 11, 0 }, { 1, 2 }, { 3, 4 }, { 12, 13 }, { 14, 15 }, { 5, 6 }, { 7, 8 }, { 9, 10 }
+};
+
+static size_t EncodeUTF8(uint16_t character, char* utf8)
+{
+	if (character < 0x80)
+	{
+		utf8[0] = static_cast<char>(character);
+		return 1;
+	}
+	if (character < 0x800)
+	{
+		utf8[0] = static_cast<char>(0xC0 | (character >> 6));
+		utf8[1] = static_cast<char>(0x80 | (character & 0x3F));
+		return 2;
+	}
+	utf8[0] = static_cast<char>(0xE0 | (character >> 12));
+	utf8[1] = static_cast<char>(0x80 | ((character >> 6) & 0x3F));
+	utf8[2] = static_cast<char>(0x80 | (character & 0x3F));
+	return 3;
+}
+
+//=====================================================================
+
+Decoder::Decoder(DecoderListener* listener, Channel channel)
+: m_listener(listener), m_channel(channel), m_statistics()
+{
+	reset();
+	m_changed = false;
+}
+
+void Decoder::reset()
+{
+	std::memset(m_memories, 0, sizeof(m_memories));
+	m_displayedMemory = 0;
+	m_mode = mode_None;
+	m_rollUpRows = 2;
+	m_row = kRows - 1;
+	m_column = 0;
+	m_channelSelected = false;
+	m_extendedData = false;
+	m_lastControlCode[0] = 0;
+	m_lastControlCode[1] = 0;
+	m_changed = true;
+}
+
+// Pop-on captions are loaded into the non-displayed memory, roll-up and paint-on captions into the displayed memory
+uint16_t (*Decoder::targetMemory())[Decoder::kColumns]
+{
+	return m_memories[m_mode == mode_PopOn ? m_displayedMemory ^ 1 : m_displayedMemory];
+}
+
+void Decoder::writeCharacter(uint16_t character)
+{
+	if (m_mode == mode_None || m_mode == mode_Text)
+		return;
+
+	// The cursor stays in the last column, which is overwritten by the following characters
+	targetMemory()[m_row][m_column] = character;
+	if (m_column < kColumns - 1)
+		m_column++;
+
+	m_changed |= (m_mode != mode_PopOn);
+}
+
+void Decoder::clearMemory(uint8_t memory)
+{
+	std::memset(m_memories[memory], 0, sizeof(m_memories[memory]));
+}
+
+// 9.2 Roll-up, the rows of the roll-up window move up one row and the base row is erased
+void Decoder::rollUp()
+{
+	uint16_t (*memory)[kColumns] = m_memories[m_displayedMemory];
+	int top = m_row + 1 - m_rollUpRows;
+
+	for (int row = top < 0 ? 0 : top; row < m_row; row++)
+		std::memcpy(memory[row], memory[row + 1], sizeof(memory[row]));
+
+	if (top > 0)
+		std::memset(memory[top - 1], 0, sizeof(memory[top - 1]));
+	std::memset(memory[m_row], 0, sizeof(memory[m_row]));
+
+	m_column = 0;
+	m_changed = true;
+}
+
+// Table 51 Miscellaneous Control Codes
+void Decoder::interpretMiscellaneous(uint8_t code)
+{
+	uint16_t (*memory)[kColumns] = targetMemory();
+
+	switch (code)
+	{
+		case 0x20:	// RCL
+			m_mode = mode_PopOn;
+			break;
+		case 0x21:	// BS
+			if (m_column > 0)
+			{
+				memory[m_row][--m_column] = 0;
+				m_changed |= (m_mode != mode_PopOn);
+			}
+			break;
+		case 0x24:	// DER
+			std::memset(&memory[m_row][m_column], 0, (kColumns - m_column) * sizeof(memory[0][0]));
+			m_changed |= (m_mode != mode_PopOn);
+			break;
+		case 0x25:	// RU2
+		case 0x26:	// RU3
+		case 0x27:	// RU4
+			if (m_mode != mode_RollUp)
+			{
+				// Roll-up captions start on the bottom row, from an erased screen
+				clearMemory(m_displayedMemory);
+				clearMemory(m_displayedMemory ^ 1);
+				m_row = kRows - 1;
+				m_column = 0;
+				m_changed = true;
+			}
+			m_mode = mode_RollUp;
+			m_rollUpRows = code - 0x23;
+			if (m_row + 1 < m_rollUpRows)
+				m_row = m_rollUpRows - 1;
+			break;
+		case 0x29:	// RDC
+			m_mode = mode_PaintOn;
+			break;
+		case 0x2A:	// TR
+		case 0x2B:	// RTD
+			m_mode = mode_Text;
+			break;
+		case 0x2C:	// EDM
+			clearMemory(m_displayedMemory);
+			m_changed = true;
+			break;
+		case 0x2D:	// CR
+			if (m_mode == mode_RollUp)
+				rollUp();
+			break;
+		case 0x2E:	// ENM
+			clearMemory(m_displayedMemory ^ 1);
+			break;
+		case 0x2F:	// EOC
+			m_displayedMemory ^= 1;
+			m_mode = mode_PopOn;
+			m_changed = true;
+			break;
+		default:
+			// AOF, AON and FON
+			break;
+	}
+}
+
+// Table 53 Preamble Address Codes, the row and the indent of the following characters
+void Decoder::interpretPreambleAddress(uint8_t data1, uint8_t data2)
+{
+	uint8_t row = kPreambleRows[data1 & 0x7][(data2 & 0x20) ? 1 : 0];
+	if (row == 0)
+		return;
+
+	m_row = row - 1;
+	if (m_mode == mode_RollUp && m_row + 1 < m_rollUpRows)
+		m_row = m_rollUpRows - 1;
+
+	// Indent codes are 0x50 - 0x5F, the colour and italics codes start at the first column
+	m_column = (data2 & 0x10) ? ((data2 >> 1) & 0x7) * 4 : 0;
+}
+
+// `data1` is the control code of the first channel of the field
+void Decoder::interpretControlCode(uint8_t data1, uint8_t data2)
+{
+	if (data2 >= 0x40)
+		interpretPreambleAddress(data1, data2);
+	else if ((data1 == 0x14 || data1 == 0x15) && data2 < 0x30)
+		interpretMiscellaneous(data2);
+	else if (data1 == 0x17 && data2 >= 0x21 && data2 <= 0x23)
+	{
+		// TO1 - TO3
+		m_column += data2 - 0x20;
+		if (m_column >= kColumns)
+			m_column = kColumns - 1;
+	}
+	else if (data1 == 0x11 && data2 < 0x30)
+		writeCharacter(' ');	// Mid-row codes are shown as a space
+	else if (data1 == 0x11)
+		writeCharacter(kSpecialCharacters[data2 - 0x30]);
+	else if (data1 == 0x12 || data1 == 0x13)
+	{
+		// An extended character replaces the basic character sent before it for older decoders
+		if (m_column > 0)
+			m_column--;
+		writeCharacter(kExtendedCharacters[data1 - 0x12][data2 - 0x20]);
+	}
+}
+
+void Decoder::push(Field field, uint8_t data1, uint8_t data2)
+{
+	if (field != ChannelField(m_channel))
+		return;
+
+	++m_statistics.pairs;
+
+	const bool		parity1 = __builtin_parity(data1);
+	const bool		parity2 = __builtin_parity(data2);
+	const uint8_t	code1 = data1 & 0x7F;
+	const uint8_t	code2 = data2 & 0x7F;
+
+	if (code1 == 0 && code2 == 0)
+		return;		// Null pair
+
+	if (code1 >= 0x10 && code1 < 0x20)
+	{
+		if (!parity1 || !parity2)
+		{
+			++m_statistics.parityErrors;
+			m_lastControlCode[0] = 0;
+			return;
+		}
+
+		if (code2 < 0x20)
+			return;		// Not a control code
+
+		if (code1 == m_lastControlCode[0] && code2 == m_lastControlCode[1])
+		{
+			++m_statistics.repeatedControlCodes;
+			m_lastControlCode[0] = 0;
+			return;
+		}
+
+		m_lastControlCode[0] = code1;
+		m_lastControlCode[1] = code2;
+		m_extendedData = false;
+
+		// The control code selects the data channel of the following characters
+		m_channelSelected = ((code1 & 0x08) != 0) == (m_channel == channel_CC2 || m_channel == channel_CC4);
+		if (m_channelSelected)
+			interpretControlCode(code1 & ~0x08, code2);
+		return;
+	}
+
+	m_lastControlCode[0] = 0;
+
+	// 0x01 - 0x0F are the XDS packets of field 2, which continue until the end code 0x0F
+	if (code1 != 0 && code1 < 0x10)
+	{
+		m_extendedData = (code1 != 0x0F);
+		return;
+	}
+
+	if (m_extendedData || !m_channelSelected)
+		return;
+
+	if (!parity1 || !parity2)
+		++m_statistics.parityErrors;
+
+	// 7.3 Characters with a parity error are shown as a solid block
+	if (code1 >= 0x20)
+		writeCharacter(parity1 ? BasicCharacter(code1) : kSolidBlock);
+	if (code2 >= 0x20)
+		writeCharacter(parity2 ? BasicCharacter(code2) : kSolidBlock);
+}
+
+void Decoder::flush()
+{
+	if (!m_changed)
+		return;
+
+	m_changed = false;
+	if (m_listener)
+		m_listener->captionsChanged(m_channel, *this);
+}
+
+size_t Decoder::rowText(uint8_t row, char* utf8, size_t size) const
+{
+	size_t	length = 0;
+	int		lastColumn = -1;
+
+	if (size == 0)
+		return 0;
+
+	if (row < kRows)
+	{
+		const uint16_t* text = m_memories[m_displayedMemory][row];
+
+		for (int column = 0; column < kColumns; ++column)
+		{
+			if (text[column] != 0)
+				lastColumn = column;
+		}
+
+		// Empty cells before the last character are spaces
+		for (int column = 0; column <= lastColumn; ++column)
+		{
+			char	character[3];
+			size_t	characterLength = EncodeUTF8(text[column] ? text[column] : ' ', character);
+
+			if (length + characterLength >= size)
+				break;
+
+			std::memcpy(utf8 + length, character, characterLength);
+			length += characterLength;
+		}
+	}
+
+	utf8[length] = '\0';
+	return length;
+}
+
+Channel Decoder::channel() const
+{
+	return m_channel;
+}
+
+Decoder::Mode Decoder::mode() const
+{
+	return m_mode;
+}
+
+const DecoderStatistics& Decoder::statistics() const
+{
+	return m_statistics;
+}
+
+}
@@ -0,0 +1,140 @@
+/* -LICENSE-START-
+ ** Copyright (c) 2024 Blackmagic Design
+ **  
+ ** Permission is hereby granted, free of charge, to any person or organization 
+ ** obtaining a copy of the software and accompanying documentation (the 
+ ** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+ ** and transmit the Software, and to prepare derivative works of the Software, 
+ ** and to permit third-parties to whom the Software is furnished to do so, in 
+ ** accordance with:
+ ** 
+ ** (1) if the Software is obtained from Blackmagic Design, the End User License 
+ ** Agreement for the Software Development Kit (“EULA”) available at 
+ ** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+ ** 
+ ** (2) if the Software is obtained from any third party, such licensing terms 
+ ** as notified by that third party,
+ ** 
+ ** and all subject to the following:
+ ** 
+ ** (3) the copyright notices in the Software and this entire statement, 
+ ** including the above license grant, this restriction and the following 
+ ** disclaimer, must be included in all copies of the Software, in whole or in 
+ ** part, and all derivative works of the Software, unless such copies or 
+ ** derivative works are solely in the form of machine-executable object code 
+ ** generated by a source language processor.
+ ** 
+ ** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+ ** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ ** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ ** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ ** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ ** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ ** DEALINGS IN THE SOFTWARE.
+ ** 
+ ** A copy of the Software is available free of charge at 
+ ** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+ ** 
+ ** -LICENSE-END-
+ */
+
+#ifndef __CEA608_DECODER_H__
+#define __CEA608_DECODER_H__
+#include <stddef.h>
+#include <stdint.h>
+#include "CEA608_Commands.h"
+
+namespace CEA608
+{
+
+class Decoder;
+
+
+// Counts of the pairs of the decoded channel's field
+struct DecoderStatistics
+{
+	uint64_t	pairs;					// Pairs received, including nulls
+	uint64_t	parityErrors;			// Control codes discarded, or characters shown as a solid block, for their parity
+	uint64_t	repeatedControlCodes;	// Repeated control codes which were discarded
+};
+
+
+/* Receives the decoded captions.
+ * captionsChanged() is called by flush(), when the displayed memory has changed since the last flush(). */
+class DecoderListener
+{
+public:
+	virtual ~DecoderListener() {}
+	virtual void captionsChanged(Channel channel, const Decoder& decoder) = 0;
+};
+
+
+/* Decodes the pop-on, roll-up and paint-on captions of one CEA-608 data channel into its displayed memory.
+ * The pairs of both fields may be pushed, the pairs of the other field are ignored, as are text mode and XDS.
+ * All state is held in fixed size members, so decoding does not allocate memory.  A Decoder is used by one thread.
+ * The CEA-708 Decoder pushes the 608 compatibility bytes of each CDP to a Decoder, see CEA708_Decoder.h. */
+class Decoder
+{
+public:
+	enum
+	{
+		kRows = 15,				// 8.5 Screen Format
+		kColumns = 32
+	};
+
+	enum Mode
+	{
+		mode_None = 0,
+		mode_PopOn,
+		mode_RollUp,
+		mode_PaintOn,
+		mode_Text
+	};
+
+private:
+	DecoderListener*	m_listener;
+	Channel				m_channel;
+	DecoderStatistics	m_statistics;
+	uint16_t			m_memories[2][kRows][kColumns];	// Unicode characters, 0 is an empty cell
+	uint8_t				m_displayedMemory;				// Index of the displayed memory
+	Mode				m_mode;
+	uint8_t				m_rollUpRows;
+	uint8_t				m_row;
+	uint8_t				m_column;
+	bool				m_channelSelected;				// The last control code of the field was of this channel
+	bool				m_extendedData;					// XDS packet of field 2 is being received
+	uint8_t				m_lastControlCode[2];			// Control code which is discarded if it is repeated
+	bool				m_changed;
+
+	uint16_t (*targetMemory())[kColumns];
+	void writeCharacter(uint16_t character);
+	void clearMemory(uint8_t memory);
+	void rollUp();
+	void interpretControlCode(uint8_t data1, uint8_t data2);
+	void interpretMiscellaneous(uint8_t code);
+	void interpretPreambleAddress(uint8_t data1, uint8_t data2);
+
+public:
+	explicit Decoder(DecoderListener* listener, Channel channel = channel_CC1);
+
+	// Decode a pair of the field with its parity, as the cc_data_1 and cc_data_2 of cc_type 0 or 1
+	void push(Field field, uint8_t data1, uint8_t data2);
+
+	// Call the listener if the displayed memory has changed since the last flush()
+	void flush();
+
+	/* Write a row of the displayed memory as a NUL terminated UTF-8 string, without trailing empty cells.
+	 * Returns the length of the string, which is truncated to fit `size` bytes. */
+	size_t rowText(uint8_t row, char* utf8, size_t size) const;
+
+	Channel channel() const;
+	Mode mode() const;
+	const DecoderStatistics& statistics() const;
+
+	// Erase the memories and wait for the next control code of the channel
+	void reset();
+};
+
+}
+
+#endif
@@ -0,0 +1,852 @@
+/* -LICENSE-START-
+ ** Copyright (c) 2024 Blackmagic Design
+ **  
+ ** Permission is hereby granted, free of charge, to any person or organization 
+ ** obtaining a copy of the software and accompanying documentation (the 
+ ** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+ ** and transmit the Software, and to prepare derivative works of the Software, 
+ ** and to permit third-parties to whom the Software is furnished to do so, in 
+ ** accordance with:
+ ** 
+ ** (1) if the Software is obtained from Blackmagic Design, the End User License 
+ ** Agreement for the Software Development Kit (“EULA”) available at 
+ ** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+ ** 
+ ** (2) if the Software is obtained from any third party, such licensing terms 
+ ** as notified by that third party,
+ ** 
+ ** and all subject to the following:
+ ** 
+ ** (3) the copyright notices in the Software and this entire statement, 
+ ** including the above license grant, this restriction and the following 
+ ** disclaimer, must be included in all copies of the Software, in whole or in 
+ ** part, and all derivative works of the Software, unless such copies or 
+ ** derivative works are solely in the form of machine-executable object code 
+ ** generated by a source language processor.
+ ** 
+ ** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+ ** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ ** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ ** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ ** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ ** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ ** DEALINGS IN THE SOFTWARE.
+ ** 
+ ** A copy of the Software is available free of charge at 
+ ** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+ ** 
+ ** -LICENSE-END-
+ */
+
+#include "CEA708_Decoder.h"
+#include <cstring>
+
+namespace CEA708
+{
+
+static const uint16_t	kMusicNote = 0x266A;
+
+// CEA-708 7.1.8 G2 Code Set - Extended Miscellaneous Characters, as Unicode from 0x20
+// Characters which are not defined are substituted by an underscore, as 7.1.8 recommends
+static const uint16_t kG2Characters[96] =
+{
+	0x0020, 0x00A0, 0x005F, 0x005F, 0x005F, 0x2026, 0x005F, 0x005F, 0x005F, 0x005F, 0x0160, 0x005F, 0x0152, 0x005F, 0x005F, 0x005F,
+	0x2588, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x005F, 0x005F, 0x005F, 0x2122, 0x0161, 0x005F, 0x0153, 0x2120, 0x005F, 0x0178,
+	0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F,
+	0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F,
+	0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F,
+	0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x005F, 0x215B, 0x215C, 0x215D, 0x215E, 0x2502, 0x2510, 0x2514, 0x2500, 0x2518, 0x250C
+};
+
+// CEA-708 Table 17 Predefined Window Style IDs, styles 1 to 7
+struct PredefinedWindowStyle
+{
+	Justify			justify;
+	uint8_t			printDirection;		// 8.4.9.2, top to bottom is 2
+	ScrollDirection	scrollDirection;
+	Opacity			fillOpacity;
+};
+
+static const PredefinedWindowStyle kWindowStyles[7] =
+{
+	{ justify_Left,		printDirection_LeftToRight,	scrollDirection_BottomToTop,	opacity_Solid },
+	{ justify_Left,		printDirection_LeftToRight,	scrollDirection_BottomToTop,	opacity_Transparent },
+	{ justify_Center,	printDirection_LeftToRight,	scrollDirection_BottomToTop,	opacity_Solid },
+	{ justify_Left,		printDirection_LeftToRight,	scrollDirection_BottomToTop,	opacity_Solid },
+	{ justify_Left,		printDirection_LeftToRight,	scrollDirection_BottomToTop,	opacity_Transparent },
+	{ justify_Center,	printDirection_LeftToRight,	scrollDirection_BottomToTop,	opacity_Solid },
+	{ justify_Left,		2,							scrollDirection_RightToLeft,	opacity_Solid }
+};
+
+// CEA-708 Table 18 Predefined Pen Style IDs, styles 1 to 7
+struct PredefinedPenStyle
+{
+	Font			font;
+	Opacity			backgroundOpacity;
+	EdgeType		edgeType;
+};
+
+static const PredefinedPenStyle kPenStyles[7] =
+{
+	{ font_Default,				opacity_Solid,			edgeType_None },
+	{ font_MonospaceSerif,		opacity_Solid,			edgeType_None },
+	{ font_ProportionalSerif,	opacity_Solid,			edgeType_None },
+	{ font_MonospaceSans,		opacity_Solid,			edgeType_None },
+	{ font_ProportionalSans,	opacity_Solid,			edgeType_None },
+	{ font_MonospaceSans,		opacity_Transparent,	edgeType_Uniform },
+	{ font_ProportionalSans,	opacity_Transparent,	edgeType_Uniform }
+};
+
+static void ApplyWindowStyle(DecodedWindow& window, uint8_t style)
+{
+	const PredefinedWindowStyle& predefined = kWindowStyles[style - 1];
+
+	window.windowStyle		= static_cast<WindowStyle>(style);
+	window.justify			= predefined.justify;
+	window.printDirection	= static_cast<PrintDirection>(predefined.printDirection);
+	window.scrollDirection	= predefined.scrollDirection;
+	window.wordwrap			= false;
+	window.displayEffect	= displayEffect_Snap;
+	window.effectDirection	= effectDirection_LeftToRight;
+	window.effectSpeed		= 0;
+	window.fillColour		= colour_Black;
+	window.fillOpacity		= predefined.fillOpacity;
+	window.borderType		= borderType_None;
+	window.borderColour		= colour_Black;
+}
+
+static void ApplyPenStyle(DecodedWindow& window, uint8_t style)
+{
+	const PredefinedPenStyle& predefined = kPenStyles[style - 1];
+
+	window.penStyle					= static_cast<PenStyle>(style);
+	window.pen.size					= penSize_Standard;
+	window.pen.font					= predefined.font;
+	window.pen.textTag				= textTag_Dialog;
+	window.pen.offset				= textOffset_Normal;
+	window.pen.italic				= false;
+	window.pen.underline			= false;
+	window.pen.edgeType				= predefined.edgeType;
+	window.pen.foregroundColour		= colour_White;
+	window.pen.foregroundOpacity	= opacity_Solid;
+	window.pen.backgroundColour		= colour_Black;
+	window.pen.backgroundOpacity	= predefined.backgroundOpacity;
+	window.pen.edgeColour			= colour_Black;
+}
+
+static size_t EncodeUTF8(uint16_t character, char* utf8)
+{
+	if (character < 0x80)
+	{
+		utf8[0] = static_cast<char>(character);
+		return 1;
+	}
+	if (character < 0x800)
+	{
+		utf8[0] = static_cast<char>(0xC0 | (character >> 6));
+		utf8[1] = static_cast<char>(0x80 | (character & 0x3F));
+		return 2;
+	}
+	utf8[0] = static_cast<char>(0xE0 | (character >> 12));
+	utf8[1] = static_cast<char>(0x80 | ((character >> 6) & 0x3F));
+	utf8[2] = static_cast<char>(0x80 | (character & 0x3F));
+	return 3;
+}
+
+//=====================================================================
+
+ServiceDecoder::ServiceDecoder()
+{
+	reset();
+	m_changed = false;
+}
+
+void ServiceDecoder::reset()
+{
+	std::memset(m_windows, 0, sizeof(m_windows));
+	m_currentWindow = -1;
+	m_changed = true;
+}
+
+void ServiceDecoder::clearWindow(DecodedWindow& window)
+{
+	std::memset(window.text, 0, sizeof(window.text));
+	window.penRow = 0;
+	window.penColumn = 0;
+}
+
+// 8.10.5.2 DEFINE WINDOW, the inverse of DefineWindow()
+void ServiceDecoder::defineWindow(uint8_t windowID, const uint8_t* parameters)
+{
+	DecodedWindow&	window = m_windows[windowID];
+	uint8_t			windowStyle = (parameters[5] >> 3) & 0x7;
+	uint8_t			penStyle = parameters[5] & 0x7;
+	uint8_t			rowCount = (parameters[3] & 0xF) + 1;
+	uint8_t			columnCount = (parameters[4] & 0x3F) + 1;
+
+	if (!window.defined)
+	{
+		// A new window takes style 1 for a style of 0, a defined window keeps its style
+		clearWindow(window);
+		ApplyWindowStyle(window, windowStyle ? windowStyle : (uint8_t)windowStyle_NTSCPopup);
+		ApplyPenStyle(window, penStyle ? penStyle : (uint8_t)penStyle_NTSC);
+		window.defined = true;
+	}
+	else
+	{
+		if (windowStyle)
+			ApplyWindowStyle(window, windowStyle);
+		if (penStyle)
+			ApplyPenStyle(window, penStyle);
+	}
+
+	window.visible				= (parameters[0] >> 5) & 0x1;
+	window.rowLock				= (parameters[0] >> 4) & 0x1;
+	window.columnLock			= (parameters[0] >> 3) & 0x1;
+	window.priority				= static_cast<Priority>(parameters[0] & 0x7);
+	window.relativePositioning	= (parameters[1] >> 7) & 0x1;
+	window.anchorVertical		= parameters[1] & 0x7F;
+	window.anchorHorizontal		= parameters[2];
+	window.anchorPoint			= static_cast<Anchor>(parameters[3] >> 4);
+	window.rowCount				= rowCount < DecodedWindow::kMaxRows ? rowCount : static_cast<uint8_t>(DecodedWindow::kMaxRows);
+	window.columnCount			= columnCount < DecodedWindow::kMaxColumns ? columnCount : static_cast<uint8_t>(DecodedWindow::kMaxColumns);
+
+	if (window.penRow >= window.rowCount)
+		window.penRow = window.rowCount - 1;
+	if (window.penColumn >= window.columnCount)
+		window.penColumn = window.columnCount - 1;
+
+	m_currentWindow = windowID;
+	m_changed = true;
+}
+
+// 7.1.4 CR, the window scrolls up when the pen is in the last row
+void ServiceDecoder::carriageReturn(DecodedWindow& window)
+{
+	window.penColumn = 0;
+
+	if (window.penRow + 1 < window.rowCount)
+	{
+		window.penRow++;
+		return;
+	}
+
+	std::memmove(window.text[0], window.text[1], sizeof(window.text[0]) * (window.rowCount - 1));
+	std::memset(window.text[window.rowCount - 1], 0, sizeof(window.text[0]));
+	m_changed |= window.visible;
+}
+
+void ServiceDecoder::writeCharacter(uint16_t character)
+{
+	if (m_currentWindow < 0 || !m_windows[m_currentWindow].defined)
+		return;
+
+	DecodedWindow& window = m_windows[m_currentWindow];
+
+	// Characters beyond the last column are discarded
+	if (window.penColumn >= window.columnCount)
+		return;
+
+	window.text[window.penRow][window.penColumn++] = character;
+	m_changed |= window.visible;
+}
+
+void ServiceDecoder::backspace()
+{
+	if (m_currentWindow < 0 || !m_windows[m_currentWindow].defined)
+		return;
+
+	DecodedWindow& window = m_windows[m_currentWindow];
+
+	if (window.penColumn > 0)
+	{
+		window.text[window.penRow][--window.penColumn] = 0;
+		m_changed |= window.visible;
+	}
+}
+
+// `visible` is 1 to display, 0 to hide, and -1 to toggle the windows
+void ServiceDecoder::setWindowsVisible(uint8_t windowMask, int visible)
+{
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		if (!(windowMask & (1 << i)) || !m_windows[i].defined)
+			continue;
+
+		m_windows[i].visible = visible < 0 ? !m_windows[i].visible : visible != 0;
+		m_changed = true;
+	}
+}
+
+// 7.1.4 C0 Code Set - Miscellaneous Control Codes
+size_t ServiceDecoder::interpretC0(const uint8_t* data, size_t size)
+{
+	const uint8_t code = data[0];
+
+	if (code == 0x10)
+		return interpretExtended(data, size);
+
+	// 0x11 - 0x17 have one parameter byte, 0x18 - 0x1F have two
+	size_t length = code < 0x10 ? 1 : code < 0x18 ? 2 : 3;
+	if (length > size)
+		return 0;
+
+	DecodedWindow* window = (m_currentWindow >= 0 && m_windows[m_currentWindow].defined) ? &m_windows[m_currentWindow] : NULL;
+
+	switch (code)
+	{
+		case 0x03:	// ETX
+			break;
+		case 0x08:	// BS
+			backspace();
+			break;
+		case 0x0C:	// FF
+			if (window)
+			{
+				clearWindow(*window);
+				m_changed |= window->visible;
+			}
+			break;
+		case 0x0D:	// CR
+			if (window)
+				carriageReturn(*window);
+			break;
+		case 0x0E:	// HCR
+			if (window)
+			{
+				std::memset(window->text[window->penRow], 0, sizeof(window->text[0]));
+				window->penColumn = 0;
+				m_changed |= window->visible;
+			}
+			break;
+		case 0x18:	// P16
+			writeCharacter(static_cast<uint16_t>((data[1] << 8) | data[2]));
+			break;
+	}
+
+	return length;
+}
+
+// 7.1.5 C1 Code Set - Captioning Command Control Codes
+size_t ServiceDecoder::interpretC1(const uint8_t* data, size_t size)
+{
+	// Parameter bytes of 0x80 - 0x9F, 8.10.5 Table 24
+	static const uint8_t kParameterBytes[32] =
+	{
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0,
+		2, 3, 2, 0, 0, 0, 0, 4, 6, 6, 6, 6, 6, 6, 6, 6
+	};
+
+	const uint8_t	code = data[0];
+	const size_t	length = 1 + kParameterBytes[code - 0x80];
+
+	if (length > size)
+		return 0;
+
+	const uint8_t*	parameters = data + 1;
+	DecodedWindow*	window = (m_currentWindow >= 0 && m_windows[m_currentWindow].defined) ? &m_windows[m_currentWindow] : NULL;
+
+	if (code <= 0x87)
+	{
+		// CWx
+		m_currentWindow = code - 0x80;
+	}
+	else if (code >= 0x98)
+	{
+		// DFx
+		defineWindow(code - 0x98, parameters);
+	}
+	else switch (code)
+	{
+		case 0x88:	// CLW
+			for (unsigned i = 0; i < 8; ++i)
+			{
+				if ((parameters[0] & (1 << i)) && m_windows[i].defined)
+				{
+					clearWindow(m_windows[i]);
+					m_changed |= m_windows[i].visible;
+				}
+			}
+			break;
+		case 0x89:	// DSW
+			setWindowsVisible(parameters[0], 1);
+			break;
+		case 0x8A:	// HDW
+			setWindowsVisible(parameters[0], 0);
+			break;
+		case 0x8B:	// TGW
+			setWindowsVisible(parameters[0], -1);
+			break;
+		case 0x8C:	// DLW
+			for (unsigned i = 0; i < 8; ++i)
+			{
+				if ((parameters[0] & (1 << i)) && m_windows[i].defined)
+				{
+					std::memset(&m_windows[i], 0, sizeof(m_windows[i]));
+					if (m_currentWindow == static_cast<int>(i))
+						m_currentWindow = -1;
+					m_changed = true;
+				}
+			}
+			break;
+		case 0x8F:	// RST
+			reset();
+			break;
+		case 0x90:	// SPA, the inverse of SetPenAttributes()
+			if (window)
+			{
+				window->pen.textTag		= static_cast<TextTag>(parameters[0] >> 4);
+				window->pen.offset		= static_cast<TextOffset>((parameters[0] >> 2) & 0x3);
+				window->pen.size		= static_cast<PenSize>(parameters[0] & 0x3);
+				window->pen.italic		= (parameters[1] >> 7) & 0x1;
+				window->pen.underline	= (parameters[1] >> 6) & 0x1;
+				window->pen.edgeType	= static_cast<EdgeType>((parameters[1] >> 3) & 0x7);
+				window->pen.font		= static_cast<Font>(parameters[1] & 0x7);
+			}
+			break;
+		case 0x91:	// SPC, the inverse of SetPenColour()
+			if (window)
+			{
+				window->pen.foregroundOpacity	= static_cast<Opacity>(parameters[0] >> 6);
+				window->pen.foregroundColour	= parameters[0] & 0x3F;
+				window->pen.backgroundOpacity	= static_cast<Opacity>(parameters[1] >> 6);
+				window->pen.backgroundColour	= parameters[1] & 0x3F;
+				window->pen.edgeColour			= parameters[2] & 0x3F;
+			}
+			break;
+		case 0x92:	// SPL, the inverse of SetPenLocation()
+			if (window)
+			{
+				uint8_t row = parameters[0] & 0xF;
+				uint8_t column = parameters[1] & 0x3F;
+				window->penRow = row < window->rowCount ? row : window->rowCount - 1;
+				window->penColumn = column < window->columnCount ? column : window->columnCount - 1;
+			}
+			break;
+		case 0x97:	// SWA, the inverse of SetWindowAttributes()
+			if (window)
+			{
+				window->fillOpacity		= static_cast<Opacity>(parameters[0] >> 6);
+				window->fillColour		= parameters[0] & 0x3F;
+				window->borderType		= static_cast<BorderType>(((parameters[2] >> 5) & 0x4) | (parameters[1] >> 6));
+				window->borderColour	= parameters[1] & 0x3F;
+				window->wordwrap		= (parameters[2] >> 6) & 0x1;
+				window->printDirection	= static_cast<PrintDirection>((parameters[2] >> 4) & 0x3);
+				window->scrollDirection	= static_cast<ScrollDirection>((parameters[2] >> 2) & 0x3);
+				window->justify			= static_cast<Justify>(parameters[2] & 0x3);
+				window->effectSpeed		= parameters[3] >> 4;
+				window->effectDirection	= static_cast<EffectDirection>((parameters[3] >> 2) & 0x3);
+				window->displayEffect	= static_cast<DisplayEffect>(parameters[3] & 0x3);
+				m_changed |= window->visible;
+			}
+			break;
+		default:
+			// DLY, DLC and the reserved codes
+			break;
+	}
+
+	return length;
+}
+
+// 7.1.1 Extending the Code Space, the codes following EXT1
+size_t ServiceDecoder::interpretExtended(const uint8_t* data, size_t size)
+{
+	if (size < 2)
+		return 0;
+
+	const uint8_t	code = data[1];
+	size_t			length;
+
+	if (code < 0x08)
+		length = 2;								// C2, no parameters
+	else if (code < 0x10)
+		length = 3;
+	else if (code < 0x18)
+		length = 4;
+	else if (code < 0x20)
+		length = 5;
+	else if (code < 0x80)
+		length = 2;								// G2
+	else if (code < 0x88)
+		length = 6;								// C3, 4 parameter bytes
+	else if (code < 0x90)
+		length = 7;
+	else if (code < 0xA0)
+	{
+		// C3 variable length commands, 7.1.11.2
+		if (size < 3)
+			return 0;
+		length = 3 + (data[2] & 0x1F);
+	}
+	else
+		length = 2;								// G3
+
+	if (length > size)
+		return 0;
+
+	if (code >= 0x20 && code < 0x80)
+		writeCharacter(kG2Characters[code - 0x20]);
+	else if (code >= 0xA0)
+		writeCharacter('_');					// The CC symbol of G3 and future characters are substituted
+
+	return length;
+}
+
+bool ServiceDecoder::push(const uint8_t* block, uint8_t blockLength)
+{
+	size_t offset = 0;
+
+	while (offset < blockLength)
+	{
+		const uint8_t*	data = block + offset;
+		const size_t	size = blockLength - offset;
+		const uint8_t	code = data[0];
+		size_t			length = 1;
+
+		if (code < 0x20)
+			length = interpretC0(data, size);
+		else if (code < 0x80)
+			writeCharacter(code == 0x7F ? kMusicNote : code);		// G0
+		else if (code < 0xA0)
+			length = interpretC1(data, size);
+		else
+			writeCharacter(code);									// G1 is ISO 8859-1
+
+		if (length == 0)
+			return false;
+
+		offset += length;
+	}
+
+	return true;
+}
+
+const DecodedWindow& ServiceDecoder::window(uint8_t windowID) const
+{
+	return m_windows[windowID & 0x7];
+}
+
+int ServiceDecoder::currentWindow() const
+{
+	return m_currentWindow;
+}
+
+size_t ServiceDecoder::rowText(uint8_t windowID, uint8_t row, char* utf8, size_t size) const
+{
+	const DecodedWindow&	window = m_windows[windowID & 0x7];
+	size_t					length = 0;
+	int						lastColumn = -1;
+
+	if (size == 0)
+		return 0;
+
+	if (window.defined && row < window.rowCount)
+	{
+		for (int column = 0; column < window.columnCount; ++column)
+		{
+			if (window.text[row][column] != 0)
+				lastColumn = column;
+		}
+
+		// Empty cells before the last character are spaces
+		for (int column = 0; column <= lastColumn; ++column)
+		{
+			char		character[3];
+			uint16_t	code = window.text[row][column];
+			size_t		characterLength = EncodeUTF8(code ? code : ' ', character);
+
+			if (length + characterLength >= size)
+				break;
+
+			std::memcpy(utf8 + length, character, characterLength);
+			length += characterLength;
+		}
+	}
+
+	utf8[length] = '\0';
+	return length;
+}
+
+bool ServiceDecoder::changed() const
+{
+	return m_changed;
+}
+
+void ServiceDecoder::clearChanged()
+{
+	m_changed = false;
+}
+
+//=====================================================================
+
+CaptionChannelPacketDecoder::CaptionChannelPacketDecoder(ServiceDecoder* services, uint8_t serviceCount, uint64_t serviceMask, DecoderStatistics& statistics)
+: m_services(services), m_serviceCount(serviceCount), m_serviceMask(serviceMask), m_statistics(statistics), m_packetSize(0), m_expectedSize(0), m_lastSequence(-1)
+{
+}
+
+void CaptionChannelPacketDecoder::reset()
+{
+	m_packetSize = 0;
+	m_expectedSize = 0;
+	m_lastSequence = -1;
+}
+
+void CaptionChannelPacketDecoder::push(uint8_t data1, uint8_t data2, bool start)
+{
+	if (start || m_expectedSize == 0)
+	{
+		if (m_expectedSize != 0)
+			++m_statistics.packetErrors;	// The previous packet was not completed
+
+		// 5 DTVCC Packet Layer, a packet_size_code of 0 is 128 bytes
+		uint8_t sizeCode = data1 & 0x3F;
+		m_expectedSize = sizeCode == 0 ? kMaximumPacket : sizeCode * 2;
+		m_packetSize = 0;
+	}
+
+	m_packet[m_packetSize++] = data1;
+	m_packet[m_packetSize++] = data2;
+
+	if (m_packetSize >= m_expectedSize)
+	{
+		decodePacket();
+		m_expectedSize = 0;
+		m_packetSize = 0;
+	}
+}
+
+void CaptionChannelPacketDecoder::decodePacket()
+{
+	int sequence = m_packet[0] >> 6;
+	if (m_lastSequence >= 0 && sequence != ((m_lastSequence + 1) & 0x3))
+		++m_statistics.packetDiscontinuities;
+	m_lastSequence = sequence;
+
+	++m_statistics.packets;
+
+	// 6.2 Service Block
+	unsigned offset = 1;
+	while (offset < m_expectedSize)
+	{
+		uint8_t header = m_packet[offset++];
+		if (header == 0)
+			break;		// NULL Service Block Header, the rest of the packet is padding
+
+		uint8_t serviceNumber = header >> 5;
+		uint8_t blockSize = header & 0x1F;
+
+		// 6.2.2 Extended Service Block Header
+		if (serviceNumber == 7 && blockSize != 0)
+		{
+			if (offset >= m_expectedSize)
+			{
+				++m_statistics.packetErrors;
+				return;
+			}
+			serviceNumber = m_packet[offset++] & 0x3F;
+		}
+
+		if (offset + blockSize > m_expectedSize)
+		{
+			++m_statistics.packetErrors;
+			return;
+		}
+
+		if (serviceNumber >= 1 && serviceNumber <= m_serviceCount && (m_serviceMask & (1ULL << serviceNumber)))
+		{
+			if (!m_services[serviceNumber - 1].push(m_packet + offset, blockSize))
+				++m_statistics.commandErrors;
+			++m_statistics.serviceBlocks;
+		}
+		else
+			++m_statistics.skippedServiceBlocks;
+
+		offset += blockSize;
+	}
+}
+
+//=====================================================================
+
+CaptionDistributionPacketDecoder::CaptionDistributionPacketDecoder(CaptionChannelPacketDecoder& packetDecoder, CEA608::Decoder* cea608Decoder, DecoderStatistics& statistics)
+: m_packetDecoder(packetDecoder), m_cea608Decoder(cea608Decoder), m_statistics(statistics), m_lastSequence(-1), m_frameRate(cdpFrameRate_Forbidden)
+{
+}
+
+void CaptionDistributionPacketDecoder::reset()
+{
+	m_lastSequence = -1;
+	m_frameRate = cdpFrameRate_Forbidden;
+}
+
+bool CaptionDistributionPacketDecoder::decode_ccdata(const uint8_t*& buffer, const uint8_t* end)
+{
+	static const uint8_t CCDATA_ID = 0x72;
+
+	enum cc_type
+	{
+		cc_type_608_1 = 0,
+		cc_type_608_2,
+		cc_type_708_data,
+		cc_type_708_start
+	};
+
+	if (end - buffer < 2 || buffer[0] != CCDATA_ID)
+		return false;
+
+	unsigned cc_count = buffer[1] & 0x1F;
+	if (end - buffer < static_cast<ptrdiff_t>(2 + 3 * cc_count))
+		return false;
+	buffer += 2;
+
+	for (unsigned i = 0; i < cc_count; ++i)
+	{
+		const uint8_t*	ccdata = buffer;
+		bool			cc_valid = (ccdata[0] >> 2) & 0x1;
+		uint8_t			type = ccdata[0] & 0x3;
+
+		if (cc_valid && type >= cc_type_708_data)
+			m_packetDecoder.push(ccdata[1], ccdata[2], type == cc_type_708_start);
+		else if (cc_valid && m_cea608Decoder)
+			m_cea608Decoder->push(type == cc_type_608_1 ? CEA608::field_1 : CEA608::field_2, ccdata[1], ccdata[2]);
+		buffer += 3;
+	}
+
+	return true;
+}
+
+bool CaptionDistributionPacketDecoder::push(const uint8_t* cdp, size_t cdpLength)
+{
+	static const uint8_t	CDP_TIMECODE_ID = 0x71;
+	static const uint8_t	CDP_FOOTER_ID = 0x74;
+
+	enum
+	{
+		kCDPHeaderLength = 7,
+		kTimecodeLength = 5,
+		kCDPFooterLength = 4
+	};
+
+	enum cdp_flags
+	{
+		time_code_present = 1 << 7,
+		ccdata_present = 1 << 6
+	};
+
+	// SMPTE 334-2 5.2 CDP Header, cdp_length may be shorter than the ancillary data
+	if (cdpLength < kCDPHeaderLength + kCDPFooterLength || cdp[0] != 0x96 || cdp[1] != 0x69 ||
+		cdp[2] < kCDPHeaderLength + kCDPFooterLength || cdp[2] > cdpLength)
+	{
+		++m_statistics.cdpErrors;
+		return false;
+	}
+
+	const uint8_t	cdp_length = cdp[2];
+	uint8_t			checksum = 0;
+
+	for (unsigned i = 0; i < cdp_length; ++i)
+		checksum += cdp[i];
+
+	const uint8_t*	cdp_footer = cdp + cdp_length - kCDPFooterLength;
+	const uint16_t	sequence = (cdp[5] << 8) | cdp[6];
+
+	if (checksum != 0 || cdp_footer[0] != CDP_FOOTER_ID || cdp_footer[1] != cdp[5] || cdp_footer[2] != cdp[6])
+	{
+		++m_statistics.cdpErrors;
+		return false;
+	}
+
+	const uint8_t*	buffer = cdp + kCDPHeaderLength;
+	const uint8_t	flags = cdp[4];
+
+	if (flags & time_code_present)
+	{
+		if (cdp_footer - buffer < kTimecodeLength || buffer[0] != CDP_TIMECODE_ID)
+		{
+			++m_statistics.cdpErrors;
+			return false;
+		}
+		buffer += kTimecodeLength;
+	}
+
+	// The CDP is checked before cc_data is decoded, a break in the sequence loses the packet being assembled
+	if (m_lastSequence >= 0 && sequence != ((m_lastSequence + 1) & 0xFFFF))
+	{
+		++m_statistics.cdpDiscontinuities;
+		m_packetDecoder.reset();
+	}
+	m_lastSequence = sequence;
+	m_frameRate = static_cast<CDPFrameRate>(cdp[3] >> 4);
+
+	// The service information and future sections are not decoded
+	if ((flags & ccdata_present) && !decode_ccdata(buffer, cdp_footer))
+	{
+		++m_statistics.cdpErrors;
+		return false;
+	}
+
+	++m_statistics.cdps;
+	return true;
+}
+
+CDPFrameRate CaptionDistributionPacketDecoder::frameRate() const
+{
+	return m_frameRate;
+}
+
+//=====================================================================
+
+Decoder::Decoder(DecoderListener* listener, uint64_t serviceMask, CEA608::Decoder* cea608Decoder)
+: m_listener(listener), m_cea608Decoder(cea608Decoder), m_statistics(), m_packetDecoder(m_services, kMaxServices, serviceMask, m_statistics), m_cdpDecoder(m_packetDecoder, cea608Decoder, m_statistics)
+{
+}
+
+bool Decoder::decode(const uint8_t* cdp, size_t cdpLength)
+{
+	bool decoded = m_cdpDecoder.push(cdp, cdpLength);
+
+	for (unsigned i = 0; i < kMaxServices; ++i)
+	{
+		if (!m_services[i].changed())
+			continue;
+
+		m_services[i].clearChanged();
+		if (m_listener)
+			m_listener->captionsChanged(i + 1, m_services[i]);
+	}
+
+	if (m_cea608Decoder)
+		m_cea608Decoder->flush();
+
+	return decoded;
+}
+
+const ServiceDecoder& Decoder::service(uint8_t serviceNumber) const
+{
+	return m_services[(serviceNumber - 1) % kMaxServices];
+}
+
+const DecoderStatistics& Decoder::statistics() const
+{
+	return m_statistics;
+}
+
+CDPFrameRate Decoder::frameRate() const
+{
+	return m_cdpDecoder.frameRate();
+}
+
+void Decoder::reset()
+{
+	for (unsigned i = 0; i < kMaxServices; ++i)
+	{
+		m_services[i].reset();
+		m_services[i].clearChanged();
+	}
+	m_packetDecoder.reset();
+	m_cdpDecoder.reset();
+
+	if (m_cea608Decoder)
+		m_cea608Decoder->reset();
+}
+
+}
@@ -0,0 +1,305 @@
+/* -LICENSE-START-
+ ** Copyright (c) 2024 Blackmagic Design
+ **  
+ ** Permission is hereby granted, free of charge, to any person or organization 
+ ** obtaining a copy of the software and accompanying documentation (the 
+ ** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+ ** and transmit the Software, and to prepare derivative works of the Software, 
+ ** and to permit third-parties to whom the Software is furnished to do so, in 
+ ** accordance with:
+ ** 
+ ** (1) if the Software is obtained from Blackmagic Design, the End User License 
+ ** Agreement for the Software Development Kit (“EULA”) available at 
+ ** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+ ** 
+ ** (2) if the Software is obtained from any third party, such licensing terms 
+ ** as notified by that third party,
+ ** 
+ ** and all subject to the following:
+ ** 
+ ** (3) the copyright notices in the Software and this entire statement, 
+ ** including the above license grant, this restriction and the following 
+ ** disclaimer, must be included in all copies of the Software, in whole or in 
+ ** part, and all derivative works of the Software, unless such copies or 
+ ** derivative works are solely in the form of machine-executable object code 
+ ** generated by a source language processor.
+ ** 
+ ** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+ ** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ ** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ ** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ ** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ ** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ ** DEALINGS IN THE SOFTWARE.
+ ** 
+ ** A copy of the Software is available free of charge at 
+ ** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+ ** 
+ ** -LICENSE-END-
+ */
+
+#ifndef __CEA708_DECODER_H__
+#define __CEA708_DECODER_H__
+#include <stddef.h>
+#include <stdint.h>
+#include "CEA608_Decoder.h"
+#include "CEA708_Types.h"
+
+namespace CEA708
+{
+
+/* The decoder mirrors the layers of the encoder, see CEA708_Encoder.h:
+ * - caption distribution packets are checked and their cc_data is extracted
+ * - channel packets are assembled from the DTVCC cc_data pairs
+ * - service blocks are split from the channel packets, and routed to their service
+ * - each service interprets its characters and commands into windows of text
+ *
+ * CEA-608 compatibility bytes are pushed to a CEA608::Decoder, which decodes one of the CEA-608 channels.
+ *
+ * The decoder is streaming, a CDP is decoded as it is captured and channel packets may span CDPs.  All state is
+ * held in fixed size members of Decoder, so decoding does not allocate memory.  A Decoder is used by one thread,
+ * each input has its own Decoder.
+ */
+
+class ServiceDecoder;
+class CaptionChannelPacketDecoder;
+class CaptionDistributionPacketDecoder;
+
+
+// Counts of the data decoded, and of the data which was discarded
+struct DecoderStatistics
+{
+	uint64_t	cdps;					// CDPs decoded
+	uint64_t	cdpErrors;				// CDPs discarded for their identifier, length, checksum or footer
+	uint64_t	cdpDiscontinuities;		// Breaks in the CDP sequence counter
+	uint64_t	packets;				// Channel packets decoded
+	uint64_t	packetErrors;			// Channel packets discarded, or truncated by the next packet start
+	uint64_t	packetDiscontinuities;	// Breaks in the channel packet sequence number
+	uint64_t	serviceBlocks;			// Service blocks interpreted
+	uint64_t	skippedServiceBlocks;	// Service blocks of services which are not decoded
+	uint64_t	commandErrors;			// Commands truncated by the end of their service block
+};
+
+
+// CEA-708 8.5 Pen
+struct DecodedPen
+{
+	PenSize		size;
+	Font		font;
+	TextTag		textTag;
+	TextOffset	offset;
+	bool		italic;
+	bool		underline;
+	EdgeType	edgeType;
+	uint8_t		foregroundColour;		// CEA-708 Table 29 colour, see Colour
+	Opacity		foregroundOpacity;
+	uint8_t		backgroundColour;
+	Opacity		backgroundOpacity;
+	uint8_t		edgeColour;
+};
+
+
+// CEA-708 8.4 Window
+struct DecodedWindow
+{
+	enum
+	{
+		kMaxRows = 15,		// 8.4.6 Window Size
+		kMaxColumns = 42
+	};
+
+	bool			defined;
+	bool			visible;
+
+	// 8.10.5.2 DEFINE WINDOW
+	Priority		priority;
+	Anchor			anchorPoint;
+	bool			relativePositioning;
+	uint8_t			anchorVertical;
+	uint8_t			anchorHorizontal;
+	uint8_t			rowCount;
+	uint8_t			columnCount;
+	bool			rowLock;
+	bool			columnLock;
+	WindowStyle		windowStyle;
+	PenStyle		penStyle;
+
+	// 8.10.5.8 SET WINDOW ATTRIBUTES
+	Justify			justify;
+	PrintDirection	printDirection;
+	ScrollDirection	scrollDirection;
+	bool			wordwrap;
+	DisplayEffect	displayEffect;
+	EffectDirection	effectDirection;
+	uint8_t			effectSpeed;
+	uint8_t			fillColour;
+	Opacity			fillOpacity;
+	BorderType		borderType;
+	uint8_t			borderColour;
+
+	// 8.10.5.9 - 8.10.5.11 pen of the window
+	DecodedPen		pen;
+	uint8_t			penRow;
+	uint8_t			penColumn;
+
+	// Unicode characters of the window, 0 is an empty cell
+	uint16_t		text[kMaxRows][kMaxColumns];
+};
+
+
+/* Receives the decoded captions.
+ * captionsChanged() is called once at the end of each decoded CDP, for each service in which the definition,
+ * visibility or text of a window was changed by the CDP. */
+class DecoderListener
+{
+public:
+	virtual ~DecoderListener() {}
+	virtual void captionsChanged(uint8_t serviceNumber, const ServiceDecoder& service) = 0;
+};
+
+
+// CEA-708 7 DTVCC Coding Layer and 8 DTVCC Interpretation Layer, the state machine of one service
+// Note: DELAY and DELAY CANCEL are not timed, commands are interpreted as they are received
+class ServiceDecoder
+{
+private:
+	DecodedWindow	m_windows[8];
+	int				m_currentWindow;	// -1 until a window is defined or set
+	bool			m_changed;
+
+	void clearWindow(DecodedWindow& window);
+	void defineWindow(uint8_t windowID, const uint8_t* parameters);
+	void carriageReturn(DecodedWindow& window);
+	void writeCharacter(uint16_t character);
+	void backspace();
+	void setWindowsVisible(uint8_t windowMask, int visible);
+
+	// Interpret the element at `data`, returns the length of the element or 0 if it is truncated
+	size_t interpretC0(const uint8_t* data, size_t size);
+	size_t interpretC1(const uint8_t* data, size_t size);
+	size_t interpretExtended(const uint8_t* data, size_t size);
+
+public:
+	ServiceDecoder();
+
+	// 8.9.3 Reset, deletes all windows
+	void reset();
+
+	/* Interpret the data of a service block.
+	 * Syntactic elements are not split across service blocks, an element truncated by the end of the block is discarded.
+	 * Returns false if an element was truncated. */
+	bool push(const uint8_t* block, uint8_t blockLength);
+
+	const DecodedWindow& window(uint8_t windowID) const;
+	int currentWindow() const;
+
+	/* Write a row of a window's text as a NUL terminated UTF-8 string, without trailing empty cells.
+	 * Returns the length of the string, which is truncated to fit `size` bytes. */
+	size_t rowText(uint8_t windowID, uint8_t row, char* utf8, size_t size) const;
+
+	// True if the captions were changed since clearChanged()
+	bool changed() const;
+	void clearChanged();
+};
+
+
+// CEA-708 5 DTVCC Packet Layer and 6 DTVCC Service Layer
+class CaptionChannelPacketDecoder
+{
+private:
+	enum
+	{
+		kMaximumPacket = 128
+	};
+
+	ServiceDecoder*		m_services;			// Services 1 to kMaxServices, see Decoder
+	uint8_t				m_serviceCount;
+	uint64_t			m_serviceMask;
+	DecoderStatistics&	m_statistics;
+	uint8_t				m_packet[kMaximumPacket];
+	uint8_t				m_packetSize;
+	uint8_t				m_expectedSize;		// 0 when no packet is being assembled
+	int					m_lastSequence;		// -1 until the first packet
+
+	void decodePacket();
+
+public:
+	CaptionChannelPacketDecoder(ServiceDecoder* services, uint8_t serviceCount, uint64_t serviceMask, DecoderStatistics& statistics);
+
+	/* Add a DTVCC cc_data pair, `start` is set for cc_type DTVCC_PACKET_START.
+	 * When the channel packet is complete, its service blocks are pushed to their ServiceDecoders.
+	 * A pair which follows a complete packet starts the next packet when it is not marked as the start, as the
+	 * encoder only marks the first pair of each CDP. */
+	void push(uint8_t data1, uint8_t data2, bool start);
+
+	// Discard a partly assembled packet, after a break in the CDP sequence
+	void reset();
+};
+
+
+// SMPTE 334-2 5 CDP Detailed Specification
+class CaptionDistributionPacketDecoder
+{
+private:
+	CaptionChannelPacketDecoder&	m_packetDecoder;
+	CEA608::Decoder*				m_cea608Decoder;	// NULL when CEA-608 is not decoded
+	DecoderStatistics&				m_statistics;
+	int32_t							m_lastSequence;		// -1 until the first CDP
+	CDPFrameRate					m_frameRate;
+
+	bool decode_ccdata(const uint8_t*& buffer, const uint8_t* end);
+
+public:
+	CaptionDistributionPacketDecoder(CaptionChannelPacketDecoder& packetDecoder, CEA608::Decoder* cea608Decoder, DecoderStatistics& statistics);
+
+	/* Check a CDP and push its DTVCC cc_data to the CaptionChannelPacketDecoder, and its CEA-608 cc_data to the
+	 * CEA608::Decoder.
+	 * Returns false if the CDP was discarded. */
+	bool push(const uint8_t* cdp, size_t cdpLength);
+
+	// Frame rate of the last CDP, cdpFrameRate_Forbidden until a CDP is decoded
+	CDPFrameRate frameRate() const;
+
+	void reset();
+};
+
+
+/* Helper class which initialises the decoder stack for the standard services 1 to 6.
+ * Only the services in `serviceMask` are interpreted, bit n for service n, the blocks of other services are skipped.
+ * Extended services 7 to 63 are skipped.
+ * The CEA-608 compatibility bytes are decoded by `cea608Decoder`, when it is set, which is flushed after each CDP. */
+class Decoder
+{
+public:
+	enum
+	{
+		kMaxServices = 6
+	};
+
+private:
+	DecoderListener*					m_listener;
+	CEA608::Decoder*					m_cea608Decoder;
+	DecoderStatistics					m_statistics;
+	ServiceDecoder						m_services[kMaxServices];
+	CaptionChannelPacketDecoder			m_packetDecoder;
+	CaptionDistributionPacketDecoder	m_cdpDecoder;
+
+public:
+	explicit Decoder(DecoderListener* listener, uint64_t serviceMask = 1 << serviceNumber_PrimaryCaptionService, CEA608::Decoder* cea608Decoder = NULL);
+
+	// Decode a CDP, as the 8-bit user data of an ancillary packet with DID 0x61 and SDID 0x01
+	bool decode(const uint8_t* cdp, size_t cdpLength);
+
+	// Service state of a standard service 1 to 6
+	const ServiceDecoder& service(uint8_t serviceNumber) const;
+
+	const DecoderStatistics& statistics() const;
+	CDPFrameRate frameRate() const;
+
+	// Reset all services, and the CEA-608 decoder, and discard partly assembled packets
+	void reset();
+};
+
+}
+
+#endif
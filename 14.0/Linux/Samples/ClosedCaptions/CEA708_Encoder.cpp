@@ -78,6 +78,20 @@ static CDPFrameRate FrameRateToCDPFrameRate(int64_t frameDuration, int64_t timeS
 	return cdpFrameRate_Forbidden;
 }
 
+// CEA-708 4.4.1, CEA-608 pairs of both fields per frame of each CDPFrameRate, as a fraction
+static const uint8_t kCEA608PairsPerFrame[9][2] =
+{
+	{ 0, 1 },	// cdpFrameRate_Forbidden
+	{ 5, 2 },	// cdpFrameRate_2397
+	{ 5, 2 },	// cdpFrameRate_24
+	{ 12, 5 },	// cdpFrameRate_25
+	{ 2, 1 },	// cdpFrameRate_2997
+	{ 2, 1 },	// cdpFrameRate_30
+	{ 6, 5 },	// cdpFrameRate_50
+	{ 1, 1 },	// cdpFrameRate_5994
+	{ 1, 1 }	// cdpFrameRate_60
+};
+
 //=====================================================================
 
 ServiceBlockEncoder::ServiceBlockEncoder(CaptionChannelPacketEncoder& packetEncoder, uint8_t serviceNumber)
@@ -193,10 +207,18 @@ void CaptionChannelPacketEncoder::flush()
 
 //=====================================================================
 
-CaptionDistributionPacketEncoder::CaptionDistributionPacketEncoder(CDPQueue& cdpQueue, int64_t frameDuration, int64_t timeScale)
-: m_cdpQueue(cdpQueue), m_sequence(0), m_CCCount(FrameRateToCDPCCCount(frameDuration, timeScale)), m_frameRate(FrameRateToCDPFrameRate(frameDuration, timeScale))
+CaptionDistributionPacketEncoder::CaptionDistributionPacketEncoder(CDPQueue& cdpQueue, int64_t frameDuration, int64_t timeScale, bool cea608)
+: m_cdpQueue(cdpQueue), m_sequence(0), m_CCCount(FrameRateToCDPCCCount(frameDuration, timeScale)), m_frameRate(FrameRateToCDPFrameRate(frameDuration, timeScale)),
+  m_packetStarts(0), m_608Phase(0), m_608NextField(CEA608::field_1)
 {
-
+	m_608PairsNumerator = kCEA608PairsPerFrame[m_frameRate][0];
+	m_608PairsDenominator = kCEA608PairsPerFrame[m_frameRate][1];
+	
+	// Enough cc_data are reserved for the most CEA-608 pairs of a frame
+	m_608Slots = cea608 ? (m_608PairsNumerator + m_608PairsDenominator - 1) / m_608PairsDenominator : 0;
+	
+	m_608QueueHead[0] = m_608QueueHead[1] = 0;
+	m_608QueueCount[0] = m_608QueueCount[1] = 0;
 }
 
 void CaptionDistributionPacketEncoder::encode_ccdata(uint8_t*& buffer)
@@ -212,9 +234,18 @@ void CaptionDistributionPacketEncoder::encode_ccdata(uint8_t*& buffer)
 	};
 	
 	unsigned payloadPackets = static_cast<unsigned>(m_payload.size() / 2);
-	unsigned padPackets = m_CCCount - payloadPackets;
+	unsigned cea608Packets = 0;
 	
-	if (payloadPackets > m_CCCount)
+	if (m_608Slots != 0)
+	{
+		m_608Phase += m_608PairsNumerator;
+		cea608Packets = m_608Phase / m_608PairsDenominator;
+		m_608Phase %= m_608PairsDenominator;
+	}
+	
+	unsigned padPackets = m_CCCount - cea608Packets - payloadPackets;
+	
+	if (cea608Packets + payloadPackets > m_CCCount)
 		return;
 	
 	uint8_t* ccdata_header = buffer;
@@ -223,13 +254,34 @@ void CaptionDistributionPacketEncoder::encode_ccdata(uint8_t*& buffer)
 	ccdata_header[1] |= m_CCCount & 0x1F;
 	buffer += 2;
 	
+	// CEA-608 pairs precede the DTVCC data, a null pair is sent when the field has nothing queued
+	for (unsigned i = 0; i < cea608Packets; ++i)
+	{
+		unsigned field = m_608NextField;
+		uint8_t* ccdata = buffer;
+		ccdata[0] = 0x1F << 3;			// marker
+		ccdata[0] |= (1 << 2);			// cc_valid
+		ccdata[0] |= field == CEA608::field_1 ? cc_type_608_1 : cc_type_608_2;
+		ccdata[1] = CEA608::AddOddParity(0);
+		ccdata[2] = CEA608::AddOddParity(0);
+		if (m_608QueueCount[field] != 0)
+		{
+			ccdata[1] = CEA608::AddOddParity(m_608Queue[field][m_608QueueHead[field]][0]);
+			ccdata[2] = CEA608::AddOddParity(m_608Queue[field][m_608QueueHead[field]][1]);
+			m_608QueueHead[field] = (m_608QueueHead[field] + 1) % kMaximum608Pairs;
+			--m_608QueueCount[field];
+		}
+		m_608NextField = field == CEA608::field_1 ? CEA608::field_2 : CEA608::field_1;
+		buffer += 3;
+	}
+	
 	uint8_t* cc_data_x = m_payload.data();
 	for (unsigned i = 0; i < payloadPackets; ++i)
 	{
 		uint8_t* ccdata = buffer;
 		ccdata[0] = 0x1F << 3;			// marker
 		ccdata[0] |= (1 << 2);			// cc_valid
-		ccdata[0] |= i == 0 ? cc_type_708_start : cc_type_708_data;
+		ccdata[0] |= (m_packetStarts & (1u << i)) ? cc_type_708_start : cc_type_708_data;
 		ccdata[1] = *cc_data_x++;
 		ccdata[2] = *cc_data_x++;
 		buffer += 3;
@@ -349,6 +401,7 @@ EncodedCaptionDistributionPacket CaptionDistributionPacketEncoder::encode()
 void CaptionDistributionPacketEncoder::reset()
 {
 	m_payload.clear();
+	m_packetStarts = 0;
 }
 
 void CaptionDistributionPacketEncoder::push(const uint8_t* packet, uint8_t packetLength)
@@ -360,9 +413,30 @@ void CaptionDistributionPacketEncoder::push(const uint8_t* packet, uint8_t packe
 		reset();
 	}
 	
+	m_packetStarts |= 1u << (m_payload.size() / 2);
 	m_payload.insert(m_payload.end(), packet, packet + packetLength);
 }
 
+bool CaptionDistributionPacketEncoder::push608(CEA608::Field field, const uint8_t (*pairs)[2], unsigned pairCount)
+{
+	if (m_608Slots == 0 || pairCount + m_608QueueCount[field] > (unsigned)kMaximum608Pairs)
+		return false;
+	
+	for (unsigned i = 0; i < pairCount; ++i)
+	{
+		unsigned tail = (m_608QueueHead[field] + m_608QueueCount[field]) % kMaximum608Pairs;
+		m_608Queue[field][tail][0] = pairs[i][0];
+		m_608Queue[field][tail][1] = pairs[i][1];
+		++m_608QueueCount[field];
+	}
+	return true;
+}
+
+unsigned CaptionDistributionPacketEncoder::queued608(CEA608::Field field) const
+{
+	return m_608QueueCount[field];
+}
+
 void CaptionDistributionPacketEncoder::flush()
 {
 	EncodedCaptionDistributionPacket packet = encode();
@@ -372,8 +446,8 @@ void CaptionDistributionPacketEncoder::flush()
 
 //=====================================================================
 
-Encoder::Encoder(int64_t frameDuration, int64_t timeScale)
-: m_cdpQueue(), m_cdpEncoder(m_cdpQueue, frameDuration, timeScale), m_packetEncoder(m_cdpEncoder), m_serviceBlockEncoder(m_packetEncoder, serviceNumber_PrimaryCaptionService)
+Encoder::Encoder(int64_t frameDuration, int64_t timeScale, bool cea608)
+: m_cdpQueue(), m_cdpEncoder(m_cdpQueue, frameDuration, timeScale, cea608), m_packetEncoder(m_cdpEncoder), m_serviceBlockEncoder(m_packetEncoder, serviceNumber_PrimaryCaptionService)
 {
 }
 
@@ -396,6 +470,35 @@ Encoder& Encoder::operator<<(const char* captionText)
 	return *this;
 }
 
+bool Encoder::push608(const CEA608::ControlCode& code)
+{
+	const uint8_t pairs[2][2] = { { code.data1, code.data2 }, { code.data1, code.data2 } };
+	return m_cdpEncoder.push608(code.field, pairs, 2);
+}
+
+bool Encoder::push608(CEA608::Channel channel, const char* captionText)
+{
+	enum
+	{
+		kMaximumTextPairs = 64
+	};
+	
+	uint8_t pairs[kMaximumTextPairs][2];
+	size_t len = strlen(captionText);
+	unsigned pairCount = static_cast<unsigned>((len + 1) / 2);
+	
+	if (pairCount > kMaximumTextPairs)
+		return false;
+	
+	// An odd character is paired with a null
+	for (size_t i = 0; i < len; ++i)
+		pairs[i / 2][i % 2] = captionText[i] & 0x7F;
+	if (len % 2)
+		pairs[len / 2][1] = 0;
+	
+	return m_cdpEncoder.push608(CEA608::ChannelField(channel), pairs, pairCount);
+}
+
 bool Encoder::empty() const
 {
 	return m_cdpQueue.empty();
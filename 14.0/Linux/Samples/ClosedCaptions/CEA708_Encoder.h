@@ -43,6 +43,7 @@
 #include <queue>
 #include <vector>
 #include <stdint.h>
+#include "CEA608_Commands.h"
 #include "CEA708_Commands.h"
 
 namespace CEA708
@@ -56,23 +57,11 @@ namespace CEA708
  * - channel packets are packed into caption distribution packets
  * - caption distribution packets are packed into ancillary data packets
  * - ancillary data packets are written into the luma channel of a vanc line
+ *
+ * CEA-608 compatibility bytes may also be carried in each caption distribution packet, before the DTVCC data.
  */
 
 
-// SMPTE 334-2 Table 3 – CDP Frame Rate
-enum CDPFrameRate
-{
-	cdpFrameRate_Forbidden = 0,	// '0b0000'
-	cdpFrameRate_2397,			// '0b0001'
-	cdpFrameRate_24,			// '0b0010'
-	cdpFrameRate_25,			// '0b0011'
-	cdpFrameRate_2997,			// '0b0100'
-	cdpFrameRate_30,			// '0b0101'
-	cdpFrameRate_50,			// '0b0110'
-	cdpFrameRate_5994,			// '0b0111'
-	cdpFrameRate_60				// '0b1000'
-};
-
 typedef std::vector<uint8_t> EncodedCaptionDistributionPacket;
 typedef std::queue<EncodedCaptionDistributionPacket> CDPQueue;
 class ServiceBlockEncoder;
@@ -151,11 +140,28 @@ public:
 class CaptionDistributionPacketEncoder
 {
 private:
+	enum
+	{
+		kMaximum608Pairs = 256		// Queued pairs of each field, 8.5 seconds of CEA-608
+	};
+	
 	CDPQueue&				m_cdpQueue;
 	uint16_t				m_sequence;
 	uint8_t					m_CCCount;
 	CDPFrameRate			m_frameRate;
 	std::vector<uint8_t>	m_payload;
+	uint32_t				m_packetStarts;		// cc_data pairs of the payload which start a channel packet
+	
+	// CEA-608 pairs of both fields are sent at 59.94 pairs per second, alternating field 1 and field 2.
+	// m_608Phase counts the pairs due in units of 1 / m_608PairsDenominator of a pair.
+	uint8_t					m_608Slots;			// cc_data reserved for CEA-608 in each CDP, 0 if CEA-608 is off
+	uint8_t					m_608PairsNumerator;
+	uint8_t					m_608PairsDenominator;
+	uint8_t					m_608Phase;
+	CEA608::Field			m_608NextField;
+	uint8_t					m_608Queue[2][kMaximum608Pairs][2];
+	uint16_t				m_608QueueHead[2];
+	uint16_t				m_608QueueCount[2];
 	
 	void encode_ccdata(uint8_t*& buffer);
 	void encode_svcinfo(uint8_t*& buffer);
@@ -165,17 +171,26 @@ private:
 	void reset();
 	
 public:
-	CaptionDistributionPacketEncoder(CDPQueue& cdpQueue, int64_t frameDuration, int64_t timeScale);
+	CaptionDistributionPacketEncoder(CDPQueue& cdpQueue, int64_t frameDuration, int64_t timeScale, bool cea608 = false);
 	
+	// The cc_data reserved for CEA-608 are not available to the DTVCC packets
 	inline std::size_t maxPayloadSize() const
 	{
-		return m_CCCount * 2;
+		return (m_CCCount - m_608Slots) * 2;
 	}
 	
 	/* Add an encoded caption channel packet to the caption distribution packet.
 	 * When full, encodes the cdp and pushes the completed CDP onto the CDPQueue. */
 	void push(const uint8_t* packet, uint8_t packetLength);
 	
+	/* Queue CEA-608 pairs of a field, without parity, which are sent at the CEA-608 rate in the following CDPs.
+	 * Null pairs are sent when the queue of a field is empty.  Returns false, and queues nothing, if the pairs do not fit
+	 * the queue or CEA-608 is off. */
+	bool push608(CEA608::Field field, const uint8_t (*pairs)[2], unsigned pairCount);
+	
+	// Pairs of a field which have not been sent
+	unsigned queued608(CEA608::Field field) const;
+	
 	/* Encodes CDP and pushes the completed CDP onto the CDPQueue */
 	void flush();
 };
@@ -192,12 +207,19 @@ private:
 	ServiceBlockEncoder					m_serviceBlockEncoder;
 	
 public:
-	Encoder(int64_t frameDuration, int64_t timeScale);
+	// CEA-608 compatibility bytes are sent in each CDP when `cea608` is set
+	Encoder(int64_t frameDuration, int64_t timeScale, bool cea608 = false);
 
 	// Push the given command / caption text into the encoder stack
 	Encoder& operator<<(const SyntacticElement& command);
 	Encoder& operator<<(const char* captionText);
 	
+	/* Queue a CEA-608 control code, which is sent twice, or up to 128 characters of CEA-608 caption text of a channel.
+	 * The text is of the CEA-608 character set, which is ASCII except for 10 characters.
+	 * Returns false if the CEA-608 queue of the field is full. */
+	bool push608(const CEA608::ControlCode& code);
+	bool push608(CEA608::Channel channel, const char* captionText);
+	
 	// True if there are no fully-encoded packets in the queue.
 	bool empty() const;
 	
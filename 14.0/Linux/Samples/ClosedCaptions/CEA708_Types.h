@@ -50,6 +50,20 @@ enum ServiceNumber
 	serviceNumber_PrimaryCaptionService = 1
 };
 
+// SMPTE 334-2 Table 3 – CDP Frame Rate
+enum CDPFrameRate
+{
+	cdpFrameRate_Forbidden = 0,	// '0b0000'
+	cdpFrameRate_2397,			// '0b0001'
+	cdpFrameRate_24,			// '0b0010'
+	cdpFrameRate_25,			// '0b0011'
+	cdpFrameRate_2997,			// '0b0100'
+	cdpFrameRate_30,			// '0b0101'
+	cdpFrameRate_50,			// '0b0110'
+	cdpFrameRate_5994,			// '0b0111'
+	cdpFrameRate_60				// '0b1000'
+};
+
 // 8.4.1 Window Identifier
 enum WindowID
 {
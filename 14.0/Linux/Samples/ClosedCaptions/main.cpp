@@ -297,6 +297,22 @@ HRESULT ScheduleNextFrame(CEA708::Encoder& CC708Encoder, IDeckLinkOutput* deckLi
 		cc.flush();
 	}
 	
+	// Resend the CEA-608 compatibility captions every 4 seconds, as CC1 carries about 30 pairs per second.
+	if (gTotalFramesScheduled % (fps * 4) == 0)
+	{
+		using namespace CEA608;
+		CEA708::Encoder& cc = CC708Encoder;
+		
+		// Pop-on captions are loaded into the non-displayed memory, and shown by EOC
+		cc.push608(ResumeCaptionLoading(channel_CC1));
+		cc.push608(EraseNonDisplayedMemory(channel_CC1));
+		cc.push608(PreambleAddress(channel_CC1, 14, 4, false));
+		cc.push608(channel_CC1, "CEA-608 Closed Captions");
+		cc.push608(PreambleAddress(channel_CC1, 15, 4, false));
+		cc.push608(channel_CC1, "Second line of text!");
+		cc.push608(EndOfCaption(channel_CC1));
+	}
+	
 	if (CC708Encoder.empty())
 	{
 		// If there is no caption data to be sent on this frame, generate a pad packet which includes the
@@ -375,7 +391,7 @@ int main()
 	IDeckLink*              deckLink         = NULL;
 	IDeckLinkOutput*        deckLinkOutput   = NULL;
 	OutputCallback*         outputCallback   = NULL;
-	CEA708::Encoder			CC708Encoder(kFrameDuration, kTimeScale);
+	CEA708::Encoder			CC708Encoder(kFrameDuration, kTimeScale, true);
 	HRESULT                 result;
 	
 	// Create an IDeckLinkIterator object to enumerate all DeckLink cards in the system
@@ -209,7 +209,7 @@ HRESULT DeckLinkInputDevice::VideoInputFormatChanged(BMDVideoInputFormatChangedE
 
 // Other methods
 
-bool DeckLinkInputDevice::startCapture(BMDDisplayMode displayMode, bool enable3D, BMDPixelFormat pixelFormat, BMDAudioSampleType audioSampleType, uint32_t audioChannelCount)
+bool DeckLinkInputDevice::startCapture(BMDDisplayMode displayMode, bool enable3D, BMDPixelFormat pixelFormat, BMDAudioSampleType audioSampleType, uint32_t audioChannelCount, BMDTimeScale streamTimescale)
 {
 	BMDVideoInputFlags				videoInputFlags = bmdVideoInputEnableFormatDetection;
 	com_ptr<IDeckLinkDisplayMode>	deckLinkDisplayMode;
@@ -227,6 +227,9 @@ bool DeckLinkInputDevice::startCapture(BMDDisplayMode displayMode, bool enable3D
 	if (deckLinkDisplayMode->GetFrameRate(&m_frameDuration, &m_frameTimescale) != S_OK)
 		return false;
 
+	if (streamTimescale != 0)
+		m_frameTimescale = streamTimescale;
+
 	// Register input callback
 	if (m_deckLinkInput->SetCallback(this) != S_OK)
 		return false;
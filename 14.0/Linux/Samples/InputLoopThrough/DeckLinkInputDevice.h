@@ -71,10 +71,13 @@ public:
 	HRESULT	STDMETHODCALLTYPE VideoInputFrameArrived(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioPacket) override;
 
 	// Other methods
-	bool	startCapture(BMDDisplayMode displayMode, bool enable3D, BMDPixelFormat pixelFormat, BMDAudioSampleType audioSampleType, uint32_t audioChannelCount);
+	// Stream times are in the timescale of the display mode, unless streamTimescale is non-zero
+	bool	startCapture(BMDDisplayMode displayMode, bool enable3D, BMDPixelFormat pixelFormat, BMDAudioSampleType audioSampleType, uint32_t audioChannelCount, BMDTimeScale streamTimescale = 0);
 	void	stopCapture(void);
 	void	setReadyForCapture(void);
 
+	BMDTimeScale	getStreamTimescale(void) const { return m_frameTimescale; }
+
 	void	onVideoFormatChange(const VideoFormatChangedCallback& callback) { m_videoFormatChangedCallback = callback; }
 	void	onVideoInputArrived(const VideoInputArrivedCallback& callback) { m_videoInputArrivedCallback = callback; }
 	void	onAudioInputArrived(const AudioInputArrivedCallback& callback) { m_audioInputArrivedCallback = callback; }
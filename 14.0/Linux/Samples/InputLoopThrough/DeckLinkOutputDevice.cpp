@@ -275,6 +275,12 @@ void DeckLinkOutputDevice::stopPlayback()
 		}
 	}
 
+	if (m_deckLinkKeyer)
+	{
+		m_deckLinkKeyer->Disable();
+		m_deckLinkKeyer = nullptr;
+	}
+
 	// Disable video and audio outputs
 	m_deckLinkOutput->DisableAudioOutput();
 	m_deckLinkOutput->DisableVideoOutput();
@@ -299,6 +305,32 @@ void DeckLinkOutputDevice::cancelWaitForReference()
 	}
 }
 
+bool DeckLinkOutputDevice::enableKeyer(bool external)
+{
+	com_ptr<IDeckLinkProfileAttributes>	deckLinkAttributes(IID_IDeckLinkProfileAttributes, m_deckLink);
+	dlbool_t							keyingSupported;
+
+	if (!deckLinkAttributes)
+		return false;
+
+	if ((deckLinkAttributes->GetFlag(external ? BMDDeckLinkSupportsExternalKeying : BMDDeckLinkSupportsInternalKeying, &keyingSupported) != S_OK) ||
+		!keyingSupported)
+		return false;
+
+	m_deckLinkKeyer = com_ptr<IDeckLinkKeyer>(IID_IDeckLinkKeyer, m_deckLink);
+	if (!m_deckLinkKeyer)
+		return false;
+
+	// Key at full level, the fill and key frames carry the graphic's alpha
+	if ((m_deckLinkKeyer->Enable(external) != S_OK) || (m_deckLinkKeyer->SetLevel(255) != S_OK))
+	{
+		m_deckLinkKeyer = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
 bool DeckLinkOutputDevice::getReferenceSignalMode(BMDDisplayMode* mode)
 {
 	com_ptr<IDeckLinkStatus> deckLinkStatus(IID_IDeckLinkStatus, m_deckLink);
@@ -86,6 +86,10 @@ public:
 
 	void						cancelWaitForReference();
 
+	// Key the output over the input with the internal keyer, or output fill and key for an external keyer.
+	// Requires an output pixel format with alpha, the keyer is disabled when playback stops.
+	bool						enableKeyer(bool external);
+
 	BMDTimeScale				getFrameTimescale(void) const { return m_frameTimescale; }
 	com_ptr<IDeckLinkOutput>	getDeckLinkOutput(void) const { return m_deckLinkOutput; }
 	bool						getReferenceSignalMode(BMDDisplayMode* mode);
@@ -102,6 +106,7 @@ private:
 	//
 	com_ptr<IDeckLink>										m_deckLink;
 	com_ptr<IDeckLinkOutput>								m_deckLinkOutput;
+	com_ptr<IDeckLinkKeyer>									m_deckLinkKeyer;
 	//
 	SampleQueue<std::shared_ptr<LoopThroughVideoFrame>>		m_outputVideoFrameQueue;
 	SampleQueue<std::shared_ptr<LoopThroughAudioPacket>>	m_outputAudioPacketQueue;
@@ -0,0 +1,182 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <algorithm>
+
+#include "GraphicsOverlay.h"
+
+// Graphic colours in BGRA, with straight alpha
+static const uint8_t kBandColor[4]		= { 96, 40, 16, 192 };
+static const uint8_t kAccentColor[4]	= { 0, 160, 255, 255 };
+static const uint8_t kBarColor[4]		= { 235, 235, 235, 255 };
+
+GraphicsOverlay::GraphicsOverlay(GraphicsKeyingMode mode, const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* displayMode) :
+	m_mode(mode),
+	m_width((uint32_t)displayMode->GetWidth()),
+	m_height((uint32_t)displayMode->GetHeight()),
+	m_framesPerSecond(1),
+	m_compositor(m_width, m_height, (m_height <= 576) ? kColorimetryRec601 : kColorimetryRec709),
+	m_graphics((size_t)m_width * m_height * 4, 0),
+	m_barFill(0),
+	m_lastStreamTime(-1),
+	m_keyFrames(deckLinkOutput, m_width, m_height, bmdFormat10BitYUVA, "fill and key")
+{
+	BMDTimeValue	frameDuration;
+	BMDTimeScale	timeScale;
+
+	if ((displayMode->GetFrameRate(&frameDuration, &timeScale) == S_OK) && (frameDuration > 0))
+		m_framesPerSecond = std::max((uint32_t)((timeScale + frameDuration / 2) / frameDuration), 1u);
+
+	drawBand();
+}
+
+void GraphicsOverlay::fillRect(const OverlayRect& rect, const uint8_t* bgra)
+{
+	for (uint32_t y = rect.y; y < rect.y + rect.height; y++)
+	{
+		uint8_t* pixel = m_graphics.data() + ((size_t)y * m_width + rect.x) * 4;
+
+		for (uint32_t x = 0; x < rect.width; x++, pixel += 4)
+			std::copy(bgra, bgra + 4, pixel);
+	}
+}
+
+void GraphicsOverlay::drawBand()
+{
+	// Lower third band above the bottom of the title safe area, with soft left and right edges
+	uint32_t	bandHeight		= std::max(m_height / 8, 8u);
+	uint32_t	accentHeight	= std::max(bandHeight / 16, 1u);
+	uint32_t	rampWidth		= bandHeight / 2;
+
+	m_band	= { m_width / 10, m_height * 9 / 10 - bandHeight, m_width - (m_width / 10) * 2, bandHeight };
+	m_bar	= { m_band.x + rampWidth, m_band.y + bandHeight * 5 / 8, m_band.width - rampWidth * 2, std::max(bandHeight / 8, 1u) };
+
+	fillRect(m_band, kBandColor);
+	fillRect({ m_band.x, m_band.y, m_band.width, accentHeight }, kAccentColor);
+
+	for (uint32_t y = m_band.y; y < m_band.y + m_band.height; y++)
+	{
+		uint8_t* row = m_graphics.data() + ((size_t)y * m_width + m_band.x) * 4;
+
+		for (uint32_t x = 0; x < rampWidth; x++)
+		{
+			row[x * 4 + 3]							= (uint8_t)(row[x * 4 + 3] * (x + 1) / rampWidth);
+			row[(m_band.width - 1 - x) * 4 + 3]		= (uint8_t)(row[(m_band.width - 1 - x) * 4 + 3] * (x + 1) / rampWidth);
+		}
+	}
+
+	m_compositor.UpdateOverlay(bmdFormat8BitBGRA, m_graphics.data(), m_width * 4, m_band, false);
+}
+
+void GraphicsOverlay::update(BMDTimeValue streamTime, BMDTimeValue frameDuration)
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	uint32_t					barFill;
+	OverlayRect					dirtyRect;
+
+	if ((frameDuration <= 0) || (streamTime <= m_lastStreamTime))
+		return;
+
+	m_lastStreamTime = streamTime;
+
+	// The bar fills once a second
+	barFill = (uint32_t)(((streamTime / frameDuration) % m_framesPerSecond + 1) * m_bar.width / m_framesPerSecond);
+	if (barFill == m_barFill)
+		return;
+
+	dirtyRect = { m_bar.x + std::min(barFill, m_barFill), m_bar.y, (barFill > m_barFill) ? barFill - m_barFill : m_barFill - barFill, m_bar.height };
+
+	fillRect(dirtyRect, (barFill > m_barFill) ? kBarColor : kBandColor);
+	m_barFill = barFill;
+
+	m_compositor.UpdateOverlay(bmdFormat8BitBGRA, m_graphics.data(), m_width * 4, dirtyRect, false);
+}
+
+bool GraphicsOverlay::keyVideoFrame(LoopThroughVideoFrame& videoFrame)
+{
+	IDeckLinkVideoFrame*	inputFrame = videoFrame.getVideoFramePtr();
+	HDRVideoFrame*			keyFrame;
+	std::vector<uint64_t>*	renderedVersions;
+	HDRMetadata				metadata;
+	void*					frameBytes;
+
+	if (m_mode == GraphicsKeyingMode::Software)
+	{
+		if ((inputFrame->GetPixelFormat() != bmdFormat10BitYUV) ||
+			((uint32_t)inputFrame->GetWidth() != m_width) || ((uint32_t)inputFrame->GetHeight() != m_height))
+			return false;
+
+		if (inputFrame->GetBytes(&frameBytes) != S_OK)
+			return false;
+
+		return m_compositor.CompositeV210(frameBytes, inputFrame->GetRowBytes()) == S_OK;
+	}
+
+	// The keyer modes output the graphic in place of the input frame
+	keyFrame = m_keyFrames.acquireFrame();
+	if (keyFrame == nullptr)
+		return false;
+
+	// Pooled frames are kept until the overlay is destroyed, so the versions of a frame are found by its pointer
+	{
+		std::lock_guard<std::mutex> lock(m_renderedVersionsMutex);
+		renderedVersions = &m_renderedVersions[keyFrame];
+	}
+
+	if ((keyFrame->GetBytes(&frameBytes) != S_OK) ||
+		(m_compositor.RenderAy10(frameBytes, keyFrame->GetRowBytes(), *renderedVersions) != S_OK))
+	{
+		m_keyFrames.releaseFrame(keyFrame);
+		return false;
+	}
+
+	// The graphic is SDR, in the colorspace of the compositor
+	metadata = HDRMetadata();
+	metadata.colorspace = (m_height <= 576) ? bmdColorspaceRec601 : bmdColorspaceRec709;
+	OutputFramePool::copyFrameProperties(inputFrame, keyFrame, metadata);
+
+	videoFrame.setVideoFrame(com_ptr<IDeckLinkVideoFrame>(keyFrame));
+	return true;
+}
+
+void GraphicsOverlay::releaseKeyFrame(IDeckLinkVideoFrame* frame)
+{
+	m_keyFrames.releaseFrame(frame);
+}
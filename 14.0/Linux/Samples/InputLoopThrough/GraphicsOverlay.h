@@ -0,0 +1,100 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Compositor.h"
+#include "DeckLinkAPI.h"
+#include "LoopThroughVideoFrame.h"
+#include "OutputFramePool.h"
+#include "com_ptr.h"
+
+enum class GraphicsKeyingMode
+{
+	None,				// Loop-through video is unchanged
+	Software,			// Graphics are composited over 10-bit YUV video on the CPU
+	InternalKeyer,		// Ay10 fill and key frames are output and keyed over the input by the DeckLink keyer
+	ExternalKeyer		// Ay10 fill and key frames are output on separate fill and key connectors for an external keyer
+};
+
+// GraphicsOverlay keys a lower third graphic over the loop-through video.  The graphic is drawn in BGRA
+// and converted by KeyingCompositor, with a seconds bar which advances each frame.  Only the changed part of
+// the bar is converted again, and for the keyer modes rendered again to the Ay10 fill and key frames, which
+// come from a pool of output frames with the RP188 timecodes of the input frame.
+class GraphicsOverlay
+{
+public:
+	GraphicsOverlay(GraphicsKeyingMode mode, const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* displayMode);
+	virtual ~GraphicsOverlay() = default;
+
+	// Draw the graphic for a frame, frames may be processed out of order so the graphic only moves forward
+	void	update(BMDTimeValue streamTime, BMDTimeValue frameDuration);
+
+	// Composite the graphic over a 10-bit YUV frame in place, or replace the frame with a fill and key frame
+	bool	keyVideoFrame(LoopThroughVideoFrame& videoFrame);
+
+	// Return a fill and key frame when its output has completed
+	void	releaseKeyFrame(IDeckLinkVideoFrame* frame);
+
+private:
+	GraphicsKeyingMode			m_mode;
+	uint32_t					m_width;
+	uint32_t					m_height;
+	uint32_t					m_framesPerSecond;
+	KeyingCompositor			m_compositor;
+	//
+	std::mutex					m_mutex;
+	std::vector<uint8_t>		m_graphics;			// BGRA with straight alpha
+	OverlayRect					m_band;
+	OverlayRect					m_bar;
+	uint32_t					m_barFill;
+	BMDTimeValue				m_lastStreamTime;
+	//
+	OutputFramePool				m_keyFrames;
+	std::mutex					m_renderedVersionsMutex;
+	std::map<IDeckLinkVideoFrame*, std::vector<uint64_t>>	m_renderedVersions;	// Overlay versions rendered to each pooled key frame
+
+	void		fillRect(const OverlayRect& rect, const uint8_t* bgra);
+	void		drawBand(void);
+};
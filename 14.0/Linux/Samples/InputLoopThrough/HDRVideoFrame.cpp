@@ -0,0 +1,243 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <cstring>
+#include "HDRVideoFrame.h"
+
+struct FloatMetadataItem
+{
+	BMDDeckLinkFrameMetadataID	metadataID;
+	double HDRMetadata::*		value;
+};
+
+static const FloatMetadataItem kFloatMetadataItems[] =
+{
+	{ bmdDeckLinkFrameMetadataHDRMaxDisplayMasteringLuminance,		&HDRMetadata::maxDisplayMasteringLuminance },
+	{ bmdDeckLinkFrameMetadataHDRMinDisplayMasteringLuminance,		&HDRMetadata::minDisplayMasteringLuminance },
+	{ bmdDeckLinkFrameMetadataHDRMaximumContentLightLevel,			&HDRMetadata::maxCLL },
+	{ bmdDeckLinkFrameMetadataHDRMaximumFrameAverageLightLevel,		&HDRMetadata::maxFALL },
+};
+
+struct PrimariesMetadataItem
+{
+	BMDDeckLinkFrameMetadataID			metadataID;
+	double ChromaticityCoordinates::*	value;
+};
+
+static const PrimariesMetadataItem kPrimariesMetadataItems[] =
+{
+	{ bmdDeckLinkFrameMetadataHDRDisplayPrimariesRedX,		&ChromaticityCoordinates::RedX },
+	{ bmdDeckLinkFrameMetadataHDRDisplayPrimariesRedY,		&ChromaticityCoordinates::RedY },
+	{ bmdDeckLinkFrameMetadataHDRDisplayPrimariesGreenX,	&ChromaticityCoordinates::GreenX },
+	{ bmdDeckLinkFrameMetadataHDRDisplayPrimariesGreenY,	&ChromaticityCoordinates::GreenY },
+	{ bmdDeckLinkFrameMetadataHDRDisplayPrimariesBlueX,		&ChromaticityCoordinates::BlueX },
+	{ bmdDeckLinkFrameMetadataHDRDisplayPrimariesBlueY,		&ChromaticityCoordinates::BlueY },
+	{ bmdDeckLinkFrameMetadataHDRWhitePointX,				&ChromaticityCoordinates::WhiteX },
+	{ bmdDeckLinkFrameMetadataHDRWhitePointY,				&ChromaticityCoordinates::WhiteY },
+};
+
+HDRVideoFrame::HDRVideoFrame(const com_ptr<IDeckLinkMutableVideoFrame>& frame) :
+	m_videoFrame(frame),
+	m_metadata(),
+	m_refCount(1)
+{
+	m_metadata.colorspace = bmdColorspaceRec709;
+}
+
+void HDRVideoFrame::readMetadata(IDeckLinkVideoFrame* frame, HDRMetadata& metadata)
+{
+	com_ptr<IDeckLinkVideoFrameMetadataExtensions>	metadataExtensions(IID_IDeckLinkVideoFrameMetadataExtensions, com_ptr<IDeckLinkVideoFrame>(frame));
+	int64_t											intValue;
+
+	metadata = HDRMetadata();
+	metadata.colorspace = bmdColorspaceRec709;
+
+	if (!metadataExtensions)
+		return;
+
+	if (metadataExtensions->GetInt(bmdDeckLinkFrameMetadataColorspace, &intValue) == S_OK)
+		metadata.colorspace = (BMDColorspace)intValue;
+
+	// Static HDR metadata is only valid when the frame is flagged
+	if ((frame->GetFlags() & bmdFrameContainsHDRMetadata) == 0)
+		return;
+
+	metadata.containsHDRMetadata = true;
+
+	if (metadataExtensions->GetInt(bmdDeckLinkFrameMetadataHDRElectroOpticalTransferFunc, &intValue) == S_OK)
+		metadata.EOTF = intValue;
+
+	for (const FloatMetadataItem& item : kFloatMetadataItems)
+		metadataExtensions->GetFloat(item.metadataID, &(metadata.*item.value));
+
+	for (const PrimariesMetadataItem& item : kPrimariesMetadataItems)
+		metadataExtensions->GetFloat(item.metadataID, &(metadata.referencePrimaries.*item.value));
+}
+
+/// IUnknown methods
+
+HRESULT HDRVideoFrame::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	CFUUIDBytes		iunknown;
+	HRESULT			result		= S_OK;
+
+	if (ppv == nullptr)
+		return E_INVALIDARG;
+
+	// Initialise the return result
+	*ppv = nullptr;
+
+	iunknown = CFUUIDGetUUIDBytes(IUnknownUUID);
+	if (std::memcmp(&iid, &iunknown, sizeof(REFIID)) == 0)
+	{
+		*ppv = this;
+		AddRef();
+	}
+	else if (std::memcmp(&iid, &IID_IDeckLinkVideoFrame, sizeof(REFIID)) == 0)
+	{
+		*ppv = static_cast<IDeckLinkVideoFrame*>(this);
+		AddRef();
+	}
+	else if (std::memcmp(&iid, &IID_IDeckLinkVideoFrameMetadataExtensions, sizeof(REFIID)) == 0)
+	{
+		*ppv = static_cast<IDeckLinkVideoFrameMetadataExtensions*>(this);
+		AddRef();
+	}
+	else
+	{
+		result = E_NOINTERFACE;
+	}
+
+	return result;
+}
+
+ULONG HDRVideoFrame::AddRef(void)
+{
+	return ++m_refCount;
+}
+
+ULONG HDRVideoFrame::Release(void)
+{
+	ULONG newRefValue = --m_refCount;
+
+	if (newRefValue == 0)
+		delete this;
+
+	return newRefValue;
+}
+
+/// IDeckLinkVideoFrame methods
+
+BMDFrameFlags HDRVideoFrame::GetFlags(void)
+{
+	BMDFrameFlags flags = m_videoFrame->GetFlags() & ~bmdFrameContainsHDRMetadata;
+
+	return m_metadata.containsHDRMetadata ? (flags | bmdFrameContainsHDRMetadata) : flags;
+}
+
+/// IDeckLinkVideoFrameMetadataExtensions methods
+
+HRESULT HDRVideoFrame::GetInt(BMDDeckLinkFrameMetadataID metadataID, int64_t* value)
+{
+	switch (metadataID)
+	{
+		case bmdDeckLinkFrameMetadataHDRElectroOpticalTransferFunc:
+			if (!m_metadata.containsHDRMetadata)
+				break;
+
+			*value = m_metadata.EOTF;
+			return S_OK;
+
+		case bmdDeckLinkFrameMetadataColorspace:
+			*value = m_metadata.colorspace;
+			return S_OK;
+
+		default:
+			break;
+	}
+
+	return E_INVALIDARG;
+}
+
+HRESULT HDRVideoFrame::GetFloat(BMDDeckLinkFrameMetadataID metadataID, double* value)
+{
+	if (!m_metadata.containsHDRMetadata)
+		return E_INVALIDARG;
+
+	for (const FloatMetadataItem& item : kFloatMetadataItems)
+	{
+		if (item.metadataID == metadataID)
+		{
+			*value = m_metadata.*item.value;
+			return S_OK;
+		}
+	}
+
+	for (const PrimariesMetadataItem& item : kPrimariesMetadataItems)
+	{
+		if (item.metadataID == metadataID)
+		{
+			*value = m_metadata.referencePrimaries.*item.value;
+			return S_OK;
+		}
+	}
+
+	return E_INVALIDARG;
+}
+
+HRESULT HDRVideoFrame::GetFlag(BMDDeckLinkFrameMetadataID, bool* value)
+{
+	// Not expecting GetFlag
+	*value = false;
+	return E_INVALIDARG;
+}
+
+HRESULT HDRVideoFrame::GetString(BMDDeckLinkFrameMetadataID, const char** value)
+{
+	// Not expecting GetString
+	*value = nullptr;
+	return E_INVALIDARG;
+}
+
+HRESULT	HDRVideoFrame::GetBytes(BMDDeckLinkFrameMetadataID, void*, uint32_t* bufferSize)
+{
+	*bufferSize = 0;
+	return E_INVALIDARG;
+}
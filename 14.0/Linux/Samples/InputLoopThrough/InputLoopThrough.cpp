@@ -66,7 +66,25 @@
 //
 // Additional considerations:
 // * Ensure that a valid input source is provided with a display mode that is supported by
-//     both input and output devices
+//     the input device, and by the output device unless the output display mode is selected
+// * The output display mode can differ from the input, defined by constant kOutputDisplayMode, see
+//     VideoFrameScaler.h
+//   - 10-bit YUV video is scaled in processVideo() by a polyphase scaler, with the filter defined by
+//     constant kScalerFilter, for up, down and cross conversion between modes of the same frame rate
+// * Interlaced video can be deinterlaced to a progressive display mode, defined by constant kDeinterlace,
+//     see VideoFrameDeinterlacer.h
+//   - 8-bit and 10-bit YUV video is deinterlaced by a motion adaptive filter in processInterlacedVideo(),
+//     at single or double rate as defined by constant kDeinterlaceRate, before it is scaled or keyed
+//   - Each frame is held until the next frame arrives, which adds one frame to the processing latency
+// * HDR video can be converted to another transfer function, defined by constant kToneMap, see
+//     VideoFrameToneMapper.h
+//   - 10-bit YUV video with PQ or HLG metadata is tone mapped in processVideo() to the transfer function
+//     defined by constant kToneMapTransferFunction, PQ to HLG, PQ to SDR or HLG to SDR, before it is scaled
+//   - The conversion tables are computed from the HDR metadata of the input frames, and rebuilt when it changes
+// * A 3D LUT can be applied to the video for show looks and camera matching, defined by constant kLUTFile,
+//     see VideoFrameLUT.h
+//   - The .cube file of 17, 33 or 65 points is loaded at startup, and applied in processVideo() after tone
+//     mapping and before scaling, to 10-bit and 12-bit RGB video directly and to YUV video through R'G'B'
 // * Out of the box, the video processing thread, defined by function processVideo(),
 //     injects a random sleep time into the pipeline.  The time's mean and standard
 //     deviation can be adjusted by constants kProcessingAdditionalTimeMean and
@@ -78,6 +96,13 @@
 //   - When set to false, the latency for every output frame is displayed to stdout
 //   - In both modes or operation, a full statistical summary is displayed when application
 //     completes
+// * Graphics can be keyed over the video, defined by constant kGraphicsKeyingMode, see GraphicsOverlay.h
+//   - Software keying composites a lower third graphic over 10-bit YUV video in processVideo(), in place
+//     of the simulated processing time
+//   - Internal and external keying output Ay10 fill and key frames of the graphic, keyed by the DeckLink
+//     keyer over the input or by an external keyer
+// * Timecode, frame number, input device name and stream time can be burnt into the video, defined by constant
+//   kBurnInTimecode, see TimecodeBurnIn.h.  The timecode is the input's RP188 or VITC timecode when it has one.
 //*************************************************************************************/
 
 
@@ -93,6 +118,12 @@
 #include "DeckLinkInputDevice.h"
 #include "DeckLinkOutputDevice.h"
 #include "DispatchQueue.h"
+#include "GraphicsOverlay.h"
+#include "TimecodeBurnIn.h"
+#include "VideoFrameDeinterlacer.h"
+#include "VideoFrameLUT.h"
+#include "VideoFrameScaler.h"
+#include "VideoFrameToneMapper.h"
 #include "SampleQueue.h"
 #include "LatencyStatistics.h"
 #include "ReferenceTime.h"
@@ -118,6 +149,21 @@ const long					kRollingAverageUpdateRateMs	= 2000;		// Print rolling average eve
 const double				kProcessingAdditionalTimeMean		= 5.0;		// Mean additional time injected into video processing thread (ms)
 const double				kProcessingAdditionalTimeStdDev		= 0.1;		// Standard deviation of time injected into video processing thread (ms)
 
+const GraphicsKeyingMode	kGraphicsKeyingMode			= GraphicsKeyingMode::None;		// Key a lower third graphic over the loop-through video
+
+const BMDDisplayMode		kOutputDisplayMode			= bmdModeUnknown;		// Output display mode, or bmdModeUnknown to output the input display mode
+const VideoScalerFilter		kScalerFilter				= kVideoScalerLanczos3;	// Filter for scaling to the output display mode
+
+const bool					kDeinterlace				= false;					// If true, deinterlace interlaced input to a progressive output display mode
+const DeinterlacerRate		kDeinterlaceRate			= kDeinterlacerDoubleRate;	// Output a frame for each field, or single rate for each input frame
+
+const bool					kToneMap					= false;			// If true, convert HDR input to the output transfer function
+const TransferFunction		kToneMapTransferFunction	= kTransferSDR;		// Output transfer function, kTransferSDR or kTransferHLG
+
+const char* const			kLUTFile					= nullptr;			// Path of a .cube 3D LUT to apply to the video, or nullptr
+
+const bool					kBurnInTimecode				= false;			// If true, burn timecode, frame number, device name and stream time into the video
+
 // Output frame completion result pair = { Completion result string, frame output boolean}
 const std::map<BMDOutputFrameCompletionResult, std::pair<const char*, bool>> kOutputCompletionResults
 {
@@ -226,11 +272,19 @@ void dispatch_printf(DispatchQueue& dispatchQueue, const char* format, Args... a
 	});
 }
 
-void processVideo(std::shared_ptr<LoopThroughVideoFrame>& videoFrame, com_ptr<DeckLinkOutputDevice>& deckLinkOutput)
+void processVideo(std::shared_ptr<LoopThroughVideoFrame>& videoFrame, com_ptr<DeckLinkOutputDevice>& deckLinkOutput, std::shared_ptr<VideoFrameDeinterlacer>& videoFrameDeinterlacer,
+				  std::shared_ptr<VideoFrameToneMapper>& videoFrameToneMapper, std::shared_ptr<VideoFrameLUT>& videoFrameLUT, std::shared_ptr<VideoFrameScaler>& videoFrameScaler,
+				  std::shared_ptr<TimecodeBurnIn>& timecodeBurnIn, std::shared_ptr<GraphicsOverlay>& graphicsOverlay)
 {
 	// Main video processing function, it is intended to invoke with DispatchQueue to allow multi-threading of incoming frames
 	// Inputs:	videoFrame - input/output video frame with stream time
 	//			deckLinkOutput - reference to IDeckLinkOutput
+	//			videoFrameDeinterlacer - deinterlacer of the frame when it is a deinterlaced frame, or null
+	//			videoFrameToneMapper - tone mapper to the output transfer function, or null
+	//			videoFrameLUT - 3D LUT applied to the video, or null
+	//			videoFrameScaler - scaler to the output display mode, or null
+	//			timecodeBurnIn - timecode burnt into the video, or null
+	//			graphicsOverlay - graphic to key over the video, or null
 	// At end of function, queue output frame for scheduling by calling deckLinkOutput->scheduleVideoFrame
 	//
 	// Developers are encouraged to insert their own processing test code in this function, by default we will simply forward the LoopThroughVideoFrame object.
@@ -240,18 +294,124 @@ void processVideo(std::shared_ptr<LoopThroughVideoFrame>& videoFrame, com_ptr<De
 	if (!deckLinkOutput->isPlaybackActive())
 		return;
 
-	// Simulate doing something by using a busy wait loop
-	// This is more precise than sleeping
-	int delay = (int)std::round(g_sleepDistribution(g_randomEngine) * 1000);
-	auto target = std::chrono::steady_clock::now() + std::chrono::microseconds(delay);
-	uint32_t i = 0;
-	while (std::chrono::steady_clock::now() < target)
-		++i;
+	if (videoFrameToneMapper)
+	{
+		IDeckLinkVideoFrame*	inputFrame	= videoFrame->getVideoFramePtr();
+		bool					toneMapped	= videoFrameToneMapper->toneMapVideoFrame(*videoFrame);
+
+		// The tone mapped frame replaces a deinterlaced frame
+		if (videoFrameDeinterlacer && (!toneMapped || (videoFrame->getVideoFramePtr() != inputFrame)))
+			videoFrameDeinterlacer->releaseDeinterlacedFrame(inputFrame);
+
+		if (!toneMapped)
+		{
+			fprintf(stderr, "Unable to tone map video frame to output transfer function\n");
+			return;
+		}
+	}
+
+	if (videoFrameLUT)
+	{
+		IDeckLinkVideoFrame*	inputFrame	= videoFrame->getVideoFramePtr();
+		bool					mapped		= videoFrameLUT->applyLUT(*videoFrame);
+
+		// The mapped frame replaces a deinterlaced or tone mapped frame
+		if (videoFrameDeinterlacer)
+			videoFrameDeinterlacer->releaseDeinterlacedFrame(inputFrame);
+		if (videoFrameToneMapper)
+			videoFrameToneMapper->releaseToneMappedFrame(inputFrame);
+
+		if (!mapped)
+		{
+			fprintf(stderr, "Unable to apply 3D LUT to video frame\n");
+			return;
+		}
+	}
+
+	if (videoFrameScaler)
+	{
+		IDeckLinkVideoFrame*	inputFrame	= videoFrame->getVideoFramePtr();
+		bool					scaled		= videoFrameScaler->scaleVideoFrame(*videoFrame);
+
+		// The scaled frame replaces a deinterlaced, tone mapped or 3D LUT frame
+		if (videoFrameDeinterlacer)
+			videoFrameDeinterlacer->releaseDeinterlacedFrame(inputFrame);
+		if (videoFrameToneMapper)
+			videoFrameToneMapper->releaseToneMappedFrame(inputFrame);
+		if (videoFrameLUT)
+			videoFrameLUT->releaseLUTFrame(inputFrame);
+
+		if (!scaled)
+		{
+			fprintf(stderr, "Unable to scale video frame to output display mode\n");
+			return;
+		}
+	}
+
+	if (timecodeBurnIn)
+	{
+		// The text is burnt into the frame in place, under any graphics
+		if (timecodeBurnIn->BurnIn(videoFrame->getVideoFramePtr(), videoFrame->getVideoStreamTime(), videoFrame->getVideoFrameDuration()) != S_OK)
+			fprintf(stderr, "Unable to burn timecode into video frame\n");
+	}
+
+	if (graphicsOverlay)
+	{
+		// Key the graphic over the frame, or replace the frame with the graphic's fill and key
+		graphicsOverlay->update(videoFrame->getVideoStreamTime(), videoFrame->getVideoFrameDuration());
+
+		if (!graphicsOverlay->keyVideoFrame(*videoFrame))
+			fprintf(stderr, "Unable to key graphics over video frame\n");
+	}
+	else if (!videoFrameScaler && !videoFrameDeinterlacer && !videoFrameToneMapper && !videoFrameLUT && !timecodeBurnIn)
+	{
+		// Simulate doing something by using a busy wait loop
+		// This is more precise than sleeping
+		int delay = (int)std::round(g_sleepDistribution(g_randomEngine) * 1000);
+		auto target = std::chrono::steady_clock::now() + std::chrono::microseconds(delay);
+		uint32_t i = 0;
+		while (std::chrono::steady_clock::now() < target)
+			++i;
+	}
 
 	// At end of function, remember to queue your output frame
 	deckLinkOutput->scheduleVideoFrame(std::move(videoFrame));
 }
 
+void processInterlacedVideo(std::shared_ptr<VideoFrameDeinterlacer::InputFrames>& inputFrames, com_ptr<DeckLinkOutputDevice>& deckLinkOutput, std::shared_ptr<VideoFrameDeinterlacer>& videoFrameDeinterlacer,
+							std::shared_ptr<VideoFrameToneMapper>& videoFrameToneMapper, std::shared_ptr<VideoFrameLUT>& videoFrameLUT, std::shared_ptr<VideoFrameScaler>& videoFrameScaler,
+							std::shared_ptr<TimecodeBurnIn>& timecodeBurnIn, std::shared_ptr<GraphicsOverlay>& graphicsOverlay)
+{
+	// Interlaced video processing function, it is invoked with DispatchQueue for each input frame once the next frame has arrived
+	// Inputs:	inputFrames - input video frame with stream time, and the frames before and after it
+	//			deckLinkOutput - reference to IDeckLinkOutput
+	//			videoFrameDeinterlacer - deinterlacer to the progressive display mode
+	//			videoFrameToneMapper - tone mapper to the output transfer function, or null
+	//			videoFrameLUT - 3D LUT applied to the video, or null
+	//			videoFrameScaler - scaler to the output display mode, or null
+	//			timecodeBurnIn - timecode burnt into the video, or null
+	//			graphicsOverlay - graphic to key over the video, or null
+	// Each deinterlaced frame is processed by processVideo as an input frame
+	std::vector<std::shared_ptr<LoopThroughVideoFrame>> deinterlacedFrames;
+
+	if (!deckLinkOutput->isPlaybackActive())
+		return;
+
+	if (!videoFrameDeinterlacer->deinterlaceVideoFrame(*inputFrames, deinterlacedFrames))
+	{
+		fprintf(stderr, "Unable to deinterlace video frame\n");
+
+		for (auto& deinterlacedFrame : deinterlacedFrames)
+			videoFrameDeinterlacer->releaseDeinterlacedFrame(deinterlacedFrame->getVideoFramePtr());
+		return;
+	}
+
+	// Release the input frames before the deinterlaced frames are processed
+	inputFrames = nullptr;
+
+	for (auto& deinterlacedFrame : deinterlacedFrames)
+		processVideo(deinterlacedFrame, deckLinkOutput, videoFrameDeinterlacer, videoFrameToneMapper, videoFrameLUT, videoFrameScaler, timecodeBurnIn, graphicsOverlay);
+}
 
 void processAudio(std::shared_ptr<LoopThroughAudioPacket>& audioPacket, com_ptr<DeckLinkOutputDevice>& deckLinkOutput)
 {
@@ -470,6 +630,154 @@ void printReferenceStatus(com_ptr<DeckLinkOutputDevice>& deckLinkOutput, Dispatc
 	}
 }
 
+std::shared_ptr<VideoFrameScaler> createVideoFrameScaler(com_ptr<DeckLinkOutputDevice>& deckLinkOutput, const FormatDescription& inputFormatDesc,
+														 BMDDisplayMode outputDisplayMode, bool useKeyer, DispatchQueue& printDispatchQueue)
+{
+	com_ptr<IDeckLinkDisplayMode>	inputDeckLinkDisplayMode;
+	com_ptr<IDeckLinkDisplayMode>	outputDeckLinkDisplayMode;
+	BMDTimeValue					inputFrameDuration;
+	BMDTimeScale					inputTimeScale;
+	BMDTimeValue					outputFrameDuration;
+	BMDTimeScale					outputTimeScale;
+
+	// The keyers require the output display mode to match the input
+	if (useKeyer || inputFormatDesc.is3D || (inputFormatDesc.pixelFormat != bmdFormat10BitYUV))
+	{
+		dispatch_printf(printDispatchQueue, "Warning: Scaling requires 2D 10-bit YUV video without the keyer, output is the input display mode.\n");
+		return nullptr;
+	}
+
+	if ((deckLinkOutput->getDeckLinkOutput()->GetDisplayMode(inputFormatDesc.displayMode, inputDeckLinkDisplayMode.releaseAndGetAddressOf()) != S_OK) ||
+		(deckLinkOutput->getDeckLinkOutput()->GetDisplayMode(outputDisplayMode, outputDeckLinkDisplayMode.releaseAndGetAddressOf()) != S_OK) ||
+		(inputDeckLinkDisplayMode->GetFrameRate(&inputFrameDuration, &inputTimeScale) != S_OK) ||
+		(outputDeckLinkDisplayMode->GetFrameRate(&outputFrameDuration, &outputTimeScale) != S_OK))
+	{
+		fprintf(stderr, "Unable to get input and output display modes for scaling\n");
+		return nullptr;
+	}
+
+	// Frames are output with the stream times of the input frames, so the frame rates must be equal
+	if ((inputFrameDuration != outputFrameDuration) || (inputTimeScale != outputTimeScale))
+	{
+		dispatch_printf(printDispatchQueue, "Warning: Output display mode has a different frame rate to the input, output is the input display mode.\n");
+		return nullptr;
+	}
+
+	return std::make_shared<VideoFrameScaler>(deckLinkOutput->getDeckLinkOutput(), inputDeckLinkDisplayMode.get(), outputDeckLinkDisplayMode.get(), kScalerFilter);
+}
+
+std::shared_ptr<VideoFrameToneMapper> createVideoFrameToneMapper(com_ptr<DeckLinkOutputDevice>& deckLinkOutput, const FormatDescription& formatDesc, bool useKeyer,
+																 DispatchQueue& printDispatchQueue)
+{
+	com_ptr<IDeckLinkDisplayMode> deckLinkDisplayMode;
+
+	// The keyers output the graphic in place of the video
+	if (useKeyer || formatDesc.is3D || (formatDesc.pixelFormat != bmdFormat10BitYUV))
+	{
+		dispatch_printf(printDispatchQueue, "Warning: Tone mapping requires 2D 10-bit YUV video without the keyer, video is not tone mapped.\n");
+		return nullptr;
+	}
+
+	if (deckLinkOutput->getDeckLinkOutput()->GetDisplayMode(formatDesc.displayMode, deckLinkDisplayMode.releaseAndGetAddressOf()) != S_OK)
+	{
+		fprintf(stderr, "Unable to get display mode for tone mapping\n");
+		return nullptr;
+	}
+
+	return std::make_shared<VideoFrameToneMapper>(deckLinkOutput->getDeckLinkOutput(), deckLinkDisplayMode.get(), kToneMapTransferFunction);
+}
+
+std::shared_ptr<VideoFrameLUT> createVideoFrameLUT(com_ptr<DeckLinkOutputDevice>& deckLinkOutput, const FormatDescription& formatDesc, bool useKeyer,
+												   const CubeLUT& lut, DispatchQueue& printDispatchQueue)
+{
+	com_ptr<IDeckLinkDisplayMode> deckLinkDisplayMode;
+
+	// The keyers output the graphic in place of the video
+	if (useKeyer || formatDesc.is3D || !LUTProcessor::IsPixelFormatSupported(formatDesc.pixelFormat))
+	{
+		dispatch_printf(printDispatchQueue, "Warning: 3D LUT requires 2D video without the keyer, 3D LUT is not applied.\n");
+		return nullptr;
+	}
+
+	if (deckLinkOutput->getDeckLinkOutput()->GetDisplayMode(formatDesc.displayMode, deckLinkDisplayMode.releaseAndGetAddressOf()) != S_OK)
+	{
+		fprintf(stderr, "Unable to get display mode for 3D LUT\n");
+		return nullptr;
+	}
+
+	return std::make_shared<VideoFrameLUT>(deckLinkOutput->getDeckLinkOutput(), deckLinkDisplayMode.get(), formatDesc.pixelFormat, lut);
+}
+
+std::shared_ptr<VideoFrameDeinterlacer> createVideoFrameDeinterlacer(com_ptr<DeckLinkOutputDevice>& deckLinkOutput, const FormatDescription& inputFormatDesc, bool useKeyer,
+																	 BMDDisplayMode& outputDisplayMode, BMDTimeScale& outputTimeScale, DispatchQueue& printDispatchQueue)
+{
+	com_ptr<IDeckLinkDisplayMode>			inputDeckLinkDisplayMode;
+	com_ptr<IDeckLinkDisplayModeIterator>	displayModeIterator;
+	com_ptr<IDeckLinkDisplayMode>			deckLinkDisplayMode;
+	BMDTimeValue							inputFrameDuration;
+	BMDTimeScale							inputTimeScale;
+	BMDFieldDominance						fieldDominance;
+	int64_t									outputFramesPerInputFrame = (kDeinterlaceRate == kDeinterlacerDoubleRate) ? 2 : 1;
+
+	if ((deckLinkOutput->getDeckLinkOutput()->GetDisplayMode(inputFormatDesc.displayMode, inputDeckLinkDisplayMode.releaseAndGetAddressOf()) != S_OK) ||
+		(inputDeckLinkDisplayMode->GetFrameRate(&inputFrameDuration, &inputTimeScale) != S_OK))
+	{
+		fprintf(stderr, "Unable to get input display mode for deinterlacing\n");
+		return nullptr;
+	}
+
+	// Progressive video is output unchanged
+	fieldDominance = inputDeckLinkDisplayMode->GetFieldDominance();
+	if ((fieldDominance != bmdLowerFieldFirst) && (fieldDominance != bmdUpperFieldFirst))
+		return nullptr;
+
+	if (useKeyer || inputFormatDesc.is3D || ((inputFormatDesc.pixelFormat != bmdFormat10BitYUV) && (inputFormatDesc.pixelFormat != bmdFormat8BitYUV)))
+	{
+		dispatch_printf(printDispatchQueue, "Warning: Deinterlacing requires 2D 8-bit or 10-bit YUV video without the keyer, video is not deinterlaced.\n");
+		return nullptr;
+	}
+
+	// Find a progressive display mode of the same frame size, at the input frame rate or twice the rate
+	outputDisplayMode = bmdModeUnknown;
+
+	if (deckLinkOutput->getDeckLinkOutput()->GetDisplayModeIterator(displayModeIterator.releaseAndGetAddressOf()) == S_OK)
+	{
+		while (displayModeIterator->Next(deckLinkDisplayMode.releaseAndGetAddressOf()) == S_OK)
+		{
+			BMDTimeValue	frameDuration;
+			BMDTimeScale	timeScale;
+
+			if ((deckLinkDisplayMode->GetFieldDominance() != bmdProgressiveFrame) ||
+				(deckLinkDisplayMode->GetWidth() != inputDeckLinkDisplayMode->GetWidth()) ||
+				(deckLinkDisplayMode->GetHeight() != inputDeckLinkDisplayMode->GetHeight()) ||
+				(deckLinkDisplayMode->GetFrameRate(&frameDuration, &timeScale) != S_OK))
+				continue;
+
+			if (frameDuration * inputTimeScale * outputFramesPerInputFrame == inputFrameDuration * timeScale)
+			{
+				outputDisplayMode	= deckLinkDisplayMode->GetDisplayMode();
+				outputTimeScale		= timeScale;
+				break;
+			}
+		}
+	}
+
+	if (outputDisplayMode == bmdModeUnknown)
+	{
+		if (kDeinterlaceRate == kDeinterlacerDoubleRate)
+		{
+			dispatch_printf(printDispatchQueue, "Warning: No progressive output display mode at twice the input frame rate, video is not deinterlaced.\n");
+			return nullptr;
+		}
+
+		// Single rate frames are output in the input display mode
+		outputDisplayMode	= inputFormatDesc.displayMode;
+		outputTimeScale		= inputTimeScale;
+	}
+
+	return std::make_shared<VideoFrameDeinterlacer>(deckLinkOutput->getDeckLinkOutput(), inputDeckLinkDisplayMode.get(), inputFormatDesc.pixelFormat, kDeinterlaceRate);
+}
+
 HRESULT InputLoopThrough(void)
 {
 	HRESULT								result = S_OK;
@@ -478,6 +786,7 @@ HRESULT InputLoopThrough(void)
 	com_ptr<IDeckLink>					deckLink;
 	com_ptr<DeckLinkInputDevice>		deckLinkInput;
 	com_ptr<DeckLinkOutputDevice>		deckLinkOutput;
+	std::string							inputDeviceName;
 
 	DispatchQueue 						videoDispatchQueue(kVideoDispatcherThreadCount);
 	DispatchQueue 						audioDispatchQueue(kAudioDispatcherThreadCount);
@@ -538,7 +847,8 @@ HRESULT InputLoopThrough(void)
 						continue;
 					}
 					g_audioChannelCount = std::min((uint32_t)maxAudioChannels, g_audioChannelCount);
-					dispatch_printf(printDispatchQueue, "Using input device: %s\n", getDeckLinkDisplayName(deckLink).c_str());
+					inputDeviceName = getDeckLinkDisplayName(deckLink);
+					dispatch_printf(printDispatchQueue, "Using input device: %s\n", inputDeviceName.c_str());
 				}
 
 				// If input device is half duplex, skip output discovery
@@ -589,9 +899,25 @@ HRESULT InputLoopThrough(void)
 		return E_FAIL;
 	}
 
+	CubeLUT lut;
+
+	if ((kLUTFile != nullptr) && (lut.LoadFile(kLUTFile) != S_OK))
+	{
+		fprintf(stderr, "Unable to load 3D LUT from %s\n", kLUTFile);
+		return E_INVALIDARG;
+	}
+
 	std::mutex formatDescMutex;
 	FormatDescription formatDesc = { kInitialDisplayMode, false, kInitialPixelFormat };
 
+	std::shared_ptr<VideoFrameDeinterlacer> videoFrameDeinterlacer;
+	std::shared_ptr<VideoFrameToneMapper> videoFrameToneMapper;
+	std::shared_ptr<VideoFrameLUT> videoFrameLUT;
+	std::shared_ptr<VideoFrameScaler> videoFrameScaler;
+	std::shared_ptr<TimecodeBurnIn> timecodeBurnIn;
+	std::shared_ptr<GraphicsOverlay> graphicsOverlay;
+	bool useKeyer = (kGraphicsKeyingMode == GraphicsKeyingMode::InternalKeyer) || (kGraphicsKeyingMode == GraphicsKeyingMode::ExternalKeyer);
+
 	// Monitor for keypress when user wants to exit
 	std::thread userInputThread = std::thread([&] {
 		getchar();
@@ -620,24 +946,98 @@ HRESULT InputLoopThrough(void)
 			g_loopThroughSessionNotifier.condition.notify_all();
 		});
 
-		deckLinkInput->onVideoInputArrived([&](std::shared_ptr<LoopThroughVideoFrame> videoFrame) { videoDispatchQueue.dispatch(processVideo, videoFrame, deckLinkOutput); });
+		deckLinkInput->onVideoInputArrived([&](std::shared_ptr<LoopThroughVideoFrame> videoFrame) {
+			if (videoFrameDeinterlacer)
+			{
+				// Interlaced frames are held in stream order until the next frame arrives
+				auto inputFrames = std::make_shared<VideoFrameDeinterlacer::InputFrames>();
+				if (videoFrameDeinterlacer->addInputFrame(std::move(videoFrame), *inputFrames))
+					videoDispatchQueue.dispatch(processInterlacedVideo, inputFrames, deckLinkOutput, videoFrameDeinterlacer, videoFrameToneMapper, videoFrameLUT, videoFrameScaler, timecodeBurnIn, graphicsOverlay);
+			}
+			else
+			{
+				videoDispatchQueue.dispatch(processVideo, videoFrame, deckLinkOutput, videoFrameDeinterlacer, videoFrameToneMapper, videoFrameLUT, videoFrameScaler, timecodeBurnIn, graphicsOverlay);
+			}
+		});
 		deckLinkInput->onAudioInputArrived([&](std::shared_ptr<LoopThroughAudioPacket> audioPacket) { audioDispatchQueue.dispatch(processAudio, audioPacket, deckLinkOutput); });
 		deckLinkInput->onVideoInputFrameDropped([&](BMDTimeValue streamTime, BMDTimeValue frameDuration, BMDTimeScale) { printDroppedCaptureFrame(streamTime, frameDuration, std::ref(printDispatchQueue)); });
 
 		// Register output callbacks
-		deckLinkOutput->onScheduledFrameCompleted([&](std::shared_ptr<LoopThroughVideoFrame> videoFrame) { updateCompletedFrameLatency(videoFrame, std::ref(printDispatchQueue)); });
+		deckLinkOutput->onScheduledFrameCompleted([&](std::shared_ptr<LoopThroughVideoFrame> videoFrame) {
+			if (videoFrameDeinterlacer)
+				videoFrameDeinterlacer->releaseDeinterlacedFrame(videoFrame->getVideoFramePtr());
+			if (videoFrameToneMapper)
+				videoFrameToneMapper->releaseToneMappedFrame(videoFrame->getVideoFramePtr());
+			if (videoFrameLUT)
+				videoFrameLUT->releaseLUTFrame(videoFrame->getVideoFramePtr());
+			if (videoFrameScaler)
+				videoFrameScaler->releaseScaledFrame(videoFrame->getVideoFramePtr());
+			if (useKeyer && graphicsOverlay)
+				graphicsOverlay->releaseKeyFrame(videoFrame->getVideoFramePtr());
+			updateCompletedFrameLatency(videoFrame, std::ref(printDispatchQueue));
+		});
 		deckLinkOutput->onAudioPacketScheduled([&](std::shared_ptr<LoopThroughAudioPacket> audioPacket) { g_audioProcessingLatencyStatistics.addSample(audioPacket->getProcessingLatency()); });
 
-		if (!deckLinkInput->startCapture(currentFormatDesc.displayMode, currentFormatDesc.is3D, currentFormatDesc.pixelFormat, kAudioSampleType, g_audioChannelCount))
+		// Deinterlace to a progressive display mode if selected, tone map to the output transfer function if selected,
+		// apply the 3D LUT if one is loaded, then scale to the output display mode if one is selected, otherwise output
+		// the input display mode
+		BMDDisplayMode	outputDisplayMode	= currentFormatDesc.displayMode;
+		BMDTimeScale	streamTimescale		= 0;
+
+		if (kDeinterlace)
+		{
+			BMDDisplayMode	deinterlacedDisplayMode;
+			BMDTimeScale	deinterlacedTimeScale;
+
+			videoFrameDeinterlacer = createVideoFrameDeinterlacer(deckLinkOutput, currentFormatDesc, useKeyer, deinterlacedDisplayMode, deinterlacedTimeScale, printDispatchQueue);
+			if (videoFrameDeinterlacer)
+			{
+				// Input stream times are in the timescale of the progressive display mode, for the times of frames output at double rate
+				outputDisplayMode	= deinterlacedDisplayMode;
+				streamTimescale		= deinterlacedTimeScale;
+			}
+		}
+
+		if (kToneMap)
+		{
+			FormatDescription toneMapperFormatDesc = { outputDisplayMode, currentFormatDesc.is3D, currentFormatDesc.pixelFormat };
+
+			videoFrameToneMapper = createVideoFrameToneMapper(deckLinkOutput, toneMapperFormatDesc, useKeyer, printDispatchQueue);
+		}
+
+		if (lut.IsLoaded())
+		{
+			FormatDescription lutFormatDesc = { outputDisplayMode, currentFormatDesc.is3D, currentFormatDesc.pixelFormat };
+
+			videoFrameLUT = createVideoFrameLUT(deckLinkOutput, lutFormatDesc, useKeyer, lut, printDispatchQueue);
+		}
+
+		if ((kOutputDisplayMode != bmdModeUnknown) && (kOutputDisplayMode != outputDisplayMode))
+		{
+			FormatDescription scalerFormatDesc = { outputDisplayMode, currentFormatDesc.is3D, currentFormatDesc.pixelFormat };
+
+			videoFrameScaler = createVideoFrameScaler(deckLinkOutput, scalerFormatDesc, kOutputDisplayMode, useKeyer, printDispatchQueue);
+			if (videoFrameScaler)
+				outputDisplayMode = kOutputDisplayMode;
+		}
+
+		if (!deckLinkInput->startCapture(currentFormatDesc.displayMode, currentFormatDesc.is3D, currentFormatDesc.pixelFormat, kAudioSampleType, g_audioChannelCount, streamTimescale))
 		{
 			fprintf(stderr, "Unable to enable input on the selected device\n");
 			return E_ACCESSDENIED;
 		}
 
+		// Stream times of the burnt-in text are in the input stream timescale
+		if (kBurnInTimecode)
+			timecodeBurnIn = std::make_shared<TimecodeBurnIn>(inputDeviceName.c_str(), deckLinkInput->getStreamTimescale());
+
 		if (kWaitForReferenceToLock)
 			dispatch_printf(printDispatchQueue, "Waiting for reference to lock...\n");
 
-		if (!deckLinkOutput->startPlayback(currentFormatDesc.displayMode, currentFormatDesc.is3D, currentFormatDesc.pixelFormat, kAudioSampleType, g_audioChannelCount, kWaitForReferenceToLock))
+		// The keyer modes output Ay10 fill and key frames in place of the video
+		BMDPixelFormat outputPixelFormat = useKeyer ? bmdFormat10BitYUVA : currentFormatDesc.pixelFormat;
+
+		if (!deckLinkOutput->startPlayback(outputDisplayMode, currentFormatDesc.is3D, outputPixelFormat, kAudioSampleType, g_audioChannelCount, kWaitForReferenceToLock))
 		{
 			std::lock_guard<std::mutex> lock(formatDescMutex);
 			if (!g_loopThroughSessionNotifier.isNotified() && formatDesc == currentFormatDesc)
@@ -647,6 +1047,26 @@ HRESULT InputLoopThrough(void)
 			}
 		}
 
+		if (kGraphicsKeyingMode != GraphicsKeyingMode::None)
+		{
+			com_ptr<IDeckLinkDisplayMode> deckLinkDisplayMode;
+
+			if (useKeyer && !deckLinkOutput->enableKeyer(kGraphicsKeyingMode == GraphicsKeyingMode::ExternalKeyer))
+			{
+				fprintf(stderr, "Unable to enable the %s keyer on the output device\n", (kGraphicsKeyingMode == GraphicsKeyingMode::ExternalKeyer) ? "external" : "internal");
+				return E_FAIL;
+			}
+
+			if (!useKeyer && (currentFormatDesc.pixelFormat != bmdFormat10BitYUV))
+			{
+				dispatch_printf(printDispatchQueue, "Warning: Software keying requires 10-bit YUV video, graphics are not keyed.\n");
+			}
+			else if (deckLinkOutput->getDeckLinkOutput()->GetDisplayMode(outputDisplayMode, deckLinkDisplayMode.releaseAndGetAddressOf()) == S_OK)
+			{
+				graphicsOverlay = std::make_shared<GraphicsOverlay>(kGraphicsKeyingMode, deckLinkOutput->getDeckLinkOutput(), deckLinkDisplayMode.get());
+			}
+		}
+
 		deckLinkInput->setReadyForCapture();
 
 		printReferenceStatus(deckLinkOutput, printDispatchQueue);
@@ -679,6 +1099,14 @@ HRESULT InputLoopThrough(void)
 		deckLinkInput->stopCapture();
 		deckLinkOutput->stopPlayback();
 
+		// Frames still being processed keep their reference to the deinterlacer, tone mapper, 3D LUT, scaler, burn-in and overlay
+		videoFrameDeinterlacer = nullptr;
+		videoFrameToneMapper = nullptr;
+		videoFrameLUT = nullptr;
+		videoFrameScaler = nullptr;
+		timecodeBurnIn = nullptr;
+		graphicsOverlay = nullptr;
+
 		printOutputSummary(printDispatchQueue);
 
 		// Reset statistics
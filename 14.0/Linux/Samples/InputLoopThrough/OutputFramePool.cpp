@@ -0,0 +1,102 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include "OutputFramePool.h"
+#include "VideoConversion.h"
+
+static const BMDTimecodeFormat kRP188TimecodeFormats[] = { bmdTimecodeRP188VITC1, bmdTimecodeRP188VITC2, bmdTimecodeRP188LTC, bmdTimecodeRP188HighFrameRate };
+
+OutputFramePool::OutputFramePool(const com_ptr<IDeckLinkOutput>& deckLinkOutput, uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, const char* description) :
+	m_deckLinkOutput(deckLinkOutput),
+	m_width(width),
+	m_height(height),
+	m_pixelFormat(pixelFormat),
+	m_description(description)
+{
+}
+
+HDRVideoFrame* OutputFramePool::acquireFrame()
+{
+	std::lock_guard<std::mutex>			lock(m_framesMutex);
+	com_ptr<IDeckLinkMutableVideoFrame>	frame;
+
+	for (auto& poolFrame : m_frames)
+	{
+		if (!poolFrame.inUse)
+		{
+			poolFrame.inUse = true;
+			return poolFrame.frame.get();
+		}
+	}
+
+	if (m_deckLinkOutput->CreateVideoFrame(m_width, m_height, GetPixelFormatRowBytes(m_pixelFormat, m_width), m_pixelFormat, bmdFrameFlagDefault, frame.releaseAndGetAddressOf()) != S_OK)
+	{
+		fprintf(stderr, "Unable to create %s output frame\n", m_description);
+		return nullptr;
+	}
+
+	m_frames.push_back({ make_com_ptr<HDRVideoFrame>(frame), true });
+	return m_frames.back().frame.get();
+}
+
+void OutputFramePool::releaseFrame(IDeckLinkVideoFrame* frame)
+{
+	std::lock_guard<std::mutex> lock(m_framesMutex);
+
+	for (auto& poolFrame : m_frames)
+	{
+		if (poolFrame.frame.get() == frame)
+			poolFrame.inUse = false;
+	}
+}
+
+void OutputFramePool::copyFrameProperties(IDeckLinkVideoFrame* sourceFrame, HDRVideoFrame* frame, const HDRMetadata& metadata)
+{
+	for (BMDTimecodeFormat timecodeFormat : kRP188TimecodeFormats)
+	{
+		com_ptr<IDeckLinkTimecode> timecode;
+
+		if (sourceFrame->GetTimecode(timecodeFormat, timecode.releaseAndGetAddressOf()) == S_OK)
+			frame->getMutableFrame()->SetTimecode(timecodeFormat, timecode.get());
+	}
+
+	frame->setMetadata(metadata);
+}
@@ -0,0 +1,83 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <list>
+#include <mutex>
+
+#include "DeckLinkAPI.h"
+#include "HDRVideoFrame.h"
+#include "com_ptr.h"
+
+// OutputFramePool holds the output frames of a processing stage.  Frames are created on demand with the size and
+// pixel format of the stage output, and are reused once their output has completed, so the pool grows to the
+// number of frames the stage has in flight.
+class OutputFramePool
+{
+public:
+	OutputFramePool(const com_ptr<IDeckLinkOutput>& deckLinkOutput, uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, const char* description);
+	virtual ~OutputFramePool() = default;
+
+	// Acquire a free frame, creating one if all frames are in use; returns nullptr if a frame could not be created
+	HDRVideoFrame*	acquireFrame(void);
+
+	// Return a frame to the pool, frames that were not acquired from this pool are ignored
+	void			releaseFrame(IDeckLinkVideoFrame* frame);
+
+	// Copy the RP188 timecodes of the source frame to an output frame, and set its colorspace and HDR metadata
+	static void		copyFrameProperties(IDeckLinkVideoFrame* sourceFrame, HDRVideoFrame* frame, const HDRMetadata& metadata);
+
+private:
+	struct PoolFrame
+	{
+		com_ptr<HDRVideoFrame>	frame;
+		bool					inUse;
+	};
+
+	com_ptr<IDeckLinkOutput>	m_deckLinkOutput;
+	uint32_t					m_width;
+	uint32_t					m_height;
+	BMDPixelFormat				m_pixelFormat;
+	const char*					m_description;
+	//
+	std::mutex					m_framesMutex;
+	std::list<PoolFrame>		m_frames;
+};
@@ -0,0 +1,141 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include "VideoFrameDeinterlacer.h"
+
+// A neighbouring frame of another format, at a format change, is replaced by the current frame
+static void* getNeighbourBytes(IDeckLinkVideoFrame* neighbourFrame, IDeckLinkVideoFrame* currentFrame)
+{
+	void* bytes;
+
+	if ((neighbourFrame == nullptr) || (neighbourFrame->GetPixelFormat() != currentFrame->GetPixelFormat()) ||
+		(neighbourFrame->GetWidth() != currentFrame->GetWidth()) || (neighbourFrame->GetHeight() != currentFrame->GetHeight()) ||
+		(neighbourFrame->GetRowBytes() != currentFrame->GetRowBytes()) || (neighbourFrame->GetBytes(&bytes) != S_OK))
+		return nullptr;
+
+	return bytes;
+}
+
+VideoFrameDeinterlacer::VideoFrameDeinterlacer(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* inputDisplayMode, BMDPixelFormat pixelFormat, DeinterlacerRate rate) :
+	m_width((uint32_t)inputDisplayMode->GetWidth()),
+	m_height((uint32_t)inputDisplayMode->GetHeight()),
+	m_pixelFormat(pixelFormat),
+	m_deinterlacer(m_width, m_height, pixelFormat, inputDisplayMode->GetFieldDominance(), rate),
+	m_deinterlacedFrames(deckLinkOutput, m_width, m_height, pixelFormat, "deinterlaced")
+{
+}
+
+bool VideoFrameDeinterlacer::addInputFrame(std::shared_ptr<LoopThroughVideoFrame> videoFrame, InputFrames& inputFrames)
+{
+	com_ptr<IDeckLinkVideoFrame> nextFrame(videoFrame->getVideoFramePtr());
+
+	if (!m_heldFrame)
+	{
+		m_heldFrame = std::move(videoFrame);
+		return false;
+	}
+
+	inputFrames.previousFrame	= m_previousFrame;
+	inputFrames.currentFrame	= m_heldFrame;
+	inputFrames.nextFrame		= nextFrame;
+
+	m_previousFrame	= com_ptr<IDeckLinkVideoFrame>(m_heldFrame->getVideoFramePtr());
+	m_heldFrame		= std::move(videoFrame);
+	return true;
+}
+
+bool VideoFrameDeinterlacer::deinterlaceVideoFrame(const InputFrames& inputFrames, std::vector<std::shared_ptr<LoopThroughVideoFrame>>& outputFrames)
+{
+	IDeckLinkVideoFrame*	currentFrame	= inputFrames.currentFrame->getVideoFramePtr();
+	BMDTimeValue			streamTime		= inputFrames.currentFrame->getVideoStreamTime();
+	BMDTimeValue			frameDuration	= inputFrames.currentFrame->getVideoFrameDuration() / m_deinterlacer.GetOutputFrameCount();
+	void*					previousBytes;
+	void*					currentBytes;
+	void*					nextBytes;
+	HDRMetadata				metadata;
+
+	outputFrames.clear();
+
+	if ((currentFrame->GetPixelFormat() != m_pixelFormat) ||
+		((uint32_t)currentFrame->GetWidth() != m_width) || ((uint32_t)currentFrame->GetHeight() != m_height))
+		return false;
+
+	previousBytes	= getNeighbourBytes(inputFrames.previousFrame.get(), currentFrame);
+	nextBytes		= getNeighbourBytes(inputFrames.nextFrame.get(), currentFrame);
+
+	if (currentFrame->GetBytes(&currentBytes) != S_OK)
+		return false;
+
+	HDRVideoFrame::readMetadata(currentFrame, metadata);
+
+	for (uint32_t outputIndex = 0; outputIndex < m_deinterlacer.GetOutputFrameCount(); outputIndex++)
+	{
+		HDRVideoFrame*	deinterlacedFrame = m_deinterlacedFrames.acquireFrame();
+		void*			outputBytes;
+
+		if (deinterlacedFrame == nullptr)
+			return false;
+
+		if ((deinterlacedFrame->GetBytes(&outputBytes) != S_OK) ||
+			(m_deinterlacer.DeinterlaceFrame(previousBytes, currentBytes, nextBytes, currentFrame->GetRowBytes(), outputIndex,
+											 outputBytes, deinterlacedFrame->GetRowBytes()) != S_OK))
+		{
+			m_deinterlacedFrames.releaseFrame(deinterlacedFrame);
+			return false;
+		}
+
+		OutputFramePool::copyFrameProperties(currentFrame, deinterlacedFrame, metadata);
+
+		// The output frame keeps the latency measurements of the input frame
+		auto outputFrame = std::make_shared<LoopThroughVideoFrame>(*inputFrames.currentFrame);
+		outputFrame->setVideoFrame(com_ptr<IDeckLinkVideoFrame>(deinterlacedFrame));
+		outputFrame->setVideoStreamTime(streamTime + outputIndex * frameDuration);
+		outputFrame->setVideoFrameDuration(frameDuration);
+
+		outputFrames.push_back(std::move(outputFrame));
+	}
+
+	return true;
+}
+
+void VideoFrameDeinterlacer::releaseDeinterlacedFrame(IDeckLinkVideoFrame* frame)
+{
+	m_deinterlacedFrames.releaseFrame(frame);
+}
@@ -0,0 +1,95 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "DeckLinkAPI.h"
+#include "Deinterlacer.h"
+#include "HDRVideoFrame.h"
+#include "LoopThroughVideoFrame.h"
+#include "OutputFramePool.h"
+#include "com_ptr.h"
+
+// VideoFrameDeinterlacer deinterlaces 8-bit and 10-bit YUV loop-through frames to a progressive display mode of
+// the same frame size, at the frame rate of the input for single rate or twice the frame rate for double rate.
+// A field is interpolated from the frames before and after it, so each input frame is held until the next
+// frame arrives and is output one frame later.  Output frames come from a pool of frames, with the RP188
+// timecodes, colorspace and HDR metadata of the input frame.  Other ancillary data is not carried to the
+// deinterlaced frames.
+//
+// Stream times of the input frames must be in the timescale of the output display mode, so that frames
+// output at double rate start at the input stream time and half way through the input frame.
+class VideoFrameDeinterlacer
+{
+public:
+	// An input frame to deinterlace with the input frames before and after it
+	struct InputFrames
+	{
+		com_ptr<IDeckLinkVideoFrame>			previousFrame;
+		std::shared_ptr<LoopThroughVideoFrame>	currentFrame;
+		com_ptr<IDeckLinkVideoFrame>			nextFrame;
+	};
+
+	VideoFrameDeinterlacer(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* inputDisplayMode, BMDPixelFormat pixelFormat, DeinterlacerRate rate);
+	virtual ~VideoFrameDeinterlacer() = default;
+
+	// Add the next input frame, in stream order.  Returns false while the first frame is held, otherwise
+	// inputFrames is set to the previous input frame and its neighbours.
+	bool	addInputFrame(std::shared_ptr<LoopThroughVideoFrame> videoFrame, InputFrames& inputFrames);
+
+	// Deinterlace the current input frame to one output frame, or two in time order at double rate
+	bool	deinterlaceVideoFrame(const InputFrames& inputFrames, std::vector<std::shared_ptr<LoopThroughVideoFrame>>& outputFrames);
+
+	// Return a deinterlaced frame when its output has completed, or it has been replaced by processing
+	void	releaseDeinterlacedFrame(IDeckLinkVideoFrame* frame);
+
+private:
+	uint32_t								m_width;
+	uint32_t								m_height;
+	BMDPixelFormat							m_pixelFormat;
+	Deinterlacer							m_deinterlacer;
+	OutputFramePool							m_deinterlacedFrames;
+	//
+	com_ptr<IDeckLinkVideoFrame>			m_previousFrame;
+	std::shared_ptr<LoopThroughVideoFrame>	m_heldFrame;
+};
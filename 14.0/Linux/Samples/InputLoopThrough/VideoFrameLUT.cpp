@@ -0,0 +1,87 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include "VideoFrameLUT.h"
+
+VideoFrameLUT::VideoFrameLUT(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* displayMode, BMDPixelFormat pixelFormat, const CubeLUT& lut) :
+	m_width((uint32_t)displayMode->GetWidth()),
+	m_height((uint32_t)displayMode->GetHeight()),
+	m_pixelFormat(pixelFormat),
+	m_lutProcessor(m_width, m_height),
+	m_lutFrames(deckLinkOutput, m_width, m_height, pixelFormat, "3D LUT")
+{
+	m_lutProcessor.SetLUT(lut);
+}
+
+bool VideoFrameLUT::applyLUT(LoopThroughVideoFrame& videoFrame)
+{
+	IDeckLinkVideoFrame*	inputFrame = videoFrame.getVideoFramePtr();
+	HDRMetadata				metadata;
+	HDRVideoFrame*			lutFrame;
+	void*					inputBytes;
+	void*					outputBytes;
+
+	if ((inputFrame->GetPixelFormat() != m_pixelFormat) ||
+		((uint32_t)inputFrame->GetWidth() != m_width) || ((uint32_t)inputFrame->GetHeight() != m_height))
+		return false;
+
+	HDRVideoFrame::readMetadata(inputFrame, metadata);
+
+	lutFrame = m_lutFrames.acquireFrame();
+	if (lutFrame == nullptr)
+		return false;
+
+	if ((inputFrame->GetBytes(&inputBytes) != S_OK) || (lutFrame->GetBytes(&outputBytes) != S_OK) ||
+		(m_lutProcessor.ApplyLUT(m_pixelFormat, metadata.colorspace, inputBytes, inputFrame->GetRowBytes(), outputBytes, lutFrame->GetRowBytes()) != S_OK))
+	{
+		m_lutFrames.releaseFrame(lutFrame);
+		return false;
+	}
+
+	OutputFramePool::copyFrameProperties(inputFrame, lutFrame, metadata);
+
+	videoFrame.setVideoFrame(com_ptr<IDeckLinkVideoFrame>(lutFrame));
+	return true;
+}
+
+void VideoFrameLUT::releaseLUTFrame(IDeckLinkVideoFrame* frame)
+{
+	m_lutFrames.releaseFrame(frame);
+}
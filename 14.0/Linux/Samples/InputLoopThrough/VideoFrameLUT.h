@@ -0,0 +1,75 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include "CubeLUT.h"
+#include "DeckLinkAPI.h"
+#include "HDRVideoFrame.h"
+#include "LoopThroughVideoFrame.h"
+#include "LUTProcessor.h"
+#include "OutputFramePool.h"
+#include "com_ptr.h"
+
+// VideoFrameLUT applies a 3D lookup table loaded from a .cube file to loop-through frames, for show looks and
+// camera matching, see LUTProcessor.h.  10-bit and 12-bit RGB frames are mapped directly, YUV frames through
+// R'G'B' with the matrix of the frame's colorspace.
+//
+// Each frame is replaced by a frame from a pool of output frames of the same pixel format, with the RP188
+// timecodes and the metadata of the input frame.
+class VideoFrameLUT
+{
+public:
+	VideoFrameLUT(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* displayMode, BMDPixelFormat pixelFormat, const CubeLUT& lut);
+	virtual ~VideoFrameLUT() = default;
+
+	// Replace the frame with a frame mapped through the table.  Returns false if the frame could not be mapped.
+	bool	applyLUT(LoopThroughVideoFrame& videoFrame);
+
+	// Return a mapped frame when its output has completed, or it has been replaced by processing
+	void	releaseLUTFrame(IDeckLinkVideoFrame* frame);
+
+private:
+	uint32_t					m_width;
+	uint32_t					m_height;
+	BMDPixelFormat				m_pixelFormat;
+	LUTProcessor				m_lutProcessor;
+	OutputFramePool				m_lutFrames;
+};
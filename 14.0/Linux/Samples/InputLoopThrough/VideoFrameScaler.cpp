@@ -0,0 +1,94 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include "VideoFrameScaler.h"
+
+static bool isInterlaced(IDeckLinkDisplayMode* displayMode)
+{
+	BMDFieldDominance fieldDominance = displayMode->GetFieldDominance();
+
+	return (fieldDominance == bmdLowerFieldFirst) || (fieldDominance == bmdUpperFieldFirst);
+}
+
+VideoFrameScaler::VideoFrameScaler(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* inputDisplayMode, IDeckLinkDisplayMode* outputDisplayMode, VideoScalerFilter filter) :
+	m_inputWidth((uint32_t)inputDisplayMode->GetWidth()),
+	m_inputHeight((uint32_t)inputDisplayMode->GetHeight()),
+	m_outputWidth((uint32_t)outputDisplayMode->GetWidth()),
+	m_outputHeight((uint32_t)outputDisplayMode->GetHeight()),
+	// Fields are scaled separately only when both modes are interlaced
+	m_scaler(m_inputWidth, m_inputHeight, m_outputWidth, m_outputHeight, filter, isInterlaced(inputDisplayMode) && isInterlaced(outputDisplayMode)),
+	m_scaledFrames(deckLinkOutput, m_outputWidth, m_outputHeight, bmdFormat10BitYUV, "scaled")
+{
+}
+
+bool VideoFrameScaler::scaleVideoFrame(LoopThroughVideoFrame& videoFrame)
+{
+	IDeckLinkVideoFrame*	inputFrame = videoFrame.getVideoFramePtr();
+	HDRVideoFrame*			scaledFrame;
+	void*					inputBytes;
+	void*					outputBytes;
+	HDRMetadata				metadata;
+
+	if ((inputFrame->GetPixelFormat() != bmdFormat10BitYUV) ||
+		((uint32_t)inputFrame->GetWidth() != m_inputWidth) || ((uint32_t)inputFrame->GetHeight() != m_inputHeight))
+		return false;
+
+	scaledFrame = m_scaledFrames.acquireFrame();
+	if (scaledFrame == nullptr)
+		return false;
+
+	if ((inputFrame->GetBytes(&inputBytes) != S_OK) || (scaledFrame->GetBytes(&outputBytes) != S_OK) ||
+		(m_scaler.ScaleV210(inputBytes, inputFrame->GetRowBytes(), outputBytes, scaledFrame->GetRowBytes()) != S_OK))
+	{
+		m_scaledFrames.releaseFrame(scaledFrame);
+		return false;
+	}
+
+	HDRVideoFrame::readMetadata(inputFrame, metadata);
+	OutputFramePool::copyFrameProperties(inputFrame, scaledFrame, metadata);
+
+	videoFrame.setVideoFrame(com_ptr<IDeckLinkVideoFrame>(scaledFrame));
+	return true;
+}
+
+void VideoFrameScaler::releaseScaledFrame(IDeckLinkVideoFrame* frame)
+{
+	m_scaledFrames.releaseFrame(frame);
+}
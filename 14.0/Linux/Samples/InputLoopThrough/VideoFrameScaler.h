@@ -0,0 +1,73 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include "DeckLinkAPI.h"
+#include "HDRVideoFrame.h"
+#include "LoopThroughVideoFrame.h"
+#include "OutputFramePool.h"
+#include "VideoScaler.h"
+#include "com_ptr.h"
+
+// VideoFrameScaler scales 10-bit YUV loop-through frames from the input display mode to the output display
+// mode, which must have the same frame rate.  Each frame is replaced by a frame from a pool of output frames,
+// with the RP188 timecodes, colorspace and HDR metadata of the input frame.  Other ancillary data is not
+// carried to the scaled frame.
+class VideoFrameScaler
+{
+public:
+	VideoFrameScaler(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* inputDisplayMode, IDeckLinkDisplayMode* outputDisplayMode, VideoScalerFilter filter);
+	virtual ~VideoFrameScaler() = default;
+
+	// Replace the frame with a frame scaled to the output display mode
+	bool	scaleVideoFrame(LoopThroughVideoFrame& videoFrame);
+
+	// Return a scaled frame when its output has completed
+	void	releaseScaledFrame(IDeckLinkVideoFrame* frame);
+
+private:
+	uint32_t					m_inputWidth;
+	uint32_t					m_inputHeight;
+	uint32_t					m_outputWidth;
+	uint32_t					m_outputHeight;
+	VideoScaler					m_scaler;
+	OutputFramePool				m_scaledFrames;
+};
@@ -0,0 +1,110 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include "VideoFrameToneMapper.h"
+
+VideoFrameToneMapper::VideoFrameToneMapper(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* displayMode, TransferFunction outputTransferFunction) :
+	m_width((uint32_t)displayMode->GetWidth()),
+	m_height((uint32_t)displayMode->GetHeight()),
+	m_toneMapper(m_width, m_height, outputTransferFunction),
+	m_toneMappedFrames(deckLinkOutput, m_width, m_height, bmdFormat10BitYUV, "tone mapped")
+{
+}
+
+bool VideoFrameToneMapper::toneMapVideoFrame(LoopThroughVideoFrame& videoFrame)
+{
+	IDeckLinkVideoFrame*	inputFrame = videoFrame.getVideoFramePtr();
+	HDRMetadata				inputMetadata;
+	HDRMetadata				outputMetadata;
+	ToneMapMetadata			toneMapMetadata;
+	HDRVideoFrame*			toneMappedFrame;
+	void*					inputBytes;
+	void*					outputBytes;
+
+	HDRVideoFrame::readMetadata(inputFrame, inputMetadata);
+
+	if (!inputMetadata.containsHDRMetadata ||
+		((inputMetadata.EOTF != kTransferPQ) && (inputMetadata.EOTF != kTransferHLG)) ||
+		!ToneMapper::IsConversionSupported((TransferFunction)inputMetadata.EOTF, m_toneMapper.GetOutputTransferFunction()))
+		return true;
+
+	if ((inputFrame->GetPixelFormat() != bmdFormat10BitYUV) ||
+		((uint32_t)inputFrame->GetWidth() != m_width) || ((uint32_t)inputFrame->GetHeight() != m_height))
+		return false;
+
+	toneMapMetadata.transferFunction				= (TransferFunction)inputMetadata.EOTF;
+	toneMapMetadata.maxDisplayMasteringLuminance	= inputMetadata.maxDisplayMasteringLuminance;
+	toneMapMetadata.minDisplayMasteringLuminance	= inputMetadata.minDisplayMasteringLuminance;
+	toneMapMetadata.maxContentLightLevel			= inputMetadata.maxCLL;
+	toneMapMetadata.maxFrameAverageLightLevel		= inputMetadata.maxFALL;
+
+	toneMappedFrame = m_toneMappedFrames.acquireFrame();
+	if (toneMappedFrame == nullptr)
+		return false;
+
+	if ((inputFrame->GetBytes(&inputBytes) != S_OK) || (toneMappedFrame->GetBytes(&outputBytes) != S_OK) ||
+		(m_toneMapper.ToneMapV210(toneMapMetadata, inputBytes, inputFrame->GetRowBytes(), outputBytes, toneMappedFrame->GetRowBytes()) != S_OK))
+	{
+		m_toneMappedFrames.releaseFrame(toneMappedFrame);
+		return false;
+	}
+
+	// HLG output keeps the mastering metadata of the input, SDR output has no HDR metadata
+	outputMetadata = inputMetadata;
+	if (m_toneMapper.GetOutputTransferFunction() == kTransferHLG)
+	{
+		outputMetadata.EOTF			= kTransferHLG;
+		outputMetadata.colorspace	= bmdColorspaceRec2020;
+	}
+	else
+	{
+		outputMetadata.containsHDRMetadata	= false;
+		outputMetadata.colorspace			= bmdColorspaceRec709;
+	}
+	OutputFramePool::copyFrameProperties(inputFrame, toneMappedFrame, outputMetadata);
+
+	videoFrame.setVideoFrame(com_ptr<IDeckLinkVideoFrame>(toneMappedFrame));
+	return true;
+}
+
+void VideoFrameToneMapper::releaseToneMappedFrame(IDeckLinkVideoFrame* frame)
+{
+	m_toneMappedFrames.releaseFrame(frame);
+}
@@ -0,0 +1,76 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include "DeckLinkAPI.h"
+#include "HDRVideoFrame.h"
+#include "LoopThroughVideoFrame.h"
+#include "OutputFramePool.h"
+#include "ToneMapper.h"
+#include "com_ptr.h"
+
+// VideoFrameToneMapper converts 10-bit YUV loop-through frames with PQ or HLG static HDR metadata to the
+// output transfer function: PQ to HLG, PQ to SDR or HLG to SDR, see ToneMapper.h.  The conversion tables are
+// computed from the EOTF, mastering display luminance, MaxCLL and MaxFALL read from the input frame, and are
+// rebuilt only when they change.
+//
+// Each converted frame is replaced by a frame from a pool of output frames, with the RP188 timecodes of the
+// input frame and the metadata of the output: HLG frames are Rec.2020 with HDR metadata, SDR frames are
+// Rec.709 without.  Frames without HDR metadata, or whose conversion is not supported, are output unchanged.
+class VideoFrameToneMapper
+{
+public:
+	VideoFrameToneMapper(const com_ptr<IDeckLinkOutput>& deckLinkOutput, IDeckLinkDisplayMode* displayMode, TransferFunction outputTransferFunction);
+	virtual ~VideoFrameToneMapper() = default;
+
+	// Replace the frame with a tone mapped frame if its transfer function is converted.  Returns false if
+	// the conversion failed.
+	bool	toneMapVideoFrame(LoopThroughVideoFrame& videoFrame);
+
+	// Return a tone mapped frame when its output has completed, or it has been replaced by processing
+	void	releaseToneMappedFrame(IDeckLinkVideoFrame* frame);
+
+private:
+	uint32_t						m_width;
+	uint32_t						m_height;
+	ToneMapper						m_toneMapper;
+	OutputFramePool					m_toneMappedFrames;
+};
@@ -0,0 +1,603 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include "platform.h"
+#include "ClipPlayer.h"
+
+static const int		kScheduleAheadFrames	= 4;		// Output frame periods kept scheduled ahead of the playback position
+static const int		kPlaybackFrameCount		= kScheduleAheadFrames + 3;
+static const int		kMaximumHoldFrames		= (int)(1.0 / ClipPlayer::kMinimumSpeed);
+
+constexpr double ClipPlayer::kMinimumSpeed;
+constexpr double ClipPlayer::kMaximumSpeed;
+
+// Clamp to the supported shuttle range, speeds between -0.25 and 0.25 are treated as pause
+static double ClampSpeed(double speed)
+{
+	if (fabs(speed) < ClipPlayer::kMinimumSpeed)
+		return 0.0;
+	return std::max(-ClipPlayer::kMaximumSpeed, std::min(speed, ClipPlayer::kMaximumSpeed));
+}
+
+// Number of output frames that the source frame at position is shown for at the given speed
+static int GetHoldFrameCount(double position, double speed)
+{
+	double	frameIndex = floor(position);
+	int		holdFrames;
+
+	if (speed == 0.0)
+		return 1;
+
+	if (speed > 0.0)
+		holdFrames = (int)ceil((frameIndex + 1.0 - position) / speed - 1e-9);
+	else
+		holdFrames = (int)floor((position - frameIndex) / -speed) + 1;
+
+	return std::max(1, std::min(holdFrames, kMaximumHoldFrames));
+}
+
+template<typename T>
+static void ResampleAudio(const T* source, T* output, uint32_t channelCount, uint32_t sampleFrameCount, double sourcePosition, double step)
+{
+	// Linear interpolation between adjacent source sample frames, step may be negative for reverse playback
+	for (uint32_t i = 0; i < sampleFrameCount; i++)
+	{
+		double		position	= sourcePosition + i * step;
+		int64_t		index		= (int64_t)floor(position);
+		double		fraction	= position - index;
+		const T*	sample0		= source + index * channelCount;
+		const T*	sample1		= sample0 + channelCount;
+
+		for (uint32_t ch = 0; ch < channelCount; ch++)
+			*(output++) = (T)lrint(sample0[ch] + (sample1[ch] - (double)sample0[ch]) * fraction);
+	}
+}
+
+ClipPlayer::ClipPlayer(IDeckLinkOutput* deckLinkOutput, ClipReader* clipReader, AudioPolicy audioPolicy, bool loopPlayback) :
+	m_refCount(1),
+	m_deckLinkOutput(deckLinkOutput),
+	m_clipReader(clipReader),
+	m_audioPolicy(audioPolicy),
+	m_loopPlayback(loopPlayback),
+	m_frameDuration(0),
+	m_timeScale(0),
+	m_audioSampleType(bmdAudioSampleType16bitInteger),
+	m_position(0.0),
+	m_speed(0.0),
+	m_resumeSpeed(1.0),
+	m_playbackRunning(false),
+	m_playbackStopped(true),
+	m_nextStreamTime(0),
+	m_nextAudioSample(0),
+	m_lateFrameCount(0),
+	m_droppedFrameCount(0)
+{
+	m_deckLinkOutput->AddRef();
+}
+
+ClipPlayer::~ClipPlayer()
+{
+	StopPlayback();
+
+	m_deckLinkOutput->Release();
+}
+
+HRESULT ClipPlayer::StartPlayback(double initialSpeed)
+{
+	HRESULT					result;
+	const ClipIndexHeader&	header = m_clipReader->GetHeader();
+	uint32_t				maxOutputSampleFrames;
+	uint32_t				maxSourceSampleFrames;
+
+	m_frameDuration = header.frameDuration;
+	m_timeScale = header.timeScale;
+
+	result = m_deckLinkOutput->SetScheduledFrameCompletionCallback(this);
+	if (result != S_OK)
+	{
+		fprintf(stderr, "Unable to set scheduled frame completion callback\n");
+		goto bail;
+	}
+
+	result = m_deckLinkOutput->EnableVideoOutput((BMDDisplayMode)header.displayMode, bmdVideoOutputFlagDefault);
+	if (result != S_OK)
+	{
+		fprintf(stderr, "Unable to enable video output\n");
+		goto bail;
+	}
+
+	if (m_clipReader->HasAudio())
+	{
+		m_audioSampleType = (header.audioSampleDepth == 32) ? bmdAudioSampleType32bitInteger : bmdAudioSampleType16bitInteger;
+
+		result = m_deckLinkOutput->SetAudioCallback(this);
+		if (result != S_OK)
+			goto bail;
+
+		// Timestamped audio is required as each scheduled frame carries a variable length of audio
+		result = m_deckLinkOutput->EnableAudioOutput(bmdAudioSampleRate48kHz, m_audioSampleType, header.audioChannels, bmdAudioOutputStreamTimestamped);
+		if (result != S_OK)
+		{
+			fprintf(stderr, "Unable to enable audio output\n");
+			goto bail;
+		}
+
+		// Preallocate resampling buffers for the longest frame hold at the fastest speed
+		maxOutputSampleFrames = (uint32_t)ceil((double)bmdAudioSampleRate48kHz * m_frameDuration * kMaximumHoldFrames / m_timeScale) + 1;
+		maxSourceSampleFrames = (uint32_t)ceil(maxOutputSampleFrames * kMaximumSpeed) + 2;
+
+		m_audioOutputBuffer.resize((size_t)maxOutputSampleFrames * m_clipReader->GetAudioSampleFrameBytes());
+		m_audioSourceBuffer.resize((size_t)maxSourceSampleFrames * m_clipReader->GetAudioSampleFrameBytes());
+	}
+
+	// Create the pool of frames that clip frames are read into
+	for (int i = 0; i < kPlaybackFrameCount; i++)
+	{
+		PlaybackFrame playbackFrame = { NULL, -1, 0 };
+
+		result = m_deckLinkOutput->CreateVideoFrame(header.width, header.height, header.rowBytes, (BMDPixelFormat)header.pixelFormat, bmdFrameFlagDefault, &playbackFrame.videoFrame);
+		if (result != S_OK)
+		{
+			fprintf(stderr, "Unable to create video frame\n");
+			goto bail;
+		}
+		m_frames.push_back(playbackFrame);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_position = 0.0;
+		m_speed = ClampSpeed(initialSpeed);
+		m_resumeSpeed = (m_speed != 0.0) ? m_speed : 1.0;
+		m_playbackRunning = true;
+		m_playbackStopped = false;
+	}
+
+	m_nextStreamTime = 0;
+
+	if (m_clipReader->HasAudio())
+	{
+		result = m_deckLinkOutput->BeginAudioPreroll();
+		if (result != S_OK)
+			goto bail;
+	}
+
+	// Preroll frames before starting the output
+	while (m_nextStreamTime < kScheduleAheadFrames * m_frameDuration)
+	{
+		if (!ScheduleNextFrame())
+		{
+			result = E_FAIL;
+			goto bail;
+		}
+	}
+
+	if (m_clipReader->HasAudio())
+	{
+		result = m_deckLinkOutput->EndAudioPreroll();
+		if (result != S_OK)
+			goto bail;
+	}
+
+	// The output always runs at normal speed, trick-play is performed by selecting the frames that are scheduled
+	result = m_deckLinkOutput->StartScheduledPlayback(0, m_timeScale, 1.0);
+	if (result != S_OK)
+	{
+		fprintf(stderr, "Unable to start scheduled playback\n");
+		goto bail;
+	}
+
+	m_scheduleThread = std::thread(&ClipPlayer::ScheduleThread, this);
+
+bail:
+	if (result != S_OK)
+		StopPlayback();
+
+	return result;
+}
+
+void ClipPlayer::StopPlayback()
+{
+	dlbool_t	scheduledPlaybackRunning = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_playbackRunning = false;
+	}
+	m_scheduleCondition.notify_all();
+
+	if (m_scheduleThread.joinable())
+		m_scheduleThread.join();
+
+	if ((m_deckLinkOutput->IsScheduledPlaybackRunning(&scheduledPlaybackRunning) == S_OK) && scheduledPlaybackRunning)
+	{
+		m_deckLinkOutput->StopScheduledPlayback(0, NULL, 0);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_stoppedCondition.wait(lock, [this]{ return m_playbackStopped; });
+	}
+
+	m_deckLinkOutput->DisableAudioOutput();
+	m_deckLinkOutput->DisableVideoOutput();
+	m_deckLinkOutput->SetScheduledFrameCompletionCallback(NULL);
+	m_deckLinkOutput->SetAudioCallback(NULL);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (!m_frames.empty())
+	{
+		m_frames.back().videoFrame->Release();
+		m_frames.pop_back();
+	}
+	m_playbackStopped = true;
+}
+
+void ClipPlayer::SetSpeed(double speed)
+{
+	speed = ClampSpeed(speed);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_speed = speed;
+	if (speed != 0.0)
+		m_resumeSpeed = speed;
+}
+
+void ClipPlayer::TogglePause()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_speed = (m_speed != 0.0) ? 0.0 : m_resumeSpeed;
+}
+
+void ClipPlayer::StepFrames(int64_t frameCount)
+{
+	// Frame step pauses playback and moves to the start of the requested frame
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_speed = 0.0;
+	m_position = floor(m_position) + frameCount;
+	WrapPosition(m_position);
+}
+
+void ClipPlayer::SeekToFrame(int64_t frameIndex)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_position = (double)frameIndex;
+	WrapPosition(m_position);
+}
+
+double ClipPlayer::GetSpeed()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_speed;
+}
+
+int64_t ClipPlayer::GetCurrentFrame()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return (int64_t)floor(m_position);
+}
+
+bool ClipPlayer::WrapPosition(double& position)
+{
+	// Must be called with m_mutex held.  Returns false if playback reached either end of the clip.
+	double frameCount = (double)m_clipReader->GetFrameCount();
+
+	if ((position >= 0.0) && (position < frameCount))
+		return true;
+
+	if (m_loopPlayback)
+	{
+		position = fmod(position, frameCount);
+		if (position < 0.0)
+			position += frameCount;
+		return true;
+	}
+
+	position = std::max(0.0, std::min(position, frameCount - 1.0));
+	return false;
+}
+
+void ClipPlayer::ScheduleThread()
+{
+	while (true)
+	{
+		BMDTimeValue	streamTime;
+		double			playbackSpeed;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_playbackRunning)
+				break;
+		}
+
+		if (m_deckLinkOutput->GetScheduledStreamTime(m_timeScale, &streamTime, &playbackSpeed) != S_OK)
+			streamTime = 0;
+
+		if (streamTime >= m_nextStreamTime)
+		{
+			// Scheduling fell behind the output, skip forward to the next frame boundary
+			m_nextStreamTime = ((streamTime / m_frameDuration) + 1) * m_frameDuration;
+		}
+
+		if (m_nextStreamTime - streamTime < kScheduleAheadFrames * m_frameDuration)
+		{
+			if (!ScheduleNextFrame())
+				break;
+			continue;
+		}
+
+		// Wait for the next frame completion, with timeout in case completions stop arriving
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_scheduleCondition.wait_for(lock, std::chrono::microseconds(m_frameDuration * 1000000 / m_timeScale));
+	}
+}
+
+bool ClipPlayer::ScheduleNextFrame()
+{
+	double			position;
+	double			speed;
+	int				holdFrames;
+	int64_t			sourceFrame;
+	PlaybackFrame*	playbackFrame;
+	BMDTimeValue	displayDuration;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!WrapPosition(m_position) && (m_speed != 0.0))
+		{
+			fprintf(stderr, "\n%s of clip reached, playback paused\n", (m_speed > 0.0) ? "End" : "Start");
+			m_speed = 0.0;
+		}
+
+		position = m_position;
+		speed = m_speed;
+		holdFrames = GetHoldFrameCount(position, speed);
+
+		m_position = position + holdFrames * speed;
+	}
+
+	sourceFrame = (int64_t)floor(position);
+	displayDuration = holdFrames * m_frameDuration;
+
+	playbackFrame = AcquireFrame(sourceFrame);
+	if (playbackFrame == NULL)
+		return false;
+
+	if (m_deckLinkOutput->ScheduleVideoFrame(playbackFrame->videoFrame, m_nextStreamTime, displayDuration, m_timeScale) != S_OK)
+	{
+		fprintf(stderr, "Unable to schedule video frame\n");
+		std::lock_guard<std::mutex> lock(m_mutex);
+		playbackFrame->scheduledCount--;
+		return false;
+	}
+
+	if (m_clipReader->HasAudio())
+	{
+		// Audio is scheduled with 48kHz timestamps so that the sample count per frame can vary (eg 29.97 fps)
+		int64_t		startSample = m_nextStreamTime * bmdAudioSampleRate48kHz / m_timeScale;
+		int64_t		endSample = (m_nextStreamTime + displayDuration) * bmdAudioSampleRate48kHz / m_timeScale;
+		double		audioStep = speed;
+
+		if ((m_audioPolicy == kAudioPolicyMute) && (speed != 1.0))
+			audioStep = 0.0;
+
+		m_nextAudioSample = startSample;
+		ScheduleAudio(m_clipReader->GetAudioSamplePosition(position), audioStep, (uint32_t)(endSample - startSample));
+	}
+
+	m_nextStreamTime += displayDuration;
+	return true;
+}
+
+ClipPlayer::PlaybackFrame* ClipPlayer::AcquireFrame(int64_t sourceFrame)
+{
+	PlaybackFrame*	playbackFrame = NULL;
+	void*			frameBytes;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		// Reuse a frame that already holds the source frame, so that held and paused frames are not read again
+		for (auto& frame : m_frames)
+		{
+			if (frame.sourceFrame == sourceFrame)
+			{
+				frame.scheduledCount++;
+				return &frame;
+			}
+		}
+
+		// Otherwise take the least recently read frame that is no longer scheduled
+		m_scheduleCondition.wait(lock, [&]{
+			for (auto& frame : m_frames)
+			{
+				if (frame.scheduledCount == 0)
+				{
+					playbackFrame = &frame;
+					return true;
+				}
+			}
+			return !m_playbackRunning;
+		});
+
+		if (playbackFrame == NULL)
+			return NULL;
+
+		playbackFrame->sourceFrame = -1;
+		playbackFrame->scheduledCount++;
+
+		// Rotate the frame to the back of the pool so that recently shown frames stay cached longest
+		std::rotate(m_frames.begin() + (playbackFrame - m_frames.data()), m_frames.begin() + (playbackFrame - m_frames.data()) + 1, m_frames.end());
+		playbackFrame = &m_frames.back();
+	}
+
+	if ((playbackFrame->videoFrame->GetBytes(&frameBytes) != S_OK) ||
+		(m_clipReader->ReadVideoFrame(sourceFrame, frameBytes) != S_OK))
+	{
+		fprintf(stderr, "Unable to read frame %ld from clip\n", (long)sourceFrame);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		playbackFrame->scheduledCount--;
+		return NULL;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	playbackFrame->sourceFrame = sourceFrame;
+	return playbackFrame;
+}
+
+void ClipPlayer::ScheduleAudio(double audioPosition, double audioStep, uint32_t sampleFrameCount)
+{
+	const uint32_t	channelCount = m_clipReader->GetHeader().audioChannels;
+	uint32_t		sampleFramesWritten;
+
+	if (audioStep == 1.0)
+	{
+		// Normal speed, no resampling required
+		m_clipReader->ReadAudioSamples((int64_t)llrint(audioPosition), sampleFrameCount, m_audioOutputBuffer.data());
+	}
+	else if (audioStep == 0.0)
+	{
+		memset(m_audioOutputBuffer.data(), 0, (size_t)sampleFrameCount * m_clipReader->GetAudioSampleFrameBytes());
+	}
+	else
+	{
+		// Read the span of source audio covered by this frame, plus one sample frame either side for interpolation
+		double		endPosition = audioPosition + audioStep * sampleFrameCount;
+		int64_t		firstSample = (int64_t)floor(std::min(audioPosition, endPosition)) - 1;
+		int64_t		lastSample = (int64_t)ceil(std::max(audioPosition, endPosition)) + 1;
+		uint32_t	sourceSampleFrames = (uint32_t)std::min<int64_t>(lastSample - firstSample + 1, m_audioSourceBuffer.size() / m_clipReader->GetAudioSampleFrameBytes());
+
+		m_clipReader->ReadAudioSamples(firstSample, sourceSampleFrames, m_audioSourceBuffer.data());
+
+		if (m_audioSampleType == bmdAudioSampleType32bitInteger)
+			ResampleAudio((const int32_t*)m_audioSourceBuffer.data(), (int32_t*)m_audioOutputBuffer.data(), channelCount, sampleFrameCount, audioPosition - firstSample, audioStep);
+		else
+			ResampleAudio((const int16_t*)m_audioSourceBuffer.data(), (int16_t*)m_audioOutputBuffer.data(), channelCount, sampleFrameCount, audioPosition - firstSample, audioStep);
+	}
+
+	if (m_deckLinkOutput->ScheduleAudioSamples(m_audioOutputBuffer.data(), sampleFrameCount, m_nextAudioSample, bmdAudioSampleRate48kHz, &sampleFramesWritten) != S_OK)
+		fprintf(stderr, "Unable to schedule audio samples\n");
+}
+
+HRESULT ClipPlayer::ScheduledFrameCompleted(IDeckLinkVideoFrame* completedFrame, BMDOutputFrameCompletionResult result)
+{
+	if (result == bmdOutputFrameDisplayedLate)
+		++m_lateFrameCount;
+	else if (result == bmdOutputFrameDropped)
+		++m_droppedFrameCount;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto& frame : m_frames)
+		{
+			if ((IDeckLinkVideoFrame*)frame.videoFrame == completedFrame)
+			{
+				frame.scheduledCount = std::max(0, frame.scheduledCount - 1);
+				break;
+			}
+		}
+	}
+	m_scheduleCondition.notify_all();
+
+	return S_OK;
+}
+
+HRESULT ClipPlayer::ScheduledPlaybackHasStopped()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_playbackStopped = true;
+	}
+	m_stoppedCondition.notify_all();
+
+	return S_OK;
+}
+
+HRESULT	STDMETHODCALLTYPE ClipPlayer::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	CFUUIDBytes		iunknown;
+	HRESULT			result = E_NOINTERFACE;
+
+	if (ppv == NULL)
+		return E_INVALIDARG;
+
+	// Initialise the return result
+	*ppv = NULL;
+
+	// Obtain the IUnknown interface and compare it the provided REFIID
+	iunknown = CFUUIDGetUUIDBytes(IUnknownUUID);
+	if (memcmp(&iid, &iunknown, sizeof(REFIID)) == 0)
+	{
+		*ppv = this;
+		AddRef();
+		result = S_OK;
+	}
+	else if (memcmp(&iid, &IID_IDeckLinkVideoOutputCallback, sizeof(REFIID)) == 0)
+	{
+		*ppv = (IDeckLinkVideoOutputCallback*)this;
+		AddRef();
+		result = S_OK;
+	}
+	else if (memcmp(&iid, &IID_IDeckLinkAudioOutputCallback, sizeof(REFIID)) == 0)
+	{
+		*ppv = (IDeckLinkAudioOutputCallback*)this;
+		AddRef();
+		result = S_OK;
+	}
+
+	return result;
+}
+
+ULONG STDMETHODCALLTYPE ClipPlayer::AddRef(void)
+{
+	return ++m_refCount;
+}
+
+ULONG STDMETHODCALLTYPE ClipPlayer::Release(void)
+{
+	ULONG newRefValue = --m_refCount;
+	if (newRefValue == 0)
+		delete this;
+
+	return newRefValue;
+}
@@ -0,0 +1,147 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ClipReader.h"
+#include "DeckLinkAPI.h"
+
+// Audio handling while the clip is not playing at normal speed
+enum AudioPolicy
+{
+	kAudioPolicyMute = 0,		// Output silence whenever speed is not 1.0
+	kAudioPolicyVarispeed		// Resample audio to follow the shuttle speed, including reverse
+};
+
+// ClipPlayer schedules frames of an indexed clip at a variable speed.
+//
+// Scheduled playback always runs at the display mode frame rate with a playback speed of 1.0.
+// For each output frame the player picks the source frame from the clip index at the current
+// shuttle position, so that:
+// * at speeds below 1.0 each source frame is scheduled once with a duration covering all of
+//   the output frames it is held for,
+// * at speeds above 1.0 only the frames that are shown are read from disk,
+// * at negative speeds frames are picked in reverse order.
+class ClipPlayer : public IDeckLinkVideoOutputCallback, public IDeckLinkAudioOutputCallback
+{
+public:
+	static constexpr double	kMinimumSpeed	= 0.25;
+	static constexpr double	kMaximumSpeed	= 8.0;
+
+	ClipPlayer(IDeckLinkOutput* deckLinkOutput, ClipReader* clipReader, AudioPolicy audioPolicy, bool loopPlayback);
+	virtual ~ClipPlayer();
+
+	HRESULT				StartPlayback(double initialSpeed);
+	void				StopPlayback(void);
+
+	// Shuttle controls, may be called from any thread while playback is running
+	void				SetSpeed(double speed);
+	void				TogglePause(void);
+	void				StepFrames(int64_t frameCount);
+	void				SeekToFrame(int64_t frameIndex);
+
+	double				GetSpeed(void);
+	int64_t				GetCurrentFrame(void);
+	unsigned long		GetLateFrameCount(void) const { return m_lateFrameCount; }
+	unsigned long		GetDroppedFrameCount(void) const { return m_droppedFrameCount; }
+
+	// IDeckLinkVideoOutputCallback interface
+	virtual HRESULT	STDMETHODCALLTYPE	ScheduledFrameCompleted(IDeckLinkVideoFrame* completedFrame, BMDOutputFrameCompletionResult result);
+	virtual HRESULT	STDMETHODCALLTYPE	ScheduledPlaybackHasStopped(void);
+
+	// IDeckLinkAudioOutputCallback interface
+	virtual HRESULT	STDMETHODCALLTYPE	RenderAudioSamples(dlbool_t preroll) { return S_OK; }
+
+	// IUnknown interface
+	virtual HRESULT	STDMETHODCALLTYPE	QueryInterface(REFIID iid, LPVOID *ppv);
+	virtual ULONG	STDMETHODCALLTYPE	AddRef();
+	virtual ULONG	STDMETHODCALLTYPE	Release();
+
+private:
+	struct PlaybackFrame
+	{
+		IDeckLinkMutableVideoFrame*	videoFrame;
+		int64_t						sourceFrame;		// Clip frame currently held in videoFrame, -1 if none
+		int							scheduledCount;		// Number of outstanding schedules of videoFrame
+	};
+
+	std::atomic<ULONG>			m_refCount;
+	IDeckLinkOutput*			m_deckLinkOutput;
+	ClipReader*					m_clipReader;
+	AudioPolicy					m_audioPolicy;
+	bool						m_loopPlayback;
+
+	BMDTimeValue				m_frameDuration;
+	BMDTimeScale				m_timeScale;
+	BMDAudioSampleType			m_audioSampleType;
+
+	// Shuttle state, protected by m_mutex
+	double						m_position;				// Fractional clip frame shown at the next scheduled output frame
+	double						m_speed;
+	double						m_resumeSpeed;
+	bool						m_playbackRunning;
+	bool						m_playbackStopped;
+
+	// Scheduling state, owned by the scheduling thread
+	std::vector<PlaybackFrame>	m_frames;
+	BMDTimeValue				m_nextStreamTime;
+	int64_t						m_nextAudioSample;
+	std::vector<uint8_t>		m_audioSourceBuffer;
+	std::vector<uint8_t>		m_audioOutputBuffer;
+
+	std::atomic<unsigned long>	m_lateFrameCount;
+	std::atomic<unsigned long>	m_droppedFrameCount;
+
+	std::mutex					m_mutex;
+	std::condition_variable		m_scheduleCondition;
+	std::condition_variable		m_stoppedCondition;
+	std::thread					m_scheduleThread;
+
+	void						ScheduleThread(void);
+	bool						ScheduleNextFrame(void);
+	PlaybackFrame*				AcquireFrame(int64_t sourceFrame);
+	void						ScheduleAudio(double audioPosition, double audioStep, uint32_t sampleFrameCount);
+	bool						WrapPosition(double& position);
+};
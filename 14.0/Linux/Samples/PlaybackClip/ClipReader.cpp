@@ -0,0 +1,257 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include "ClipReader.h"
+
+ClipReader::ClipReader() :
+	m_videoFile(-1),
+	m_audioFile(-1),
+	m_audioSampleFrameCount(0)
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+ClipReader::~ClipReader()
+{
+	Close();
+}
+
+HRESULT ClipReader::Open(const std::string& indexFilename, const std::string& videoFilename, const std::string& audioFilename)
+{
+	HRESULT			result		= E_FAIL;
+	int				indexFile	= -1;
+	struct stat		fileStat;
+	int64_t			entryCount;
+	uint64_t		frameBytes;
+
+	Close();
+
+	indexFile = open(indexFilename.c_str(), O_RDONLY);
+	if (indexFile < 0)
+	{
+		fprintf(stderr, "Could not open clip index file %s\n", indexFilename.c_str());
+		goto bail;
+	}
+
+	if ((read(indexFile, &m_header, sizeof(m_header)) != sizeof(m_header)) ||
+		(memcmp(m_header.magic, CLIP_INDEX_MAGIC, sizeof(m_header.magic)) != 0) ||
+		(m_header.version != CLIP_INDEX_VERSION))
+	{
+		fprintf(stderr, "%s is not a valid clip index file\n", indexFilename.c_str());
+		goto bail;
+	}
+
+	if ((m_header.frameDuration <= 0) || (m_header.timeScale <= 0) || (m_header.rowBytes == 0) || (m_header.height == 0))
+	{
+		fprintf(stderr, "Clip index %s has an invalid header\n", indexFilename.c_str());
+		goto bail;
+	}
+
+	// Load all entries, the index is small compared to the clip (32 bytes per frame)
+	if (fstat(indexFile, &fileStat) != 0)
+		goto bail;
+
+	entryCount = (fileStat.st_size - (off_t)sizeof(m_header)) / (off_t)sizeof(ClipIndexEntry);
+	if (entryCount <= 0)
+	{
+		fprintf(stderr, "Clip index %s does not contain any frames\n", indexFilename.c_str());
+		goto bail;
+	}
+
+	m_entries.resize(entryCount);
+	if (read(indexFile, m_entries.data(), entryCount * sizeof(ClipIndexEntry)) != (ssize_t)(entryCount * sizeof(ClipIndexEntry)))
+	{
+		fprintf(stderr, "Could not read clip index entries\n");
+		goto bail;
+	}
+
+	m_videoFile = open(videoFilename.c_str(), O_RDONLY);
+	if (m_videoFile < 0)
+	{
+		fprintf(stderr, "Could not open raw video file %s\n", videoFilename.c_str());
+		goto bail;
+	}
+
+	// Drop trailing index entries whose frames were not completely written to the video file
+	frameBytes = (uint64_t)m_header.rowBytes * m_header.height;
+	if (fstat(m_videoFile, &fileStat) != 0)
+		goto bail;
+
+	while (!m_entries.empty() && (m_entries.back().videoOffset + frameBytes > (uint64_t)fileStat.st_size))
+		m_entries.pop_back();
+
+	if (m_entries.empty())
+	{
+		fprintf(stderr, "Raw video file %s is shorter than the clip index\n", videoFilename.c_str());
+		goto bail;
+	}
+
+	if (!audioFilename.empty())
+	{
+		if (m_header.audioChannels == 0)
+		{
+			fprintf(stderr, "Clip index was captured without audio, ignoring %s\n", audioFilename.c_str());
+		}
+		else
+		{
+			m_audioFile = open(audioFilename.c_str(), O_RDONLY);
+			if (m_audioFile < 0)
+			{
+				fprintf(stderr, "Could not open raw audio file %s\n", audioFilename.c_str());
+				goto bail;
+			}
+
+			if (fstat(m_audioFile, &fileStat) != 0)
+				goto bail;
+
+			m_audioSampleFrameCount = fileStat.st_size / GetAudioSampleFrameBytes();
+		}
+	}
+
+	result = S_OK;
+
+bail:
+	if (indexFile >= 0)
+		close(indexFile);
+
+	if (result != S_OK)
+		Close();
+
+	return result;
+}
+
+void ClipReader::Close()
+{
+	if (m_videoFile >= 0)
+		close(m_videoFile);
+	m_videoFile = -1;
+
+	if (m_audioFile >= 0)
+		close(m_audioFile);
+	m_audioFile = -1;
+
+	m_audioSampleFrameCount = 0;
+	m_entries.clear();
+}
+
+HRESULT ClipReader::ReadVideoFrame(int64_t frameIndex, void* buffer) const
+{
+	size_t		frameBytes = (size_t)m_header.rowBytes * m_header.height;
+	uint8_t*	nextBytes = (uint8_t*)buffer;
+	off_t		offset;
+
+	if ((frameIndex < 0) || (frameIndex >= GetFrameCount()))
+		return E_INVALIDARG;
+
+	// For 3D clips, the left eye frame is stored first and is the one played out
+	offset = (off_t)m_entries[frameIndex].videoOffset;
+
+	while (frameBytes > 0)
+	{
+		ssize_t bytesRead = pread(m_videoFile, nextBytes, frameBytes, offset);
+		if (bytesRead <= 0)
+			return E_FAIL;
+
+		nextBytes += bytesRead;
+		offset += bytesRead;
+		frameBytes -= bytesRead;
+	}
+
+	return S_OK;
+}
+
+HRESULT ClipReader::ReadAudioSamples(int64_t sampleOffset, uint32_t sampleFrameCount, void* buffer) const
+{
+	uint32_t	sampleFrameBytes = GetAudioSampleFrameBytes();
+	uint8_t*	nextBytes = (uint8_t*)buffer;
+	int64_t		firstSample;
+	int64_t		lastSample;
+
+	// Silence for any part of the request that lies outside the captured audio
+	memset(buffer, 0, (size_t)sampleFrameCount * sampleFrameBytes);
+
+	if (m_audioFile < 0)
+		return S_OK;
+
+	firstSample = std::max<int64_t>(sampleOffset, 0);
+	lastSample = std::min<int64_t>(sampleOffset + sampleFrameCount, m_audioSampleFrameCount);
+	if (lastSample <= firstSample)
+		return S_OK;
+
+	nextBytes += (firstSample - sampleOffset) * sampleFrameBytes;
+
+	size_t	bytesRemaining = (size_t)(lastSample - firstSample) * sampleFrameBytes;
+	off_t	offset = (off_t)firstSample * sampleFrameBytes;
+
+	while (bytesRemaining > 0)
+	{
+		ssize_t bytesRead = pread(m_audioFile, nextBytes, bytesRemaining, offset);
+		if (bytesRead <= 0)
+			return E_FAIL;
+
+		nextBytes += bytesRead;
+		offset += bytesRead;
+		bytesRemaining -= bytesRead;
+	}
+
+	return S_OK;
+}
+
+double ClipReader::GetAudioSamplePosition(double framePosition) const
+{
+	double	samplesPerFrame = (double)bmdAudioSampleRate48kHz * m_header.frameDuration / m_header.timeScale;
+	int64_t	frameIndex = (int64_t)floor(framePosition);
+
+	frameIndex = std::max<int64_t>(0, std::min<int64_t>(frameIndex, GetFrameCount() - 1));
+
+	// Audio packets are not necessarily one frame long, so interpolate within the packet delivered with the frame
+	const ClipIndexEntry& entry = m_entries[frameIndex];
+	if (entry.audioSampleCount > 0)
+		samplesPerFrame = entry.audioSampleCount;
+
+	return (double)entry.audioSampleOffset + (framePosition - frameIndex) * samplesPerFrame;
+}
@@ -0,0 +1,82 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ClipIndex.h"
+#include "DeckLinkAPI.h"
+
+// ClipReader provides random access to a raw clip written by the Capture sample with a clip index.
+// Frames are read individually with pread(), so frames that are skipped during fast or reverse
+// playback are never read from disk.
+class ClipReader
+{
+public:
+	ClipReader();
+	virtual ~ClipReader();
+
+	HRESULT					Open(const std::string& indexFilename, const std::string& videoFilename, const std::string& audioFilename);
+	void					Close(void);
+
+	const ClipIndexHeader&	GetHeader(void) const { return m_header; }
+	int64_t					GetFrameCount(void) const { return (int64_t)m_entries.size(); }
+	bool					HasAudio(void) const { return m_audioFile != -1; }
+	uint32_t				GetAudioSampleFrameBytes(void) const { return m_header.audioChannels * (m_header.audioSampleDepth / 8); }
+
+	// Read the video frame at frameIndex into buffer, which must be at least rowBytes * height in size
+	HRESULT					ReadVideoFrame(int64_t frameIndex, void* buffer) const;
+
+	// Read sampleFrameCount audio sample frames starting at sampleOffset.  Samples outside the
+	// captured audio are returned as silence.
+	HRESULT					ReadAudioSamples(int64_t sampleOffset, uint32_t sampleFrameCount, void* buffer) const;
+
+	// Map a fractional frame position onto a fractional audio sample position
+	double					GetAudioSamplePosition(double framePosition) const;
+
+private:
+	int							m_videoFile;
+	int							m_audioFile;
+	int64_t						m_audioSampleFrameCount;
+	ClipIndexHeader				m_header;
+	std::vector<ClipIndexEntry>	m_entries;
+};
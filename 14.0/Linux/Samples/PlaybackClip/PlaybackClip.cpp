@@ -0,0 +1,363 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "platform.h"
+#include "ClipReader.h"
+#include "ClipPlayer.h"
+#include "DeckLinkAPI.h"
+
+void DisplayUsage(const std::vector<std::string>& deviceNames, const int selectedDeviceIndex)
+{
+	fprintf(stderr,
+		"\n"
+		"Usage: ./PlaybackClip -d <device id> -x <index file> -v <video file> [OPTIONS]\n"
+		"\n"
+		"    -d <device id>:\n"
+		);
+
+	if (deviceNames.empty())
+	{
+		fprintf(stderr, "        No DeckLink devices found. Please check Desktop Video installation\n");
+	}
+	else
+	{
+		// Loop through all available devices
+		for (size_t i = 0; i < deviceNames.size(); i++)
+		{
+			fprintf(stderr,
+				"       %c%2d:  %s\n",
+				((int)i == selectedDeviceIndex) ? '*' : ' ',
+				(int)i,
+				deviceNames[i].c_str()
+				);
+		}
+	}
+
+	fprintf(stderr,
+		"    -x <filename>\n        Clip index written by Capture -x\n"
+		"    -v <filename>\n        Raw video file written by Capture -v\n"
+		"    -a <filename>\n        Raw audio file written by Capture -a (optional)\n"
+		"    -s <speed>\n        Initial playback speed, %.2f to %.1f forward or reverse (default is 1.0)\n"
+		"    -u <mute|varispeed>\n        Audio when speed is not 1.0 (default is mute)\n"
+		"    -l\n        Loop playback\n"
+		"\n"
+		"Playback a captured clip with variable speed. eg:\n"
+		"\n"
+		"    ./PlaybackClip -d 0 -x video.idx -v video.raw -a audio.raw -s -2 -l\n"
+		"\n"
+		"While playing, enter a speed (eg 0.5, -4) to shuttle, or one of the following commands:\n"
+		"    p        Pause or resume playback\n"
+		"    f / b    Step one frame forward / backward\n"
+		"    g <n>    Go to frame n\n"
+		"    q        Stop playback and exit\n",
+		ClipPlayer::kMinimumSpeed,
+		ClipPlayer::kMaximumSpeed
+		);
+}
+
+void ProcessCommands(ClipPlayer* clipPlayer, int64_t frameCount)
+{
+	char	line[256];
+
+	while (fgets(line, sizeof(line), stdin) != NULL)
+	{
+		char*	command = line;
+		char*	end;
+		double	speed;
+
+		while ((*command == ' ') || (*command == '\t'))
+			command++;
+
+		if ((*command == 'q') || (*command == 'Q'))
+			break;
+
+		else if ((*command == 'p') || (*command == 'P'))
+			clipPlayer->TogglePause();
+
+		else if ((*command == 'f') || (*command == 'F'))
+			clipPlayer->StepFrames(1);
+
+		else if ((*command == 'b') || (*command == 'B'))
+			clipPlayer->StepFrames(-1);
+
+		else if ((*command == 'g') || (*command == 'G'))
+			clipPlayer->SeekToFrame(atoll(command + 1));
+
+		else
+		{
+			speed = strtod(command, &end);
+			if (end != command)
+				clipPlayer->SetSpeed(speed);
+			else if ((*command != '\n') && (*command != '\0'))
+			{
+				fprintf(stderr, "Unknown command\n");
+				continue;
+			}
+		}
+
+		fprintf(stderr, "Frame %ld of %ld, speed %.2f, late %lu, dropped %lu\n",
+			(long)clipPlayer->GetCurrentFrame(),
+			(long)frameCount,
+			clipPlayer->GetSpeed(),
+			clipPlayer->GetLateFrameCount(),
+			clipPlayer->GetDroppedFrameCount()
+			);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	// Configuration flags
+	bool						displayHelp			= false;
+	int							deckLinkIndex		= -1;
+	bool						loopPlayback		= false;
+	double						initialSpeed		= 1.0;
+	AudioPolicy					audioPolicy			= kAudioPolicyMute;
+	std::string					indexFilename;
+	std::string					videoFilename;
+	std::string					audioFilename;
+
+	HRESULT						result;
+	int							exitStatus = 1;
+	int							idx;
+
+	IDeckLinkIterator*			deckLinkIterator		= NULL;
+	IDeckLink*					deckLink				= NULL;
+	IDeckLinkOutput*			selectedDeckLinkOutput	= NULL;
+	ClipPlayer*					clipPlayer				= NULL;
+	ClipReader					clipReader;
+
+	std::vector<std::string>	deckLinkDeviceNames;
+
+	result = GetDeckLinkIterator(&deckLinkIterator);
+	if (result != S_OK)
+		goto bail;
+
+	// Process the command line arguments
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc))
+			deckLinkIndex = atoi(argv[++i]);
+
+		else if ((strcmp(argv[i], "-x") == 0) && (i + 1 < argc))
+			indexFilename = argv[++i];
+
+		else if ((strcmp(argv[i], "-v") == 0) && (i + 1 < argc))
+			videoFilename = argv[++i];
+
+		else if ((strcmp(argv[i], "-a") == 0) && (i + 1 < argc))
+			audioFilename = argv[++i];
+
+		else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+			initialSpeed = atof(argv[++i]);
+
+		else if ((strcmp(argv[i], "-u") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "varispeed") == 0)
+				audioPolicy = kAudioPolicyVarispeed;
+			else if (strcmp(argv[i], "mute") == 0)
+				audioPolicy = kAudioPolicyMute;
+			else
+			{
+				fprintf(stderr, "Invalid audio policy %s\n", argv[i]);
+				displayHelp = true;
+			}
+		}
+
+		else if (strcmp(argv[i], "-l") == 0)
+			loopPlayback = true;
+
+		else
+			displayHelp = true;
+	}
+
+	if (indexFilename.empty() || videoFilename.empty())
+	{
+		fprintf(stderr, "You must set a clip index and raw video file\n");
+		displayHelp = true;
+	}
+	else if (clipReader.Open(indexFilename, videoFilename, audioFilename) != S_OK)
+	{
+		displayHelp = true;
+	}
+
+	if ((initialSpeed > ClipPlayer::kMaximumSpeed) || (initialSpeed < -ClipPlayer::kMaximumSpeed))
+	{
+		fprintf(stderr, "Playback speed must be between %.1f and %.1f\n", -ClipPlayer::kMaximumSpeed, ClipPlayer::kMaximumSpeed);
+		displayHelp = true;
+	}
+
+	if (deckLinkIndex < 0)
+	{
+		fprintf(stderr, "You must select a device\n");
+		displayHelp = true;
+	}
+
+	// Obtain the required DeckLink device
+	idx = 0;
+
+	while ((result = deckLinkIterator->Next(&deckLink)) == S_OK)
+	{
+		dlstring_t deckLinkName;
+
+		result = deckLink->GetDisplayName(&deckLinkName);
+		if (result == S_OK)
+		{
+			deckLinkDeviceNames.push_back(DlToStdString(deckLinkName));
+			DeleteString(deckLinkName);
+		}
+
+		if (idx++ == deckLinkIndex)
+		{
+			// Check that selected device supports playback
+			IDeckLinkProfileAttributes*	deckLinkAttributes = NULL;
+			int64_t						ioSupportAttribute = 0;
+
+			result = deckLink->QueryInterface(IID_IDeckLinkProfileAttributes, (void**)&deckLinkAttributes);
+
+			if (result != S_OK)
+			{
+				fprintf(stderr, "Unable to get IDeckLinkAttributes interface\n");
+				goto bail;
+			}
+
+			if (deckLinkAttributes->GetInt(BMDDeckLinkVideoIOSupport, &ioSupportAttribute) != S_OK)
+				ioSupportAttribute = 0;
+
+			deckLinkAttributes->Release();
+
+			if ((ioSupportAttribute & bmdDeviceSupportsPlayback) != 0)
+			{
+				result = deckLink->QueryInterface(IID_IDeckLinkOutput, (void**)&selectedDeckLinkOutput);
+				if (result != S_OK)
+				{
+					fprintf(stderr, "Unable to get IDeckLinkOutput interface\n");
+					goto bail;
+				}
+			}
+			else
+			{
+				fprintf(stderr, "Selected device does not support playback\n");
+				displayHelp = true;
+			}
+		}
+
+		deckLink->Release();
+		deckLink = NULL;
+	}
+
+	if ((selectedDeckLinkOutput != NULL) && (clipReader.GetFrameCount() > 0))
+	{
+		// Check the captured display mode and pixel format can be played back without conversion
+		const ClipIndexHeader&	header = clipReader.GetHeader();
+		dlbool_t				displayModeSupported = false;
+
+		result = selectedDeckLinkOutput->DoesSupportVideoMode(bmdVideoConnectionUnspecified, (BMDDisplayMode)header.displayMode, (BMDPixelFormat)header.pixelFormat, bmdNoVideoOutputConversion, bmdSupportedVideoModeDefault, NULL, &displayModeSupported);
+		if ((result != S_OK) || (!displayModeSupported))
+		{
+			fprintf(stderr, "The captured display mode and pixel format are not supported by device\n");
+			displayHelp = true;
+		}
+	}
+
+	if (displayHelp)
+	{
+		DisplayUsage(deckLinkDeviceNames, deckLinkIndex);
+		goto bail;
+	}
+
+	clipPlayer = new ClipPlayer(selectedDeckLinkOutput, &clipReader, audioPolicy, loopPlayback);
+
+	// OK to start playback - print configuration
+	fprintf(stderr, "Output with the following configuration:\n"
+		" - Playback device: %s\n"
+		" - Frame size: %u x %u\n"
+		" - Number of frames: %ld\n"
+		" - Audio: %s\n"
+		" - Initial speed: %.2f\n"
+		" - Loop Playback: %s\n",
+		deckLinkDeviceNames[deckLinkIndex].c_str(),
+		clipReader.GetHeader().width,
+		clipReader.GetHeader().height,
+		(long)clipReader.GetFrameCount(),
+		clipReader.HasAudio() ? ((audioPolicy == kAudioPolicyVarispeed) ? "varispeed" : "mute when not 1.0") : "none",
+		initialSpeed,
+		loopPlayback ? "YES" : "NO"
+		);
+
+	result = clipPlayer->StartPlayback(initialSpeed);
+	if (result != S_OK)
+		goto bail;
+
+	fprintf(stderr, "Starting Playback, enter q to exit\n");
+
+	ProcessCommands(clipPlayer, clipReader.GetFrameCount());
+
+	fprintf(stderr, "Stopping Playback\n");
+	clipPlayer->StopPlayback();
+
+	exitStatus = 0;
+
+bail:
+	if (clipPlayer != NULL)
+	{
+		clipPlayer->Release();
+		clipPlayer = NULL;
+	}
+
+	if (selectedDeckLinkOutput != NULL)
+	{
+		selectedDeckLinkOutput->Release();
+		selectedDeckLinkOutput = NULL;
+	}
+
+	if (deckLinkIterator != NULL)
+	{
+		deckLinkIterator->Release();
+		deckLinkIterator = NULL;
+	}
+
+	return exitStatus;
+}
@@ -39,6 +39,7 @@
 */
 
 #include "platform.h"
+#include "VideoConversion.h"
 
 HRESULT GetDeckLinkIterator(IDeckLinkIterator **deckLinkIterator)
 {
@@ -59,8 +60,9 @@ HRESULT GetDeckLinkFrameConverter(IDeckLinkVideoConversion** deckLinkFrameConver
 {
 	HRESULT result = S_OK;
 
-	// Create an IDeckLinkVideoConversion interface object to provide pixel format conversion of video frame.
-	*deckLinkFrameConverter = CreateVideoConversionInstance();
+	// Create an IDeckLinkVideoConversion interface object to provide pixel format conversion of video frame,
+	// converting in software with a thread per CPU.
+	*deckLinkFrameConverter = CreateSoftwareVideoConversionInstance();
 	if (*deckLinkFrameConverter == NULL)
 	{
 		fprintf(stderr, "A DeckLink Video Conversion interface could not be created.\n");
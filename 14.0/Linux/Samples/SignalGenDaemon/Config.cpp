@@ -0,0 +1,666 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctype.h>
+#include <strings.h>
+#include <unistd.h>
+#include "Config.h"
+#include "TextOverlay.h"
+
+static const size_t		kMaxConfigLineLength	= 256;
+static const unsigned	kMaxSchedulerThreads	= 16;
+static const uint32_t	kMaxToneFrequency		= 20000;
+
+static const struct
+{
+	const char*		name;
+	BMDPixelFormat	pixelFormat;
+}
+kPixelFormats[] =
+{
+	{ "8bit-yuv",	bmdFormat8BitYUV },
+	{ "10bit-yuv",	bmdFormat10BitYUV },
+	{ "10bit-rgb",	bmdFormat10BitRGB },
+	{ "12bit-rgb",	bmdFormat12BitRGB },
+};
+
+static const struct
+{
+	const char*		name;
+	TestPatternType	pattern;
+}
+kPatterns[] =
+{
+	{ "bars100",	kTestPatternColourBars100 },
+	{ "bars75",		kTestPatternColourBars75 },
+	{ "black",		kTestPatternBlack },
+	{ "white",		kTestPatternWhite },
+};
+
+// Tone names, in order of ToneSequence
+static const char* const	kToneNames[kToneSequenceCount] = { "continuous", "ident", "ebu", "glits" };
+
+static int			g_lineNumber = 0;		// Line of the configuration file being parsed, for messages
+
+static char* TrimSpace(char* text)
+{
+	char*	end;
+
+	while (isspace((unsigned char)*text))
+		text++;
+
+	end = text + strlen(text);
+	while ((end > text) && isspace((unsigned char)end[-1]))
+		*(--end) = '\0';
+
+	return text;
+}
+
+static bool ParseUnsigned(const char* value, unsigned long& number)
+{
+	char*	end;
+
+	if (!isdigit((unsigned char)*value))
+		return false;
+
+	number = strtoul(value, &end, 10);
+	return *end == '\0';
+}
+
+static bool ParseSwitch(const char* value, bool& on)
+{
+	if ((strcasecmp(value, "on") == 0) || (strcasecmp(value, "yes") == 0) || (strcmp(value, "1") == 0))
+		on = true;
+	else if ((strcasecmp(value, "off") == 0) || (strcasecmp(value, "no") == 0) || (strcmp(value, "0") == 0))
+		on = false;
+	else
+		return false;
+
+	return true;
+}
+
+BMDConfig::BMDConfig() :
+	m_configFile(NULL),
+	m_schedulerThreads(2),
+	m_statusInterval(1)
+{
+}
+
+bool BMDConfig::ParseArguments(int argc,  char** argv)
+{
+	int		ch;
+
+	while ((ch = getopt(argc, argv, "f:?h")) != -1)
+	{
+		switch (ch)
+		{
+			case 'f':
+				m_configFile = optarg;
+				break;
+
+			case '?':
+			case 'h':
+			default:
+				return false;
+		}
+	}
+
+	if (m_configFile == NULL)
+	{
+		fprintf(stderr, "No configuration file given\n");
+		return false;
+	}
+
+	return LoadFile(m_configFile);
+}
+
+void BMDConfig::DisplayUsage(int status)
+{
+	IDeckLinkIterator*				deckLinkIterator = CreateDeckLinkIteratorInstance();
+	IDeckLink*						deckLink = NULL;
+	int								deckLinkCount = 0;
+
+	fprintf(stderr,
+		"Usage: SignalGenDaemon -f <configuration file>\n"
+		"\n"
+		"    Outputs colour bars, line-up tone, ident and timecode on any number of DeckLink outputs.\n"
+		"    Outputs of the same display mode, pixel format, pattern and ident share their video frames,\n"
+		"    and outputs of the same tone share their audio.\n"
+		"\n"
+		"    Devices:\n"
+	);
+
+	while ((deckLinkIterator != NULL) && (deckLinkIterator->Next(&deckLink) == S_OK))
+	{
+		char*	deckLinkName;
+
+		if (IsPlaybackDevice(deckLink) && (deckLink->GetDisplayName((const char**)&deckLinkName) == S_OK))
+		{
+			fprintf(stderr, "        %2d: %s\n", deckLinkCount++, deckLinkName);
+			free(deckLinkName);
+		}
+
+		deckLink->Release();
+	}
+
+	if (deckLinkIterator != NULL)
+		deckLinkIterator->Release();
+	else
+		fprintf(stderr, "        No DeckLink drivers installed\n");
+
+	fprintf(stderr,
+		"\n"
+		"    Configuration file:\n"
+		"        threads = 2                      Scheduler threads shared by all outputs (default 2)\n"
+		"        cache = <directory>              Directory of pattern cache files\n"
+		"        status = <file>                  Status file, rewritten each interval (default stdout)\n"
+		"        interval = 1                     Status interval in seconds\n"
+		"\n"
+		"        [output]                         Starts the settings of an output\n"
+		"        device = <index>                 Playback device, see above\n"
+		"        mode = <name or index>           Display mode, eg 1080i50 (default 0)\n"
+		"        format = 8bit-yuv                8bit-yuv, 10bit-yuv, 10bit-rgb or 12bit-rgb\n"
+		"        pattern = bars75                 bars100, bars75, black or white\n"
+		"        ident = <text>                   Ident burnt into the pattern\n"
+		"        tone = off                       off, continuous, ident, ebu or glits\n"
+		"        frequency = 1000                 Tone frequency, a whole number of Hz\n"
+		"        level = -18                      Tone level in dBFS\n"
+		"        channels = 2                     Audio channels, 2, 8 or 16\n"
+		"        depth = 16                       Audio sample depth, 16 or 32 bits\n"
+		"        timecode = off                   RP188 timecode from 00:00:00:00\n"
+		"        ltc = off                        Audio channel of LTC, from 1\n"
+		"\n"
+		"    Example, outputs of the same bars with EBU line-up tone and timecode:\n"
+		"        threads = 2\n"
+		"        [output]\n"
+		"        device = 0\n"
+		"        mode = 1080i50\n"
+		"        ident = STUDIO 1\n"
+		"        tone = ebu\n"
+		"        timecode = on\n"
+		"        [output]\n"
+		"        device = 1\n"
+		"        ...\n"
+	);
+
+	exit(status);
+}
+
+void BMDConfig::DisplayConfiguration()
+{
+	fprintf(stderr, "Outputting with the following configuration:\n"
+		" - Scheduler threads: %u\n"
+		" - Pattern cache: %s\n"
+		" - Status: %s every %u s\n",
+		m_schedulerThreads,
+		m_patternCacheDirectory.empty() ? "in memory" : m_patternCacheDirectory.c_str(),
+		m_statusFile.empty() ? "stdout" : m_statusFile.c_str(),
+		m_statusInterval
+	);
+
+	for (size_t i = 0; i < m_outputs.size(); i++)
+	{
+		const OutputConfig&	output = m_outputs[i];
+
+		fprintf(stderr, " - Output %zu: device %d, mode %s, %s, %s%s%s%s\n",
+			i,
+			output.deckLinkIndex,
+			output.displayModeName.c_str(),
+			GetPixelFormatName(output.pixelFormat),
+			GetPatternName(output.pattern),
+			output.identText.empty() ? "" : " \"",
+			output.identText.c_str(),
+			output.identText.empty() ? "" : "\""
+		);
+
+		fprintf(stderr, "     %u channels of %u bit audio, ", output.audioChannels, output.audioSampleDepth);
+		if (output.toneSequence >= 0)
+			fprintf(stderr, "%s tone, %u Hz at %g dBFS", GetToneSequenceName(output.toneSequence), output.toneFrequency, output.toneLevel);
+		else
+			fprintf(stderr, "silence");
+
+		if (output.ltcChannel >= 0)
+			fprintf(stderr, ", LTC on channel %d", output.ltcChannel + 1);
+
+		fprintf(stderr, "%s\n", output.timecode ? ", RP188 timecode" : "");
+	}
+}
+
+bool BMDConfig::LoadFile(const char* path)
+{
+	FILE*			file	= fopen(path, "r");
+	char			line[kMaxConfigLineLength];
+	OutputConfig*	output	= NULL;
+	bool			valid	= true;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open the configuration file %s\n", path);
+		return false;
+	}
+
+	m_outputs.clear();
+	g_lineNumber = 0;
+
+	while (valid && (fgets(line, sizeof(line), file) != NULL))
+	{
+		char*	comment	= strchr(line, '#');
+		char*	separator;
+		char*	text;
+
+		g_lineNumber++;
+
+		if (comment != NULL)
+			*comment = '\0';
+
+		text = TrimSpace(line);
+		if (*text == '\0')
+			continue;
+
+		if (strcasecmp(text, "[output]") == 0)
+		{
+			// Validate each output when the next starts
+			if (output != NULL)
+				valid = ValidateOutput(*output);
+
+			m_outputs.push_back(OutputConfig());
+			output = &m_outputs.back();
+
+			output->lineNumber			= g_lineNumber;
+			output->deckLinkIndex		= -1;
+			output->displayModeName		= "0";
+			output->pixelFormat			= bmdFormat8BitYUV;
+			output->pattern				= kTestPatternColourBars75;
+			output->toneSequence		= -1;
+			output->toneFrequency		= (uint32_t)kDefaultToneFrequency;
+			output->toneLevel			= kDefaultToneLevel;
+			output->audioChannels		= 2;
+			output->audioSampleDepth	= 16;
+			output->timecode			= false;
+			output->ltcChannel			= -1;
+			continue;
+		}
+
+		separator = strchr(text, '=');
+		if (separator == NULL)
+		{
+			fprintf(stderr, "%s:%d: Expected <setting> = <value>\n", path, g_lineNumber);
+			valid = false;
+			break;
+		}
+
+		*separator = '\0';
+
+		if (output != NULL)
+			valid = SetOutputValue(*output, TrimSpace(text), TrimSpace(separator + 1));
+		else
+			valid = SetGlobalValue(TrimSpace(text), TrimSpace(separator + 1));
+	}
+
+	fclose(file);
+
+	if (valid && (output != NULL))
+		valid = ValidateOutput(*output);
+
+	if (valid && m_outputs.empty())
+	{
+		fprintf(stderr, "%s: No [output] sections\n", path);
+		valid = false;
+	}
+
+	return valid;
+}
+
+bool BMDConfig::SetGlobalValue(const char* key, const char* value)
+{
+	unsigned long	number;
+
+	if (strcasecmp(key, "threads") == 0)
+	{
+		if (!ParseUnsigned(value, number) || (number < 1) || (number > kMaxSchedulerThreads))
+		{
+			fprintf(stderr, "%s:%d: Scheduler threads must be from 1 to %u\n", m_configFile, g_lineNumber, kMaxSchedulerThreads);
+			return false;
+		}
+		m_schedulerThreads = (unsigned)number;
+	}
+	else if (strcasecmp(key, "cache") == 0)
+	{
+		m_patternCacheDirectory = value;
+	}
+	else if (strcasecmp(key, "status") == 0)
+	{
+		m_statusFile = value;
+	}
+	else if (strcasecmp(key, "interval") == 0)
+	{
+		if (!ParseUnsigned(value, number) || (number < 1))
+		{
+			fprintf(stderr, "%s:%d: The status interval must be at least 1 second\n", m_configFile, g_lineNumber);
+			return false;
+		}
+		m_statusInterval = (unsigned)number;
+	}
+	else
+	{
+		fprintf(stderr, "%s:%d: Unknown setting %s, output settings follow [output]\n", m_configFile, g_lineNumber, key);
+		return false;
+	}
+
+	return true;
+}
+
+bool BMDConfig::SetOutputValue(OutputConfig& output, const char* key, const char* value)
+{
+	unsigned long	number;
+	const char*		error = NULL;
+
+	if (strcasecmp(key, "device") == 0)
+	{
+		if (ParseUnsigned(value, number))
+			output.deckLinkIndex = (int)number;
+		else
+			error = "The device must be an index";
+	}
+	else if (strcasecmp(key, "mode") == 0)
+	{
+		output.displayModeName = value;
+	}
+	else if (strcasecmp(key, "format") == 0)
+	{
+		error = "Unknown pixel format";
+		for (auto& format : kPixelFormats)
+		{
+			if (strcasecmp(value, format.name) == 0)
+			{
+				output.pixelFormat = format.pixelFormat;
+				error = NULL;
+			}
+		}
+	}
+	else if (strcasecmp(key, "pattern") == 0)
+	{
+		error = "Unknown pattern";
+		for (auto& pattern : kPatterns)
+		{
+			if (strcasecmp(value, pattern.name) == 0)
+			{
+				output.pattern = pattern.pattern;
+				error = NULL;
+			}
+		}
+	}
+	else if (strcasecmp(key, "ident") == 0)
+	{
+		output.identText = value;
+	}
+	else if (strcasecmp(key, "tone") == 0)
+	{
+		output.toneSequence = -1;
+		for (int sequence = 0; sequence < kToneSequenceCount; sequence++)
+		{
+			if (strcasecmp(value, kToneNames[sequence]) == 0)
+				output.toneSequence = sequence;
+		}
+
+		if ((output.toneSequence < 0) && (strcasecmp(value, "off") != 0))
+			error = "Unknown tone";
+	}
+	else if (strcasecmp(key, "frequency") == 0)
+	{
+		// A whole number of Hz has a whole number of cycles in each second of the shared audio
+		if (ParseUnsigned(value, number) && (number >= 1) && (number <= kMaxToneFrequency))
+			output.toneFrequency = (uint32_t)number;
+		else
+			error = "The tone frequency must be a whole number of Hz up to 20000";
+	}
+	else if (strcasecmp(key, "level") == 0)
+	{
+		char*	end;
+
+		output.toneLevel = strtod(value, &end);
+		if ((*end != '\0') || (end == value) || (output.toneLevel > 0.0))
+			error = "The tone level must be a dBFS value up to 0";
+	}
+	else if (strcasecmp(key, "channels") == 0)
+	{
+		if (ParseUnsigned(value, number) && ((number == 2) || (number == 8) || (number == 16)))
+			output.audioChannels = (uint32_t)number;
+		else
+			error = "Audio channels must be either 2, 8 or 16";
+	}
+	else if (strcasecmp(key, "depth") == 0)
+	{
+		if (ParseUnsigned(value, number) && ((number == 16) || (number == 32)))
+			output.audioSampleDepth = (uint32_t)number;
+		else
+			error = "Audio sample depth must be either 16 bits or 32 bits";
+	}
+	else if (strcasecmp(key, "timecode") == 0)
+	{
+		if (!ParseSwitch(value, output.timecode))
+			error = "Timecode must be on or off";
+	}
+	else if (strcasecmp(key, "ltc") == 0)
+	{
+		if (strcasecmp(value, "off") == 0)
+			output.ltcChannel = -1;
+		else if (ParseUnsigned(value, number) && (number >= 1))
+			output.ltcChannel = (int)number - 1;
+		else
+			error = "The LTC channel must be from 1, or off";
+	}
+	else
+	{
+		error = "Unknown output setting";
+	}
+
+	if (error != NULL)
+	{
+		fprintf(stderr, "%s:%d: %s: %s = %s\n", m_configFile, g_lineNumber, error, key, value);
+		return false;
+	}
+
+	return true;
+}
+
+bool BMDConfig::ValidateOutput(const OutputConfig& output)
+{
+	const char*		error = NULL;
+
+	if (output.deckLinkIndex < 0)
+		error = "No device";
+	else if ((output.ltcChannel >= 0) && ((uint32_t)output.ltcChannel >= output.audioChannels))
+		error = "The LTC channel is not one of the audio channels";
+	else if (!output.identText.empty() && !TextOverlay::IsPixelFormatSupported(output.pixelFormat))
+		error = "Ident text is not supported in the pixel format";
+
+	for (size_t i = 0; (error == NULL) && (i < m_outputs.size()); i++)
+	{
+		if ((&m_outputs[i] != &output) && (m_outputs[i].deckLinkIndex == output.deckLinkIndex))
+			error = "The device is used by another output";
+	}
+
+	if (error != NULL)
+	{
+		fprintf(stderr, "%s:%d: %s\n", m_configFile, output.lineNumber, error);
+		return false;
+	}
+
+	return true;
+}
+
+IDeckLink* BMDConfig::GetDeckLink(int index)
+{
+	HRESULT				result;
+	IDeckLink*			deckLink;
+	IDeckLinkIterator*	deckLinkIterator = CreateDeckLinkIteratorInstance();
+	int					i = 0;
+
+	if (!deckLinkIterator)
+	{
+		fprintf(stderr, "This application requires the DeckLink drivers installed.\n");
+		return NULL;
+	}
+
+	while((result = deckLinkIterator->Next(&deckLink)) == S_OK)
+	{
+		// Skip over devices that don't support playback
+		if (IsPlaybackDevice(deckLink))
+		{
+			if (index == i++)
+				break;
+		}
+
+		deckLink->Release();
+	}
+
+	deckLinkIterator->Release();
+
+	if (result != S_OK)
+		return NULL;
+
+	return deckLink;
+}
+
+IDeckLinkDisplayMode* BMDConfig::GetDisplayMode(IDeckLinkOutput* deckLinkOutput, const std::string& name)
+{
+	IDeckLinkDisplayMode*			displayMode = NULL;
+	IDeckLinkDisplayModeIterator*	displayModeIterator = NULL;
+	unsigned long					index;
+	bool							byIndex = ParseUnsigned(name.c_str(), index);
+	unsigned long					i = 0;
+
+	if (deckLinkOutput->GetDisplayModeIterator(&displayModeIterator) != S_OK)
+		return NULL;
+
+	while (displayModeIterator->Next(&displayMode) == S_OK)
+	{
+		char*	displayModeName;
+		bool	found = false;
+
+		if (byIndex)
+			found = (index == i++);
+		else if (displayMode->GetName((const char**)&displayModeName) == S_OK)
+		{
+			found = (strcasecmp(displayModeName, name.c_str()) == 0);
+			free(displayModeName);
+		}
+
+		if (found)
+			break;
+
+		displayMode->Release();
+		displayMode = NULL;
+	}
+
+	displayModeIterator->Release();
+
+	return displayMode;
+}
+
+const char* BMDConfig::GetPixelFormatName(BMDPixelFormat pixelFormat)
+{
+	switch (pixelFormat)
+	{
+		case bmdFormat8BitYUV:
+			return "8 bit YUV (4:2:2)";
+		case bmdFormat10BitYUV:
+			return "10 bit YUV (4:2:2)";
+		case bmdFormat10BitRGB:
+			return "10 bit RGB (4:4:4)";
+		case bmdFormat12BitRGB:
+			return "12 bit RGB (4:4:4)";
+	}
+	return "unknown";
+}
+
+const char* BMDConfig::GetPatternName(TestPatternType pattern)
+{
+	switch (pattern)
+	{
+		case kTestPatternBlack:
+			return "black";
+		case kTestPatternColourBars100:
+			return "100% colour bars";
+		case kTestPatternColourBars100Reversed:
+			return "reversed 100% colour bars";
+		case kTestPatternColourBars75:
+			return "75% colour bars";
+		case kTestPatternWhite:
+			return "white";
+	}
+	return "unknown";
+}
+
+const char* BMDConfig::GetToneSequenceName(int sequence)
+{
+	switch (sequence)
+	{
+		case kToneSequenceContinuous:
+			return "continuous line-up";
+		case kToneSequenceChannelIdent:
+			return "channel ident";
+		case kToneSequenceEBU:
+			return "EBU stereo line-up";
+		case kToneSequenceGLITS:
+			return "GLITS stereo line-up";
+	}
+	return "unknown";
+}
+
+bool BMDConfig::IsPlaybackDevice(IDeckLink* deckLink)
+{
+	IDeckLinkProfileAttributes*		deckLinkAttributes = NULL;
+	int64_t							ioSupport;
+
+	if (deckLink->QueryInterface(IID_IDeckLinkProfileAttributes, (void**)&deckLinkAttributes) != S_OK)
+		return false;
+
+	if (deckLinkAttributes->GetInt(BMDDeckLinkVideoIOSupport, &ioSupport) != S_OK)
+		ioSupport = 0;
+
+	deckLinkAttributes->Release();
+
+	return ((BMDVideoIOSupport)ioSupport & bmdDeviceSupportsPlayback) != 0;
+}
@@ -0,0 +1,127 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#ifndef BMD_CONFIG_H
+#define BMD_CONFIG_H
+
+#include <string>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "PatternCache.h"
+#include "ToneGenerator.h"
+
+// The configuration file has global settings, then an [output] section for each output, with a setting on each
+// line and '#' starting a comment:
+//
+//     threads = 2                          # Scheduler threads shared by all outputs
+//     cache = /var/cache/signalgen         # Directory of pattern cache files
+//     status = /run/signalgen.status       # Status file, rewritten every interval, or stdout if not set
+//     interval = 1                         # Status interval in seconds
+//
+//     [output]
+//     device = 0                           # Index of the playback device
+//     mode = 1080i50                       # Display mode name or index
+//     format = 10bit-yuv                   # 8bit-yuv, 10bit-yuv, 10bit-rgb or 12bit-rgb
+//     pattern = bars75                     # bars100, bars75, black or white
+//     ident = STUDIO 1                     # Text burnt into the pattern
+//     tone = ident                         # off, continuous, ident, ebu or glits
+//     frequency = 1000                     # Hz, a whole number
+//     level = -18                          # dBFS
+//     channels = 8                         # 2, 8 or 16
+//     depth = 32                           # 16 or 32
+//     timecode = on                        # RP188 timecode from 00:00:00:00
+//     ltc = 8                              # Audio channel of LTC, from 1, or off
+
+struct OutputConfig
+{
+	int					lineNumber;				// Line of the [output] section
+
+	int					deckLinkIndex;
+	std::string			displayModeName;		// Name, or index if a number
+	BMDPixelFormat		pixelFormat;
+	TestPatternType		pattern;
+	std::string			identText;				// Empty for no ident
+
+	int					toneSequence;			// ToneSequence, or -1 for silence
+	uint32_t			toneFrequency;
+	double				toneLevel;				// dBFS
+	uint32_t			audioChannels;
+	uint32_t			audioSampleDepth;
+
+	bool				timecode;
+	int					ltcChannel;				// From 0, or -1 for no LTC
+};
+
+class BMDConfig
+{
+public:
+	BMDConfig();
+
+	bool ParseArguments(int argc,  char** argv);
+	void DisplayUsage(int status);
+	void DisplayConfiguration();
+
+	const char*					m_configFile;
+	unsigned					m_schedulerThreads;
+	std::string					m_patternCacheDirectory;
+	std::string					m_statusFile;
+	unsigned					m_statusInterval;		// Seconds
+
+	std::vector<OutputConfig>	m_outputs;
+
+	// Playback device of an index, or NULL
+	static IDeckLink*				GetDeckLink(int index);
+	// Display mode of an output by name or index, or NULL
+	static IDeckLinkDisplayMode*	GetDisplayMode(IDeckLinkOutput* deckLinkOutput, const std::string& name);
+
+	static const char*			GetPixelFormatName(BMDPixelFormat pixelFormat);
+	static const char*			GetPatternName(TestPatternType pattern);
+	static const char*			GetToneSequenceName(int sequence);
+
+private:
+	bool						LoadFile(const char* path);
+	bool						SetGlobalValue(const char* key, const char* value);
+	bool						SetOutputValue(OutputConfig& output, const char* key, const char* value);
+	bool						ValidateOutput(const OutputConfig& output);
+
+	static bool					IsPlaybackDevice(IDeckLink* deckLink);
+};
+
+#endif
@@ -0,0 +1,419 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "GeneratorOutput.h"
+#include "TimecodeBurnIn.h"
+#include "VideoConversion.h"
+
+static const uint32_t	kAudioSampleRate	= 48000;
+
+// Frames scheduled ahead of output, and frames of the pool, which must be more so that a frame is not changed
+// before it is completed
+static const uint32_t	kPrerollFrames		= 8;
+static const uint32_t	kFramePoolSize		= kPrerollFrames + 4;
+
+// Audio is buffered to a quarter of a second, as the preroll of video at 30 fps
+static const uint32_t	kAudioWaterlevel	= kAudioSampleRate / 4;
+
+GeneratorOutput::GeneratorOutput(const OutputConfig& config, SharedSignalStore& store, OutputScheduler* scheduler) :
+	m_refCount(1),
+	m_config(config),
+	m_store(store),
+	m_scheduler(scheduler),
+	m_deckLink(),
+	m_deckLinkOutput(),
+	m_deckLinkConfiguration(),
+	m_frameDuration(0),
+	m_timeScale(0),
+	m_framesPerSecond(0),
+	m_interlaced(false),
+	m_audioLoopPosition(0),
+	m_ltcBufferedFrames(0),
+	m_state(kOutputStopped),
+	m_framesScheduled(0),
+	m_framesCompleted(0),
+	m_framesLate(0),
+	m_framesDropped(0),
+	m_framesFlushed(0),
+	m_bufferedAudioFrames(0)
+{
+}
+
+GeneratorOutput::~GeneratorOutput()
+{
+	ReleaseDevice();
+}
+
+bool GeneratorOutput::Start(void)
+{
+	IDeckLinkDisplayMode*	displayMode = NULL;
+	char*					name;
+	bool					supported = false;
+	BMDVideoOutputFlags		outputFlags = m_config.timecode ? bmdVideoOutputRP188 : bmdVideoOutputFlagDefault;
+	HRESULT					result;
+
+	{
+		std::lock_guard<std::mutex> lock(m_errorMutex);
+		m_error.clear();
+	}
+
+	m_framesScheduled		= 0;
+	m_framesCompleted		= 0;
+	m_framesLate			= 0;
+	m_framesDropped			= 0;
+	m_framesFlushed			= 0;
+	m_bufferedAudioFrames	= 0;
+	m_audioLoopPosition		= 0;
+	m_ltcBufferedFrames		= 0;
+
+	m_deckLink = BMDConfig::GetDeckLink(m_config.deckLinkIndex);
+	if (m_deckLink == NULL)
+		return Fail("No playback device of the index");
+
+	if (m_deckLink->GetDisplayName((const char**)&name) == S_OK)
+	{
+		m_deviceName = name;
+		free(name);
+	}
+
+	if ((m_deckLink->QueryInterface(IID_IDeckLinkOutput, (void**)&m_deckLinkOutput) != S_OK) ||
+		(m_deckLink->QueryInterface(IID_IDeckLinkConfiguration, (void**)&m_deckLinkConfiguration) != S_OK))
+		return Fail("Could not get the output interfaces of the device");
+
+	displayMode = BMDConfig::GetDisplayMode(m_deckLinkOutput, m_config.displayModeName);
+	if (displayMode == NULL)
+		return Fail("No display mode of the name or index");
+
+	if (displayMode->GetName((const char**)&name) == S_OK)
+	{
+		m_displayModeName = name;
+		free(name);
+	}
+
+	displayMode->GetFrameRate(&m_frameDuration, &m_timeScale);
+	m_framesPerSecond	= (uint32_t)((m_timeScale + m_frameDuration - 1) / m_frameDuration);
+	m_interlaced		= (displayMode->GetFieldDominance() != bmdProgressiveFrame);
+
+	result = m_deckLinkOutput->DoesSupportVideoMode(bmdVideoConnectionUnspecified, displayMode->GetDisplayMode(), m_config.pixelFormat,
+													bmdNoVideoOutputConversion, bmdSupportedVideoModeDefault, NULL, &supported);
+	if ((result != S_OK) || !supported)
+	{
+		displayMode->Release();
+		return Fail("The display mode is not supported in the pixel format");
+	}
+
+	m_pattern = m_store.GetPattern(displayMode->GetDisplayMode(), (uint32_t)displayMode->GetWidth(), (uint32_t)displayMode->GetHeight(),
+								   m_config.pixelFormat, m_config.pattern, m_config.identText);
+	result = m_deckLinkOutput->EnableVideoOutput(displayMode->GetDisplayMode(), outputFlags);
+	displayMode->Release();
+
+	if (m_pattern == NULL)
+		return Fail("The pattern is not supported in the pixel format");
+
+	if (result != S_OK)
+		return Fail("Could not enable video output, is another application using the device?");
+
+	m_audioLoop = m_store.GetAudioLoop(m_config.audioChannels, m_config.audioSampleDepth, m_config.toneSequence, m_config.toneFrequency, m_config.toneLevel);
+	if (m_audioLoop == NULL)
+		return Fail("The tone is not valid");
+
+	// RGB is output as 4:4:4 on SDI, a device without SDI output returns E_NOTIMPL
+	result = m_deckLinkConfiguration->SetFlag(bmdDeckLinkConfig444SDIVideoOutput, !IsYUVPixelFormat(m_config.pixelFormat));
+	if ((result != S_OK) && (result != E_NOTIMPL))
+		return Fail("Could not set 4:4:4 SDI output");
+
+	if (m_deckLinkOutput->EnableAudioOutput(bmdAudioSampleRate48kHz, m_config.audioSampleDepth, m_config.audioChannels, bmdAudioOutputStreamContinuous) != S_OK)
+		return Fail("Could not enable audio output");
+
+	// LTC starts at 00:00:00:00 with the first frame, as the RP188 timecode
+	if (m_config.ltcChannel >= 0)
+	{
+		m_ltcEncoder.reset(new LTCEncoder(m_frameDuration, m_timeScale, kAudioSampleRate));
+		m_ltcBuffer.resize(kAudioWaterlevel * m_audioLoop->GetFrameBytes());
+	}
+
+	for (uint32_t i = 0; i < kFramePoolSize; i++)
+		m_framePool.push_back(new OutputFrame(m_pattern));
+
+	m_deckLinkOutput->SetScheduledFrameCompletionCallback(this);
+
+	m_state = kOutputRunning;
+
+	for (uint32_t i = 0; i < kPrerollFrames; i++)
+	{
+		if (!ScheduleNextFrame())
+			return false;
+	}
+
+	if ((m_deckLinkOutput->BeginAudioPreroll() != S_OK) || !ScheduleAudio() || (m_deckLinkOutput->EndAudioPreroll() != S_OK))
+		return Fail("Could not preroll audio");
+
+	if (m_deckLinkOutput->StartScheduledPlayback(0, m_timeScale, 1.0) != S_OK)
+		return Fail("Could not start playback");
+
+	m_scheduler->AddOutput(this);
+	return true;
+}
+
+void GeneratorOutput::Stop(void)
+{
+	m_scheduler->RemoveOutput(this);
+
+	if (m_deckLinkOutput != NULL)
+	{
+		m_deckLinkOutput->StopScheduledPlayback(0, NULL, 0);
+		m_deckLinkOutput->DisableAudioOutput();
+		m_deckLinkOutput->DisableVideoOutput();
+		m_deckLinkOutput->SetScheduledFrameCompletionCallback(NULL);
+	}
+
+	ReleaseDevice();
+
+	if (m_state == kOutputRunning)
+		m_state = kOutputStopped;
+}
+
+void GeneratorOutput::Service(void)
+{
+	if (m_state != kOutputRunning)
+		return;
+
+	while (m_framesScheduled - m_framesCompleted < kPrerollFrames)
+	{
+		if (!ScheduleNextFrame())
+			return;
+	}
+
+	ScheduleAudio();
+}
+
+void GeneratorOutput::GetStatus(OutputStatus& status)
+{
+	uint64_t	framesCompleted = m_framesCompleted;
+
+	{
+		std::lock_guard<std::mutex> lock(m_errorMutex);
+		status.error = m_error;
+	}
+
+	status.deviceName			= m_deviceName;
+	status.displayModeName		= m_displayModeName;
+	status.state				= m_state;
+	status.framesScheduled		= m_framesScheduled;
+	status.framesCompleted		= framesCompleted;
+	status.framesLate			= m_framesLate;
+	status.framesDropped		= m_framesDropped;
+	status.framesFlushed		= m_framesFlushed;
+	status.bufferedAudioFrames	= m_bufferedAudioFrames;
+	status.timecode[0]			= '\0';
+
+	if ((framesCompleted > 0) && (m_frameDuration > 0))
+	{
+		BurnInTimecode	timecode;
+
+		ComputeTimecode(framesCompleted - 1, m_frameDuration, m_timeScale, timecode);
+		snprintf(status.timecode, sizeof(status.timecode), "%02u:%02u:%02u%c%02u",
+				 timecode.hours, timecode.minutes, timecode.seconds, timecode.dropFrame ? ';' : ':', timecode.frames);
+	}
+}
+
+HRESULT GeneratorOutput::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	*ppv = NULL;
+	return E_NOINTERFACE;
+}
+
+ULONG GeneratorOutput::AddRef()
+{
+	// gcc atomic operation builtin
+	return __sync_add_and_fetch(&m_refCount, 1);
+}
+
+ULONG GeneratorOutput::Release()
+{
+	// gcc atomic operation builtin
+	ULONG newRefValue = __sync_sub_and_fetch(&m_refCount, 1);
+	if (!newRefValue)
+		delete this;
+	return newRefValue;
+}
+
+HRESULT GeneratorOutput::ScheduledFrameCompleted(IDeckLinkVideoFrame* completedFrame, BMDOutputFrameCompletionResult result)
+{
+	if (result == bmdOutputFrameDisplayedLate)
+		++m_framesLate;
+	else if (result == bmdOutputFrameDropped)
+		++m_framesDropped;
+	else if (result == bmdOutputFrameFlushed)
+		++m_framesFlushed;
+
+	++m_framesCompleted;
+	m_scheduler->Wake();
+
+	return S_OK;
+}
+
+HRESULT GeneratorOutput::ScheduledPlaybackHasStopped()
+{
+	return S_OK;
+}
+
+bool GeneratorOutput::Fail(const char* error)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_errorMutex);
+		m_error = error;
+	}
+
+	m_state = kOutputFailed;
+	fprintf(stderr, "Output of device %d (%s): %s\n", m_config.deckLinkIndex, m_deviceName.empty() ? "unknown" : m_deviceName.c_str(), error);
+
+	return false;
+}
+
+bool GeneratorOutput::ScheduleNextFrame(void)
+{
+	uint64_t		frameNumber	= m_framesScheduled;
+	OutputFrame*	frame		= m_framePool[frameNumber % m_framePool.size()];
+
+	if (m_config.timecode)
+	{
+		BurnInTimecode	timecode;
+
+		ComputeTimecode(frameNumber, m_frameDuration, m_timeScale, timecode);
+		frame->SetTimecode(timecode.hours, timecode.minutes, timecode.seconds, timecode.frames, timecode.dropFrame, m_framesPerSecond, m_interlaced);
+	}
+
+	if (m_deckLinkOutput->ScheduleVideoFrame(frame, frameNumber * m_frameDuration, m_frameDuration, m_timeScale) != S_OK)
+		return Fail("Could not schedule a video frame");
+
+	++m_framesScheduled;
+	return true;
+}
+
+bool GeneratorOutput::ScheduleAudio(void)
+{
+	const SharedAudioLoop&	audioLoop		= *m_audioLoop;
+	const size_t			frameBytes		= audioLoop.GetFrameBytes();
+	uint32_t				bufferedFrames	= 0;
+	uint32_t				framesToWrite;
+	uint32_t				written;
+
+	if (m_deckLinkOutput->GetBufferedAudioSampleFrameCount(&bufferedFrames) != S_OK)
+		return false;
+
+	m_bufferedAudioFrames = bufferedFrames;
+	if (bufferedFrames >= kAudioWaterlevel)
+		return true;
+
+	framesToWrite = kAudioWaterlevel - bufferedFrames;
+
+	if (!m_ltcEncoder)
+	{
+		// Schedule directly from the shared loop
+		while (framesToWrite > 0)
+		{
+			uint32_t	count = std::min(framesToWrite, audioLoop.sampleFrames - m_audioLoopPosition);
+
+			if (m_deckLinkOutput->ScheduleAudioSamples((void*)(audioLoop.samples.data() + m_audioLoopPosition * frameBytes), count, 0, 0, &written) != S_OK)
+				return false;
+
+			m_audioLoopPosition	= (m_audioLoopPosition + written) % audioLoop.sampleFrames;
+			framesToWrite		-= written;
+
+			if (written < count)
+				break;
+		}
+
+		return true;
+	}
+
+	// Copy the loop after the frames not yet scheduled, and encode LTC into the copy once
+	while (m_ltcBufferedFrames < framesToWrite)
+	{
+		uint8_t*	buffer	= m_ltcBuffer.data() + m_ltcBufferedFrames * frameBytes;
+		uint32_t	count	= std::min(framesToWrite - m_ltcBufferedFrames, audioLoop.sampleFrames - m_audioLoopPosition);
+
+		memcpy(buffer, audioLoop.samples.data() + m_audioLoopPosition * frameBytes, count * frameBytes);
+		m_ltcEncoder->Encode(buffer, count, audioLoop.channels, (uint32_t)m_config.ltcChannel, audioLoop.sampleDepth);
+
+		m_audioLoopPosition	= (m_audioLoopPosition + count) % audioLoop.sampleFrames;
+		m_ltcBufferedFrames	+= count;
+	}
+
+	if (m_deckLinkOutput->ScheduleAudioSamples(m_ltcBuffer.data(), m_ltcBufferedFrames, 0, 0, &written) != S_OK)
+		return false;
+
+	m_ltcBufferedFrames -= written;
+	memmove(m_ltcBuffer.data(), m_ltcBuffer.data() + written * frameBytes, m_ltcBufferedFrames * frameBytes);
+
+	return true;
+}
+
+void GeneratorOutput::ReleaseDevice(void)
+{
+	for (OutputFrame* frame : m_framePool)
+		frame->Release();
+
+	m_framePool.clear();
+	m_ltcEncoder.reset();
+
+	if (m_deckLinkConfiguration != NULL)
+	{
+		m_deckLinkConfiguration->Release();
+		m_deckLinkConfiguration = NULL;
+	}
+
+	if (m_deckLinkOutput != NULL)
+	{
+		m_deckLinkOutput->Release();
+		m_deckLinkOutput = NULL;
+	}
+
+	if (m_deckLink != NULL)
+	{
+		m_deckLink->Release();
+		m_deckLink = NULL;
+	}
+}
@@ -0,0 +1,157 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "Config.h"
+#include "LTC.h"
+#include "OutputFrame.h"
+#include "OutputScheduler.h"
+#include "SharedSignals.h"
+
+// GeneratorOutput drives one DeckLink output with the signals of its configuration.  Video frames are OutputFrames
+// of the shared pattern, a pool of them scheduled in order with the RP188 timecode of each frame, so an output
+// holds no frame buffers of its own.  Audio is streamed in continuous mode from the shared audio loop, each output
+// at its own position in the loop.  Only an output with LTC copies its audio, into a buffer of the water level in
+// which LTC is encoded as it is scheduled.
+//
+// Scheduling is done by the output's OutputScheduler: Start() prerolls the output on the calling thread, then adds
+// it to the scheduler, which calls Service() from its thread.  The completion callback counts the result of the
+// frame and wakes the scheduler.  Status is read from counters, GetStatus() may be called from any thread.
+//
+// An output which fails to start, or fails while scheduling, is stopped and keeps the reason for its status.
+
+enum OutputState
+{
+	kOutputStopped = 0,
+	kOutputRunning,
+	kOutputFailed
+};
+
+struct OutputStatus
+{
+	std::string		deviceName;
+	std::string		displayModeName;
+	OutputState		state;
+	std::string		error;
+
+	uint64_t		framesScheduled;
+	uint64_t		framesCompleted;		// Every completion result, including late, dropped and flushed frames
+	uint64_t		framesLate;
+	uint64_t		framesDropped;
+	uint64_t		framesFlushed;
+	uint32_t		bufferedAudioFrames;
+	char			timecode[16];			// Timecode of the last completed frame
+};
+
+class GeneratorOutput : public IDeckLinkVideoOutputCallback
+{
+public:
+	GeneratorOutput(const OutputConfig& config, SharedSignalStore& store, OutputScheduler* scheduler);
+
+	// Start output, returns false if the output failed to start
+	bool				Start(void);
+	void				Stop(void);
+
+	// Schedule frames up to the preroll and audio up to the water level, called by the scheduler
+	void				Service(void);
+
+	OutputState			GetState(void) const { return m_state; }
+	void				GetStatus(OutputStatus& status);
+
+	// IUnknown
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, LPVOID *ppv);
+	virtual ULONG STDMETHODCALLTYPE AddRef();
+	virtual ULONG STDMETHODCALLTYPE Release();
+
+	// IDeckLinkVideoOutputCallback
+	virtual HRESULT STDMETHODCALLTYPE ScheduledFrameCompleted(IDeckLinkVideoFrame* completedFrame, BMDOutputFrameCompletionResult result);
+	virtual HRESULT STDMETHODCALLTYPE ScheduledPlaybackHasStopped();
+
+private:
+	int32_t									m_refCount;
+	OutputConfig							m_config;
+	SharedSignalStore&						m_store;
+	OutputScheduler*						m_scheduler;
+
+	IDeckLink*								m_deckLink;
+	IDeckLinkOutput*						m_deckLinkOutput;
+	IDeckLinkConfiguration*					m_deckLinkConfiguration;
+	std::string								m_deviceName;
+	std::string								m_displayModeName;
+
+	BMDTimeValue							m_frameDuration;
+	BMDTimeScale							m_timeScale;
+	uint32_t								m_framesPerSecond;		// Rounded up, 30 at 29.97
+	bool									m_interlaced;
+
+	std::shared_ptr<const SharedPattern>	m_pattern;
+	std::vector<OutputFrame*>				m_framePool;			// Frame n is m_framePool[n % size]
+
+	std::shared_ptr<const SharedAudioLoop>	m_audioLoop;
+	uint32_t								m_audioLoopPosition;	// Next sample frame of the loop to schedule
+	std::unique_ptr<LTCEncoder>				m_ltcEncoder;
+	std::vector<uint8_t>					m_ltcBuffer;
+	uint32_t								m_ltcBufferedFrames;	// Encoded frames in m_ltcBuffer, not yet scheduled
+
+	std::atomic<OutputState>				m_state;
+	std::mutex								m_errorMutex;
+	std::string								m_error;
+
+	std::atomic<uint64_t>					m_framesScheduled;
+	std::atomic<uint64_t>					m_framesCompleted;
+	std::atomic<uint64_t>					m_framesLate;
+	std::atomic<uint64_t>					m_framesDropped;
+	std::atomic<uint64_t>					m_framesFlushed;
+	std::atomic<uint32_t>					m_bufferedAudioFrames;
+
+	virtual ~GeneratorOutput();
+
+	bool				Fail(const char* error);
+	bool				ScheduleNextFrame(void);
+	bool				ScheduleAudio(void);
+	void				ReleaseDevice(void);
+};
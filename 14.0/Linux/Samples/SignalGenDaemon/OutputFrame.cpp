@@ -0,0 +1,261 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "OutputFrame.h"
+
+static const uint32_t	kTimecodeVITC1			= 1;
+static const uint32_t	kTimecodeVITC2			= 2;
+static const uint32_t	kMaxVITCFramesPerSecond	= 30;
+
+static inline bool CompareREFIID(const REFIID& ref1, const REFIID& ref2)
+{
+	return memcmp(&ref1, &ref2, sizeof(REFIID)) == 0;
+}
+
+static inline uint32_t ToBCD(uint8_t value)
+{
+	return ((value / 10) << 4) | (value % 10);
+}
+
+FrameTimecode::FrameTimecode() :
+	m_refCount(1),
+	m_hours(0),
+	m_minutes(0),
+	m_seconds(0),
+	m_frames(0),
+	m_flags(bmdTimecodeFlagDefault)
+{
+}
+
+void FrameTimecode::SetComponents(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames, BMDTimecodeFlags flags)
+{
+	m_hours		= hours;
+	m_minutes	= minutes;
+	m_seconds	= seconds;
+	m_frames	= frames;
+	m_flags		= flags;
+}
+
+HRESULT FrameTimecode::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	if (CompareREFIID(iid, IID_IUnknown) || CompareREFIID(iid, IID_IDeckLinkTimecode))
+		*ppv = static_cast<IDeckLinkTimecode*>(this);
+	else
+	{
+		*ppv = NULL;
+		return E_NOINTERFACE;
+	}
+
+	AddRef();
+	return S_OK;
+}
+
+ULONG FrameTimecode::AddRef(void)
+{
+	// gcc atomic operation builtin
+	return __sync_add_and_fetch(&m_refCount, 1);
+}
+
+ULONG FrameTimecode::Release(void)
+{
+	// gcc atomic operation builtin
+	ULONG newRefValue = __sync_sub_and_fetch(&m_refCount, 1);
+	if (!newRefValue)
+		delete this;
+	return newRefValue;
+}
+
+BMDTimecodeBCD FrameTimecode::GetBCD(void)
+{
+	return (ToBCD(m_hours) << 24) | (ToBCD(m_minutes) << 16) | (ToBCD(m_seconds) << 8) | ToBCD(m_frames);
+}
+
+HRESULT FrameTimecode::GetComponents(uint8_t* hours, uint8_t* minutes, uint8_t* seconds, uint8_t* frames)
+{
+	*hours		= m_hours;
+	*minutes	= m_minutes;
+	*seconds	= m_seconds;
+	*frames		= m_frames;
+	return S_OK;
+}
+
+HRESULT FrameTimecode::GetString(const char** timecode)
+{
+	char	text[16];
+
+	// The caller frees the string, as strings returned by the API
+	snprintf(text, sizeof(text), "%02u:%02u:%02u%c%02u", m_hours, m_minutes, m_seconds, (m_flags & bmdTimecodeIsDropFrame) ? ';' : ':', m_frames);
+	*timecode = strdup(text);
+
+	return (*timecode != NULL) ? S_OK : E_OUTOFMEMORY;
+}
+
+BMDTimecodeFlags FrameTimecode::GetFlags(void)
+{
+	return m_flags;
+}
+
+HRESULT FrameTimecode::GetTimecodeUserBits(BMDTimecodeUserBits* userBits)
+{
+	*userBits = 0;
+	return S_OK;
+}
+
+OutputFrame::OutputFrame(std::shared_ptr<const SharedPattern> pattern) :
+	m_pattern(pattern),
+	m_refCount(1),
+	m_timecode(new FrameTimecode()),
+	m_timecodeFormats(0)
+{
+}
+
+OutputFrame::~OutputFrame()
+{
+	m_timecode->Release();
+}
+
+void OutputFrame::SetTimecode(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames, bool dropFrame, uint32_t framesPerSecond, bool interlaced)
+{
+	BMDTimecodeFlags	flags = dropFrame ? bmdTimecodeIsDropFrame : bmdTimecodeFlagDefault;
+
+	if (interlaced)
+		m_timecodeFormats = kTimecodeVITC1 | kTimecodeVITC2;
+	else if (framesPerSecond <= kMaxVITCFramesPerSecond)
+		m_timecodeFormats = kTimecodeVITC1;
+	else
+	{
+		// The frames count of RP188 can not exceed 30, frame pairs are counted
+		m_timecodeFormats = (frames & 1) ? kTimecodeVITC2 : kTimecodeVITC1;
+		frames >>= 1;
+	}
+
+	m_timecode->SetComponents(hours, minutes, seconds, frames, flags);
+}
+
+HRESULT OutputFrame::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	if (CompareREFIID(iid, IID_IUnknown) || CompareREFIID(iid, IID_IDeckLinkVideoFrame))
+		*ppv = static_cast<IDeckLinkVideoFrame*>(this);
+	else
+	{
+		*ppv = NULL;
+		return E_NOINTERFACE;
+	}
+
+	AddRef();
+	return S_OK;
+}
+
+ULONG OutputFrame::AddRef(void)
+{
+	// gcc atomic operation builtin
+	return __sync_add_and_fetch(&m_refCount, 1);
+}
+
+ULONG OutputFrame::Release(void)
+{
+	// gcc atomic operation builtin
+	ULONG newRefValue = __sync_sub_and_fetch(&m_refCount, 1);
+	if (!newRefValue)
+		delete this;
+	return newRefValue;
+}
+
+long OutputFrame::GetWidth(void)
+{
+	return m_pattern->GetWidth();
+}
+
+long OutputFrame::GetHeight(void)
+{
+	return m_pattern->GetHeight();
+}
+
+long OutputFrame::GetRowBytes(void)
+{
+	return m_pattern->GetRowBytes();
+}
+
+BMDPixelFormat OutputFrame::GetPixelFormat(void)
+{
+	return m_pattern->GetPixelFormat();
+}
+
+BMDFrameFlags OutputFrame::GetFlags(void)
+{
+	return bmdFrameFlagDefault;
+}
+
+HRESULT OutputFrame::GetBytes(void** buffer)
+{
+	// The pattern is read-only, output only reads the frame
+	*buffer = (void*)m_pattern->GetBytes();
+	return S_OK;
+}
+
+HRESULT OutputFrame::GetTimecode(BMDTimecodeFormat format, IDeckLinkTimecode** timecode)
+{
+	uint32_t	formats = 0;
+
+	if (format == bmdTimecodeRP188VITC1)
+		formats = kTimecodeVITC1;
+	else if (format == bmdTimecodeRP188VITC2)
+		formats = kTimecodeVITC2;
+	else if (format == bmdTimecodeRP188Any)
+		formats = kTimecodeVITC1 | kTimecodeVITC2;
+
+	if ((m_timecodeFormats & formats) == 0)
+	{
+		*timecode = NULL;
+		return S_FALSE;
+	}
+
+	m_timecode->AddRef();
+	*timecode = m_timecode;
+	return S_OK;
+}
+
+HRESULT OutputFrame::GetAncillaryData(IDeckLinkVideoFrameAncillary** ancillary)
+{
+	*ancillary = NULL;
+	return S_FALSE;
+}
@@ -0,0 +1,122 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <memory>
+#include "DeckLinkAPI.h"
+#include "SharedSignals.h"
+
+// OutputFrame is a frame scheduled by an output, a few words which refer to the bytes of a shared pattern and
+// carry the RP188 timecode of the frame, so that outputs of the same pattern schedule the same read-only frame
+// without a copy.  Each output schedules its frames from a small pool, in order, and sets the timecode of a frame
+// only when it has been completed.
+//
+// RP188 timecode is set as SMPTE ST 12-2: interlaced and PsF frames have the same timecode in VITC1 and VITC2,
+// frames up to 30 fps have VITC1, and above 30 fps even frames have VITC1 and odd frames VITC2, with the frames
+// count halved.
+
+class FrameTimecode : public IDeckLinkTimecode
+{
+public:
+	FrameTimecode();
+
+	void			SetComponents(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames, BMDTimecodeFlags flags);
+
+	// IUnknown methods
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, LPVOID *ppv);
+	virtual ULONG STDMETHODCALLTYPE AddRef(void);
+	virtual ULONG STDMETHODCALLTYPE Release(void);
+
+	// IDeckLinkTimecode methods
+	virtual BMDTimecodeBCD GetBCD(void);
+	virtual HRESULT GetComponents(/* out */ uint8_t* hours, /* out */ uint8_t* minutes, /* out */ uint8_t* seconds, /* out */ uint8_t* frames);
+	virtual HRESULT GetString(/* out */ const char** timecode);
+	virtual BMDTimecodeFlags GetFlags(void);
+	virtual HRESULT GetTimecodeUserBits(/* out */ BMDTimecodeUserBits* userBits);
+
+protected:
+	virtual ~FrameTimecode() {}
+
+private:
+	int32_t				m_refCount;
+	uint8_t				m_hours;
+	uint8_t				m_minutes;
+	uint8_t				m_seconds;
+	uint8_t				m_frames;
+	BMDTimecodeFlags	m_flags;
+};
+
+class OutputFrame : public IDeckLinkVideoFrame
+{
+public:
+	explicit OutputFrame(std::shared_ptr<const SharedPattern> pattern);
+
+	// Set the timecode of the frame, with frames counted at framesPerSecond, the frame rate of the display mode
+	// rounded up
+	void			SetTimecode(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames, bool dropFrame, uint32_t framesPerSecond, bool interlaced);
+	void			ClearTimecode(void) { m_timecodeFormats = 0; }
+
+	// IUnknown methods
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, LPVOID *ppv);
+	virtual ULONG STDMETHODCALLTYPE AddRef(void);
+	virtual ULONG STDMETHODCALLTYPE Release(void);
+
+	// IDeckLinkVideoFrame methods
+	virtual long GetWidth(void);
+	virtual long GetHeight(void);
+	virtual long GetRowBytes(void);
+	virtual BMDPixelFormat GetPixelFormat(void);
+	virtual BMDFrameFlags GetFlags(void);
+	virtual HRESULT GetBytes(/* out */ void** buffer);
+
+	virtual HRESULT GetTimecode (/* in */ BMDTimecodeFormat format, /* out */ IDeckLinkTimecode** timecode);
+	virtual HRESULT GetAncillaryData (/* out */ IDeckLinkVideoFrameAncillary** ancillary);
+
+protected:
+	virtual ~OutputFrame();
+
+private:
+	std::shared_ptr<const SharedPattern>	m_pattern;
+	int32_t									m_refCount;
+
+	FrameTimecode*							m_timecode;
+	uint32_t								m_timecodeFormats;		// Bits of the RP188 formats, 1 for VITC1 and 2 for VITC2
+};
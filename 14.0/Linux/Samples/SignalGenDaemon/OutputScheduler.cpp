@@ -0,0 +1,108 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <algorithm>
+#include <chrono>
+#include "OutputScheduler.h"
+#include "GeneratorOutput.h"
+
+static const std::chrono::milliseconds	kServiceInterval(20);
+
+OutputScheduler::OutputScheduler() :
+	m_wake(false),
+	m_stop(false)
+{
+	m_thread = std::thread(&OutputScheduler::SchedulerThread, this);
+}
+
+OutputScheduler::~OutputScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_stop = true;
+	}
+	m_wakeCondition.notify_one();
+
+	m_thread.join();
+}
+
+void OutputScheduler::AddOutput(GeneratorOutput* output)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_outputsMutex);
+		m_outputs.push_back(output);
+	}
+	Wake();
+}
+
+void OutputScheduler::RemoveOutput(GeneratorOutput* output)
+{
+	std::lock_guard<std::mutex> lock(m_outputsMutex);
+	m_outputs.erase(std::remove(m_outputs.begin(), m_outputs.end(), output), m_outputs.end());
+}
+
+void OutputScheduler::Wake(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_wake = true;
+	}
+	m_wakeCondition.notify_one();
+}
+
+void OutputScheduler::SchedulerThread(void)
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_wakeMutex);
+			m_wakeCondition.wait_for(lock, kServiceInterval, [this]{ return m_wake || m_stop; });
+
+			if (m_stop)
+				break;
+
+			m_wake = false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_outputsMutex);
+		for (GeneratorOutput* output : m_outputs)
+			output->Service();
+	}
+}
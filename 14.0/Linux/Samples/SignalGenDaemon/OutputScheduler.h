@@ -0,0 +1,83 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GeneratorOutput;
+
+// OutputScheduler is a thread which schedules the video and audio of a set of outputs, so that any number of
+// outputs is driven by a few threads.  The thread services each of its outputs when woken by the frame completion
+// of one of them, and at least every 20ms, which tops up the output's scheduled frames to its preroll and its
+// buffered audio to its water level.  Completion callbacks only count the completed frame and wake the thread,
+// so they never wait for scheduling.
+//
+// An output must be removed before it is released.  AddOutput() and RemoveOutput() may be called from any thread,
+// RemoveOutput() returns when the output is no longer being serviced.
+
+class OutputScheduler
+{
+public:
+	OutputScheduler();
+	~OutputScheduler();
+
+	void						AddOutput(GeneratorOutput* output);
+	void						RemoveOutput(GeneratorOutput* output);
+
+	// Service the outputs as soon as possible
+	void						Wake(void);
+
+private:
+	std::mutex					m_outputsMutex;			// Held while the outputs are serviced
+	std::vector<GeneratorOutput*>	m_outputs;
+
+	std::mutex					m_wakeMutex;
+	std::condition_variable		m_wakeCondition;
+	bool						m_wake;
+	bool						m_stop;
+
+	std::thread					m_thread;
+
+	void						SchedulerThread(void);
+};
@@ -0,0 +1,162 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <string.h>
+#include <algorithm>
+#include "SharedSignals.h"
+#include "TextOverlay.h"
+#include "ToneGenerator.h"
+
+static const uint32_t	kAudioSampleRate		= 48000;
+
+// The ident font pixel is a 1/135 of the frame height, twice the size of burnt-in timecode, and the text is
+// centred at 2/3 of the height
+static const uint32_t	kIdentPixelsPerFrame	= 135;
+static const uint32_t	kMinIdentPixel			= 2;
+
+std::shared_ptr<const SharedPattern> SharedSignalStore::GetPattern(BMDDisplayMode displayMode, uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, TestPatternType pattern, const std::string& identText)
+{
+	std::lock_guard<std::mutex>				lock(m_mutex);
+	PatternKey								key(displayMode, pixelFormat, pattern, identText);
+	auto									entry = m_patterns.find(key);
+	std::shared_ptr<const PatternFrame>		cacheFrame;
+	std::shared_ptr<SharedPattern>			sharedPattern;
+
+	if (entry != m_patterns.end())
+		return entry->second;
+
+	cacheFrame = PatternCache::GetSharedCache().GetFrame(displayMode, width, height, pixelFormat, pattern);
+	if (cacheFrame == NULL)
+		return NULL;
+
+	sharedPattern = std::make_shared<SharedPattern>();
+	sharedPattern->m_width			= width;
+	sharedPattern->m_height			= height;
+	sharedPattern->m_pixelFormat	= pixelFormat;
+	sharedPattern->m_rowBytes		= cacheFrame->GetRowBytes();
+
+	if (identText.empty())
+	{
+		sharedPattern->m_bytes		= cacheFrame->GetBytes();
+		sharedPattern->m_cacheFrame	= cacheFrame;
+	}
+	else
+	{
+		TextOverlay		textOverlay(std::max(height / kIdentPixelsPerFrame, kMinIdentPixel));
+		uint32_t		textWidth;
+		uint32_t		textHeight;
+
+		if (!TextOverlay::IsPixelFormatSupported(pixelFormat))
+			return NULL;
+
+		sharedPattern->m_identFrame.resize((size_t)cacheFrame->GetRowBytes() * height);
+		cacheFrame->CopyTo(sharedPattern->m_identFrame.data(), cacheFrame->GetRowBytes());
+
+		textOverlay.GetTextSize(identText.c_str(), textWidth, textHeight);
+		textOverlay.DrawText(identText.c_str(), (width - std::min(textWidth, width)) / 2, (height * 2) / 3, pixelFormat,
+							 sharedPattern->m_identFrame.data(), cacheFrame->GetRowBytes(), width, height);
+
+		sharedPattern->m_bytes		= sharedPattern->m_identFrame.data();
+	}
+
+	m_patterns[key] = sharedPattern;
+	return sharedPattern;
+}
+
+std::shared_ptr<const SharedAudioLoop> SharedSignalStore::GetAudioLoop(uint32_t channels, uint32_t sampleDepth, int toneSequence, uint32_t frequency, double level)
+{
+	std::lock_guard<std::mutex>			lock(m_mutex);
+	std::shared_ptr<SharedAudioLoop>	audioLoop;
+
+	// Silence does not depend on the tone
+	AudioKey							key = (toneSequence < 0) ? AudioKey(channels, sampleDepth, -1, 0, 0.0) : AudioKey(channels, sampleDepth, toneSequence, frequency, level);
+	auto								entry = m_audioLoops.find(key);
+
+	if (entry != m_audioLoops.end())
+		return entry->second;
+
+	audioLoop = std::make_shared<SharedAudioLoop>();
+	audioLoop->channels		= channels;
+	audioLoop->sampleDepth	= sampleDepth;
+
+	if (toneSequence < 0)
+	{
+		audioLoop->sampleFrames = kAudioSampleRate;
+		audioLoop->samples.assign(audioLoop->sampleFrames * audioLoop->GetFrameBytes(), 0);
+	}
+	else
+	{
+		ToneGenerator	toneGenerator(channels, kAudioSampleRate);
+		uint32_t		cycleFrames;
+
+		if ((channels > kMaxToneChannels) || !toneGenerator.SetTone((double)frequency, level))
+			return NULL;
+
+		toneGenerator.SetSequence((ToneSequence)toneSequence);
+		cycleFrames = toneGenerator.GetCycleSampleFrames();
+
+		audioLoop->sampleFrames = ((cycleFrames + kAudioSampleRate - 1) / kAudioSampleRate) * kAudioSampleRate;
+		audioLoop->samples.resize(audioLoop->sampleFrames * audioLoop->GetFrameBytes());
+
+		// The oscillators keep running when the sequence changes, so the padding continues the tone
+		toneGenerator.Render(audioLoop->samples.data(), cycleFrames, sampleDepth);
+		toneGenerator.SetSequence(kToneSequenceContinuous);
+		toneGenerator.Render(audioLoop->samples.data() + cycleFrames * audioLoop->GetFrameBytes(), audioLoop->sampleFrames - cycleFrames, sampleDepth);
+	}
+
+	m_audioLoops[key] = audioLoop;
+	return audioLoop;
+}
+
+void SharedSignalStore::GetStatistics(size_t& patterns, size_t& patternBytes, size_t& audioLoops, size_t& audioBytes)
+{
+	std::lock_guard<std::mutex>		lock(m_mutex);
+
+	patterns		= m_patterns.size();
+	patternBytes	= 0;
+	audioLoops		= m_audioLoops.size();
+	audioBytes		= 0;
+
+	for (auto& entry : m_patterns)
+		patternBytes += entry.second->GetRowBytes() * entry.second->GetHeight();
+
+	for (auto& entry : m_audioLoops)
+		audioBytes += entry.second->samples.size();
+}
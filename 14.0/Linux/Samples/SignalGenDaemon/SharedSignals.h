@@ -0,0 +1,120 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "PatternCache.h"
+
+// SharedSignalStore holds the signals of the outputs, so that memory and rendering scale with the number of
+// distinct signals rather than the number of outputs.
+//
+// A SharedPattern is a read-only frame of a pattern, keyed by display mode, pixel format, pattern and ident text.
+// Without ident text it is the entry of the process's PatternCache.  With ident text it is a copy of the entry
+// with the text burnt in by TextOverlay, in the lower third of the frame.  Outputs schedule small frames which
+// refer to the bytes of the shared pattern, see OutputFrame.
+//
+// A SharedAudioLoop is a loop of interleaved audio, keyed by channels, sample depth, tone sequence, frequency and
+// level.  It is a whole number of seconds, a cycle of the tone sequence followed by continuous tone up to the next
+// second, so that a tone of a whole number of Hz is continuous across the end of the loop.  The channel ident
+// tail is lengthened by the padding, the other sequences are a whole number of seconds.  Outputs without tone
+// share a second of silence of their channels and depth.
+//
+// Entries are kept until the store is destroyed, so outputs may be restarted without rendering again.
+// Calls from multiple threads are serialized, entries are read-only and may be read from any thread.
+
+class SharedPattern
+{
+public:
+	uint32_t			GetWidth(void) const { return m_width; }
+	uint32_t			GetHeight(void) const { return m_height; }
+	BMDPixelFormat		GetPixelFormat(void) const { return m_pixelFormat; }
+	long				GetRowBytes(void) const { return m_rowBytes; }
+	const uint8_t*		GetBytes(void) const { return m_bytes; }
+
+private:
+	friend class SharedSignalStore;
+
+	uint32_t								m_width;
+	uint32_t								m_height;
+	BMDPixelFormat							m_pixelFormat;
+	long									m_rowBytes;
+	const uint8_t*							m_bytes;
+	std::shared_ptr<const PatternFrame>		m_cacheFrame;
+	std::vector<uint8_t>					m_identFrame;
+};
+
+struct SharedAudioLoop
+{
+	uint32_t				channels;
+	uint32_t				sampleDepth;
+	uint32_t				sampleFrames;
+	std::vector<uint8_t>	samples;
+
+	size_t					GetFrameBytes(void) const { return channels * (sampleDepth / 8); }
+};
+
+class SharedSignalStore
+{
+public:
+	// Returns the shared pattern, or NULL if the pixel format is not supported
+	std::shared_ptr<const SharedPattern>	GetPattern(BMDDisplayMode displayMode, uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, TestPatternType pattern, const std::string& identText);
+
+	// Returns the shared loop of 48kHz audio, toneSequence is a ToneSequence or -1 for silence, or NULL if the
+	// tone is not valid
+	std::shared_ptr<const SharedAudioLoop>	GetAudioLoop(uint32_t channels, uint32_t sampleDepth, int toneSequence, uint32_t frequency, double level);
+
+	// Counts and bytes of the entries
+	void									GetStatistics(size_t& patterns, size_t& patternBytes, size_t& audioLoops, size_t& audioBytes);
+
+private:
+	typedef std::tuple<BMDDisplayMode, BMDPixelFormat, TestPatternType, std::string>	PatternKey;
+	typedef std::tuple<uint32_t, uint32_t, int, uint32_t, double>						AudioKey;
+
+	std::mutex													m_mutex;
+	std::map<PatternKey, std::shared_ptr<const SharedPattern>>	m_patterns;
+	std::map<AudioKey, std::shared_ptr<const SharedAudioLoop>>	m_audioLoops;
+};
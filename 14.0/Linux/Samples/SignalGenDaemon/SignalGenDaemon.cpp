@@ -0,0 +1,248 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Config.h"
+#include "GeneratorOutput.h"
+#include "OutputScheduler.h"
+#include "SharedSignals.h"
+
+pthread_mutex_t			sleepMutex;
+pthread_cond_t			sleepCond;
+bool					do_exit = false;
+bool					do_restart = false;
+
+void sigfunc(int signum)
+{
+	if (signum == SIGINT || signum == SIGTERM)
+		do_exit = true;
+	else if (signum == SIGHUP)
+		do_restart = true;
+
+	pthread_cond_signal(&sleepCond);
+}
+
+static const char* GetStateName(OutputState state)
+{
+	switch (state)
+	{
+		case kOutputStopped:
+			return "stopped";
+		case kOutputRunning:
+			return "running";
+		case kOutputFailed:
+			return "failed";
+	}
+	return "unknown";
+}
+
+// Write the status of the shared signals and each output, to the status file or stdout.  The file is replaced
+// with rename() so that readers never see a partial status.
+static void WriteStatus(const BMDConfig& config, SharedSignalStore& store, const std::vector<GeneratorOutput*>& outputs, time_t startTime)
+{
+	std::string		temporaryPath	= config.m_statusFile + ".tmp";
+	FILE*			file			= stdout;
+	size_t			patterns;
+	size_t			patternBytes;
+	size_t			audioLoops;
+	size_t			audioBytes;
+	unsigned		running			= 0;
+
+	if (!config.m_statusFile.empty())
+	{
+		file = fopen(temporaryPath.c_str(), "w");
+		if (file == NULL)
+		{
+			fprintf(stderr, "Could not write the status file %s: %s\n", temporaryPath.c_str(), strerror(errno));
+			return;
+		}
+	}
+
+	for (GeneratorOutput* output : outputs)
+	{
+		if (output->GetState() == kOutputRunning)
+			running++;
+	}
+
+	store.GetStatistics(patterns, patternBytes, audioLoops, audioBytes);
+
+	fprintf(file, "SignalGenDaemon: %zu outputs, %u running, up %ld s\n", outputs.size(), running, (long)(time(NULL) - startTime));
+	fprintf(file, "Shared: %zu patterns of %.1f MB, %zu audio loops of %.1f MB, %u scheduler threads\n",
+			patterns, patternBytes / 1048576.0, audioLoops, audioBytes / 1048576.0, config.m_schedulerThreads);
+
+	for (size_t i = 0; i < outputs.size(); i++)
+	{
+		OutputStatus	status;
+
+		outputs[i]->GetStatus(status);
+
+		fprintf(file, "Output %zu: %s, %s, %s", i,
+				status.deviceName.empty() ? "-" : status.deviceName.c_str(),
+				status.displayModeName.empty() ? "-" : status.displayModeName.c_str(),
+				GetStateName(status.state));
+
+		if (status.state == kOutputFailed)
+			fprintf(file, ": %s", status.error.c_str());
+
+		fprintf(file, ", TC %s, %llu frames scheduled, %llu completed, %llu late, %llu dropped, %llu flushed, %u audio samples buffered\n",
+				(status.timecode[0] != '\0') ? status.timecode : "--:--:--:--",
+				(unsigned long long)status.framesScheduled,
+				(unsigned long long)status.framesCompleted,
+				(unsigned long long)status.framesLate,
+				(unsigned long long)status.framesDropped,
+				(unsigned long long)status.framesFlushed,
+				status.bufferedAudioFrames);
+	}
+
+	if (file == stdout)
+	{
+		fprintf(file, "\n");
+		fflush(file);
+	}
+	else
+	{
+		fclose(file);
+		if (rename(temporaryPath.c_str(), config.m_statusFile.c_str()) != 0)
+			fprintf(stderr, "Could not replace the status file %s: %s\n", config.m_statusFile.c_str(), strerror(errno));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int											exitStatus = 1;
+	BMDConfig									config;
+	SharedSignalStore							store;
+	std::vector<std::unique_ptr<OutputScheduler>>	schedulers;
+	std::vector<GeneratorOutput*>				outputs;
+	unsigned									running = 0;
+	time_t										startTime = time(NULL);
+
+	pthread_mutex_init(&sleepMutex, NULL);
+	pthread_cond_init(&sleepCond, NULL);
+
+	signal(SIGINT, sigfunc);
+	signal(SIGTERM, sigfunc);
+	signal(SIGHUP, sigfunc);
+
+	if (!config.ParseArguments(argc, argv))
+		config.DisplayUsage(exitStatus);
+
+	config.DisplayConfiguration();
+
+	PatternCache::GetSharedCache().SetDirectory(config.m_patternCacheDirectory.c_str());
+
+	// Outputs are shared round-robin by the scheduler threads
+	for (unsigned i = 0; i < std::min((size_t)config.m_schedulerThreads, config.m_outputs.size()); i++)
+		schedulers.emplace_back(new OutputScheduler());
+
+	for (size_t i = 0; i < config.m_outputs.size(); i++)
+	{
+		GeneratorOutput*	output = new GeneratorOutput(config.m_outputs[i], store, schedulers[i % schedulers.size()].get());
+
+		if (output->Start())
+			running++;
+		else
+			output->Stop();
+
+		outputs.push_back(output);
+	}
+
+	if (running == 0)
+	{
+		fprintf(stderr, "No outputs started\n");
+		goto bail;
+	}
+
+	fprintf(stderr, "Started %u of %zu outputs\n", running, outputs.size());
+
+	while (!do_exit)
+	{
+		struct timespec		wakeTime;
+
+		WriteStatus(config, store, outputs, startTime);
+
+		clock_gettime(CLOCK_REALTIME, &wakeTime);
+		wakeTime.tv_sec += config.m_statusInterval;
+
+		pthread_mutex_lock(&sleepMutex);
+		pthread_cond_timedwait(&sleepCond, &sleepMutex, &wakeTime);
+		pthread_mutex_unlock(&sleepMutex);
+
+		// SIGHUP restarts the outputs which have failed
+		if (do_restart && !do_exit)
+		{
+			do_restart = false;
+
+			for (GeneratorOutput* output : outputs)
+			{
+				if (output->GetState() != kOutputFailed)
+					continue;
+
+				output->Stop();
+				if (!output->Start())
+					output->Stop();
+			}
+		}
+	}
+
+	fprintf(stderr, "Stopping outputs\n");
+
+	exitStatus = 0;
+
+bail:
+	for (GeneratorOutput* output : outputs)
+	{
+		output->Stop();
+		output->Release();
+	}
+
+	return exitStatus;
+}
@@ -41,12 +41,14 @@
 //
 
 #include "stdint.h"
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <functional>
 #include <utility>
 #include <vector>
 #include "ColorBars.h"
+#include "VideoKernels.h"
 
 struct Color12BitRGB
 {
@@ -60,6 +62,8 @@ typedef std::vector<std::pair<EOTFColorArray, uint32_t>> ColorBarsPattern;
 
 static void FillLineBars(ColorBarsPattern& pattern, EOTFColorRange range, std::vector<Color12BitRGB>& lineBuffer);
 static void FillLineRamp(ColorBarsPattern& pattern, EOTFColorRange range, std::vector<Color12BitRGB>& lineBuffer);
+static void WriteLine(const std::vector<Color12BitRGB>& line, uint32_t width, EOTFColorRange range, uint32_t* row,
+					  std::vector<uint16_t>& redLine, std::vector<uint16_t>& greenLine, std::vector<uint16_t>& blueLine);
 
 
 // Refer to BT.2111 specification
@@ -234,13 +238,21 @@ static const std::vector<std::tuple<std::function<void(EOTFColorRange, std::vect
 static const uint32_t kHD1080Width	= 1920;
 static const uint32_t kHD1080Height	= 1080;
 
-void FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EOTFColorRange range)
+// The moving box is drawn over the middle of the 75% bars pattern, HD size
+static const size_t   kMovingBoxPattern	= 1;
+static const uint32_t kMovingBoxSize	= 180;
+
+void FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EOTFColorRange range, uint32_t movingFrame, uint32_t movingFrameCount)
 {
 	uint32_t*	nextWord;
 	uint32_t	width;
 	uint32_t	height;
 	uint32_t	rowBytes;
 	std::vector<Color12BitRGB> colorBarsLine;
+	std::vector<uint16_t> redLine;
+	std::vector<uint16_t> greenLine;
+	std::vector<uint16_t> blueLine;
+	std::vector<Color12BitRGB> movingBoxLine;
 
 	colorBarsFrame->GetBytes((void**)&nextWord);
 	width = colorBarsFrame->GetWidth();
@@ -249,9 +261,19 @@ void FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EO
 
 	colorBarsLine.reserve(width);
 
+	if (range == EOTFColorRange::PQFullRange)
+	{
+		redLine.resize(width);
+		greenLine.resize(width);
+		blueLine.resize(width);
+	}
+
 	for (auto& iter : kColorBarPatternsNarrow)
 	{
 		uint32_t* refLine = nextWord;
+		uint32_t* movingBoxRow = nullptr;
+		uint32_t movingBoxTop = 0;
+		uint32_t movingBoxHeight = 0;
 
 		// Scale pattern for UHD frame height
 		uint32_t patternHeight = std::get<kColorBarsPatternHeight>(iter) * (height / kHD1080Height);
@@ -267,38 +289,39 @@ void FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EO
 		for (uint32_t i = 0; i < padWidth; i++)
 			colorBarsLine.push_back(k40pcGrey[(int)range]);
 
+		if ((movingFrameCount > 0) && (&iter == &kColorBarPatternsNarrow[kMovingBoxPattern]))
+		{
+			// Box scaled as the bars, stepping from the left edge towards the right edge
+			uint32_t movingBoxWidth = std::min(kMovingBoxSize * (width / kHD1080Width), width);
+			uint32_t movingBoxLeft = (width - movingBoxWidth) * (movingFrame % movingFrameCount) / movingFrameCount;
+
+			movingBoxHeight = std::min(kMovingBoxSize * (height / kHD1080Height), patternHeight);
+			movingBoxTop = (patternHeight - movingBoxHeight) / 2;
+
+			movingBoxLine = colorBarsLine;
+			for (uint32_t i = movingBoxLeft; i < movingBoxLeft + movingBoxWidth; i++)
+				movingBoxLine[i] = k100pcWhite[(int)range];
+		}
+
 		for (uint32_t j = 0; j < patternHeight; j++)
 		{
 			uint8_t* lineStart = (uint8_t*)nextWord;
 
 			if (j == 0)
 			{
-				if (range == EOTFColorRange::PQFullRange)
+				WriteLine(colorBarsLine, width, range, nextWord, redLine, greenLine, blueLine);
+			}
+			else if ((j >= movingBoxTop) && (j < movingBoxTop + movingBoxHeight))
+			{
+				// The first line of the box is written, the following lines are copied from it
+				if (movingBoxRow == nullptr)
 				{
-					// Write out data in full-range 12-bit RGB
-					for (uint32_t i = 0; i < width; i += 8)
-					{
-						// Refer to DeckLink SDK Manual, section 2.7.4 for packing structure
-						*nextWord++ = ((colorBarsLine[i].Blue & 0x0FF) << 24) | ((colorBarsLine[i].Green & 0xFFF) << 12) | (colorBarsLine[i].Red & 0xFFF);
-						*nextWord++ = ((colorBarsLine[i + 1].Blue & 0x00F) << 28) | ((colorBarsLine[i + 1].Green & 0xFFF) << 16) | ((colorBarsLine[i + 1].Red & 0xFFF) << 4) | ((colorBarsLine[i].Blue & 0xF00) >> 8);
-						*nextWord++ = ((colorBarsLine[i + 2].Green & 0xFFF) << 20) | ((colorBarsLine[i + 2].Red & 0xFFF) << 8) | ((colorBarsLine[i + 1].Blue & 0xFF0) >> 4);
-						*nextWord++ = ((colorBarsLine[i + 3].Green & 0x0FF) << 24) | ((colorBarsLine[i + 3].Red & 0xFFF) << 12) | (colorBarsLine[i + 2].Blue & 0xFFF);
-						*nextWord++ = ((colorBarsLine[i + 4].Green & 0x00F) << 28) | ((colorBarsLine[i + 4].Red & 0xFFF) << 16) | ((colorBarsLine[i + 3].Blue & 0xFFF) << 4) | ((colorBarsLine[i + 3].Green & 0xF00) >> 8);
-						*nextWord++ = ((colorBarsLine[i + 5].Red & 0xFFF) << 20) | ((colorBarsLine[i + 4].Blue & 0xFFF) << 8) | ((colorBarsLine[i + 4].Green & 0xFF0) >> 4);
-						*nextWord++ = ((colorBarsLine[i + 6].Red & 0x0FF) << 24) | ((colorBarsLine[i + 5].Blue & 0xFFF) << 12) | (colorBarsLine[i + 5].Green & 0xFFF);
-						*nextWord++ = ((colorBarsLine[i + 7].Red & 0x00F) << 28) | ((colorBarsLine[i + 6].Blue & 0xFFF) << 16) | ((colorBarsLine[i + 6].Green & 0xFFF) << 4) | ((colorBarsLine[i + 6].Red & 0xF00) >> 8);
-						*nextWord++ = ((colorBarsLine[i + 7].Blue & 0xFFF) << 20) | ((colorBarsLine[i + 7].Green & 0xFFF) << 8) | ((colorBarsLine[i + 7].Red & 0xFF0) >> 4);
-					}
+					WriteLine(movingBoxLine, width, range, nextWord, redLine, greenLine, blueLine);
+					movingBoxRow = nextWord;
 				}
 				else
 				{
-					// Write out data with video-range r210
-					for (uint32_t i = 0; i < width; i++)
-					{
-						// Refer to DeckLink SDK Manual, section 2.7.4 for packing structure
-						*nextWord++ = ((colorBarsLine[i].Blue & 0x3FC) << 22) | ((colorBarsLine[i].Green & 0x0FC) << 16) | ((colorBarsLine[i].Blue & 0xC00) << 6)
-										| ((colorBarsLine[i].Red & 0x03C) << 10) | (colorBarsLine[i].Green & 0xF00) | ((colorBarsLine[i].Red & 0xFC0) >> 6);
-					}
+					std::memcpy(nextWord, movingBoxRow, rowBytes);
 				}
 			}
 			else
@@ -312,6 +335,33 @@ void FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EO
 	}
 }
 
+void WriteLine(const std::vector<Color12BitRGB>& line, uint32_t width, EOTFColorRange range, uint32_t* row,
+			   std::vector<uint16_t>& redLine, std::vector<uint16_t>& greenLine, std::vector<uint16_t>& blueLine)
+{
+	if (range == EOTFColorRange::PQFullRange)
+	{
+		// Write out data in full-range 12-bit RGB, refer to DeckLink SDK Manual, section 2.7.4 for packing structure
+		for (uint32_t i = 0; i < width; i++)
+		{
+			redLine[i]		= line[i].Red;
+			greenLine[i]	= line[i].Green;
+			blueLine[i]		= line[i].Blue;
+		}
+
+		PackR12Row(redLine.data(), greenLine.data(), blueLine.data(), row, width, false);
+	}
+	else
+	{
+		// Write out data with video-range r210
+		for (uint32_t i = 0; i < width; i++)
+		{
+			// Refer to DeckLink SDK Manual, section 2.7.4 for packing structure
+			*row++ = ((line[i].Blue & 0x3FC) << 22) | ((line[i].Green & 0x0FC) << 16) | ((line[i].Blue & 0xC00) << 6)
+						| ((line[i].Red & 0x03C) << 10) | (line[i].Green & 0xF00) | ((line[i].Red & 0xFC0) >> 6);
+		}
+	}
+}
+
 void FillLineBars(ColorBarsPattern& pattern, EOTFColorRange colorRange, std::vector<Color12BitRGB>& lineBuffer)
 {
 	for (auto& iter : pattern)
@@ -47,4 +47,6 @@
 
 enum class EOTFColorRange { HLGVideoRange = 0, PQVideoRange, PQFullRange, Size };
 
-void	FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EOTFColorRange range);
+// Fill a frame with BT.2111 colour bars.  Frames of moving content add a 100% white box over the 75% bars, which
+// steps across the frame to position movingFrame of movingFrameCount.  A movingFrameCount of 0 has no box.
+void	FillBT2111ColorBars(com_ptr<IDeckLinkMutableVideoFrame>& colorBarsFrame, EOTFColorRange range, uint32_t movingFrame = 0, uint32_t movingFrameCount = 0);
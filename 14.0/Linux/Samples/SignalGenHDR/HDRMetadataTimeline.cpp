@@ -0,0 +1,240 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include "HDRMetadataTimeline.h"
+
+static const size_t		kMaxScriptLineLength	= 256;
+
+// Field names of scripts, in order of HDRMetadataField
+static const char* const	kFieldNames[kHDRMetadataFieldCount] = { "eotf", "maxdml", "mindml", "maxcll", "maxfall" };
+
+// EOTF names of scripts, in order of their CTA-861 codes, as EOTF of SignalGenHDR.h
+static const char* const	kEOTFNames[] = { "sdr", "hdr", "pq", "hlg" };
+
+// EOTF codes of the built-in EOTF switch
+static const double		kEOTFPQ					= 2.0;
+static const double		kEOTFHLG				= 3.0;
+
+HDRMetadataTimeline::HDRMetadataTimeline() :
+	m_loopLength(0)
+{
+}
+
+void HDRMetadataTimeline::Clear(void)
+{
+	for (auto& keyPoints : m_keyPoints)
+		keyPoints.clear();
+
+	m_loopLength = 0;
+}
+
+bool HDRMetadataTimeline::IsEmpty(void) const
+{
+	for (auto& keyPoints : m_keyPoints)
+	{
+		if (!keyPoints.empty())
+			return false;
+	}
+
+	return true;
+}
+
+bool HDRMetadataTimeline::AddKeyPoint(HDRMetadataField field, uint64_t frame, double value, bool ramp)
+{
+	std::vector<KeyPoint>&	keyPoints = m_keyPoints[field];
+
+	if ((ramp && (field == kHDRMetadataEOTF)) || (!keyPoints.empty() && (frame < keyPoints.back().frame)))
+		return false;
+
+	keyPoints.push_back({ frame, value, ramp });
+	return true;
+}
+
+void HDRMetadataTimeline::SetSequence(HDRMetadataSequence sequence, uint32_t framesPerSecond)
+{
+	const uint64_t	seconds = framesPerSecond;
+
+	Clear();
+
+	switch (sequence)
+	{
+		case kHDRSequenceMaxCLLRamp:
+			AddKeyPoint(kHDRMetadataMaxCLL, 0, 100.0, false);
+			AddKeyPoint(kHDRMetadataMaxCLL, 4 * seconds, 4000.0, true);
+			AddKeyPoint(kHDRMetadataMaxCLL, 8 * seconds, 100.0, true);
+			SetLoopLength(8 * seconds);
+			break;
+
+		case kHDRSequenceMaxFALLRamp:
+			AddKeyPoint(kHDRMetadataMaxFALL, 0, 10.0, false);
+			AddKeyPoint(kHDRMetadataMaxFALL, 4 * seconds, 1000.0, true);
+			AddKeyPoint(kHDRMetadataMaxFALL, 8 * seconds, 10.0, true);
+			SetLoopLength(8 * seconds);
+			break;
+
+		case kHDRSequenceEOTFSwitch:
+			AddKeyPoint(kHDRMetadataEOTF, 0, kEOTFPQ, false);
+			AddKeyPoint(kHDRMetadataEOTF, 2 * seconds, kEOTFHLG, false);
+			SetLoopLength(4 * seconds);
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool HDRMetadataTimeline::LoadScript(const char* path, int* errorLine)
+{
+	FILE*	file		= fopen(path, "r");
+	char	line[kMaxScriptLineLength];
+	int		lineNumber	= 0;
+	bool	valid		= (file != NULL);
+
+	Clear();
+
+	while (valid && (fgets(line, sizeof(line), file) != NULL))
+	{
+		char				frameText[32];
+		char				fieldText[32];
+		char				valueText[32];
+		char				rampText[32];
+		char*				comment	= strchr(line, '#');
+		int					count;
+		unsigned long long	frame;
+		int					field;
+		double				value;
+
+		lineNumber++;
+
+		if (comment != NULL)
+			*comment = '\0';
+
+		count = sscanf(line, "%31s %31s %31s %31s", frameText, fieldText, valueText, rampText);
+		if (count <= 0)
+			continue;
+
+		if (strcasecmp(frameText, "loop") == 0)
+		{
+			valid = (count == 2) && (sscanf(fieldText, "%llu", &frame) == 1);
+			m_loopLength = frame;
+			continue;
+		}
+
+		valid = (count >= 3) && (sscanf(frameText, "%llu", &frame) == 1) && ((count == 3) || (strcasecmp(rampText, "ramp") == 0));
+
+		for (field = 0; valid && (field < kHDRMetadataFieldCount); field++)
+		{
+			if (strcasecmp(fieldText, kFieldNames[field]) == 0)
+				break;
+		}
+
+		if (!valid || (field == kHDRMetadataFieldCount))
+		{
+			valid = false;
+			break;
+		}
+
+		if (field == kHDRMetadataEOTF)
+		{
+			valid = false;
+			for (size_t i = 0; i < sizeof(kEOTFNames) / sizeof(kEOTFNames[0]); i++)
+			{
+				if (strcasecmp(valueText, kEOTFNames[i]) == 0)
+				{
+					value = (double)i;
+					valid = true;
+				}
+			}
+		}
+		else
+		{
+			valid = (sscanf(valueText, "%lf", &value) == 1) && (value >= 0.0);
+		}
+
+		valid = valid && AddKeyPoint((HDRMetadataField)field, frame, value, count == 4);
+	}
+
+	if (file != NULL)
+		fclose(file);
+
+	if (!valid)
+	{
+		Clear();
+		if (errorLine != NULL)
+			*errorLine = lineNumber;
+	}
+
+	return valid;
+}
+
+void HDRMetadataTimeline::GetMetadata(uint64_t frame, const HDRMetadata& base, HDRMetadata& metadata) const
+{
+	if (m_loopLength != 0)
+		frame %= m_loopLength;
+
+	metadata								= base;
+	metadata.EOTF							= (int64_t)GetValue(kHDRMetadataEOTF, frame, (double)base.EOTF);
+	metadata.maxDisplayMasteringLuminance	= GetValue(kHDRMetadataMaxDisplayMasteringLuminance, frame, base.maxDisplayMasteringLuminance);
+	metadata.minDisplayMasteringLuminance	= GetValue(kHDRMetadataMinDisplayMasteringLuminance, frame, base.minDisplayMasteringLuminance);
+	metadata.maxCLL							= GetValue(kHDRMetadataMaxCLL, frame, base.maxCLL);
+	metadata.maxFALL						= GetValue(kHDRMetadataMaxFALL, frame, base.maxFALL);
+}
+
+double HDRMetadataTimeline::GetValue(HDRMetadataField field, uint64_t frame, double baseValue) const
+{
+	const std::vector<KeyPoint>&	keyPoints	= m_keyPoints[field];
+	auto							next		= std::upper_bound(keyPoints.begin(), keyPoints.end(), frame,
+																	[](uint64_t f, const KeyPoint& keyPoint) { return f < keyPoint.frame; });
+
+	if (next == keyPoints.begin())
+		return baseValue;
+
+	auto	last = next - 1;
+
+	if ((next == keyPoints.end()) || !next->ramp)
+		return last->value;
+
+	// Ramp from the last key point to the next, the frames of the key points are different
+	return last->value + (next->value - last->value) * (double)(frame - last->frame) / (double)(next->frame - last->frame);
+}
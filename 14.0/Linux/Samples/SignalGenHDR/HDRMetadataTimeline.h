@@ -0,0 +1,125 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "HDRVideoFrame.h"
+
+// HDRMetadataTimeline scripts the HDR metadata of each frame of scheduled output, to test the tone mapping of a
+// display or converter as the metadata changes.  Each field of the metadata has its own key points, at frame
+// numbers counted from the start of playback.  A key point holds its value until the next key point of the field,
+// or is reached by a linear ramp from the previous key point when it is a ramp.  The timeline repeats after its
+// loop length.  Fields without key points, and every field before its first key point, keep the metadata of the
+// controls.
+//
+// Scripts are text, a key point on each line, and '#' starts a comment:
+//
+//     # frame  field    value  [ramp]
+//     0        maxcll   100
+//     240      maxcll   4000   ramp
+//     480      eotf     hlg
+//     loop     720
+//
+// The fields are eotf (sdr, hdr, pq or hlg), maxdml and mindml, the maximum and minimum display mastering
+// luminance, maxcll and maxfall, luminances in cd/m2.  The EOTF switches at its key points and can not ramp.
+//
+// Key points are added before playback, and GetMetadata() only reads the timeline, so a timeline which is not
+// changed while it is read may be read from any thread.
+
+enum HDRMetadataField
+{
+	kHDRMetadataEOTF = 0,
+	kHDRMetadataMaxDisplayMasteringLuminance,
+	kHDRMetadataMinDisplayMasteringLuminance,
+	kHDRMetadataMaxCLL,
+	kHDRMetadataMaxFALL,
+	kHDRMetadataFieldCount
+};
+
+enum HDRMetadataSequence
+{
+	kHDRSequenceStatic = 0,			// No key points, the metadata of the controls
+	kHDRSequenceMaxCLLRamp,			// MaxCLL ramps from 100 to 4000 cd/m2 and back, over 8 seconds
+	kHDRSequenceMaxFALLRamp,		// MaxFALL ramps from 10 to 1000 cd/m2 and back, over 8 seconds
+	kHDRSequenceEOTFSwitch,			// PQ and HLG alternate every 2 seconds
+	kHDRSequenceCount
+};
+
+class HDRMetadataTimeline
+{
+public:
+	HDRMetadataTimeline();
+
+	void			Clear(void);
+	bool			IsEmpty(void) const;
+	bool			HasKeyPoints(HDRMetadataField field) const { return !m_keyPoints[field].empty(); }
+
+	// Add a key point of a field, in order of frame for the field.  Returns false if the frame is before the last
+	// key point of the field, or for a ramp of the EOTF.
+	bool			AddKeyPoint(HDRMetadataField field, uint64_t frame, double value, bool ramp);
+
+	// Repeat the timeline every loopLength frames, or 0 to hold the last key points
+	void			SetLoopLength(uint64_t loopLength) { m_loopLength = loopLength; }
+
+	// Replace the timeline with a built-in sequence, at framesPerSecond
+	void			SetSequence(HDRMetadataSequence sequence, uint32_t framesPerSecond);
+
+	// Replace the timeline with a script, see above.  Returns false and the number of the first line which is not
+	// valid if the script can not be read, which leaves the timeline empty.
+	bool			LoadScript(const char* path, int* errorLine);
+
+	// Metadata of frame, from base and the key points of the timeline
+	void			GetMetadata(uint64_t frame, const HDRMetadata& base, HDRMetadata& metadata) const;
+
+private:
+	struct KeyPoint
+	{
+		uint64_t	frame;
+		double		value;
+		bool		ramp;
+	};
+
+	std::vector<KeyPoint>	m_keyPoints[kHDRMetadataFieldCount];
+	uint64_t				m_loopLength;
+
+	double					GetValue(HDRMetadataField field, uint64_t frame, double baseValue) const;
+};
@@ -98,6 +98,11 @@ public:
 
 	void UpdateHDRMetadata(const HDRMetadata& metadata) { m_metadata = metadata; }
 
+	// The frame of the image, which may be shared by frames with different metadata.  The image of a frame is
+	// only replaced while the frame is not scheduled.
+	com_ptr<IDeckLinkMutableVideoFrame> GetVideoFrame(void) const { return m_videoFrame; }
+	void SetVideoFrame(const com_ptr<IDeckLinkMutableVideoFrame>& frame) { m_videoFrame = frame; }
+
 private:
 	com_ptr<IDeckLinkMutableVideoFrame>	m_videoFrame;
 	HDRMetadata							m_metadata;
@@ -39,6 +39,7 @@
 */
 
 
+#include <QFileDialog>
 #include <QMessageBox>
 #include <QStandardItemModel>
 #include <QStandardItem>
@@ -58,6 +59,15 @@ static const double kDefaultMinDisplayMasteringLuminance	= 0.0001;
 static const double kDefaultMaxCLL							= 1000.0;
 static const double kDefaultMaxFALL							= 50.0;
 
+// Frames scheduled ahead of output, and frames of the pool.  The pool has more frames than are scheduled ahead, so
+// the metadata of a frame is only changed after it has been output.
+static const uint32_t kPrerollFrames	= 4;
+static const uint32_t kFramePoolSize	= 8;
+
+// Frames of moving content rendered for each EOTF, the moving box steps across the bars in this many frames.  The
+// frames are full size, so the rendered frames are a multiple of this for 8K modes.
+static const uint32_t kMovingFrameCount	= 8;
+
 // Supported pixel formats map to string representation and boolean if RGB format
 static const std::map<BMDPixelFormat, std::pair<QString, bool>> kPixelFormats = {
 	std::make_pair(bmdFormat10BitYUV,	std::make_pair(QString("10-bit YUV (Video-range)"), false)),
@@ -71,6 +81,16 @@ static const std::vector<std::pair<EOTF, QString>> kSupportedEOTF = {
 	std::make_pair(EOTF::HLG,	QString("HLG")),
 };
 
+// Metadata sequences, in order of HDRMetadataSequence, then a script loaded from a file
+static const std::vector<QString> kMetadataSequenceNames = {
+	QString("Static"),
+	QString("MaxCLL ramp"),
+	QString("MaxFALL ramp"),
+	QString("PQ/HLG switch"),
+	QString("Script..."),
+};
+static const int kMetadataScriptIndex = kHDRSequenceCount;
+
 static int GetBytesPerRow(BMDPixelFormat pixelFormat, ULONG frameWidth)
 {
 	int bytesPerRow;
@@ -101,7 +121,12 @@ static int GetBytesPerRow(BMDPixelFormat pixelFormat, ULONG frameWidth)
 SignalGenHDR::SignalGenHDR(QWidget *parent) :
 	QDialog(parent),
 	ui(new Ui::SignalGenHDR),
-	m_running(false)
+	m_running(false),
+	m_selectedMetadataSequence(kHDRSequenceStatic),
+	m_scheduling(false),
+	m_totalFramesScheduled(0),
+	m_frameDuration(0),
+	m_frameTimescale(0)
 {
 	ui->setupUi(this);
 
@@ -119,6 +144,7 @@ SignalGenHDR::SignalGenHDR(QWidget *parent) :
 	connect(ui->videoFormatComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(VideoFormatChanged(int)));
 	connect(ui->pixelFormatComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(PixelFormatChanged(int)));
 	connect(ui->eotfComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(EOTFChanged(int)));
+	connect(ui->metadataSequenceComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(MetadataSequenceChanged(int)));
 
 	connect(ui->displayPrimaryRedXSlider, SIGNAL(valueChanged(int)), this, SLOT(DisplayPrimaryRedXSliderChanged(int)));
 	connect(ui->displayPrimaryRedYSlider, SIGNAL(valueChanged(int)), this, SLOT(DisplayPrimaryRedYSliderChanged(int)));
@@ -153,6 +179,11 @@ SignalGenHDR::SignalGenHDR(QWidget *parent) :
 	ui->maxCLLSlider->setSliderPosition((int)(std::log10(m_selectedHDRParameters.maxCLL) * 10000));
 	ui->maxFALLSlider->setSliderPosition((int)(std::log10(m_selectedHDRParameters.maxFALL) * 10000));
 
+	for (auto& sequenceName : kMetadataSequenceNames)
+		ui->metadataSequenceComboBox->addItem(sequenceName);
+
+	m_outputCallback = make_com_ptr<DeckLinkOutputCallback>(this);
+
 	// Disable interface on load
 	EnableInterface(false);
 	EnableHDRInterface(false);
@@ -241,11 +272,53 @@ void SignalGenHDR::StartRunning()
 	if (m_selectedDeckLinkOutput->EnableVideoOutput(m_selectedDisplayMode->GetDisplayMode(), bmdVideoOutputFlagDefault) != S_OK)
 		goto bail;
 
-	m_videoFrameBars = CreateColorbarsFrame();
-	if (!m_videoFrameBars)
+	m_selectedDisplayMode->GetFrameRate(&m_frameDuration, &m_frameTimescale);
+
+	// A script is loaded when it is selected, the built-in sequences count the frames of the selected mode
+	if (m_selectedMetadataSequence != kMetadataScriptIndex)
+		m_metadataTimeline.SetSequence((HDRMetadataSequence)m_selectedMetadataSequence, (uint32_t)((m_frameTimescale + m_frameDuration - 1) / m_frameDuration));
+
+	// The colour bars are rendered once, for the EOTF of the controls, and for the other EOTF when the timeline
+	// switches EOTF.  There are no full range HLG bars, so 12-bit RGB only has PQ bars.  The frames of the pool only
+	// attach an image and metadata.
+	{
+		std::vector<EOTF> barsEOTFs = { (m_selectedHDRParameters.EOTF == static_cast<int64_t>(EOTF::HLG)) ? EOTF::HLG : EOTF::PQ };
+
+		if (m_metadataTimeline.HasKeyPoints(kHDRMetadataEOTF) && (m_selectedPixelFormat != bmdFormat12BitRGBLE))
+			barsEOTFs.push_back((barsEOTFs[0] == EOTF::HLG) ? EOTF::PQ : EOTF::HLG);
+
+		m_barsFrames.clear();
+		for (EOTF eotf : barsEOTFs)
+		{
+			for (uint32_t movingFrame = 0; movingFrame < kMovingFrameCount; movingFrame++)
+			{
+				com_ptr<IDeckLinkMutableVideoFrame> barsFrame = CreateColorbarsFrame(eotf, movingFrame);
+				if (!barsFrame)
+					goto bail;
+
+				m_barsFrames[eotf].push_back(barsFrame);
+			}
+		}
+	}
+
+	m_framePool.clear();
+	for (uint32_t i = 0; i < kFramePoolSize; i++)
+		m_framePool.push_back(make_com_ptr<HDRVideoFrame>(m_barsFrames.begin()->second.front(), m_selectedHDRParameters));
+
+	if (m_selectedDeckLinkOutput->SetScheduledFrameCompletionCallback(m_outputCallback.get()) != S_OK)
 		goto bail;
 
-	if (m_selectedDeckLinkOutput->DisplayVideoFrameSync(m_videoFrameBars.get()) != S_OK)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_outputHDRParameters	= m_selectedHDRParameters;
+		m_totalFramesScheduled	= 0;
+		m_scheduling			= true;
+	}
+
+	for (uint32_t i = 0; i < kPrerollFrames; i++)
+		ScheduleNextFrame();
+
+	if (m_selectedDeckLinkOutput->StartScheduledPlayback(0, m_frameTimescale, 1.0) != S_OK)
 		goto bail;
 
 	// Success, update the UI
@@ -264,7 +337,17 @@ bail:
 
 void SignalGenHDR::StopRunning()
 {
+	{
+		// No frame is scheduled after this, so the pool can be released
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_scheduling = false;
+	}
+
+	m_selectedDeckLinkOutput->StopScheduledPlayback(0, nullptr, 0);
+	m_selectedDeckLinkOutput->SetScheduledFrameCompletionCallback(nullptr);
 	m_selectedDeckLinkOutput->DisableVideoOutput();
+	m_framePool.clear();
+	m_barsFrames.clear();
 
 	// Update UI
 	m_running = false;
@@ -373,6 +456,13 @@ void SignalGenHDR::RefreshEOTFMenu(void)
 	}
 
 	ui->eotfComboBox->setCurrentIndex(0);
+
+	// Nor is the switch to HLG
+	QStandardItemModel* model = qobject_cast<QStandardItemModel*>(ui->metadataSequenceComboBox->model());
+	model->item(kHDRSequenceEOTFSwitch)->setEnabled(m_selectedPixelFormat != bmdFormat12BitRGBLE);
+
+	if ((m_selectedPixelFormat == bmdFormat12BitRGBLE) && (ui->metadataSequenceComboBox->currentIndex() == kHDRSequenceEOTFSwitch))
+		ui->metadataSequenceComboBox->setCurrentIndex(kHDRSequenceStatic);
 }
 
 void SignalGenHDR::AddDevice(com_ptr<IDeckLink> deckLink)
@@ -536,6 +626,32 @@ void SignalGenHDR::EOTFChanged(int selectedEOTFIndex)
 	UpdateOutputFrame();
 }
 
+void SignalGenHDR::MetadataSequenceChanged(int selectedSequenceIndex)
+{
+	QString		scriptPath;
+	int			errorLine = 0;
+
+	if (selectedSequenceIndex == -1)
+		return;
+
+	m_selectedMetadataSequence = selectedSequenceIndex;
+
+	if (selectedSequenceIndex != kMetadataScriptIndex)
+		return;
+
+	scriptPath = QFileDialog::getOpenFileName(this, "Open HDR Metadata Script");
+
+	if (scriptPath.isEmpty())
+	{
+		ui->metadataSequenceComboBox->setCurrentIndex(kHDRSequenceStatic);
+	}
+	else if (!m_metadataTimeline.LoadScript(scriptPath.toLocal8Bit().constData(), &errorLine))
+	{
+		QMessageBox::critical(this, "Unable to load the HDR metadata script.", QString("The script could not be read, or line %1 is not valid.").arg(errorLine));
+		ui->metadataSequenceComboBox->setCurrentIndex(kHDRSequenceStatic);
+	}
+}
+
 void SignalGenHDR::DisplayPrimaryRedXSliderChanged(int displayPrimaryRedXValue)
 {
 	m_selectedHDRParameters.referencePrimaries.RedX = (double)displayPrimaryRedXValue / 1000;
@@ -622,17 +738,41 @@ void SignalGenHDR::MaxFALLSliderChanged(int maxFALLValue)
 
 void SignalGenHDR::UpdateOutputFrame()
 {
-	if (m_running)
-	{
-		// Update the HDR metadata in frame and output
-		// As these statements are sequential, they are thread safe.  It is not recommended
-		// that an active frame is updated, and normally synchronization will be required
-		m_videoFrameBars->UpdateHDRMetadata(m_selectedHDRParameters);
-		m_selectedDeckLinkOutput->DisplayVideoFrameSync(m_videoFrameBars.get());
-	}
+	// The metadata of the controls is attached to the frames scheduled after the change, the frames already
+	// scheduled are not changed
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_outputHDRParameters = m_selectedHDRParameters;
 }
 
-com_ptr<HDRVideoFrame> SignalGenHDR::CreateColorbarsFrame()
+void SignalGenHDR::ScheduleNextFrame()
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	HDRMetadata					metadata;
+
+	if (!m_scheduling)
+		return;
+
+	// Frames of the pool are scheduled in turn, and the metadata of each frame is that of the timeline for its
+	// frame number, so switch points are frame accurate.  The image is the moving frame of the bars of the EOTF,
+	// or of the EOTF of the controls if the bars of the EOTF were not rendered.
+	com_ptr<HDRVideoFrame>& frame = m_framePool[m_totalFramesScheduled % m_framePool.size()];
+
+	m_metadataTimeline.GetMetadata(m_totalFramesScheduled, m_outputHDRParameters, metadata);
+
+	auto barsFrames = m_barsFrames.find((metadata.EOTF == static_cast<int64_t>(EOTF::HLG)) ? EOTF::HLG : EOTF::PQ);
+	if (barsFrames == m_barsFrames.end())
+		barsFrames = m_barsFrames.begin();
+
+	frame->SetVideoFrame(barsFrames->second[m_totalFramesScheduled % barsFrames->second.size()]);
+	frame->UpdateHDRMetadata(metadata);
+
+	if (m_selectedDeckLinkOutput->ScheduleVideoFrame(frame.get(), (m_totalFramesScheduled * m_frameDuration), m_frameDuration, m_frameTimescale) != S_OK)
+		return;
+
+	m_totalFramesScheduled++;
+}
+
+com_ptr<IDeckLinkMutableVideoFrame> SignalGenHDR::CreateColorbarsFrame(EOTF eotf, uint32_t movingFrame)
 {
 	com_ptr<IDeckLinkMutableVideoFrame>	displayFrame;
 	HRESULT								hr;
@@ -641,13 +781,16 @@ com_ptr<HDRVideoFrame> SignalGenHDR::CreateColorbarsFrame()
 	unsigned long						frameWidth;
 	unsigned long						frameHeight;
 	EOTFColorRange						colorRange;
+	HDRMetadata							barsHDRParameters = m_selectedHDRParameters;
 
 	frameWidth = m_selectedDisplayMode->GetWidth();
 	frameHeight = m_selectedDisplayMode->GetHeight();
 
 	displayFrameBytesPerRow = GetBytesPerRow(m_selectedPixelFormat, frameWidth);
 
-	if (m_selectedHDRParameters.EOTF == static_cast<int64_t>(EOTF::HLG))
+	barsHDRParameters.EOTF = static_cast<int64_t>(eotf);
+
+	if (eotf == EOTF::HLG)
 		colorRange = EOTFColorRange::HLGVideoRange;
 	else if (m_selectedPixelFormat == bmdFormat12BitRGBLE)
 		colorRange = EOTFColorRange::PQFullRange;
@@ -661,12 +804,12 @@ com_ptr<HDRVideoFrame> SignalGenHDR::CreateColorbarsFrame()
 	referencePixelFormat = (m_selectedPixelFormat == bmdFormat12BitRGBLE) ? bmdFormat12BitRGBLE : bmdFormat10BitRGB;
 
 	// Attach HDR metadata to video frame
-	com_ptr<HDRVideoFrame> displayHDRFrame = make_com_ptr<HDRVideoFrame>(displayFrame, m_selectedHDRParameters);
+	com_ptr<HDRVideoFrame> displayHDRFrame = make_com_ptr<HDRVideoFrame>(displayFrame, barsHDRParameters);
 
 	if (m_selectedPixelFormat == referencePixelFormat)
 	{
 		// output pixel format matches reference, so can be filled directly without conversion
-		FillBT2111ColorBars(displayFrame, colorRange);
+		FillBT2111ColorBars(displayFrame, colorRange, movingFrame, kMovingFrameCount);
 	}
 	else
 	{
@@ -678,10 +821,10 @@ com_ptr<HDRVideoFrame> SignalGenHDR::CreateColorbarsFrame()
 		if (hr != S_OK)
 			return nullptr;
 
-		FillBT2111ColorBars(referenceFrame, colorRange);
+		FillBT2111ColorBars(referenceFrame, colorRange, movingFrame, kMovingFrameCount);
 
 		// Attach HDR metadata to reference frame
-		com_ptr<HDRVideoFrame> referenceHDRFrame = make_com_ptr<HDRVideoFrame>(referenceFrame, m_selectedHDRParameters);
+		com_ptr<HDRVideoFrame> referenceHDRFrame = make_com_ptr<HDRVideoFrame>(referenceFrame, barsHDRParameters);
 
 		// Convert to required pixel format
 		com_ptr<IDeckLinkVideoConversion> frameConverter(CreateVideoConversionInstance());
@@ -691,5 +834,5 @@ com_ptr<HDRVideoFrame> SignalGenHDR::CreateColorbarsFrame()
 			return nullptr;
 	}
 
-	return displayHDRFrame;
+	return displayFrame;
 }
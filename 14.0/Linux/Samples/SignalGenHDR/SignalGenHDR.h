@@ -41,6 +41,8 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <vector>
 #include <QDialog>
 #include <QEvent>
 #include <QLayout>
@@ -48,6 +50,8 @@
 #include "com_ptr.h"
 #include "DeckLinkDeviceDiscovery.h"
 #include "DeckLinkOpenGLWidget.h"
+#include "DeckLinkOutputCallback.h"
+#include "HDRMetadataTimeline.h"
 #include "HDRVideoFrame.h"
 
 // Define custom event type
@@ -90,6 +94,7 @@ public:
 	void AddDevice(com_ptr<IDeckLink> deckLink);
 	void RemoveDevice(com_ptr<IDeckLink> deckLink);
 	void UpdateOutputFrame(void);
+	void ScheduleNextFrame(void);
 
 
 private:
@@ -103,19 +108,34 @@ private:
 	com_ptr<IDeckLinkDisplayMode>		m_selectedDisplayMode;
 	com_ptr<IDeckLinkOutput>			m_selectedDeckLinkOutput;
 	com_ptr<IDeckLinkConfiguration>		m_selectedDeckLinkConfiguration;
-	com_ptr<HDRVideoFrame>				m_videoFrameBars;
+	com_ptr<DeckLinkOutputCallback>		m_outputCallback;
 	BMDPixelFormat						m_selectedPixelFormat;
 	HDRMetadata							m_selectedHDRParameters;
+	int									m_selectedMetadataSequence;
+
+	// Scheduled output: colour bars with moving content are rendered before playback, for PQ and for HLG.  Frames
+	// of the pool attach the metadata of the timeline for their frame to the image of the bars of its EOTF.
+	// m_mutex guards the state used from the output callback.
+	std::mutex							m_mutex;
+	bool								m_scheduling;
+	std::map<EOTF, std::vector<com_ptr<IDeckLinkMutableVideoFrame>>>	m_barsFrames;
+	std::vector<com_ptr<HDRVideoFrame>>	m_framePool;
+	HDRMetadataTimeline					m_metadataTimeline;
+	HDRMetadata							m_outputHDRParameters;
+	uint64_t							m_totalFramesScheduled;
+	BMDTimeValue						m_frameDuration;
+	BMDTimeScale						m_frameTimescale;
 
 	DisplayModeMap						m_supportedDisplayModeMap;
 
-	com_ptr<HDRVideoFrame>		CreateColorbarsFrame(void);
+	com_ptr<IDeckLinkMutableVideoFrame>	CreateColorbarsFrame(EOTF eotf, uint32_t movingFrame);
 
 public slots:
 	void OutputDeviceChanged(int selectedDeviceIndex);
 	void VideoFormatChanged(int selectedVideoFormatIndex);
 	void PixelFormatChanged(int selectedPixelFormatIndex);
 	void EOTFChanged(int selectedEOTFIndex);
+	void MetadataSequenceChanged(int selectedSequenceIndex);
 	void ToggleStart();
 
 	void DisplayPrimaryRedXSliderChanged(int displayPrimaryRedXValue);
@@ -11,7 +11,7 @@ QT       += core gui widgets
 
 TARGET = SignalGenHDR
 TEMPLATE = app
-INCLUDEPATH = ../../include
+INCLUDEPATH = ../../include ../VideoKernels
 LIBS += -ldl
 
 # The following define makes your compiler emit warnings if you use
@@ -32,7 +32,15 @@ SOURCES += \
         ColorBars.cpp \
         DeckLinkDeviceDiscovery.cpp \
         DeckLinkOpenGLWidget.cpp \
+        DeckLinkOutputCallback.cpp \
+        HDRMetadataTimeline.cpp \
         HDRVideoFrame.cpp \
+        ../VideoKernels/VideoKernels.cpp \
+        ../VideoKernels/VideoKernelsSSE41.cpp \
+        ../VideoKernels/VideoKernelsAVX2.cpp \
+        ../VideoKernels/VideoKernelsAVX512.cpp \
+        ../VideoKernels/VideoKernelsNEON.cpp \
+        ../VideoKernels/Colorimetry.cpp \
         ../../include/DeckLinkAPIDispatch.cpp
 
 HEADERS += \
@@ -40,7 +48,11 @@ HEADERS += \
         ColorBars.h \
         DeckLinkDeviceDiscovery.h \
         DeckLinkOpenGLWidget.h \
+        DeckLinkOutputCallback.h \
+        HDRMetadataTimeline.h \
         HDRVideoFrame.h \
+        ../VideoKernels/VideoKernels.h \
+        ../VideoKernels/VideoKernelsPrivate.h \
     com_ptr.h
 
 FORMS += \
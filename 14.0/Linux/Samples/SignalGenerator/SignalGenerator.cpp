@@ -53,20 +53,6 @@
 
 const uint32_t		kAudioWaterlevel = 48000;
 
-// SD 75% Colour Bars
-static uint32_t gSD75pcColourBars[8] =
-{
-	0xeb80eb80, 0xa28ea22c, 0x832c839c, 0x703a7048,
-	0x54c654b8, 0x41d44164, 0x237223d4, 0x10801080
-};
-
-// HD 75% Colour Bars
-static uint32_t gHD75pcColourBars[8] =
-{
-	0xeb80eb80, 0xa888a82c, 0x912c9193, 0x8534853f,
-	0x3fcc3fc1, 0x33d4336d, 0x1c781cd4, 0x10801080
-};
-
 // Audio channels supported
 static const int gAudioChannels[] = { 2, 8, 16 };
 
@@ -99,6 +85,8 @@ SignalGenerator::SignalGenerator() : QDialog(),
 
 	ui->outputSignalPopup->addItem("Pip", QVariant::fromValue((int)kOutputSignalPip));
 	ui->outputSignalPopup->addItem("Dropout", QVariant::fromValue((int)kOutputSignalDrop));
+	ui->outputSignalPopup->addItem("A/V Sync", QVariant::fromValue((int)kOutputSignalAVSync));
+	ui->outputSignalPopup->addItem("Channel Ident", QVariant::fromValue((int)kOutputSignalIdent));
 	
 	ui->audioSampleDepthPopup->addItem("16", QVariant::fromValue(16));
 	ui->audioSampleDepthPopup->addItem("32", QVariant::fromValue(32));
@@ -336,46 +324,26 @@ void SignalGenerator::playbackStopped()
 	stopPlaybackCondition.notify_one();
 }
 
-com_ptr<IDeckLinkMutableVideoFrame> SignalGenerator::CreateOutputFrame(FillFrameFunction fillFrame)
+com_ptr<IDeckLinkMutableVideoFrame> SignalGenerator::CreateOutputFrame(TestPatternType pattern)
 {
 	com_ptr<IDeckLinkOutput>				deckLinkOutput;
-	com_ptr<IDeckLinkMutableVideoFrame>		referenceFrame;
 	com_ptr<IDeckLinkMutableVideoFrame>		scheduleFrame;
 	HRESULT									hr;
 	int										bytesPerRow;
-	int										referenceBytesPerRow;
-	com_ptr<IDeckLinkVideoConversion>		frameConverter;
 
 	bytesPerRow = GetRowBytes(selectedPixelFormat, frameWidth);
-	referenceBytesPerRow = GetRowBytes(bmdFormat8BitYUV, frameWidth);
 
 	deckLinkOutput = selectedDevice->getDeviceOutput();
 
-	frameConverter = CreateVideoConversionInstance();
-	if (!frameConverter)
-		goto bail;
-
-	hr = deckLinkOutput->CreateVideoFrame(frameWidth, frameHeight, referenceBytesPerRow, bmdFormat8BitYUV, bmdFrameFlagDefault, referenceFrame.releaseAndGetAddressOf());
+	hr = deckLinkOutput->CreateVideoFrame(frameWidth, frameHeight, bytesPerRow, selectedPixelFormat, bmdFrameFlagDefault, scheduleFrame.releaseAndGetAddressOf());
 	if (hr != S_OK)
 		goto bail;
 
-	fillFrame(referenceFrame);
-
-	if (selectedPixelFormat == bmdFormat8BitYUV)
-	{
-		// Frame is already 8-bit YUV, no conversion required
-		scheduleFrame = referenceFrame;
-	}
-	else
-	{
-		hr = deckLinkOutput->CreateVideoFrame(frameWidth, frameHeight, bytesPerRow, selectedPixelFormat, bmdFrameFlagDefault, scheduleFrame.releaseAndGetAddressOf());
-		if (hr != S_OK)
-			goto bail;
-
-		hr = frameConverter->ConvertFrame(referenceFrame.get(), scheduleFrame.get());
-		if (hr != S_OK)
-			goto bail;
-	}
+	// The pattern is rendered in the selected pixel format once, so changing back to a mode and pixel format
+	// only copies the frame from the cache
+	hr = PatternCache::GetSharedCache().FillFrame(selectedDisplayMode, pattern, scheduleFrame.get());
+	if (hr != S_OK)
+		scheduleFrame = nullptr;
 
 bail:
 	return scheduleFrame;
@@ -494,13 +462,26 @@ void SignalGenerator::startRunning()
 	audioBuffer = malloc(audioBufferSampleLength * audioChannelCount * (audioSampleDepth / 8));
 	if (audioBuffer == nullptr)
 		goto bail;
-	FillSine(audioBuffer, audioBufferSampleLength, audioChannelCount, audioSampleDepth);
+	if (outputSignal == kOutputSignalAVSync)
+		FillAVSyncAudio(audioBuffer, audioBufferSampleLength, audioSamplesPerFrame, audioChannelCount, audioSampleDepth, ~0ULL);
+	else if (outputSignal == kOutputSignalIdent)
+	{
+		// Each second of the ident is rendered as it is scheduled
+		toneGenerator.reset(new ToneGenerator(audioChannelCount, audioSampleRate));
+		toneGenerator->SetSequence(kToneSequenceChannelIdent);
+	}
+	else
+		FillSine(audioBuffer, audioBufferSampleLength, audioChannelCount, audioSampleDepth);
 	
 	// Generate a frame of black
-	videoFrameBlack = CreateOutputFrame(FillBlack);
+	videoFrameBlack = CreateOutputFrame(kTestPatternBlack);
 	
 	// Generate a frame of colour bars
-	videoFrameBars = CreateOutputFrame(FillColorBars);
+	videoFrameBars = CreateOutputFrame(kTestPatternColourBars75);
+
+	// Generate a frame of white, for the flash of the A/V sync test signal
+	if (outputSignal == kOutputSignalAVSync)
+		videoFrameWhite = CreateOutputFrame(kTestPatternWhite);
 	
 	// Begin video preroll by scheduling a second of frames in hardware
 	for (unsigned int i = 0; i < framesPerSecond; i++)
@@ -554,6 +535,7 @@ void SignalGenerator::stopRunning()
 	if (audioBuffer != nullptr)
 		free(audioBuffer);
 	audioBuffer = nullptr;
+	toneGenerator.reset();
 	
 	selectedDevice->onScheduledFrameCompleted(nullptr);
 	selectedDevice->onRenderAudioSamples(nullptr);
@@ -585,7 +567,19 @@ void SignalGenerator::scheduleNextFrame(bool prerolling)
 			return;
 	}
 	
-	if (outputSignal == kOutputSignalPip)
+	if (outputSignal == kOutputSignalAVSync)
+	{
+		// A white flash on each second, on the first sample of the beep
+		if ((totalFramesScheduled % framesPerSecond) == 0)
+			currentFrame = videoFrameWhite;
+		else
+			currentFrame = videoFrameBlack;
+	}
+	else if (outputSignal == kOutputSignalIdent)
+	{
+		currentFrame = videoFrameBars;
+	}
+	else if (outputSignal == kOutputSignalPip)
 	{
 		if ((totalFramesScheduled % framesPerSecond) == 0)
 			currentFrame = videoFrameBars;
@@ -717,7 +711,20 @@ void SignalGenerator::writeNextAudioSamples()
 {
 	// Write one second of audio to the DeckLink API.
 	
-	if (outputSignal == kOutputSignalPip)
+	if (outputSignal == kOutputSignalAVSync)
+	{
+		// Schedule one-second of audio, starting with the beep
+		if (selectedDevice->getDeviceOutput()->ScheduleAudioSamples(audioBuffer, audioBufferSampleLength, (totalAudioSecondsScheduled * audioBufferSampleLength), audioSampleRate, nullptr) != S_OK)
+			return;
+	}
+	else if (outputSignal == kOutputSignalIdent)
+	{
+		// Render and schedule the next second of the ident, which continues from the last
+		toneGenerator->Render(audioBuffer, audioBufferSampleLength, audioSampleDepth);
+		if (selectedDevice->getDeviceOutput()->ScheduleAudioSamples(audioBuffer, audioBufferSampleLength, (totalAudioSecondsScheduled * audioBufferSampleLength), audioSampleRate, nullptr) != S_OK)
+			return;
+	}
+	else if (outputSignal == kOutputSignalPip)
 	{
 		// Schedule one-frame of audio tone
 		if (selectedDevice->getDeviceOutput()->ScheduleAudioSamples(audioBuffer, audioSamplesPerFrame, (totalAudioSecondsScheduled * audioBufferSampleLength), audioSampleRate, nullptr) != S_OK)
@@ -799,78 +806,9 @@ int		GetRowBytes(BMDPixelFormat pixelFormat, uint32_t frameWidth)
 
 void	FillSine (void* audioBuffer, uint32_t samplesToWrite, uint32_t channels, uint32_t sampleDepth)
 {
-	if (sampleDepth == 16)
-	{
-		int16_t*		nextBuffer;
-		
-		nextBuffer = (int16_t*)audioBuffer;
-		for (uint32_t i = 0; i < samplesToWrite; i++)
-		{
-			int16_t		sample;
-			
-			sample = (int16_t)(24576.0 * sin((i * 2.0 * M_PI) / 48.0));
-			for (uint32_t ch = 0; ch < channels; ch++)
-				*(nextBuffer++) = sample;
-		}
-	}
-	else if (sampleDepth == 32)
-	{
-		int32_t*		nextBuffer;
-		
-		nextBuffer = (int32_t*)audioBuffer;
-		for (uint32_t i = 0; i < samplesToWrite; i++)
-		{
-			int32_t		sample;
-			
-			sample = (int32_t)(1610612736.0 * sin((i * 2.0 * M_PI) / 48.0));
-			for (uint32_t ch = 0; ch < channels; ch++)
-				*(nextBuffer++) = sample;
-		}
-	}
-}
+	// A 1kHz tone at 3/4 of full scale, -2.5dBFS, on every channel
+	ToneGenerator	toneGenerator(channels);
 
-void	FillColorBars (com_ptr<IDeckLinkMutableVideoFrame>& theFrame)
-{
-	uint32_t*		nextWord;
-	uint32_t		width;
-	uint32_t		height;
-	uint32_t*		bars;
-	
-	theFrame->GetBytes((void**)&nextWord);
-	width = theFrame->GetWidth();
-	height = theFrame->GetHeight();
-	
-	if (width > 720)
-	{
-		bars = gHD75pcColourBars;
-	}
-	else
-	{
-		bars = gSD75pcColourBars;
-	}
-
-	for (uint32_t y = 0; y < height; y++)
-	{
-		for (uint32_t x = 0; x < width; x+=2)
-		{
-			*(nextWord++) = bars[(x * 8) / width];
-		}
-	}
-}
-
-void	FillBlack (com_ptr<IDeckLinkMutableVideoFrame>& theFrame)
-{
-	uint32_t*		nextWord;
-	uint32_t		width;
-	uint32_t		height;
-	uint32_t		wordsRemaining;
-	
-	theFrame->GetBytes((void**)&nextWord);
-	width = theFrame->GetWidth();
-	height = theFrame->GetHeight();
-	
-	wordsRemaining = (width*2 * height) / 4;
-	
-	while (wordsRemaining-- > 0)
-		*(nextWord++) = 0x10801080;
+	toneGenerator.SetTone(1000.0, -2.5);
+	toneGenerator.Render(audioBuffer, samplesToWrite, sampleDepth);
 }
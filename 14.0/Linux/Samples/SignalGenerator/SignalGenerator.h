@@ -55,6 +55,9 @@
 #include "DeckLinkOpenGLWidget.h"
 #include "DeckLinkOutputDevice.h"
 #include "DeckLinkDeviceDiscovery.h"
+#include "AVSync.h"
+#include "PatternCache.h"
+#include "ToneGenerator.h"
 
 #include "ui_SignalGenerator.h"
 
@@ -110,15 +113,15 @@ private:
 enum OutputSignal
 {
 	kOutputSignalPip		= 0,
-	kOutputSignalDrop		= 1
+	kOutputSignalDrop		= 1,
+	kOutputSignalAVSync		= 2,	// A white flash each second, with a beep starting on the same audio sample
+	kOutputSignalIdent		= 3		// Colour bars, with a streamed channel ident tone
 };
 
 class SignalGenerator : public QDialog
 {
 	Q_OBJECT
 
-	using FillFrameFunction = std::function<void(com_ptr<IDeckLinkMutableVideoFrame>&)>;
-
 public:
 	SignalGenerator();
 	~SignalGenerator() = default;
@@ -139,6 +142,7 @@ public:
 	uint32_t								dropFrames;
 	com_ptr<IDeckLinkMutableVideoFrame>		videoFrameBlack;
 	com_ptr<IDeckLinkMutableVideoFrame>		videoFrameBars;
+	com_ptr<IDeckLinkMutableVideoFrame>		videoFrameWhite;
 	uint32_t								totalFramesScheduled;
 	//
 	OutputSignal							outputSignal;
@@ -149,6 +153,7 @@ public:
 	BMDAudioSampleRate						audioSampleRate;
 	uint32_t								audioSampleDepth;
 	uint32_t								totalAudioSecondsScheduled;
+	std::unique_ptr<ToneGenerator>			toneGenerator;
 	//
 	std::mutex								mutex;
 	std::condition_variable					stopPlaybackCondition;
@@ -187,11 +192,9 @@ private:
 	bool scheduledPlaybackStopped;
 	std::map<intptr_t, com_ptr<DeckLinkOutputDevice>>		outputDevices;
 
-	com_ptr<IDeckLinkMutableVideoFrame> CreateOutputFrame(FillFrameFunction fillFrame);
+	com_ptr<IDeckLinkMutableVideoFrame> CreateOutputFrame(TestPatternType pattern);
 };
 
 int		GetRowBytes(BMDPixelFormat pixelFormat, uint32_t frameWidth);
 void	FillSine (void* audioBuffer, uint32_t samplesToWrite, uint32_t channels, uint32_t sampleDepth);
-void	FillColorBars (com_ptr<IDeckLinkMutableVideoFrame>& theFrame);
-void	FillBlack (com_ptr<IDeckLinkMutableVideoFrame>& theFrame);
 void	ScheduleNextVideoFrame (void);
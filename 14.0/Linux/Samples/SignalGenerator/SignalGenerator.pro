@@ -6,7 +6,7 @@ QT       += core gui widgets
 TARGET = SignalGenerator
 TEMPLATE = app
 CONFIG += c++11
-INCLUDEPATH = ../../include
+INCLUDEPATH = ../../include ../VideoKernels
 LIBS += -ldl
 
 # The following define makes your compiler emit warnings if you use
@@ -25,14 +25,30 @@ HEADERS 	=	SignalGenerator.h \
 				com_ptr.h \
 				DeckLinkDeviceDiscovery.h \
 				DeckLinkOutputDevice.h \
-				DeckLinkOpenGLWidget.h
+				DeckLinkOpenGLWidget.h \
+				../VideoKernels/AVSync.h \
+				../VideoKernels/PatternCache.h \
+				../VideoKernels/ToneGenerator.h \
+				../VideoKernels/VideoConversion.h \
+				../VideoKernels/VideoKernels.h \
+				../VideoKernels/VideoKernelsPrivate.h
 
 SOURCES 	= 	main.cpp \
 				../../include/DeckLinkAPIDispatch.cpp \
 				DeckLinkDeviceDiscovery.cpp \
 				DeckLinkOutputDevice.cpp \
 				DeckLinkOpenGLWidget.cpp \
-				SignalGenerator.cpp
+				SignalGenerator.cpp \
+				../VideoKernels/AVSync.cpp \
+				../VideoKernels/PatternCache.cpp \
+				../VideoKernels/ToneGenerator.cpp \
+				../VideoKernels/VideoConversion.cpp \
+				../VideoKernels/VideoKernels.cpp \
+				../VideoKernels/VideoKernelsSSE41.cpp \
+				../VideoKernels/VideoKernelsAVX2.cpp \
+				../VideoKernels/VideoKernelsAVX512.cpp \
+				../VideoKernels/VideoKernelsNEON.cpp \
+				../VideoKernels/Colorimetry.cpp
 
 FORMS 		= 	SignalGenerator.ui
 
@@ -53,6 +53,14 @@ BMDConfig::BMDConfig() :
 	m_outputFlags(bmdVideoOutputFlagDefault),
 	m_pixelFormat(bmdFormat8BitYUV),
 	m_output444(false),
+	m_patternCacheDirectory(NULL),
+	m_animatedPattern(-1),
+	m_burnInTimecode(false),
+	m_avSyncChannelMask(0),
+	m_toneSequence(-1),
+	m_toneFrequency(kDefaultToneFrequency),
+	m_toneLevel(kDefaultToneLevel),
+	m_ltcChannel(-1),
 	m_deckLinkName(),
 	m_displayModeName()
 {
@@ -72,7 +80,7 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 	int		ch;
 	bool	displayHelp = false;
 
-	while ((ch = getopt(argc, argv, "d:?h3c:s:f:a:m:n:p:t:")) != -1)
+	while ((ch = getopt(argc, argv, "d:?h3c:s:f:a:m:n:p:t:C:A:bS:T:F:L:l:")) != -1)
 	{
 		switch (ch)
 		{
@@ -110,6 +118,7 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 					case 0: m_pixelFormat = bmdFormat8BitYUV;  m_output444 = false; break;
 					case 1: m_pixelFormat = bmdFormat10BitYUV; m_output444 = false; break;
 					case 2: m_pixelFormat = bmdFormat10BitRGB; m_output444 = true;  break;
+					case 3: m_pixelFormat = bmdFormat12BitRGB; m_output444 = true;  break;
 					default:
 						fprintf(stderr, "Invalid argument: Pixel format %d is not valid", atoi(optarg));
 						return false;
@@ -120,6 +129,68 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 				m_outputFlags |= bmdVideoOutputDualStream3D;
 				break;
 
+			case 'C':
+				m_patternCacheDirectory = optarg;
+				break;
+
+			case 'A':
+				m_animatedPattern = atoi(optarg);
+				if (m_animatedPattern < 0 || m_animatedPattern > 3)
+				{
+					fprintf(stderr, "Invalid argument: Animated pattern must be between 0 and 3\n");
+					return false;
+				}
+				break;
+
+			case 'b':
+				m_burnInTimecode = true;
+				break;
+
+			case 'S':
+				m_avSyncChannelMask = strtoull(optarg, NULL, 0);
+				if (m_avSyncChannelMask == 0)
+				{
+					fprintf(stderr, "Invalid argument: A/V sync channel mask must select at least one channel\n");
+					return false;
+				}
+				break;
+
+			case 'T':
+				m_toneSequence = atoi(optarg);
+				if (m_toneSequence < 0 || m_toneSequence >= kToneSequenceCount)
+				{
+					fprintf(stderr, "Invalid argument: Tone sequence must be between 0 and %d\n", kToneSequenceCount - 1);
+					return false;
+				}
+				break;
+
+			case 'F':
+				m_toneFrequency = atof(optarg);
+				if (m_toneFrequency <= 0.0 || m_toneFrequency >= 24000.0)
+				{
+					fprintf(stderr, "Invalid argument: Tone frequency must be between 0 and 24000 Hz\n");
+					return false;
+				}
+				break;
+
+			case 'L':
+				m_toneLevel = atof(optarg);
+				if (m_toneLevel > 0.0)
+				{
+					fprintf(stderr, "Invalid argument: Tone level must be at most 0 dBFS\n");
+					return false;
+				}
+				break;
+
+			case 'l':
+				m_ltcChannel = atoi(optarg) - 1;
+				if (m_ltcChannel < 0)
+				{
+					fprintf(stderr, "Invalid argument: LTC channel must be at least 1\n");
+					return false;
+				}
+				break;
+
 			case '?':
 			case 'h':
 				displayHelp = true;
@@ -138,6 +209,42 @@ bool BMDConfig::ParseArguments(int argc,  char** argv)
 		DisplayUsage(1);
 	}
 
+	if ((m_animatedPattern >= 0) && (m_outputFlags & bmdVideoOutputDualStream3D))
+	{
+		fprintf(stderr, "Animated patterns are not supported with 3D\n");
+		return false;
+	}
+
+	if (m_burnInTimecode && (m_animatedPattern < 0))
+	{
+		fprintf(stderr, "Timecode burn-in requires an animated pattern\n");
+		return false;
+	}
+
+	if ((m_avSyncChannelMask != 0) && (m_animatedPattern >= 0))
+	{
+		fprintf(stderr, "The A/V sync test signal can not be output with an animated pattern\n");
+		return false;
+	}
+
+	if ((m_avSyncChannelMask != 0) && (m_toneSequence >= 0))
+	{
+		fprintf(stderr, "The A/V sync test signal can not be output with a line-up tone\n");
+		return false;
+	}
+
+	if ((m_avSyncChannelMask >> m_audioChannels) != 0)
+	{
+		fprintf(stderr, "The A/V sync channel mask selects channels above channel %d\n", m_audioChannels);
+		return false;
+	}
+
+	if (m_ltcChannel >= m_audioChannels)
+	{
+		fprintf(stderr, "The LTC channel must be at most channel %d\n", m_audioChannels);
+		return false;
+	}
+
 	if (displayHelp)
 		DisplayUsage(0);
 
@@ -294,13 +401,54 @@ bail:
 		"         0:  8 bit YUV (4:2:2) (default)\n"
 		"         1:  10 bit YUV (4:2:2)\n"
 		"         2:  10 bit RGB (4:4:4)\n"
+		"         3:  12 bit RGB (4:4:4)\n"
 		"    -c <channels>        Audio Channels (2, 8 or 16 - default is 2)\n"
 		"    -s <depth>           Audio Sample Depth (16 or 32 - default is 16)\n"
 		"    -3                   Playback Stereoscopic 3D (Requires 3D Hardware support)\n"
+		"    -C <directory>       Keep rendered test pattern frames in the directory, for a faster start on the next run\n"
+		"    -A <pattern>         Render an animated pattern each frame, instead of colour bars and black\n"
+		"         0:  Zone plate with a moving centre\n"
+		"         1:  Scrolling ramp\n"
+		"         2:  Rotating frequency sweep\n"
+		"         3:  Moving box with a frame counter\n"
+		"    -b                   Burn timecode, frame number, device name and stream time into the animated pattern\n"
+		"    -S <mask>            Output the A/V sync test signal, a white flash each second with a beep on the audio channels of the mask\n"
+		"    -T <sequence>        Stream a line-up tone on every audio channel, with colour bars unless an animated pattern is selected\n"
+		"         0:  Continuous tone\n"
+		"         1:  Channel ident, channel n is interrupted n times\n"
+		"         2:  EBU stereo line-up, left channel interrupted every 3 seconds\n"
+		"         3:  GLITS stereo line-up, left interrupted once and right twice every 4 seconds\n"
+		"    -F <frequency>       Line-up tone frequency in Hz (default 1000)\n"
+		"    -L <level>           Line-up tone level in dBFS (default -18)\n"
+		"    -l <channel>         Output LTC of the frame timecode on an audio channel, from 1, in place of its audio\n"
 		"\n"
 		"Output a test pattern eg:\n"
 		"\n"
 		"    TestPattern -d 0 -m 2 \n"
+		"\n"
+		"Output a test pattern, reusing the frames rendered by earlier runs eg:\n"
+		"\n"
+		"    TestPattern -d 0 -m 2 -p 1 -C /var/cache/testpattern\n"
+		"\n"
+		"Output a moving box showing the number of each frame, to check for dropped or repeated frames eg:\n"
+		"\n"
+		"    TestPattern -d 0 -m 2 -p 1 -A 3\n"
+		"\n"
+		"Output a zone plate with burnt-in timecode, for QC and latency measurement through a signal chain eg:\n"
+		"\n"
+		"    TestPattern -d 0 -m 2 -p 1 -A 0 -b\n"
+		"\n"
+		"Output a white flash each second with a beep on audio channels 1 and 2, to measure lip-sync through a chain with Capture -S eg:\n"
+		"\n"
+		"    TestPattern -d 0 -m 2 -S 0x3\n"
+		"\n"
+		"Output colour bars with a channel ident tone on 16 channels of 32 bit audio, to check the audio routing of a chain eg:\n"
+		"\n"
+		"    TestPattern -d 0 -m 2 -c 16 -s 32 -T 1\n"
+		"\n"
+		"Output a moving box with burnt-in timecode and the same timecode as LTC on audio channel 8, to check LTC with Capture -L eg:\n"
+		"\n"
+		"    TestPattern -d 0 -m 2 -p 1 -A 3 -b -c 8 -l 8\n"
 	);
 
 	if (deckLinkIterator != NULL)
@@ -324,15 +472,25 @@ void BMDConfig::DisplayConfiguration()
 		" - Playback device: %s\n"
 		" - Video mode: %s %s\n"
 		" - Pixel format: %s\n"
+		" - Test pattern: %s%s\n"
 		" - Audio channels: %u\n"
 		" - Audio sample depth: %u bit \n",
 		m_deckLinkName,
 		m_displayModeName,
 		(m_outputFlags & bmdVideoOutputDualStream3D) ? "3D" : "",
 		GetPixelFormatName(m_pixelFormat),
+		(m_avSyncChannelMask != 0) ? "A/V sync flash and beep" :
+			((m_toneSequence >= 0) && (m_animatedPattern < 0)) ? "colour bars" : GetAnimatedPatternName(m_animatedPattern),
+		m_burnInTimecode ? " with burnt-in timecode" : "",
 		m_audioChannels,
 		m_audioSampleDepth
 	);
+
+	if (m_toneSequence >= 0)
+		fprintf(stderr, " - Line-up tone: %s, %g Hz at %g dBFS\n", GetToneSequenceName(m_toneSequence), m_toneFrequency, m_toneLevel);
+
+	if (m_ltcChannel >= 0)
+		fprintf(stderr, " - LTC: audio channel %d\n", m_ltcChannel + 1);
 }
 
 IDeckLink* BMDConfig::GetSelectedDeckLink()
@@ -413,6 +571,40 @@ const char* BMDConfig::GetPixelFormatName(BMDPixelFormat pixelFormat)
 			return "10 bit YUV (4:2:2)";
 		case bmdFormat10BitRGB:
 			return "10 bit RGB (4:4:4)";
+		case bmdFormat12BitRGB:
+			return "12 bit RGB (4:4:4)";
+	}
+	return "unknown";
+}
+
+const char* BMDConfig::GetAnimatedPatternName(int pattern)
+{
+	switch (pattern)
+	{
+		case 0:
+			return "animated zone plate";
+		case 1:
+			return "scrolling ramp";
+		case 2:
+			return "rotating frequency sweep";
+		case 3:
+			return "moving box with frame counter";
+	}
+	return "colour bars and black";
+}
+
+const char* BMDConfig::GetToneSequenceName(int sequence)
+{
+	switch (sequence)
+	{
+		case kToneSequenceContinuous:
+			return "continuous line-up";
+		case kToneSequenceChannelIdent:
+			return "channel ident";
+		case kToneSequenceEBU:
+			return "EBU stereo line-up";
+		case kToneSequenceGLITS:
+			return "GLITS stereo line-up";
 	}
 	return "unknown";
 }
@@ -42,6 +42,7 @@
 #define BMD_CONFIG_H
 
 #include "DeckLinkAPI.h"
+#include "ToneGenerator.h"
 
 class BMDConfig
 {
@@ -66,14 +67,36 @@ public:
 	const char*				m_videoOutputFile;
 	const char*				m_audioOutputFile;
 
+	const char*				m_patternCacheDirectory;
+
+	// Animated pattern rendered each frame, or -1 to alternate colour bars and black
+	int						m_animatedPattern;
+
+	// Burn timecode, frame number, device name and stream time into the animated pattern
+	bool					m_burnInTimecode;
+
+	// Audio channels of the beep of the A/V sync test signal, bit 0 for the first channel, or 0 for no test signal
+	uint64_t				m_avSyncChannelMask;
+
+	// Line-up tone sequence streamed on every audio channel, or -1 for the tone and silence of the test pattern
+	int						m_toneSequence;
+	double					m_toneFrequency;
+	double					m_toneLevel;			// dBFS
+
+	// Audio channel of LTC, from 0, or -1 for no LTC
+	int						m_ltcChannel;
+
 	IDeckLink*				GetSelectedDeckLink(void);
 	IDeckLinkDisplayMode*	GetSelectedDeckLinkDisplayMode(IDeckLink* deckLink);
+	const char*				GetDeckLinkName(void) const { return m_deckLinkName; }
 
 private:
 	char*					m_deckLinkName;
 	char*					m_displayModeName;
 
 	static const char*		GetPixelFormatName(BMDPixelFormat pixelFormat);
+	static const char*		GetAnimatedPatternName(int pattern);
+	static const char*		GetToneSequenceName(int sequence);
 
 	bool					IsDeviceActive(IDeckLink* deckLink);
 	bool					IsPlaybackDevice(IDeckLink* deckLink);
@@ -60,6 +60,10 @@ pthread_cond_t			sleepCond;
 bool					do_exit = false;
 
 const unsigned long		kAudioWaterlevel = 48000;
+const double			kTestPatternToneLevel = -2.5;		// dBFS, 3/4 of full scale
+
+// Frames of the animated pattern pool beyond the second of frames scheduled in preroll
+const unsigned long		kAnimatedFramePoolMargin = 4;
 
 void sigfunc(int signum)
 {
@@ -119,9 +123,15 @@ TestPattern::TestPattern(BMDConfig *config) :
 	m_displayMode(),
 	m_videoFrameBlack(),
 	m_videoFrameBars(),
-	m_outputSignal(kOutputSignalDrop),
+	m_videoFrameWhite(),
+	m_animatedPatternRenderer(),
+	m_timecodeBurnIn(),
+	m_outputSignal((config->m_avSyncChannelMask != 0) ? kOutputSignalAVSync : (config->m_toneSequence >= 0) ? kOutputSignalLineUp : kOutputSignalDrop),
 	m_audioBuffer(),
-	m_audioSampleRate(bmdAudioSampleRate48kHz)
+	m_audioSampleRate(bmdAudioSampleRate48kHz),
+	m_toneGenerator(),
+	m_ltcEncoder(),
+	m_ltcEncodedSamples(0)
 {
 }
 
@@ -172,6 +182,8 @@ bool TestPattern::Run()
 
 	m_config->DisplayConfiguration();
 
+	PatternCache::GetSharedCache().SetDirectory(m_config->m_patternCacheDirectory);
+
 	// Provide this class as a delegate to the audio and video output interfaces
 	m_deckLinkOutput->SetScheduledFrameCompletionCallback(this);
 	m_deckLinkOutput->SetAudioCallback(this);
@@ -268,35 +280,108 @@ void TestPattern::StartRunning()
 
 	if (m_outputSignal == kOutputSignalPip)
 		FillSine(m_audioBuffer, audioSamplesPerFrame, m_config->m_audioChannels, m_config->m_audioSampleDepth);
+	else if (m_outputSignal == kOutputSignalAVSync)
+		FillAVSyncAudio(m_audioBuffer, m_audioBufferSampleLength, audioSamplesPerFrame, m_config->m_audioChannels, m_config->m_audioSampleDepth, m_config->m_avSyncChannelMask);
+	else if (m_outputSignal == kOutputSignalLineUp)
+	{
+		// The line-up tone is streamed, the buffer holds the next second of it
+		m_toneGenerator = new ToneGenerator(m_config->m_audioChannels, m_audioSampleRate);
+		if (!m_toneGenerator->SetTone(m_config->m_toneFrequency, m_config->m_toneLevel))
+		{
+			fprintf(stderr, "Invalid line-up tone frequency\n");
+			goto bail;
+		}
+		m_toneGenerator->SetSequence((ToneSequence)m_config->m_toneSequence);
+		m_toneGenerator->Render(m_audioBuffer, m_audioBufferSampleLength, m_config->m_audioSampleDepth);
+	}
 	else
 		FillSine((void*)((unsigned long)m_audioBuffer + (audioSamplesPerFrame * m_config->m_audioChannels * m_config->m_audioSampleDepth / 8)), (m_audioBufferSampleLength - audioSamplesPerFrame), m_config->m_audioChannels, m_config->m_audioSampleDepth);
 
-	// Generate a frame of black
-	if (CreateFrame(&m_videoFrameBlack, FillBlack) != S_OK)
-		goto bail;
+	// LTC starts at 00:00:00:00 with the first frame, as the timecode burnt into the animated pattern
+	if (m_config->m_ltcChannel >= 0)
+		m_ltcEncoder = new LTCEncoder(m_frameDuration, m_frameTimescale, m_audioSampleRate);
 
-	if (m_config->m_outputFlags & bmdVideoOutputDualStream3D)
+	if (m_config->m_animatedPattern >= 0)
 	{
-		frame3D = new VideoFrame3D(m_videoFrameBlack);
-		m_videoFrameBlack->Release();
-		m_videoFrameBlack = frame3D;
-		frame3D = NULL;
-	}
+		if (!AnimatedPatternRenderer::IsPixelFormatSupported(m_config->m_pixelFormat))
+		{
+			fprintf(stderr, "Animated patterns are not supported in the pixel format\n");
+			goto bail;
+		}
 
-	// Generate a frame of colour bars
-	if (CreateFrame(&m_videoFrameBars, FillForwardColourBars) != S_OK)
-		goto bail;
+		// Each frame is rendered when it is scheduled, into a frame of the pool that is no longer in use
+		m_animatedPatternRenderer = new AnimatedPatternRenderer(m_frameWidth, m_frameHeight, m_config->m_pixelFormat, (AnimatedPatternType)m_config->m_animatedPattern);
+
+		for (unsigned i = 0; i < m_framesPerSecond + kAnimatedFramePoolMargin; i++)
+		{
+			IDeckLinkMutableVideoFrame* frame = NULL;
+
+			if (m_deckLinkOutput->CreateVideoFrame(m_frameWidth, m_frameHeight, GetRowBytes(m_config->m_pixelFormat, m_frameWidth), m_config->m_pixelFormat, bmdFrameFlagDefault, &frame) != S_OK)
+			{
+				fprintf(stderr, "Failed to create video frame\n");
+				goto bail;
+			}
+
+			m_animatedFrames.push_back(frame);
+		}
+
+		m_freeAnimatedFrames = m_animatedFrames;
+
+		if (m_config->m_burnInTimecode)
+		{
+			if (!TextOverlay::IsPixelFormatSupported(m_config->m_pixelFormat))
+			{
+				fprintf(stderr, "Timecode burn-in is not supported in the pixel format\n");
+				goto bail;
+			}
 
-	if (m_config->m_outputFlags & bmdVideoOutputDualStream3D)
+			m_timecodeBurnIn = new TimecodeBurnIn(m_config->GetDeckLinkName(), m_frameTimescale);
+		}
+	}
+	else
 	{
-		if (CreateFrame(&rightFrame, FillReverseColourBars) != S_OK)
+		// Generate a frame of black
+		if (CreateFrame(&m_videoFrameBlack, kTestPatternBlack) != S_OK)
 			goto bail;
 
-		frame3D = new VideoFrame3D(m_videoFrameBars, rightFrame);
-		m_videoFrameBars->Release();
-		rightFrame->Release();
-		m_videoFrameBars = frame3D;
-		frame3D = NULL;
+		if (m_config->m_outputFlags & bmdVideoOutputDualStream3D)
+		{
+			frame3D = new VideoFrame3D(m_videoFrameBlack);
+			m_videoFrameBlack->Release();
+			m_videoFrameBlack = frame3D;
+			frame3D = NULL;
+		}
+
+		// Generate a frame of colour bars
+		if (CreateFrame(&m_videoFrameBars, kTestPatternColourBars100) != S_OK)
+			goto bail;
+
+		if (m_config->m_outputFlags & bmdVideoOutputDualStream3D)
+		{
+			if (CreateFrame(&rightFrame, kTestPatternColourBars100Reversed) != S_OK)
+				goto bail;
+
+			frame3D = new VideoFrame3D(m_videoFrameBars, rightFrame);
+			m_videoFrameBars->Release();
+			rightFrame->Release();
+			m_videoFrameBars = frame3D;
+			frame3D = NULL;
+		}
+
+		// Generate a frame of white, for the flash of the A/V sync test signal
+		if (m_outputSignal == kOutputSignalAVSync)
+		{
+			if (CreateFrame(&m_videoFrameWhite, kTestPatternWhite) != S_OK)
+				goto bail;
+
+			if (m_config->m_outputFlags & bmdVideoOutputDualStream3D)
+			{
+				frame3D = new VideoFrame3D(m_videoFrameWhite);
+				m_videoFrameWhite->Release();
+				m_videoFrameWhite = frame3D;
+				frame3D = NULL;
+			}
+		}
 	}
 
 	// Begin video preroll by scheduling a second of frames in hardware
@@ -308,6 +393,7 @@ void TestPattern::StartRunning()
 
 	// Begin audio preroll.  This will begin calling our audio callback, which will start the DeckLink output stream.
 	m_audioBufferOffset = 0;
+	m_ltcEncodedSamples = 0;
 	if (m_deckLinkOutput->BeginAudioPreroll() != S_OK)
 	{
 		fprintf(stderr, "Failed to begin audio preroll\n");
@@ -348,9 +434,30 @@ void TestPattern::StopRunning()
 		m_videoFrameBars->Release();
 	m_videoFrameBars = NULL;
 
+	if (m_videoFrameWhite != NULL)
+		m_videoFrameWhite->Release();
+	m_videoFrameWhite = NULL;
+
+	for (IDeckLinkMutableVideoFrame* frame : m_animatedFrames)
+		frame->Release();
+	m_animatedFrames.clear();
+	m_freeAnimatedFrames.clear();
+
+	delete m_animatedPatternRenderer;
+	m_animatedPatternRenderer = NULL;
+
+	delete m_timecodeBurnIn;
+	m_timecodeBurnIn = NULL;
+
 	if (m_audioBuffer != NULL)
 		free(m_audioBuffer);
 	m_audioBuffer = NULL;
+
+	delete m_toneGenerator;
+	m_toneGenerator = NULL;
+
+	delete m_ltcEncoder;
+	m_ltcEncoder = NULL;
 }
 
 void TestPattern::ScheduleNextFrame(bool prerolling)
@@ -362,7 +469,27 @@ void TestPattern::ScheduleNextFrame(bool prerolling)
 		if (m_running == false)
 			return;
 	}
-	if (m_outputSignal == kOutputSignalPip)
+	if (m_animatedPatternRenderer != NULL)
+	{
+		if (!ScheduleAnimatedFrame())
+			return;
+	}
+	else if (m_outputSignal == kOutputSignalAVSync)
+	{
+		// On each second, schedule a white flash, which starts on the first sample of the beep in the one second
+		// audio buffer, and frames of black otherwise
+		IDeckLinkVideoFrame* frame = ((m_totalFramesScheduled % m_framesPerSecond) == 0) ? m_videoFrameWhite : m_videoFrameBlack;
+
+		if (m_deckLinkOutput->ScheduleVideoFrame(frame, (m_totalFramesScheduled * m_frameDuration), m_frameDuration, m_frameTimescale) != S_OK)
+			return;
+	}
+	else if (m_outputSignal == kOutputSignalLineUp)
+	{
+		// Schedule frames of colour bars under the line-up tone
+		if (m_deckLinkOutput->ScheduleVideoFrame(m_videoFrameBars, (m_totalFramesScheduled * m_frameDuration), m_frameDuration, m_frameTimescale) != S_OK)
+			return;
+	}
+	else if (m_outputSignal == kOutputSignalPip)
 	{
 		if ((m_totalFramesScheduled % m_framesPerSecond) == 0)
 		{
@@ -396,6 +523,34 @@ void TestPattern::ScheduleNextFrame(bool prerolling)
 	m_totalFramesScheduled += 1;
 }
 
+bool TestPattern::ScheduleAnimatedFrame()
+{
+	IDeckLinkMutableVideoFrame*	frame;
+	void*						bytes;
+
+	{
+		std::lock_guard<std::mutex> guard(m_animatedFramesMutex);
+		if (m_freeAnimatedFrames.empty())
+			return false;
+
+		frame = m_freeAnimatedFrames.back();
+		m_freeAnimatedFrames.pop_back();
+	}
+
+	// The frame number is the frame's position in the output, so that a dropped or repeated frame is visible
+	if ((frame->GetBytes(&bytes) != S_OK) ||
+		(m_animatedPatternRenderer->RenderFrame(m_totalFramesScheduled, bytes, frame->GetRowBytes()) != S_OK) ||
+		((m_timecodeBurnIn != NULL) && (m_timecodeBurnIn->BurnIn(frame, (m_totalFramesScheduled * m_frameDuration), m_frameDuration) != S_OK)) ||
+		(m_deckLinkOutput->ScheduleVideoFrame(frame, (m_totalFramesScheduled * m_frameDuration), m_frameDuration, m_frameTimescale) != S_OK))
+	{
+		std::lock_guard<std::mutex> guard(m_animatedFramesMutex);
+		m_freeAnimatedFrames.push_back(frame);
+		return false;
+	}
+
+	return true;
+}
+
 void TestPattern::WriteNextAudioSamples()
 {
 	unsigned int		bufferedSamples;
@@ -412,21 +567,33 @@ void TestPattern::WriteNextAudioSamples()
 		if (samplesToWrite > samplesToEndOfBuffer)
 			samplesToWrite = samplesToEndOfBuffer;
 
+		// Encode LTC over the samples not encoded by an earlier call, which may have been only partly scheduled
+		if ((m_ltcEncoder != NULL) && (samplesToWrite > m_ltcEncodedSamples))
+		{
+			unsigned long	firstSample = m_audioBufferOffset + m_ltcEncodedSamples;
+
+			m_ltcEncoder->Encode((void*)((unsigned long)m_audioBuffer + (firstSample * m_config->m_audioChannels * m_config->m_audioSampleDepth / 8)), samplesToWrite - m_ltcEncodedSamples, m_config->m_audioChannels, m_config->m_ltcChannel, m_config->m_audioSampleDepth);
+			m_ltcEncodedSamples = samplesToWrite;
+		}
+
 		if (m_deckLinkOutput->ScheduleAudioSamples((void*)((unsigned long)m_audioBuffer + (m_audioBufferOffset * m_config->m_audioChannels * m_config->m_audioSampleDepth / 8)), samplesToWrite, 0, 0, &samplesWritten) == S_OK)
 		{
 			m_audioBufferOffset = ((m_audioBufferOffset + samplesWritten) % m_audioBufferSampleLength);
+			m_ltcEncodedSamples -= std::min<unsigned long>(samplesWritten, m_ltcEncodedSamples);
+
+			// Once the whole buffer of line-up tone has been scheduled, render the next second, so the tone and its
+			// sequence continue without a repeat
+			if ((m_toneGenerator != NULL) && (samplesWritten > 0) && (m_audioBufferOffset == 0))
+				m_toneGenerator->Render(m_audioBuffer, m_audioBufferSampleLength, m_config->m_audioSampleDepth);
 		}
 	}
 }
 
-HRESULT TestPattern::CreateFrame(IDeckLinkVideoFrame** frame, void (*fillFunc)(IDeckLinkVideoFrame*))
+HRESULT TestPattern::CreateFrame(IDeckLinkVideoFrame** frame, TestPatternType pattern)
 {
 	HRESULT						result;
 	int							bytesPerRow = GetRowBytes(m_config->m_pixelFormat, m_frameWidth);
-	int							referenceBytesPerRow = GetRowBytes(bmdFormat8BitYUV, m_frameWidth);
 	IDeckLinkMutableVideoFrame*	newFrame = NULL;
-	IDeckLinkMutableVideoFrame*	referenceFrame = NULL;
-	IDeckLinkVideoConversion*	frameConverter = NULL;
 
 	*frame = NULL;
 
@@ -437,42 +604,18 @@ HRESULT TestPattern::CreateFrame(IDeckLinkVideoFrame** frame, void (*fillFunc)(I
 		goto bail;
 	}
 
-	if (m_config->m_pixelFormat == bmdFormat8BitYUV)
-	{
-		fillFunc(newFrame);
-	}
-	else
+	// The pattern is rendered in the pixel format once, and copied from the cache after that
+	result = PatternCache::GetSharedCache().FillFrame(m_displayMode->GetDisplayMode(), pattern, newFrame);
+	if (result != S_OK)
 	{
-		// Create a black frame in 8 bit YUV and convert to desired format
-		result = m_deckLinkOutput->CreateVideoFrame(m_frameWidth, m_frameHeight, referenceBytesPerRow, bmdFormat8BitYUV, bmdFrameFlagDefault, &referenceFrame);
-		if (result != S_OK)
-		{
-			fprintf(stderr, "Failed to create reference video frame\n");
-			goto bail;
-		}
-
-		fillFunc(referenceFrame);
-
-		frameConverter = CreateVideoConversionInstance();
-
-		result = frameConverter->ConvertFrame(referenceFrame, newFrame);
-		if (result != S_OK)
-		{
-			fprintf(stderr, "Failed to convert frame\n");
-			goto bail;
-		}
+		fprintf(stderr, "Failed to fill video frame\n");
+		goto bail;
 	}
 
 	*frame = newFrame;
 	newFrame = NULL;
 
 bail:
-	if (referenceFrame != NULL)
-		referenceFrame->Release();
-
-	if (frameConverter != NULL)
-		frameConverter->Release();
-
 	if (newFrame != NULL)
 		newFrame->Release();
 
@@ -512,8 +655,21 @@ ULONG TestPattern::Release()
 HRESULT TestPattern::ScheduledFrameCompleted(IDeckLinkVideoFrame* completedFrame, BMDOutputFrameCompletionResult result)
 {
 	++m_totalFramesCompleted;
+	if (result == bmdOutputFrameDropped)
+		++m_totalFramesDropped;
 	PrintStatusLine();
 
+	// Return a frame of an animated pattern to the pool
+	{
+		std::lock_guard<std::mutex> guard(m_animatedFramesMutex);
+
+		for (IDeckLinkMutableVideoFrame* frame : m_animatedFrames)
+		{
+			if (frame == completedFrame)
+				m_freeAnimatedFrames.push_back(frame);
+		}
+	}
+
 	// When a video frame has been released by the API, schedule another video frame to be output
 	ScheduleNextFrame(false);
 	return S_OK;
@@ -546,84 +702,11 @@ HRESULT TestPattern::RenderAudioSamples(bool preroll)
 
 void FillSine(void* audioBuffer, unsigned long samplesToWrite, unsigned long channels, unsigned long sampleDepth)
 {
-	if (sampleDepth == 16)
-	{
-		short*		nextBuffer;
-
-		nextBuffer = (short*)audioBuffer;
-		for (unsigned i = 0; i < samplesToWrite; i++)
-		{
-			short		sample;
+	// A 1kHz tone at 3/4 of full scale on every channel
+	ToneGenerator	toneGenerator((uint32_t)channels);
 
-			sample = (short)(24576.0 * sin((i * 2.0 * M_PI) / 48.0));
-			for (unsigned ch = 0; ch < channels; ch++)
-				*(nextBuffer++) = sample;
-		}
-	}
-	else if (sampleDepth == 32)
-	{
-		int*		nextBuffer;
-
-		nextBuffer = (int*)audioBuffer;
-		for (unsigned i = 0; i < samplesToWrite; i++)
-		{
-			int		sample;
-
-			sample = (int)(1610612736.0 * sin((i * 2.0 * M_PI) / 48.0));
-			for (unsigned ch = 0; ch < channels; ch++)
-				*(nextBuffer++) = sample;
-		}
-	}
-}
-
-void FillColourBars(IDeckLinkVideoFrame* theFrame, bool reverse)
-{
-	unsigned int*	nextWord;
-	unsigned long	width;
-	unsigned long	height;
-	unsigned int	bars[8] = {0xEA80EA80, 0xD292D210, 0xA910A9A5, 0x90229035, 0x6ADD6ACA, 0x51EF515A, 0x286D28EF, 0x10801080};
-
-	theFrame->GetBytes((void**)&nextWord);
-	width = theFrame->GetWidth();
-	height = theFrame->GetHeight();
-
-	if (reverse)
-	{
-		for (long y = 0; y < height; y++)
-		{
-			for (long x = width - 2; x >= 0; x -= 2)
-			{
-				*(nextWord++) = bars[(x * 8) / width];
-			}
-		}
-	}
-	else
-	{
-		for (long y = 0; y < height; y++)
-		{
-			for (long x = 0; x < width; x += 2)
-			{
-				*(nextWord++) = bars[(x * 8) / width];
-			}
-		}
-	}
-}
-
-void FillBlack(IDeckLinkVideoFrame* theFrame)
-{
-	unsigned int*	nextWord;
-	unsigned long	width;
-	unsigned long	height;
-	unsigned long	wordsRemaining;
-
-	theFrame->GetBytes((void**)&nextWord);
-	width = theFrame->GetWidth();
-	height = theFrame->GetHeight();
-
-	wordsRemaining = (width * 2 * height) / 4;
-
-	while (wordsRemaining-- > 0)
-		*(nextWord++) = 0x10801080;
+	toneGenerator.SetTone(1000.0, kTestPatternToneLevel);
+	toneGenerator.Render(audioBuffer, (uint32_t)samplesToWrite, (uint32_t)sampleDepth);
 }
 
 int GetRowBytes(BMDPixelFormat pixelFormat, int frameWidth)
@@ -645,6 +728,10 @@ int GetRowBytes(BMDPixelFormat pixelFormat, int frameWidth)
 		bytesPerRow = ((frameWidth + 63) / 64) * 256;
 		break;
 
+	case bmdFormat12BitRGB:
+		bytesPerRow = ((frameWidth + 7) / 8) * 36;
+		break;
+
 	case bmdFormat8BitARGB:
 	case bmdFormat8BitBGRA:
 	default:
@@ -40,14 +40,23 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 #include "DeckLinkAPI.h"
 #include "Config.h"
+#include "AnimatedPattern.h"
+#include "AVSync.h"
+#include "LTC.h"
+#include "PatternCache.h"
+#include "TimecodeBurnIn.h"
+#include "ToneGenerator.h"
 
 enum OutputSignal
 {
 	kOutputSignalPip		= 0,
-	kOutputSignalDrop		= 1
+	kOutputSignalDrop		= 1,
+	kOutputSignalAVSync		= 2,	// A white flash each second, with a beep starting on the same audio sample
+	kOutputSignalLineUp		= 3		// Colour bars, with a line-up tone streamed from m_toneGenerator
 };
 
 
@@ -69,6 +78,15 @@ private:
 	unsigned long			m_framesPerSecond;
 	IDeckLinkVideoFrame*	m_videoFrameBlack;
 	IDeckLinkVideoFrame*	m_videoFrameBars;
+	IDeckLinkVideoFrame*	m_videoFrameWhite;
+
+	// Animated patterns are rendered into a pool of frames, a frame returns to the pool when it has been output
+	AnimatedPatternRenderer*					m_animatedPatternRenderer;
+	std::vector<IDeckLinkMutableVideoFrame*>	m_animatedFrames;
+	std::vector<IDeckLinkMutableVideoFrame*>	m_freeAnimatedFrames;
+	std::mutex									m_animatedFramesMutex;
+	TimecodeBurnIn*								m_timecodeBurnIn;
+
 	unsigned long			m_totalFramesScheduled;
 	unsigned long			m_totalFramesDropped;
 	unsigned long			m_totalFramesCompleted;
@@ -78,6 +96,9 @@ private:
 	unsigned long			m_audioBufferSampleLength;
 	unsigned long			m_audioBufferOffset;
 	BMDAudioSampleRate		m_audioSampleRate;
+	ToneGenerator*			m_toneGenerator;			// Renders each second of the buffer in turn, for a line-up tone
+	LTCEncoder*				m_ltcEncoder;				// Encodes LTC into the buffer as it is scheduled
+	unsigned long			m_ltcEncodedSamples;		// Samples from m_audioBufferOffset already encoded
 
 	std::mutex				m_mutex;
 	std::condition_variable	m_stoppedCondition;
@@ -88,6 +109,7 @@ private:
 	void			StartRunning();
 	void			StopRunning();
 	void			ScheduleNextFrame(bool prerolling);
+	bool			ScheduleAnimatedFrame();
 	void			WriteNextAudioSamples();
 
 	void			PrintStatusLine();
@@ -107,18 +129,8 @@ public:
 
 	virtual HRESULT STDMETHODCALLTYPE RenderAudioSamples(bool preroll);
 
-	HRESULT CreateFrame(IDeckLinkVideoFrame** theFrame, void (*fillFunc)(IDeckLinkVideoFrame*));
+	HRESULT CreateFrame(IDeckLinkVideoFrame** theFrame, TestPatternType pattern);
 };
 
 void FillSine(void* audioBuffer, unsigned long samplesToWrite, unsigned long channels, unsigned long sampleDepth);
-void FillColourBars(IDeckLinkVideoFrame* theFrame, bool reverse);
-static inline void FillForwardColourBars(IDeckLinkVideoFrame* theFrame)
-{
-	FillColourBars(theFrame, false);
-}
-static inline void FillReverseColourBars(IDeckLinkVideoFrame* theFrame)
-{
-	FillColourBars(theFrame, true);
-}
-void FillBlack(IDeckLinkVideoFrame* theFrame);
 int GetRowBytes(BMDPixelFormat pixelFormat, int frameWidth);
@@ -0,0 +1,223 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include "AVSync.h"
+
+// The beep is 1kHz at 3/4 of full scale, as the tone of the TestPattern and SignalGenerator samples
+static const double		kBeepSamplesPerCycle	= 48.0;
+static const double		kBeepLevel				= 0.75;
+
+// An onset is a sample of at least 1/8 of full scale after 50ms below it
+static const int		kBeepThresholdShift		= 3;
+static const uint32_t	kMinSilenceSamples		= kAVSyncSampleRate / 20;
+
+// A frame is a flash when its level rises above kFlashOnLevel, and the next flash must fall below kFlashOffLevel
+// first.  Levels are 10-bit, black at 64 and white at 940.
+static const int		kFlashOnLevel			= 700;
+static const int		kFlashOffLevel			= 300;
+
+// Rows spread over the frame, and a sample in every kLevelStep of each row, are averaged for the frame level
+static const uint32_t	kLevelRows				= 8;
+static const uint32_t	kLevelStep				= 4;
+
+static const double		kMaxPairingInterval		= 0.5;
+static const size_t		kMaxMeasurements		= 64;
+
+void FillAVSyncAudio(void* audioBuffer, uint32_t sampleFrames, uint32_t beepSampleFrames, uint32_t channels, uint32_t sampleDepth, uint64_t channelMask)
+{
+	double		fullScale = (sampleDepth == 32) ? 2147483648.0 : 32768.0;
+	int16_t*	nextSample16 = (int16_t*)audioBuffer;
+	int32_t*	nextSample32 = (int32_t*)audioBuffer;
+
+	for (uint32_t i = 0; i < sampleFrames; i++)
+	{
+		double	sample = (i < beepSampleFrames) ? fullScale * kBeepLevel * cos((i * 2.0 * M_PI) / kBeepSamplesPerCycle) : 0.0;
+
+		for (uint32_t ch = 0; ch < channels; ch++)
+		{
+			bool	beep = (ch < 64) && ((channelMask >> ch) & 1);
+
+			if (sampleDepth == 32)
+				*(nextSample32++) = beep ? (int32_t)sample : 0;
+			else
+				*(nextSample16++) = beep ? (int16_t)sample : 0;
+		}
+	}
+}
+
+AVSyncAnalyzer::AVSyncAnalyzer(uint32_t channels, uint32_t sampleDepth, uint32_t beepChannel) :
+	m_channels(channels),
+	m_sampleDepth(sampleDepth),
+	m_beepChannel(beepChannel),
+	m_beepThreshold((sampleDepth == 32) ? (INT32_MAX >> kBeepThresholdShift) : (INT16_MAX >> kBeepThresholdShift)),
+	m_flashing(false),
+	m_silentSamples(0),
+	m_hasVideoEvent(false),
+	m_hasAudioEvent(false),
+	m_videoEventTime(0.0),
+	m_audioEventTime(0.0)
+{
+}
+
+int AVSyncAnalyzer::GetFrameLevel(IDeckLinkVideoFrame* frame, VideoConversion::RowPlanes& planes)
+{
+	const uint32_t			width		= (uint32_t)frame->GetWidth();
+	const uint32_t			height		= (uint32_t)frame->GetHeight();
+	const BMDPixelFormat	pixelFormat	= frame->GetPixelFormat();
+	const bool				isYUV		= IsYUVPixelFormat(pixelFormat);
+	uint64_t				sum			= 0;
+	uint32_t				count		= 0;
+	void*					bytes;
+
+	if ((width == 0) || (height == 0) || (GetPixelFormatRowBytes(pixelFormat, width) == 0) || (frame->GetBytes(&bytes) != S_OK))
+		return -1;
+
+	planes.luma.resize(width);
+	planes.cb.resize((width + 1) / 2);
+	planes.cr.resize((width + 1) / 2);
+	planes.red.resize(width);
+	planes.green.resize(width);
+	planes.blue.resize(width);
+	planes.alpha.resize(width);
+
+	for (uint32_t i = 0; i < kLevelRows; i++)
+	{
+		uint32_t				y		= (uint32_t)(((2 * i + 1) * (uint64_t)height) / (2 * kLevelRows));
+		const uint8_t*			row		= (const uint8_t*)bytes + y * frame->GetRowBytes();
+		const uint16_t*			samples	= isYUV ? planes.luma.data() : planes.green.data();
+
+		if (!DecodePixelFormatRow(pixelFormat, row, planes, width))
+			return -1;
+
+		// RGB samples are at 16-bit video levels
+		for (uint32_t x = 0; x < width; x += kLevelStep, count++)
+			sum += isYUV ? samples[x] : (samples[x] >> 6);
+	}
+
+	return (int)(sum / count);
+}
+
+void AVSyncAnalyzer::AnalyzeVideoFrame(IDeckLinkVideoFrame* frame, BMDTimeValue streamTime, BMDTimeScale timeScale)
+{
+	int		level = GetFrameLevel(frame, m_planes);
+
+	if ((level < 0) || (timeScale <= 0))
+		return;
+
+	if (!m_flashing && (level > kFlashOnLevel))
+	{
+		m_flashing = true;
+		AddEvent(true, (double)streamTime / timeScale);
+	}
+	else if (m_flashing && (level < kFlashOffLevel))
+	{
+		m_flashing = false;
+	}
+}
+
+void AVSyncAnalyzer::AnalyzeAudioSamples(const void* samples, uint32_t sampleFrameCount, BMDTimeValue packetTime)
+{
+	if ((samples == NULL) || (m_beepChannel >= m_channels))
+		return;
+
+	for (uint32_t i = 0; i < sampleFrameCount; i++)
+	{
+		size_t	index	= (size_t)i * m_channels + m_beepChannel;
+		int32_t	sample	= (m_sampleDepth == 32) ? ((const int32_t*)samples)[index] : ((const int16_t*)samples)[index];
+
+		if ((sample < m_beepThreshold) && (sample > -m_beepThreshold))
+		{
+			if (m_silentSamples < kMinSilenceSamples)
+				m_silentSamples++;
+			continue;
+		}
+
+		if (m_silentSamples >= kMinSilenceSamples)
+			AddEvent(false, (double)(packetTime + i) / kAVSyncSampleRate);
+
+		m_silentSamples = 0;
+	}
+}
+
+bool AVSyncAnalyzer::GetMeasurement(AVSyncMeasurement& measurement)
+{
+	if (m_measurements.empty())
+		return false;
+
+	measurement = m_measurements.front();
+	m_measurements.pop_front();
+	return true;
+}
+
+void AVSyncAnalyzer::AddEvent(bool video, double time)
+{
+	bool&	hasOtherEvent	= video ? m_hasAudioEvent : m_hasVideoEvent;
+	double	otherEventTime	= video ? m_audioEventTime : m_videoEventTime;
+
+	if (hasOtherEvent && (fabs(time - otherEventTime) < kMaxPairingInterval))
+	{
+		AVSyncMeasurement	measurement;
+
+		measurement.videoTime	= video ? time : otherEventTime;
+		measurement.audioTime	= video ? otherEventTime : time;
+		measurement.offset		= (measurement.audioTime - measurement.videoTime) * 1000.0;
+
+		if (m_measurements.size() >= kMaxMeasurements)
+			m_measurements.pop_front();
+
+		m_measurements.push_back(measurement);
+		hasOtherEvent = false;
+		return;
+	}
+
+	// An unpaired event is replaced by the next event of its kind
+	if (video)
+	{
+		m_hasVideoEvent		= true;
+		m_videoEventTime	= time;
+	}
+	else
+	{
+		m_hasAudioEvent		= true;
+		m_audioEventTime	= time;
+	}
+}
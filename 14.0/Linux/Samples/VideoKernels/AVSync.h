@@ -0,0 +1,110 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <deque>
+#include "DeckLinkAPI.h"
+#include "VideoConversion.h"
+
+// The A/V sync test signal is a 100% white flash frame once in each period of black frames, with a beep on some
+// audio channels that starts on the first audio sample of the flash frame.  A generator outputs the flash frames
+// with kTestPatternWhite of PatternCache, and fills a period of audio with FillAVSyncAudio().
+//
+// AVSyncAnalyzer measures the offset of the beep from the flash in captured video and audio, for lip-sync checks
+// through a chain.  Each frame is tested for a flash from the mean luma, or green, of a few of its rows, and
+// the audio of the beep channel for the first sample above the beep threshold after a silence.  Audio times are
+// sample accurate, 21us at 48kHz, so offsets are measured well below a millisecond.  A flash and a beep are
+// paired when they are less than half a second apart.
+//
+// AVSyncAnalyzer is not thread safe, frames and audio packets should be analyzed from the input callback.
+
+static const uint32_t	kAVSyncSampleRate	= 48000;
+
+// Fill sampleFrames of interleaved 16 or 32-bit audio, a period of the test signal: a 1kHz beep of
+// beepSampleFrames on the channels of channelMask, bit 0 for the first channel, then silence.  The beep starts at
+// the peak of its cosine, so that its first sample marks the onset.
+void	FillAVSyncAudio(void* audioBuffer, uint32_t sampleFrames, uint32_t beepSampleFrames, uint32_t channels, uint32_t sampleDepth, uint64_t channelMask);
+
+struct AVSyncMeasurement
+{
+	double		videoTime;		// Stream time of the flash frame, in seconds
+	double		audioTime;		// Stream time of the beep onset, in seconds
+	double		offset;			// audioTime - videoTime in milliseconds, positive when audio is late
+};
+
+class AVSyncAnalyzer
+{
+public:
+	// beepChannel is the channel of the beep, from 0, in audio of channels channels of sampleDepth bits
+	AVSyncAnalyzer(uint32_t channels, uint32_t sampleDepth, uint32_t beepChannel);
+
+	// Test a frame with a stream time of streamTime / timeScale for a flash.  Frames of unsupported pixel
+	// formats are ignored.
+	void				AnalyzeVideoFrame(IDeckLinkVideoFrame* frame, BMDTimeValue streamTime, BMDTimeScale timeScale);
+
+	// Find beep onsets in the audio of a packet, with a packet time in samples at 48kHz
+	void				AnalyzeAudioSamples(const void* samples, uint32_t sampleFrameCount, BMDTimeValue packetTime);
+
+	// Get the next measurement, returns false if there is none
+	bool				GetMeasurement(AVSyncMeasurement& measurement);
+
+	// Mean luma of a frame at 10-bit video levels, of the rows tested for a flash, or -1 if the pixel format is
+	// not supported
+	static int			GetFrameLevel(IDeckLinkVideoFrame* frame, VideoConversion::RowPlanes& planes);
+
+private:
+	uint32_t						m_channels;
+	uint32_t						m_sampleDepth;
+	uint32_t						m_beepChannel;
+	int32_t							m_beepThreshold;
+
+	VideoConversion::RowPlanes		m_planes;
+	bool							m_flashing;				// The last frame was a flash
+	uint32_t						m_silentSamples;		// Samples below the beep threshold before the next sample
+
+	bool							m_hasVideoEvent;		// Unpaired flash and beep times
+	bool							m_hasAudioEvent;
+	double							m_videoEventTime;
+	double							m_audioEventTime;
+	std::deque<AVSyncMeasurement>	m_measurements;
+
+	void							AddEvent(bool video, double time);
+};
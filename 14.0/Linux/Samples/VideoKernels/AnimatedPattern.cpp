@@ -0,0 +1,342 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "AnimatedPattern.h"
+
+// Narrow range black and white of the planes, see VideoConversion.h
+static const uint16_t	kYUVBlack				= 64;
+static const uint16_t	kYUVWhite				= 940;
+static const uint16_t	kRGBBlack				= 4096;
+static const uint16_t	kRGBWhite				= 60160;
+static const uint16_t	kChromaZero				= 512;
+static const uint16_t	kOpaque					= 0xFFFF;
+
+// The cosine and sine of A(x) are scaled by 2^kSinusoidShift
+static const double		kPhaseScale				= (double)(1 << kSinusoidShift);
+
+// Periods of the animations in frames.  The zone plate centre traces a figure of eight, and its rings expand by
+// one cycle every kZonePlateRingFrames.
+static const uint32_t	kZonePlateOrbitFrames	= 600;
+static const uint32_t	kZonePlateRingFrames	= 30;
+static const uint32_t	kSweepRotationFrames	= 720;
+static const uint32_t	kSweepFrames			= 240;
+
+// The sweep frequency in cycles per pixel, from a wide grating to just below the Nyquist frequency
+static const double		kSweepMinFrequency		= 1.0 / 256.0;
+static const double		kSweepMaxFrequency		= 0.45;
+
+// The ramp scrolls a frame width every kRampFrames, the box crosses the frame in about kBoxFrames
+static const uint32_t	kRampFrames				= 480;
+static const uint32_t	kBoxFrames				= 240;
+
+// The box is 9 font pixels high and a font pixel is a 1/108 of the frame height, so the box is a 1/12 of it
+static const uint32_t	kBoxUnitsPerFrame		= 108;
+static const uint32_t	kGlyphWidth				= 5;
+static const uint32_t	kGlyphHeight			= 7;
+static const uint32_t	kGlyphAdvance			= kGlyphWidth + 1;
+
+// 5x7 font of the decimal digits, the most significant of the 5 bits of each row is the leftmost pixel
+static const uint8_t	kDigitFont[10][kGlyphHeight] =
+{
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }
+};
+
+// Angle of a frame in an animation period of periodFrames
+static inline double PeriodAngle(uint64_t frameNumber, uint32_t periodFrames)
+{
+	return 2.0 * M_PI * (double)(frameNumber % periodFrames) / periodFrames;
+}
+
+// Position moving at speed samples per frame between 0 and range, reversing at each end
+static inline uint32_t BouncePosition(uint64_t frameNumber, uint32_t speed, uint32_t range)
+{
+	if (range == 0)
+		return 0;
+
+	uint64_t position = (frameNumber * speed) % ((uint64_t)range * 2);
+
+	return (uint32_t)((position <= range) ? position : (uint64_t)range * 2 - position);
+}
+
+AnimatedPatternRenderer::AnimatedPatternRenderer(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, AnimatedPatternType pattern, unsigned threadCount) :
+	m_width(width),
+	m_height(height),
+	m_pixelFormat(pixelFormat),
+	m_pattern(pattern),
+	m_isYUV(IsYUVPixelFormat(pixelFormat)),
+	m_rowBytes(GetPixelFormatRowBytes(pixelFormat, width)),
+	m_black(m_isYUV ? kYUVBlack : kRGBBlack),
+	m_white(m_isYUV ? kYUVWhite : kRGBWhite),
+	m_workerPool(threadCount)
+{
+	m_boxUnit	= std::max<uint32_t>(height / kBoxUnitsPerFrame, 1);
+	m_boxWidth	= std::min<uint32_t>((kAnimatedPatternDigits * kGlyphAdvance + 1) * m_boxUnit, width);
+	m_boxHeight	= std::min<uint32_t>((kGlyphHeight + 2) * m_boxUnit, height);
+
+	m_phases.resize((size_t)width * 2);
+
+	m_rowPlanes.resize(m_workerPool.GetThreadCount());
+	for (RowPlanes& planes : m_rowPlanes)
+	{
+		planes.luma.resize(width);
+		planes.cb.assign((width + 1) / 2, kChromaZero);
+		planes.cr.assign((width + 1) / 2, kChromaZero);
+		planes.red.resize(width);
+		planes.green.resize(width);
+		planes.blue.resize(width);
+		planes.alpha.assign(width, kOpaque);
+	}
+
+	if ((pattern == kAnimatedPatternMovingBox) && IsPixelFormatSupported(pixelFormat))
+	{
+		RowPlanes& planes = m_rowPlanes.back();
+
+		std::fill(planes.luma.begin(), planes.luma.end(), GetLevel(0.5));
+		std::fill(planes.red.begin(), planes.red.end(), GetLevel(0.5));
+
+		m_backgroundRow.resize(m_rowBytes);
+		EncodeRow(planes, m_backgroundRow.data());
+	}
+}
+
+bool AnimatedPatternRenderer::IsPixelFormatSupported(BMDPixelFormat pixelFormat)
+{
+	return GetPixelFormatRowBytes(pixelFormat, 1) != 0;
+}
+
+HRESULT AnimatedPatternRenderer::RenderFrame(uint64_t frameNumber, void* frame, long rowBytes)
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	FrameState					state;
+	uint8_t*					bytes = (uint8_t*)frame;
+
+	if (!IsPixelFormatSupported(m_pixelFormat) || (rowBytes < m_rowBytes))
+		return E_INVALIDARG;
+
+	PrepareFrame(frameNumber, state);
+
+	// The first row of the ramp is rendered before the slices that copy it
+	if (m_pattern == kAnimatedPatternScrollingRamp)
+	{
+		RenderRampRow(m_rowPlanes.back(), state);
+		EncodeRow(m_rowPlanes.back(), bytes);
+	}
+
+	uint32_t sliceCount		= std::min<uint32_t>(m_height, m_workerPool.GetThreadCount() * 4);
+	uint32_t rowsPerSlice	= (m_height + sliceCount - 1) / sliceCount;
+	sliceCount				= (m_height + rowsPerSlice - 1) / rowsPerSlice;
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		uint32_t firstRow	= slice * rowsPerSlice;
+		uint32_t endRow		= std::min(firstRow + rowsPerSlice, m_height);
+
+		for (uint32_t row = firstRow; row < endRow; row++)
+		{
+			uint8_t* outputRow = bytes + (size_t)row * rowBytes;
+
+			if (m_pattern == kAnimatedPatternScrollingRamp)
+			{
+				if (row != 0)
+					memcpy(outputRow, bytes, m_rowBytes);
+			}
+			else if ((m_pattern == kAnimatedPatternMovingBox) && ((row < state.boxY) || (row >= state.boxY + m_boxHeight)))
+			{
+				memcpy(outputRow, m_backgroundRow.data(), m_rowBytes);
+			}
+			else
+			{
+				RenderRow(m_rowPlanes[threadIndex], state, row);
+				EncodeRow(m_rowPlanes[threadIndex], outputRow);
+			}
+		}
+	});
+
+	return S_OK;
+}
+
+void AnimatedPatternRenderer::PrepareFrame(uint64_t frameNumber, FrameState& state)
+{
+	double horizontalQuadratic	= 0.0;
+	double horizontalLinear		= 0.0;
+	double horizontalCentre		= m_width / 2.0;
+
+	memset(&state, 0, sizeof(state));
+	state.centre = m_height / 2.0;
+
+	switch (m_pattern)
+	{
+		case kAnimatedPatternZonePlate:
+		{
+			// Phase k * r^2 has a frequency of k * r / pi cycles per pixel at radius r, so the frequency reaches
+			// the Nyquist frequency half a frame width from the centre
+			double orbit = PeriodAngle(frameNumber, kZonePlateOrbitFrames);
+
+			horizontalQuadratic	= M_PI / m_width;
+			horizontalCentre	+= m_width / 8.0 * sin(orbit);
+			state.quadratic		= horizontalQuadratic;
+			state.centre		+= m_height / 8.0 * sin(orbit * 2.0);
+			state.phase			= -PeriodAngle(frameNumber, kZonePlateRingFrames);
+			break;
+		}
+
+		case kAnimatedPatternRotatingSweep:
+		{
+			// The frequency sweeps exponentially up and down over kSweepFrames
+			double sweep		= PeriodAngle(frameNumber, kSweepFrames);
+			double frequency	= kSweepMinFrequency * pow(kSweepMaxFrequency / kSweepMinFrequency, (1.0 - cos(sweep)) / 2.0);
+			double rotation		= PeriodAngle(frameNumber, kSweepRotationFrames);
+
+			horizontalLinear	= 2.0 * M_PI * frequency * cos(rotation);
+			state.linear		= 2.0 * M_PI * frequency * sin(rotation);
+			break;
+		}
+
+		case kAnimatedPatternScrollingRamp:
+			state.rampOffset = (uint32_t)((frameNumber * std::max<uint32_t>(m_width / kRampFrames, 1)) % m_width);
+			break;
+
+		case kAnimatedPatternMovingBox:
+		{
+			uint64_t value = frameNumber;
+
+			state.boxX = BouncePosition(frameNumber, std::max<uint32_t>(m_width / kBoxFrames, 1), m_width - m_boxWidth);
+			state.boxY = BouncePosition(frameNumber, std::max<uint32_t>(m_height / kBoxFrames, 1), m_height - m_boxHeight);
+
+			for (uint32_t d = kAnimatedPatternDigits; d > 0; d--)
+			{
+				state.digits[d - 1]	= (uint8_t)(value % 10);
+				value				/= 10;
+			}
+			break;
+		}
+	}
+
+	if ((m_pattern == kAnimatedPatternZonePlate) || (m_pattern == kAnimatedPatternRotatingSweep))
+	{
+		for (uint32_t x = 0; x < m_width; x++)
+		{
+			double position	= x - horizontalCentre;
+			double phase	= horizontalQuadratic * position * position + horizontalLinear * position;
+
+			m_phases[x * 2]		= (int16_t)lrint(cos(phase) * kPhaseScale);
+			m_phases[x * 2 + 1]	= (int16_t)lrint(sin(phase) * kPhaseScale);
+		}
+	}
+}
+
+void AnimatedPatternRenderer::RenderRampRow(RowPlanes& planes, const FrameState& state)
+{
+	uint16_t*	samples	= m_isYUV ? planes.luma.data() : planes.red.data();
+	uint32_t	range	= std::max<uint32_t>(m_width - 1, 1);
+
+	for (uint32_t x = 0; x < m_width; x++)
+		samples[x] = (uint16_t)(m_black + ((uint64_t)((x + state.rampOffset) % m_width) * (m_white - m_black) + range / 2) / range);
+}
+
+void AnimatedPatternRenderer::RenderRow(RowPlanes& planes, const FrameState& state, uint32_t row)
+{
+	uint16_t* samples = m_isYUV ? planes.luma.data() : planes.red.data();
+
+	if (m_pattern == kAnimatedPatternMovingBox)
+	{
+		uint32_t boxEnd		= state.boxX + m_boxWidth;
+		uint32_t glyphRow	= (row - state.boxY) / m_boxUnit;
+
+		std::fill(samples, samples + m_width, GetLevel(0.5));
+		std::fill(samples + state.boxX, samples + boxEnd, m_white);
+
+		// Glyphs have a font pixel of white around them
+		if ((glyphRow < 1) || (glyphRow > kGlyphHeight))
+			return;
+
+		for (uint32_t d = 0; d < kAnimatedPatternDigits; d++)
+		{
+			uint8_t bits = kDigitFont[state.digits[d]][glyphRow - 1];
+
+			for (uint32_t c = 0; c < kGlyphWidth; c++)
+			{
+				uint32_t x = state.boxX + (1 + d * kGlyphAdvance + c) * m_boxUnit;
+
+				if ((bits & (0x10 >> c)) && (x < boxEnd))
+					std::fill(samples + x, samples + std::min(x + m_boxUnit, boxEnd), m_black);
+			}
+		}
+	}
+	else
+	{
+		// Sinusoids between black and white
+		double		position	= row - state.centre;
+		double		phase		= state.quadratic * position * position + state.linear * position + state.phase;
+		double		amplitude	= (m_white - m_black) / 2.0;
+		uint16_t	offset		= (uint16_t)((m_white + m_black) / 2);
+
+		RenderSinusoidRow(m_phases.data(), (int16_t)lrint(amplitude * cos(phase)), (int16_t)lrint(-amplitude * sin(phase)), offset, samples, m_width);
+	}
+}
+
+void AnimatedPatternRenderer::EncodeRow(RowPlanes& planes, void* row) const
+{
+	// Patterns are grey, so RGB patterns are rendered in red
+	if (!m_isYUV)
+	{
+		memcpy(planes.green.data(), planes.red.data(), m_width * sizeof(uint16_t));
+		memcpy(planes.blue.data(), planes.red.data(), m_width * sizeof(uint16_t));
+	}
+
+	EncodePixelFormatRow(m_pixelFormat, planes, row, m_width);
+}
+
+uint16_t AnimatedPatternRenderer::GetLevel(double level) const
+{
+	return (uint16_t)lrint(m_black + level * (m_white - m_black));
+}
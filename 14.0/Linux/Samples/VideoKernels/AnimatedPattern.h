@@ -0,0 +1,134 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoConversion.h"
+#include "VideoKernels.h"
+
+// AnimatedPatternRenderer renders moving test patterns into frames of the uncompressed pixel formats supported by
+// VideoConversion, a new frame for each frame number, so that dropped or repeated frames, motion artefacts and
+// scaler problems are visible on the output.  Each pattern is a function of the frame number only, so a frame is
+// the same whenever it is rendered.
+//
+// Patterns are grey, rendered in luma with neutral chroma for YUV formats and in R, G and B for RGB formats, at
+// narrow range levels.  Each row is rendered in planar samples and encoded directly into the frame by the
+// VideoConversion row codecs:
+// * The zone plate and the rotating sweep are sinusoids of a phase A(x) + B(y), rendered by the sinusoid kernels
+//   from a table of A(x) built once per frame.
+// * Every row of the scrolling ramp is the same, so one row is encoded and copied.
+// * Rows of the moving box scene outside the box are copies of an encoded background row.
+//
+// Each frame is split into slices of rows which are rendered in parallel by a SliceWorkerPool.
+
+enum AnimatedPatternType
+{
+	kAnimatedPatternZonePlate = 0,		// Circular zone plate with expanding rings and a moving centre
+	kAnimatedPatternScrollingRamp,		// Black to white horizontal ramp scrolling left
+	kAnimatedPatternRotatingSweep,		// Grating rotating about the centre of the frame, sweeping in frequency
+	kAnimatedPatternMovingBox			// White box bouncing over grey, showing the frame number
+};
+
+// Digits of the frame number shown by the moving box, the frame number modulo 10^8
+static const uint32_t	kAnimatedPatternDigits	= 8;
+
+class AnimatedPatternRenderer
+{
+public:
+	// threadCount includes the calling thread, 0 selects the number of CPUs
+	AnimatedPatternRenderer(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, AnimatedPatternType pattern, unsigned threadCount = 0);
+
+	uint32_t				GetWidth(void) const { return m_width; }
+	uint32_t				GetHeight(void) const { return m_height; }
+	BMDPixelFormat			GetPixelFormat(void) const { return m_pixelFormat; }
+	AnimatedPatternType		GetPattern(void) const { return m_pattern; }
+	unsigned				GetThreadCount(void) const { return m_workerPool.GetThreadCount(); }
+
+	static bool				IsPixelFormatSupported(BMDPixelFormat pixelFormat);
+
+	// Render a frame of the pattern.  Returns E_INVALIDARG if the pixel format is not supported or a row is too
+	// short.  Calls from multiple threads are serialized.
+	HRESULT					RenderFrame(uint64_t frameNumber, void* frame, long rowBytes);
+
+private:
+	typedef VideoConversion::RowPlanes	RowPlanes;
+
+	// Vertical phase of the sinusoid patterns, B(y) = quadratic * (y - centre)^2 + linear * (y - centre) + phase,
+	// the offset of the ramp, or the position of the box and the digits it shows
+	struct FrameState
+	{
+		double		quadratic;
+		double		linear;
+		double		centre;
+		double		phase;
+		uint32_t	rampOffset;
+		uint32_t	boxX;
+		uint32_t	boxY;
+		uint8_t		digits[kAnimatedPatternDigits];
+	};
+
+	uint32_t					m_width;
+	uint32_t					m_height;
+	BMDPixelFormat				m_pixelFormat;
+	AnimatedPatternType			m_pattern;
+	bool						m_isYUV;
+	long						m_rowBytes;
+	uint16_t					m_black;				// Samples of the plane the pattern is rendered in
+	uint16_t					m_white;
+	uint32_t					m_boxUnit;				// Size of a pixel of the digit font
+	uint32_t					m_boxWidth;
+	uint32_t					m_boxHeight;
+	std::vector<int16_t>		m_phases;				// Cosine and sine of A(x) of the frame
+	std::vector<uint8_t>		m_backgroundRow;		// Encoded row of the moving box background
+
+	std::mutex					m_mutex;
+	SliceWorkerPool				m_workerPool;
+	std::vector<RowPlanes>		m_rowPlanes;			// Indexed by pool thread
+
+	void						PrepareFrame(uint64_t frameNumber, FrameState& state);
+	void						RenderRampRow(RowPlanes& planes, const FrameState& state);
+	void						RenderRow(RowPlanes& planes, const FrameState& state, uint32_t row);
+	void						EncodeRow(RowPlanes& planes, void* row) const;
+	uint16_t					GetLevel(double level) const;
+};
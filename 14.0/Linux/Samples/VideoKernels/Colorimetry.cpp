@@ -0,0 +1,210 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "VideoKernels.h"
+#include "VideoKernelsPrivate.h"
+
+// Code values of each range, 10-bit YCbCr and 16-bit RGB
+struct YUVRange
+{
+	double	black;
+	double	lumaRange;
+	double	chromaRange;
+};
+
+struct RGBRange
+{
+	double	black;
+	double	range;
+};
+
+static const YUVRange	kNarrowYUV	= { 64.0, 876.0, 896.0 };
+static const YUVRange	kFullYUV	= { 0.0, 1023.0, 1023.0 };
+static const RGBRange	kNarrowRGB	= { 4096.0, 56064.0 };
+static const RGBRange	kFullRGB	= { 0.0, 65535.0 };
+
+void GetColorimetryCoefficients(const Colorimetry& colorimetry, ColorimetryCoefficients& coefficients)
+{
+	const YUVRange&	yuv		= (colorimetry.yuvRange == kColorimetryFullRange) ? kFullYUV : kNarrowYUV;
+	const RGBRange&	rgb		= (colorimetry.rgbRange == kColorimetryFullRange) ? kFullRGB : kNarrowRGB;
+	double			kr;
+	double			kb;
+	double			kg;
+
+	switch (colorimetry.matrix)
+	{
+		case kColorimetryRec601:
+			kr = 0.299;
+			kb = 0.114;
+			break;
+		case kColorimetryRec2020:
+			kr = 0.2627;
+			kb = 0.0593;
+			break;
+		case kColorimetryRec709:
+		default:
+			kr = 0.2126;
+			kb = 0.0722;
+			break;
+	}
+	kg = 1.0 - kr - kb;
+
+	coefficients.chromaSiting = colorimetry.chromaSiting;
+
+	// YCbCr to RGB.  Coefficients are within 16 bits for SIMD multiply-add, and green chroma coefficients
+	// are negative.
+	const double lumaScale		= (1 << kYUVToRGBShift) * rgb.range / yuv.lumaRange;
+	const double chromaScale	= (1 << kYUVToRGBShift) * rgb.range / yuv.chromaRange;
+
+	coefficients.yToRGB		= (int32_t)lrint(lumaScale);
+	coefficients.crToRed	= (int32_t)lrint(chromaScale * 2.0 * (1.0 - kr));
+	coefficients.cbToGreen	= (int32_t)lrint(-chromaScale * 2.0 * kb * (1.0 - kb) / kg);
+	coefficients.crToGreen	= (int32_t)lrint(-chromaScale * 2.0 * kr * (1.0 - kr) / kg);
+	coefficients.cbToBlue	= (int32_t)lrint(chromaScale * 2.0 * (1.0 - kb));
+	coefficients.rgbOffset	= (int32_t)lrint(rgb.black * (1 << kYUVToRGBShift)) - coefficients.yToRGB * (int32_t)yuv.black + (1 << (kYUVToRGBShift - 1));
+
+	// RGB to YCbCr
+	const double yScale		= (1 << kRGBToYUVShift) * yuv.lumaRange / rgb.range;
+	const double cScale		= (1 << kRGBToYUVShift) * yuv.chromaRange / rgb.range;
+
+	coefficients.rgbToY[0]	= (int32_t)lrint(yScale * kr);
+	coefficients.rgbToY[1]	= (int32_t)lrint(yScale * kg);
+	coefficients.rgbToY[2]	= (int32_t)lrint(yScale * kb);
+	coefficients.rgbToCb[0]	= (int32_t)lrint(cScale * -kr / (2.0 * (1.0 - kb)));
+	coefficients.rgbToCb[1]	= (int32_t)lrint(cScale * -kg / (2.0 * (1.0 - kb)));
+	coefficients.rgbToCb[2]	= (int32_t)lrint(cScale * 0.5);
+	coefficients.rgbToCr[0]	= (int32_t)lrint(cScale * 0.5);
+	coefficients.rgbToCr[1]	= (int32_t)lrint(cScale * -kg / (2.0 * (1.0 - kr)));
+	coefficients.rgbToCr[2]	= (int32_t)lrint(cScale * -kb / (2.0 * (1.0 - kr)));
+
+	// Black offsets use the rounded coefficients, so that RGB black maps exactly to YCbCr black
+	const int32_t rgbBlack	= (int32_t)rgb.black;
+	const int32_t round		= 1 << (kRGBToYUVShift - 1);
+
+	coefficients.yOffset	= ((int32_t)yuv.black << kRGBToYUVShift) + round
+							  - rgbBlack * (coefficients.rgbToY[0] + coefficients.rgbToY[1] + coefficients.rgbToY[2]);
+	coefficients.cbOffset	= (kChromaZero << kRGBToYUVShift) + round
+							  - rgbBlack * (coefficients.rgbToCb[0] + coefficients.rgbToCb[1] + coefficients.rgbToCb[2]);
+	coefficients.crOffset	= (kChromaZero << kRGBToYUVShift) + round
+							  - rgbBlack * (coefficients.rgbToCr[0] + coefficients.rgbToCr[1] + coefficients.rgbToCr[2]);
+}
+
+static inline uint32_t Average(uint32_t a, uint32_t b)
+{
+	return (a + b + 1) >> 1;
+}
+
+static inline uint16_t ClampRGB(int32_t value)
+{
+	return (uint16_t)std::min(std::max(value, 0), 0xFFFF);
+}
+
+static inline uint16_t ClampYUV(int32_t value)
+{
+	return (uint16_t)std::min(std::max(value, (int32_t)kMinYUVCode), (int32_t)kMaxYUVCode);
+}
+
+// Chroma of pixel x from 4:2:2 samples
+static inline int32_t UpsampleChroma(const uint16_t* chroma, uint32_t x, uint32_t chromaCount, ChromaSiting siting)
+{
+	const uint32_t	k		= x / 2;
+	const uint32_t	next	= std::min(k + 1, chromaCount - 1);
+
+	if (siting == kChromaSitingCosited)
+		return (x & 1) ? Average(chroma[k], chroma[next]) : chroma[k];
+
+	// Interstitial samples are 1/4 pixel from each pixel of their pair
+	uint32_t neighbour = (x & 1) ? chroma[next] : chroma[(k > 0) ? k - 1 : 0];
+	return (3 * chroma[k] + neighbour + 2) >> 2;
+}
+
+// RGB sample at the chroma position of pixel pair k
+static inline int32_t DownsampleRGB(const uint16_t* samples, uint32_t k, uint32_t width, ChromaSiting siting)
+{
+	const uint32_t	x		= k * 2;
+	const uint32_t	next	= samples[std::min(x + 1, width - 1)];
+
+	if (siting == kChromaSitingCosited)
+		return Average(Average(samples[(x > 0) ? x - 1 : 0], next), samples[x]);
+
+	return Average(samples[x], next);
+}
+
+void ConvertYUV422ToRGBScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+							  uint32_t startPixel, uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	const uint32_t chromaCount = (width + 1) / 2;
+
+	for (uint32_t x = startPixel; x < width; x++)
+	{
+		int32_t y	= luma[x] * coefficients.yToRGB + coefficients.rgbOffset;
+		int32_t u	= UpsampleChroma(cb, x, chromaCount, coefficients.chromaSiting) - kChromaZero;
+		int32_t v	= UpsampleChroma(cr, x, chromaCount, coefficients.chromaSiting) - kChromaZero;
+
+		red[x]		= ClampRGB((y + v * coefficients.crToRed) >> kYUVToRGBShift);
+		green[x]	= ClampRGB((y + u * coefficients.cbToGreen + v * coefficients.crToGreen) >> kYUVToRGBShift);
+		blue[x]		= ClampRGB((y + u * coefficients.cbToBlue) >> kYUVToRGBShift);
+	}
+}
+
+void ConvertRGBToYUV422Scalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+							  uint32_t startPixel, uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	for (uint32_t x = startPixel; x < width; x++)
+	{
+		int32_t r = red[x];
+		int32_t g = green[x];
+		int32_t b = blue[x];
+
+		luma[x] = ClampYUV((r * coefficients.rgbToY[0] + g * coefficients.rgbToY[1] + b * coefficients.rgbToY[2] + coefficients.yOffset) >> kRGBToYUVShift);
+
+		if ((x & 1) == 0)
+		{
+			r = DownsampleRGB(red, x / 2, width, coefficients.chromaSiting);
+			g = DownsampleRGB(green, x / 2, width, coefficients.chromaSiting);
+			b = DownsampleRGB(blue, x / 2, width, coefficients.chromaSiting);
+
+			cb[x / 2] = ClampYUV((r * coefficients.rgbToCb[0] + g * coefficients.rgbToCb[1] + b * coefficients.rgbToCb[2] + coefficients.cbOffset) >> kRGBToYUVShift);
+			cr[x / 2] = ClampYUV((r * coefficients.rgbToCr[0] + g * coefficients.rgbToCr[1] + b * coefficients.rgbToCr[2] + coefficients.crOffset) >> kRGBToYUVShift);
+		}
+	}
+}
@@ -0,0 +1,370 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <string.h>
+#include <algorithm>
+#include "Compositor.h"
+#include "VideoConversion.h"
+
+// v210 packs 48 pixels in 128 bytes, spans of the overlay are aligned to these blocks so that they can be
+// unpacked and packed without touching the pixels either side
+static const uint32_t	kV210BlockPixels	= 48;
+static const uint32_t	kV210BlockBytes		= 128;
+
+// Key weights are scaled by 2^10, as the composite kernel
+static const uint32_t	kKeyScale			= 1024;
+
+// Transparent overlay, black fill with zero key
+static const uint16_t	kBlackLuma			= 64;
+static const uint16_t	kZeroChroma			= 512;
+
+// BGRA graphics are converted with a margin either side of the dirty region for the chroma filter
+static const uint32_t	kChromaFilterMargin	= 2;
+
+static inline uint32_t LoadBE32(const uint8_t* bytes)
+{
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return __builtin_bswap32(value);
+}
+
+static inline void StoreBE32(uint8_t* bytes, uint32_t value)
+{
+	value = __builtin_bswap32(value);
+	memcpy(bytes, &value, sizeof(value));
+}
+
+// 10-bit key to weight of the fill, 0-1024
+static inline uint32_t KeyWeight(uint16_t alpha)
+{
+	return alpha + (alpha >> 9);
+}
+
+static inline uint16_t Premultiply(uint16_t sample, uint32_t weight)
+{
+	return (uint16_t)((sample * weight + kKeyScale / 2) / kKeyScale);
+}
+
+KeyingCompositor::KeyingCompositor(uint32_t width, uint32_t height, ColorimetryMatrix matrix) :
+	m_width(width),
+	m_height(height),
+	m_nextVersion(1)
+{
+	// Graphics are full range RGB, keyed over video range YCbCr
+	Colorimetry colorimetry = { matrix, kColorimetryNarrowRange, kColorimetryFullRange, kChromaSitingCosited };
+
+	GetColorimetryCoefficients(colorimetry, m_colorimetry);
+
+	std::shared_ptr<OverlayRow> transparentRow = CreateTransparentRow();
+
+	transparentRow->version = m_nextVersion++;
+	m_rows = std::make_shared<OverlayRows>(m_height, transparentRow);
+}
+
+std::shared_ptr<const KeyingCompositor::OverlayRows> KeyingCompositor::GetRows() const
+{
+	std::lock_guard<std::mutex> lock(m_rowsMutex);
+	return m_rows;
+}
+
+std::shared_ptr<KeyingCompositor::OverlayRow> KeyingCompositor::CreateTransparentRow() const
+{
+	std::shared_ptr<OverlayRow>	row				= std::make_shared<OverlayRow>();
+	uint32_t					chromaWidth		= (m_width + 1) / 2;
+
+	row->version	= 0;
+	row->spanStart	= 0;
+	row->spanEnd	= 0;
+	row->luma.assign(m_width, kBlackLuma);
+	row->cb.assign(chromaWidth, kZeroChroma);
+	row->cr.assign(chromaWidth, kZeroChroma);
+	row->alpha.assign(m_width, 0);
+	row->fillLuma.assign(m_width, 0);
+	row->fillCb.assign(chromaWidth, 0);
+	row->fillCr.assign(chromaWidth, 0);
+	row->inverseLumaKey.assign(m_width, kKeyScale);
+	row->inverseChromaKey.assign(chromaWidth, kKeyScale);
+
+	return row;
+}
+
+void KeyingCompositor::ConvertBGRA(const uint8_t* bgraRow, OverlayRow& row, uint32_t start, uint32_t end, bool premultipliedAlpha) const
+{
+	// Convert from an even pixel before the region to a pixel after it, so that chroma in the region is
+	// filtered as if the whole row was converted
+	uint32_t				convertStart	= (start >= kChromaFilterMargin) ? start - kChromaFilterMargin : 0;
+	uint32_t				convertEnd		= std::min(end + kChromaFilterMargin, m_width);
+	uint32_t				count			= convertEnd - convertStart;
+	std::vector<uint16_t>	red(count);
+	std::vector<uint16_t>	green(count);
+	std::vector<uint16_t>	blue(count);
+	std::vector<uint16_t>	luma(count);
+	std::vector<uint16_t>	cb((count + 1) / 2);
+	std::vector<uint16_t>	cr((count + 1) / 2);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const uint8_t*	pixel	= bgraRow + (convertStart + i) * 4;
+		uint32_t		alpha	= pixel[3];
+		uint32_t		rgb[3]	= { pixel[2], pixel[1], pixel[0] };
+
+		// Keying needs the straight fill, which is undefined where the graphics are transparent
+		if (premultipliedAlpha)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+				rgb[c] = (alpha == 0) ? 0 : std::min(255u, (rgb[c] * 255 + alpha / 2) / alpha);
+		}
+
+		red[i]		= (uint16_t)(rgb[0] * 257);
+		green[i]	= (uint16_t)(rgb[1] * 257);
+		blue[i]		= (uint16_t)(rgb[2] * 257);
+
+		if ((convertStart + i >= start) && (convertStart + i < end))
+			row.alpha[convertStart + i] = (uint16_t)((alpha * 1023 + 127) / 255);
+	}
+
+	ConvertRGBRowToYUV422(red.data(), green.data(), blue.data(), luma.data(), cb.data(), cr.data(), count, m_colorimetry);
+
+	for (uint32_t x = start; x < end; x++)
+		row.luma[x] = luma[x - convertStart];
+
+	for (uint32_t x = start; x < end; x += 2)
+	{
+		row.cb[x / 2] = cb[(x - convertStart) / 2];
+		row.cr[x / 2] = cr[(x - convertStart) / 2];
+	}
+}
+
+void KeyingCompositor::ConvertAy10(const uint8_t* ay10Row, OverlayRow& row, uint32_t start, uint32_t end) const
+{
+	// Ay10 is a big-endian word per pixel, A << 20 | C << 10 | Y, where C is Cb for even pixels and Cr for odd pixels
+	for (uint32_t x = start; x < end; x++)
+	{
+		uint32_t word = LoadBE32(ay10Row + x * 4);
+
+		row.luma[x]		= word & 0x3FF;
+		row.alpha[x]	= (word >> 20) & 0x3FF;
+
+		if (x & 1)
+			row.cr[x / 2] = (word >> 10) & 0x3FF;
+		else
+			row.cb[x / 2] = (word >> 10) & 0x3FF;
+	}
+}
+
+void KeyingCompositor::PremultiplyRow(OverlayRow& row, uint32_t start, uint32_t end) const
+{
+	uint32_t first	= m_width;
+	uint32_t last	= 0;
+
+	for (uint32_t x = start; x < end; x++)
+	{
+		uint32_t weight = KeyWeight(row.alpha[x]);
+
+		row.fillLuma[x]			= Premultiply(row.luma[x], weight);
+		row.inverseLumaKey[x]	= (uint16_t)(kKeyScale - weight);
+	}
+
+	// Chroma is keyed with the average weight of each pair of pixels, start is even
+	for (uint32_t x = start; x < end; x += 2)
+	{
+		uint32_t weight0	= KeyWeight(row.alpha[x]);
+		uint32_t weight1	= (x + 1 < m_width) ? KeyWeight(row.alpha[x + 1]) : weight0;
+		uint32_t weight		= (weight0 + weight1 + 1) / 2;
+
+		row.fillCb[x / 2]			= Premultiply(row.cb[x / 2], weight);
+		row.fillCr[x / 2]			= Premultiply(row.cr[x / 2], weight);
+		row.inverseChromaKey[x / 2]	= (uint16_t)(kKeyScale - weight);
+	}
+
+	for (uint32_t x = 0; x < m_width; x++)
+	{
+		if (row.inverseLumaKey[x] != kKeyScale)
+		{
+			first	= std::min(first, x);
+			last	= x;
+		}
+	}
+
+	if (first < m_width)
+	{
+		row.spanStart	= (first / kV210BlockPixels) * kV210BlockPixels;
+		row.spanEnd		= std::min(((last / kV210BlockPixels) + 1) * kV210BlockPixels, m_width);
+	}
+	else
+	{
+		row.spanStart	= 0;
+		row.spanEnd		= 0;
+	}
+}
+
+HRESULT KeyingCompositor::UpdateOverlay(BMDPixelFormat pixelFormat, const void* graphics, long rowBytes, const OverlayRect& dirtyRect, bool premultipliedAlpha)
+{
+	std::shared_ptr<OverlayRows>	rows;
+	uint64_t						version;
+	uint32_t						start;
+	uint32_t						end;
+
+	if ((pixelFormat != bmdFormat8BitBGRA) && (pixelFormat != bmdFormat10BitYUVA))
+		return E_INVALIDARG;
+
+	if ((graphics == nullptr) || (rowBytes < (long)m_width * 4))
+		return E_INVALIDARG;
+
+	if ((dirtyRect.x > m_width) || (dirtyRect.width > m_width - dirtyRect.x) ||
+		(dirtyRect.y > m_height) || (dirtyRect.height > m_height - dirtyRect.y))
+		return E_INVALIDARG;
+
+	if ((dirtyRect.width == 0) || (dirtyRect.height == 0))
+		return S_OK;
+
+	// Update whole chroma samples
+	start	= dirtyRect.x & ~1u;
+	end		= std::min((dirtyRect.x + dirtyRect.width + 1) & ~1u, m_width);
+
+	std::lock_guard<std::mutex> updateLock(m_updateMutex);
+
+	rows = std::make_shared<OverlayRows>(*GetRows());
+
+	{
+		std::lock_guard<std::mutex> lock(m_rowsMutex);
+		version = m_nextVersion++;
+	}
+
+	for (uint32_t y = dirtyRect.y; y < dirtyRect.y + dirtyRect.height; y++)
+	{
+		const uint8_t*				graphicsRow	= (const uint8_t*)graphics + (size_t)y * rowBytes;
+		std::shared_ptr<OverlayRow>	row			= std::make_shared<OverlayRow>(*(*rows)[y]);
+
+		row->version = version;
+
+		if (pixelFormat == bmdFormat8BitBGRA)
+			ConvertBGRA(graphicsRow, *row, start, end, premultipliedAlpha);
+		else
+			ConvertAy10(graphicsRow, *row, start, end);
+
+		PremultiplyRow(*row, start, end);
+
+		(*rows)[y] = row;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_rowsMutex);
+		m_rows = rows;
+	}
+
+	return S_OK;
+}
+
+void KeyingCompositor::ClearOverlay()
+{
+	std::lock_guard<std::mutex>	updateLock(m_updateMutex);
+	std::shared_ptr<OverlayRow>	transparentRow	= CreateTransparentRow();
+	std::lock_guard<std::mutex>	lock(m_rowsMutex);
+
+	transparentRow->version = m_nextVersion++;
+	m_rows = std::make_shared<OverlayRows>(m_height, transparentRow);
+}
+
+HRESULT KeyingCompositor::CompositeV210(void* v210Frame, long rowBytes) const
+{
+	std::shared_ptr<const OverlayRows>	rows		= GetRows();
+	uint32_t							chromaWidth	= (m_width + 1) / 2;
+	std::vector<uint16_t>				luma(m_width);
+	std::vector<uint16_t>				cb(chromaWidth);
+	std::vector<uint16_t>				cr(chromaWidth);
+
+	if ((v210Frame == nullptr) || (rowBytes < (long)V210RowBytes(m_width)))
+		return E_INVALIDARG;
+
+	for (uint32_t y = 0; y < m_height; y++)
+	{
+		const OverlayRow&	row			= *(*rows)[y];
+		uint32_t			count		= row.spanEnd - row.spanStart;
+		uint32_t			chromaStart	= row.spanStart / 2;
+		uint32_t			chromaCount	= (count + 1) / 2;
+		uint8_t*			v210Row;
+
+		if (count == 0)
+			continue;
+
+		v210Row = (uint8_t*)v210Frame + (size_t)y * rowBytes + (row.spanStart / kV210BlockPixels) * kV210BlockBytes;
+
+		UnpackV210Row(v210Row, luma.data(), cb.data(), cr.data(), count);
+
+		CompositeRow(luma.data(), row.fillLuma.data() + row.spanStart, row.inverseLumaKey.data() + row.spanStart, luma.data(), count);
+		CompositeRow(cb.data(), row.fillCb.data() + chromaStart, row.inverseChromaKey.data() + chromaStart, cb.data(), chromaCount);
+		CompositeRow(cr.data(), row.fillCr.data() + chromaStart, row.inverseChromaKey.data() + chromaStart, cr.data(), chromaCount);
+
+		PackV210Row(luma.data(), cb.data(), cr.data(), v210Row, count);
+	}
+
+	return S_OK;
+}
+
+HRESULT KeyingCompositor::RenderAy10(void* ay10Frame, long rowBytes, std::vector<uint64_t>& renderedVersions) const
+{
+	std::shared_ptr<const OverlayRows> rows = GetRows();
+
+	if ((ay10Frame == nullptr) || (rowBytes < GetPixelFormatRowBytes(bmdFormat10BitYUVA, m_width)))
+		return E_INVALIDARG;
+
+	renderedVersions.resize(m_height, 0);
+
+	for (uint32_t y = 0; y < m_height; y++)
+	{
+		const OverlayRow&	row		= *(*rows)[y];
+		uint8_t*			ay10Row	= (uint8_t*)ay10Frame + (size_t)y * rowBytes;
+
+		if (renderedVersions[y] == row.version)
+			continue;
+
+		for (uint32_t x = 0; x < m_width; x++)
+		{
+			uint32_t chroma = (x & 1) ? row.cr[x / 2] : row.cb[x / 2];
+
+			StoreBE32(ay10Row + x * 4, ((uint32_t)row.alpha[x] << 20) | ((uint32_t)chroma << 10) | row.luma[x]);
+		}
+
+		renderedVersions[y] = row.version;
+	}
+
+	return S_OK;
+}
@@ -0,0 +1,126 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "VideoKernels.h"
+
+// KeyingCompositor keys graphics over 10-bit YUV video on the CPU.
+//
+// The overlay is a frame of graphics the size of the video, in BGRA or Ay10.  It is converted once to
+// 4:2:2 planes of premultiplied fill and inverse key, which CompositeV210() blends over each v210 video
+// frame in place with the SIMD composite kernel.  For each row the compositor keeps the span of 48 pixel
+// v210 blocks which are not fully transparent, rows without graphics are not touched.
+//
+// UpdateOverlay() is given the rectangle of graphics which changed, only the rows in it are converted
+// again.  Rows are immutable once converted and shared between versions of the overlay, so frames can be
+// composited concurrently with each other and with overlay updates.
+//
+// For keying by the DeckLink keyer (IDeckLinkKeyer) or an external keyer, RenderAy10() writes the overlay
+// as an Ay10 fill and key frame, rewriting only the rows which changed since the frame was last rendered.
+
+struct OverlayRect
+{
+	uint32_t	x;
+	uint32_t	y;
+	uint32_t	width;
+	uint32_t	height;
+};
+
+class KeyingCompositor
+{
+public:
+	KeyingCompositor(uint32_t width, uint32_t height, ColorimetryMatrix matrix);
+
+	uint32_t	GetWidth(void) const { return m_width; }
+	uint32_t	GetHeight(void) const { return m_height; }
+
+	// Update the overlay from graphics of bmdFormat8BitBGRA or bmdFormat10BitYUVA, the size of the video frame.
+	// dirtyRect is the region which changed since the last update.  BGRA is full range RGB with premultiplied
+	// or straight alpha, Ay10 has straight alpha.
+	HRESULT		UpdateOverlay(BMDPixelFormat pixelFormat, const void* graphics, long rowBytes, const OverlayRect& dirtyRect, bool premultipliedAlpha);
+	void		ClearOverlay(void);
+
+	// Composite the overlay over a v210 frame in place
+	HRESULT		CompositeV210(void* v210Frame, long rowBytes) const;
+
+	// Render the overlay to an Ay10 frame.  renderedVersions is kept with each frame, it holds the version of
+	// each row last rendered to the frame and is empty for a new frame.
+	HRESULT		RenderAy10(void* ay10Frame, long rowBytes, std::vector<uint64_t>& renderedVersions) const;
+
+private:
+	// One row of the overlay, planes are 10-bit 4:2:2
+	struct OverlayRow
+	{
+		uint64_t				version;
+		uint32_t				spanStart;				// Pixels spanStart to spanEnd are not fully transparent, aligned to v210 blocks
+		uint32_t				spanEnd;
+		std::vector<uint16_t>	luma;					// Straight fill and key, for Ay10
+		std::vector<uint16_t>	cb;
+		std::vector<uint16_t>	cr;
+		std::vector<uint16_t>	alpha;
+		std::vector<uint16_t>	fillLuma;				// Premultiplied fill and inverse key, for compositing
+		std::vector<uint16_t>	fillCb;
+		std::vector<uint16_t>	fillCr;
+		std::vector<uint16_t>	inverseLumaKey;
+		std::vector<uint16_t>	inverseChromaKey;
+	};
+
+	using OverlayRows = std::vector<std::shared_ptr<const OverlayRow>>;
+
+	uint32_t							m_width;
+	uint32_t							m_height;
+	ColorimetryCoefficients				m_colorimetry;
+
+	std::shared_ptr<const OverlayRows>	m_rows;
+	uint64_t							m_nextVersion;
+	mutable std::mutex					m_rowsMutex;			// Guards m_rows and m_nextVersion
+	std::mutex							m_updateMutex;			// Serializes overlay updates
+
+	std::shared_ptr<const OverlayRows>	GetRows(void) const;
+	std::shared_ptr<OverlayRow>			CreateTransparentRow(void) const;
+	void								ConvertBGRA(const uint8_t* bgraRow, OverlayRow& row, uint32_t start, uint32_t end, bool premultipliedAlpha) const;
+	void								ConvertAy10(const uint8_t* ay10Row, OverlayRow& row, uint32_t start, uint32_t end) const;
+	void								PremultiplyRow(OverlayRow& row, uint32_t start, uint32_t end) const;
+};
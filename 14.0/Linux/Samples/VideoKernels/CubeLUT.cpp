@@ -0,0 +1,185 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include "CubeLUT.h"
+
+static const uint32_t	kMinLUT3DSize	= 2;
+
+CubeLUT::CubeLUT() :
+	m_size(0),
+	m_domainMin { 0.0f, 0.0f, 0.0f },
+	m_domainMax { 1.0f, 1.0f, 1.0f }
+{
+}
+
+HRESULT CubeLUT::LoadFile(const char* path)
+{
+	std::ifstream stream(path);
+
+	if (!stream)
+	{
+		fprintf(stderr, "Unable to open LUT file %s\n", path);
+		return E_FAIL;
+	}
+
+	return Load(stream, path);
+}
+
+HRESULT CubeLUT::Load(std::istream& stream, const char* name)
+{
+	std::string			title;
+	uint32_t			size			= 0;
+	float				domainMin[3]	= { 0.0f, 0.0f, 0.0f };
+	float				domainMax[3]	= { 1.0f, 1.0f, 1.0f };
+	std::vector<float>	table;
+	std::string			line;
+	uint32_t			lineNumber		= 0;
+
+	while (std::getline(stream, line))
+	{
+		std::istringstream	fields(line);
+		std::string			keyword;
+		std::string			extra;
+
+		lineNumber++;
+
+		if (!(fields >> keyword) || (keyword[0] == '#'))
+			continue;
+
+		if (keyword == "TITLE")
+		{
+			size_t first	= line.find('"');
+			size_t last		= line.rfind('"');
+
+			if ((first != std::string::npos) && (last > first))
+				title = line.substr(first + 1, last - first - 1);
+			continue;
+		}
+
+		if (keyword == "LUT_3D_SIZE")
+		{
+			if (!(fields >> size) || (size < kMinLUT3DSize) || (size > kMaxLUT3DSize) || !table.empty())
+			{
+				fprintf(stderr, "%s:%u: LUT_3D_SIZE must be %u to %u and precede the table\n", name, lineNumber, kMinLUT3DSize, kMaxLUT3DSize);
+				return E_INVALIDARG;
+			}
+			table.reserve((size_t)size * size * size * 3);
+			continue;
+		}
+
+		if (keyword == "LUT_1D_SIZE")
+		{
+			fprintf(stderr, "%s:%u: 1D LUTs are not supported\n", name, lineNumber);
+			return E_INVALIDARG;
+		}
+
+		// Resolve writes the same domain for each component as LUT_3D_INPUT_RANGE
+		if (keyword == "LUT_3D_INPUT_RANGE")
+		{
+			if (!(fields >> domainMin[0] >> domainMax[0]))
+			{
+				fprintf(stderr, "%s:%u: LUT_3D_INPUT_RANGE must have 2 values\n", name, lineNumber);
+				return E_INVALIDARG;
+			}
+			domainMin[1] = domainMin[2] = domainMin[0];
+			domainMax[1] = domainMax[2] = domainMax[0];
+			continue;
+		}
+
+		if ((keyword == "DOMAIN_MIN") || (keyword == "DOMAIN_MAX"))
+		{
+			float* domain = (keyword == "DOMAIN_MIN") ? domainMin : domainMax;
+
+			if (!(fields >> domain[0] >> domain[1] >> domain[2]))
+			{
+				fprintf(stderr, "%s:%u: %s must have 3 values\n", name, lineNumber, keyword.c_str());
+				return E_INVALIDARG;
+			}
+			continue;
+		}
+
+		// Any other line is a grid point of the table
+		std::istringstream	values(line);
+		float				rgb[3];
+
+		if (!(values >> rgb[0] >> rgb[1] >> rgb[2]) || (values >> extra))
+		{
+			fprintf(stderr, "%s:%u: Expected R G B values or a keyword\n", name, lineNumber);
+			return E_INVALIDARG;
+		}
+
+		if ((size == 0) || (table.size() == (size_t)size * size * size * 3))
+		{
+			fprintf(stderr, "%s:%u: Table has more values than LUT_3D_SIZE\n", name, lineNumber);
+			return E_INVALIDARG;
+		}
+
+		table.insert(table.end(), rgb, rgb + 3);
+	}
+
+	if ((size == 0) || (table.size() != (size_t)size * size * size * 3))
+	{
+		fprintf(stderr, "%s: Table has %zu of %u grid points\n", name, table.size() / 3, size * size * size);
+		return E_INVALIDARG;
+	}
+
+	for (int c = 0; c < 3; c++)
+	{
+		if (!(domainMax[c] > domainMin[c]))
+		{
+			fprintf(stderr, "%s: DOMAIN_MAX must be greater than DOMAIN_MIN\n", name);
+			return E_INVALIDARG;
+		}
+	}
+
+	m_title	= title;
+	m_size	= size;
+	m_table.swap(table);
+	for (int c = 0; c < 3; c++)
+	{
+		m_domainMin[c] = domainMin[c];
+		m_domainMax[c] = domainMax[c];
+	}
+
+	return S_OK;
+}
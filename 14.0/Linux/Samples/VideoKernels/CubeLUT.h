@@ -0,0 +1,89 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "VideoKernels.h"
+
+// CubeLUT loads a 3D lookup table from a .cube file, as exported by grading applications for show looks and
+// camera matching.  The file has keyword lines and one line of R, G and B output values for each grid point,
+// with red changing fastest:
+//
+//   # Comment
+//   TITLE "Show look"
+//   LUT_3D_SIZE 33
+//   DOMAIN_MIN 0.0 0.0 0.0
+//   DOMAIN_MAX 1.0 1.0 1.0
+//   0.0 0.0 0.0
+//   ...
+//
+// Tables of 2 to kMaxLUT3DSize grid points are supported, including the common 17, 33 and 65 point sizes.
+// The domain is the input value of the first and last grid points, 0 to 1 if not given, or the same for
+// each component with LUT_3D_INPUT_RANGE.  1D tables (LUT_1D_SIZE) are not supported.  Output values are in the order of LUT3D entries, see VideoKernels.h.
+class CubeLUT
+{
+public:
+	CubeLUT();
+
+	// Load a .cube file or stream.  Returns E_INVALIDARG, and prints the line in error, if it is not a
+	// supported 3D table, or E_FAIL if the file cannot be opened.  The table is unchanged on failure.
+	HRESULT						LoadFile(const char* path);
+	HRESULT						Load(std::istream& stream, const char* name = "<stream>");
+
+	bool						IsLoaded(void) const { return m_size != 0; }
+	const std::string&			GetTitle(void) const { return m_title; }
+	uint32_t					GetSize(void) const { return m_size; }
+	const float*				GetDomainMin(void) const { return m_domainMin; }
+	const float*				GetDomainMax(void) const { return m_domainMax; }
+
+	// size^3 R, G and B output values, red fastest
+	const std::vector<float>&	GetTable(void) const { return m_table; }
+
+private:
+	std::string					m_title;
+	uint32_t					m_size;
+	float						m_domainMin[3];
+	float						m_domainMax[3];
+	std::vector<float>			m_table;
+};
@@ -0,0 +1,233 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <string.h>
+#include <algorithm>
+#include "Deinterlacer.h"
+
+// Planes are padded to whole v210 blocks of 48 pixels for the unpack and pack kernels
+static const uint32_t	kV210BlockPixels	= 48;
+
+// Samples repeated beyond each edge of an unpacked plane, the kernel reads 3 samples beyond the row
+static const uint32_t	kEdgeSamples		= 8;
+
+// Rows of each input frame in the window of the kernel, from two above to two below a missing row
+static const uint32_t	kRingRowCount		= 8;
+
+static inline uint32_t PaddedSampleCount(uint32_t count)
+{
+	return ((count + kV210BlockPixels - 1) / kV210BlockPixels) * kV210BlockPixels;
+}
+
+static void ExtendEdges(uint16_t* plane, uint32_t count)
+{
+	std::fill(plane - kEdgeSamples, plane, plane[0]);
+	std::fill(plane + count, plane + count + kEdgeSamples, plane[count - 1]);
+}
+
+static DeinterlaceRows OffsetRows(const DeinterlaceRows& rows, uint32_t offset)
+{
+	DeinterlaceRows offsetRows;
+
+	offsetRows.above			= rows.above + offset;
+	offsetRows.below			= rows.below + offset;
+	offsetRows.previousAbove	= rows.previousAbove + offset;
+	offsetRows.previousBelow	= rows.previousBelow + offset;
+	offsetRows.nextAbove		= rows.nextAbove + offset;
+	offsetRows.nextBelow		= rows.nextBelow + offset;
+	offsetRows.earlier			= rows.earlier + offset;
+	offsetRows.later			= rows.later + offset;
+	offsetRows.earlierAbove		= rows.earlierAbove + offset;
+	offsetRows.earlierBelow		= rows.earlierBelow + offset;
+	offsetRows.laterAbove		= rows.laterAbove + offset;
+	offsetRows.laterBelow		= rows.laterBelow + offset;
+
+	return offsetRows;
+}
+
+Deinterlacer::Deinterlacer(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, BMDFieldDominance fieldDominance, DeinterlacerRate rate, unsigned threadCount) :
+	m_width(width),
+	m_height(height),
+	m_chromaWidth((width + 1) / 2),
+	m_pixelFormat(pixelFormat),
+	m_rate(rate),
+	m_firstFieldParity((fieldDominance == bmdLowerFieldFirst) ? 1 : 0),
+	m_workerPool(threadCount)
+{
+	m_packedRowBytes	= (pixelFormat == bmdFormat10BitYUV) ? V210RowBytes(width) : m_chromaWidth * 4;
+
+	m_lumaStride		= PaddedSampleCount(width) + kEdgeSamples * 2;
+	m_chromaStride		= PaddedSampleCount(width) / 2 + kEdgeSamples * 2;
+	m_unpackedRowSize	= m_lumaStride + m_chromaStride * 2;
+
+	m_threadRows.resize(m_workerPool.GetThreadCount());
+	for (ThreadRows& rows : m_threadRows)
+	{
+		rows.unpackedRows.resize((size_t)kInputFrameCount * kRingRowCount * m_unpackedRowSize);
+		rows.unpackedRowIndex.resize(kInputFrameCount * kRingRowCount);
+		rows.dstLuma.resize(PaddedSampleCount(width));
+		rows.dstCb.resize(PaddedSampleCount(width) / 2);
+		rows.dstCr.resize(PaddedSampleCount(width) / 2);
+	}
+}
+
+HRESULT Deinterlacer::DeinterlaceFrame(const void* previousFrame, const void* currentFrame, const void* nextFrame, long srcRowBytes,
+									   uint32_t outputIndex, void* dstFrame, long dstRowBytes)
+{
+	const uint8_t* srcFrames[kInputFrameCount];
+
+	if ((currentFrame == NULL) || (dstFrame == NULL))
+		return E_POINTER;
+
+	if ((m_pixelFormat != bmdFormat10BitYUV) && (m_pixelFormat != bmdFormat8BitYUV))
+		return E_INVALIDARG;
+
+	if ((outputIndex >= GetOutputFrameCount()) || (srcRowBytes < (long)m_packedRowBytes) || (dstRowBytes < (long)m_packedRowBytes))
+		return E_INVALIDARG;
+
+	srcFrames[kPreviousFrame]	= (const uint8_t*)((previousFrame != NULL) ? previousFrame : currentFrame);
+	srcFrames[kCurrentFrame]	= (const uint8_t*)currentFrame;
+	srcFrames[kNextFrame]		= (const uint8_t*)((nextFrame != NULL) ? nextFrame : currentFrame);
+
+	// Each slice unpacks the rows in the window of its first missing row again
+	uint32_t sliceCount		= std::min<uint32_t>(m_height, m_workerPool.GetThreadCount() * 2);
+	uint32_t rowsPerSlice	= (m_height + sliceCount - 1) / sliceCount;
+	sliceCount				= (m_height + rowsPerSlice - 1) / rowsPerSlice;
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		uint32_t firstRow = slice * rowsPerSlice;
+		DeinterlaceSlice(m_threadRows[threadIndex], srcFrames, srcRowBytes, outputIndex, (uint8_t*)dstFrame, dstRowBytes,
+						 firstRow, std::min(rowsPerSlice, m_height - firstRow));
+	});
+
+	return S_OK;
+}
+
+const uint16_t* Deinterlacer::UnpackInputRow(ThreadRows& rows, const uint8_t* const* srcFrames, long srcRowBytes, InputFrame frame, uint32_t row)
+{
+	uint32_t	ringRow		= frame * kRingRowCount + row % kRingRowCount;
+	uint16_t*	unpacked	= rows.unpackedRows.data() + (size_t)ringRow * m_unpackedRowSize;
+	uint16_t*	luma		= unpacked + kEdgeSamples;
+	uint16_t*	cb			= unpacked + m_lumaStride + kEdgeSamples;
+	uint16_t*	cr			= unpacked + m_lumaStride + m_chromaStride + kEdgeSamples;
+
+	if (rows.unpackedRowIndex[ringRow] != (int32_t)row)
+	{
+		const uint8_t* srcRow = srcFrames[frame] + (size_t)row * srcRowBytes;
+
+		if (m_pixelFormat == bmdFormat10BitYUV)
+			UnpackV210Row(srcRow, luma, cb, cr, m_width);
+		else
+			Unpack2vuyRow(srcRow, luma, cb, cr, m_width);
+
+		ExtendEdges(luma, m_width);
+		ExtendEdges(cb, m_chromaWidth);
+		ExtendEdges(cr, m_chromaWidth);
+
+		rows.unpackedRowIndex[ringRow] = (int32_t)row;
+	}
+
+	return luma;
+}
+
+// Rows beyond the top and bottom of the frame are mirrored, so they have the parity of the row they replace
+uint32_t Deinterlacer::MirrorRow(uint32_t row, int offset) const
+{
+	int32_t mirrored = (int32_t)row + offset;
+
+	if ((mirrored < 0) || (mirrored >= (int32_t)m_height))
+		mirrored = (int32_t)row - offset;
+
+	if ((mirrored < 0) || (mirrored >= (int32_t)m_height))
+		mirrored = (int32_t)row;
+
+	return (uint32_t)mirrored;
+}
+
+void Deinterlacer::DeinterlaceSlice(ThreadRows& rows, const uint8_t* const* srcFrames, long srcRowBytes, uint32_t outputIndex,
+									uint8_t* dstFrame, long dstRowBytes, uint32_t firstRow, uint32_t rowCount)
+{
+	// The first output frame keeps the first field, with the other field of the previous and current frames
+	// on either side of it in time.  The second keeps the second field, between the current and next frames.
+	uint32_t	keptParity		= m_firstFieldParity ^ outputIndex;
+	InputFrame	earlierFrame	= (outputIndex == 0) ? kPreviousFrame : kCurrentFrame;
+	InputFrame	laterFrame		= (outputIndex == 0) ? kCurrentFrame : kNextFrame;
+
+	// Rows unpacked for a previous frame are stale
+	std::fill(rows.unpackedRowIndex.begin(), rows.unpackedRowIndex.end(), -1);
+
+	for (uint32_t y = firstRow; y < firstRow + rowCount; y++)
+	{
+		DeinterlaceRows	lumaRows;
+
+		if ((y & 1) == keptParity)
+		{
+			memcpy(dstFrame + (size_t)y * dstRowBytes, srcFrames[kCurrentFrame] + (size_t)y * srcRowBytes, m_packedRowBytes);
+			continue;
+		}
+
+		lumaRows.above			= UnpackInputRow(rows, srcFrames, srcRowBytes, kCurrentFrame, MirrorRow(y, -1));
+		lumaRows.below			= UnpackInputRow(rows, srcFrames, srcRowBytes, kCurrentFrame, MirrorRow(y, 1));
+		lumaRows.previousAbove	= UnpackInputRow(rows, srcFrames, srcRowBytes, kPreviousFrame, MirrorRow(y, -1));
+		lumaRows.previousBelow	= UnpackInputRow(rows, srcFrames, srcRowBytes, kPreviousFrame, MirrorRow(y, 1));
+		lumaRows.nextAbove		= UnpackInputRow(rows, srcFrames, srcRowBytes, kNextFrame, MirrorRow(y, -1));
+		lumaRows.nextBelow		= UnpackInputRow(rows, srcFrames, srcRowBytes, kNextFrame, MirrorRow(y, 1));
+		lumaRows.earlier		= UnpackInputRow(rows, srcFrames, srcRowBytes, earlierFrame, y);
+		lumaRows.later			= UnpackInputRow(rows, srcFrames, srcRowBytes, laterFrame, y);
+		lumaRows.earlierAbove	= UnpackInputRow(rows, srcFrames, srcRowBytes, earlierFrame, MirrorRow(y, -2));
+		lumaRows.earlierBelow	= UnpackInputRow(rows, srcFrames, srcRowBytes, earlierFrame, MirrorRow(y, 2));
+		lumaRows.laterAbove		= UnpackInputRow(rows, srcFrames, srcRowBytes, laterFrame, MirrorRow(y, -2));
+		lumaRows.laterBelow		= UnpackInputRow(rows, srcFrames, srcRowBytes, laterFrame, MirrorRow(y, 2));
+
+		// The chroma planes follow the luma plane of each unpacked row
+		DeinterlaceRows cbRows = OffsetRows(lumaRows, m_lumaStride);
+		DeinterlaceRows crRows = OffsetRows(lumaRows, m_lumaStride + m_chromaStride);
+
+		DeinterlaceRow(lumaRows, rows.dstLuma.data(), m_width);
+		DeinterlaceRow(cbRows, rows.dstCb.data(), m_chromaWidth);
+		DeinterlaceRow(crRows, rows.dstCr.data(), m_chromaWidth);
+
+		if (m_pixelFormat == bmdFormat10BitYUV)
+			PackV210Row(rows.dstLuma.data(), rows.dstCb.data(), rows.dstCr.data(), dstFrame + (size_t)y * dstRowBytes, m_width);
+		else
+			Pack2vuyRow(rows.dstLuma.data(), rows.dstCb.data(), rows.dstCr.data(), dstFrame + (size_t)y * dstRowBytes, m_width);
+	}
+}
@@ -0,0 +1,131 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoKernels.h"
+
+// Deinterlacer converts interlaced v210 and 2vuy frames to progressive frames with a motion adaptive
+// (YADIF) filter.
+//
+// Each output frame keeps the rows of one field and interpolates the rows of the other parity with the
+// deinterlace kernel, from the fields before and after it in time: static areas keep the other field and
+// moving areas are interpolated within the field along edges.  The time order of the fields is given by
+// the field dominance of the display mode.  At single rate one frame is output for each input frame, from
+// its first field, and at double rate one frame is output for each field.
+//
+// A field is interpolated from the previous, current and next input frames, so output is one frame behind
+// input and the caller holds the two most recent frames.  At the start and end of a sequence there is no
+// previous or next frame and the current frame is used in its place.
+//
+// Each frame is split into slices of output rows which are deinterlaced in parallel by a SliceWorkerPool.  A
+// thread keeps the rows it has unpacked from each input frame while they are in the window of the kernel,
+// rows of the kept field are copied from the current frame.
+
+enum DeinterlacerRate
+{
+	kDeinterlacerSingleRate = 0,	// One frame from the first field of each input frame
+	kDeinterlacerDoubleRate			// One frame from each field
+};
+
+class Deinterlacer
+{
+public:
+	// pixelFormat is bmdFormat10BitYUV or bmdFormat8BitYUV.  Fields are in the time order of bmdLowerFieldFirst,
+	// otherwise upper field first.  threadCount includes the calling thread, 0 selects the number of CPUs.
+	Deinterlacer(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, BMDFieldDominance fieldDominance, DeinterlacerRate rate, unsigned threadCount = 0);
+
+	uint32_t			GetWidth(void) const { return m_width; }
+	uint32_t			GetHeight(void) const { return m_height; }
+	BMDPixelFormat		GetPixelFormat(void) const { return m_pixelFormat; }
+	DeinterlacerRate	GetRate(void) const { return m_rate; }
+	unsigned			GetThreadCount(void) const { return m_workerPool.GetThreadCount(); }
+
+	// Frames output for each input frame, 1 at single rate or 2 at double rate
+	uint32_t			GetOutputFrameCount(void) const { return (m_rate == kDeinterlacerDoubleRate) ? 2 : 1; }
+
+	// Deinterlace output frame outputIndex of the current frame, below GetOutputFrameCount() in time order.
+	// previousFrame and nextFrame may be NULL at the start and end of a sequence.  Calls from multiple
+	// threads are serialized.
+	HRESULT				DeinterlaceFrame(const void* previousFrame, const void* currentFrame, const void* nextFrame, long srcRowBytes,
+										 uint32_t outputIndex, void* dstFrame, long dstRowBytes);
+
+private:
+	enum InputFrame
+	{
+		kPreviousFrame = 0,
+		kCurrentFrame,
+		kNextFrame,
+		kInputFrameCount
+	};
+
+	// Working rows of one thread
+	struct ThreadRows
+	{
+		std::vector<uint16_t>	unpackedRows;		// Unpacked rows of each input frame, a ring of window rows per frame
+		std::vector<int32_t>	unpackedRowIndex;	// Input row held by each row of the rings, -1 if none
+		std::vector<uint16_t>	dstLuma;
+		std::vector<uint16_t>	dstCb;
+		std::vector<uint16_t>	dstCr;
+	};
+
+	uint32_t					m_width;
+	uint32_t					m_height;
+	uint32_t					m_chromaWidth;
+	BMDPixelFormat				m_pixelFormat;
+	DeinterlacerRate			m_rate;
+	uint32_t					m_firstFieldParity;		// Parity of the rows of the first field in time
+	uint32_t					m_packedRowBytes;
+
+	uint32_t					m_lumaStride;			// Padded planes of an unpacked row
+	uint32_t					m_chromaStride;
+	uint32_t					m_unpackedRowSize;
+
+	SliceWorkerPool				m_workerPool;
+	std::vector<ThreadRows>		m_threadRows;			// Indexed by pool thread
+
+	const uint16_t*				UnpackInputRow(ThreadRows& rows, const uint8_t* const* srcFrames, long srcRowBytes, InputFrame frame, uint32_t row);
+	uint32_t					MirrorRow(uint32_t row, int offset) const;
+	void						DeinterlaceSlice(ThreadRows& rows, const uint8_t* const* srcFrames, long srcRowBytes, uint32_t outputIndex,
+												 uint8_t* dstFrame, long dstRowBytes, uint32_t firstRow, uint32_t rowCount);
+};
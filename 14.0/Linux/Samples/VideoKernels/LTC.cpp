@@ -0,0 +1,387 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "LTC.h"
+
+static const uint32_t	kLTCWordBits			= 80;
+static const uint64_t	kLTCSyncWord			= 0xBFFC;		// Bits 64-79, bit 64 in bit 0
+
+// Bits of the word for 30 (and 24) fps and for 25 fps LTC
+static const uint32_t	kDropFrameBit			= 10;
+static const uint32_t	kPolarityBit30			= 27;
+static const uint32_t	kPolarityBit25			= 59;
+
+// The peak level of LTC output, -12dBFS, and the level a decoded signal must cross to change state, -36dBFS
+static const double		kLTCAmplitude			= 0.25;
+static const int		kLTCThresholdShift		= 6;
+
+// Intervals between edges are a bit, for a 0, or half a bit, for each half of a 1.  Decoding starts from a bit
+// period between those of 30 and 24 fps, which is within the range of both, and follows the period of the bits
+// decoded.  Intervals longer than kMaxBitPeriods bits are a loss of signal.
+static const double		kNominalBitsPerSecond	= 80.0 * 27.0;
+static const double		kShortIntervalLimit		= 0.75;
+static const double		kMaxBitPeriods			= 1.5;
+static const double		kBitPeriodSmoothing		= 1.0 / 16.0;
+static const double		kMinBitPeriodRatio		= 0.7;
+static const double		kMaxBitPeriodRatio		= 1.4;
+
+static inline uint32_t GetWordBit(const uint64_t bits[2], uint32_t bit)
+{
+	return (uint32_t)(bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+static inline void SetWordBits(uint64_t bits[2], uint32_t firstBit, uint32_t count, uint32_t value)
+{
+	for (uint32_t i = 0; i < count; i++)
+		bits[(firstBit + i) / 64] |= (uint64_t)((value >> i) & 1) << ((firstBit + i) % 64);
+}
+
+static inline uint32_t GetWordBits(const uint64_t bits[2], uint32_t firstBit, uint32_t count)
+{
+	uint32_t value = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+		value |= GetWordBit(bits, firstBit + i) << i;
+
+	return value;
+}
+
+void PackLTCWord(const LTCTimecode& timecode, uint32_t framesPerSecond, uint64_t bits[2])
+{
+	// Timecode digits are interleaved with the 8 user bit groups, from bit 0: frame units, user bits, frame tens
+	// and the drop frame and colour frame flags, user bits, and so on to the hour tens
+	const uint32_t	digits[8]		= { (uint32_t)timecode.frames % 10, (uint32_t)timecode.frames / 10,
+										(uint32_t)timecode.seconds % 10, (uint32_t)timecode.seconds / 10,
+										(uint32_t)timecode.minutes % 10, (uint32_t)timecode.minutes / 10,
+										(uint32_t)timecode.hours % 10, (uint32_t)timecode.hours / 10 };
+	const uint32_t	digitBits[8]	= { 4, 2, 4, 3, 4, 3, 4, 2 };
+	const uint32_t	polarityBit		= (framesPerSecond == 25) ? kPolarityBit25 : kPolarityBit30;
+	uint32_t		ones			= 0;
+
+	bits[0] = 0;
+	bits[1] = kLTCSyncWord;
+
+	for (uint32_t group = 0; group < 8; group++)
+	{
+		SetWordBits(bits, group * 8, digitBits[group], digits[group]);
+		SetWordBits(bits, group * 8 + 4, 4, timecode.userBits >> (group * 4));
+	}
+
+	if (timecode.dropFrame && (framesPerSecond == 30))
+		SetWordBits(bits, kDropFrameBit, 1, 1);
+
+	// An even number of ones gives an even number of transitions in the word
+	for (uint32_t i = 0; i < 2; i++)
+		ones += __builtin_popcountll(bits[i]);
+
+	if (ones & 1)
+		SetWordBits(bits, polarityBit, 1, 1);
+}
+
+bool UnpackLTCWord(const uint64_t bits[2], LTCTimecode& timecode)
+{
+	uint32_t	frameUnits		= GetWordBits(bits, 0, 4);
+	uint32_t	secondUnits		= GetWordBits(bits, 16, 4);
+	uint32_t	minuteUnits		= GetWordBits(bits, 32, 4);
+	uint32_t	hourUnits		= GetWordBits(bits, 48, 4);
+	uint32_t	seconds			= GetWordBits(bits, 24, 3) * 10 + secondUnits;
+	uint32_t	minutes			= GetWordBits(bits, 40, 3) * 10 + minuteUnits;
+	uint32_t	hours			= GetWordBits(bits, 56, 2) * 10 + hourUnits;
+
+	if ((frameUnits > 9) || (secondUnits > 9) || (minuteUnits > 9) || (hourUnits > 9) || (seconds > 59) || (minutes > 59) || (hours > 23))
+		return false;
+
+	timecode.frames		= (uint8_t)(GetWordBits(bits, 8, 2) * 10 + frameUnits);
+	timecode.seconds	= (uint8_t)seconds;
+	timecode.minutes	= (uint8_t)minutes;
+	timecode.hours		= (uint8_t)hours;
+	timecode.dropFrame	= GetWordBit(bits, kDropFrameBit) != 0;
+	timecode.userBits	= 0;
+
+	for (uint32_t group = 0; group < 8; group++)
+		timecode.userBits |= GetWordBits(bits, group * 8 + 4, 4) << (group * 4);
+
+	return true;
+}
+
+LTCEncoder::LTCEncoder(BMDTimeValue frameDuration, BMDTimeScale timeScale, uint32_t sampleRate)
+{
+	LTCTimecode	timecode = { 0, 0, 0, 0, false, 0 };
+
+	m_framesPerSecond = std::max<uint32_t>((uint32_t)((timeScale + frameDuration / 2) / frameDuration), 1);
+
+	// Above 30 fps, an LTC frame spans two video frames
+	if (m_framesPerSecond > 30)
+	{
+		frameDuration		*= 2;
+		m_framesPerSecond	= (m_framesPerSecond + 1) / 2;
+	}
+
+	m_unitsPerBit		= (uint64_t)sampleRate * frameDuration;
+	m_unitsPerSample	= (uint64_t)kLTCWordBits * timeScale;
+	m_dropFrame			= ((timeScale % frameDuration) != 0) && (m_framesPerSecond == 30);
+
+	Reset(timecode);
+}
+
+void LTCEncoder::Reset(const LTCTimecode& timecode)
+{
+	m_timecode				= timecode;
+	m_timecode.dropFrame	= m_dropFrame;
+	m_position				= 0;
+	m_bit					= kLTCWordBits;			// The first sample starts bit 0, with a transition
+	m_midBit				= false;
+	m_high					= false;
+
+	PackLTCWord(m_timecode, m_framesPerSecond, m_bits);
+}
+
+void LTCEncoder::NextWord(void)
+{
+	LTCTimecode& timecode = m_timecode;
+
+	if (++timecode.frames >= m_framesPerSecond)
+	{
+		timecode.frames = 0;
+
+		if (++timecode.seconds == 60)
+		{
+			timecode.seconds = 0;
+
+			if (++timecode.minutes == 60)
+			{
+				timecode.minutes	= 0;
+				timecode.hours		= (timecode.hours + 1) % 24;
+			}
+
+			// Frames 0 and 1 are dropped at the start of each minute, except every tenth
+			if (timecode.dropFrame && ((timecode.minutes % 10) != 0))
+				timecode.frames = 2;
+		}
+	}
+
+	PackLTCWord(timecode, m_framesPerSecond, m_bits);
+}
+
+void LTCEncoder::Encode(void* samples, uint32_t sampleFrames, uint32_t channels, uint32_t channel, uint32_t sampleDepth)
+{
+	const double	amplitude = kLTCAmplitude * ((sampleDepth == 32) ? 2147483647.0 : 32767.0);
+
+	if (channel >= channels)
+		return;
+
+	for (uint32_t i = 0; i < sampleFrames; i++)
+	{
+		uint32_t	bit = (uint32_t)(m_position / m_unitsPerBit);
+		uint64_t	offset;
+		bool		one;
+		double		pastEdge;
+		double		nextEdge;
+		double		sample;
+
+		if (bit >= kLTCWordBits)
+		{
+			m_position -= kLTCWordBits * m_unitsPerBit;
+			bit = (uint32_t)(m_position / m_unitsPerBit);
+			NextWord();
+		}
+
+		offset	= m_position - bit * m_unitsPerBit;
+		one		= GetWordBit(m_bits, bit) != 0;
+
+		// Each bit starts with a transition, and a 1 has another in its middle
+		if (bit != m_bit)
+		{
+			m_bit		= bit;
+			m_midBit	= false;
+			m_high		= !m_high;
+		}
+
+		if (one && !m_midBit && (offset * 2 >= m_unitsPerBit))
+		{
+			m_midBit	= true;
+			m_high		= !m_high;
+		}
+
+		// Transitions are linear ramps over two samples, a 10-90% rise time of 33us at 48kHz against the 25us of
+		// SMPTE 12M, centred on the exact time of the transition.  The samples either side of it are always on the
+		// ramp, so the time is recovered exactly by interpolation.
+		pastEdge	= (one && m_midBit) ? m_unitsPerBit / 2.0 : 0.0;
+		nextEdge	= (one && !m_midBit) ? m_unitsPerBit / 2.0 : (double)m_unitsPerBit;
+		sample		= std::min(1.0, std::min(offset - pastEdge, nextEdge - offset) / m_unitsPerSample);
+		sample		*= m_high ? amplitude : -amplitude;
+
+		if (sampleDepth == 32)
+			((int32_t*)samples)[(size_t)i * channels + channel] = (int32_t)lrint(sample);
+		else
+			((int16_t*)samples)[(size_t)i * channels + channel] = (int16_t)lrint(sample);
+
+		m_position += m_unitsPerSample;
+	}
+}
+
+LTCDecoder::LTCDecoder(uint32_t channels, uint32_t sampleDepth, uint32_t channel, uint32_t sampleRate) :
+	m_channels(channels),
+	m_sampleDepth(sampleDepth),
+	m_channel(channel),
+	m_threshold((sampleDepth == 32) ? (INT32_MAX >> kLTCThresholdShift) : (INT16_MAX >> kLTCThresholdShift)),
+	m_nominalBitPeriod(sampleRate / kNominalBitsPerSecond),
+	m_high(false),
+	m_lastSample(0),
+	m_lastSampleTime(0.0),
+	m_lastZeroCrossing(0.0),
+	m_hasEdge(false),
+	m_lastEdge(0.0),
+	m_bitPeriod(m_nominalBitPeriod),
+	m_halfBit(false),
+	m_bitStart(0.0),
+	m_bitCount(0),
+	m_frameRead(0),
+	m_frameCount(0)
+{
+	m_bits[0] = 0;
+	m_bits[1] = 0;
+	std::fill(m_bitStarts, m_bitStarts + kLTCWordBits, 0.0);
+}
+
+void LTCDecoder::Decode(const void* samples, uint32_t sampleFrameCount, BMDTimeValue packetTime)
+{
+	if ((samples == NULL) || (m_channel >= m_channels))
+		return;
+
+	for (uint32_t i = 0; i < sampleFrameCount; i++)
+	{
+		size_t	index	= (size_t)i * m_channels + m_channel;
+		int32_t	sample	= (m_sampleDepth == 32) ? ((const int32_t*)samples)[index] : ((const int16_t*)samples)[index];
+		double	time	= (double)(packetTime + i);
+
+		// Edges are timed at the last zero crossing towards the other state, interpolated between the samples
+		// either side
+		if ((!m_high && (m_lastSample <= 0) && (sample > 0)) || (m_high && (m_lastSample >= 0) && (sample < 0)))
+			m_lastZeroCrossing = m_lastSampleTime + (time - m_lastSampleTime) * m_lastSample / ((double)m_lastSample - sample);
+
+		if ((!m_high && (sample > m_threshold)) || (m_high && (sample < -m_threshold)))
+		{
+			m_high = !m_high;
+			AddEdge(m_lastZeroCrossing);
+		}
+
+		m_lastSample		= sample;
+		m_lastSampleTime	= time;
+	}
+}
+
+bool LTCDecoder::GetFrame(LTCFrame& frame)
+{
+	if (m_frameCount == 0)
+		return false;
+
+	frame		= m_frames[m_frameRead];
+	m_frameRead	= (m_frameRead + 1) % kMaxFrames;
+	m_frameCount--;
+	return true;
+}
+
+void LTCDecoder::AddEdge(double time)
+{
+	double interval = time - m_lastEdge;
+
+	m_lastEdge = time;
+
+	if (!m_hasEdge || (interval >= kMaxBitPeriods * m_bitPeriod) || (interval <= 0.0))
+	{
+		// The first edge, or the first after a loss of signal, starts a bit
+		m_hasEdge	= true;
+		m_halfBit	= false;
+		m_bitStart	= time;
+		return;
+	}
+
+	if (interval < kShortIntervalLimit * m_bitPeriod)
+	{
+		// The second half of a 1 completes it, otherwise wait for it
+		if (m_halfBit)
+			AddBit(true, m_bitStart, time);
+
+		m_halfBit = !m_halfBit;
+	}
+	else if (m_halfBit)
+	{
+		// A whole bit after half a bit, the halves were paired across bits, so resynchronize on this edge
+		m_halfBit	= false;
+		m_bitStart	= time;
+	}
+	else
+	{
+		AddBit(false, m_bitStart, time);
+	}
+}
+
+void LTCDecoder::AddBit(bool one, double start, double end)
+{
+	m_bitPeriod += (end - start - m_bitPeriod) * kBitPeriodSmoothing;
+	m_bitPeriod = std::min(std::max(m_bitPeriod, m_nominalBitPeriod * kMinBitPeriodRatio), m_nominalBitPeriod * kMaxBitPeriodRatio);
+	m_bitStart	= end;
+
+	// Shift the bit in as bit 79, the oldest bit leaves from bit 0
+	m_bits[0] = (m_bits[0] >> 1) | (m_bits[1] << 63);
+	m_bits[1] = ((m_bits[1] >> 1) | ((uint64_t)one << 15)) & 0xFFFF;
+	m_bitStarts[m_bitCount % kLTCWordBits] = start;
+	m_bitCount++;
+
+	if ((m_bitCount < kLTCWordBits) || (m_bits[1] != kLTCSyncWord))
+		return;
+
+	LTCFrame&	frame = m_frames[(m_frameRead + m_frameCount) % kMaxFrames];
+
+	if (!UnpackLTCWord(m_bits, frame.timecode))
+		return;
+
+	// The start of bit 0 is the oldest start in the ring
+	frame.startTime	= m_bitStarts[m_bitCount % kLTCWordBits];
+	frame.duration	= end - frame.startTime;
+
+	if (m_frameCount < kMaxFrames)
+		m_frameCount++;
+	else
+		m_frameRead = (m_frameRead + 1) % kMaxFrames;
+}
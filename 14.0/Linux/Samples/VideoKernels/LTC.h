@@ -0,0 +1,159 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "DeckLinkAPI.h"
+
+// Linear timecode (SMPTE 12M) on an audio channel.  Each LTC frame is an 80-bit word: BCD timecode, 32 user
+// bits and flags in bits 0-63, then the sync word 0011 1111 1111 1101 in bits 64-79.  Bits are biphase mark
+// coded: the signal inverts at the start of each bit, and a 1 also inverts at the middle of the bit.
+//
+// LTCEncoder writes LTC into one channel of interleaved audio as it is scheduled, so any number of sample frames
+// may be encoded at a time.  Bit positions are counted exactly, in units of a 1 / (sampleRate * frameDuration) of
+// a bit, so the words stay in step with the video frames over any length of output.  LTC is defined up to 30 fps,
+// above 30 fps each LTC frame spans two video frames and counts at half the frame rate, as SMPTE 12M-2.
+//
+// LTCDecoder recovers timecode from one channel of captured audio packets.  Edges are found with hysteresis and
+// timed at the zero crossing interpolated between samples, bits are classified against a running estimate of the
+// bit period, so LTC from 24 to 30 fps is decoded with varispeed.  The start of each word, the start of bit 0, is
+// reported with sub-sample precision, which gives the phase of the LTC against the video frames.  LTC played in
+// reverse is not decoded.
+//
+// Neither allocates memory after construction, and neither is thread safe.
+
+struct LTCTimecode
+{
+	uint8_t		hours;
+	uint8_t		minutes;
+	uint8_t		seconds;
+	uint8_t		frames;
+	bool		dropFrame;
+	uint32_t	userBits;		// User bit groups 1-8, group 1 in bits 0-3
+};
+
+struct LTCFrame
+{
+	LTCTimecode	timecode;
+	double		startTime;		// Start of bit 0 of the word, in samples of the packet times
+	double		duration;		// Length of the word in samples, 1 / frame rate of the LTC at nominal speed
+};
+
+// Pack a timecode to the 80 bits of an LTC word, bit 0 of the word in bit 0 of bits[0].  The polarity correction
+// bit is set so that every word starts with the same polarity.
+void	PackLTCWord(const LTCTimecode& timecode, uint32_t framesPerSecond, uint64_t bits[2]);
+
+// Unpack an LTC word, returns false if the timecode is not valid BCD
+bool	UnpackLTCWord(const uint64_t bits[2], LTCTimecode& timecode);
+
+class LTCEncoder
+{
+public:
+	// LTC of video frames of frameDuration / timeScale seconds, starting at 00:00:00:00, drop frame at 29.97
+	LTCEncoder(BMDTimeValue frameDuration, BMDTimeScale timeScale, uint32_t sampleRate = 48000);
+
+	// Restart at the start of a word, with the timecode of the word.  The drop frame flag is set from the frame rate.
+	void				Reset(const LTCTimecode& timecode);
+
+	// Encode the next sampleFrames samples into channel, from 0, of interleaved audio of channels channels of
+	// 16 or 32-bit samples.  The other channels are not changed.
+	void				Encode(void* samples, uint32_t sampleFrames, uint32_t channels, uint32_t channel, uint32_t sampleDepth);
+
+	uint32_t			GetFramesPerSecond(void) const { return m_framesPerSecond; }
+
+private:
+	uint64_t			m_unitsPerBit;			// sampleRate * frame duration of the LTC
+	uint64_t			m_unitsPerSample;		// 80 * timeScale
+	uint64_t			m_position;				// Position in the word, up to 80 * m_unitsPerBit
+	uint32_t			m_framesPerSecond;		// Frames per second of the LTC, 30 at 29.97
+	bool				m_dropFrame;
+
+	LTCTimecode			m_timecode;				// Timecode of the current word
+	uint64_t			m_bits[2];
+	uint32_t			m_bit;					// Bit of m_position and whether its middle transition is done
+	bool				m_midBit;
+	bool				m_high;					// Level after the last transition
+
+	void				NextWord(void);
+};
+
+class LTCDecoder
+{
+public:
+	// channel is the LTC channel, from 0, of audio of channels channels of sampleDepth bits
+	LTCDecoder(uint32_t channels, uint32_t sampleDepth, uint32_t channel, uint32_t sampleRate = 48000);
+
+	// Decode the audio of a packet, with a packet time in samples
+	void				Decode(const void* samples, uint32_t sampleFrameCount, BMDTimeValue packetTime);
+
+	// Get the next decoded frame, returns false if there is none
+	bool				GetFrame(LTCFrame& frame);
+
+private:
+	static const uint32_t	kMaxFrames = 8;
+
+	uint32_t			m_channels;
+	uint32_t			m_sampleDepth;
+	uint32_t			m_channel;
+	int32_t				m_threshold;
+	double				m_nominalBitPeriod;
+
+	bool				m_high;					// Signal state, after hysteresis
+	int32_t				m_lastSample;
+	double				m_lastSampleTime;
+	double				m_lastZeroCrossing;
+	bool				m_hasEdge;
+	double				m_lastEdge;
+	double				m_bitPeriod;			// Running estimate, in samples
+	bool				m_halfBit;				// A short interval, the first half of a 1, has been seen
+	double				m_bitStart;
+
+	uint64_t			m_bits[2];				// Last 80 bits, the latest in bit 79
+	double				m_bitStarts[80];		// Start times of the last 80 bits, a ring indexed by m_bitCount
+	uint64_t			m_bitCount;
+
+	LTCFrame			m_frames[kMaxFrames];	// Ring of decoded frames
+	uint32_t			m_frameRead;
+	uint32_t			m_frameCount;
+
+	void				AddEdge(double time);
+	void				AddBit(bool one, double start, double end);
+};
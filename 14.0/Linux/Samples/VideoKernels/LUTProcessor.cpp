@@ -0,0 +1,231 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "LUTProcessor.h"
+
+// 16-bit video levels of RGB planes, see VideoConversion.h
+static const double		kVideoBlack		= 4096.0;
+static const double		kVideoWhite		= 60160.0;
+
+static inline uint16_t SampleFromValue(double value)
+{
+	return (uint16_t)lrint(std::min(std::max(value, 0.0), 1.0) * 65535.0);
+}
+
+static inline double LUT1DInput(uint32_t index)
+{
+	return std::min<uint32_t>(index * 16, 0xFFFF) / 65535.0;
+}
+
+LUTProcessor::LUTProcessor(uint32_t width, uint32_t height, unsigned threadCount) :
+	m_width(width),
+	m_height(height),
+	m_fullRangeShaperEnabled(false),
+	m_lut3D(),
+	m_colorspace(bmdColorspaceRec709),
+	m_workerPool(threadCount)
+{
+	Colorimetry colorimetry = { kColorimetryRec709, kColorimetryNarrowRange, kColorimetryFullRange, kChromaSitingCosited };
+
+	GetColorimetryCoefficients(colorimetry, m_yuvCoefficients);
+
+	for (int c = 0; c < 3; c++)
+	{
+		m_videoLevelShapers[c].resize(kLUT1DSize);
+		m_fullRangeShapers[c].resize(kLUT1DSize);
+	}
+
+	m_videoLevelOutput.resize(kLUT1DSize);
+	for (uint32_t i = 0; i < kLUT1DSize; i++)
+		m_videoLevelOutput[i] = (uint16_t)lrint(kVideoBlack + LUT1DInput(i) * (kVideoWhite - kVideoBlack));
+
+	m_rowPlanes.resize(m_workerPool.GetThreadCount());
+	for (RowPlanes& planes : m_rowPlanes)
+	{
+		planes.luma.resize(width);
+		planes.cb.resize((width + 1) / 2);
+		planes.cr.resize((width + 1) / 2);
+		planes.red.resize(width);
+		planes.green.resize(width);
+		planes.blue.resize(width);
+		planes.alpha.resize(width);
+	}
+}
+
+bool LUTProcessor::IsPixelFormatSupported(BMDPixelFormat pixelFormat)
+{
+	return GetPixelFormatRowBytes(pixelFormat, 1) != 0;
+}
+
+HRESULT LUTProcessor::SetLUT(const CubeLUT& lut)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!lut.IsLoaded())
+		return E_INVALIDARG;
+
+	const uint32_t				size		= lut.GetSize();
+	const std::vector<float>&	table		= lut.GetTable();
+	const float*				domainMin	= lut.GetDomainMin();
+	const float*				domainMax	= lut.GetDomainMax();
+
+	// The shapers map the domain of the table to the first and last grid points
+	m_fullRangeShaperEnabled = false;
+	for (int c = 0; c < 3; c++)
+	{
+		double scale = 1.0 / ((double)domainMax[c] - domainMin[c]);
+
+		for (uint32_t i = 0; i < kLUT1DSize; i++)
+		{
+			double videoLevelValue = (LUT1DInput(i) * 65535.0 - kVideoBlack) / (kVideoWhite - kVideoBlack);
+
+			m_videoLevelShapers[c][i]	= SampleFromValue((videoLevelValue - domainMin[c]) * scale);
+			m_fullRangeShapers[c][i]	= SampleFromValue((LUT1DInput(i) - domainMin[c]) * scale);
+		}
+
+		if ((domainMin[c] != 0.0f) || (domainMax[c] != 1.0f))
+			m_fullRangeShaperEnabled = true;
+	}
+
+	// The table is in the order of LUT3D entries, with red fastest
+	m_lut3DEntries.resize((size_t)size * size * size * 4);
+	for (size_t i = 0; i < (size_t)size * size * size; i++)
+	{
+		m_lut3DEntries[i * 4 + 0] = SampleFromValue(table[i * 3 + 0]);
+		m_lut3DEntries[i * 4 + 1] = SampleFromValue(table[i * 3 + 1]);
+		m_lut3DEntries[i * 4 + 2] = SampleFromValue(table[i * 3 + 2]);
+		m_lut3DEntries[i * 4 + 3] = 0;
+	}
+
+	m_lut3D.size	= size;
+	m_lut3D.entries	= m_lut3DEntries.data();
+
+	return S_OK;
+}
+
+HRESULT LUTProcessor::ApplyLUT(BMDPixelFormat pixelFormat, BMDColorspace colorspace, const void* srcFrame, long srcRowBytes, void* dstFrame, long dstRowBytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ((srcFrame == NULL) || (dstFrame == NULL))
+		return E_POINTER;
+
+	if (!IsPixelFormatSupported(pixelFormat) || (m_lut3D.size == 0))
+		return E_INVALIDARG;
+
+	if ((srcRowBytes < GetPixelFormatRowBytes(pixelFormat, m_width)) || (dstRowBytes < GetPixelFormatRowBytes(pixelFormat, m_width)))
+		return E_INVALIDARG;
+
+	if (IsYUVPixelFormat(pixelFormat) && (colorspace != m_colorspace))
+	{
+		Colorimetry colorimetry = { kColorimetryRec709, kColorimetryNarrowRange, kColorimetryFullRange, kChromaSitingCosited };
+
+		if (colorspace == bmdColorspaceRec601)
+			colorimetry.matrix = kColorimetryRec601;
+		else if (colorspace == bmdColorspaceRec2020)
+			colorimetry.matrix = kColorimetryRec2020;
+
+		GetColorimetryCoefficients(colorimetry, m_yuvCoefficients);
+		m_colorspace = colorspace;
+	}
+
+	// Rows are independent, so slices are several per thread to balance the load
+	uint32_t sliceCount		= std::min<uint32_t>(m_height, m_workerPool.GetThreadCount() * 4);
+	uint32_t rowsPerSlice	= (m_height + sliceCount - 1) / sliceCount;
+	sliceCount				= (m_height + rowsPerSlice - 1) / rowsPerSlice;
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		uint32_t firstRow = slice * rowsPerSlice;
+		ProcessRows(m_rowPlanes[threadIndex], pixelFormat, (const uint8_t*)srcFrame, srcRowBytes, (uint8_t*)dstFrame, dstRowBytes,
+					firstRow, std::min(rowsPerSlice, m_height - firstRow));
+	});
+
+	return S_OK;
+}
+
+void LUTProcessor::ProcessRows(RowPlanes& planes, BMDPixelFormat pixelFormat, const uint8_t* srcFrame, long srcRowBytes,
+							   uint8_t* dstFrame, long dstRowBytes, uint32_t firstRow, uint32_t rowCount)
+{
+	const bool	yuv		= IsYUVPixelFormat(pixelFormat);
+	uint16_t*	red		= planes.red.data();
+	uint16_t*	green	= planes.green.data();
+	uint16_t*	blue	= planes.blue.data();
+
+	for (uint32_t row = firstRow; row < firstRow + rowCount; row++)
+	{
+		DecodePixelFormatRow(pixelFormat, srcFrame + (size_t)row * srcRowBytes, planes, m_width);
+
+		if (yuv)
+		{
+			ConvertYUV422RowToRGB(planes.luma.data(), planes.cb.data(), planes.cr.data(), red, green, blue, m_width, m_yuvCoefficients);
+
+			if (m_fullRangeShaperEnabled)
+			{
+				ApplyLUT1DRow(red, red, m_width, m_fullRangeShapers[0].data());
+				ApplyLUT1DRow(green, green, m_width, m_fullRangeShapers[1].data());
+				ApplyLUT1DRow(blue, blue, m_width, m_fullRangeShapers[2].data());
+			}
+		}
+		else
+		{
+			ApplyLUT1DRow(red, red, m_width, m_videoLevelShapers[0].data());
+			ApplyLUT1DRow(green, green, m_width, m_videoLevelShapers[1].data());
+			ApplyLUT1DRow(blue, blue, m_width, m_videoLevelShapers[2].data());
+		}
+
+		ApplyLUT3DRow(red, green, blue, red, green, blue, m_width, m_lut3D);
+
+		if (yuv)
+		{
+			ConvertRGBRowToYUV422(red, green, blue, planes.luma.data(), planes.cb.data(), planes.cr.data(), m_width, m_yuvCoefficients);
+		}
+		else
+		{
+			ApplyLUT1DRow(red, red, m_width, m_videoLevelOutput.data());
+			ApplyLUT1DRow(green, green, m_width, m_videoLevelOutput.data());
+			ApplyLUT1DRow(blue, blue, m_width, m_videoLevelOutput.data());
+		}
+
+		EncodePixelFormatRow(pixelFormat, planes, dstFrame + (size_t)row * dstRowBytes, m_width);
+	}
+}
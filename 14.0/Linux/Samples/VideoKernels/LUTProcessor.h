@@ -0,0 +1,110 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "CubeLUT.h"
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoConversion.h"
+#include "VideoKernels.h"
+
+// LUTProcessor applies a 3D lookup table loaded by CubeLUT to frames of the uncompressed pixel formats
+// supported by VideoConversion, in place or to another frame of the same format.
+//
+// Each row is unpacked to planar 16-bit samples by the VideoConversion row codecs:
+// * RGB formats, such as r210 and the 12-bit R12B and R12L, are unpacked to 16-bit video levels.  A 1D shaper
+//   table maps black to white, over the domain of the table, to the full range of its grid, and a 1D table maps
+//   the full range output back to video levels.
+// * YUV formats are converted to full range R'G'B' by the colorimetry kernels, with the matrix of the frame's
+//   colorspace, and back to YUV with the same matrix.  The shaper is applied only when the domain of the table
+//   is not 0 to 1.
+//
+// The 3D table is interpolated between the 4 grid points of the tetrahedron around each pixel by the lookup
+// table kernels.  Each grid point is quantized to a 16-bit entry of 8 bytes, which the AVX2 kernel fetches with a
+// single 64-bit gather per vertex, and a 33 point table of 280 KB stays in the L2 cache.  Alpha is preserved.
+//
+// Each frame is split into slices of rows which are processed in parallel by a SliceWorkerPool.
+class LUTProcessor
+{
+public:
+	// threadCount includes the calling thread, 0 selects the number of CPUs
+	LUTProcessor(uint32_t width, uint32_t height, unsigned threadCount = 0);
+
+	uint32_t			GetWidth(void) const { return m_width; }
+	uint32_t			GetHeight(void) const { return m_height; }
+	unsigned			GetThreadCount(void) const { return m_workerPool.GetThreadCount(); }
+
+	static bool			IsPixelFormatSupported(BMDPixelFormat pixelFormat);
+
+	// Set the table applied to frames.  Returns E_INVALIDARG if no table is loaded.
+	HRESULT				SetLUT(const CubeLUT& lut);
+	bool				HasLUT(void) const { return m_lut3D.size != 0; }
+
+	// Apply the table to a frame, colorspace selects the YUV matrix.  dstFrame may be srcFrame.  Returns
+	// E_INVALIDARG if the pixel format is not supported or no table is set.  Calls from multiple threads are
+	// serialized.
+	HRESULT				ApplyLUT(BMDPixelFormat pixelFormat, BMDColorspace colorspace, const void* srcFrame, long srcRowBytes, void* dstFrame, long dstRowBytes);
+
+private:
+	typedef VideoConversion::RowPlanes	RowPlanes;
+
+	uint32_t					m_width;
+	uint32_t					m_height;
+
+	std::mutex					m_mutex;
+	std::vector<uint16_t>		m_videoLevelShapers[3];		// Video level R, G and B to the grid
+	std::vector<uint16_t>		m_fullRangeShapers[3];		// Full range R'G'B' to the grid
+	bool						m_fullRangeShaperEnabled;	// False when the domain is 0 to 1
+	std::vector<uint16_t>		m_videoLevelOutput;			// Full range output to video levels
+	std::vector<uint16_t>		m_lut3DEntries;
+	LUT3D						m_lut3D;
+
+	BMDColorspace				m_colorspace;				// Colorspace of the YUV coefficients
+	ColorimetryCoefficients		m_yuvCoefficients;
+
+	SliceWorkerPool				m_workerPool;
+	std::vector<RowPlanes>		m_rowPlanes;				// Indexed by pool thread
+
+	void						ProcessRows(RowPlanes& planes, BMDPixelFormat pixelFormat, const uint8_t* srcFrame, long srcRowBytes,
+											uint8_t* dstFrame, long dstRowBytes, uint32_t firstRow, uint32_t rowCount);
+};
@@ -0,0 +1,355 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include "PatternCache.h"
+
+// Samples of a colour in each kind of row plane, see VideoConversion.h
+struct PatternColour
+{
+	uint16_t	luma;
+	uint16_t	cb;
+	uint16_t	cr;
+	uint16_t	red;
+	uint16_t	green;
+	uint16_t	blue;
+};
+
+static constexpr double PatternLuma(double r, double g, double b, double kr, double kb)
+{
+	return kr * r + (1.0 - kr - kb) * g + kb * b;
+}
+
+static constexpr uint16_t PatternSample(double value)
+{
+	return (uint16_t)(value + 0.5);
+}
+
+// Narrow range 10-bit YCbCr and 16-bit R'G'B' samples of an R'G'B' colour, with the luma coefficients of a matrix
+static constexpr PatternColour MakePatternColour(double r, double g, double b, double kr, double kb)
+{
+	return {
+		PatternSample(64.0 + 876.0 * PatternLuma(r, g, b, kr, kb)),
+		PatternSample(512.0 + 448.0 * (b - PatternLuma(r, g, b, kr, kb)) / (1.0 - kb)),
+		PatternSample(512.0 + 448.0 * (r - PatternLuma(r, g, b, kr, kb)) / (1.0 - kr)),
+		PatternSample(4096.0 + 56064.0 * r),
+		PatternSample(4096.0 + 56064.0 * g),
+		PatternSample(4096.0 + 56064.0 * b)
+	};
+}
+
+// Bar i of colour bars: white, yellow, cyan, green, magenta, red, blue and black.  White is at 100% in bars of
+// either level.
+static constexpr PatternColour BarColour(int i, double level, double kr, double kb)
+{
+	return MakePatternColour((i & 2) ? 0.0 : (i == 0) ? 1.0 : level,
+							 (i & 4) ? 0.0 : (i == 0) ? 1.0 : level,
+							 (i & 1) ? 0.0 : (i == 0) ? 1.0 : level, kr, kb);
+}
+
+static const uint32_t		kBarCount		= 8;
+static const uint32_t		kBlackBar		= 7;
+static const uint32_t		kWhiteBar		= 0;
+
+// Indexed by matrix, Rec.601 then Rec.709
+static constexpr PatternColour kColourBars100[2][kBarCount] =
+{
+	{ BarColour(0, 1.0, 0.299, 0.114), BarColour(1, 1.0, 0.299, 0.114), BarColour(2, 1.0, 0.299, 0.114), BarColour(3, 1.0, 0.299, 0.114),
+	  BarColour(4, 1.0, 0.299, 0.114), BarColour(5, 1.0, 0.299, 0.114), BarColour(6, 1.0, 0.299, 0.114), BarColour(7, 1.0, 0.299, 0.114) },
+	{ BarColour(0, 1.0, 0.2126, 0.0722), BarColour(1, 1.0, 0.2126, 0.0722), BarColour(2, 1.0, 0.2126, 0.0722), BarColour(3, 1.0, 0.2126, 0.0722),
+	  BarColour(4, 1.0, 0.2126, 0.0722), BarColour(5, 1.0, 0.2126, 0.0722), BarColour(6, 1.0, 0.2126, 0.0722), BarColour(7, 1.0, 0.2126, 0.0722) }
+};
+
+static constexpr PatternColour kColourBars75[2][kBarCount] =
+{
+	{ BarColour(0, 0.75, 0.299, 0.114), BarColour(1, 0.75, 0.299, 0.114), BarColour(2, 0.75, 0.299, 0.114), BarColour(3, 0.75, 0.299, 0.114),
+	  BarColour(4, 0.75, 0.299, 0.114), BarColour(5, 0.75, 0.299, 0.114), BarColour(6, 0.75, 0.299, 0.114), BarColour(7, 0.75, 0.299, 0.114) },
+	{ BarColour(0, 0.75, 0.2126, 0.0722), BarColour(1, 0.75, 0.2126, 0.0722), BarColour(2, 0.75, 0.2126, 0.0722), BarColour(3, 0.75, 0.2126, 0.0722),
+	  BarColour(4, 0.75, 0.2126, 0.0722), BarColour(5, 0.75, 0.2126, 0.0722), BarColour(6, 0.75, 0.2126, 0.0722), BarColour(7, 0.75, 0.2126, 0.0722) }
+};
+
+static_assert(kColourBars75[0][1].luma == 646 && kColourBars100[1][7].luma == 64 && kColourBars100[1][0].cb == 512,
+			  "Colour bar samples are not video levels");
+
+// Header of a cache file, followed by the rows of the frame
+static const char			kPatternFileMagic[8]	= { 'B', 'M', 'D', 'P', 'A', 'T', 'T', 'N' };
+static const uint32_t		kPatternFileVersion		= 1;
+
+struct PatternFileHeader
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	displayMode;
+	uint32_t	pixelFormat;
+	uint32_t	pattern;
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	rowBytes;
+	uint32_t	reserved;
+};
+
+PatternFrame::PatternFrame(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat) :
+	m_width(width),
+	m_height(height),
+	m_pixelFormat(pixelFormat),
+	m_rowBytes(GetPixelFormatRowBytes(pixelFormat, width)),
+	m_size((size_t)m_rowBytes * height),
+	m_bytes(NULL),
+	m_mapping(NULL),
+	m_mappingSize(0)
+{
+}
+
+PatternFrame::~PatternFrame()
+{
+	if (m_mapping != NULL)
+		munmap(m_mapping, m_mappingSize);
+	else
+		delete[] m_bytes;
+}
+
+void PatternFrame::CopyTo(void* frame, long rowBytes) const
+{
+	if (rowBytes == m_rowBytes)
+	{
+		memcpy(frame, m_bytes, m_size);
+		return;
+	}
+
+	for (uint32_t row = 0; row < m_height; row++)
+		memcpy((uint8_t*)frame + (size_t)row * rowBytes, m_bytes + (size_t)row * m_rowBytes, m_rowBytes);
+}
+
+PatternCache::PatternCache() :
+	m_directory()
+{
+}
+
+PatternCache& PatternCache::GetSharedCache(void)
+{
+	static PatternCache sharedCache;
+	return sharedCache;
+}
+
+void PatternCache::SetDirectory(const char* directory)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_directory = (directory != NULL) ? directory : "";
+}
+
+std::shared_ptr<const PatternFrame> PatternCache::GetFrame(BMDDisplayMode displayMode, uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, TestPatternType pattern)
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	EntryKey					key(displayMode, pixelFormat, pattern);
+	std::string					path;
+
+	auto entry = m_entries.find(key);
+	if (entry != m_entries.end())
+		return entry->second;
+
+	if ((GetPixelFormatRowBytes(pixelFormat, width) == 0) || (width == 0) || (height == 0))
+		return nullptr;
+
+	std::shared_ptr<PatternFrame> frame = std::make_shared<PatternFrame>(width, height, pixelFormat);
+
+	if (!m_directory.empty())
+		path = GetFilePath(displayMode, pixelFormat, pattern);
+
+	if (path.empty() || !MapFile(path, displayMode, pattern, *frame))
+	{
+		RenderPattern(*frame, pattern);
+
+		if (!path.empty())
+			WriteFile(path, displayMode, pattern, *frame);
+	}
+
+	m_entries[key] = frame;
+	return frame;
+}
+
+HRESULT PatternCache::FillFrame(BMDDisplayMode displayMode, TestPatternType pattern, IDeckLinkVideoFrame* frame)
+{
+	std::shared_ptr<const PatternFrame>	patternFrame;
+	void*								bytes;
+
+	if (frame == NULL)
+		return E_POINTER;
+
+	patternFrame = GetFrame(displayMode, (uint32_t)frame->GetWidth(), (uint32_t)frame->GetHeight(), frame->GetPixelFormat(), pattern);
+	if ((patternFrame == nullptr) || (patternFrame->GetWidth() != (uint32_t)frame->GetWidth()) ||
+		(patternFrame->GetHeight() != (uint32_t)frame->GetHeight()) || (frame->GetRowBytes() < patternFrame->GetRowBytes()))
+		return E_INVALIDARG;
+
+	if (frame->GetBytes(&bytes) != S_OK)
+		return E_FAIL;
+
+	patternFrame->CopyTo(bytes, frame->GetRowBytes());
+	return S_OK;
+}
+
+void PatternCache::RenderPattern(PatternFrame& frame, TestPatternType pattern)
+{
+	const uint32_t				width	= frame.m_width;
+	const PatternColour*		bars	= (pattern == kTestPatternColourBars75) ? kColourBars75[frame.m_height > 576] : kColourBars100[frame.m_height > 576];
+	VideoConversion::RowPlanes	planes;
+
+	planes.luma.resize(width);
+	planes.cb.resize((width + 1) / 2);
+	planes.cr.resize((width + 1) / 2);
+	planes.red.resize(width);
+	planes.green.resize(width);
+	planes.blue.resize(width);
+	planes.alpha.assign(width, 0xFFFF);
+
+	// Bars are selected for each pair of pixels, so that luma and chroma change together
+	for (uint32_t x = 0; x < width; x += 2)
+	{
+		uint32_t				barX	= (pattern == kTestPatternColourBars100Reversed) ? ((width - 1 - x) & ~1u) : x;
+		const PatternColour&	colour	= bars[(pattern == kTestPatternBlack) ? kBlackBar : (pattern == kTestPatternWhite) ? kWhiteBar : (barX * kBarCount) / width];
+
+		for (uint32_t i = x; i < std::min(x + 2, width); i++)
+		{
+			planes.luma[i]	= colour.luma;
+			planes.red[i]	= colour.red;
+			planes.green[i]	= colour.green;
+			planes.blue[i]	= colour.blue;
+		}
+
+		planes.cb[x / 2] = colour.cb;
+		planes.cr[x / 2] = colour.cr;
+	}
+
+	// Every row of the patterns is the same
+	frame.m_bytes = new uint8_t[frame.m_size];
+	EncodePixelFormatRow(frame.m_pixelFormat, planes, frame.m_bytes, width);
+
+	for (uint32_t row = 1; row < frame.m_height; row++)
+		memcpy(frame.m_bytes + (size_t)row * frame.m_rowBytes, frame.m_bytes, frame.m_rowBytes);
+}
+
+std::string PatternCache::GetFilePath(BMDDisplayMode displayMode, BMDPixelFormat pixelFormat, TestPatternType pattern) const
+{
+	char name[64];
+
+	snprintf(name, sizeof(name), "/%08x-%08x-%u.pattern", (uint32_t)displayMode, (uint32_t)pixelFormat, (uint32_t)pattern);
+	return m_directory + name;
+}
+
+bool PatternCache::MapFile(const std::string& path, BMDDisplayMode displayMode, TestPatternType pattern, PatternFrame& frame) const
+{
+	const PatternFileHeader*	header;
+	struct stat					fileStatus;
+	size_t						mappingSize = sizeof(PatternFileHeader) + frame.m_size;
+	void*						mapping;
+	int							fd = open(path.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	if ((fstat(fd, &fileStatus) != 0) || ((size_t)fileStatus.st_size != mappingSize))
+	{
+		close(fd);
+		return false;
+	}
+
+	mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+	// A file of another version or frame size is replaced
+	header = (const PatternFileHeader*)mapping;
+	if ((memcmp(header->magic, kPatternFileMagic, sizeof(header->magic)) != 0) || (header->version != kPatternFileVersion) ||
+		(header->displayMode != (uint32_t)displayMode) || (header->pixelFormat != (uint32_t)frame.m_pixelFormat) ||
+		(header->pattern != (uint32_t)pattern) || (header->width != frame.m_width) || (header->height != frame.m_height) ||
+		(header->rowBytes != (uint32_t)frame.m_rowBytes))
+	{
+		munmap(mapping, mappingSize);
+		return false;
+	}
+
+	frame.m_mapping		= mapping;
+	frame.m_mappingSize	= mappingSize;
+	frame.m_bytes		= (uint8_t*)mapping + sizeof(PatternFileHeader);
+	return true;
+}
+
+void PatternCache::WriteFile(const std::string& path, BMDDisplayMode displayMode, TestPatternType pattern, const PatternFrame& frame) const
+{
+	PatternFileHeader	header;
+	std::string			tempPath = path + ".tmp";
+	FILE*				file;
+	bool				success;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kPatternFileMagic, sizeof(header.magic));
+	header.version		= kPatternFileVersion;
+	header.displayMode	= (uint32_t)displayMode;
+	header.pixelFormat	= (uint32_t)frame.m_pixelFormat;
+	header.pattern		= (uint32_t)pattern;
+	header.width		= frame.m_width;
+	header.height		= frame.m_height;
+	header.rowBytes		= (uint32_t)frame.m_rowBytes;
+
+	// The file is renamed into place when complete, so another process never reads part of it
+	file = fopen(tempPath.c_str(), "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not create pattern cache file %s\n", tempPath.c_str());
+		return;
+	}
+
+	success = (fwrite(&header, sizeof(header), 1, file) == 1) && (fwrite(frame.m_bytes, 1, frame.m_size, file) == frame.m_size);
+	success = (fclose(file) == 0) && success;
+
+	if (!success || (rename(tempPath.c_str(), path.c_str()) != 0))
+	{
+		fprintf(stderr, "Could not write pattern cache file %s\n", path.c_str());
+		remove(tempPath.c_str());
+	}
+}
@@ -0,0 +1,135 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "DeckLinkAPI.h"
+#include "VideoConversion.h"
+
+// PatternCache renders the test patterns of the signal generator samples, black, white and colour bars, into frames of
+// the uncompressed pixel formats supported by VideoConversion.  Each pattern is rendered directly in the target
+// format: the colours of the bars are compile-time tables of 10-bit YCbCr and 16-bit R'G'B' samples, one row is
+// encoded by the VideoConversion row codecs and copied to every row of the frame.  The Rec.601 matrix is used
+// for SD heights and Rec.709 otherwise, as VideoConversion does for frames without colorspace metadata.
+//
+// A cache entry is keyed by display mode, pixel format and pattern.  It is built once, then shared read-only by
+// every output that uses it, and output frames are filled by copying its rows.  When a cache directory is set,
+// each entry is also written to a file in the directory when it is built, and later runs map the file instead of
+// rendering the pattern, so processes using the same directory share the pages of each entry.
+//
+// The shared cache is the cache of the process, outputs should use it so that entries are shared between them.
+// Calls from multiple threads are serialized.
+
+enum TestPatternType
+{
+	kTestPatternBlack = 0,
+	kTestPatternColourBars100,			// 100% colour bars
+	kTestPatternColourBars100Reversed,	// 100% colour bars in reverse order, for the right eye of 3D output
+	kTestPatternColourBars75,			// 75% colour bars with 100% white
+	kTestPatternWhite					// 100% white, for the flash of the A/V sync test signal
+};
+
+// A rendered pattern frame
+class PatternFrame
+{
+public:
+	PatternFrame(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat);
+	~PatternFrame();
+
+	PatternFrame(const PatternFrame&) = delete;
+	PatternFrame& operator=(const PatternFrame&) = delete;
+
+	uint32_t			GetWidth(void) const { return m_width; }
+	uint32_t			GetHeight(void) const { return m_height; }
+	BMDPixelFormat		GetPixelFormat(void) const { return m_pixelFormat; }
+	long				GetRowBytes(void) const { return m_rowBytes; }
+	const uint8_t*		GetBytes(void) const { return m_bytes; }
+
+	// Copy the pattern to a frame of the same size, with rows of at least GetRowBytes() bytes
+	void				CopyTo(void* frame, long rowBytes) const;
+
+private:
+	friend class PatternCache;
+
+	uint32_t				m_width;
+	uint32_t				m_height;
+	BMDPixelFormat			m_pixelFormat;
+	long					m_rowBytes;
+	size_t					m_size;
+	uint8_t*				m_bytes;
+	void*					m_mapping;			// Mapping of the cache file holding the frame, or NULL if rendered
+	size_t					m_mappingSize;
+};
+
+class PatternCache
+{
+public:
+	PatternCache();
+
+	static PatternCache&	GetSharedCache(void);
+
+	// Directory of the cache files, NULL or empty to keep entries in memory only.  The directory must exist.
+	void					SetDirectory(const char* directory);
+
+	// Returns the cache entry of the pattern in frames of the display mode and pixel format, building it if
+	// necessary, or NULL if the pixel format is not supported
+	std::shared_ptr<const PatternFrame>	GetFrame(BMDDisplayMode displayMode, uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, TestPatternType pattern);
+
+	// Fill a frame of the display mode with the pattern, in the frame's pixel format.  Returns E_INVALIDARG if the
+	// pixel format is not supported.
+	HRESULT					FillFrame(BMDDisplayMode displayMode, TestPatternType pattern, IDeckLinkVideoFrame* frame);
+
+private:
+	typedef std::tuple<BMDDisplayMode, BMDPixelFormat, TestPatternType>	EntryKey;
+
+	std::mutex												m_mutex;
+	std::string												m_directory;
+	std::map<EntryKey, std::shared_ptr<const PatternFrame>>	m_entries;
+
+	static void				RenderPattern(PatternFrame& frame, TestPatternType pattern);
+	std::string				GetFilePath(BMDDisplayMode displayMode, BMDPixelFormat pixelFormat, TestPatternType pattern) const;
+	bool					MapFile(const std::string& path, BMDDisplayMode displayMode, TestPatternType pattern, PatternFrame& frame) const;
+	void					WriteFile(const std::string& path, BMDDisplayMode displayMode, TestPatternType pattern, const PatternFrame& frame) const;
+};
@@ -0,0 +1,182 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// SliceWorkerPool runs the slices of a frame in parallel on a pool of worker threads and the calling thread.
+// Threads take slices in order until none are left, so slices should be several times the thread count to
+// balance the load when threads are preempted.  The slice function is given the index of the thread running
+// it, below GetThreadCount(), to select its working buffers.  The calling thread has the last index.
+//
+// Run() returns when all slices are done, calls from multiple threads are serialized.
+class SliceWorkerPool
+{
+public:
+	using SliceFunction = std::function<void(uint32_t slice, unsigned threadIndex)>;
+
+	// threadCount includes the calling thread, 0 selects the number of CPUs
+	explicit SliceWorkerPool(unsigned threadCount = 0) :
+		m_sliceFunction(nullptr),
+		m_jobGeneration(0),
+		m_sliceCount(0),
+		m_nextSlice(0),
+		m_slicesDone(0),
+		m_stopWorkers(false)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		m_threadCount = threadCount;
+
+		for (unsigned i = 0; i + 1 < threadCount; i++)
+			m_workerThreads.emplace_back(&SliceWorkerPool::WorkerThread, this, i);
+	}
+
+	~SliceWorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopWorkers = true;
+		}
+		m_jobCondition.notify_all();
+
+		for (std::thread& workerThread : m_workerThreads)
+			workerThread.join();
+	}
+
+	SliceWorkerPool(const SliceWorkerPool&) = delete;
+	SliceWorkerPool& operator=(const SliceWorkerPool&) = delete;
+
+	unsigned	GetThreadCount(void) const { return m_threadCount; }
+
+	void Run(uint32_t sliceCount, const SliceFunction& sliceFunction)
+	{
+		std::lock_guard<std::mutex> runLock(m_runMutex);
+
+		if (sliceCount == 0)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_sliceFunction	= &sliceFunction;
+			m_sliceCount	= sliceCount;
+			m_nextSlice		= 0;
+			m_slicesDone	= 0;
+			m_jobGeneration++;
+		}
+		m_jobCondition.notify_all();
+
+		// The calling thread runs slices too, then waits for slices taken by workers
+		RunSlices(m_threadCount - 1);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this]{ return m_slicesDone == m_sliceCount; });
+		m_sliceFunction = nullptr;
+	}
+
+private:
+	unsigned					m_threadCount;
+	std::vector<std::thread>	m_workerThreads;
+
+	// Serializes Run calls
+	std::mutex					m_runMutex;
+
+	std::mutex					m_mutex;
+	std::condition_variable		m_jobCondition;
+	std::condition_variable		m_doneCondition;
+	const SliceFunction*		m_sliceFunction;
+	uint64_t					m_jobGeneration;
+	uint32_t					m_sliceCount;
+	uint32_t					m_nextSlice;
+	uint32_t					m_slicesDone;
+	bool						m_stopWorkers;
+
+	void WorkerThread(unsigned threadIndex)
+	{
+		uint64_t						jobGeneration = 0;
+		std::unique_lock<std::mutex>	lock(m_mutex);
+
+		while (true)
+		{
+			m_jobCondition.wait(lock, [&]{ return m_stopWorkers || (m_jobGeneration != jobGeneration); });
+			if (m_stopWorkers)
+				break;
+
+			jobGeneration = m_jobGeneration;
+
+			lock.unlock();
+			RunSlices(threadIndex);
+			lock.lock();
+		}
+	}
+
+	void RunSlices(unsigned threadIndex)
+	{
+		while (true)
+		{
+			const SliceFunction*	sliceFunction;
+			uint32_t				slice;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_nextSlice >= m_sliceCount)
+					return;
+
+				sliceFunction	= m_sliceFunction;
+				slice			= m_nextSlice++;
+			}
+
+			(*sliceFunction)(slice, threadIndex);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (++m_slicesDone == m_sliceCount)
+					m_doneCondition.notify_all();
+			}
+		}
+	}
+};
@@ -0,0 +1,410 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <string.h>
+#include <algorithm>
+#include "Stereo3D.h"
+
+// Unpacked rows kept by each thread for the vertical filter, at least the 11 rows of the decimation window
+static const uint32_t	kRingRowCount	= 16;
+
+// Limits of filtered samples, 10-bit YUV excludes the codes reserved for timing references
+static const uint16_t	kMinYUVCode		= 4;
+static const uint16_t	kMaxYUVCode		= 1019;
+
+// Black in the active space of frame packed frames
+static const uint16_t	kBlackLuma		= 64;
+static const uint16_t	kChromaZero		= 512;
+static const uint16_t	kBlackRGB		= 4096;
+static const uint16_t	kOpaqueAlpha	= 0xFFFF;
+
+static bool HasAlpha(BMDPixelFormat pixelFormat)
+{
+	return (pixelFormat == bmdFormat10BitYUVA) || (pixelFormat == bmdFormat8BitARGB) || (pixelFormat == bmdFormat8BitBGRA);
+}
+
+static void ResizePlanes(VideoConversion::RowPlanes& planes, uint32_t width)
+{
+	planes.luma.resize(width);
+	planes.cb.resize((width + 1) / 2);
+	planes.cr.resize((width + 1) / 2);
+	planes.red.resize(width);
+	planes.green.resize(width);
+	planes.blue.resize(width);
+	planes.alpha.resize(width);
+}
+
+Stereo3DPacker::Stereo3DPacker(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, Stereo3DLayout layout, unsigned threadCount) :
+	m_width(width),
+	m_height(height),
+	m_pixelFormat(pixelFormat),
+	m_layout(layout),
+	m_activeSpace((layout == kStereo3DFramePacked) ? GetFramePackingActiveSpace(height) : 0),
+	m_rowBytes(GetPixelFormatRowBytes(pixelFormat, width)),
+	m_workerPool(threadCount)
+{
+	RowPlanes black;
+
+	m_packedHeight = (layout == kStereo3DFramePacked) ? height * 2 + m_activeSpace : height;
+
+	if (IsYUVPixelFormat(pixelFormat))
+	{
+		m_planes.push_back({ &RowPlanes::luma, width, kMinYUVCode, kMaxYUVCode });
+		m_planes.push_back({ &RowPlanes::cb, (width + 1) / 2, kMinYUVCode, kMaxYUVCode });
+		m_planes.push_back({ &RowPlanes::cr, (width + 1) / 2, kMinYUVCode, kMaxYUVCode });
+	}
+	else
+	{
+		m_planes.push_back({ &RowPlanes::red, width, 0, 0xFFFF });
+		m_planes.push_back({ &RowPlanes::green, width, 0, 0xFFFF });
+		m_planes.push_back({ &RowPlanes::blue, width, 0, 0xFFFF });
+	}
+
+	if (HasAlpha(pixelFormat))
+		m_planes.push_back({ &RowPlanes::alpha, width, 0, 0xFFFF });
+
+	ResizePlanes(black, width);
+	std::fill(black.luma.begin(), black.luma.end(), kBlackLuma);
+	std::fill(black.cb.begin(), black.cb.end(), kChromaZero);
+	std::fill(black.cr.begin(), black.cr.end(), kChromaZero);
+	std::fill(black.red.begin(), black.red.end(), kBlackRGB);
+	std::fill(black.green.begin(), black.green.end(), kBlackRGB);
+	std::fill(black.blue.begin(), black.blue.end(), kBlackRGB);
+	std::fill(black.alpha.begin(), black.alpha.end(), kOpaqueAlpha);
+
+	m_blackRow.resize(std::max<long>(m_rowBytes, 0));
+	if (m_rowBytes > 0)
+		EncodePixelFormatRow(pixelFormat, black, m_blackRow.data(), width);
+
+	m_threadRows.resize(m_workerPool.GetThreadCount());
+	for (ThreadRows& rows : m_threadRows)
+	{
+		ResizePlanes(rows.eyePlanes[0], width);
+		ResizePlanes(rows.eyePlanes[1], width);
+		ResizePlanes(rows.packedPlanes, width);
+
+		if (layout == kStereo3DTopBottom)
+		{
+			rows.ringPlanes.resize(kRingRowCount);
+			rows.ringRowIndex.assign(kRingRowCount, -1);
+			for (RowPlanes& planes : rows.ringPlanes)
+				ResizePlanes(planes, width);
+		}
+	}
+}
+
+bool Stereo3DPacker::IsSupported(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, Stereo3DLayout layout)
+{
+	if ((width == 0) || (height == 0) || (GetPixelFormatRowBytes(pixelFormat, width) == 0))
+		return false;
+
+	switch (layout)
+	{
+		case kStereo3DSideBySide:
+			return (width % 4) == 0;
+		case kStereo3DTopBottom:
+			return (height % 2) == 0;
+		case kStereo3DFramePacked:
+			return true;
+		default:
+			return false;
+	}
+}
+
+uint32_t Stereo3DPacker::GetFramePackingActiveSpace(uint32_t height)
+{
+	switch (height)
+	{
+		case 480:	return 45;
+		case 576:	return 49;
+		case 720:	return 30;
+		case 1080:	return 45;
+		case 2160:	return 90;
+		default:	return 0;
+	}
+}
+
+uint32_t Stereo3DPacker::GetSliceCount(uint32_t rowCount, uint32_t& rowsPerSlice) const
+{
+	// Rows are independent, so slices are several per thread to balance the load
+	uint32_t sliceCount = std::min<uint32_t>(rowCount, m_workerPool.GetThreadCount() * 4);
+
+	rowsPerSlice = (rowCount + sliceCount - 1) / sliceCount;
+	return (rowCount + rowsPerSlice - 1) / rowsPerSlice;
+}
+
+HRESULT Stereo3DPacker::PackFrame(const void* leftFrame, const void* rightFrame, long eyeRowBytes, void* packedFrame, long packedRowBytes)
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	const uint8_t*				eyeFrames[2] = { (const uint8_t*)leftFrame, (const uint8_t*)rightFrame };
+	uint32_t					rowsPerSlice;
+	uint32_t					sliceCount;
+
+	if ((leftFrame == NULL) || (rightFrame == NULL) || (packedFrame == NULL))
+		return E_POINTER;
+
+	if (!IsSupported(m_width, m_height, m_pixelFormat, m_layout) || (eyeRowBytes < m_rowBytes) || (packedRowBytes < m_rowBytes))
+		return E_INVALIDARG;
+
+	sliceCount = GetSliceCount(m_packedHeight, rowsPerSlice);
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		ThreadRows&	rows		= m_threadRows[threadIndex];
+		uint32_t	firstRow	= slice * rowsPerSlice;
+		uint32_t	lastRow		= std::min(firstRow + rowsPerSlice, m_packedHeight);
+
+		std::fill(rows.ringRowIndex.begin(), rows.ringRowIndex.end(), -1);
+
+		for (uint32_t row = firstRow; row < lastRow; row++)
+			PackRow(rows, eyeFrames, eyeRowBytes, (uint8_t*)packedFrame, packedRowBytes, row);
+	});
+
+	return S_OK;
+}
+
+HRESULT Stereo3DPacker::UnpackFrame(const void* packedFrame, long packedRowBytes, void* leftFrame, void* rightFrame, long eyeRowBytes)
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	uint8_t*					eyeFrames[2] = { (uint8_t*)leftFrame, (uint8_t*)rightFrame };
+	uint32_t					rowCount = (m_layout == kStereo3DSideBySide) ? m_height : m_height * 2;
+	uint32_t					rowsPerSlice;
+	uint32_t					sliceCount;
+
+	if ((leftFrame == NULL) || (rightFrame == NULL) || (packedFrame == NULL))
+		return E_POINTER;
+
+	if (!IsSupported(m_width, m_height, m_pixelFormat, m_layout) || (eyeRowBytes < m_rowBytes) || (packedRowBytes < m_rowBytes))
+		return E_INVALIDARG;
+
+	sliceCount = GetSliceCount(rowCount, rowsPerSlice);
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		ThreadRows&	rows		= m_threadRows[threadIndex];
+		uint32_t	firstRow	= slice * rowsPerSlice;
+		uint32_t	lastRow		= std::min(firstRow + rowsPerSlice, rowCount);
+
+		std::fill(rows.ringRowIndex.begin(), rows.ringRowIndex.end(), -1);
+
+		for (uint32_t row = firstRow; row < lastRow; row++)
+			UnpackRow(rows, (const uint8_t*)packedFrame, packedRowBytes, eyeFrames, eyeRowBytes, row);
+	});
+
+	return S_OK;
+}
+
+const Stereo3DPacker::RowPlanes& Stereo3DPacker::UnpackRingRow(ThreadRows& rows, const uint8_t* row, uint32_t key)
+{
+	uint32_t ringRow = key % kRingRowCount;
+
+	if (rows.ringRowIndex[ringRow] != (int32_t)key)
+	{
+		DecodePixelFormatRow(m_pixelFormat, row, rows.ringPlanes[ringRow], m_width);
+		rows.ringRowIndex[ringRow] = (int32_t)key;
+	}
+
+	return rows.ringPlanes[ringRow];
+}
+
+void Stereo3DPacker::PackRow(ThreadRows& rows, const uint8_t* const* eyeFrames, long eyeRowBytes, uint8_t* packedFrame, long packedRowBytes, uint32_t row)
+{
+	uint8_t* packedRow = packedFrame + (size_t)row * packedRowBytes;
+
+	switch (m_layout)
+	{
+		case kStereo3DSideBySide:
+		{
+			// Each eye is decimated to its half of each plane
+			for (uint32_t eye = 0; eye < 2; eye++)
+				DecodePixelFormatRow(m_pixelFormat, eyeFrames[eye] + (size_t)row * eyeRowBytes, rows.eyePlanes[eye], m_width);
+
+			for (const Plane& plane : m_planes)
+			{
+				uint32_t halfWidth = plane.width / 2;
+
+				for (uint32_t eye = 0; eye < 2; eye++)
+					DecimateRowHorizontal((rows.eyePlanes[eye].*plane.samples).data(), (rows.packedPlanes.*plane.samples).data() + eye * halfWidth,
+										  halfWidth, plane.minValue, plane.maxValue);
+			}
+
+			EncodePixelFormatRow(m_pixelFormat, rows.packedPlanes, packedRow, m_width);
+			break;
+		}
+
+		case kStereo3DTopBottom:
+		{
+			// Each packed row is centred on an even row of its eye, rows beyond the edges of the eye are the edge rows
+			uint32_t			halfHeight	= m_height / 2;
+			uint32_t			eye			= row / halfHeight;
+			int32_t				centre		= (int32_t)(row % halfHeight) * 2;
+			const RowPlanes*	centreRow;
+			const RowPlanes*	aboveRows[3];
+			const RowPlanes*	belowRows[3];
+
+			auto eyeRow = [&](int32_t eyeRowIndex) -> const RowPlanes*
+			{
+				uint32_t y = (uint32_t)std::min(std::max(eyeRowIndex, 0), (int32_t)m_height - 1);
+
+				return &UnpackRingRow(rows, eyeFrames[eye] + (size_t)y * eyeRowBytes, eye * m_height + y);
+			};
+
+			centreRow = eyeRow(centre);
+			for (int t = 0; t < 3; t++)
+			{
+				aboveRows[t] = eyeRow(centre - (t * 2 + 1));
+				belowRows[t] = eyeRow(centre + (t * 2 + 1));
+			}
+
+			for (const Plane& plane : m_planes)
+			{
+				HalfBandRows halfBandRows;
+
+				halfBandRows.centre = (centreRow->*plane.samples).data();
+				for (int t = 0; t < 3; t++)
+				{
+					halfBandRows.above[t] = (aboveRows[t]->*plane.samples).data();
+					halfBandRows.below[t] = (belowRows[t]->*plane.samples).data();
+				}
+
+				FilterRowsHalfBand(halfBandRows, (rows.packedPlanes.*plane.samples).data(), plane.width, plane.minValue, plane.maxValue);
+			}
+
+			EncodePixelFormatRow(m_pixelFormat, rows.packedPlanes, packedRow, m_width);
+			break;
+		}
+
+		case kStereo3DFramePacked:
+		default:
+			if (row < m_height)
+				memcpy(packedRow, eyeFrames[0] + (size_t)row * eyeRowBytes, m_rowBytes);
+			else if (row < m_height + m_activeSpace)
+				memcpy(packedRow, m_blackRow.data(), m_rowBytes);
+			else
+				memcpy(packedRow, eyeFrames[1] + (size_t)(row - m_height - m_activeSpace) * eyeRowBytes, m_rowBytes);
+			break;
+	}
+}
+
+void Stereo3DPacker::UnpackRow(ThreadRows& rows, const uint8_t* packedFrame, long packedRowBytes, uint8_t* const* eyeFrames, long eyeRowBytes, uint32_t row)
+{
+	switch (m_layout)
+	{
+		case kStereo3DSideBySide:
+		{
+			// Each half of each plane is interpolated to its eye
+			DecodePixelFormatRow(m_pixelFormat, packedFrame + (size_t)row * packedRowBytes, rows.packedPlanes, m_width);
+
+			for (const Plane& plane : m_planes)
+			{
+				uint32_t halfWidth = plane.width / 2;
+
+				for (uint32_t eye = 0; eye < 2; eye++)
+					InterpolateRowHorizontal((rows.packedPlanes.*plane.samples).data() + eye * halfWidth, (rows.eyePlanes[eye].*plane.samples).data(),
+											 halfWidth, plane.minValue, plane.maxValue);
+			}
+
+			for (uint32_t eye = 0; eye < 2; eye++)
+				EncodePixelFormatRow(m_pixelFormat, rows.eyePlanes[eye], eyeFrames[eye] + (size_t)row * eyeRowBytes, m_width);
+			break;
+		}
+
+		case kStereo3DTopBottom:
+		{
+			// Rows are of both eyes in turn.  Even rows of each eye are the packed rows, odd rows are interpolated
+			// from the packed rows of the eye around them.
+			uint32_t	halfHeight	= m_height / 2;
+			uint32_t	eye			= row / m_height;
+			uint32_t	y			= row % m_height;
+			uint8_t*	eyeRow		= eyeFrames[eye] + (size_t)y * eyeRowBytes;
+			int32_t		above		= (int32_t)(y / 2);
+
+			if ((y % 2) == 0)
+			{
+				memcpy(eyeRow, packedFrame + (size_t)(eye * halfHeight + y / 2) * packedRowBytes, m_rowBytes);
+				break;
+			}
+
+			auto packedRow = [&](int32_t packedRowIndex) -> const RowPlanes*
+			{
+				uint32_t packedY = eye * halfHeight + (uint32_t)std::min(std::max(packedRowIndex, 0), (int32_t)halfHeight - 1);
+
+				return &UnpackRingRow(rows, packedFrame + (size_t)packedY * packedRowBytes, packedY);
+			};
+
+			const RowPlanes* aboveRows[3];
+			const RowPlanes* belowRows[3];
+
+			for (int t = 0; t < 3; t++)
+			{
+				aboveRows[t] = packedRow(above - t);
+				belowRows[t] = packedRow(above + 1 + t);
+			}
+
+			for (const Plane& plane : m_planes)
+			{
+				HalfBandRows halfBandRows;
+
+				halfBandRows.centre = NULL;
+				for (int t = 0; t < 3; t++)
+				{
+					halfBandRows.above[t] = (aboveRows[t]->*plane.samples).data();
+					halfBandRows.below[t] = (belowRows[t]->*plane.samples).data();
+				}
+
+				FilterRowsHalfBand(halfBandRows, (rows.eyePlanes[0].*plane.samples).data(), plane.width, plane.minValue, plane.maxValue);
+			}
+
+			EncodePixelFormatRow(m_pixelFormat, rows.eyePlanes[0], eyeRow, m_width);
+			break;
+		}
+
+		case kStereo3DFramePacked:
+		default:
+		{
+			uint32_t eye		= row / m_height;
+			uint32_t y			= row % m_height;
+			uint32_t packedY	= (eye == 0) ? y : m_height + m_activeSpace + y;
+
+			memcpy(eyeFrames[eye] + (size_t)y * eyeRowBytes, packedFrame + (size_t)packedY * packedRowBytes, m_rowBytes);
+			break;
+		}
+	}
+}
@@ -0,0 +1,146 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoConversion.h"
+#include "VideoKernels.h"
+
+// Stereo3DPacker packs the left and right eye frames of stereoscopic 3D video into a single frame, and unpacks
+// them again, for the uncompressed pixel formats supported by VideoConversion.  A dual stream 3D input can then
+// be recorded, processed and played out as a single stream:
+// * Side-by-side and top-bottom frames are the size of one eye frame, so the stream is half the bandwidth of
+//   the two eyes.  Each eye is decimated 2:1 horizontally or vertically by the half-band kernels, which filter
+//   out the frequencies that would alias, and interpolated 1:2 when unpacked.  The rows or columns kept by
+//   decimation are unpacked unchanged.
+// * Frame packed frames hold both eyes at full resolution, the left eye above the right, separated by the rows
+//   of the vertical blanking interval as HDMI 1.4a frame packing.  These active space rows are black.  The eyes
+//   are copied unchanged.
+//
+// Each row is unpacked to planar 16-bit samples by the VideoConversion row codecs and filtered in each plane:
+// luma and chroma of YUV formats, R, G and B of RGB formats, and alpha of Ay10, ARGB and BGRA.  Chroma and R'G'B'
+// are filtered separately, so side-by-side 4:2:2 chroma is decimated to a quarter of the luma width.
+//
+// Each frame is split into slices of output rows which are packed or unpacked in parallel by a SliceWorkerPool.
+// For top-bottom frames a thread keeps the rows it has unpacked while they are in the window of the vertical
+// filter.
+
+enum Stereo3DLayout
+{
+	kStereo3DSideBySide = 0,		// Left eye in the left half of the frame, decimated horizontally
+	kStereo3DTopBottom,				// Left eye in the top half of the frame, decimated vertically
+	kStereo3DFramePacked			// Left eye above the right eye and active space, at full resolution
+};
+
+class Stereo3DPacker
+{
+public:
+	// width and height are of each eye frame.  threadCount includes the calling thread, 0 selects the number
+	// of CPUs.
+	Stereo3DPacker(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, Stereo3DLayout layout, unsigned threadCount = 0);
+
+	uint32_t			GetWidth(void) const { return m_width; }
+	uint32_t			GetHeight(void) const { return m_height; }
+	BMDPixelFormat		GetPixelFormat(void) const { return m_pixelFormat; }
+	Stereo3DLayout		GetLayout(void) const { return m_layout; }
+	unsigned			GetThreadCount(void) const { return m_workerPool.GetThreadCount(); }
+
+	// Packed frames are the width of an eye frame, and the height of an eye frame unless frame packed
+	uint32_t			GetPackedHeight(void) const { return m_packedHeight; }
+
+	// Returns true if the pixel format is supported, and the eye frames can be packed in the layout.  Side-by-side
+	// packing requires a width that is a multiple of 4, and top-bottom packing an even height.
+	static bool			IsSupported(uint32_t width, uint32_t height, BMDPixelFormat pixelFormat, Stereo3DLayout layout);
+
+	// Rows of active space between the eyes of a frame packed frame, the vertical blanking of the progressive
+	// HD and UHD modes, or 0 for other heights
+	static uint32_t		GetFramePackingActiveSpace(uint32_t height);
+
+	// Pack the left and right eye frames into a frame.  Returns E_INVALIDARG if the packer does not support its
+	// format or a row is too short.  Calls from multiple threads are serialized.
+	HRESULT				PackFrame(const void* leftFrame, const void* rightFrame, long eyeRowBytes, void* packedFrame, long packedRowBytes);
+
+	// Unpack the left and right eye frames from a packed frame
+	HRESULT				UnpackFrame(const void* packedFrame, long packedRowBytes, void* leftFrame, void* rightFrame, long eyeRowBytes);
+
+private:
+	typedef VideoConversion::RowPlanes	RowPlanes;
+
+	// A plane filtered by the half-band kernels
+	struct Plane
+	{
+		std::vector<uint16_t> RowPlanes::*	samples;
+		uint32_t							width;
+		uint16_t							minValue;
+		uint16_t							maxValue;
+	};
+
+	// Working rows of one thread
+	struct ThreadRows
+	{
+		RowPlanes				eyePlanes[2];
+		RowPlanes				packedPlanes;
+		std::vector<RowPlanes>	ringPlanes;			// Unpacked rows of the vertical filter window
+		std::vector<int32_t>	ringRowIndex;		// Row held by each row of the ring, -1 if none
+	};
+
+	uint32_t					m_width;
+	uint32_t					m_height;
+	BMDPixelFormat				m_pixelFormat;
+	Stereo3DLayout				m_layout;
+	uint32_t					m_packedHeight;
+	uint32_t					m_activeSpace;
+	long						m_rowBytes;
+	std::vector<Plane>			m_planes;
+	std::vector<uint8_t>		m_blackRow;			// Row of active space
+
+	std::mutex					m_mutex;
+	SliceWorkerPool				m_workerPool;
+	std::vector<ThreadRows>		m_threadRows;		// Indexed by pool thread
+
+	uint32_t					GetSliceCount(uint32_t rowCount, uint32_t& rowsPerSlice) const;
+	const RowPlanes&			UnpackRingRow(ThreadRows& rows, const uint8_t* row, uint32_t key);
+	void						PackRow(ThreadRows& rows, const uint8_t* const* eyeFrames, long eyeRowBytes, uint8_t* packedFrame, long packedRowBytes, uint32_t row);
+	void						UnpackRow(ThreadRows& rows, const uint8_t* packedFrame, long packedRowBytes, uint8_t* const* eyeFrames, long eyeRowBytes, uint32_t row);
+};
@@ -0,0 +1,398 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <string.h>
+#include <algorithm>
+#include "TextOverlay.h"
+
+// Key weights are scaled by 2^10, as the composite kernel
+static const uint32_t	kKeyShift			= 10;
+static const uint32_t	kKeyScale			= 1 << kKeyShift;
+
+// Text is white on black at narrow range, the box shows the video through it at half brightness.  Samples are
+// 10-bit, RGB planes are blended at 10 bits.
+static const uint16_t	kTextLevel			= 940;
+static const uint16_t	kBoxLevel			= 64;
+static const uint16_t	kChromaZero			= 512;
+static const uint16_t	kBoxInverseKey		= 512;
+static const uint16_t	kMax10BitCode		= 1023;
+static const int		kRGBSampleShift		= 6;				// 16-bit RGB samples to 10 bits
+
+// A glyph of 5x7 font pixels is drawn in a cell of 6x9, with a font pixel of box to its left, above and below
+static const uint32_t	kGlyphWidth			= 5;
+static const uint32_t	kGlyphHeight		= 7;
+static const uint32_t	kCellUnitsWide		= kGlyphWidth + 1;
+static const uint32_t	kCellUnitsHigh		= kGlyphHeight + 2;
+
+// 5x7 font of ASCII ' ' to '_', the most significant of the 5 bits of each row is the leftmost pixel
+static const char		kFirstGlyph			= ' ';
+static const uint32_t	kGlyphCount			= 64;
+static const uint8_t	kFont[kGlyphCount][kGlyphHeight] =
+{
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },		// ' '
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },		// '!'
+	{ 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 },		// '"'
+	{ 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },		// '#'
+	{ 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 },		// '$'
+	{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },		// '%'
+	{ 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D },		// '&'
+	{ 0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 },		// '''
+	{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },		// '('
+	{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },		// ')'
+	{ 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 },		// '*'
+	{ 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },		// '+'
+	{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },		// ','
+	{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },		// '-'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },		// '.'
+	{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },		// '/'
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },		// '0'
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },		// '1'
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },		// '2'
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },		// '3'
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },		// '4'
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },		// '5'
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },		// '6'
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },		// '7'
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },		// '8'
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },		// '9'
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },		// ':'
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 },		// ';'
+	{ 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },		// '<'
+	{ 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },		// '='
+	{ 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },		// '>'
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },		// '?'
+	{ 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E },		// '@'
+	{ 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 },		// 'A'
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },		// 'B'
+	{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },		// 'C'
+	{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },		// 'D'
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },		// 'E'
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },		// 'F'
+	{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },		// 'G'
+	{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },		// 'H'
+	{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },		// 'I'
+	{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },		// 'J'
+	{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },		// 'K'
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },		// 'L'
+	{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },		// 'M'
+	{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },		// 'N'
+	{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },		// 'O'
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },		// 'P'
+	{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },		// 'Q'
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },		// 'R'
+	{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },		// 'S'
+	{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },		// 'T'
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },		// 'U'
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },		// 'V'
+	{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },		// 'W'
+	{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },		// 'X'
+	{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },		// 'Y'
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },		// 'Z'
+	{ 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E },		// '['
+	{ 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 },		// '\'
+	{ 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E },		// ']'
+	{ 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 },		// '^'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }		// '_'
+};
+
+// Pixels and bytes of the smallest group of pixels which can be decoded and encoded on its own, YUV groups are
+// whole pairs of 4:2:2 pixels
+static bool GetPixelGroup(BMDPixelFormat pixelFormat, uint32_t& groupPixels, uint32_t& groupBytes)
+{
+	switch (pixelFormat)
+	{
+		case bmdFormat8BitYUV:
+			groupPixels = 2;	groupBytes = 4;
+			return true;
+
+		case bmdFormat10BitYUV:
+			groupPixels = 6;	groupBytes = 16;
+			return true;
+
+		case bmdFormat10BitYUVA:
+			groupPixels = 2;	groupBytes = 8;
+			return true;
+
+		case bmdFormat8BitARGB:
+		case bmdFormat8BitBGRA:
+		case bmdFormat10BitRGB:
+		case bmdFormat10BitRGBXLE:
+		case bmdFormat10BitRGBX:
+			groupPixels = 1;	groupBytes = 4;
+			return true;
+
+		case bmdFormat12BitRGB:
+		case bmdFormat12BitRGBLE:
+			groupPixels = 8;	groupBytes = 36;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static inline uint32_t GetGlyphIndex(char c)
+{
+	if ((c >= 'a') && (c <= 'z'))
+		c = (char)(c - 'a' + 'A');
+
+	if ((c < kFirstGlyph) || ((uint32_t)(c - kFirstGlyph) >= kGlyphCount))
+		c = '?';
+
+	return (uint32_t)(c - kFirstGlyph);
+}
+
+static inline uint16_t Premultiply(uint16_t level, uint16_t inverseKey)
+{
+	return (uint16_t)(((uint32_t)level * (kKeyScale - inverseKey) + kKeyScale / 2) >> kKeyShift);
+}
+
+TextOverlay::TextOverlay(uint32_t scale) :
+	m_scale(std::max<uint32_t>(scale, 1))
+{
+	m_cellWidth		= kCellUnitsWide * m_scale;
+	m_cellHeight	= kCellUnitsHigh * m_scale;
+
+	// The margin balances the font pixel to the left of the first glyph, rounded up to keep 4:2:2 pairs whole
+	m_marginWidth	= (m_scale + 1) & ~1u;
+
+	RenderAtlas();
+}
+
+bool TextOverlay::IsPixelFormatSupported(BMDPixelFormat pixelFormat)
+{
+	uint32_t groupPixels;
+	uint32_t groupBytes;
+
+	return GetPixelGroup(pixelFormat, groupPixels, groupBytes);
+}
+
+void TextOverlay::GetTextSize(const char* text, uint32_t& width, uint32_t& height) const
+{
+	uint32_t lines		= 1;
+	uint32_t columns	= 0;
+	uint32_t column		= 0;
+
+	if ((text == NULL) || (*text == '\0'))
+	{
+		width	= 0;
+		height	= 0;
+		return;
+	}
+
+	for (const char* c = text; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			lines++;
+			column = 0;
+		}
+		else
+		{
+			columns = std::max(columns, ++column);
+		}
+	}
+
+	width	= columns * m_cellWidth + m_marginWidth;
+	height	= lines * m_cellHeight;
+}
+
+HRESULT TextOverlay::DrawText(const char* text, uint32_t x, uint32_t y, BMDPixelFormat pixelFormat, void* frame, long rowBytes, uint32_t width, uint32_t height)
+{
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	uint32_t					groupPixels;
+	uint32_t					groupBytes;
+	uint32_t					boxWidth;
+	uint32_t					boxHeight;
+
+	if (!GetPixelGroup(pixelFormat, groupPixels, groupBytes) || (rowBytes < GetPixelFormatRowBytes(pixelFormat, width)))
+		return E_INVALIDARG;
+
+	GetTextSize(text, boxWidth, boxHeight);
+
+	x &= ~1u;
+	if ((boxWidth == 0) || (x >= width) || (y >= height))
+		return S_OK;
+
+	// The span of pixel groups holding the visible part of the box
+	const bool		isYUV			= IsYUVPixelFormat(pixelFormat);
+	const uint32_t	columns			= (boxWidth - m_marginWidth) / m_cellWidth;
+	const uint32_t	visibleWidth	= std::min(boxWidth, width - x);
+	const uint32_t	visibleHeight	= std::min(boxHeight, height - y);
+	const uint32_t	spanStart		= (x / groupPixels) * groupPixels;
+	const uint32_t	spanEnd			= std::min(((x + visibleWidth + groupPixels - 1) / groupPixels) * groupPixels, width);
+	const uint32_t	spanWidth		= spanEnd - spanStart;
+	const size_t	spanOffset		= (size_t)(spanStart / groupPixels) * groupBytes;
+	const size_t	spanBytes		= (size_t)((spanWidth + groupPixels - 1) / groupPixels) * groupBytes;
+	const uint32_t	boxOffset		= x - spanStart;
+	const char*		line			= text;
+	uint8_t*		bytes			= (uint8_t*)frame + (size_t)y * rowBytes + spanOffset;
+
+	// The span is decoded from and encoded to a copy, as the row codecs complete the padding of a whole row
+	m_spanBytes.resize(GetPixelFormatRowBytes(pixelFormat, spanWidth));
+	m_planes.luma.resize(spanWidth);
+	m_planes.cb.resize((spanWidth + 1) / 2);
+	m_planes.cr.resize((spanWidth + 1) / 2);
+	m_planes.red.resize(spanWidth);
+	m_planes.green.resize(spanWidth);
+	m_planes.blue.resize(spanWidth);
+	m_planes.alpha.resize(spanWidth);
+
+	for (uint32_t row = 0; row < visibleHeight; row++)
+	{
+		uint32_t	tileRow		= row % m_cellHeight;
+		uint8_t*	frameRow	= bytes + (size_t)row * rowBytes;
+
+		if ((row > 0) && (tileRow == 0))
+			line = strchr(line, '\n') + 1;
+
+		// Each font pixel row is m_scale identical tile rows
+		if ((row == 0) || (tileRow % m_scale == 0))
+			BuildRow(line, columns, tileRow);
+
+		memcpy(m_spanBytes.data(), frameRow, spanBytes);
+		DecodePixelFormatRow(pixelFormat, m_spanBytes.data(), m_planes, spanWidth);
+
+		if (isYUV)
+		{
+			uint32_t chromaCount = (visibleWidth + 1) / 2;
+
+			CompositeRow(m_planes.luma.data() + boxOffset, m_fillRow.data(), m_keyRow.data(), m_planes.luma.data() + boxOffset, visibleWidth);
+			CompositeRow(m_planes.cb.data() + boxOffset / 2, m_chromaFillRow.data(), m_chromaKeyRow.data(), m_planes.cb.data() + boxOffset / 2, chromaCount);
+			CompositeRow(m_planes.cr.data() + boxOffset / 2, m_chromaFillRow.data(), m_chromaKeyRow.data(), m_planes.cr.data() + boxOffset / 2, chromaCount);
+		}
+		else
+		{
+			BlendPlane(m_planes.red.data() + boxOffset, visibleWidth);
+			BlendPlane(m_planes.green.data() + boxOffset, visibleWidth);
+			BlendPlane(m_planes.blue.data() + boxOffset, visibleWidth);
+		}
+
+		EncodePixelFormatRow(pixelFormat, m_planes, m_spanBytes.data(), spanWidth);
+		memcpy(frameRow, m_spanBytes.data(), spanBytes);
+	}
+
+	return S_OK;
+}
+
+void TextOverlay::RenderAtlas(void)
+{
+	const uint32_t	chromaWidth		= m_cellWidth / 2;
+	const size_t	tileSize		= (size_t)m_cellWidth * m_cellHeight;
+
+	m_fillTiles.resize(tileSize * kGlyphCount);
+	m_keyTiles.resize(tileSize * kGlyphCount);
+	m_chromaFillTiles.resize(tileSize / 2 * kGlyphCount);
+	m_chromaKeyTiles.resize(tileSize / 2 * kGlyphCount);
+
+	for (uint32_t glyph = 0; glyph < kGlyphCount; glyph++)
+	{
+		for (uint32_t row = 0; row < m_cellHeight; row++)
+		{
+			size_t		tileRow		= (size_t)glyph * m_cellHeight + row;
+			uint16_t*	fill		= m_fillTiles.data() + tileRow * m_cellWidth;
+			uint16_t*	key			= m_keyTiles.data() + tileRow * m_cellWidth;
+			uint16_t*	chromaFill	= m_chromaFillTiles.data() + tileRow * chromaWidth;
+			uint16_t*	chromaKey	= m_chromaKeyTiles.data() + tileRow * chromaWidth;
+			uint32_t	fontRow		= row / m_scale;
+
+			for (uint32_t column = 0; column < m_cellWidth; column++)
+			{
+				uint32_t	fontColumn	= column / m_scale;
+				bool		isText		= (fontRow >= 1) && (fontRow <= kGlyphHeight) && (fontColumn >= 1) &&
+										  (kFont[glyph][fontRow - 1] & (0x20 >> fontColumn));
+
+				key[column]		= isText ? 0 : kBoxInverseKey;
+				fill[column]	= Premultiply(isText ? kTextLevel : kBoxLevel, key[column]);
+			}
+
+			// Chroma is keyed with the average weight of each pair of pixels
+			for (uint32_t column = 0; column < chromaWidth; column++)
+			{
+				chromaKey[column]	= (uint16_t)((key[column * 2] + key[column * 2 + 1] + 1) / 2);
+				chromaFill[column]	= Premultiply(kChromaZero, chromaKey[column]);
+			}
+		}
+	}
+}
+
+void TextOverlay::BuildRow(const char* line, uint32_t columns, uint32_t tileRow)
+{
+	const uint32_t	chromaWidth		= m_cellWidth / 2;
+	const uint32_t	rowWidth		= columns * m_cellWidth + m_marginWidth;
+	bool			endOfLine		= false;
+
+	m_fillRow.resize(rowWidth);
+	m_keyRow.resize(rowWidth);
+	m_chromaFillRow.resize(rowWidth / 2);
+	m_chromaKeyRow.resize(rowWidth / 2);
+
+	// Lines shorter than the box are completed with spaces
+	for (uint32_t column = 0; column < columns; column++)
+	{
+		// The line is not read past its end
+		endOfLine = endOfLine || (line[column] == '\0') || (line[column] == '\n');
+
+		size_t tile = (size_t)GetGlyphIndex(endOfLine ? ' ' : line[column]) * m_cellHeight + tileRow;
+
+		memcpy(&m_fillRow[column * m_cellWidth], &m_fillTiles[tile * m_cellWidth], m_cellWidth * sizeof(uint16_t));
+		memcpy(&m_keyRow[column * m_cellWidth], &m_keyTiles[tile * m_cellWidth], m_cellWidth * sizeof(uint16_t));
+		memcpy(&m_chromaFillRow[column * chromaWidth], &m_chromaFillTiles[tile * chromaWidth], chromaWidth * sizeof(uint16_t));
+		memcpy(&m_chromaKeyRow[column * chromaWidth], &m_chromaKeyTiles[tile * chromaWidth], chromaWidth * sizeof(uint16_t));
+	}
+
+	std::fill(m_fillRow.begin() + columns * m_cellWidth, m_fillRow.end(), Premultiply(kBoxLevel, kBoxInverseKey));
+	std::fill(m_keyRow.begin() + columns * m_cellWidth, m_keyRow.end(), kBoxInverseKey);
+	std::fill(m_chromaFillRow.begin() + columns * chromaWidth, m_chromaFillRow.end(), Premultiply(kChromaZero, kBoxInverseKey));
+	std::fill(m_chromaKeyRow.begin() + columns * chromaWidth, m_chromaKeyRow.end(), kBoxInverseKey);
+}
+
+void TextOverlay::BlendPlane(uint16_t* samples, uint32_t count)
+{
+	m_blendRow.resize(count);
+
+	for (uint32_t i = 0; i < count; i++)
+		m_blendRow[i] = (uint16_t)std::min<uint32_t>((samples[i] + (1 << (kRGBSampleShift - 1))) >> kRGBSampleShift, kMax10BitCode);
+
+	CompositeRow(m_blendRow.data(), m_fillRow.data(), m_keyRow.data(), m_blendRow.data(), count);
+
+	for (uint32_t i = 0; i < count; i++)
+		samples[i] = (uint16_t)(m_blendRow[i] << kRGBSampleShift);
+}
@@ -0,0 +1,104 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "VideoConversion.h"
+#include "VideoKernels.h"
+
+// TextOverlay burns lines of text into frames of the uncompressed pixel formats supported by VideoConversion,
+// as white capitals on a translucent black box, for timecode and other captions which must survive the
+// signal chain.
+//
+// The 5x7 font is rendered once, at the text scale, to an atlas of glyph tiles of premultiplied fill and inverse
+// key for luma or R'G'B', and for 4:2:2 chroma.  Drawing touches only the frame rows of the text box, and in
+// each row only the pixel groups of the format which hold the box: the span is decoded to planar samples, the
+// tile rows of its glyphs are blended over it by the compositing kernel of KeyingCompositor (see CompositeRow())
+// and the span is encoded again.  RGB samples are blended at 10 bits, which is exact for 10-bit RGB, and alpha is
+// kept.
+//
+// Calls from multiple threads are serialized.
+
+class TextOverlay
+{
+public:
+	// scale is the size of a font pixel in frame pixels
+	explicit TextOverlay(uint32_t scale);
+
+	uint32_t		GetScale(void) const { return m_scale; }
+
+	static bool		IsPixelFormatSupported(BMDPixelFormat pixelFormat);
+
+	// Size of the text box of lines separated by '\n'.  Lower case letters are drawn as capitals and characters
+	// not in the font as '?'.
+	void			GetTextSize(const char* text, uint32_t& width, uint32_t& height) const;
+
+	// Draw text with the top left of its box at x, y, x is rounded down to an even pixel.  The box is clipped to
+	// the frame.  Returns E_INVALIDARG if the pixel format is not supported or a row is too short.
+	HRESULT			DrawText(const char* text, uint32_t x, uint32_t y, BMDPixelFormat pixelFormat, void* frame, long rowBytes, uint32_t width, uint32_t height);
+
+private:
+	typedef VideoConversion::RowPlanes	RowPlanes;
+
+	uint32_t				m_scale;
+	uint32_t				m_cellWidth;			// A glyph and the spacing around it, in frame pixels
+	uint32_t				m_cellHeight;
+	uint32_t				m_marginWidth;			// Box to the right of the last glyph
+	std::vector<uint16_t>	m_fillTiles;			// Tiles of each glyph, m_cellWidth by m_cellHeight samples
+	std::vector<uint16_t>	m_keyTiles;
+	std::vector<uint16_t>	m_chromaFillTiles;		// m_cellWidth / 2 by m_cellHeight samples
+	std::vector<uint16_t>	m_chromaKeyTiles;
+
+	std::mutex				m_mutex;
+	std::vector<uint16_t>	m_fillRow;				// Tile rows of a row of the box
+	std::vector<uint16_t>	m_keyRow;
+	std::vector<uint16_t>	m_chromaFillRow;
+	std::vector<uint16_t>	m_chromaKeyRow;
+	std::vector<uint16_t>	m_blendRow;				// Samples of an RGB plane at 10 bits
+	std::vector<uint8_t>	m_spanBytes;			// Span of a frame row
+	RowPlanes				m_planes;
+
+	void					RenderAtlas(void);
+	void					BuildRow(const char* line, uint32_t columns, uint32_t tileRow);
+	void					BlendPlane(uint16_t* samples, uint32_t count);
+};
@@ -0,0 +1,167 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include "TimecodeBurnIn.h"
+
+// The text is in the top left of the title safe area, a 1/20 of the frame from each edge
+static const uint32_t	kSafeAreaDivisor		= 20;
+
+// A font pixel is a 1/270 of the frame height, 4 pixels at 1080 lines
+static const uint32_t	kFontPixelsPerFrame		= 270;
+static const uint32_t	kMinFontPixel			= 2;
+
+static const size_t		kMaxDeviceNameLength	= 32;
+static const size_t		kMaxTextLength			= 128;
+
+static const char* const	kTimecodeSourceNames[] = { "RP188", "VITC", "GEN" };
+
+void ComputeTimecode(uint64_t frameNumber, BMDTimeValue frameDuration, BMDTimeScale timeScale, BurnInTimecode& timecode)
+{
+	// Nominal frames per second, 30 at 29.97
+	uint32_t	framesPerSecond	= std::max<uint32_t>((uint32_t)((timeScale + frameDuration / 2) / frameDuration), 1);
+	uint64_t	totalSeconds;
+
+	timecode.dropFrame	= ((timeScale % frameDuration) != 0) && ((framesPerSecond % 30) == 0);
+	timecode.source		= kTimecodeSourceComputed;
+
+	if (timecode.dropFrame)
+	{
+		// Frame numbers 0 and 1 (or 0 to 3 at 59.94) are dropped at the start of each minute, except every tenth
+		uint32_t	droppedFrames		= framesPerSecond / 15;
+		uint64_t	framesPerMinute		= (uint64_t)framesPerSecond * 60 - droppedFrames;
+		uint64_t	framesPerTenMinutes	= (uint64_t)framesPerSecond * 600 - droppedFrames * 9;
+		uint64_t	tenMinutes			= frameNumber / framesPerTenMinutes;
+		uint64_t	remainder			= frameNumber % framesPerTenMinutes;
+
+		frameNumber += droppedFrames * 9 * tenMinutes;
+		if (remainder > droppedFrames)
+			frameNumber += droppedFrames * ((remainder - droppedFrames) / framesPerMinute);
+	}
+
+	totalSeconds		= frameNumber / framesPerSecond;
+	timecode.frames		= (uint8_t)(frameNumber % framesPerSecond);
+	timecode.seconds	= (uint8_t)(totalSeconds % 60);
+	timecode.minutes	= (uint8_t)((totalSeconds / 60) % 60);
+	timecode.hours		= (uint8_t)((totalSeconds / 3600) % 24);
+}
+
+TimecodeBurnIn::TimecodeBurnIn(const char* deviceName, BMDTimeScale timeScale) :
+	m_deviceName(deviceName != NULL ? deviceName : ""),
+	m_timeScale(timeScale),
+	m_textHeight(0)
+{
+	if (m_deviceName.length() > kMaxDeviceNameLength)
+		m_deviceName.resize(kMaxDeviceNameLength);
+
+	std::replace(m_deviceName.begin(), m_deviceName.end(), '\n', ' ');
+}
+
+HRESULT TimecodeBurnIn::BurnIn(IDeckLinkVideoFrame* frame, BMDTimeValue streamTime, BMDTimeValue frameDuration)
+{
+	BurnInTimecode	timecode;
+	char			text[kMaxTextLength];
+	void*			bytes;
+
+	if (frame == NULL)
+		return E_POINTER;
+
+	if (!TextOverlay::IsPixelFormatSupported(frame->GetPixelFormat()) || (frameDuration <= 0))
+		return E_INVALIDARG;
+
+	GetFrameTimecode(frame, streamTime, frameDuration, m_timeScale, timecode);
+	FormatText(timecode, streamTime, frameDuration, text, sizeof(text));
+
+	if (frame->GetBytes(&bytes) != S_OK)
+		return E_FAIL;
+
+	std::lock_guard<std::mutex>	lock(m_mutex);
+	uint32_t					width	= (uint32_t)frame->GetWidth();
+	uint32_t					height	= (uint32_t)frame->GetHeight();
+
+	if (!m_textOverlay || (m_textHeight != height))
+	{
+		m_textOverlay.reset(new TextOverlay(std::max(height / kFontPixelsPerFrame, kMinFontPixel)));
+		m_textHeight = height;
+	}
+
+	return m_textOverlay->DrawText(text, width / kSafeAreaDivisor, height / kSafeAreaDivisor, frame->GetPixelFormat(), bytes, frame->GetRowBytes(), width, height);
+}
+
+void TimecodeBurnIn::GetFrameTimecode(IDeckLinkVideoFrame* frame, BMDTimeValue streamTime, BMDTimeValue frameDuration, BMDTimeScale timeScale, BurnInTimecode& timecode)
+{
+	static const BMDTimecodeFormat	kTimecodeFormats[] = { bmdTimecodeRP188Any, bmdTimecodeVITC };
+	static const TimecodeSource		kTimecodeSources[] = { kTimecodeSourceRP188, kTimecodeSourceVITC };
+
+	for (size_t i = 0; (frame != NULL) && (i < sizeof(kTimecodeFormats) / sizeof(kTimecodeFormats[0])); i++)
+	{
+		IDeckLinkTimecode*	frameTimecode	= NULL;
+		bool				found			= false;
+
+		if (frame->GetTimecode(kTimecodeFormats[i], &frameTimecode) != S_OK)
+			continue;
+
+		if ((frameTimecode != NULL) &&
+			(frameTimecode->GetComponents(&timecode.hours, &timecode.minutes, &timecode.seconds, &timecode.frames) == S_OK))
+		{
+			timecode.dropFrame	= (frameTimecode->GetFlags() & bmdTimecodeIsDropFrame) != 0;
+			timecode.source		= kTimecodeSources[i];
+			found				= true;
+		}
+
+		if (frameTimecode != NULL)
+			frameTimecode->Release();
+
+		if (found)
+			return;
+	}
+
+	ComputeTimecode((uint64_t)(streamTime / frameDuration), frameDuration, timeScale, timecode);
+}
+
+int TimecodeBurnIn::FormatText(const BurnInTimecode& timecode, BMDTimeValue streamTime, BMDTimeValue frameDuration, char* text, size_t size) const
+{
+	// Drop frame timecode separates the frames with ';'
+	return snprintf(text, size, "TC %02u:%02u:%02u%c%02u %s\nFRAME %llu\n%s\nTIME %.3f S",
+					timecode.hours, timecode.minutes, timecode.seconds, timecode.dropFrame ? ';' : ':', timecode.frames,
+					kTimecodeSourceNames[timecode.source], (unsigned long long)(streamTime / frameDuration),
+					m_deviceName.c_str(), (double)streamTime / m_timeScale);
+}
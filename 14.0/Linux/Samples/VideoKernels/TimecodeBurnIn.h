@@ -0,0 +1,102 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include "DeckLinkAPI.h"
+#include "TextOverlay.h"
+
+// TimecodeBurnIn burns the timecode, frame number, device name and stream time of each frame into it, in the top
+// left of the title safe area, for QC of live and generated video and for measuring latency through a chain.
+//
+// The timecode is the frame's RP188 timecode, or VITC if it has none, and otherwise is computed from the frame
+// number and frame rate, counting drop frame at 29.97 and 59.94 fps.  The text is drawn by a TextOverlay with a
+// font pixel of a 1/270 of the frame height and at least 2 pixels, which is created again when the frame height
+// changes.
+//
+// Calls from multiple threads are serialized.
+
+enum TimecodeSource
+{
+	kTimecodeSourceRP188 = 0,
+	kTimecodeSourceVITC,
+	kTimecodeSourceComputed
+};
+
+struct BurnInTimecode
+{
+	uint8_t			hours;
+	uint8_t			minutes;
+	uint8_t			seconds;
+	uint8_t			frames;
+	bool			dropFrame;
+	TimecodeSource	source;
+};
+
+// Compute the timecode of a frame number counted from 00:00:00:00, at timeScale / frameDuration frames per
+// second.  Hours wrap at 24.
+void	ComputeTimecode(uint64_t frameNumber, BMDTimeValue frameDuration, BMDTimeScale timeScale, BurnInTimecode& timecode);
+
+class TimecodeBurnIn
+{
+public:
+	// timeScale is the time scale of stream times and frame durations, deviceName is shown on the third line
+	TimecodeBurnIn(const char* deviceName, BMDTimeScale timeScale);
+
+	// Burn the text of a frame at streamTime into it.  Returns E_INVALIDARG if the pixel format is not supported.
+	HRESULT		BurnIn(IDeckLinkVideoFrame* frame, BMDTimeValue streamTime, BMDTimeValue frameDuration);
+
+	// Get the timecode of a frame, see above
+	static void	GetFrameTimecode(IDeckLinkVideoFrame* frame, BMDTimeValue streamTime, BMDTimeValue frameDuration, BMDTimeScale timeScale, BurnInTimecode& timecode);
+
+	// Format the text burnt into a frame, returns the length of the text
+	int			FormatText(const BurnInTimecode& timecode, BMDTimeValue streamTime, BMDTimeValue frameDuration, char* text, size_t size) const;
+
+private:
+	std::string						m_deviceName;
+	BMDTimeScale					m_timeScale;
+
+	std::mutex						m_mutex;
+	std::unique_ptr<TextOverlay>	m_textOverlay;
+	uint32_t						m_textHeight;			// Frame height of the overlay's scale
+};
@@ -0,0 +1,218 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "ToneGenerator.h"
+#include "VideoKernels.h"
+
+// Sequences are timed in steps of 50ms
+static const uint32_t	kStepsPerSecond			= 20;
+
+// Channel ident breaks and tone between them are 2 steps, and the tones are unbroken for a second after the breaks
+static const uint32_t	kIdentBreakSteps		= 2;
+static const uint32_t	kIdentTailSteps			= kStepsPerSecond;
+
+// EBU line-up: a 250ms break of the left channel every 3 seconds
+static const uint32_t	kEBUCycleSteps			= 60;
+static const uint32_t	kEBUBreakSteps			= 5;
+
+// GLITS line-up: a 4 second cycle, with a left break at step 0 and right breaks at steps 10 and 20, of 250ms each
+static const uint32_t	kGLITSCycleSteps		= 80;
+static const uint32_t	kGLITSBreakSteps		= 5;
+static const uint32_t	kGLITSLeftBreak			= 0;
+static const uint32_t	kGLITSRightBreaks[2]	= { 10, 20 };
+
+// Integer samples are rendered as float in blocks of this many sample frames, small enough to stay in L1 cache
+static const uint32_t	kBlockSampleFrames		= 64;
+
+static bool InBreak(uint32_t step, uint32_t breakStart, uint32_t breakSteps)
+{
+	return (step >= breakStart) && (step < breakStart + breakSteps);
+}
+
+ToneGenerator::ToneGenerator(uint32_t channels, uint32_t sampleRate) :
+	m_channels(std::min(std::max(channels, 1u), kMaxToneChannels)),
+	m_sampleRate(sampleRate),
+	m_stepFrames(std::max(sampleRate / kStepsPerSecond, 1u)),
+	m_sequence(kToneSequenceContinuous),
+	m_cycleSteps(1),
+	m_step(0),
+	m_stepPosition(0),
+	m_block((size_t)kBlockSampleFrames * m_channels)
+{
+	std::fill(m_increments, m_increments + kMaxToneChannels, 0);
+	std::fill(m_levels, m_levels + kMaxToneChannels, 0.0f);
+
+	SetTone(kDefaultToneFrequency, kDefaultToneLevel);
+	Reset();
+}
+
+bool ToneGenerator::SetTone(uint32_t channel, double frequency, double level)
+{
+	if ((channel >= m_channels) || (frequency < 0.0) || (frequency * 2.0 >= m_sampleRate))
+		return false;
+
+	// A turn of phase is 2^32
+	m_increments[channel]	= (uint32_t)llround(frequency / m_sampleRate * 4294967296.0);
+	m_levels[channel]		= (float)pow(10.0, std::min(level, 0.0) / 20.0);
+
+	UpdateStepLevels();
+	return true;
+}
+
+bool ToneGenerator::SetTone(double frequency, double level)
+{
+	for (uint32_t channel = 0; channel < m_channels; channel++)
+	{
+		if (!SetTone(channel, frequency, level))
+			return false;
+	}
+
+	return true;
+}
+
+void ToneGenerator::SetSequence(ToneSequence sequence)
+{
+	m_sequence = sequence;
+
+	switch (sequence)
+	{
+		case kToneSequenceChannelIdent:
+			m_cycleSteps = m_channels * kIdentBreakSteps * 2 + kIdentTailSteps;
+			break;
+
+		case kToneSequenceEBU:
+			m_cycleSteps = kEBUCycleSteps;
+			break;
+
+		case kToneSequenceGLITS:
+			m_cycleSteps = kGLITSCycleSteps;
+			break;
+
+		default:
+			m_sequence = kToneSequenceContinuous;
+			m_cycleSteps = 1;
+			break;
+	}
+
+	m_step			= 0;
+	m_stepPosition	= 0;
+	UpdateStepLevels();
+}
+
+void ToneGenerator::Reset(void)
+{
+	std::fill(m_phases, m_phases + kMaxToneChannels, 0);
+
+	m_step			= 0;
+	m_stepPosition	= 0;
+	UpdateStepLevels();
+}
+
+bool ToneGenerator::IsToneOn(uint32_t channel, uint32_t step) const
+{
+	bool left = (channel % 2) == 0;
+
+	step %= m_cycleSteps;
+
+	switch (m_sequence)
+	{
+		case kToneSequenceChannelIdent:
+			// Channel n has n breaks, each the first half of a period of 2 * kIdentBreakSteps
+			return (step >= (channel + 1) * kIdentBreakSteps * 2) || ((step % (kIdentBreakSteps * 2)) >= kIdentBreakSteps);
+
+		case kToneSequenceEBU:
+			return !left || !InBreak(step, 0, kEBUBreakSteps);
+
+		case kToneSequenceGLITS:
+			if (left)
+				return !InBreak(step, kGLITSLeftBreak, kGLITSBreakSteps);
+			return !InBreak(step, kGLITSRightBreaks[0], kGLITSBreakSteps) && !InBreak(step, kGLITSRightBreaks[1], kGLITSBreakSteps);
+
+		default:
+			return true;
+	}
+}
+
+void ToneGenerator::UpdateStepLevels(void)
+{
+	for (uint32_t channel = 0; channel < m_channels; channel++)
+		m_stepLevels[channel] = IsToneOn(channel, m_step) ? m_levels[channel] : 0.0f;
+}
+
+void ToneGenerator::RenderFloat(float* output, uint32_t sampleFrames)
+{
+	while (sampleFrames > 0)
+	{
+		// Render to the end of the step, the levels only change between steps
+		uint32_t frames = std::min(sampleFrames, m_stepFrames - m_stepPosition);
+
+		RenderToneFrames(m_phases, m_increments, m_stepLevels, m_channels, output, frames);
+
+		output			+= (size_t)frames * m_channels;
+		sampleFrames	-= frames;
+		m_stepPosition	+= frames;
+
+		if (m_stepPosition == m_stepFrames)
+		{
+			m_step			= (m_step + 1) % m_cycleSteps;
+			m_stepPosition	= 0;
+			UpdateStepLevels();
+		}
+	}
+}
+
+void ToneGenerator::Render(void* output, uint32_t sampleFrames, uint32_t sampleDepth)
+{
+	const size_t	sampleBytes = (sampleDepth == 32) ? sizeof(int32_t) : sizeof(int16_t);
+	uint8_t*		nextOutput = (uint8_t*)output;
+
+	while (sampleFrames > 0)
+	{
+		uint32_t frames = std::min(sampleFrames, kBlockSampleFrames);
+
+		RenderFloat(m_block.data(), frames);
+		QuantizeAudioSamples(m_block.data(), nextOutput, frames * m_channels, sampleDepth);
+
+		nextOutput		+= frames * m_channels * sampleBytes;
+		sampleFrames	-= frames;
+	}
+}
@@ -0,0 +1,120 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// ToneGenerator streams interleaved audio of a sine tone on each channel, with a frequency and level per channel,
+// for line-up and channel identification.  Each channel is a numerically controlled oscillator rendered by the tone
+// kernel (see RenderToneFrames()), so the tones are phase continuous across calls and any number of sample frames
+// may be rendered at a time.
+//
+// Sequences interrupt the tones, in steps of 50ms, while the oscillators keep running:
+//  - Channel ident: channel n, from 1, has n breaks of 100ms separated by 100ms of tone, then all channels have
+//    tone until a second after the breaks of the last channel.
+//  - EBU: EBU Tech 3304 stereo line-up, the left channel has a 250ms break every 3 seconds, the right channel is
+//    continuous.
+//  - GLITS: the GLITS stereo line-up, a 4 second cycle in which the left channel has a break at 0ms and the right
+//    channel breaks at 500ms and 1000ms, each of 250ms.
+// Even channels are left and odd channels right.
+//
+// ToneGenerator is not thread safe.
+
+enum ToneSequence
+{
+	kToneSequenceContinuous = 0,
+	kToneSequenceChannelIdent,
+	kToneSequenceEBU,
+	kToneSequenceGLITS,
+	kToneSequenceCount
+};
+
+static const uint32_t	kMaxToneChannels		= 64;
+static const double		kDefaultToneFrequency	= 1000.0;
+static const double		kDefaultToneLevel		= -18.0;		// dBFS, EBU alignment level
+
+class ToneGenerator
+{
+public:
+	// channels is limited to kMaxToneChannels, sampleRate must be a multiple of 20
+	explicit ToneGenerator(uint32_t channels, uint32_t sampleRate = 48000);
+
+	uint32_t			GetChannels(void) const { return m_channels; }
+
+	// Sample frames in a cycle of the sequence, a 50ms step for continuous tone
+	uint32_t			GetCycleSampleFrames(void) const { return m_cycleSteps * m_stepFrames; }
+
+	// Set the tone of a channel, from 0, with a level in dBFS of the peak up to 0.  Returns false if the channel
+	// is out of range or the frequency is not below half the sample rate.
+	bool				SetTone(uint32_t channel, double frequency, double level);
+	// Set the tone of all channels
+	bool				SetTone(double frequency, double level);
+	void				SetSequence(ToneSequence sequence);
+
+	// Restart the tones and the sequence at phase zero
+	void				Reset(void);
+
+	// Render the next sampleFrames frames of 16 or 32-bit integer samples, or float samples with a full scale of 1.0
+	void				Render(void* output, uint32_t sampleFrames, uint32_t sampleDepth);
+	void				RenderFloat(float* output, uint32_t sampleFrames);
+
+	// Whether a channel has tone in a 50ms step of the sequence
+	bool				IsToneOn(uint32_t channel, uint32_t step) const;
+
+private:
+	uint32_t			m_channels;
+	uint32_t			m_sampleRate;
+	uint32_t			m_stepFrames;						// Sample frames in a 50ms step of the sequence
+	ToneSequence		m_sequence;
+	uint32_t			m_cycleSteps;
+
+	uint32_t			m_phases[kMaxToneChannels];
+	uint32_t			m_increments[kMaxToneChannels];
+	float				m_levels[kMaxToneChannels];
+	float				m_stepLevels[kMaxToneChannels];		// Levels of the current step, zero in a break
+
+	uint32_t			m_step;
+	uint32_t			m_stepPosition;						// Sample frames of the current step rendered
+	std::vector<float>	m_block;							// Float samples quantized by Render()
+
+	void				UpdateStepLevels(void);
+};
@@ -0,0 +1,340 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "ToneMapper.h"
+
+// Grid points on each axis of the 3D table, the shaper keeps the steps between them small
+static const uint32_t	kLUT3DGridSize			= 33;
+
+// Planes are padded to whole v210 blocks of 48 pixels for the unpack and pack kernels
+static const uint32_t	kV210BlockPixels		= 48;
+
+static const double		kPQPeakLuminance		= 10000.0;
+static const double		kDefaultPeakLuminance	= 1000.0;		// PQ content without mastering metadata
+static const double		kHLGPeakLuminance		= 1000.0;		// Nominal peak of the HLG reference display
+static const double		kHLGSystemGamma			= 1.2;			// BT.2100 OOTF gamma for a 1000 cd/m2 display
+static const double		kSDRReferenceWhite		= 203.0;		// BT.2408 HDR reference white, mapped to SDR peak white
+static const double		kSDRGamma				= 2.4;			// BT.1886
+
+// ST 2084 constants
+static const double		kPQm1					= 2610.0 / 16384.0;
+static const double		kPQm2					= 2523.0 / 4096.0 * 128.0;
+static const double		kPQc1					= 3424.0 / 4096.0;
+static const double		kPQc2					= 2413.0 / 4096.0 * 32.0;
+static const double		kPQc3					= 2392.0 / 4096.0 * 32.0;
+
+// BT.2100 HLG constants
+static const double		kHLGa					= 0.17883277;
+static const double		kHLGb					= 1.0 - 4.0 * kHLGa;
+static const double		kHLGc					= 0.5 - kHLGa * log(4.0 * kHLGa);
+
+// Rec.2020 luminance and Rec.2020 to Rec.709 linear RGB
+static const double		kRec2020Luminance[3]	= { 0.2627, 0.6780, 0.0593 };
+static const double		kRec2020ToRec709[3][3]	=
+{
+	{  1.6605, -0.5876, -0.0728 },
+	{ -0.1246,  1.1329, -0.0083 },
+	{ -0.0182, -0.1006,  1.1187 }
+};
+
+static inline uint32_t PaddedSampleCount(uint32_t count)
+{
+	return ((count + kV210BlockPixels - 1) / kV210BlockPixels) * kV210BlockPixels;
+}
+
+static inline uint16_t SampleFromValue(double value)
+{
+	return (uint16_t)lrint(std::min(std::max(value, 0.0), 1.0) * 65535.0);
+}
+
+// ST 2084 EOTF, PQ code to cd/m2, and its inverse
+static double PQToLuminance(double code)
+{
+	double e = pow(std::max(code, 0.0), 1.0 / kPQm2);
+
+	return kPQPeakLuminance * pow(std::max(e - kPQc1, 0.0) / (kPQc2 - kPQc3 * e), 1.0 / kPQm1);
+}
+
+static double LuminanceToPQ(double luminance)
+{
+	double y = pow(std::min(std::max(luminance / kPQPeakLuminance, 0.0), 1.0), kPQm1);
+
+	return pow((kPQc1 + kPQc2 * y) / (1.0 + kPQc3 * y), kPQm2);
+}
+
+// BT.2100 HLG OETF, relative scene light to HLG code, and its inverse
+static double HLGOETF(double light)
+{
+	light = std::max(light, 0.0);
+	return (light <= 1.0 / 12.0) ? sqrt(3.0 * light) : kHLGa * log(12.0 * light - kHLGb) + kHLGc;
+}
+
+static double HLGInverseOETF(double code)
+{
+	code = std::max(code, 0.0);
+	return (code <= 0.5) ? code * code / 3.0 : (exp((code - kHLGc) / kHLGa) + kHLGb) / 12.0;
+}
+
+static double Rec2020Luminance(const double* rgb)
+{
+	return kRec2020Luminance[0] * rgb[0] + kRec2020Luminance[1] * rgb[1] + kRec2020Luminance[2] * rgb[2];
+}
+
+static double SourcePeakLuminance(const ToneMapMetadata& metadata)
+{
+	double peak;
+
+	if (metadata.transferFunction == kTransferHLG)
+		return kHLGPeakLuminance;
+
+	if (metadata.maxContentLightLevel > 0.0)
+		peak = metadata.maxContentLightLevel;
+	else if (metadata.maxDisplayMasteringLuminance > 0.0)
+		peak = metadata.maxDisplayMasteringLuminance;
+	else
+		peak = kDefaultPeakLuminance;
+
+	return std::min(peak, kPQPeakLuminance);
+}
+
+// BT.2390 EETF, compressing luminances above the knee to the target peak in the PQ domain.  The black
+// level of source and target is 0.
+static double EETF(double luminance, double sourcePeak, double targetPeak)
+{
+	double sourceRange	= LuminanceToPQ(sourcePeak);
+	double maxLum		= LuminanceToPQ(targetPeak) / sourceRange;
+	double kneeStart	= 1.5 * maxLum - 0.5;
+	double e			= std::min(LuminanceToPQ(luminance) / sourceRange, 1.0);
+
+	if (e >= kneeStart)
+	{
+		double t	= (e - kneeStart) / (1.0 - kneeStart);
+		double t2	= t * t;
+		double t3	= t2 * t;
+
+		e = (2.0 * t3 - 3.0 * t2 + 1.0) * kneeStart + (t3 - 2.0 * t2 + t) * (1.0 - kneeStart) + (-2.0 * t3 + 3.0 * t2) * maxLum;
+	}
+
+	return PQToLuminance(e * sourceRange);
+}
+
+ToneMapper::ToneMapper(uint32_t width, uint32_t height, TransferFunction outputTransferFunction, unsigned threadCount) :
+	m_width(width),
+	m_height(height),
+	m_outputTransferFunction(outputTransferFunction),
+	m_lutsValid(false),
+	m_lutMetadata(),
+	m_lutBuildCount(0),
+	m_shaperEnabled(false),
+	m_workerPool(threadCount)
+{
+	Colorimetry inputColorimetry	= { kColorimetryRec2020, kColorimetryNarrowRange, kColorimetryFullRange, kChromaSitingCosited };
+	Colorimetry outputColorimetry	= { (outputTransferFunction == kTransferHLG) ? kColorimetryRec2020 : kColorimetryRec709,
+										kColorimetryNarrowRange, kColorimetryFullRange, kChromaSitingCosited };
+
+	GetColorimetryCoefficients(inputColorimetry, m_inputCoefficients);
+	GetColorimetryCoefficients(outputColorimetry, m_outputCoefficients);
+
+	m_shaperLUT.resize(kLUT1DSize);
+	m_lut3DEntries.resize((size_t)kLUT3DGridSize * kLUT3DGridSize * kLUT3DGridSize * 4);
+	m_lut3D.size	= kLUT3DGridSize;
+	m_lut3D.entries	= m_lut3DEntries.data();
+
+	m_threadRows.resize(m_workerPool.GetThreadCount());
+	for (ThreadRows& rows : m_threadRows)
+	{
+		rows.luma.resize(PaddedSampleCount(width));
+		rows.cb.resize(PaddedSampleCount(width) / 2);
+		rows.cr.resize(PaddedSampleCount(width) / 2);
+		rows.red.resize(PaddedSampleCount(width));
+		rows.green.resize(PaddedSampleCount(width));
+		rows.blue.resize(PaddedSampleCount(width));
+	}
+}
+
+bool ToneMapper::IsConversionSupported(TransferFunction inputTransferFunction, TransferFunction outputTransferFunction)
+{
+	if (inputTransferFunction == kTransferPQ)
+		return (outputTransferFunction == kTransferHLG) || (outputTransferFunction == kTransferSDR);
+
+	return (inputTransferFunction == kTransferHLG) && (outputTransferFunction == kTransferSDR);
+}
+
+HRESULT ToneMapper::ToneMapV210(const ToneMapMetadata& metadata, const void* srcFrame, long srcRowBytes, void* dstFrame, long dstRowBytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ((srcFrame == NULL) || (dstFrame == NULL))
+		return E_POINTER;
+
+	if (!IsConversionSupported(metadata.transferFunction, m_outputTransferFunction))
+		return E_INVALIDARG;
+
+	if ((srcRowBytes < (long)V210RowBytes(m_width)) || (dstRowBytes < (long)V210RowBytes(m_width)))
+		return E_INVALIDARG;
+
+	if (!m_lutsValid || (metadata != m_lutMetadata))
+		BuildLUTs(metadata);
+
+	// Rows are independent, so slices are several per thread to balance the load
+	uint32_t sliceCount		= std::min<uint32_t>(m_height, m_workerPool.GetThreadCount() * 4);
+	uint32_t rowsPerSlice	= (m_height + sliceCount - 1) / sliceCount;
+	sliceCount				= (m_height + rowsPerSlice - 1) / rowsPerSlice;
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		uint32_t firstRow = slice * rowsPerSlice;
+		ToneMapRows(m_threadRows[threadIndex], (const uint8_t*)srcFrame, srcRowBytes, (uint8_t*)dstFrame, dstRowBytes,
+					firstRow, std::min(rowsPerSlice, m_height - firstRow));
+	});
+
+	return S_OK;
+}
+
+void ToneMapper::BuildLUTs(const ToneMapMetadata& metadata)
+{
+	const double	sourcePeak	= SourcePeakLuminance(metadata);
+	const double	targetPeak	= (m_outputTransferFunction == kTransferHLG) ? kHLGPeakLuminance : kSDRReferenceWhite;
+	const bool		inputPQ		= (metadata.transferFunction == kTransferPQ);
+	// PQ codes above the peak of the content are clipped by the shaper
+	const double	shaperRange	= inputPQ ? LuminanceToPQ(sourcePeak) : 1.0;
+	const uint32_t	gridMax		= kLUT3DGridSize - 1;
+	uint16_t*		entry		= m_lut3DEntries.data();
+
+	m_shaperEnabled = inputPQ;
+	if (m_shaperEnabled)
+	{
+		for (uint32_t i = 0; i < kLUT1DSize; i++)
+			m_shaperLUT[i] = SampleFromValue((std::min<uint32_t>(i * 16, 0xFFFF) / 65535.0) / shaperRange);
+	}
+
+	for (uint32_t b = 0; b <= gridMax; b++)
+	{
+		for (uint32_t g = 0; g <= gridMax; g++)
+		{
+			for (uint32_t r = 0; r <= gridMax; r++)
+			{
+				double	code[3]	= { (double)r / gridMax, (double)g / gridMax, (double)b / gridMax };
+				double	rgb[3];
+
+				// Display light in cd/m2
+				if (inputPQ)
+				{
+					for (int c = 0; c < 3; c++)
+						rgb[c] = PQToLuminance(code[c] * shaperRange);
+				}
+				else
+				{
+					for (int c = 0; c < 3; c++)
+						rgb[c] = HLGInverseOETF(code[c]);
+
+					double ootfGain = kHLGPeakLuminance * pow(std::max(Rec2020Luminance(rgb), 0.0), kHLGSystemGamma - 1.0);
+
+					for (int c = 0; c < 3; c++)
+						rgb[c] *= ootfGain;
+				}
+
+				// Tone map the maximum component, scaling each component by the same ratio
+				double maxComponent = std::max(std::max(rgb[0], rgb[1]), rgb[2]);
+
+				if ((sourcePeak > targetPeak) && (maxComponent > 0.0))
+				{
+					double ratio = EETF(maxComponent, sourcePeak, targetPeak) / maxComponent;
+
+					for (int c = 0; c < 3; c++)
+						rgb[c] *= ratio;
+				}
+
+				if (m_outputTransferFunction == kTransferHLG)
+				{
+					// Inverse OOTF to relative scene light, then the OETF
+					double displayLuminance = Rec2020Luminance(rgb) / kHLGPeakLuminance;
+					double sceneGain		= (displayLuminance > 0.0) ? pow(displayLuminance, (1.0 - kHLGSystemGamma) / kHLGSystemGamma) / kHLGPeakLuminance : 0.0;
+
+					for (int c = 0; c < 3; c++)
+						entry[c] = SampleFromValue(HLGOETF(rgb[c] * sceneGain));
+				}
+				else
+				{
+					// Relative to SDR peak white in Rec.709 primaries, clipped to the Rec.709 gamut
+					for (int c = 0; c < 3; c++)
+					{
+						double light = (kRec2020ToRec709[c][0] * rgb[0] + kRec2020ToRec709[c][1] * rgb[1] + kRec2020ToRec709[c][2] * rgb[2]) / kSDRReferenceWhite;
+
+						entry[c] = SampleFromValue(pow(std::min(std::max(light, 0.0), 1.0), 1.0 / kSDRGamma));
+					}
+				}
+
+				entry[3] = 0;
+				entry += 4;
+			}
+		}
+	}
+
+	m_lutMetadata	= metadata;
+	m_lutsValid		= true;
+	m_lutBuildCount++;
+}
+
+void ToneMapper::ToneMapRows(ThreadRows& rows, const uint8_t* srcFrame, long srcRowBytes, uint8_t* dstFrame, long dstRowBytes,
+							 uint32_t firstRow, uint32_t rowCount)
+{
+	for (uint32_t row = firstRow; row < firstRow + rowCount; row++)
+	{
+		UnpackV210Row(srcFrame + (size_t)row * srcRowBytes, rows.luma.data(), rows.cb.data(), rows.cr.data(), m_width);
+		ConvertYUV422RowToRGB(rows.luma.data(), rows.cb.data(), rows.cr.data(), rows.red.data(), rows.green.data(), rows.blue.data(),
+							  m_width, m_inputCoefficients);
+
+		if (m_shaperEnabled)
+		{
+			ApplyLUT1DRow(rows.red.data(), rows.red.data(), m_width, m_shaperLUT.data());
+			ApplyLUT1DRow(rows.green.data(), rows.green.data(), m_width, m_shaperLUT.data());
+			ApplyLUT1DRow(rows.blue.data(), rows.blue.data(), m_width, m_shaperLUT.data());
+		}
+
+		ApplyLUT3DRow(rows.red.data(), rows.green.data(), rows.blue.data(), rows.red.data(), rows.green.data(), rows.blue.data(), m_width, m_lut3D);
+
+		ConvertRGBRowToYUV422(rows.red.data(), rows.green.data(), rows.blue.data(), rows.luma.data(), rows.cb.data(), rows.cr.data(),
+							  m_width, m_outputCoefficients);
+		PackV210Row(rows.luma.data(), rows.cb.data(), rows.cr.data(), dstFrame + (size_t)row * dstRowBytes, m_width);
+	}
+}
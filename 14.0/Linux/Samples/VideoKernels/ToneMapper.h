@@ -0,0 +1,150 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoKernels.h"
+
+// ToneMapper converts v210 frames between transfer functions: PQ to HLG, PQ to SDR and HLG to SDR.
+//
+// Each row is converted from Rec.2020 narrow range YCbCr to full range R'G'B', mapped through a 1D shaper
+// table and a 3D table with the lookup table kernels, then converted back to YCbCr, Rec.2020 for HLG output
+// and Rec.709 for SDR output.  The tables are computed from the static HDR metadata of the input:
+//
+//  - PQ input is decoded to display light with the ST 2084 EOTF.  The shaper stretches PQ codes up to the
+//    peak luminance of the content over the 3D table, so its grid is not spent on codes that do not occur.
+//  - HLG input is decoded to display light with the BT.2100 inverse OETF and OOTF for a 1000 cd/m2 display.
+//  - Content brighter than the output peak, 1000 cd/m2 for HLG and 203 cd/m2 (HDR reference white) for SDR,
+//    is compressed with the BT.2390 EETF, applied to the maximum of R, G and B to preserve hue.
+//  - HLG output is encoded with the inverse OOTF and OETF.  SDR output is converted to Rec.709 primaries,
+//    clipped and encoded with the inverse of the BT.1886 EOTF.
+//
+// The peak luminance of PQ content is MaxCLL, or the maximum mastering display luminance when MaxCLL is
+// not known, otherwise 1000 cd/m2.  Tables are rebuilt only when the metadata of a frame differs from the
+// metadata of the previous frame.
+//
+// Each frame is split into slices of rows which are converted in parallel by a SliceWorkerPool.
+
+// Electro-optical transfer functions, with the values of the CEA 861.3 EOTF field
+enum TransferFunction
+{
+	kTransferSDR = 0,
+	kTransferPQ = 2,
+	kTransferHLG = 3
+};
+
+// Static HDR metadata of the input, luminances in cd/m2 and 0 if not known
+struct ToneMapMetadata
+{
+	TransferFunction	transferFunction;
+	double				maxDisplayMasteringLuminance;
+	double				minDisplayMasteringLuminance;
+	double				maxContentLightLevel;
+	double				maxFrameAverageLightLevel;
+
+	bool operator==(const ToneMapMetadata& other) const
+	{
+		return (transferFunction == other.transferFunction) &&
+			(maxDisplayMasteringLuminance == other.maxDisplayMasteringLuminance) &&
+			(minDisplayMasteringLuminance == other.minDisplayMasteringLuminance) &&
+			(maxContentLightLevel == other.maxContentLightLevel) &&
+			(maxFrameAverageLightLevel == other.maxFrameAverageLightLevel);
+	}
+	bool operator!=(const ToneMapMetadata& other) const { return !(*this == other); }
+};
+
+class ToneMapper
+{
+public:
+	// threadCount includes the calling thread, 0 selects the number of CPUs
+	ToneMapper(uint32_t width, uint32_t height, TransferFunction outputTransferFunction, unsigned threadCount = 0);
+
+	uint32_t			GetWidth(void) const { return m_width; }
+	uint32_t			GetHeight(void) const { return m_height; }
+	TransferFunction	GetOutputTransferFunction(void) const { return m_outputTransferFunction; }
+	unsigned			GetThreadCount(void) const { return m_workerPool.GetThreadCount(); }
+
+	// Number of times the tables have been built, for monitoring metadata changes
+	uint32_t			GetLUTBuildCount(void) const { return m_lutBuildCount; }
+
+	static bool			IsConversionSupported(TransferFunction inputTransferFunction, TransferFunction outputTransferFunction);
+
+	// Tone map a v210 frame with the metadata of the input.  dstFrame may be srcFrame.  Returns E_INVALIDARG
+	// if the conversion is not supported.  Calls from multiple threads are serialized.
+	HRESULT				ToneMapV210(const ToneMapMetadata& metadata, const void* srcFrame, long srcRowBytes, void* dstFrame, long dstRowBytes);
+
+private:
+	// Working rows of one thread
+	struct ThreadRows
+	{
+		std::vector<uint16_t>	luma;
+		std::vector<uint16_t>	cb;
+		std::vector<uint16_t>	cr;
+		std::vector<uint16_t>	red;
+		std::vector<uint16_t>	green;
+		std::vector<uint16_t>	blue;
+	};
+
+	uint32_t					m_width;
+	uint32_t					m_height;
+	TransferFunction			m_outputTransferFunction;
+	ColorimetryCoefficients		m_inputCoefficients;
+	ColorimetryCoefficients		m_outputCoefficients;
+
+	std::mutex					m_mutex;
+	bool						m_lutsValid;
+	ToneMapMetadata				m_lutMetadata;			// Metadata the tables were built for
+	uint32_t					m_lutBuildCount;
+	bool						m_shaperEnabled;		// False when the shaper is the identity
+	std::vector<uint16_t>		m_shaperLUT;
+	std::vector<uint16_t>		m_lut3DEntries;
+	LUT3D						m_lut3D;
+
+	SliceWorkerPool				m_workerPool;
+	std::vector<ThreadRows>		m_threadRows;			// Indexed by pool thread
+
+	void						BuildLUTs(const ToneMapMetadata& metadata);
+	void						ToneMapRows(ThreadRows& rows, const uint8_t* srcFrame, long srcRowBytes, uint8_t* dstFrame, long dstRowBytes,
+											uint32_t firstRow, uint32_t rowCount);
+};
@@ -0,0 +1,940 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <string.h>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <smmintrin.h>
+#endif
+#include "VideoConversion.h"
+#include "VideoKernels.h"
+
+typedef VideoConversion::RowPlanes		RowPlanes;
+
+enum ColorModel
+{
+	kColorModelYUV,
+	kColorModelRGB
+};
+
+struct VideoConversion::PixelFormatCodec
+{
+	BMDPixelFormat	pixelFormat;
+	ColorModel		colorModel;
+	bool			hasAlpha;
+	void			(*decodeRow)(const uint8_t* row, RowPlanes& planes, uint32_t width);
+	void			(*encodeRow)(const RowPlanes& planes, uint8_t* row, uint32_t width);
+};
+
+typedef VideoConversion::PixelFormatCodec	PixelFormatCodec;
+
+// RGB planes hold 16-bit video levels, 10-bit video levels shifted left by 6
+static const int32_t	kBlack16			= 4096;
+static const int32_t	kWhite16			= 60160;
+static const int32_t	kRange16			= kWhite16 - kBlack16;
+static const uint16_t	kOpaque16			= 0xFFFF;
+
+static inline uint32_t Load32(const uint8_t* bytes)
+{
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static inline void Store32(uint8_t* bytes, uint32_t value)
+{
+	memcpy(bytes, &value, sizeof(value));
+}
+
+static inline uint32_t LoadBE32(const uint8_t* bytes)		{ return __builtin_bswap32(Load32(bytes)); }
+static inline void StoreBE32(uint8_t* bytes, uint32_t value)	{ Store32(bytes, __builtin_bswap32(value)); }
+
+// Scale between 8-bit or 12-bit full range samples and 16-bit video levels, (value * scale + round) >> shift.
+// The scales are within one of the exact result for every sample and full range samples round trip exactly,
+// the products fit in 32 bits for SIMD implementations.
+struct FullRangeScale
+{
+	uint32_t	expandScale;
+	uint32_t	expandRound;
+	int			expandShift;
+	uint32_t	compressScale;
+	uint32_t	compressRound;
+	int			compressShift;
+};
+
+static const FullRangeScale	kFullRange8Bit	= { 14071, 1 << 5, 6, 149, 1 << 14, 15 };
+static const FullRangeScale	kFullRange12Bit	= { 28039, 1 << 10, 11, 4787, 1 << 15, 16 };
+
+static inline uint16_t ExpandFullRange(uint32_t value, const FullRangeScale& scale)
+{
+	return (uint16_t)(kBlack16 + ((value * scale.expandScale + scale.expandRound) >> scale.expandShift));
+}
+
+static inline uint32_t CompressFullRange(uint16_t value, const FullRangeScale& scale)
+{
+	uint32_t level = (uint32_t)std::min(std::max((int32_t)value - kBlack16, 0), kRange16);
+	return (level * scale.compressScale + scale.compressRound) >> scale.compressShift;
+}
+
+static inline uint16_t Expand10Bit(uint32_t value)		{ return (uint16_t)(value << 6); }
+static inline uint32_t Compress10Bit(uint16_t value)	{ return std::min((value + 32u) >> 6, 1023u); }
+
+static inline uint16_t ExpandAlpha8(uint32_t value)		{ return (uint16_t)(value * 257); }
+static inline uint32_t CompressAlpha8(uint16_t value)	{ return (value * 255u + 0x8000) >> 16; }
+static inline uint16_t ExpandAlpha10(uint32_t value)	{ return (uint16_t)((value << 6) | (value >> 4)); }
+static inline uint32_t CompressAlpha10(uint16_t value)	{ return (value * 1023u + 0x8000) >> 16; }
+
+// SIMD paths follow the implementation selected for the VideoKernels library
+static inline bool UseSSE41(void)
+{
+	VideoKernelsISA isa = GetVideoKernelsISA();
+
+	return (isa == kVideoKernelsISASSE41) || (isa == kVideoKernelsISAAVX2) || (isa == kVideoKernelsISAAVX512);
+}
+
+/* YUV formats */
+
+static void Decode2vuy(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	Unpack2vuyRow(row, planes.luma.data(), planes.cb.data(), planes.cr.data(), width);
+}
+
+static void Encode2vuy(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	Pack2vuyRow(planes.luma.data(), planes.cb.data(), planes.cr.data(), row, width);
+}
+
+static void DecodeV210(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	UnpackV210Row(row, planes.luma.data(), planes.cb.data(), planes.cr.data(), width);
+}
+
+static void EncodeV210(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	PackV210Row(planes.luma.data(), planes.cb.data(), planes.cr.data(), row, width);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Decode 8 pixels per iteration, returns the number of pixels decoded
+__attribute__((target("sse4.1")))
+static uint32_t DecodeAy10SSE41(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	const __m128i	byteSwap		= _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m128i	deinterleave	= _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+	const __m128i	mask10			= _mm_set1_epi32(0x3FF);
+	uint16_t*		luma			= planes.luma.data();
+	uint16_t*		cb				= planes.cb.data();
+	uint16_t*		cr				= planes.cr.data();
+	uint16_t*		alpha			= planes.alpha.data();
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		__m128i w0		= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row + x * 4)), byteSwap);
+		__m128i w1		= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row + x * 4 + 16)), byteSwap);
+		__m128i y		= _mm_packus_epi32(_mm_and_si128(w0, mask10), _mm_and_si128(w1, mask10));
+		__m128i c		= _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w0, 10), mask10), _mm_and_si128(_mm_srli_epi32(w1, 10), mask10));
+		__m128i a		= _mm_packus_epi32(_mm_srli_epi32(w0, 20), _mm_srli_epi32(w1, 20));
+
+		// Cb is the chroma of even pixels and Cr of odd pixels
+		c = _mm_shuffle_epi8(c, deinterleave);
+		a = _mm_and_si128(a, _mm_set1_epi16(0x3FF));
+
+		_mm_storeu_si128((__m128i*)(luma + x), y);
+		_mm_storel_epi64((__m128i*)(cb + x / 2), c);
+		_mm_storel_epi64((__m128i*)(cr + x / 2), _mm_srli_si128(c, 8));
+		_mm_storeu_si128((__m128i*)(alpha + x), _mm_or_si128(_mm_slli_epi16(a, 6), _mm_srli_epi16(a, 4)));
+	}
+
+	return x;
+}
+
+// Encode 8 pixels per iteration, returns the number of pixels encoded
+__attribute__((target("sse4.1")))
+static uint32_t EncodeAy10SSE41(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	const __m128i	byteSwap	= _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m128i	mask10		= _mm_set1_epi16(0x3FF);
+	const __m128i	multiplier	= _mm_set1_epi32(1023);
+	const __m128i	round		= _mm_set1_epi32(0x8000);
+	const uint16_t*	luma		= planes.luma.data();
+	const uint16_t*	cb			= planes.cb.data();
+	const uint16_t*	cr			= planes.cr.data();
+	const uint16_t*	alpha		= planes.alpha.data();
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		__m128i y	= _mm_and_si128(_mm_loadu_si128((const __m128i*)(luma + x)), mask10);
+		__m128i c	= _mm_and_si128(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(cb + x / 2)), _mm_loadl_epi64((const __m128i*)(cr + x / 2))), mask10);
+		__m128i a	= _mm_loadu_si128((const __m128i*)(alpha + x));
+		__m128i a0	= _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_cvtepu16_epi32(a), multiplier), round), 16);
+		__m128i a1	= _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(a, _mm_setzero_si128()), multiplier), round), 16);
+		__m128i w0	= _mm_or_si128(_mm_or_si128(_mm_slli_epi32(a0, 20), _mm_slli_epi32(_mm_cvtepu16_epi32(c), 10)), _mm_cvtepu16_epi32(y));
+		__m128i w1	= _mm_or_si128(_mm_or_si128(_mm_slli_epi32(a1, 20), _mm_slli_epi32(_mm_unpackhi_epi16(c, _mm_setzero_si128()), 10)),
+								   _mm_unpackhi_epi16(y, _mm_setzero_si128()));
+
+		_mm_storeu_si128((__m128i*)(row + x * 4), _mm_shuffle_epi8(w0, byteSwap));
+		_mm_storeu_si128((__m128i*)(row + x * 4 + 16), _mm_shuffle_epi8(w1, byteSwap));
+	}
+
+	return x;
+}
+#endif
+
+// Ay10 is a big-endian word per pixel, A << 20 | C << 10 | Y, where C is Cb for even pixels and Cr for odd pixels
+static void DecodeAy10(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	uint16_t*	luma	= planes.luma.data();
+	uint16_t*	cb		= planes.cb.data();
+	uint16_t*	cr		= planes.cr.data();
+	uint16_t*	alpha	= planes.alpha.data();
+	uint32_t	x		= 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = DecodeAy10SSE41(row, planes, width);
+#endif
+
+	for (; x < width; x += 2)
+	{
+		uint32_t word = LoadBE32(row + x * 4);
+
+		luma[x]		= word & 0x3FF;
+		cb[x / 2]	= (word >> 10) & 0x3FF;
+		alpha[x]	= ExpandAlpha10((word >> 20) & 0x3FF);
+
+		if (x + 1 < width)
+		{
+			word = LoadBE32(row + x * 4 + 4);
+
+			luma[x + 1]		= word & 0x3FF;
+			cr[x / 2]		= (word >> 10) & 0x3FF;
+			alpha[x + 1]	= ExpandAlpha10((word >> 20) & 0x3FF);
+		}
+		else
+		{
+			cr[x / 2]		= 512;
+		}
+	}
+}
+
+static void EncodeAy10(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	const uint16_t*	luma	= planes.luma.data();
+	const uint16_t*	cb		= planes.cb.data();
+	const uint16_t*	cr		= planes.cr.data();
+	const uint16_t*	alpha	= planes.alpha.data();
+	uint32_t		x		= 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = EncodeAy10SSE41(planes, row, width);
+#endif
+
+	for (; x < width; x++)
+	{
+		uint32_t chroma = (x & 1) ? cr[x / 2] : cb[x / 2];
+
+		StoreBE32(row + x * 4, (CompressAlpha10(alpha[x]) << 20) | ((chroma & 0x3FF) << 10) | (luma[x] & 0x3FF));
+	}
+}
+
+/* RGB formats */
+
+#if defined(__x86_64__) || defined(__i386__)
+// Scale 8 full range samples to 16-bit video levels and back
+__attribute__((target("sse4.1")))
+static inline __m128i ExpandFullRangeSSE41(__m128i samples, const FullRangeScale& scale)
+{
+	const __m128i	multiplier	= _mm_set1_epi32(scale.expandScale);
+	const __m128i	round		= _mm_set1_epi32(scale.expandRound);
+	__m128i			lo			= _mm_add_epi32(_mm_mullo_epi32(_mm_cvtepu16_epi32(samples), multiplier), round);
+	__m128i			hi			= _mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(samples, _mm_setzero_si128()), multiplier), round);
+
+	lo = _mm_srl_epi32(lo, _mm_cvtsi32_si128(scale.expandShift));
+	hi = _mm_srl_epi32(hi, _mm_cvtsi32_si128(scale.expandShift));
+	return _mm_add_epi16(_mm_packus_epi32(lo, hi), _mm_set1_epi16(kBlack16));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i CompressFullRangeSSE41(__m128i levels, const FullRangeScale& scale)
+{
+	const __m128i	multiplier	= _mm_set1_epi32(scale.compressScale);
+	const __m128i	round		= _mm_set1_epi32(scale.compressRound);
+	__m128i			level		= _mm_min_epu16(_mm_subs_epu16(levels, _mm_set1_epi16(kBlack16)), _mm_set1_epi16((short)kRange16));
+	__m128i			lo			= _mm_add_epi32(_mm_mullo_epi32(_mm_cvtepu16_epi32(level), multiplier), round);
+	__m128i			hi			= _mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(level, _mm_setzero_si128()), multiplier), round);
+
+	lo = _mm_srl_epi32(lo, _mm_cvtsi32_si128(scale.compressShift));
+	hi = _mm_srl_epi32(hi, _mm_cvtsi32_si128(scale.compressShift));
+	return _mm_packus_epi32(lo, hi);
+}
+
+// 8-bit alpha to 16 bits is a multiply by 257, and back is rounded (alpha * 255 + 0x8000) >> 16
+__attribute__((target("sse4.1")))
+static inline __m128i CompressAlpha8SSE41(__m128i alpha)
+{
+	const __m128i	multiplier	= _mm_set1_epi32(255);
+	const __m128i	round		= _mm_set1_epi32(0x8000);
+	__m128i			lo			= _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_cvtepu16_epi32(alpha), multiplier), round), 16);
+	__m128i			hi			= _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(alpha, _mm_setzero_si128()), multiplier), round), 16);
+
+	return _mm_packus_epi32(lo, hi);
+}
+
+// Decode 8 pixels of 4 bytes per iteration, returns the number of pixels decoded
+template <int AlphaByte, int RedByte, int GreenByte, int BlueByte>
+__attribute__((target("sse4.1")))
+static uint32_t Decode8BitRGBSSE41(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	// Gather each byte of the 4 pixels in a vector into a 32-bit lane
+	const __m128i	deinterleave	= _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+	uint16_t*		red				= planes.red.data();
+	uint16_t*		green			= planes.green.data();
+	uint16_t*		blue			= planes.blue.data();
+	uint16_t*		alpha			= planes.alpha.data();
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		__m128i p0		= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row + x * 4)), deinterleave);
+		__m128i p1		= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(row + x * 4 + 16)), deinterleave);
+		__m128i bytes01	= _mm_unpacklo_epi32(p0, p1);
+		__m128i bytes23	= _mm_unpackhi_epi32(p0, p1);
+		__m128i bytes[4];
+
+		bytes[0] = _mm_cvtepu8_epi16(bytes01);
+		bytes[1] = _mm_cvtepu8_epi16(_mm_srli_si128(bytes01, 8));
+		bytes[2] = _mm_cvtepu8_epi16(bytes23);
+		bytes[3] = _mm_cvtepu8_epi16(_mm_srli_si128(bytes23, 8));
+
+		_mm_storeu_si128((__m128i*)(red + x), ExpandFullRangeSSE41(bytes[RedByte], kFullRange8Bit));
+		_mm_storeu_si128((__m128i*)(green + x), ExpandFullRangeSSE41(bytes[GreenByte], kFullRange8Bit));
+		_mm_storeu_si128((__m128i*)(blue + x), ExpandFullRangeSSE41(bytes[BlueByte], kFullRange8Bit));
+		_mm_storeu_si128((__m128i*)(alpha + x), _mm_mullo_epi16(bytes[AlphaByte], _mm_set1_epi16(257)));
+	}
+
+	return x;
+}
+
+// Encode 8 pixels of 4 bytes per iteration, returns the number of pixels encoded
+template <int AlphaByte, int RedByte, int GreenByte, int BlueByte>
+__attribute__((target("sse4.1")))
+static uint32_t Encode8BitRGBSSE41(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	const uint16_t*	red		= planes.red.data();
+	const uint16_t*	green	= planes.green.data();
+	const uint16_t*	blue	= planes.blue.data();
+	const uint16_t*	alpha	= planes.alpha.data();
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		__m128i bytes[4];
+
+		bytes[RedByte]		= CompressFullRangeSSE41(_mm_loadu_si128((const __m128i*)(red + x)), kFullRange8Bit);
+		bytes[GreenByte]	= CompressFullRangeSSE41(_mm_loadu_si128((const __m128i*)(green + x)), kFullRange8Bit);
+		bytes[BlueByte]		= CompressFullRangeSSE41(_mm_loadu_si128((const __m128i*)(blue + x)), kFullRange8Bit);
+		bytes[AlphaByte]	= CompressAlpha8SSE41(_mm_loadu_si128((const __m128i*)(alpha + x)));
+
+		// Interleave bytes 0 and 1, and bytes 2 and 3 of each pixel, then the pairs
+		__m128i bytes01	= _mm_packus_epi16(bytes[0], bytes[1]);
+		__m128i bytes23	= _mm_packus_epi16(bytes[2], bytes[3]);
+		__m128i pairs01	= _mm_unpacklo_epi8(bytes01, _mm_srli_si128(bytes01, 8));
+		__m128i pairs23	= _mm_unpacklo_epi8(bytes23, _mm_srli_si128(bytes23, 8));
+
+		_mm_storeu_si128((__m128i*)(row + x * 4), _mm_unpacklo_epi16(pairs01, pairs23));
+		_mm_storeu_si128((__m128i*)(row + x * 4 + 16), _mm_unpackhi_epi16(pairs01, pairs23));
+	}
+
+	return x;
+}
+
+// Decode 8 pixels of 32-bit words per iteration, returns the number of pixels decoded
+template <bool BigEndian, int RedShift, int GreenShift, int BlueShift>
+__attribute__((target("sse4.1")))
+static uint32_t Decode10BitRGBSSE41(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	const __m128i	byteSwap	= _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m128i	mask10		= _mm_set1_epi32(0x3FF);
+	uint16_t*		red			= planes.red.data();
+	uint16_t*		green		= planes.green.data();
+	uint16_t*		blue		= planes.blue.data();
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		__m128i w0 = _mm_loadu_si128((const __m128i*)(row + x * 4));
+		__m128i w1 = _mm_loadu_si128((const __m128i*)(row + x * 4 + 16));
+
+		if (BigEndian)
+		{
+			w0 = _mm_shuffle_epi8(w0, byteSwap);
+			w1 = _mm_shuffle_epi8(w1, byteSwap);
+		}
+
+		__m128i r = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w0, RedShift), mask10), _mm_and_si128(_mm_srli_epi32(w1, RedShift), mask10));
+		__m128i g = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w0, GreenShift), mask10), _mm_and_si128(_mm_srli_epi32(w1, GreenShift), mask10));
+		__m128i b = _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w0, BlueShift), mask10), _mm_and_si128(_mm_srli_epi32(w1, BlueShift), mask10));
+
+		_mm_storeu_si128((__m128i*)(red + x), _mm_slli_epi16(r, 6));
+		_mm_storeu_si128((__m128i*)(green + x), _mm_slli_epi16(g, 6));
+		_mm_storeu_si128((__m128i*)(blue + x), _mm_slli_epi16(b, 6));
+	}
+
+	return x;
+}
+
+// Encode 8 pixels of 32-bit words per iteration, returns the number of pixels encoded
+template <bool BigEndian, int RedShift, int GreenShift, int BlueShift>
+__attribute__((target("sse4.1")))
+static uint32_t Encode10BitRGBSSE41(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	const __m128i	byteSwap	= _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m128i	round		= _mm_set1_epi16(32);
+	const uint16_t*	red			= planes.red.data();
+	const uint16_t*	green		= planes.green.data();
+	const uint16_t*	blue		= planes.blue.data();
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		// Saturating the rounding add limits samples to 1023
+		__m128i r	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(red + x)), round), 6);
+		__m128i g	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(green + x)), round), 6);
+		__m128i b	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(blue + x)), round), 6);
+		__m128i w0	= _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_cvtepu16_epi32(r), RedShift), _mm_slli_epi32(_mm_cvtepu16_epi32(g), GreenShift)),
+								   _mm_slli_epi32(_mm_cvtepu16_epi32(b), BlueShift));
+		__m128i w1	= _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_unpackhi_epi16(r, _mm_setzero_si128()), RedShift),
+											   _mm_slli_epi32(_mm_unpackhi_epi16(g, _mm_setzero_si128()), GreenShift)),
+								   _mm_slli_epi32(_mm_unpackhi_epi16(b, _mm_setzero_si128()), BlueShift));
+
+		if (BigEndian)
+		{
+			w0 = _mm_shuffle_epi8(w0, byteSwap);
+			w1 = _mm_shuffle_epi8(w1, byteSwap);
+		}
+
+		_mm_storeu_si128((__m128i*)(row + x * 4), w0);
+		_mm_storeu_si128((__m128i*)(row + x * 4 + 16), w1);
+	}
+
+	return x;
+}
+#endif
+
+// ARGB and BGRA are 4 bytes per pixel, template parameters are the byte offset of each component
+template <int AlphaByte, int RedByte, int GreenByte, int BlueByte>
+static void Decode8BitRGB(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	uint16_t*	red		= planes.red.data();
+	uint16_t*	green	= planes.green.data();
+	uint16_t*	blue	= planes.blue.data();
+	uint16_t*	alpha	= planes.alpha.data();
+	uint32_t	x		= 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = Decode8BitRGBSSE41<AlphaByte, RedByte, GreenByte, BlueByte>(row, planes, width);
+#endif
+
+	for (; x < width; x++)
+	{
+		const uint8_t* pixel = row + x * 4;
+
+		red[x]		= ExpandFullRange(pixel[RedByte], kFullRange8Bit);
+		green[x]	= ExpandFullRange(pixel[GreenByte], kFullRange8Bit);
+		blue[x]		= ExpandFullRange(pixel[BlueByte], kFullRange8Bit);
+		alpha[x]	= ExpandAlpha8(pixel[AlphaByte]);
+	}
+}
+
+template <int AlphaByte, int RedByte, int GreenByte, int BlueByte>
+static void Encode8BitRGB(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	const uint16_t*	red		= planes.red.data();
+	const uint16_t*	green	= planes.green.data();
+	const uint16_t*	blue	= planes.blue.data();
+	const uint16_t*	alpha	= planes.alpha.data();
+	uint32_t		x		= 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = Encode8BitRGBSSE41<AlphaByte, RedByte, GreenByte, BlueByte>(planes, row, width);
+#endif
+
+	for (; x < width; x++)
+	{
+		uint8_t* pixel = row + x * 4;
+
+		pixel[RedByte]		= (uint8_t)CompressFullRange(red[x], kFullRange8Bit);
+		pixel[GreenByte]	= (uint8_t)CompressFullRange(green[x], kFullRange8Bit);
+		pixel[BlueByte]		= (uint8_t)CompressFullRange(blue[x], kFullRange8Bit);
+		pixel[AlphaByte]	= (uint8_t)CompressAlpha8(alpha[x]);
+	}
+}
+
+// r210 is a big-endian word per pixel, R << 20 | G << 10 | B.  R10l is a little-endian word per pixel,
+// R << 22 | G << 12 | B << 2, and R10b is the same word big-endian.
+template <bool BigEndian, int RedShift, int GreenShift, int BlueShift>
+static void Decode10BitRGB(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	uint16_t*	red		= planes.red.data();
+	uint16_t*	green	= planes.green.data();
+	uint16_t*	blue	= planes.blue.data();
+	uint32_t	x		= 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = Decode10BitRGBSSE41<BigEndian, RedShift, GreenShift, BlueShift>(row, planes, width);
+#endif
+
+	for (; x < width; x++)
+	{
+		uint32_t word = BigEndian ? LoadBE32(row + x * 4) : Load32(row + x * 4);
+
+		red[x]		= Expand10Bit((word >> RedShift) & 0x3FF);
+		green[x]	= Expand10Bit((word >> GreenShift) & 0x3FF);
+		blue[x]		= Expand10Bit((word >> BlueShift) & 0x3FF);
+	}
+}
+
+template <bool BigEndian, int RedShift, int GreenShift, int BlueShift>
+static void Encode10BitRGB(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	const uint16_t*	red		= planes.red.data();
+	const uint16_t*	green	= planes.green.data();
+	const uint16_t*	blue	= planes.blue.data();
+	uint32_t		x		= 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = Encode10BitRGBSSE41<BigEndian, RedShift, GreenShift, BlueShift>(planes, row, width);
+#endif
+
+	for (; x < width; x++)
+	{
+		uint32_t word = (Compress10Bit(red[x]) << RedShift) | (Compress10Bit(green[x]) << GreenShift) | (Compress10Bit(blue[x]) << BlueShift);
+
+		if (BigEndian)
+			StoreBE32(row + x * 4, word);
+		else
+			Store32(row + x * 4, word);
+	}
+}
+
+// R12B and R12L rows are unpacked and packed by the VideoKernels library as full range 12-bit samples,
+// which are scaled to and from 16-bit video levels.  Packing scales chunks of each plane on the stack.
+static const uint32_t kR12ChunkPixels = 256;
+
+#if defined(__x86_64__) || defined(__i386__)
+// Scale 8 samples per iteration, returns the number of samples scaled
+__attribute__((target("sse4.1")))
+static uint32_t ExpandFullRange12BitSSE41(uint16_t* samples, uint32_t count)
+{
+	uint32_t x;
+
+	for (x = 0; x + 8 <= count; x += 8)
+		_mm_storeu_si128((__m128i*)(samples + x), ExpandFullRangeSSE41(_mm_loadu_si128((const __m128i*)(samples + x)), kFullRange12Bit));
+
+	return x;
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t CompressFullRange12BitSSE41(const uint16_t* levels, uint16_t* samples, uint32_t count)
+{
+	uint32_t x;
+
+	for (x = 0; x + 8 <= count; x += 8)
+		_mm_storeu_si128((__m128i*)(samples + x), CompressFullRangeSSE41(_mm_loadu_si128((const __m128i*)(levels + x)), kFullRange12Bit));
+
+	return x;
+}
+#endif
+
+static void ExpandFullRange12Bit(uint16_t* samples, uint32_t count)
+{
+	uint32_t x = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = ExpandFullRange12BitSSE41(samples, count);
+#endif
+
+	for (; x < count; x++)
+		samples[x] = ExpandFullRange(samples[x], kFullRange12Bit);
+}
+
+static void CompressFullRange12Bit(const uint16_t* levels, uint16_t* samples, uint32_t count)
+{
+	uint32_t x = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (UseSSE41())
+		x = CompressFullRange12BitSSE41(levels, samples, count);
+#endif
+
+	for (; x < count; x++)
+		samples[x] = (uint16_t)CompressFullRange(levels[x], kFullRange12Bit);
+}
+
+template <bool BigEndian>
+static void DecodeR12(const uint8_t* row, RowPlanes& planes, uint32_t width)
+{
+	UnpackR12Row(row, planes.red.data(), planes.green.data(), planes.blue.data(), width, BigEndian);
+
+	ExpandFullRange12Bit(planes.red.data(), width);
+	ExpandFullRange12Bit(planes.green.data(), width);
+	ExpandFullRange12Bit(planes.blue.data(), width);
+}
+
+template <bool BigEndian>
+static void EncodeR12(const RowPlanes& planes, uint8_t* row, uint32_t width)
+{
+	uint16_t red[kR12ChunkPixels];
+	uint16_t green[kR12ChunkPixels];
+	uint16_t blue[kR12ChunkPixels];
+
+	// Chunks are whole 8 pixel groups of 36 bytes, except the last
+	for (uint32_t x = 0; x < width; x += kR12ChunkPixels)
+	{
+		uint32_t chunkWidth = std::min(kR12ChunkPixels, width - x);
+
+		CompressFullRange12Bit(planes.red.data() + x, red, chunkWidth);
+		CompressFullRange12Bit(planes.green.data() + x, green, chunkWidth);
+		CompressFullRange12Bit(planes.blue.data() + x, blue, chunkWidth);
+
+		PackR12Row(red, green, blue, row + (x / 8) * 36, chunkWidth, BigEndian);
+	}
+}
+
+static const PixelFormatCodec kPixelFormatCodecs[] =
+{
+	{ bmdFormat8BitYUV,			kColorModelYUV,	false,	Decode2vuy,								Encode2vuy },
+	{ bmdFormat10BitYUV,		kColorModelYUV,	false,	DecodeV210,								EncodeV210 },
+	{ bmdFormat10BitYUVA,		kColorModelYUV,	true,	DecodeAy10,								EncodeAy10 },
+	{ bmdFormat8BitARGB,		kColorModelRGB,	true,	Decode8BitRGB<0, 1, 2, 3>,				Encode8BitRGB<0, 1, 2, 3> },
+	{ bmdFormat8BitBGRA,		kColorModelRGB,	true,	Decode8BitRGB<3, 2, 1, 0>,				Encode8BitRGB<3, 2, 1, 0> },
+	{ bmdFormat10BitRGB,		kColorModelRGB,	false,	Decode10BitRGB<true, 20, 10, 0>,		Encode10BitRGB<true, 20, 10, 0> },
+	{ bmdFormat12BitRGB,		kColorModelRGB,	false,	DecodeR12<true>,						EncodeR12<true> },
+	{ bmdFormat12BitRGBLE,		kColorModelRGB,	false,	DecodeR12<false>,						EncodeR12<false> },
+	{ bmdFormat10BitRGBXLE,		kColorModelRGB,	false,	Decode10BitRGB<false, 22, 12, 2>,		Encode10BitRGB<false, 22, 12, 2> },
+	{ bmdFormat10BitRGBX,		kColorModelRGB,	false,	Decode10BitRGB<true, 22, 12, 2>,		Encode10BitRGB<true, 22, 12, 2> },
+};
+
+static const PixelFormatCodec* FindPixelFormatCodec(BMDPixelFormat pixelFormat)
+{
+	for (const PixelFormatCodec& codec : kPixelFormatCodecs)
+	{
+		if (codec.pixelFormat == pixelFormat)
+			return &codec;
+	}
+
+	return NULL;
+}
+
+bool DecodePixelFormatRow(BMDPixelFormat pixelFormat, const void* row, RowPlanes& planes, uint32_t width)
+{
+	const PixelFormatCodec* codec = FindPixelFormatCodec(pixelFormat);
+
+	if (codec == NULL)
+		return false;
+
+	codec->decodeRow((const uint8_t*)row, planes, width);
+	return true;
+}
+
+bool EncodePixelFormatRow(BMDPixelFormat pixelFormat, const RowPlanes& planes, void* row, uint32_t width)
+{
+	const PixelFormatCodec* codec = FindPixelFormatCodec(pixelFormat);
+
+	if (codec == NULL)
+		return false;
+
+	codec->encodeRow(planes, (uint8_t*)row, width);
+	return true;
+}
+
+bool IsYUVPixelFormat(BMDPixelFormat pixelFormat)
+{
+	const PixelFormatCodec* codec = FindPixelFormatCodec(pixelFormat);
+
+	return (codec != NULL) && (codec->colorModel == kColorModelYUV);
+}
+
+long GetPixelFormatRowBytes(BMDPixelFormat pixelFormat, long width)
+{
+	// Refer to DeckLink SDK Manual - 2.7.4 Pixel Formats
+	switch (pixelFormat)
+	{
+		case bmdFormat8BitYUV:
+			return ((width + 1) / 2) * 4;
+
+		case bmdFormat10BitYUV:
+			return ((width + 47) / 48) * 128;
+
+		case bmdFormat10BitYUVA:
+		case bmdFormat10BitRGB:
+		case bmdFormat10BitRGBXLE:
+		case bmdFormat10BitRGBX:
+			return ((width + 63) / 64) * 256;
+
+		case bmdFormat8BitARGB:
+		case bmdFormat8BitBGRA:
+			return width * 4;
+
+		case bmdFormat12BitRGB:
+		case bmdFormat12BitRGBLE:
+			return ((width * 36 + 31) / 32) * 4;
+
+		default:
+			return 0;
+	}
+}
+
+/* Colorimetry */
+
+static BMDColorspace GetFrameColorspace(IDeckLinkVideoFrame* videoFrame)
+{
+	IDeckLinkVideoFrameMetadataExtensions*	metadataExtensions	= NULL;
+	int64_t									colorspace			= 0;
+
+	if (videoFrame->QueryInterface(IID_IDeckLinkVideoFrameMetadataExtensions, (void**)&metadataExtensions) == S_OK)
+	{
+		if (metadataExtensions->GetInt(bmdDeckLinkFrameMetadataColorspace, &colorspace) != S_OK)
+			colorspace = 0;
+
+		metadataExtensions->Release();
+	}
+
+	if ((colorspace == bmdColorspaceRec601) || (colorspace == bmdColorspaceRec709) || (colorspace == bmdColorspaceRec2020))
+		return (BMDColorspace)colorspace;
+
+	return (videoFrame->GetHeight() <= 576) ? bmdColorspaceRec601 : bmdColorspaceRec709;
+}
+
+static void GetFrameColorimetry(BMDColorspace colorspace, ColorimetryCoefficients& coefficients)
+{
+	Colorimetry colorimetry;
+
+	switch (colorspace)
+	{
+		case bmdColorspaceRec601:
+			colorimetry.matrix = kColorimetryRec601;
+			break;
+		case bmdColorspaceRec2020:
+			colorimetry.matrix = kColorimetryRec2020;
+			break;
+		case bmdColorspaceRec709:
+		default:
+			colorimetry.matrix = kColorimetryRec709;
+			break;
+	}
+
+	// RGB planes hold video levels, and DeckLink 4:2:2 chroma is co-sited
+	colorimetry.yuvRange		= kColorimetryNarrowRange;
+	colorimetry.rgbRange		= kColorimetryNarrowRange;
+	colorimetry.chromaSiting	= kChromaSitingCosited;
+
+	GetColorimetryCoefficients(colorimetry, coefficients);
+}
+
+/* VideoConversion class */
+
+IDeckLinkVideoConversion* CreateSoftwareVideoConversionInstance(unsigned threadCount)
+{
+	return new VideoConversion(threadCount);
+}
+
+VideoConversion::VideoConversion(unsigned threadCount) :
+	m_refCount(1),
+	m_workerPool(threadCount)
+{
+	m_rowPlanes.resize(m_workerPool.GetThreadCount());
+}
+
+VideoConversion::~VideoConversion()
+{
+}
+
+HRESULT VideoConversion::ConvertFrame(IDeckLinkVideoFrame* srcFrame, IDeckLinkVideoFrame* dstFrame)
+{
+	FrameJob	job;
+	void*		srcBytes;
+	void*		dstBytes;
+
+	if ((srcFrame == NULL) || (dstFrame == NULL))
+		return E_POINTER;
+
+	job.srcCodec	= FindPixelFormatCodec(srcFrame->GetPixelFormat());
+	job.dstCodec	= FindPixelFormatCodec(dstFrame->GetPixelFormat());
+	if ((job.srcCodec == NULL) || (job.dstCodec == NULL))
+		return E_NOTIMPL;
+
+	if ((srcFrame->GetWidth() != dstFrame->GetWidth()) || (srcFrame->GetHeight() != dstFrame->GetHeight()) || (srcFrame->GetWidth() <= 0))
+		return E_INVALIDARG;
+
+	job.width		= (uint32_t)srcFrame->GetWidth();
+	job.height		= (uint32_t)srcFrame->GetHeight();
+	job.srcRowBytes	= srcFrame->GetRowBytes();
+	job.dstRowBytes	= dstFrame->GetRowBytes();
+	if ((job.srcRowBytes < GetPixelFormatRowBytes(job.srcCodec->pixelFormat, job.width)) ||
+		(job.dstRowBytes < GetPixelFormatRowBytes(job.dstCodec->pixelFormat, job.width)))
+		return E_INVALIDARG;
+
+	if ((srcFrame->GetBytes(&srcBytes) != S_OK) || (dstFrame->GetBytes(&dstBytes) != S_OK))
+		return E_FAIL;
+
+	job.srcBytes	= (const uint8_t*)srcBytes;
+	job.dstBytes	= (uint8_t*)dstBytes;
+
+	if (job.srcCodec->colorModel != job.dstCodec->colorModel)
+		GetFrameColorimetry(GetFrameColorspace(srcFrame), job.colorimetry);
+
+	// Calls from multiple threads are serialized by the worker pool.  Several slices per thread balance the load when threads are preempted
+	uint32_t sliceCount	= std::min<uint32_t>(job.height, (uint32_t)m_rowPlanes.size() * 4);
+	job.rowsPerSlice	= (job.height + sliceCount - 1) / sliceCount;
+	sliceCount			= (job.height + job.rowsPerSlice - 1) / job.rowsPerSlice;
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		uint32_t firstRow = slice * job.rowsPerSlice;
+		ConvertRows(job, firstRow, std::min(job.rowsPerSlice, job.height - firstRow), m_rowPlanes[threadIndex]);
+	});
+
+	return S_OK;
+}
+
+void VideoConversion::ConvertRows(const FrameJob& job, uint32_t firstRow, uint32_t rowCount, RowPlanes& planes)
+{
+	const PixelFormatCodec*	srcCodec	= job.srcCodec;
+	const PixelFormatCodec*	dstCodec	= job.dstCodec;
+	const uint8_t*			srcRow		= job.srcBytes + (size_t)firstRow * job.srcRowBytes;
+	uint8_t*				dstRow		= job.dstBytes + (size_t)firstRow * job.dstRowBytes;
+
+	if (planes.luma.size() < job.width)
+	{
+		uint32_t chromaCount = (job.width + 1) / 2;
+
+		planes.luma.resize(job.width);
+		planes.cb.resize(chromaCount);
+		planes.cr.resize(chromaCount);
+		planes.red.resize(job.width);
+		planes.green.resize(job.width);
+		planes.blue.resize(job.width);
+		planes.alpha.resize(job.width);
+	}
+
+	// Formats without alpha are opaque
+	if (dstCodec->hasAlpha && !srcCodec->hasAlpha)
+		std::fill(planes.alpha.begin(), planes.alpha.begin() + job.width, kOpaque16);
+
+	for (uint32_t y = 0; y < rowCount; y++, srcRow += job.srcRowBytes, dstRow += job.dstRowBytes)
+	{
+		if (srcCodec == dstCodec)
+		{
+			memcpy(dstRow, srcRow, GetPixelFormatRowBytes(srcCodec->pixelFormat, job.width));
+		}
+		else if ((srcCodec->pixelFormat == bmdFormat10BitYUV) && (dstCodec->pixelFormat == bmdFormat8BitYUV))
+		{
+			ConvertV210RowTo2vuy(srcRow, dstRow, job.width);
+		}
+		else if ((srcCodec->pixelFormat == bmdFormat8BitYUV) && (dstCodec->pixelFormat == bmdFormat10BitYUV))
+		{
+			Convert2vuyRowToV210(srcRow, dstRow, job.width);
+		}
+		else
+		{
+			srcCodec->decodeRow(srcRow, planes, job.width);
+
+			if ((srcCodec->colorModel == kColorModelYUV) && (dstCodec->colorModel == kColorModelRGB))
+				ConvertYUV422RowToRGB(planes.luma.data(), planes.cb.data(), planes.cr.data(),
+									  planes.red.data(), planes.green.data(), planes.blue.data(), job.width, job.colorimetry);
+			else if ((srcCodec->colorModel == kColorModelRGB) && (dstCodec->colorModel == kColorModelYUV))
+				ConvertRGBRowToYUV422(planes.red.data(), planes.green.data(), planes.blue.data(),
+									  planes.luma.data(), planes.cb.data(), planes.cr.data(), job.width, job.colorimetry);
+
+			dstCodec->encodeRow(planes, dstRow, job.width);
+		}
+	}
+}
+
+HRESULT VideoConversion::QueryInterface(REFIID iid, LPVOID *ppv)
+{
+	CFUUIDBytes		iunknown;
+	HRESULT			result = E_NOINTERFACE;
+
+	if (ppv == NULL)
+		return E_INVALIDARG;
+
+	*ppv = NULL;
+
+	iunknown = CFUUIDGetUUIDBytes(IUnknownUUID);
+	if (memcmp(&iid, &iunknown, sizeof(REFIID)) == 0)
+	{
+		*ppv = this;
+		AddRef();
+		result = S_OK;
+	}
+	else if (memcmp(&iid, &IID_IDeckLinkVideoConversion, sizeof(REFIID)) == 0)
+	{
+		*ppv = (IDeckLinkVideoConversion*)this;
+		AddRef();
+		result = S_OK;
+	}
+
+	return result;
+}
+
+ULONG VideoConversion::AddRef(void)
+{
+	return ++m_refCount;
+}
+
+ULONG VideoConversion::Release(void)
+{
+	ULONG newRefValue = --m_refCount;
+
+	if (newRefValue == 0)
+		delete this;
+
+	return newRefValue;
+}
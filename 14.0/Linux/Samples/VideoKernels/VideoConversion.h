@@ -0,0 +1,132 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoKernels.h"
+
+// VideoConversion is a software implementation of IDeckLinkVideoConversion, which converts between
+// all uncompressed pixel formats: 2vuy, v210, Ay10, ARGB, BGRA, r210, R12B, R12L, R10l and R10b.
+//
+// Each frame is split into slices of rows which are converted in parallel by a SliceWorkerPool of worker
+// threads and the calling thread.  Rows are converted through planar 16-bit samples, using the SIMD kernels of
+// the VideoKernels library where available:
+// * YUV formats are unpacked to 4:2:2 10-bit video level samples,
+// * RGB formats are unpacked to 4:4:4 samples at 16-bit video levels (black 4096, white 60160), so
+//   10-bit RGB keeps its headroom and full range formats round trip exactly.
+// Between YUV and RGB the colorimetry kernels convert with the Rec.601, Rec.709 or Rec.2020 matrix,
+// selected from the source frame's colorspace metadata, or from the frame height if there is none.  Alpha is preserved between Ay10,
+// ARGB and BGRA, and is opaque when converting from other formats.
+//
+// CreateSoftwareVideoConversionInstance() is a drop-in replacement for CreateVideoConversionInstance().
+// ConvertFrame() is synchronous, calls from multiple threads are serialized.
+
+// Create a converter that converts each frame with threadCount threads, including the calling thread.
+// 0 selects the number of CPUs.
+IDeckLinkVideoConversion*	CreateSoftwareVideoConversionInstance(unsigned threadCount = 0);
+
+// Returns the minimum row bytes of an uncompressed pixel format, or 0 if the format is not supported
+long						GetPixelFormatRowBytes(BMDPixelFormat pixelFormat, long width);
+
+class VideoConversion : public IDeckLinkVideoConversion
+{
+public:
+	explicit VideoConversion(unsigned threadCount);
+
+	// IDeckLinkVideoConversion interface
+	virtual HRESULT		STDMETHODCALLTYPE	ConvertFrame(IDeckLinkVideoFrame* srcFrame, IDeckLinkVideoFrame* dstFrame);
+
+	// IUnknown interface
+	virtual HRESULT		STDMETHODCALLTYPE	QueryInterface(REFIID iid, LPVOID *ppv);
+	virtual ULONG		STDMETHODCALLTYPE	AddRef();
+	virtual ULONG		STDMETHODCALLTYPE	Release();
+
+	// Planar samples of one row, owned by each thread
+	struct RowPlanes
+	{
+		std::vector<uint16_t>	luma;
+		std::vector<uint16_t>	cb;
+		std::vector<uint16_t>	cr;
+		std::vector<uint16_t>	red;
+		std::vector<uint16_t>	green;
+		std::vector<uint16_t>	blue;
+		std::vector<uint16_t>	alpha;
+	};
+
+	struct PixelFormatCodec;
+
+private:
+	virtual ~VideoConversion();
+
+	struct FrameJob
+	{
+		const PixelFormatCodec*	srcCodec;
+		const PixelFormatCodec*	dstCodec;
+		const uint8_t*			srcBytes;
+		uint8_t*				dstBytes;
+		long					srcRowBytes;
+		long					dstRowBytes;
+		uint32_t				width;
+		uint32_t				height;
+		uint32_t				rowsPerSlice;
+		ColorimetryCoefficients	colorimetry;
+	};
+
+	std::atomic<ULONG>			m_refCount;
+
+	SliceWorkerPool				m_workerPool;
+	std::vector<RowPlanes>		m_rowPlanes;			// Indexed by pool thread
+
+	void						ConvertRows(const FrameJob& job, uint32_t firstRow, uint32_t rowCount, RowPlanes& planes);
+};
+
+// Decode a row of an uncompressed pixel format to the planar samples described above, or encode planar
+// samples to a row, as ConvertFrame() does.  The planes hold at least width samples, and width / 2 rounded up
+// chroma samples.  Alpha is decoded and encoded only by Ay10, ARGB and BGRA.  Returns false if the pixel
+// format is not supported.
+bool						DecodePixelFormatRow(BMDPixelFormat pixelFormat, const void* row, VideoConversion::RowPlanes& planes, uint32_t width);
+bool						EncodePixelFormatRow(BMDPixelFormat pixelFormat, const VideoConversion::RowPlanes& planes, void* row, uint32_t width);
+
+// Returns true if an uncompressed pixel format is decoded to YUV planes, false for RGB or unsupported formats
+bool						IsYUVPixelFormat(BMDPixelFormat pixelFormat);
@@ -0,0 +1,861 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <atomic>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include "VideoKernels.h"
+#include "VideoKernelsPrivate.h"
+
+// 2vuy conversions pass through planar rows of this many pixels, small enough to stay in L1 cache
+static const uint32_t kChunkPixels = 768;
+
+static inline uint8_t RoundTo8Bit(uint16_t sample)
+{
+	return (uint8_t)std::min(255, (sample + 2) >> 2);
+}
+
+void UnpackV210Scalar(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t startPixel, uint32_t width)
+{
+	const uint32_t chromaCount = (width + 1) / 2;
+
+	for (uint32_t x = startPixel; x < width; x += 6)
+	{
+		const uint32_t*	words	= v210Row + (x / 6) * 4;
+		uint16_t		y[6];
+		uint16_t		u[3];
+		uint16_t		v[3];
+
+		u[0] = words[0] & 0x3FF;
+		y[0] = (words[0] >> 10) & 0x3FF;
+		v[0] = (words[0] >> 20) & 0x3FF;
+		y[1] = words[1] & 0x3FF;
+		u[1] = (words[1] >> 10) & 0x3FF;
+		y[2] = (words[1] >> 20) & 0x3FF;
+		v[1] = words[2] & 0x3FF;
+		y[3] = (words[2] >> 10) & 0x3FF;
+		u[2] = (words[2] >> 20) & 0x3FF;
+		y[4] = words[3] & 0x3FF;
+		v[2] = (words[3] >> 10) & 0x3FF;
+		y[5] = (words[3] >> 20) & 0x3FF;
+
+		for (uint32_t i = 0; (i < 6) && (x + i < width); i++)
+			luma[x + i] = y[i];
+
+		for (uint32_t i = 0; (i < 3) && (x / 2 + i < chromaCount); i++)
+		{
+			cb[x / 2 + i] = u[i];
+			cr[x / 2 + i] = v[i];
+		}
+	}
+}
+
+void PackV210Scalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t startPixel, uint32_t width)
+{
+	const uint32_t	chromaCount	= (width + 1) / 2;
+	const uint32_t	rowWords	= V210RowBytes(width) / 4;
+	uint32_t		x;
+
+	for (x = startPixel; x < width; x += 6)
+	{
+		uint32_t*	words = v210Row + (x / 6) * 4;
+		uint32_t	y[6];
+		uint32_t	u[3];
+		uint32_t	v[3];
+
+		// Complete the last group by repeating the last pixel
+		for (uint32_t i = 0; i < 6; i++)
+			y[i] = luma[std::min(x + i, width - 1)] & 0x3FF;
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			u[i] = cb[std::min(x / 2 + i, chromaCount - 1)] & 0x3FF;
+			v[i] = cr[std::min(x / 2 + i, chromaCount - 1)] & 0x3FF;
+		}
+
+		words[0] = u[0] | (y[0] << 10) | (v[0] << 20);
+		words[1] = y[1] | (u[1] << 10) | (y[2] << 20);
+		words[2] = v[1] | (y[3] << 10) | (u[2] << 20);
+		words[3] = y[4] | (v[2] << 10) | (y[5] << 20);
+	}
+
+	for (uint32_t i = ((x + 5) / 6) * 4; i < rowWords; i++)
+		v210Row[i] = 0;
+}
+
+void PlanarTo2vuyScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t startPixel, uint32_t width)
+{
+	for (uint32_t x = startPixel; x < width; x += 2)
+	{
+		yuvRow[x * 2 + 0] = RoundTo8Bit(cb[x / 2]);
+		yuvRow[x * 2 + 1] = RoundTo8Bit(luma[x]);
+		yuvRow[x * 2 + 2] = RoundTo8Bit(cr[x / 2]);
+		yuvRow[x * 2 + 3] = RoundTo8Bit(luma[x + 1]);
+	}
+}
+
+void Unpack2vuyScalar(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t startPixel, uint32_t width)
+{
+	for (uint32_t x = startPixel; x < width; x += 2)
+	{
+		cb[x / 2]		= yuvRow[x * 2 + 0] << 2;
+		luma[x]			= yuvRow[x * 2 + 1] << 2;
+		cr[x / 2]		= yuvRow[x * 2 + 2] << 2;
+		luma[x + 1]		= yuvRow[x * 2 + 3] << 2;
+	}
+}
+
+void UnpackR12Scalar(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t startPixel, uint32_t width, bool bigEndian)
+{
+	const uint32_t	swap		= bigEndian ? 3 : 0;
+	uint16_t*		planes[3]	= { red, green, blue };
+
+	for (uint32_t x = startPixel; x < width; x++)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			// Both bytes of a sample are within the row, and swapped bytes within the same word
+			uint32_t bitOffset	= (x * 3 + c) * 12;
+			uint32_t byteOffset	= bitOffset / 8;
+			uint32_t value		= r12Row[byteOffset ^ swap] | (r12Row[(byteOffset + 1) ^ swap] << 8);
+
+			planes[c][x] = (uint16_t)((value >> (bitOffset & 7)) & 0xFFF);
+		}
+	}
+}
+
+void PackR12Scalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t startPixel, uint32_t width, bool bigEndian)
+{
+	const uint32_t		swap		= bigEndian ? 3 : 0;
+	const uint32_t		rowBytes	= R12RowBytes(width);
+	const uint16_t*		planes[3]	= { red, green, blue };
+
+	for (uint32_t x = startPixel; x < width; x += 8)
+	{
+		uint8_t*	groupBytes	= r12Row + (x / 8) * 36;
+		uint32_t	byteCount	= std::min(36u, rowBytes - (x / 8) * 36);
+		uint8_t		group[36]	= { 0 };
+
+		for (uint32_t i = 0; (i < 8) && (x + i < width); i++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				uint32_t bitOffset	= (i * 3 + c) * 12;
+				uint32_t value		= (planes[c][x + i] & 0xFFF) << (bitOffset & 7);
+
+				group[bitOffset / 8]		|= (uint8_t)value;
+				group[bitOffset / 8 + 1]	|= (uint8_t)(value >> 8);
+			}
+		}
+
+		// The last group is truncated to a whole word
+		for (uint32_t i = 0; i < byteCount; i++)
+			groupBytes[i ^ swap] = group[i];
+	}
+}
+
+void UnpackR210Scalar(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t startPixel, uint32_t width)
+{
+	for (uint32_t x = startPixel; x < width; x++)
+	{
+		// Big-endian words with 2 unused bits above red
+		uint32_t word = __builtin_bswap32(r210Row[x]);
+
+		red[x]		= (uint16_t)((word >> 20) & 0x3FF);
+		green[x]	= (uint16_t)((word >> 10) & 0x3FF);
+		blue[x]		= (uint16_t)(word & 0x3FF);
+	}
+}
+
+void CompositeScalar(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t startSample, uint32_t count)
+{
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		uint32_t value = fill[i] + (((uint32_t)background[i] * inverseKey[i] + kKeyRound) >> kKeyShift);
+
+		output[i] = (uint16_t)std::max<uint32_t>(std::min<uint32_t>(value, kMaxYUVCode), kMinYUVCode);
+	}
+}
+
+void FilterHorizontalScalar(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+							uint16_t* output, uint32_t startSample, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		const uint16_t*	taps	= source + offsets[i];
+		const int16_t*	weights	= coefficients + (size_t)i * tapStride;
+		int32_t			sum		= kFilterRound;
+
+		for (uint32_t t = 0; t < tapStride; t++)
+			sum += weights[t] * taps[t];
+
+		output[i] = (uint16_t)std::max<int32_t>(std::min<int32_t>(sum >> kFilterCoefficientShift, maxValue), minValue);
+	}
+}
+
+void FilterVerticalScalar(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+						  uint16_t* output, uint32_t startSample, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		int32_t sum = kFilterRound;
+
+		for (uint32_t t = 0; t < tapCount; t++)
+			sum += coefficients[t] * sourceRows[t][i];
+
+		output[i] = (uint16_t)std::max<int32_t>(std::min<int32_t>(sum >> kFilterCoefficientShift, maxValue), minValue);
+	}
+}
+
+// Difference between the rows above and below along direction j, over 3 sample pairs
+static inline int DirectionScore(const uint16_t* above, const uint16_t* below, int j)
+{
+	return abs(above[j - 1] - below[-j - 1]) + abs(above[j] - below[-j]) + abs(above[j + 1] - below[-j + 1]);
+}
+
+void DeinterlaceScalar(const DeinterlaceRows& rows, uint16_t* output, uint32_t startSample, uint32_t count)
+{
+	for (uint32_t x = startSample; x < count; x++)
+	{
+		const uint16_t*	above			= rows.above + x;
+		const uint16_t*	below			= rows.below + x;
+		int				c				= above[0];
+		int				e				= below[0];
+		int				d				= (rows.earlier[x] + rows.later[x]) >> 1;
+		int				temporalDiff0	= abs(rows.earlier[x] - rows.later[x]);
+		int				temporalDiff1	= (abs(rows.previousAbove[x] - c) + abs(rows.previousBelow[x] - e)) >> 1;
+		int				temporalDiff2	= (abs(rows.nextAbove[x] - c) + abs(rows.nextBelow[x] - e)) >> 1;
+		int				diff			= std::max(std::max(temporalDiff0 >> 1, temporalDiff1), temporalDiff2);
+		int				spatialPred		= (c + e) >> 1;
+		int				spatialScore	= DirectionScore(above, below, 0) - 1;
+
+		// Edge directed prediction along the direction with the smallest difference, the steeper directions
+		// are only tried after the shallower direction on the same side
+		for (int side = -1; side <= 1; side += 2)
+		{
+			for (int j = side; (j == side) || (j == side * 2); j += side)
+			{
+				int score = DirectionScore(above, below, j);
+
+				if (score >= spatialScore)
+					break;
+
+				spatialScore	= score;
+				spatialPred		= (above[j] + below[-j]) >> 1;
+			}
+		}
+
+		// Where the temporal average is above or below both neighbouring rows allow the spatial prediction,
+		// unless the rows two above and below show the same vertical detail
+		int b	= (rows.earlierAbove[x] + rows.laterAbove[x]) >> 1;
+		int f	= (rows.earlierBelow[x] + rows.laterBelow[x]) >> 1;
+		int max	= std::max(std::max(d - e, d - c), std::min(b - c, f - e));
+		int min	= std::min(std::min(d - e, d - c), std::max(b - c, f - e));
+
+		diff = std::max(std::max(diff, min), -max);
+
+		output[x] = (uint16_t)std::min(std::max(spatialPred, d - diff), d + diff);
+	}
+}
+
+void ApplyLUT1DScalar(const uint16_t* input, uint16_t* output, uint32_t startSample, uint32_t count, const uint16_t* lut)
+{
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		uint32_t	index		= input[i] >> kLUT1DIndexShift;
+		int32_t		fraction	= input[i] & kLUT1DFractionMask;
+		int32_t		low			= lut[index];
+
+		output[i] = (uint16_t)(low + (((lut[index + 1] - low) * fraction + kLUT1DRound) >> kLUT1DIndexShift));
+	}
+}
+
+// Sort the fractions of a pixel's grid position into descending order, with the entry steps of their axes
+static inline void SortLUT3DFractions(int32_t& fraction1, uint32_t& step1, int32_t& fraction2, uint32_t& step2)
+{
+	if (fraction1 < fraction2)
+	{
+		std::swap(fraction1, fraction2);
+		std::swap(step1, step2);
+	}
+}
+
+void ApplyLUT3DScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+					  uint32_t startPixel, uint32_t count, const LUT3D& lut)
+{
+	uint32_t scale = lut.size - 1;
+
+	for (uint32_t i = startPixel; i < count; i++)
+	{
+		uint32_t	redPosition		= LUT3DPosition(red[i], scale);
+		uint32_t	greenPosition	= LUT3DPosition(green[i], scale);
+		uint32_t	bluePosition	= LUT3DPosition(blue[i], scale);
+		uint32_t	vertex0			= ((bluePosition >> kLUT3DPositionShift) * lut.size + (greenPosition >> kLUT3DPositionShift)) * lut.size + (redPosition >> kLUT3DPositionShift);
+		int32_t		fraction1		= (redPosition & 0xFFFF) >> 1;
+		int32_t		fraction2		= (greenPosition & 0xFFFF) >> 1;
+		int32_t		fraction3		= (bluePosition & 0xFFFF) >> 1;
+		uint32_t	step1			= 1;
+		uint32_t	step2			= lut.size;
+		uint32_t	step3			= lut.size * lut.size;
+		uint16_t	output[3];
+
+		// The tetrahedron around the pixel steps from the grid point below it along the axis of the largest
+		// fraction, then the next largest, to the grid point above it
+		SortLUT3DFractions(fraction1, step1, fraction2, step2);
+		SortLUT3DFractions(fraction2, step2, fraction3, step3);
+		SortLUT3DFractions(fraction1, step1, fraction2, step2);
+
+		const uint16_t*	c0	= lut.entries + (size_t)vertex0 * 4;
+		const uint16_t*	c1	= c0 + (size_t)step1 * 4;
+		const uint16_t*	c2	= c1 + (size_t)step2 * 4;
+		const uint16_t*	c3	= c2 + (size_t)step3 * 4;
+
+		for (int c = 0; c < 3; c++)
+		{
+			int32_t sum = ((int32_t)c0[c] << kLUT3DFractionShift) + fraction1 * (c1[c] - c0[c]) + fraction2 * (c2[c] - c1[c]) + fraction3 * (c3[c] - c2[c]);
+
+			output[c] = (uint16_t)((sum + kLUT3DRound) >> kLUT3DFractionShift);
+		}
+
+		outRed[i]	= output[0];
+		outGreen[i]	= output[1];
+		outBlue[i]	= output[2];
+	}
+}
+
+static inline uint16_t LimitHalfBand(int32_t sum, uint16_t minValue, uint16_t maxValue)
+{
+	return (uint16_t)std::max<int32_t>(std::min<int32_t>((sum + kFilterRound) >> kFilterCoefficientShift, maxValue), minValue);
+}
+
+void DecimateHorizontalScalar(const uint16_t* input, uint16_t* output, uint32_t startSample, uint32_t endSample, uint32_t count,
+							  uint16_t minValue, uint16_t maxValue)
+{
+	const int32_t last = (int32_t)count * 2 - 1;
+
+	for (uint32_t i = startSample; i < endSample; i++)
+	{
+		int32_t centre	= (int32_t)i * 2;
+		int32_t sum		= kHalfBandCentre * input[centre];
+
+		for (int32_t t = 0; t < 3; t++)
+			sum += kHalfBandTaps[t] * (input[std::max(centre - (t * 2 + 1), 0)] + input[std::min(centre + (t * 2 + 1), last)]);
+
+		output[i] = LimitHalfBand(sum, minValue, maxValue);
+	}
+}
+
+void InterpolateHorizontalScalar(const uint16_t* input, uint16_t* output, uint32_t startSample, uint32_t endSample, uint32_t count,
+								 uint16_t minValue, uint16_t maxValue)
+{
+	const int32_t last = (int32_t)count - 1;
+
+	for (uint32_t i = startSample; i < endSample; i++)
+	{
+		int32_t sum = 0;
+
+		for (int32_t t = 0; t < 3; t++)
+			sum += kHalfBandTaps[t] * 2 * (input[std::max((int32_t)i - t, 0)] + input[std::min((int32_t)i + 1 + t, last)]);
+
+		output[i * 2]		= input[i];
+		output[i * 2 + 1]	= LimitHalfBand(sum, minValue, maxValue);
+	}
+}
+
+void HalfBandVerticalScalar(const HalfBandRows& rows, uint16_t* output, uint32_t startSample, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	const int32_t scale = (rows.centre != NULL) ? 1 : 2;
+
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		int32_t sum = (rows.centre != NULL) ? kHalfBandCentre * rows.centre[i] : 0;
+
+		for (int t = 0; t < 3; t++)
+			sum += kHalfBandTaps[t] * scale * (rows.above[t][i] + rows.below[t][i]);
+
+		output[i] = LimitHalfBand(sum, minValue, maxValue);
+	}
+}
+
+void SinusoidScalar(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t startSample, uint32_t count)
+{
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		int32_t sum = phases[i * 2] * cosine + phases[i * 2 + 1] * sine;
+
+		output[i] = (uint16_t)std::max<int32_t>(std::min<int32_t>(offset + ((sum + kSinusoidRound) >> kSinusoidShift), 0xFFFF), 0);
+	}
+}
+
+static inline float ToneSine(uint32_t phase)
+{
+	uint32_t	shifted	= phase + kToneQuarterTurn;
+	uint32_t	folded	= ((int32_t)shifted < 0) ? 0u - shifted : shifted;
+	float		x		= (float)(int32_t)(folded - kToneQuarterTurn) * kTonePhaseScale;
+	float		x2		= x * x;
+	float		sum		= kToneSineCoefficients[5];
+
+	for (int i = 4; i >= 0; i--)
+		sum = sum * x2 + kToneSineCoefficients[i];
+
+	return sum * x;
+}
+
+void ToneScalar(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output,
+				uint32_t startChannel, uint32_t frameCount)
+{
+	for (uint32_t c = startChannel; c < channels; c++)
+	{
+		uint32_t phase = phases[c];
+
+		for (uint32_t f = 0; f < frameCount; f++)
+		{
+			output[(size_t)f * channels + c] = levels[c] * ToneSine(phase);
+			phase += increments[c];
+		}
+
+		phases[c] = phase;
+	}
+}
+
+void QuantizeAudioScalar(const float* input, void* output, uint32_t startSample, uint32_t count, uint32_t sampleDepth)
+{
+	const float scale	= (sampleDepth == 32) ? kAudioScale32 : kAudioScale16;
+	const float max		= (sampleDepth == 32) ? kAudioMax32 : kAudioMax16;
+
+	for (uint32_t i = startSample; i < count; i++)
+	{
+		int32_t sample = (int32_t)lrintf(std::min(std::max(input[i] * scale, -scale), max));
+
+		if (sampleDepth == 32)
+			((int32_t*)output)[i] = sample;
+		else
+			((int16_t*)output)[i] = (int16_t)sample;
+	}
+}
+
+static void UnpackV210RowScalar(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	UnpackV210Scalar(v210Row, luma, cb, cr, 0, width);
+}
+
+static void PackV210RowScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t width)
+{
+	PackV210Scalar(luma, cb, cr, v210Row, 0, width);
+}
+
+static void PlanarTo2vuyRowScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t width)
+{
+	PlanarTo2vuyScalar(luma, cb, cr, yuvRow, 0, width);
+}
+
+static void Unpack2vuyRowScalar(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	Unpack2vuyScalar(yuvRow, luma, cb, cr, 0, width);
+}
+
+static void UnpackR12RowScalar(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian)
+{
+	UnpackR12Scalar(r12Row, red, green, blue, 0, width, bigEndian);
+}
+
+static void PackR12RowScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t width, bool bigEndian)
+{
+	PackR12Scalar(red, green, blue, r12Row, 0, width, bigEndian);
+}
+
+static void UnpackR210RowScalar(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width)
+{
+	UnpackR210Scalar(r210Row, red, green, blue, 0, width);
+}
+
+static void CompositeRowScalar(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count)
+{
+	CompositeScalar(background, fill, inverseKey, output, 0, count);
+}
+
+static void FilterRowHorizontalScalar(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+									  uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	FilterHorizontalScalar(source, offsets, coefficients, tapStride, output, 0, count, minValue, maxValue);
+}
+
+static void FilterRowsVerticalScalar(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+									 uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	FilterVerticalScalar(sourceRows, coefficients, tapCount, output, 0, count, minValue, maxValue);
+}
+
+static void DeinterlaceRowScalar(const DeinterlaceRows& rows, uint16_t* output, uint32_t count)
+{
+	DeinterlaceScalar(rows, output, 0, count);
+}
+
+void ApplyLUT1DRowScalar(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut)
+{
+	ApplyLUT1DScalar(input, output, 0, count, lut);
+}
+
+void ApplyLUT3DRowScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+						 uint32_t count, const LUT3D& lut)
+{
+	ApplyLUT3DScalar(red, green, blue, outRed, outGreen, outBlue, 0, count, lut);
+}
+
+static void DecimateRowHorizontalScalar(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	DecimateHorizontalScalar(input, output, 0, count, count, minValue, maxValue);
+}
+
+static void InterpolateRowHorizontalScalar(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	InterpolateHorizontalScalar(input, output, 0, count, count, minValue, maxValue);
+}
+
+static void FilterRowsHalfBandScalar(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	HalfBandVerticalScalar(rows, output, 0, count, minValue, maxValue);
+}
+
+static void RenderSinusoidRowScalar(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count)
+{
+	SinusoidScalar(phases, cosine, sine, offset, output, 0, count);
+}
+
+static void RenderToneFramesScalar(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount)
+{
+	ToneScalar(phases, increments, levels, channels, output, 0, frameCount);
+}
+
+static void QuantizeAudioRowScalar(const float* input, void* output, uint32_t count, uint32_t sampleDepth)
+{
+	QuantizeAudioScalar(input, output, 0, count, sampleDepth);
+}
+
+void ConvertYUV422ToRGBRowScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+										uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	ConvertYUV422ToRGBScalar(luma, cb, cr, red, green, blue, 0, width, coefficients);
+}
+
+void ConvertRGBToYUV422RowScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+										uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	ConvertRGBToYUV422Scalar(red, green, blue, luma, cb, cr, 0, width, coefficients);
+}
+
+static const VideoKernelTable kScalarVideoKernels =
+{
+	UnpackV210RowScalar,
+	PackV210RowScalar,
+	PlanarTo2vuyRowScalar,
+	Unpack2vuyRowScalar,
+	ConvertYUV422ToRGBRowScalar,
+	ConvertRGBToYUV422RowScalar,
+	UnpackR12RowScalar,
+	PackR12RowScalar,
+	UnpackR210RowScalar,
+	CompositeRowScalar,
+	FilterRowHorizontalScalar,
+	FilterRowsVerticalScalar,
+	DeinterlaceRowScalar,
+	ApplyLUT1DRowScalar,
+	ApplyLUT3DRowScalar,
+	DecimateRowHorizontalScalar,
+	InterpolateRowHorizontalScalar,
+	FilterRowsHalfBandScalar,
+	RenderSinusoidRowScalar,
+	RenderToneFramesScalar,
+	QuantizeAudioRowScalar
+};
+
+static const VideoKernelTable* GetKernelTable(VideoKernelsISA isa)
+{
+	switch (isa)
+	{
+		case kVideoKernelsISAScalar:
+			return &kScalarVideoKernels;
+
+#if defined(__x86_64__) || defined(__i386__)
+		case kVideoKernelsISASSE41:
+			return __builtin_cpu_supports("sse4.1") ? &kSSE41VideoKernels : NULL;
+
+		case kVideoKernelsISAAVX2:
+			return __builtin_cpu_supports("avx2") ? &kAVX2VideoKernels : NULL;
+
+		case kVideoKernelsISAAVX512:
+			return (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) ? &kAVX512VideoKernels : NULL;
+#endif
+
+#if defined(__aarch64__)
+		case kVideoKernelsISANEON:
+			// Advanced SIMD is mandatory in AArch64
+			return &kNEONVideoKernels;
+#endif
+
+		default:
+			return NULL;
+	}
+}
+
+static std::atomic<int> g_selectedISA(-1);
+
+VideoKernelsISA GetVideoKernelsISA()
+{
+	int isa = g_selectedISA.load(std::memory_order_relaxed);
+
+	if (isa < 0)
+	{
+		// Select the most capable supported implementation
+		for (isa = kVideoKernelsISACount - 1; isa > kVideoKernelsISAScalar; isa--)
+		{
+			if (GetKernelTable((VideoKernelsISA)isa) != NULL)
+				break;
+		}
+		g_selectedISA.store(isa, std::memory_order_relaxed);
+	}
+
+	return (VideoKernelsISA)isa;
+}
+
+bool SetVideoKernelsISA(VideoKernelsISA isa)
+{
+	if (!IsVideoKernelsISASupported(isa))
+		return false;
+
+	g_selectedISA.store(isa, std::memory_order_relaxed);
+	return true;
+}
+
+bool IsVideoKernelsISASupported(VideoKernelsISA isa)
+{
+	return (isa >= kVideoKernelsISAScalar) && (isa < kVideoKernelsISACount) && (GetKernelTable(isa) != NULL);
+}
+
+const char* GetVideoKernelsISAName(VideoKernelsISA isa)
+{
+	switch (isa)
+	{
+		case kVideoKernelsISAScalar:	return "Scalar";
+		case kVideoKernelsISASSE41:		return "SSE4.1";
+		case kVideoKernelsISAAVX2:		return "AVX2";
+		case kVideoKernelsISAAVX512:	return "AVX-512";
+		case kVideoKernelsISANEON:		return "NEON";
+		default:						return "Unknown";
+	}
+}
+
+static inline const VideoKernelTable* SelectedKernels()
+{
+	return GetKernelTable(GetVideoKernelsISA());
+}
+
+void UnpackV210Row(const void* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	SelectedKernels()->unpackV210((const uint32_t*)v210Row, luma, cb, cr, width);
+}
+
+void PackV210Row(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, void* v210Row, uint32_t width)
+{
+	SelectedKernels()->packV210(luma, cb, cr, (uint32_t*)v210Row, width);
+}
+
+void Unpack2vuyRow(const void* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	const VideoKernelTable* kernels = SelectedKernels();
+
+	kernels->unpack2vuy((const uint8_t*)yuvRow, luma, cb, cr, width & ~1);
+
+	// The last pixel of an odd width shares its chroma with a padding pixel
+	if (width & 1)
+	{
+		const uint8_t* pixelPair = (const uint8_t*)yuvRow + (width - 1) * 2;
+
+		cb[width / 2]		= pixelPair[0] << 2;
+		luma[width - 1]		= pixelPair[1] << 2;
+		cr[width / 2]		= pixelPair[2] << 2;
+	}
+}
+
+void Pack2vuyRow(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, void* yuvRow, uint32_t width)
+{
+	const VideoKernelTable* kernels = SelectedKernels();
+
+	kernels->planarTo2vuy(luma, cb, cr, (uint8_t*)yuvRow, width & ~1);
+
+	// Complete an odd width by repeating the last pixel
+	if (width & 1)
+	{
+		uint16_t lastLuma[2] = { luma[width - 1], luma[width - 1] };
+
+		PlanarTo2vuyScalar(lastLuma, cb + width / 2, cr + width / 2, (uint8_t*)yuvRow + (width - 1) * 2, 0, 2);
+	}
+}
+
+void UnpackR12Row(const void* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian)
+{
+	SelectedKernels()->unpackR12((const uint8_t*)r12Row, red, green, blue, width, bigEndian);
+}
+
+void PackR12Row(const uint16_t* red, const uint16_t* green, const uint16_t* blue, void* r12Row, uint32_t width, bool bigEndian)
+{
+	SelectedKernels()->packR12(red, green, blue, (uint8_t*)r12Row, width, bigEndian);
+}
+
+void UnpackR210Row(const void* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width)
+{
+	SelectedKernels()->unpackR210((const uint32_t*)r210Row, red, green, blue, width);
+}
+
+void CompositeRow(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count)
+{
+	SelectedKernels()->composite(background, fill, inverseKey, output, count);
+}
+
+void FilterRowHorizontal(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+						 uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	SelectedKernels()->filterHorizontal(source, offsets, coefficients, tapStride, output, count, minValue, maxValue);
+}
+
+void FilterRowsVertical(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+						uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	SelectedKernels()->filterVertical(sourceRows, coefficients, tapCount, output, count, minValue, maxValue);
+}
+
+void DeinterlaceRow(const DeinterlaceRows& rows, uint16_t* output, uint32_t count)
+{
+	SelectedKernels()->deinterlace(rows, output, count);
+}
+
+void ApplyLUT1DRow(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut)
+{
+	SelectedKernels()->lut1D(input, output, count, lut);
+}
+
+void ApplyLUT3DRow(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+				   uint32_t count, const LUT3D& lut)
+{
+	SelectedKernels()->lut3D(red, green, blue, outRed, outGreen, outBlue, count, lut);
+}
+
+void DecimateRowHorizontal(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	SelectedKernels()->decimateHorizontal(input, output, count, minValue, maxValue);
+}
+
+void InterpolateRowHorizontal(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	SelectedKernels()->interpolateHorizontal(input, output, count, minValue, maxValue);
+}
+
+void FilterRowsHalfBand(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	SelectedKernels()->halfBandVertical(rows, output, count, minValue, maxValue);
+}
+
+void RenderSinusoidRow(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count)
+{
+	SelectedKernels()->sinusoid(phases, cosine, sine, offset, output, count);
+}
+
+void RenderToneFrames(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount)
+{
+	SelectedKernels()->tone(phases, increments, levels, channels, output, frameCount);
+}
+
+void QuantizeAudioSamples(const float* input, void* output, uint32_t count, uint32_t sampleDepth)
+{
+	SelectedKernels()->quantizeAudio(input, output, count, sampleDepth);
+}
+
+void ConvertYUV422RowToRGB(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+						   uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	SelectedKernels()->yuv422ToRGB(luma, cb, cr, red, green, blue, width, coefficients);
+}
+
+void ConvertRGBRowToYUV422(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+						   uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	SelectedKernels()->rgbToYUV422(red, green, blue, luma, cb, cr, width, coefficients);
+}
+
+void ConvertV210RowTo2vuy(const void* v210Row, void* yuvRow, uint32_t width)
+{
+	const VideoKernelTable*	kernels = SelectedKernels();
+	uint16_t				luma[kChunkPixels + 1];
+	uint16_t				cb[kChunkPixels / 2];
+	uint16_t				cr[kChunkPixels / 2];
+
+	// Chunks start on 48 pixel boundaries, so that each starts on a whole v210 group
+	for (uint32_t x = 0; x < width; x += kChunkPixels)
+	{
+		uint32_t chunkWidth = std::min(kChunkPixels, width - x);
+
+		kernels->unpackV210((const uint32_t*)((const uint8_t*)v210Row + x / 48 * 128), luma, cb, cr, chunkWidth);
+
+		// An odd width is completed to a whole 2vuy pixel pair by repeating the last pixel
+		if (chunkWidth & 1)
+			luma[chunkWidth] = luma[chunkWidth - 1];
+
+		kernels->planarTo2vuy(luma, cb, cr, (uint8_t*)yuvRow + x * 2, (chunkWidth + 1) & ~1);
+	}
+}
+
+void Convert2vuyRowToV210(const void* yuvRow, void* v210Row, uint32_t width)
+{
+	const VideoKernelTable*	kernels = SelectedKernels();
+	uint16_t				luma[kChunkPixels + 1];
+	uint16_t				cb[kChunkPixels / 2];
+	uint16_t				cr[kChunkPixels / 2];
+
+	for (uint32_t x = 0; x < width; x += kChunkPixels)
+	{
+		uint32_t chunkWidth = std::min(kChunkPixels, width - x);
+
+		kernels->unpack2vuy((const uint8_t*)yuvRow + x * 2, luma, cb, cr, (chunkWidth + 1) & ~1);
+
+		// Only the last chunk may be partial, so packing zeroes the end of the row once
+		kernels->packV210(luma, cb, cr, (uint32_t*)((uint8_t*)v210Row + x / 48 * 128), chunkWidth);
+	}
+}
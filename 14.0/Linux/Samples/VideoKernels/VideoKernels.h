@@ -0,0 +1,297 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// VideoKernels converts rows of 10-bit YUV (v210) to and from planar 16-bit samples and 8-bit YUV (2vuy),
+// and rows of 12-bit RGB (R12B and R12L) to and from planar 16-bit samples.
+//
+// Each kernel has a scalar implementation and SIMD implementations for SSE4.1, AVX2 and AVX-512 (x86-64)
+// and NEON (aarch64).  The fastest implementation supported by the CPU is selected when a kernel is
+// first called.
+//
+// Planar rows hold one 16-bit sample per element: width luma samples, and (width + 1) / 2 samples each
+// of Cb and Cr, or width samples each of R, G and B.  v210 rows are ((width + 47) / 48) * 128 bytes and
+// 12-bit RGB rows are ((width * 36 + 31) / 32) * 4 bytes, see DeckLink SDK Manual section 2.7.4.
+// Kernels may be called concurrently on different rows.
+//
+// The colorimetry kernels convert between planar 10-bit 4:2:2 YCbCr and planar 4:4:4 R'G'B' with 16-bit
+// samples, for the Rec.601, Rec.709 and Rec.2020 non-constant luminance matrices.  Each side may be narrow
+// (video) range or full range: narrow range YCbCr is 64-940 luma and 64-960 chroma, narrow range 16-bit
+// RGB is 4096-60160.  Chroma is upsampled and downsampled for co-sited or interstitial siting.  The
+// scalar kernels are the reference implementation, SIMD kernels produce identical results.
+//
+// The composite kernel blends premultiplied graphics over a plane of 10-bit samples, it is used by
+// KeyingCompositor (Compositor.h) to key overlays over v210 video.
+//
+// The filter kernels apply the horizontal and vertical passes of a separable polyphase filter to planes
+// of 10-bit samples, they are used by VideoScaler (VideoScaler.h) to scale v210 video.
+//
+// The deinterlace kernel interpolates the rows missing from a field with a motion adaptive (YADIF) filter,
+// it is used by Deinterlacer (Deinterlacer.h) to deinterlace v210 and 2vuy video.
+//
+// The lookup table kernels map planes of 16-bit samples through 1D tables with linear interpolation, and
+// R'G'B' through 3D tables with tetrahedral interpolation, they are used by ToneMapper (ToneMapper.h) to
+// convert between transfer functions.
+//
+// The half-band kernels decimate planes of 16-bit samples 2:1 and interpolate them 1:2, horizontally or
+// vertically, they are used by Stereo3DPacker (Stereo3D.h) to pack stereoscopic 3D frames side-by-side or
+// top-bottom.
+enum VideoKernelsISA
+{
+	kVideoKernelsISAScalar = 0,
+	kVideoKernelsISASSE41,
+	kVideoKernelsISAAVX2,
+	kVideoKernelsISAAVX512,
+	kVideoKernelsISANEON,
+	kVideoKernelsISACount
+};
+
+inline uint32_t V210RowBytes(uint32_t width) { return ((width + 47) / 48) * 128; }
+inline uint32_t R12RowBytes(uint32_t width) { return ((width * 36 + 31) / 32) * 4; }
+
+// Unpack a v210 row to planar 10-bit samples
+void		UnpackV210Row(const void* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width);
+
+// Pack planar 10-bit samples to a v210 row.  Samples are masked to 10 bits.  The last 6 pixel group is
+// completed by repeating the last pixel and the remainder of the row is zeroed.
+void		PackV210Row(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, void* v210Row, uint32_t width);
+
+// Unpack a 2vuy row to planar 10-bit samples, and pack planar 10-bit samples rounded to 8 bits to a 2vuy row
+void		Unpack2vuyRow(const void* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width);
+void		Pack2vuyRow(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, void* yuvRow, uint32_t width);
+
+// Convert between v210 and 2vuy rows, 10-bit samples are rounded to 8 bits.  2vuy rows are
+// ((width + 1) / 2) * 4 bytes, an odd width is completed by repeating the last pixel.
+void		ConvertV210RowTo2vuy(const void* v210Row, void* yuvRow, uint32_t width);
+void		Convert2vuyRowToV210(const void* yuvRow, void* v210Row, uint32_t width);
+
+// Unpack a 12-bit RGB row, R12B if bigEndian or R12L otherwise, to planar 12-bit samples
+void		UnpackR12Row(const void* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian);
+
+// Pack planar 12-bit samples to a 12-bit RGB row.  Samples are masked to 12 bits, and unused samples of
+// the last 8 pixel group are zero.
+void		PackR12Row(const uint16_t* red, const uint16_t* green, const uint16_t* blue, void* r12Row, uint32_t width, bool bigEndian);
+
+// Unpack a big-endian 10-bit RGB (r210) row to planar 10-bit samples
+void		UnpackR210Row(const void* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width);
+
+// Composite premultiplied fill over a row of 10-bit samples, output = fill + background * inverseKey / 1024,
+// limited to 4-1019.  inverseKey is the weight of the background, 0 where the fill is opaque and 1024 where
+// it is transparent.  output may be the background row.
+void		CompositeRow(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count);
+
+// Filter coefficients are signed with 14 fractional bits, the coefficients of each output sample should sum
+// to 16384.  Filter outputs are rounded and limited to minValue-maxValue.
+static const int		kFilterCoefficientShift		= 14;
+static const uint32_t	kMaxFilterTaps				= 64;
+
+// Filter a row horizontally, output[i] is the sum of coefficients[i * tapStride + t] * source[offsets[i] + t]
+// for t below tapStride.  tapStride must be a multiple of 8, up to kMaxFilterTaps, and source must be
+// readable to offsets[i] + tapStride for each output sample.
+void		FilterRowHorizontal(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+								uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Filter rows vertically, output[i] is the sum of coefficients[t] * sourceRows[t][i] for t below tapCount,
+// up to kMaxFilterTaps.
+void		FilterRowsVertical(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+							   uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Rows around a row missing from a field, for the deinterlace kernel.  Samples are read from 3 before the
+// first to 3 after the last sample of each row.
+struct DeinterlaceRows
+{
+	const uint16_t*	above;				// Rows of the field above and below the missing row
+	const uint16_t*	below;
+	const uint16_t*	previousAbove;		// The same rows of the previous and next frames
+	const uint16_t*	previousBelow;
+	const uint16_t*	nextAbove;
+	const uint16_t*	nextBelow;
+	const uint16_t*	earlier;			// The missing row of the fields of the other parity before and after the field
+	const uint16_t*	later;
+	const uint16_t*	earlierAbove;		// Rows two above and below the missing row of those fields
+	const uint16_t*	earlierBelow;
+	const uint16_t*	laterAbove;
+	const uint16_t*	laterBelow;
+};
+
+// Interpolate a missing row of 10-bit samples.  The temporal average of the earlier and later fields is
+// limited to the range allowed by the motion measured between fields, around the best of 5 edge directed
+// spatial predictions from the rows above and below.  Static areas keep the other field, moving areas are
+// interpolated within the field.
+void		DeinterlaceRow(const DeinterlaceRows& rows, uint16_t* output, uint32_t count);
+
+// 1D lookup tables have an entry for every 16th 16-bit sample, from 0 to 65536
+static const uint32_t	kLUT1DSize		= 4097;
+
+// 3D lookup tables have up to kMaxLUT3DSize grid points on each axis.  Each entry holds the R, G and B
+// samples of a grid point and a zero, the entry of grid point (r, g, b) is at (b * size + g) * size + r.
+static const uint32_t	kMaxLUT3DSize	= 65;
+
+struct LUT3D
+{
+	uint32_t			size;				// Grid points on each axis, 2 to kMaxLUT3DSize
+	const uint16_t*		entries;			// size^3 entries of 4 samples
+};
+
+// Map a row of 16-bit samples through a 1D table of kLUT1DSize entries, interpolating linearly between
+// entries.  output may be input.
+void		ApplyLUT1DRow(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut);
+
+// Map rows of 16-bit R'G'B' samples through a 3D table, interpolating between the 4 grid points of the
+// tetrahedron around each pixel.  The output rows may be the input rows.
+void		ApplyLUT3DRow(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+						  uint32_t count, const LUT3D& lut);
+
+// The half-band filter is a Lanczos-3 filter with every other tap zero, 7 taps to decimate and 6 taps for each
+// interpolated sample.  Samples beyond the ends of a row or plane are the edge samples, so the two halves of a
+// packed row are filtered independently.  Outputs are rounded and limited to minValue-maxValue.
+
+// Decimate a row of count * 2 samples to count samples, output[i] is centred on input[i * 2]
+void		DecimateRowHorizontal(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Interpolate a row of count samples to count * 2 samples, output[i * 2] is input[i] and output[i * 2 + 1] is
+// midway between input[i] and input[i + 1]
+void		InterpolateRowHorizontal(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Rows around an output row of the vertical half-band filter, nearest first.  For 2:1 decimation these are the
+// rows 1, 3 and 5 above and below the centre row, for 1:2 interpolation the 3 rows above and below the
+// interpolated row.
+struct HalfBandRows
+{
+	const uint16_t*	centre;				// Row at the output row to decimate, NULL to interpolate
+	const uint16_t*	above[3];
+	const uint16_t*	below[3];
+};
+
+// Filter a decimated or interpolated row vertically
+void		FilterRowsHalfBand(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Sinusoidal test patterns are rendered from a horizontal phase A(x) and a vertical phase B(y) as
+// cos(A(x) + B(y)) = cos A(x) cos B(y) - sin A(x) sin B(y).  The cosine and sine of A(x) are tabulated once per
+// frame, so each row is a multiply-add of the table with the cosine and sine of its B(y).
+static const int		kSinusoidShift	= 14;
+
+// Render a row of a sinusoid, output[i] = offset + (phases[i * 2] * cosine + phases[i * 2 + 1] * sine) >> 14
+// rounded and saturated to 16 bits.  phases holds the cosine and sine of A(x) scaled by 2^14, and cosine and
+// sine are amplitude * cos B(y) and -amplitude * sin B(y).
+void		RenderSinusoidRow(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count);
+
+// Audio tones are rendered by a numerically controlled oscillator for each channel: a 32-bit phase, a turn being
+// 2^32, advanced by a fixed increment each sample frame.  The sine of a phase is an odd polynomial of the phase
+// folded to a quarter turn, accurate to about 1e-7, so there is no table lookup and no call to sin().  SIMD kernels
+// render groups of channels, and for 1, 2 or 4 channels several frames, in parallel, and match the scalar kernel
+// within a float rounding.  They are used by ToneGenerator (ToneGenerator.h).
+//
+// Render frameCount frames of channels interleaved float samples, output[f * channels + c] = levels[c] *
+// sin(2 pi phases[c] / 2^32), advancing phases[c] by increments[c] after each frame.  phases are left at the
+// phases of the next frame.
+void		RenderToneFrames(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount);
+
+// Convert float audio samples, full scale -1.0 to 1.0, to 16-bit, or 32-bit if sampleDepth is 32, integer
+// samples, rounded to nearest and saturated
+void		QuantizeAudioSamples(const float* input, void* output, uint32_t count, uint32_t sampleDepth);
+
+enum ColorimetryMatrix
+{
+	kColorimetryRec601 = 0,
+	kColorimetryRec709,
+	kColorimetryRec2020
+};
+
+enum ColorimetryRange
+{
+	kColorimetryNarrowRange = 0,
+	kColorimetryFullRange
+};
+
+enum ChromaSiting
+{
+	kChromaSitingCosited = 0,		// Chroma samples are co-sited with even luma samples, as Rec.709 and Rec.2020
+	kChromaSitingInterstitial		// Chroma samples are midway between each pair of luma samples
+};
+
+struct Colorimetry
+{
+	ColorimetryMatrix	matrix;
+	ColorimetryRange	yuvRange;
+	ColorimetryRange	rgbRange;
+	ChromaSiting		chromaSiting;
+};
+
+// Fixed point coefficients of a colorimetry, including range offsets and rounding
+struct ColorimetryCoefficients
+{
+	ChromaSiting		chromaSiting;
+	int32_t				yToRGB;				// YCbCr to RGB, scaled by 2^6
+	int32_t				crToRed;
+	int32_t				cbToGreen;
+	int32_t				crToGreen;
+	int32_t				cbToBlue;
+	int32_t				rgbOffset;
+	int32_t				rgbToY[3];			// RGB to YCbCr, scaled by 2^20
+	int32_t				rgbToCb[3];
+	int32_t				rgbToCr[3];
+	int32_t				yOffset;
+	int32_t				cbOffset;
+	int32_t				crOffset;
+};
+
+void		GetColorimetryCoefficients(const Colorimetry& colorimetry, ColorimetryCoefficients& coefficients);
+
+// Convert planar 4:2:2 YCbCr to 4:4:4 RGB.  Chroma is upsampled by linear interpolation, the last chroma
+// sample is repeated at the right edge, and for interstitial siting the first at the left edge.
+void		ConvertYUV422RowToRGB(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+								  uint32_t width, const ColorimetryCoefficients& coefficients);
+
+// Convert planar 4:4:4 RGB to 4:2:2 YCbCr.  Chroma is downsampled with a [1 2 1] filter for co-sited
+// siting or by averaging each pair of pixels for interstitial siting, repeating edge pixels.  YCbCr
+// samples are limited to 4-1019, excluding the codes reserved for SDI timing references.
+void		ConvertRGBRowToYUV422(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+								  uint32_t width, const ColorimetryCoefficients& coefficients);
+
+// The selected ISA can be overridden, for example to compare implementations.  Returns false if the
+// ISA is not supported by the CPU or was not compiled in.
+VideoKernelsISA	GetVideoKernelsISA(void);
+bool			SetVideoKernelsISA(VideoKernelsISA isa);
+bool			IsVideoKernelsISASupported(VideoKernelsISA isa);
+const char*		GetVideoKernelsISAName(VideoKernelsISA isa);
@@ -0,0 +1,995 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <algorithm>
+#include <immintrin.h>
+#include "VideoKernelsPrivate.h"
+
+#define TARGET_AVX2		__attribute__((target("avx2")))
+
+// AVX2 shuffles do not cross 128-bit lanes, so each lane processes one 6 pixel group, as the SSE4.1
+// kernels do, and two groups are processed per iteration.
+
+TARGET_AVX2
+static inline __m256i BroadcastMask(const int8_t* mask)
+{
+	return _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)mask));
+}
+
+TARGET_AVX2
+static void UnpackV210RowAVX2(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	const __m256i	mask10		= _mm256_set1_epi32(0x3FF);
+	const __m256i	lumaFromAB	= BroadcastMask(kV210LumaFromAB);
+	const __m256i	lumaFromC	= BroadcastMask(kV210LumaFromC);
+	const __m256i	cbFromAB	= BroadcastMask(kV210CbFromAB);
+	const __m256i	cbFromC		= BroadcastMask(kV210CbFromC);
+	const __m256i	crFromAB	= BroadcastMask(kV210CrFromAB);
+	const __m256i	crFromC		= BroadcastMask(kV210CrFromC);
+	uint32_t		x;
+
+	// Each lane writes 8 luma and 4 chroma samples, the last 2 and 1 are overwritten by the next group
+	for (x = 0; x + 14 <= width; x += 12)
+	{
+		__m256i w		= _mm256_loadu_si256((const __m256i*)(v210Row + (x / 6) * 4));
+		__m256i ab		= _mm256_packus_epi32(_mm256_and_si256(w, mask10), _mm256_and_si256(_mm256_srli_epi32(w, 10), mask10));
+		__m256i cc		= _mm256_packus_epi32(_mm256_and_si256(_mm256_srli_epi32(w, 20), mask10), _mm256_setzero_si256());
+		__m256i y		= _mm256_or_si256(_mm256_shuffle_epi8(ab, lumaFromAB), _mm256_shuffle_epi8(cc, lumaFromC));
+		__m256i u		= _mm256_or_si256(_mm256_shuffle_epi8(ab, cbFromAB), _mm256_shuffle_epi8(cc, cbFromC));
+		__m256i v		= _mm256_or_si256(_mm256_shuffle_epi8(ab, crFromAB), _mm256_shuffle_epi8(cc, crFromC));
+
+		_mm_storeu_si128((__m128i*)(luma + x), _mm256_castsi256_si128(y));
+		_mm_storeu_si128((__m128i*)(luma + x + 6), _mm256_extracti128_si256(y, 1));
+		_mm_storel_epi64((__m128i*)(cb + x / 2), _mm256_castsi256_si128(u));
+		_mm_storel_epi64((__m128i*)(cb + x / 2 + 3), _mm256_extracti128_si256(u, 1));
+		_mm_storel_epi64((__m128i*)(cr + x / 2), _mm256_castsi256_si128(v));
+		_mm_storel_epi64((__m128i*)(cr + x / 2 + 3), _mm256_extracti128_si256(v, 1));
+	}
+
+	UnpackV210Scalar(v210Row, luma, cb, cr, x, width);
+}
+
+TARGET_AVX2
+static inline __m256i LoadChromaPair(const uint16_t* cb, const uint16_t* cr)
+{
+	// {Cb0 Cb1 Cb2 Cb3 Cr0 Cr1 Cr2 Cr3} for the groups starting at cb and cb + 3
+	__m128i c0 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)cb), _mm_loadl_epi64((const __m128i*)cr));
+	__m128i c1 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(cb + 3)), _mm_loadl_epi64((const __m128i*)(cr + 3)));
+
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(c0), c1, 1);
+}
+
+TARGET_AVX2
+static void PackV210RowAVX2(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t width)
+{
+	const __m256i	mask10		= _mm256_set1_epi16(0x3FF);
+	const __m256i	aFromL		= BroadcastMask(kV210AFromL);
+	const __m256i	aFromC		= BroadcastMask(kV210AFromC);
+	const __m256i	bFromL		= BroadcastMask(kV210BFromL);
+	const __m256i	bFromC		= BroadcastMask(kV210BFromC);
+	const __m256i	cFromL		= BroadcastMask(kV210CFromL);
+	const __m256i	cFromC		= BroadcastMask(kV210CFromC);
+	uint32_t		x;
+
+	for (x = 0; x + 14 <= width; x += 12)
+	{
+		__m256i l		= _mm256_and_si256(_mm256_loadu2_m128i((const __m128i*)(luma + x + 6), (const __m128i*)(luma + x)), mask10);
+		__m256i c		= _mm256_and_si256(LoadChromaPair(cb + x / 2, cr + x / 2), mask10);
+		__m256i a		= _mm256_or_si256(_mm256_shuffle_epi8(l, aFromL), _mm256_shuffle_epi8(c, aFromC));
+		__m256i b		= _mm256_or_si256(_mm256_shuffle_epi8(l, bFromL), _mm256_shuffle_epi8(c, bFromC));
+		__m256i hi		= _mm256_or_si256(_mm256_shuffle_epi8(l, cFromL), _mm256_shuffle_epi8(c, cFromC));
+
+		_mm256_storeu_si256((__m256i*)(v210Row + (x / 6) * 4), _mm256_or_si256(_mm256_or_si256(a, _mm256_slli_epi32(b, 10)), _mm256_slli_epi32(hi, 20)));
+	}
+
+	PackV210Scalar(luma, cb, cr, v210Row, x, width);
+}
+
+TARGET_AVX2
+static inline __m256i LoadR12UnpackMask(const int8_t* mask, bool bigEndian)
+{
+	return _mm256_xor_si256(BroadcastMask(mask), _mm256_set1_epi8(bigEndian ? 3 : 0));
+}
+
+TARGET_AVX2
+static inline __m256i LoadR12PackMask(const int8_t* mask, bool bigEndian)
+{
+	const __m256i swapWords = bigEndian ? _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+														   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+										: _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+														   0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+	return _mm256_shuffle_epi8(BroadcastMask(mask), swapWords);
+}
+
+// Load 16 bytes from each of two consecutive groups to the low and high lanes
+TARGET_AVX2
+static inline __m256i LoadGroupPair(const uint8_t* group)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)group)), _mm_loadu_si128((const __m128i*)(group + 36)), 1);
+}
+
+// Each lane unpacks one 8 pixel group, as the SSE4.1 kernel does, and two groups are unpacked per iteration
+TARGET_AVX2
+void UnpackR12RowAVX2(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian)
+{
+	const __m256i	mask12	= _mm256_set1_epi16(0xFFF);
+	const __m256i	r0		= LoadR12UnpackMask(kR12RedFromLoad0, bigEndian);
+	const __m256i	r1		= LoadR12UnpackMask(kR12RedFromLoad1, bigEndian);
+	const __m256i	r2		= LoadR12UnpackMask(kR12RedFromLoad2, bigEndian);
+	const __m256i	g0		= LoadR12UnpackMask(kR12GreenFromLoad0, bigEndian);
+	const __m256i	g1		= LoadR12UnpackMask(kR12GreenFromLoad1, bigEndian);
+	const __m256i	g2		= LoadR12UnpackMask(kR12GreenFromLoad2, bigEndian);
+	const __m256i	b0		= LoadR12UnpackMask(kR12BlueFromLoad0, bigEndian);
+	const __m256i	b1		= LoadR12UnpackMask(kR12BlueFromLoad1, bigEndian);
+	const __m256i	b2		= LoadR12UnpackMask(kR12BlueFromLoad2, bigEndian);
+	uint32_t		x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		const uint8_t*	group	= r12Row + (x / 8) * 36;
+		__m256i			l0		= LoadGroupPair(group);
+		__m256i			l1		= LoadGroupPair(group + 12);
+		__m256i			l2		= LoadGroupPair(group + 20);
+
+		__m256i r	= _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(l0, r0), _mm256_shuffle_epi8(l1, r1)), _mm256_shuffle_epi8(l2, r2));
+		__m256i g	= _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(l0, g0), _mm256_shuffle_epi8(l1, g1)), _mm256_shuffle_epi8(l2, g2));
+		__m256i b	= _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(l0, b0), _mm256_shuffle_epi8(l1, b1)), _mm256_shuffle_epi8(l2, b2));
+
+		_mm256_storeu_si256((__m256i*)(red + x), _mm256_blend_epi16(_mm256_and_si256(r, mask12), _mm256_srli_epi16(r, 4), 0xAA));
+		_mm256_storeu_si256((__m256i*)(green + x), _mm256_blend_epi16(_mm256_and_si256(g, mask12), _mm256_srli_epi16(g, 4), 0x55));
+		_mm256_storeu_si256((__m256i*)(blue + x), _mm256_blend_epi16(_mm256_and_si256(b, mask12), _mm256_srli_epi16(b, 4), 0xAA));
+	}
+
+	UnpackR12Scalar(r12Row, red, green, blue, x, width, bigEndian);
+}
+
+TARGET_AVX2
+void PackR12RowAVX2(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t width, bool bigEndian)
+{
+	const __m256i	mask12	= _mm256_set1_epi16(0xFFF);
+	const __m256i	r0		= LoadR12PackMask(kR12Chunk0FromRed, bigEndian);
+	const __m256i	g0		= LoadR12PackMask(kR12Chunk0FromGreen, bigEndian);
+	const __m256i	b0		= LoadR12PackMask(kR12Chunk0FromBlue, bigEndian);
+	const __m256i	r1		= LoadR12PackMask(kR12Chunk1FromRed, bigEndian);
+	const __m256i	g1		= LoadR12PackMask(kR12Chunk1FromGreen, bigEndian);
+	const __m256i	b1		= LoadR12PackMask(kR12Chunk1FromBlue, bigEndian);
+	const __m256i	r2		= LoadR12PackMask(kR12Chunk2FromRed, bigEndian);
+	const __m256i	g2		= LoadR12PackMask(kR12Chunk2FromGreen, bigEndian);
+	const __m256i	b2		= LoadR12PackMask(kR12Chunk2FromBlue, bigEndian);
+	uint32_t		x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		uint8_t*	group	= r12Row + (x / 8) * 36;
+		__m256i		r		= _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(red + x)), mask12);
+		__m256i		g		= _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(green + x)), mask12);
+		__m256i		b		= _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(blue + x)), mask12);
+
+		r = _mm256_blend_epi16(r, _mm256_slli_epi16(r, 4), 0xAA);
+		g = _mm256_blend_epi16(g, _mm256_slli_epi16(g, 4), 0x55);
+		b = _mm256_blend_epi16(b, _mm256_slli_epi16(b, 4), 0xAA);
+
+		__m256i c0	= _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(r, r0), _mm256_shuffle_epi8(g, g0)), _mm256_shuffle_epi8(b, b0));
+		__m256i c1	= _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(r, r1), _mm256_shuffle_epi8(g, g1)), _mm256_shuffle_epi8(b, b1));
+		__m256i c2	= _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(r, r2), _mm256_shuffle_epi8(g, g2)), _mm256_shuffle_epi8(b, b2));
+		int32_t	lastWord0	= _mm256_extract_epi32(c2, 0);
+		int32_t	lastWord1	= _mm256_extract_epi32(c2, 4);
+
+		_mm_storeu_si128((__m128i*)group, _mm256_castsi256_si128(c0));
+		_mm_storeu_si128((__m128i*)(group + 16), _mm256_castsi256_si128(c1));
+		memcpy(group + 32, &lastWord0, 4);
+		_mm_storeu_si128((__m128i*)(group + 36), _mm256_extracti128_si256(c0, 1));
+		_mm_storeu_si128((__m128i*)(group + 52), _mm256_extracti128_si256(c1, 1));
+		memcpy(group + 68, &lastWord1, 4);
+	}
+
+	PackR12Scalar(red, green, blue, r12Row, x, width, bigEndian);
+}
+
+// As the SSE4.1 kernel, the lanes of the packed samples are reordered to restore pixel order
+TARGET_AVX2
+void UnpackR210RowAVX2(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width)
+{
+	const __m256i	swapWords	= _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+												   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m256i	mask10		= _mm256_set1_epi32(0x3FF);
+	uint32_t		x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		__m256i w0 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(r210Row + x)), swapWords);
+		__m256i w1 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(r210Row + x + 8)), swapWords);
+		__m256i r  = _mm256_packus_epi32(_mm256_and_si256(_mm256_srli_epi32(w0, 20), mask10), _mm256_and_si256(_mm256_srli_epi32(w1, 20), mask10));
+		__m256i g  = _mm256_packus_epi32(_mm256_and_si256(_mm256_srli_epi32(w0, 10), mask10), _mm256_and_si256(_mm256_srli_epi32(w1, 10), mask10));
+		__m256i b  = _mm256_packus_epi32(_mm256_and_si256(w0, mask10), _mm256_and_si256(w1, mask10));
+
+		_mm256_storeu_si256((__m256i*)(red + x), _mm256_permute4x64_epi64(r, 0xD8));
+		_mm256_storeu_si256((__m256i*)(green + x), _mm256_permute4x64_epi64(g, 0xD8));
+		_mm256_storeu_si256((__m256i*)(blue + x), _mm256_permute4x64_epi64(b, 0xD8));
+	}
+
+	UnpackR210Scalar(r210Row, red, green, blue, x, width);
+}
+
+// Chroma of 16 pixels from the 8 samples of pixel x onwards, upsampled as UpsampleChroma()
+TARGET_AVX2
+static inline __m256i UpsampleChromaAVX2(const uint16_t* chroma, uint32_t x, ChromaSiting siting)
+{
+	__m128i c		= _mm_loadu_si128((const __m128i*)(chroma + x / 2));
+	__m128i next	= _mm_loadu_si128((const __m128i*)(chroma + x / 2 + 1));
+	__m128i even;
+	__m128i odd;
+
+	if (siting == kChromaSitingCosited)
+	{
+		even	= c;
+		odd		= _mm_avg_epu16(c, next);
+	}
+	else
+	{
+		// The first sample of a row is its own left neighbour
+		__m128i prev	= (x > 0) ? _mm_loadu_si128((const __m128i*)(chroma + x / 2 - 1)) : _mm_insert_epi16(_mm_slli_si128(c, 2), chroma[0], 0);
+		__m128i c3		= _mm_add_epi16(_mm_add_epi16(c, c), _mm_add_epi16(c, _mm_set1_epi16(2)));
+
+		even	= _mm_srli_epi16(_mm_add_epi16(c3, prev), 2);
+		odd		= _mm_srli_epi16(_mm_add_epi16(c3, next), 2);
+	}
+
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(even, odd)), _mm_unpackhi_epi16(even, odd), 1);
+}
+
+// The multiply-adds and packs operate within 128-bit lanes, so luma and chroma stay in pixel order
+TARGET_AVX2
+void ConvertYUV422ToRGBRowAVX2(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+							   uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	const uint32_t	chromaCount	= (width + 1) / 2;
+	const __m256i	chromaZero	= _mm256_set1_epi16(kChromaZero);
+	const __m256i	offset		= _mm256_set1_epi32(coefficients.rgbOffset);
+	const __m256i	redCoeffs	= _mm256_set1_epi32(MaddCoefficients(coefficients.yToRGB, coefficients.crToRed));
+	const __m256i	greenCoeffs	= _mm256_set1_epi32(MaddCoefficients(coefficients.yToRGB, coefficients.cbToGreen));
+	const __m256i	crGreen		= _mm256_set1_epi32(MaddCoefficients(coefficients.crToGreen, 0));
+	const __m256i	blueCoeffs	= _mm256_set1_epi32(MaddCoefficients(coefficients.yToRGB, coefficients.cbToBlue));
+	uint32_t		x;
+
+	// Interpolation reads one chroma sample beyond each group
+	for (x = 0; (x + 16 <= width) && (x / 2 + 8 < chromaCount); x += 16)
+	{
+		__m256i y		= _mm256_loadu_si256((const __m256i*)(luma + x));
+		__m256i u		= _mm256_sub_epi16(UpsampleChromaAVX2(cb, x, coefficients.chromaSiting), chromaZero);
+		__m256i v		= _mm256_sub_epi16(UpsampleChromaAVX2(cr, x, coefficients.chromaSiting), chromaZero);
+
+		__m256i yvLo	= _mm256_unpacklo_epi16(y, v);
+		__m256i yvHi	= _mm256_unpackhi_epi16(y, v);
+		__m256i yuLo	= _mm256_unpacklo_epi16(y, u);
+		__m256i yuHi	= _mm256_unpackhi_epi16(y, u);
+		__m256i vLo		= _mm256_unpacklo_epi16(v, _mm256_setzero_si256());
+		__m256i vHi		= _mm256_unpackhi_epi16(v, _mm256_setzero_si256());
+
+		__m256i rLo		= _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvLo, redCoeffs), offset), kYUVToRGBShift);
+		__m256i rHi		= _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvHi, redCoeffs), offset), kYUVToRGBShift);
+		__m256i gLo		= _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLo, greenCoeffs), _mm256_madd_epi16(vLo, crGreen)), offset), kYUVToRGBShift);
+		__m256i gHi		= _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHi, greenCoeffs), _mm256_madd_epi16(vHi, crGreen)), offset), kYUVToRGBShift);
+		__m256i bLo		= _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLo, blueCoeffs), offset), kYUVToRGBShift);
+		__m256i bHi		= _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHi, blueCoeffs), offset), kYUVToRGBShift);
+
+		_mm256_storeu_si256((__m256i*)(red + x), _mm256_packus_epi32(rLo, rHi));
+		_mm256_storeu_si256((__m256i*)(green + x), _mm256_packus_epi32(gLo, gHi));
+		_mm256_storeu_si256((__m256i*)(blue + x), _mm256_packus_epi32(bLo, bHi));
+	}
+
+	ConvertYUV422ToRGBScalar(luma, cb, cr, red, green, blue, x, width, coefficients);
+}
+
+TARGET_AVX2
+static inline __m256i MultiplyAdd3AVX2(__m256i r, __m256i g, __m256i b, const int32_t* coeffs, int32_t offset)
+{
+	__m256i sum = _mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(coeffs[0])), _mm256_mullo_epi32(g, _mm256_set1_epi32(coeffs[1])));
+
+	sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(b, _mm256_set1_epi32(coeffs[2])));
+	return _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(offset)), kRGBToYUVShift);
+}
+
+// RGB samples at the chroma positions of the 8 pixel pairs from pixel x, as DownsampleRGB(), in 32-bit lanes
+TARGET_AVX2
+static inline __m256i DownsampleRGBAVX2(const uint16_t* samples, uint32_t x, ChromaSiting siting)
+{
+	__m256i s		= _mm256_loadu_si256((const __m256i*)(samples + x));
+	__m256i next	= _mm256_loadu_si256((const __m256i*)(samples + x + 1));
+	__m256i filtered;
+
+	if (siting == kChromaSitingCosited)
+	{
+		__m256i prev;
+
+		if (x > 0)
+			prev = _mm256_loadu_si256((const __m256i*)(samples + x - 1));
+		else
+			prev = _mm256_insert_epi16(_mm256_alignr_epi8(s, _mm256_permute2x128_si256(s, s, 0x08), 14), samples[0], 0);
+
+		filtered = _mm256_avg_epu16(_mm256_avg_epu16(prev, next), s);
+	}
+	else
+	{
+		filtered = _mm256_avg_epu16(s, next);
+	}
+
+	return _mm256_and_si256(filtered, _mm256_set1_epi32(0xFFFF));
+}
+
+TARGET_AVX2
+void ConvertRGBToYUV422RowAVX2(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+									  uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	const __m256i	minCode	= _mm256_set1_epi16(kMinYUVCode);
+	const __m256i	maxCode	= _mm256_set1_epi16(kMaxYUVCode);
+	uint32_t		x;
+
+	// Chroma filtering reads one pixel beyond each group
+	for (x = 0; x + 17 <= width; x += 16)
+	{
+		__m256i r		= _mm256_loadu_si256((const __m256i*)(red + x));
+		__m256i g		= _mm256_loadu_si256((const __m256i*)(green + x));
+		__m256i b		= _mm256_loadu_si256((const __m256i*)(blue + x));
+
+		__m256i yLo		= MultiplyAdd3AVX2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(r)), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(g)),
+										   _mm256_cvtepu16_epi32(_mm256_castsi256_si128(b)), coefficients.rgbToY, coefficients.yOffset);
+		__m256i yHi		= MultiplyAdd3AVX2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(r, 1)), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(g, 1)),
+										   _mm256_cvtepu16_epi32(_mm256_extracti128_si256(b, 1)), coefficients.rgbToY, coefficients.yOffset);
+
+		// Pack interleaves the lanes of yLo and yHi, which the permute restores to pixel order
+		__m256i y		= _mm256_permute4x64_epi64(_mm256_packus_epi32(yLo, yHi), 0xD8);
+		_mm256_storeu_si256((__m256i*)(luma + x), _mm256_max_epu16(_mm256_min_epu16(y, maxCode), minCode));
+
+		__m256i rc		= DownsampleRGBAVX2(red, x, coefficients.chromaSiting);
+		__m256i gc		= DownsampleRGBAVX2(green, x, coefficients.chromaSiting);
+		__m256i bc		= DownsampleRGBAVX2(blue, x, coefficients.chromaSiting);
+		__m256i u		= MultiplyAdd3AVX2(rc, gc, bc, coefficients.rgbToCb, coefficients.cbOffset);
+		__m256i v		= MultiplyAdd3AVX2(rc, gc, bc, coefficients.rgbToCr, coefficients.crOffset);
+
+		u = _mm256_max_epu16(_mm256_min_epu16(_mm256_permute4x64_epi64(_mm256_packus_epi32(u, u), 0x08), maxCode), minCode);
+		v = _mm256_max_epu16(_mm256_min_epu16(_mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08), maxCode), minCode);
+
+		_mm_storeu_si128((__m128i*)(cb + x / 2), _mm256_castsi256_si128(u));
+		_mm_storeu_si128((__m128i*)(cr + x / 2), _mm256_castsi256_si128(v));
+	}
+
+	ConvertRGBToYUV422Scalar(red, green, blue, luma, cb, cr, x, width, coefficients);
+}
+
+TARGET_AVX2
+void CompositeRowAVX2(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count)
+{
+	// Multiply-add of {background, 1} by {inverseKey, round} pairs, unpack and pack are both within lanes
+	const __m256i	one		= _mm256_set1_epi16(1);
+	const __m256i	round	= _mm256_set1_epi16(kKeyRound);
+	uint32_t		i;
+
+	for (i = 0; i + 16 <= count; i += 16)
+	{
+		__m256i bg		= _mm256_loadu_si256((const __m256i*)(background + i));
+		__m256i key		= _mm256_loadu_si256((const __m256i*)(inverseKey + i));
+		__m256i lo		= _mm256_srli_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(bg, one), _mm256_unpacklo_epi16(key, round)), kKeyShift);
+		__m256i hi		= _mm256_srli_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(bg, one), _mm256_unpackhi_epi16(key, round)), kKeyShift);
+		__m256i value	= _mm256_add_epi16(_mm256_packus_epi32(lo, hi), _mm256_loadu_si256((const __m256i*)(fill + i)));
+
+		value = _mm256_max_epu16(_mm256_min_epu16(value, _mm256_set1_epi16(kMaxYUVCode)), _mm256_set1_epi16(kMinYUVCode));
+		_mm256_storeu_si256((__m256i*)(output + i), value);
+	}
+
+	CompositeScalar(background, fill, inverseKey, output, i, count);
+}
+
+TARGET_AVX2
+static inline __m256i FilterTapsAVX2(const uint16_t* taps0, const int16_t* weights0, const uint16_t* taps1, const int16_t* weights1, uint32_t tapStride)
+{
+	__m256i sum = _mm256_setzero_si256();
+
+	for (uint32_t t = 0; t < tapStride; t += 8)
+	{
+		__m256i taps	= _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(taps0 + t))), _mm_loadu_si128((const __m128i*)(taps1 + t)), 1);
+		__m256i weights	= _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(weights0 + t))), _mm_loadu_si128((const __m128i*)(weights1 + t)), 1);
+
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(taps, weights));
+	}
+
+	return sum;
+}
+
+TARGET_AVX2
+void FilterRowHorizontalAVX2(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+							 uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// Each lane multiply-adds 8 taps of one output sample at a time, samples 0-3 in the low lanes and 4-7 in
+	// the high lanes, so the horizontal adds reduce the partial sums to samples in order
+	const __m256i	round	= _mm256_set1_epi32(kFilterRound);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		const int16_t*	weights = coefficients + (size_t)i * tapStride;
+		__m256i			sum[4];
+
+		for (uint32_t j = 0; j < 4; j++)
+			sum[j] = FilterTapsAVX2(source + offsets[i + j], weights + j * tapStride, source + offsets[i + j + 4], weights + (j + 4) * tapStride, tapStride);
+
+		__m256i value	= _mm256_hadd_epi32(_mm256_hadd_epi32(sum[0], sum[1]), _mm256_hadd_epi32(sum[2], sum[3]));
+		value			= _mm256_srai_epi32(_mm256_add_epi32(value, round), kFilterCoefficientShift);
+
+		__m128i packed	= _mm_packs_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+
+		_mm_storeu_si128((__m128i*)(output + i), _mm_max_epi16(_mm_min_epi16(packed, _mm_set1_epi16(maxValue)), _mm_set1_epi16(minValue)));
+	}
+
+	FilterHorizontalScalar(source, offsets, coefficients, tapStride, output, i, count, minValue, maxValue);
+}
+
+TARGET_AVX2
+void FilterRowsVerticalAVX2(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+							uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// Rows are interleaved in pairs for a multiply-add by each pair of coefficients, unpack and pack are both
+	// within lanes
+	const __m256i	round = _mm256_set1_epi32(kFilterRound);
+	__m256i			pairCoefficients[kMaxFilterTaps / 2];
+	uint32_t		pairCount = (tapCount + 1) / 2;
+	uint32_t		i;
+
+	for (uint32_t p = 0; p < pairCount; p++)
+		pairCoefficients[p] = _mm256_set1_epi32(MaddCoefficients(coefficients[p * 2], (p * 2 + 1 < tapCount) ? coefficients[p * 2 + 1] : 0));
+
+	for (i = 0; i + 16 <= count; i += 16)
+	{
+		__m256i lo = round;
+		__m256i hi = round;
+
+		for (uint32_t p = 0; p < pairCount; p++)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(sourceRows[p * 2] + i));
+			__m256i b = (p * 2 + 1 < tapCount) ? _mm256_loadu_si256((const __m256i*)(sourceRows[p * 2 + 1] + i)) : _mm256_setzero_si256();
+
+			lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), pairCoefficients[p]));
+			hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), pairCoefficients[p]));
+		}
+
+		__m256i value = _mm256_packs_epi32(_mm256_srai_epi32(lo, kFilterCoefficientShift), _mm256_srai_epi32(hi, kFilterCoefficientShift));
+
+		value = _mm256_max_epi16(_mm256_min_epi16(value, _mm256_set1_epi16(maxValue)), _mm256_set1_epi16(minValue));
+		_mm256_storeu_si256((__m256i*)(output + i), value);
+	}
+
+	FilterVerticalScalar(sourceRows, coefficients, tapCount, output, i, count, minValue, maxValue);
+}
+
+TARGET_AVX2
+static inline __m256i AbsDiffAVX2(const uint16_t* a, const uint16_t* b)
+{
+	return _mm256_abs_epi16(_mm256_sub_epi16(_mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b)));
+}
+
+TARGET_AVX2
+static inline __m256i AverageAVX2(__m256i a, __m256i b)
+{
+	return _mm256_srai_epi16(_mm256_add_epi16(a, b), 1);
+}
+
+// Sum of differences between the rows above and below along direction j, over 3 sample pairs
+TARGET_AVX2
+static inline __m256i DirectionScoreAVX2(const uint16_t* above, const uint16_t* below, int j)
+{
+	return _mm256_add_epi16(_mm256_add_epi16(AbsDiffAVX2(above + j - 1, below - j - 1), AbsDiffAVX2(above + j, below - j)),
+							AbsDiffAVX2(above + j + 1, below - j + 1));
+}
+
+TARGET_AVX2
+void DeinterlaceRowAVX2(const DeinterlaceRows& rows, uint16_t* output, uint32_t count)
+{
+	// As the SSE4.1 kernel, 16 samples per iteration
+	uint32_t i;
+
+	for (i = 0; i + 16 <= count; i += 16)
+	{
+		const uint16_t*	above			= rows.above + i;
+		const uint16_t*	below			= rows.below + i;
+		__m256i			c				= _mm256_loadu_si256((const __m256i*)above);
+		__m256i			e				= _mm256_loadu_si256((const __m256i*)below);
+		__m256i			d				= AverageAVX2(_mm256_loadu_si256((const __m256i*)(rows.earlier + i)), _mm256_loadu_si256((const __m256i*)(rows.later + i)));
+		__m256i			temporalDiff0	= _mm256_srai_epi16(AbsDiffAVX2(rows.earlier + i, rows.later + i), 1);
+		__m256i			temporalDiff1	= _mm256_srai_epi16(_mm256_add_epi16(AbsDiffAVX2(rows.previousAbove + i, above), AbsDiffAVX2(rows.previousBelow + i, below)), 1);
+		__m256i			temporalDiff2	= _mm256_srai_epi16(_mm256_add_epi16(AbsDiffAVX2(rows.nextAbove + i, above), AbsDiffAVX2(rows.nextBelow + i, below)), 1);
+		__m256i			diff			= _mm256_max_epi16(_mm256_max_epi16(temporalDiff0, temporalDiff1), temporalDiff2);
+		__m256i			spatialPred		= AverageAVX2(c, e);
+		__m256i			spatialScore	= _mm256_sub_epi16(DirectionScoreAVX2(above, below, 0), _mm256_set1_epi16(1));
+
+		for (int side = -1; side <= 1; side += 2)
+		{
+			__m256i selected = _mm256_set1_epi16(-1);
+
+			for (int j = side; (j == side) || (j == side * 2); j += side)
+			{
+				__m256i score	= DirectionScoreAVX2(above, below, j);
+				__m256i pred	= AverageAVX2(_mm256_loadu_si256((const __m256i*)(above + j)), _mm256_loadu_si256((const __m256i*)(below - j)));
+
+				selected		= _mm256_and_si256(selected, _mm256_cmpgt_epi16(spatialScore, score));
+				spatialScore	= _mm256_blendv_epi8(spatialScore, score, selected);
+				spatialPred		= _mm256_blendv_epi8(spatialPred, pred, selected);
+			}
+		}
+
+		__m256i b	= AverageAVX2(_mm256_loadu_si256((const __m256i*)(rows.earlierAbove + i)), _mm256_loadu_si256((const __m256i*)(rows.laterAbove + i)));
+		__m256i f	= AverageAVX2(_mm256_loadu_si256((const __m256i*)(rows.earlierBelow + i)), _mm256_loadu_si256((const __m256i*)(rows.laterBelow + i)));
+		__m256i de	= _mm256_sub_epi16(d, e);
+		__m256i dc	= _mm256_sub_epi16(d, c);
+		__m256i bc	= _mm256_sub_epi16(b, c);
+		__m256i fe	= _mm256_sub_epi16(f, e);
+		__m256i max	= _mm256_max_epi16(_mm256_max_epi16(de, dc), _mm256_min_epi16(bc, fe));
+		__m256i min	= _mm256_min_epi16(_mm256_min_epi16(de, dc), _mm256_max_epi16(bc, fe));
+
+		diff = _mm256_max_epi16(_mm256_max_epi16(diff, min), _mm256_sub_epi16(_mm256_setzero_si256(), max));
+
+		_mm256_storeu_si256((__m256i*)(output + i), _mm256_min_epi16(_mm256_max_epi16(spatialPred, _mm256_sub_epi16(d, diff)), _mm256_add_epi16(d, diff)));
+	}
+
+	DeinterlaceScalar(rows, output, i, count);
+}
+
+// Pack 8 32-bit values of a 256-bit vector to 8 16-bit values with unsigned saturation
+TARGET_AVX2
+static inline __m128i PackUnsigned32AVX2(__m256i value)
+{
+	return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(value, value), 0x08));
+}
+
+TARGET_AVX2
+void ApplyLUT1DRowAVX2(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut)
+{
+	// 8 samples per iteration, a 32-bit gather loads each entry with the entry after it in the high half
+	const __m256i	lowMask	= _mm256_set1_epi32(0xFFFF);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m256i samples		= _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(input + i)));
+		__m256i entries		= _mm256_i32gather_epi32((const int*)lut, _mm256_srli_epi32(samples, kLUT1DIndexShift), 2);
+		__m256i low			= _mm256_and_si256(entries, lowMask);
+		__m256i high		= _mm256_srli_epi32(entries, 16);
+		__m256i fraction	= _mm256_and_si256(samples, _mm256_set1_epi32(kLUT1DFractionMask));
+		__m256i delta		= _mm256_mullo_epi32(_mm256_sub_epi32(high, low), fraction);
+		__m256i value		= _mm256_add_epi32(low, _mm256_srai_epi32(_mm256_add_epi32(delta, _mm256_set1_epi32(kLUT1DRound)), kLUT1DIndexShift));
+
+		_mm_storeu_si128((__m128i*)(output + i), PackUnsigned32AVX2(value));
+	}
+
+	ApplyLUT1DScalar(input, output, i, count, lut);
+}
+
+TARGET_AVX2
+static inline void SortLUT3DFractionsAVX2(__m256i& fraction1, __m256i& step1, __m256i& fraction2, __m256i& step2)
+{
+	__m256i swap			= _mm256_cmpgt_epi32(fraction2, fraction1);
+	__m256i sortedFraction1	= _mm256_blendv_epi8(fraction1, fraction2, swap);
+	__m256i sortedStep1		= _mm256_blendv_epi8(step1, step2, swap);
+
+	fraction2	= _mm256_blendv_epi8(fraction2, fraction1, swap);
+	step2		= _mm256_blendv_epi8(step2, step1, swap);
+	fraction1	= sortedFraction1;
+	step1		= sortedStep1;
+}
+
+// Gather the entries of 8 vertices.  The 64-bit gathers load pixels 0, 1, 4, 5 and 2, 3, 6, 7, so that the
+// in-lane shuffles and unpacks return the red, green and blue samples as 32-bit values in pixel order.
+TARGET_AVX2
+static inline void GatherLUT3DVertexAVX2(const uint16_t* entries, __m256i vertex, __m256i& red, __m256i& green, __m256i& blue)
+{
+	__m256i indices		= _mm256_permute4x64_epi64(vertex, _MM_SHUFFLE(3, 1, 2, 0));
+	__m256i entries0	= _mm256_i32gather_epi64((const long long*)entries, _mm256_castsi256_si128(indices), 8);
+	__m256i entries1	= _mm256_i32gather_epi64((const long long*)entries, _mm256_extracti128_si256(indices, 1), 8);
+	__m256i lowMask		= _mm256_set1_epi32(0xFFFF);
+
+	entries0	= _mm256_shuffle_epi32(entries0, _MM_SHUFFLE(3, 1, 2, 0));
+	entries1	= _mm256_shuffle_epi32(entries1, _MM_SHUFFLE(3, 1, 2, 0));
+
+	__m256i redGreen = _mm256_unpacklo_epi64(entries0, entries1);
+
+	red		= _mm256_and_si256(redGreen, lowMask);
+	green	= _mm256_srli_epi32(redGreen, 16);
+	blue	= _mm256_and_si256(_mm256_unpackhi_epi64(entries0, entries1), lowMask);
+}
+
+TARGET_AVX2
+static inline __m256i LUT3DPositionAVX2(const uint16_t* samples, __m256i scale)
+{
+	__m256i position = _mm256_mullo_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)samples)), scale);
+
+	return _mm256_add_epi32(position, _mm256_srli_epi32(position, kLUT3DPositionShift));
+}
+
+TARGET_AVX2
+void ApplyLUT3DRowAVX2(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+					   uint32_t count, const LUT3D& lut)
+{
+	// As the scalar kernel, 8 pixels per iteration
+	const __m256i	scale			= _mm256_set1_epi32((int)lut.size - 1);
+	const __m256i	size			= _mm256_set1_epi32((int)lut.size);
+	const __m256i	fractionMask	= _mm256_set1_epi32(0xFFFF);
+	const __m256i	round			= _mm256_set1_epi32(kLUT3DRound);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m256i redPosition		= LUT3DPositionAVX2(red + i, scale);
+		__m256i greenPosition	= LUT3DPositionAVX2(green + i, scale);
+		__m256i bluePosition	= LUT3DPositionAVX2(blue + i, scale);
+		__m256i vertex0			= _mm256_mullo_epi32(_mm256_srli_epi32(bluePosition, kLUT3DPositionShift), size);
+		__m256i fraction1		= _mm256_srli_epi32(_mm256_and_si256(redPosition, fractionMask), 1);
+		__m256i fraction2		= _mm256_srli_epi32(_mm256_and_si256(greenPosition, fractionMask), 1);
+		__m256i fraction3		= _mm256_srli_epi32(_mm256_and_si256(bluePosition, fractionMask), 1);
+		__m256i step1			= _mm256_set1_epi32(1);
+		__m256i step2			= size;
+		__m256i step3			= _mm256_mullo_epi32(size, size);
+		__m256i vertexRed[4];
+		__m256i vertexGreen[4];
+		__m256i vertexBlue[4];
+		__m256i vertex;
+
+		vertex0 = _mm256_mullo_epi32(_mm256_add_epi32(vertex0, _mm256_srli_epi32(greenPosition, kLUT3DPositionShift)), size);
+		vertex0 = _mm256_add_epi32(vertex0, _mm256_srli_epi32(redPosition, kLUT3DPositionShift));
+
+		SortLUT3DFractionsAVX2(fraction1, step1, fraction2, step2);
+		SortLUT3DFractionsAVX2(fraction2, step2, fraction3, step3);
+		SortLUT3DFractionsAVX2(fraction1, step1, fraction2, step2);
+
+		vertex = vertex0;
+		GatherLUT3DVertexAVX2(lut.entries, vertex, vertexRed[0], vertexGreen[0], vertexBlue[0]);
+		vertex = _mm256_add_epi32(vertex, step1);
+		GatherLUT3DVertexAVX2(lut.entries, vertex, vertexRed[1], vertexGreen[1], vertexBlue[1]);
+		vertex = _mm256_add_epi32(vertex, step2);
+		GatherLUT3DVertexAVX2(lut.entries, vertex, vertexRed[2], vertexGreen[2], vertexBlue[2]);
+		vertex = _mm256_add_epi32(vertex, step3);
+		GatherLUT3DVertexAVX2(lut.entries, vertex, vertexRed[3], vertexGreen[3], vertexBlue[3]);
+
+		__m256i*	vertexSamples[3]	= { vertexRed, vertexGreen, vertexBlue };
+		uint16_t*	outputs[3]			= { outRed, outGreen, outBlue };
+
+		for (int c = 0; c < 3; c++)
+		{
+			const __m256i*	v	= vertexSamples[c];
+			__m256i			sum	= _mm256_add_epi32(_mm256_slli_epi32(v[0], kLUT3DFractionShift), round);
+
+			sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(fraction1, _mm256_sub_epi32(v[1], v[0])));
+			sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(fraction2, _mm256_sub_epi32(v[2], v[1])));
+			sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(fraction3, _mm256_sub_epi32(v[3], v[2])));
+
+			_mm_storeu_si128((__m128i*)(outputs[c] + i), PackUnsigned32AVX2(_mm256_srai_epi32(sum, kLUT3DFractionShift)));
+		}
+	}
+
+	ApplyLUT3DScalar(red, green, blue, outRed, outGreen, outBlue, i, count, lut);
+}
+
+TARGET_AVX2
+static inline __m256i LoadSamplesAVX2(const uint16_t* samples)
+{
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)samples));
+}
+
+TARGET_AVX2
+static inline __m256i LimitHalfBandAVX2(__m256i sum, __m256i minValue, __m256i maxValue)
+{
+	__m256i value = _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(kFilterRound)), kFilterCoefficientShift);
+
+	return _mm256_max_epi32(_mm256_min_epi32(value, maxValue), minValue);
+}
+
+TARGET_AVX2
+void DecimateRowHorizontalAVX2(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// 8 samples per iteration.  Each 32-bit lane of a load holds an even and odd input pair, so the pair at
+	// each output sample gives its centre tap in the low half, and the pairs around it the odd taps in the
+	// high halves.  Products of 16-bit samples need 32-bit lanes.
+	const __m256i	lowMask	= _mm256_set1_epi32(0xFFFF);
+	const __m256i	min		= _mm256_set1_epi32(minValue);
+	const __m256i	max		= _mm256_set1_epi32(maxValue);
+	uint32_t		i		= std::min(kHalfBandEdgeSamples, count);
+
+	DecimateHorizontalScalar(input, output, 0, i, count, minValue, maxValue);
+
+	for (; i + 8 + kHalfBandEdgeSamples <= count; i += 8)
+	{
+		const uint16_t*	pairs	= input + (size_t)i * 2;
+		__m256i			sum		= _mm256_mullo_epi32(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)pairs), lowMask), _mm256_set1_epi32(kHalfBandCentre));
+
+		for (int t = 0; t < 3; t++)
+		{
+			__m256i before	= _mm256_srli_epi32(_mm256_loadu_si256((const __m256i*)(pairs - (t + 1) * 2)), 16);
+			__m256i after	= _mm256_srli_epi32(_mm256_loadu_si256((const __m256i*)(pairs + t * 2)), 16);
+
+			sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(_mm256_add_epi32(before, after), _mm256_set1_epi32(kHalfBandTaps[t])));
+		}
+
+		_mm_storeu_si128((__m128i*)(output + i), PackUnsigned32AVX2(LimitHalfBandAVX2(sum, min, max)));
+	}
+
+	DecimateHorizontalScalar(input, output, i, count, count, minValue, maxValue);
+}
+
+TARGET_AVX2
+void InterpolateRowHorizontalAVX2(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// 8 input samples per iteration, each 32-bit lane of the output is an input sample in the low half and the
+	// interpolated sample after it in the high half
+	const __m256i	min		= _mm256_set1_epi32(minValue);
+	const __m256i	max		= _mm256_set1_epi32(maxValue);
+	uint32_t		i		= std::min(kHalfBandEdgeSamples, count);
+
+	InterpolateHorizontalScalar(input, output, 0, i, count, minValue, maxValue);
+
+	for (; i + 8 + kHalfBandEdgeSamples <= count; i += 8)
+	{
+		__m256i samples	= LoadSamplesAVX2(input + i);
+		__m256i sum		= _mm256_setzero_si256();
+
+		for (int t = 0; t < 3; t++)
+		{
+			__m256i pair = _mm256_add_epi32(LoadSamplesAVX2(input + i - t), LoadSamplesAVX2(input + i + 1 + t));
+
+			sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(pair, _mm256_set1_epi32(kHalfBandTaps[t] * 2)));
+		}
+
+		_mm256_storeu_si256((__m256i*)(output + (size_t)i * 2), _mm256_or_si256(samples, _mm256_slli_epi32(LimitHalfBandAVX2(sum, min, max), 16)));
+	}
+
+	InterpolateHorizontalScalar(input, output, i, count, count, minValue, maxValue);
+}
+
+TARGET_AVX2
+void FilterRowsHalfBandAVX2(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	const int32_t	scale	= (rows.centre != NULL) ? 1 : 2;
+	const __m256i	min		= _mm256_set1_epi32(minValue);
+	const __m256i	max		= _mm256_set1_epi32(maxValue);
+	__m256i			taps[3];
+	uint32_t		i;
+
+	for (int t = 0; t < 3; t++)
+		taps[t] = _mm256_set1_epi32(kHalfBandTaps[t] * scale);
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m256i sum = (rows.centre != NULL) ? _mm256_mullo_epi32(LoadSamplesAVX2(rows.centre + i), _mm256_set1_epi32(kHalfBandCentre)) : _mm256_setzero_si256();
+
+		for (int t = 0; t < 3; t++)
+			sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(_mm256_add_epi32(LoadSamplesAVX2(rows.above[t] + i), LoadSamplesAVX2(rows.below[t] + i)), taps[t]));
+
+		_mm_storeu_si128((__m128i*)(output + i), PackUnsigned32AVX2(LimitHalfBandAVX2(sum, min, max)));
+	}
+
+	HalfBandVerticalScalar(rows, output, i, count, minValue, maxValue);
+}
+
+TARGET_AVX2
+void RenderSinusoidRowAVX2(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count)
+{
+	// 8 samples per iteration, a multiply-add of each cosine and sine pair of the table gives the 32-bit sum
+	const __m256i	coefficients	= _mm256_set1_epi32(MaddCoefficients(cosine, sine));
+	const __m256i	round			= _mm256_set1_epi32(kSinusoidRound);
+	const __m256i	offsets			= _mm256_set1_epi32(offset);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m256i sum = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)(phases + (size_t)i * 2)), coefficients);
+
+		_mm_storeu_si128((__m128i*)(output + i), PackUnsigned32AVX2(_mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(sum, round), kSinusoidShift), offsets)));
+	}
+
+	SinusoidScalar(phases, cosine, sine, offset, output, i, count);
+}
+
+TARGET_AVX2
+static inline __m256 ToneSineAVX2(__m256i phases)
+{
+	// Evaluated as the scalar kernel, see ToneSineSSE41()
+	const __m256i	quarterTurn	= _mm256_set1_epi32((int32_t)kToneQuarterTurn);
+	__m256i			folded		= _mm256_abs_epi32(_mm256_add_epi32(phases, quarterTurn));
+	__m256			x			= _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(folded, quarterTurn)), _mm256_set1_ps(kTonePhaseScale));
+	__m256			x2			= _mm256_mul_ps(x, x);
+	__m256			sum			= _mm256_set1_ps(kToneSineCoefficients[5]);
+
+	for (int i = 4; i >= 0; i--)
+		sum = _mm256_add_ps(_mm256_mul_ps(sum, x2), _mm256_set1_ps(kToneSineCoefficients[i]));
+
+	return _mm256_mul_ps(sum, x);
+}
+
+TARGET_AVX2
+static inline __m128 ToneSine128AVX2(__m128i phases)
+{
+	const __m128i	quarterTurn	= _mm_set1_epi32((int32_t)kToneQuarterTurn);
+	__m128i			folded		= _mm_abs_epi32(_mm_add_epi32(phases, quarterTurn));
+	__m128			x			= _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(folded, quarterTurn)), _mm_set1_ps(kTonePhaseScale));
+	__m128			x2			= _mm_mul_ps(x, x);
+	__m128			sum			= _mm_set1_ps(kToneSineCoefficients[5]);
+
+	for (int i = 4; i >= 0; i--)
+		sum = _mm_add_ps(_mm_mul_ps(sum, x2), _mm_set1_ps(kToneSineCoefficients[i]));
+
+	return _mm_mul_ps(sum, x);
+}
+
+TARGET_AVX2
+void RenderToneFramesAVX2(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount)
+{
+	uint32_t c;
+
+	if ((channels == 1) || (channels == 2) || (channels == 4))
+	{
+		// Each vector holds 8 / channels frames, lane j is channel j % channels of frame j / channels
+		const uint32_t	framesPerVector = 8 / channels;
+		alignas(32) uint32_t	lanePhases[8];
+		alignas(32) uint32_t	laneSteps[8];
+		alignas(32) float		laneLevels[8];
+		uint32_t		f;
+
+		for (uint32_t j = 0; j < 8; j++)
+		{
+			lanePhases[j]	= phases[j % channels] + (j / channels) * increments[j % channels];
+			laneSteps[j]	= framesPerVector * increments[j % channels];
+			laneLevels[j]	= levels[j % channels];
+		}
+
+		__m256i			phase	= _mm256_load_si256((const __m256i*)lanePhases);
+		const __m256i	step	= _mm256_load_si256((const __m256i*)laneSteps);
+		const __m256	level	= _mm256_load_ps(laneLevels);
+
+		for (f = 0; f + framesPerVector <= frameCount; f += framesPerVector)
+		{
+			_mm256_storeu_ps(output + (size_t)f * channels, _mm256_mul_ps(level, ToneSineAVX2(phase)));
+			phase = _mm256_add_epi32(phase, step);
+		}
+
+		// The first lanes hold the phases of frame f
+		_mm256_store_si256((__m256i*)lanePhases, phase);
+		for (uint32_t j = 0; j < channels; j++)
+			phases[j] = lanePhases[j];
+
+		ToneScalar(phases, increments, levels, channels, output + (size_t)f * channels, 0, frameCount - f);
+		return;
+	}
+
+	// Otherwise each vector holds 8 channels of a frame, and a remainder of 4 or more channels a 128-bit vector
+	for (c = 0; c + 8 <= channels; c += 8)
+	{
+		__m256i			phase	= _mm256_loadu_si256((const __m256i*)(phases + c));
+		const __m256i	step	= _mm256_loadu_si256((const __m256i*)(increments + c));
+		const __m256	level	= _mm256_loadu_ps(levels + c);
+
+		for (uint32_t f = 0; f < frameCount; f++)
+		{
+			_mm256_storeu_ps(output + (size_t)f * channels + c, _mm256_mul_ps(level, ToneSineAVX2(phase)));
+			phase = _mm256_add_epi32(phase, step);
+		}
+
+		_mm256_storeu_si256((__m256i*)(phases + c), phase);
+	}
+
+	if (c + 4 <= channels)
+	{
+		__m128i			phase	= _mm_loadu_si128((const __m128i*)(phases + c));
+		const __m128i	step	= _mm_loadu_si128((const __m128i*)(increments + c));
+		const __m128	level	= _mm_loadu_ps(levels + c);
+
+		for (uint32_t f = 0; f < frameCount; f++)
+		{
+			_mm_storeu_ps(output + (size_t)f * channels + c, _mm_mul_ps(level, ToneSine128AVX2(phase)));
+			phase = _mm_add_epi32(phase, step);
+		}
+
+		_mm_storeu_si128((__m128i*)(phases + c), phase);
+		c += 4;
+	}
+
+	ToneScalar(phases, increments, levels, channels, output, c, frameCount);
+}
+
+TARGET_AVX2
+static inline __m256i QuantizeAudio8AVX2(const float* input, __m256 scale, __m256 min, __m256 max)
+{
+	return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(input), scale), min), max));
+}
+
+TARGET_AVX2
+void QuantizeAudioAVX2(const float* input, void* output, uint32_t count, uint32_t sampleDepth)
+{
+	// 16 samples per iteration, packssdw interleaves the 128-bit lanes so the 64-bit quarters are reordered
+	const __m256	scale	= _mm256_set1_ps((sampleDepth == 32) ? kAudioScale32 : kAudioScale16);
+	const __m256	min		= _mm256_set1_ps((sampleDepth == 32) ? -kAudioScale32 : -kAudioScale16);
+	const __m256	max		= _mm256_set1_ps((sampleDepth == 32) ? kAudioMax32 : kAudioMax16);
+	uint32_t		i;
+
+	for (i = 0; i + 16 <= count; i += 16)
+	{
+		__m256i lo = QuantizeAudio8AVX2(input + i, scale, min, max);
+		__m256i hi = QuantizeAudio8AVX2(input + i + 8, scale, min, max);
+
+		if (sampleDepth == 32)
+		{
+			_mm256_storeu_si256((__m256i*)((int32_t*)output + i), lo);
+			_mm256_storeu_si256((__m256i*)((int32_t*)output + i + 8), hi);
+		}
+		else
+		{
+			_mm256_storeu_si256((__m256i*)((int16_t*)output + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8));
+		}
+	}
+
+	QuantizeAudioScalar(input, output, i, count, sampleDepth);
+}
+
+const VideoKernelTable kAVX2VideoKernels =
+{
+	UnpackV210RowAVX2,
+	PackV210RowAVX2,
+	PlanarTo2vuyRowSSE41,
+	Unpack2vuyRowSSE41,
+	ConvertYUV422ToRGBRowAVX2,
+	ConvertRGBToYUV422RowAVX2,
+	UnpackR12RowAVX2,
+	PackR12RowAVX2,
+	UnpackR210RowAVX2,
+	CompositeRowAVX2,
+	FilterRowHorizontalAVX2,
+	FilterRowsVerticalAVX2,
+	DeinterlaceRowAVX2,
+	ApplyLUT1DRowAVX2,
+	ApplyLUT3DRowAVX2,
+	DecimateRowHorizontalAVX2,
+	InterpolateRowHorizontalAVX2,
+	FilterRowsHalfBandAVX2,
+	RenderSinusoidRowAVX2,
+	RenderToneFramesAVX2,
+	QuantizeAudioAVX2
+};
+
+#endif
@@ -0,0 +1,147 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+#include "VideoKernelsPrivate.h"
+
+// GCC 12 reports the undefined pass-through operand of unmasked AVX-512 intrinsics as uninitialized
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define TARGET_AVX512	__attribute__((target("avx512f,avx512bw")))
+
+// Four 6 pixel groups are processed per iteration.  Unlike SSE4.1 and AVX2, AVX-512BW has word permutes
+// that select from two registers across the full width, so the samples of all four groups are gathered
+// into place by one permute per plane, and masked loads and stores touch exactly 24 pixels.
+
+// Unpack word indices into ab (0-31) and cc (32-63), which hold the packed a, b and c fields of each
+// group in its own 128-bit lane, see VideoKernelsPrivate.h
+alignas(64) static const uint16_t kLumaIndices[32]	= {	4, 1, 33, 6, 3, 35, 12, 9, 41, 14, 11, 43, 20, 17, 49, 22, 19, 51, 28, 25, 57, 30, 27, 59,
+														0, 0, 0, 0, 0, 0, 0, 0 };
+alignas(64) static const uint16_t kCbIndices[32]	= {	0, 5, 34, 8, 13, 42, 16, 21, 50, 24, 29, 58,
+														0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+alignas(64) static const uint16_t kCrIndices[32]	= {	32, 2, 7, 40, 10, 15, 48, 18, 23, 56, 26, 31,
+														0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// Pack word indices into 24 luma samples (0-23) and 12 Cb (32-43) and 12 Cr (48-59) samples, giving the
+// a, b and c fields in the low word of each v210 word
+alignas(64) static const uint16_t kAIndices[32]		= {	32, 0, 1, 0, 49, 0, 4, 0, 35, 0, 7, 0, 52, 0, 10, 0, 38, 0, 13, 0, 55, 0, 16, 0, 41, 0, 19, 0, 58, 0, 22, 0 };
+alignas(64) static const uint16_t kBIndices[32]		= {	0, 0, 33, 0, 3, 0, 50, 0, 6, 0, 36, 0, 9, 0, 53, 0, 12, 0, 39, 0, 15, 0, 56, 0, 18, 0, 42, 0, 21, 0, 59, 0 };
+alignas(64) static const uint16_t kCIndices[32]		= {	48, 0, 2, 0, 34, 0, 5, 0, 51, 0, 8, 0, 37, 0, 11, 0, 54, 0, 14, 0, 40, 0, 17, 0, 57, 0, 20, 0, 43, 0, 23, 0 };
+
+static const __mmask32 kLumaMask	= 0x00FFFFFF;
+static const __mmask32 kChromaMask	= 0x00000FFF;
+static const __mmask32 kLowWordMask	= 0x55555555;
+
+TARGET_AVX512
+static void UnpackV210RowAVX512(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	const __m512i	mask10		= _mm512_set1_epi32(0x3FF);
+	const __m512i	lumaIndices	= _mm512_load_si512(kLumaIndices);
+	const __m512i	cbIndices	= _mm512_load_si512(kCbIndices);
+	const __m512i	crIndices	= _mm512_load_si512(kCrIndices);
+	uint32_t		x;
+
+	for (x = 0; x + 24 <= width; x += 24)
+	{
+		__m512i w		= _mm512_loadu_si512(v210Row + (x / 6) * 4);
+		__m512i ab		= _mm512_packus_epi32(_mm512_and_si512(w, mask10), _mm512_and_si512(_mm512_srli_epi32(w, 10), mask10));
+		__m512i cc		= _mm512_packus_epi32(_mm512_and_si512(_mm512_srli_epi32(w, 20), mask10), _mm512_setzero_si512());
+
+		_mm512_mask_storeu_epi16(luma + x, kLumaMask, _mm512_permutex2var_epi16(ab, lumaIndices, cc));
+		_mm512_mask_storeu_epi16(cb + x / 2, kChromaMask, _mm512_permutex2var_epi16(ab, cbIndices, cc));
+		_mm512_mask_storeu_epi16(cr + x / 2, kChromaMask, _mm512_permutex2var_epi16(ab, crIndices, cc));
+	}
+
+	UnpackV210Scalar(v210Row, luma, cb, cr, x, width);
+}
+
+TARGET_AVX512
+static void PackV210RowAVX512(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t width)
+{
+	const __m512i	mask10		= _mm512_set1_epi16(0x3FF);
+	const __m512i	aIndices	= _mm512_load_si512(kAIndices);
+	const __m512i	bIndices	= _mm512_load_si512(kBIndices);
+	const __m512i	cIndices	= _mm512_load_si512(kCIndices);
+	uint32_t		x;
+
+	for (x = 0; x + 24 <= width; x += 24)
+	{
+		__m512i l		= _mm512_and_si512(_mm512_maskz_loadu_epi16(kLumaMask, luma + x), mask10);
+		__m512i u		= _mm512_maskz_loadu_epi16(kChromaMask, cb + x / 2);
+		__m512i v		= _mm512_maskz_loadu_epi16(kChromaMask, cr + x / 2);
+		__m512i c		= _mm512_and_si512(_mm512_inserti64x4(u, _mm512_castsi512_si256(v), 1), mask10);
+		__m512i a		= _mm512_maskz_permutex2var_epi16(kLowWordMask, l, aIndices, c);
+		__m512i b		= _mm512_maskz_permutex2var_epi16(kLowWordMask, l, bIndices, c);
+		__m512i hi		= _mm512_maskz_permutex2var_epi16(kLowWordMask, l, cIndices, c);
+
+		_mm512_storeu_si512(v210Row + (x / 6) * 4, _mm512_or_si512(_mm512_or_si512(a, _mm512_slli_epi32(b, 10)), _mm512_slli_epi32(hi, 20)));
+	}
+
+	PackV210Scalar(luma, cb, cr, v210Row, x, width);
+}
+
+const VideoKernelTable kAVX512VideoKernels =
+{
+	UnpackV210RowAVX512,
+	PackV210RowAVX512,
+	PlanarTo2vuyRowSSE41,
+	Unpack2vuyRowSSE41,
+	ConvertYUV422ToRGBRowAVX2,
+	ConvertRGBToYUV422RowAVX2,
+	UnpackR12RowAVX2,
+	PackR12RowAVX2,
+	UnpackR210RowAVX2,
+	CompositeRowAVX2,
+	FilterRowHorizontalAVX2,
+	FilterRowsVerticalAVX2,
+	DeinterlaceRowAVX2,
+	ApplyLUT1DRowAVX2,
+	ApplyLUT3DRowAVX2,
+	DecimateRowHorizontalAVX2,
+	InterpolateRowHorizontalAVX2,
+	FilterRowsHalfBandAVX2,
+	RenderSinusoidRowAVX2,
+	RenderToneFramesAVX2,
+	QuantizeAudioAVX2
+};
+
+#endif
@@ -0,0 +1,3544 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "AnimatedPattern.h"
+#include "AVSync.h"
+#include "CEA708_Decoder.h"
+#include "CEA708_Encoder.h"
+#include "Compositor.h"
+#include "CubeLUT.h"
+#include "Deinterlacer.h"
+#include "LTC.h"
+#include "LUTProcessor.h"
+#include "PatternCache.h"
+#include "Stereo3D.h"
+#include "TextOverlay.h"
+#include "TimecodeBurnIn.h"
+#include "ToneGenerator.h"
+#include "ToneMapper.h"
+#include "VideoConversion.h"
+#include "VideoKernels.h"
+#include "VideoScaler.h"
+
+// VideoKernelsBenchmark checks each kernel implementation supported by the CPU against the scalar
+// implementation, then measures its throughput converting whole frames.  The scalar colorimetry kernels
+// are checked against a floating point model of each colorimetry, and the keying compositor against a
+// floating point blend.  It then checks the software IDeckLinkVideoConversion between every pair of
+// pixel formats and measures its conversion time, the video scaler and its scaling time, the deinterlacer
+// and its deinterlacing time, the tone mapper and its tone mapping time, the 3D LUT processor and its
+// processing time, the stereoscopic 3D packer and its packing time, the pattern cache and the time to
+// create a pattern frame, the animated patterns and their rendering time, the text overlay and the time to
+// burn timecode into a frame, the A/V sync analyzer and its analysis time, the tone generator against sin() and
+// its rendering rate, LTC decoded from the encoder and the time to encode and decode it, and CEA-708 captions with
+// their CEA-608 compatibility bytes decoded from the ClosedCaptions encoder and the time to decode them.
+
+struct FrameBuffers
+{
+	uint32_t				width;
+	uint32_t				height;
+	uint32_t				v210RowBytes;
+	uint32_t				yuvRowBytes;
+	uint32_t				r12RowBytes;
+	std::vector<uint8_t>	v210;
+	std::vector<uint8_t>	yuv;
+	std::vector<uint8_t>	r12;
+	std::vector<uint16_t>	luma;
+	std::vector<uint16_t>	cb;
+	std::vector<uint16_t>	cr;
+	std::vector<uint16_t>	red;
+	std::vector<uint16_t>	green;
+	std::vector<uint16_t>	blue;
+	std::vector<uint16_t>	fill;
+	std::vector<uint16_t>	inverseKey;
+	std::vector<uint32_t>	filterOffsets;
+	std::vector<int16_t>	filterCoefficients;
+	std::vector<uint16_t>	lut1D;
+	std::vector<uint16_t>	lut3D;
+	ColorimetryCoefficients	colorimetry;
+};
+
+// Filter kernels are run with random coefficients, horizontally over kFilterTapStride input samples from
+// random offsets, and vertically over kFilterRowCount rows
+static const uint32_t kFilterTapStride	= 16;
+static const uint32_t kFilterRowCount	= 7;
+
+// Lookup table kernels are run with random tables, the 3D table has the grid size used by ToneMapper
+static const uint32_t kLUT3DTestSize	= 33;
+
+enum KernelID
+{
+	kKernelUnpackV210 = 0,
+	kKernelPackV210,
+	kKernelV210To2vuy,
+	kKernel2vuyToV210,
+	kKernelYUVToRGB,
+	kKernelRGBToYUV,
+	kKernelUnpackR12B,
+	kKernelPackR12B,
+	kKernelUnpackR12L,
+	kKernelPackR12L,
+	kKernelUnpackR210,
+	kKernelComposite,
+	kKernelFilterHorizontal,
+	kKernelFilterVertical,
+	kKernelDeinterlace,
+	kKernelLUT1D,
+	kKernelLUT3D,
+	kKernelDecimateHorizontal,
+	kKernelInterpolateHorizontal,
+	kKernelHalfBandVertical,
+	kKernelSinusoid,
+	kKernelCount
+};
+
+static const char* kKernelNames[kKernelCount] =
+{
+	"v210 -> planar",
+	"planar -> v210",
+	"v210 -> 2vuy",
+	"2vuy -> v210",
+	"YUV 4:2:2 -> RGB",
+	"RGB -> YUV 4:2:2",
+	"R12B -> planar",
+	"planar -> R12B",
+	"R12L -> planar",
+	"planar -> R12L",
+	"r210 -> planar",
+	"composite 4:2:2",
+	"horizontal filter",
+	"vertical filter",
+	"deinterlace",
+	"1D LUT",
+	"3D LUT",
+	"decimate 2:1",
+	"interpolate 1:2",
+	"vertical 2:1 1:2",
+	"sinusoid"
+};
+
+// Every combination of matrix, ranges and chroma siting
+static const int kColorimetryCount = 3 * 2 * 2 * 2;
+
+static Colorimetry GetTestColorimetry(int index)
+{
+	Colorimetry colorimetry;
+
+	colorimetry.matrix			= (ColorimetryMatrix)(index % 3);
+	colorimetry.yuvRange		= (ColorimetryRange)((index / 3) % 2);
+	colorimetry.rgbRange		= (ColorimetryRange)((index / 6) % 2);
+	colorimetry.chromaSiting	= (ChromaSiting)((index / 12) % 2);
+
+	return colorimetry;
+}
+
+static void AllocateFrame(FrameBuffers& frame, uint32_t width, uint32_t height)
+{
+	uint32_t chromaWidth = (width + 1) / 2;
+
+	frame.width			= width;
+	frame.height		= height;
+	frame.v210RowBytes	= V210RowBytes(width);
+	frame.yuvRowBytes	= chromaWidth * 4;
+	frame.r12RowBytes	= R12RowBytes(width);
+	frame.v210.assign((size_t)frame.v210RowBytes * height, 0);
+	frame.yuv.assign((size_t)frame.yuvRowBytes * height, 0);
+	frame.r12.assign((size_t)frame.r12RowBytes * height, 0);
+	// Luma is padded for the horizontal filter
+	frame.luma.assign((size_t)width * height + kFilterTapStride, 0);
+	frame.cb.assign((size_t)chromaWidth * height, 0);
+	frame.cr.assign((size_t)chromaWidth * height, 0);
+	frame.red.assign((size_t)width * height, 0);
+	frame.green.assign((size_t)width * height, 0);
+	frame.blue.assign((size_t)width * height, 0);
+	frame.fill.assign((size_t)width * height, 0);
+	frame.inverseKey.assign((size_t)width * height, 0);
+	frame.filterOffsets.assign(width, 0);
+	frame.filterCoefficients.assign((size_t)width * kFilterTapStride, 0);
+	frame.lut1D.assign(kLUT1DSize, 0);
+	frame.lut3D.assign((size_t)kLUT3DTestSize * kLUT3DTestSize * kLUT3DTestSize * 4, 0);
+
+	// Rec.709 video levels unless a colorimetry is selected
+	GetColorimetryCoefficients(GetTestColorimetry(1), frame.colorimetry);
+}
+
+static void FillRandom(FrameBuffers& frame, std::mt19937& random)
+{
+	for (uint16_t& sample : frame.luma)
+		sample = random() & 0x3FF;
+	for (uint16_t& sample : frame.cb)
+		sample = random() & 0x3FF;
+	for (uint16_t& sample : frame.cr)
+		sample = random() & 0x3FF;
+	for (uint8_t& byte : frame.yuv)
+		byte = random() & 0xFF;
+	for (uint8_t& byte : frame.r12)
+		byte = random() & 0xFF;
+	for (uint16_t& sample : frame.red)
+		sample = random() & 0xFFFF;
+	for (uint16_t& sample : frame.green)
+		sample = random() & 0xFFFF;
+	for (uint16_t& sample : frame.blue)
+		sample = random() & 0xFFFF;
+	for (uint16_t& sample : frame.fill)
+		sample = random() & 0x3FF;
+	for (uint16_t& sample : frame.inverseKey)
+		sample = random() % 1025;
+	for (uint32_t& offset : frame.filterOffsets)
+		offset = random() % frame.width;
+	// Coefficients average 1/16, so filtered samples are both within and beyond the limits
+	for (int16_t& coefficient : frame.filterCoefficients)
+		coefficient = (int16_t)((int32_t)(random() % 4096) - 1024);
+	for (uint16_t& entry : frame.lut1D)
+		entry = random() & 0xFFFF;
+	for (uint16_t& entry : frame.lut3D)
+		entry = random() & 0xFFFF;
+}
+
+static void RunKernel(KernelID kernel, FrameBuffers& frame)
+{
+	uint32_t chromaWidth = (frame.width + 1) / 2;
+
+	for (uint32_t y = 0; y < frame.height; y++)
+	{
+		uint8_t*	v210Row	= frame.v210.data() + (size_t)y * frame.v210RowBytes;
+		uint8_t*	yuvRow	= frame.yuv.data() + (size_t)y * frame.yuvRowBytes;
+		uint8_t*	r12Row	= frame.r12.data() + (size_t)y * frame.r12RowBytes;
+		uint16_t*	luma	= frame.luma.data() + (size_t)y * frame.width;
+		uint16_t*	cb		= frame.cb.data() + (size_t)y * chromaWidth;
+		uint16_t*	cr		= frame.cr.data() + (size_t)y * chromaWidth;
+		uint16_t*	red		= frame.red.data() + (size_t)y * frame.width;
+		uint16_t*	green	= frame.green.data() + (size_t)y * frame.width;
+		uint16_t*	blue	= frame.blue.data() + (size_t)y * frame.width;
+		uint16_t*	fill	= frame.fill.data() + (size_t)y * frame.width;
+		uint16_t*	key		= frame.inverseKey.data() + (size_t)y * frame.width;
+
+		switch (kernel)
+		{
+			case kKernelUnpackV210:
+				UnpackV210Row(v210Row, luma, cb, cr, frame.width);
+				break;
+			case kKernelPackV210:
+				PackV210Row(luma, cb, cr, v210Row, frame.width);
+				break;
+			case kKernelV210To2vuy:
+				ConvertV210RowTo2vuy(v210Row, yuvRow, frame.width);
+				break;
+			case kKernel2vuyToV210:
+				Convert2vuyRowToV210(yuvRow, v210Row, frame.width);
+				break;
+			case kKernelYUVToRGB:
+				ConvertYUV422RowToRGB(luma, cb, cr, red, green, blue, frame.width, frame.colorimetry);
+				break;
+			case kKernelRGBToYUV:
+				ConvertRGBRowToYUV422(red, green, blue, luma, cb, cr, frame.width, frame.colorimetry);
+				break;
+			case kKernelUnpackR12B:
+			case kKernelUnpackR12L:
+				UnpackR12Row(r12Row, red, green, blue, frame.width, kernel == kKernelUnpackR12B);
+				break;
+			case kKernelPackR12B:
+			case kKernelPackR12L:
+				PackR12Row(red, green, blue, r12Row, frame.width, kernel == kKernelPackR12B);
+				break;
+			case kKernelUnpackR210:
+				// 12-bit RGB rows have at least the 4 bytes per pixel of r210
+				UnpackR210Row(r12Row, red, green, blue, frame.width);
+				break;
+			case kKernelComposite:
+				// Chroma planes use the start of the fill and key rows
+				CompositeRow(luma, fill, key, luma, frame.width);
+				CompositeRow(cb, fill, key, cb, chromaWidth);
+				CompositeRow(cr, fill, key, cr, chromaWidth);
+				break;
+			case kKernelFilterHorizontal:
+				FilterRowHorizontal(luma, frame.filterOffsets.data(), frame.filterCoefficients.data(), kFilterTapStride, red, frame.width, 4, 1019);
+				break;
+			case kKernelFilterVertical:
+			{
+				// Rows following this row, wrapping to the first, with the coefficients of the first output sample
+				const uint16_t* sourceRows[kFilterRowCount];
+
+				for (uint32_t t = 0; t < kFilterRowCount; t++)
+					sourceRows[t] = frame.luma.data() + (size_t)((y + t) % frame.height) * frame.width;
+
+				FilterRowsVertical(sourceRows, frame.filterCoefficients.data(), kFilterRowCount, green, frame.width, 4, 1019);
+				break;
+			}
+			case kKernelDeinterlace:
+			{
+				// Rows of the luma and fill planes following this row, wrapping to the first, so that some
+				// rows are static between fields.  The kernel reads 3 samples beyond each end of the rows.
+				DeinterlaceRows	rows;
+				auto			planeRow = [&](const std::vector<uint16_t>& plane, uint32_t offset) { return plane.data() + (size_t)((y + offset) % frame.height) * frame.width + 3; };
+
+				rows.above			= planeRow(frame.luma, 0);
+				rows.below			= planeRow(frame.luma, 1);
+				rows.previousAbove	= planeRow(frame.fill, 0);
+				rows.previousBelow	= planeRow(frame.luma, 1);
+				rows.nextAbove		= planeRow(frame.luma, 0);
+				rows.nextBelow		= planeRow(frame.fill, 1);
+				rows.earlier		= planeRow(frame.luma, 2);
+				rows.later			= planeRow(frame.fill, 2);
+				rows.earlierAbove	= planeRow(frame.fill, 3);
+				rows.earlierBelow	= planeRow(frame.luma, 3);
+				rows.laterAbove		= planeRow(frame.luma, 4);
+				rows.laterBelow		= planeRow(frame.fill, 4);
+
+				if (frame.width > 6)
+					DeinterlaceRow(rows, blue + 3, frame.width - 6);
+				break;
+			}
+			case kKernelLUT1D:
+				ApplyLUT1DRow(red, red, frame.width, frame.lut1D.data());
+				ApplyLUT1DRow(green, green, frame.width, frame.lut1D.data());
+				ApplyLUT1DRow(blue, blue, frame.width, frame.lut1D.data());
+				break;
+			case kKernelLUT3D:
+			{
+				LUT3D lut = { kLUT3DTestSize, frame.lut3D.data() };
+
+				ApplyLUT3DRow(red, green, blue, red, green, blue, frame.width, lut);
+				break;
+			}
+			case kKernelDecimateHorizontal:
+				// 16-bit samples, limited within the range so that overshoots are limited at both ends
+				DecimateRowHorizontal(red, green, frame.width / 2, 16, 65000);
+				break;
+			case kKernelInterpolateHorizontal:
+				InterpolateRowHorizontal(red, blue, frame.width / 2, 16, 65000);
+				break;
+			case kKernelHalfBandVertical:
+			{
+				// Rows around this row, wrapping at the ends, decimated to green and interpolated to blue
+				HalfBandRows	rows;
+				auto			redRow = [&](int32_t offset) { return frame.red.data() + (size_t)((y + frame.height * 8 + offset) % frame.height) * frame.width; };
+
+				rows.centre = red;
+				for (int t = 0; t < 3; t++)
+				{
+					rows.above[t] = redRow(-(t * 2 + 1));
+					rows.below[t] = redRow(t * 2 + 1);
+				}
+				FilterRowsHalfBand(rows, green, frame.width, 16, 65000);
+
+				rows.centre = NULL;
+				for (int t = 0; t < 3; t++)
+				{
+					rows.above[t] = redRow(-t);
+					rows.below[t] = redRow(t + 1);
+				}
+				FilterRowsHalfBand(rows, blue, frame.width, 16, 65000);
+				break;
+			}
+			case kKernelSinusoid:
+				// Random coefficients as cosine and sine pairs, and a random amplitude and offset of each row, so
+				// that outputs saturate at both ends
+				RenderSinusoidRow(frame.filterCoefficients.data(), (int16_t)red[0], (int16_t)green[0], blue[0], blue, frame.width);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+// Compare every kernel of the selected ISA against the scalar kernels for one frame of random samples,
+// and the colorimetry kernels for every colorimetry
+static bool VerifyKernels(VideoKernelsISA isa, uint32_t width, uint32_t height, std::mt19937& random)
+{
+	FrameBuffers	source;
+	FrameBuffers	reference;
+	FrameBuffers	result;
+	bool			matched = true;
+
+	AllocateFrame(source, width, height);
+	FillRandom(source, random);
+
+	// Unpack source samples packed by the scalar kernel, so that unpack and pack round trip exactly
+	SetVideoKernelsISA(kVideoKernelsISAScalar);
+	RunKernel(kKernelPackV210, source);
+
+	for (int kernel = 0; kernel < kKernelCount; kernel++)
+	{
+		bool	colorimetryKernel	= (kernel == kKernelYUVToRGB) || (kernel == kKernelRGBToYUV);
+		int		colorimetryCount	= colorimetryKernel ? kColorimetryCount : 1;
+
+		for (int colorimetry = 0; colorimetry < colorimetryCount; colorimetry++)
+		{
+			reference	= source;
+
+			if (colorimetryKernel)
+				GetColorimetryCoefficients(GetTestColorimetry(colorimetry), reference.colorimetry);
+
+			result		= reference;
+
+			SetVideoKernelsISA(kVideoKernelsISAScalar);
+			RunKernel((KernelID)kernel, reference);
+			SetVideoKernelsISA(isa);
+			RunKernel((KernelID)kernel, result);
+
+			if ((result.v210 != reference.v210) || (result.yuv != reference.yuv) || (result.r12 != reference.r12) ||
+				(result.luma != reference.luma) || (result.cb != reference.cb) || (result.cr != reference.cr) ||
+				(result.red != reference.red) || (result.green != reference.green) || (result.blue != reference.blue))
+			{
+				fprintf(stderr, "%s %s does not match scalar result for width %u, colorimetry %d\n",
+						GetVideoKernelsISAName(isa), kKernelNames[kernel], width, colorimetry);
+				matched = false;
+			}
+		}
+	}
+
+	return matched;
+}
+
+// Compare the scalar colorimetry kernels with floating point conversion of random flat colours, where
+// chroma filtering has no effect.  RGB must be within 1/4 and YCbCr within 1 of a 10-bit code.
+static bool VerifyColorimetryAccuracy(std::mt19937& random)
+{
+	static const double	kKr[3]			= { 0.299, 0.2126, 0.2627 };
+	static const double	kKb[3]			= { 0.114, 0.0722, 0.0593 };
+	static const int	kColourCount	= 20000;
+	double				maxRGBError		= 0.0;
+	double				maxYUVError		= 0.0;
+	bool				accurate		= true;
+
+	SetVideoKernelsISA(kVideoKernelsISAScalar);
+
+	for (int index = 0; index < kColorimetryCount; index++)
+	{
+		Colorimetry				colorimetry = GetTestColorimetry(index);
+		ColorimetryCoefficients	coefficients;
+		double					kr			= kKr[colorimetry.matrix];
+		double					kb			= kKb[colorimetry.matrix];
+		double					kg			= 1.0 - kr - kb;
+		bool					fullYUV		= (colorimetry.yuvRange == kColorimetryFullRange);
+		bool					fullRGB		= (colorimetry.rgbRange == kColorimetryFullRange);
+		double					yBlack		= fullYUV ? 0.0 : 64.0;
+		double					yRange		= fullYUV ? 1023.0 : 876.0;
+		double					cRange		= fullYUV ? 1023.0 : 896.0;
+		double					rgbBlack	= fullRGB ? 0.0 : 4096.0;
+		double					rgbRange	= fullRGB ? 65535.0 : 56064.0;
+
+		GetColorimetryCoefficients(colorimetry, coefficients);
+
+		for (int colour = 0; colour < kColourCount; colour++)
+		{
+			uint16_t	luma[2];
+			uint16_t	cb[1]		= { (uint16_t)(random() & 0x3FF) };
+			uint16_t	cr[1]		= { (uint16_t)(random() & 0x3FF) };
+			uint16_t	rgb[3][2];
+
+			luma[0] = luma[1] = random() & 0x3FF;
+
+			ConvertYUV422RowToRGB(luma, cb, cr, rgb[0], rgb[1], rgb[2], 2, coefficients);
+
+			double y		= (luma[0] - yBlack) / yRange;
+			double u		= (cb[0] - 512.0) / cRange;
+			double v		= (cr[0] - 512.0) / cRange;
+			double ideal[3]	=
+			{
+				y + 2.0 * (1.0 - kr) * v,
+				y - 2.0 * kb * (1.0 - kb) / kg * u - 2.0 * kr * (1.0 - kr) / kg * v,
+				y + 2.0 * (1.0 - kb) * u
+			};
+
+			for (int c = 0; c < 3; c++)
+			{
+				double expected = std::min(std::max(rgbBlack + ideal[c] * rgbRange, 0.0), 65535.0);
+				maxRGBError = std::max(maxRGBError, fabs(rgb[c][0] - expected) / 64.0);
+			}
+
+			for (int c = 0; c < 3; c++)
+				rgb[c][0] = rgb[c][1] = random() & 0xFFFF;
+
+			ConvertRGBRowToYUV422(rgb[0], rgb[1], rgb[2], luma, cb, cr, 2, coefficients);
+
+			double r		= (rgb[0][0] - rgbBlack) / rgbRange;
+			double g		= (rgb[1][0] - rgbBlack) / rgbRange;
+			double b		= (rgb[2][0] - rgbBlack) / rgbRange;
+			double ey		= kr * r + kg * g + kb * b;
+			double expected[3] =
+			{
+				yBlack + ey * yRange,
+				512.0 + (b - ey) / (2.0 * (1.0 - kb)) * cRange,
+				512.0 + (r - ey) / (2.0 * (1.0 - kr)) * cRange
+			};
+			uint16_t actual[3] = { luma[0], cb[0], cr[0] };
+
+			for (int c = 0; c < 3; c++)
+				maxYUVError = std::max(maxYUVError, fabs(actual[c] - std::min(std::max(expected[c], 4.0), 1019.0)));
+		}
+	}
+
+	if ((maxRGBError > 0.25) || (maxYUVError > 1.0))
+		accurate = false;
+
+	printf("Scalar colorimetry kernels %s, maximum error RGB %.3f, YCbCr %.3f 10-bit codes\n",
+		   accurate ? "accurate" : "NOT ACCURATE", maxRGBError, maxYUVError);
+
+	return accurate;
+}
+
+static void BenchmarkKernels(VideoKernelsISA isa, uint32_t width, uint32_t height, int iterations, std::mt19937& random)
+{
+	FrameBuffers frame;
+
+	AllocateFrame(frame, width, height);
+	FillRandom(frame, random);
+	SetVideoKernelsISA(isa);
+
+	for (int kernel = 0; kernel < kKernelCount; kernel++)
+	{
+		// Throughput is measured in bytes of the packed format, v210 or 2vuy for 2vuy -> v210, v210 for the
+		// colorimetry, composite and lookup table kernels and 12-bit RGB for the 12-bit RGB kernels
+		double bytesPerFrame = (double)frame.v210.size();
+
+		if (kernel == kKernel2vuyToV210)
+			bytesPerFrame = (double)frame.yuv.size();
+		else if ((kernel >= kKernelUnpackR12B) && (kernel <= kKernelPackR12L))
+			bytesPerFrame = (double)frame.r12.size();
+
+		RunKernel((KernelID)kernel, frame);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < iterations; i++)
+			RunKernel((KernelID)kernel, frame);
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		// Cores needed to convert 7680x4320 at 60 frames/s, assuming throughput scales with cores
+		double pixelsPerSecond = (double)width * height * iterations / elapsed.count();
+
+		printf("  %-8s %-16s %8.2f GB/s %9.1f frames/s %6.2f cores for 8K60\n", GetVideoKernelsISAName(isa), kKernelNames[kernel],
+			   bytesPerFrame * iterations / elapsed.count() / 1e9, iterations / elapsed.count(), 7680.0 * 4320.0 * 60.0 / pixelsPerSecond);
+	}
+}
+
+static void FillRandomV210(std::vector<uint8_t>& v210, uint32_t width, uint32_t height, std::mt19937& random)
+{
+	std::vector<uint16_t> luma(width);
+	std::vector<uint16_t> cb((width + 1) / 2);
+	std::vector<uint16_t> cr((width + 1) / 2);
+
+	v210.assign((size_t)V210RowBytes(width) * height, 0);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint16_t& sample : luma)
+			sample = 64 + random() % 877;
+		for (uint16_t& sample : cb)
+			sample = 64 + random() % 897;
+		for (uint16_t& sample : cr)
+			sample = 64 + random() % 897;
+
+		PackV210Row(luma.data(), cb.data(), cr.data(), v210.data() + (size_t)y * V210RowBytes(width), width);
+	}
+}
+
+// Ay10 graphics with random fill and key within rect, and some fully transparent and opaque pixels
+static void FillRandomAy10(std::vector<uint8_t>& ay10, uint32_t width, uint32_t height, const OverlayRect& rect, std::mt19937& random)
+{
+	ay10.assign((size_t)width * 4 * height, 0);
+
+	for (uint32_t y = rect.y; y < rect.y + rect.height; y++)
+	{
+		for (uint32_t x = rect.x; x < rect.x + rect.width; x++)
+		{
+			uint32_t	alpha	= random() % 1200;
+			uint32_t	word	= (std::min(alpha, 1023u) << 20) | ((64 + random() % 897) << 10) | (64 + random() % 877);
+			uint8_t*	pixel	= ay10.data() + ((size_t)y * width + x) * 4;
+
+			pixel[0] = word >> 24;
+			pixel[1] = word >> 16;
+			pixel[2] = word >> 8;
+			pixel[3] = word;
+		}
+	}
+}
+
+static uint32_t LoadAy10Word(const std::vector<uint8_t>& ay10, uint32_t width, uint32_t x, uint32_t y)
+{
+	const uint8_t* pixel = ay10.data() + ((size_t)y * width + x) * 4;
+
+	return ((uint32_t)pixel[0] << 24) | (pixel[1] << 16) | (pixel[2] << 8) | pixel[3];
+}
+
+static double ExpectedComposite(uint32_t fill, double alpha, uint16_t background)
+{
+	return std::min(std::max(fill * alpha + background * (1.0 - alpha), 4.0), 1019.0);
+}
+
+// Composite random Ay10 graphics over random video, each sample within the overlay rectangle must be within
+// 1.5 codes of a floating point blend and every other sample unchanged.  Rendering the overlay back to Ay10
+// must reproduce the graphics, and only rows which changed since the last render are rewritten.  The
+// rectangle is aligned to pairs of pixels, so chroma outside it is unchanged.
+static bool VerifyCompositor(uint32_t width, uint32_t height, std::mt19937& random)
+{
+	KeyingCompositor		compositor(width, height, kColorimetryRec709);
+	OverlayRect				rect			= { (width / 5) & ~1u, height / 4, ((width * 3 / 5) & ~1u) - ((width / 5) & ~1u), height / 2 + 1 };
+	uint32_t				rowBytes		= V210RowBytes(width);
+	long					ay10RowBytes	= GetPixelFormatRowBytes(bmdFormat10BitYUVA, width);
+	uint32_t				chromaWidth		= (width + 1) / 2;
+	std::vector<uint8_t>	background;
+	std::vector<uint8_t>	graphics;
+	std::vector<uint8_t>	ay10;
+	std::vector<uint64_t>	renderedVersions;
+	double					maxError		= 0.0;
+	bool					matched			= true;
+
+	FillRandomV210(background, width, height, random);
+	FillRandomAy10(graphics, width, height, rect, random);
+
+	std::vector<uint8_t> composite = background;
+
+	if ((compositor.UpdateOverlay(bmdFormat10BitYUVA, graphics.data(), width * 4, rect, false) != S_OK) ||
+		(compositor.CompositeV210(composite.data(), rowBytes) != S_OK))
+		return false;
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		std::vector<uint16_t>	bg[3]		= { std::vector<uint16_t>(width), std::vector<uint16_t>(chromaWidth), std::vector<uint16_t>(chromaWidth) };
+		std::vector<uint16_t>	out[3]		= { std::vector<uint16_t>(width), std::vector<uint16_t>(chromaWidth), std::vector<uint16_t>(chromaWidth) };
+		bool					inRect		= (y >= rect.y) && (y < rect.y + rect.height);
+
+		UnpackV210Row(background.data() + (size_t)y * rowBytes, bg[0].data(), bg[1].data(), bg[2].data(), width);
+		UnpackV210Row(composite.data() + (size_t)y * rowBytes, out[0].data(), out[1].data(), out[2].data(), width);
+
+		for (uint32_t x = 0; x < width; x++)
+		{
+			uint32_t	word		= LoadAy10Word(graphics, width, x, y);
+			double		alpha		= ((word >> 20) & 0x3FF) / 1023.0;
+
+			// Chroma is keyed with the average key of each pair of pixels
+			if (!inRect || (x < rect.x) || (x >= rect.x + rect.width))
+			{
+				if ((out[0][x] != bg[0][x]) || (out[1][x / 2] != bg[1][x / 2]) || (out[2][x / 2] != bg[2][x / 2]))
+					matched = false;
+				continue;
+			}
+
+			maxError = std::max(maxError, fabs(out[0][x] - ExpectedComposite(word & 0x3FF, alpha, bg[0][x])));
+
+			if ((x & 1) == 0)
+			{
+				uint32_t	oddWord		= LoadAy10Word(graphics, width, x + 1, y);
+				double		pairAlpha	= (alpha + ((oddWord >> 20) & 0x3FF) / 1023.0) / 2.0;
+
+				maxError = std::max(maxError, fabs(out[1][x / 2] - ExpectedComposite((word >> 10) & 0x3FF, pairAlpha, bg[1][x / 2])));
+				maxError = std::max(maxError, fabs(out[2][x / 2] - ExpectedComposite((oddWord >> 10) & 0x3FF, pairAlpha, bg[2][x / 2])));
+			}
+		}
+	}
+
+	if (maxError > 1.5)
+		matched = false;
+
+	// Ay10 frames have rows of whole 64 pixel blocks, a shorter row is rejected
+	if ((ay10RowBytes != (long)width * 4) && (compositor.RenderAy10(graphics.data(), width * 4, renderedVersions) != E_INVALIDARG))
+		matched = false;
+
+	// Render the whole overlay, then a second render must not write to the frame
+	ay10.assign((size_t)ay10RowBytes * height, 0);
+	compositor.RenderAy10(ay10.data(), ay10RowBytes, renderedVersions);
+
+	for (uint32_t y = rect.y; y < rect.y + rect.height; y++)
+	{
+		if (memcmp(ay10.data() + (size_t)y * ay10RowBytes + rect.x * 4, graphics.data() + ((size_t)y * width + rect.x) * 4, rect.width * 4) != 0)
+			matched = false;
+	}
+
+	std::fill(ay10.begin(), ay10.end(), 0xFF);
+	compositor.RenderAy10(ay10.data(), ay10RowBytes, renderedVersions);
+
+	if (std::count(ay10.begin(), ay10.end(), 0xFF) != (long)ay10.size())
+		matched = false;
+
+	if (!matched)
+		fprintf(stderr, "Keying compositor failed for %ux%u, maximum error %.2f\n", width, height, maxError);
+
+	return matched;
+}
+
+// Composite a lower third, the bottom quarter of the frame, and render it to Ay10
+static void BenchmarkCompositor(uint32_t width, uint32_t height, int iterations, std::mt19937& random)
+{
+	KeyingCompositor		compositor(width, height, kColorimetryRec709);
+	OverlayRect				lowerThird		= { 0, height - height / 4, width, height / 4 };
+	OverlayRect				dirtyRect		= { width / 2, lowerThird.y, std::min(width / 2, 64u), std::min(lowerThird.height, 64u) };
+	std::vector<uint8_t>	video;
+	std::vector<uint8_t>	graphics;
+	long					ay10RowBytes	= GetPixelFormatRowBytes(bmdFormat10BitYUVA, width);
+	std::vector<uint8_t>	ay10((size_t)ay10RowBytes * height, 0);
+	std::vector<uint64_t>	renderedVersions;
+
+	FillRandomV210(video, width, height, random);
+	FillRandomAy10(graphics, width, height, lowerThird, random);
+	compositor.UpdateOverlay(bmdFormat10BitYUVA, graphics.data(), width * 4, lowerThird, false);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < iterations; i++)
+		compositor.CompositeV210(video.data(), V210RowBytes(width));
+
+	std::chrono::duration<double> compositeTime = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	compositor.RenderAy10(ay10.data(), ay10RowBytes, renderedVersions);
+	std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		compositor.UpdateOverlay(bmdFormat10BitYUVA, graphics.data(), width * 4, dirtyRect, false);
+		compositor.RenderAy10(ay10.data(), ay10RowBytes, renderedVersions);
+	}
+
+	std::chrono::duration<double> updateTime = std::chrono::steady_clock::now() - start;
+
+	printf("  Lower third composite %.2f ms/frame, Ay10 render %.2f ms, %ux%u update and render %.2f ms/frame\n",
+		   compositeTime.count() * 1000.0 / iterations, renderTime.count() * 1000.0, dirtyRect.width, dirtyRect.height,
+		   updateTime.count() * 1000.0 / iterations);
+}
+
+struct ScalerTest
+{
+	uint32_t	srcWidth;
+	uint32_t	srcHeight;
+	uint32_t	dstWidth;
+	uint32_t	dstHeight;
+	bool		interlaced;
+};
+
+// Up, down and cross conversions between HD, UHD and SD, and small frames for the edges of the filters
+static const ScalerTest kScalerTests[] =
+{
+	{ 1920, 1080, 3840, 2160, false },
+	{ 3840, 2160, 1920, 1080, false },
+	{ 1280, 720, 1920, 1080, false },
+	{ 1920, 1080, 1280, 720, false },
+	{ 1920, 1080, 720, 486, true },
+	{ 720, 576, 1920, 1080, true },
+	{ 97, 31, 50, 17, false },
+	{ 7, 5, 13, 10, true },
+};
+
+// Scaling random video to the same size must leave it unchanged, and scaling with the worker pool must
+// match a single thread.  A frame with ramps of luma and Cb across and Cr down must scale to the same ramps
+// at each output sample's position, away from the edges.  The mean difference from the rounded ramp within
+// 1/4 code checks the alignment of the luma and co-sited chroma samples and of the fields, the maximum
+// error of 1.25 codes allows for rounding of the ramps and the filter passes.
+static bool VerifyScaler(const ScalerTest& test, std::mt19937& random)
+{
+	uint32_t	srcRowBytes		= V210RowBytes(test.srcWidth);
+	uint32_t	dstRowBytes		= V210RowBytes(test.dstWidth);
+	double		scaleX			= (double)test.srcWidth / test.dstWidth;
+	double		scaleY			= (double)test.srcHeight / test.dstHeight;
+	double		marginX			= 8 * std::max(scaleX, 1.0);
+	double		marginY			= 8 * std::max(scaleY, 1.0) * (test.interlaced ? 2 : 1);
+	double		slopeX			= 800.0 / test.srcWidth;
+	double		slopeY			= 800.0 / test.srcHeight;
+	bool		matched			= true;
+
+	for (int filter = kVideoScalerBicubic; filter <= kVideoScalerLanczos3; filter++)
+	{
+		VideoScaler				pooledScaler(test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight, (VideoScalerFilter)filter, test.interlaced, 4);
+		VideoScaler				singleScaler(test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight, (VideoScalerFilter)filter, test.interlaced, 1);
+		VideoScaler				identityScaler(test.srcWidth, test.srcHeight, test.srcWidth, test.srcHeight, (VideoScalerFilter)filter, test.interlaced, 4);
+		std::vector<uint8_t>	source;
+		std::vector<uint8_t>	pooled((size_t)dstRowBytes * test.dstHeight, 0);
+		std::vector<uint8_t>	single((size_t)dstRowBytes * test.dstHeight, 0);
+		std::vector<uint8_t>	identity((size_t)srcRowBytes * test.srcHeight, 0);
+		std::vector<uint16_t>	luma(std::max(test.srcWidth, test.dstWidth));
+		std::vector<uint16_t>	cb(luma.size());
+		std::vector<uint16_t>	cr(luma.size());
+		double					maxError	= 0.0;
+		double					errorSum[3]	= {};
+		uint32_t				errorCount	= 0;
+
+		FillRandomV210(source, test.srcWidth, test.srcHeight, random);
+
+		if ((pooledScaler.ScaleV210(source.data(), srcRowBytes, pooled.data(), dstRowBytes) != S_OK) ||
+			(singleScaler.ScaleV210(source.data(), srcRowBytes, single.data(), dstRowBytes) != S_OK) ||
+			(identityScaler.ScaleV210(source.data(), srcRowBytes, identity.data(), srcRowBytes) != S_OK) ||
+			(pooled != single) || (identity != source))
+		{
+			fprintf(stderr, "Scaler filter %d %ux%u to %ux%u does not match single thread or same size scaling\n",
+					filter, test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight);
+			matched = false;
+		}
+
+		for (uint32_t y = 0; y < test.srcHeight; y++)
+		{
+			for (uint32_t x = 0; x < test.srcWidth; x++)
+				luma[x] = (uint16_t)lround(100 + x * slopeX);
+			for (uint32_t x = 0; x < (test.srcWidth + 1) / 2; x++)
+			{
+				cb[x] = (uint16_t)lround(100 + x * 2 * slopeX);
+				cr[x] = (uint16_t)lround(100 + y * slopeY);
+			}
+
+			PackV210Row(luma.data(), cb.data(), cr.data(), source.data() + (size_t)y * srcRowBytes, test.srcWidth);
+		}
+
+		pooledScaler.ScaleV210(source.data(), srcRowBytes, pooled.data(), dstRowBytes);
+
+		for (uint32_t y = 0; y < test.dstHeight; y++)
+		{
+			double srcY = (y + 0.5) * scaleY - 0.5;
+
+			UnpackV210Row(pooled.data() + (size_t)y * dstRowBytes, luma.data(), cb.data(), cr.data(), test.dstWidth);
+
+			for (uint32_t x = 0; x < test.dstWidth; x++)
+			{
+				double srcX = (x + 0.5) * scaleX - 0.5;
+
+				if ((srcX < marginX) || (srcX > test.srcWidth - 1 - marginX))
+					continue;
+
+				if (((x & 1) != 0) || (srcY < marginY) || (srcY > test.srcHeight - 1 - marginY))
+					continue;
+
+				// Chroma is co-sited with even luma samples
+				double expected[3]	= { 100 + srcX * slopeX, 100 + srcX * slopeX, 100 + srcY * slopeY };
+				double sample[3]	= { (double)luma[x], (double)cb[x / 2], (double)cr[x / 2] };
+
+				for (int plane = 0; plane < 3; plane++)
+				{
+					maxError		= std::max(maxError, fabs(sample[plane] - expected[plane]));
+					errorSum[plane]	+= sample[plane] - round(expected[plane]);
+				}
+				errorCount++;
+			}
+		}
+
+		for (int plane = 0; plane < 3; plane++)
+		{
+			if ((maxError > 1.25) || ((errorCount > 0) && (fabs(errorSum[plane] / errorCount) > 0.25)))
+			{
+				fprintf(stderr, "Scaler filter %d %ux%u to %ux%u plane %d ramp error maximum %.2f, mean %.2f codes\n",
+						filter, test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight, plane, maxError, errorSum[plane] / errorCount);
+				matched = false;
+				break;
+			}
+		}
+	}
+
+	return matched;
+}
+
+static void BenchmarkScaler(int iterations, unsigned threadCount, std::mt19937& random)
+{
+	for (const ScalerTest& test : kScalerTests)
+	{
+		if (test.srcWidth < 720)
+			continue;
+
+		VideoScaler				scaler(test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight, kVideoScalerLanczos3, test.interlaced, threadCount);
+		VideoScaler				singleScaler(test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight, kVideoScalerLanczos3, test.interlaced, 1);
+		std::vector<uint8_t>	source;
+		std::vector<uint8_t>	destination((size_t)V210RowBytes(test.dstWidth) * test.dstHeight, 0);
+		double					frameTime[2];
+
+		FillRandomV210(source, test.srcWidth, test.srcHeight, random);
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			VideoScaler& passScaler = (pass == 0) ? scaler : singleScaler;
+
+			passScaler.ScaleV210(source.data(), V210RowBytes(test.srcWidth), destination.data(), V210RowBytes(test.dstWidth));
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < iterations; i++)
+				passScaler.ScaleV210(source.data(), V210RowBytes(test.srcWidth), destination.data(), V210RowBytes(test.dstWidth));
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			frameTime[pass] = elapsed.count() * 1000.0 / iterations;
+		}
+
+		printf("  %4ux%-4u -> %4ux%-4u%s %6.2f ms/frame with %u threads, %6.2f ms/frame with 1 thread\n",
+			   test.srcWidth, test.srcHeight, test.dstWidth, test.dstHeight, test.interlaced ? " interlaced" : "           ",
+			   frameTime[0], scaler.GetThreadCount(), frameTime[1]);
+	}
+}
+
+struct DeinterlacerTest
+{
+	uint32_t		width;
+	uint32_t		height;
+	BMDPixelFormat	pixelFormat;
+};
+
+// NTSC and HD interlaced frames, and small frames for the edges of the fields and the kernel
+static const DeinterlacerTest kDeinterlacerTests[] =
+{
+	{ 1920, 1080, bmdFormat10BitYUV },
+	{ 720, 486, bmdFormat8BitYUV },
+	{ 97, 31, bmdFormat10BitYUV },
+	{ 7, 5, bmdFormat8BitYUV },
+	{ 33, 4, bmdFormat10BitYUV },
+};
+
+static uint32_t DeinterlacerRowBytes(const DeinterlacerTest& test)
+{
+	return (test.pixelFormat == bmdFormat10BitYUV) ? V210RowBytes(test.width) : ((test.width + 1) / 2) * 4;
+}
+
+// Frame with luma, Cb and Cr computed by sampleFunction(x, y) for each row y
+template <typename SampleFunction>
+static void FillDeinterlacerFrame(const DeinterlacerTest& test, std::vector<uint8_t>& frame, SampleFunction sampleFunction)
+{
+	uint32_t				rowBytes = DeinterlacerRowBytes(test);
+	std::vector<uint16_t>	luma(test.width);
+	std::vector<uint16_t>	cb((test.width + 1) / 2);
+	std::vector<uint16_t>	cr((test.width + 1) / 2);
+
+	frame.assign((size_t)rowBytes * test.height, 0);
+
+	for (uint32_t y = 0; y < test.height; y++)
+	{
+		for (uint32_t x = 0; x < test.width; x++)
+			luma[x] = sampleFunction(x, y);
+		for (uint32_t x = 0; x < (test.width + 1) / 2; x++)
+			cb[x] = cr[x] = sampleFunction(x * 2, y);
+
+		if (test.pixelFormat == bmdFormat10BitYUV)
+			PackV210Row(luma.data(), cb.data(), cr.data(), frame.data() + (size_t)y * rowBytes, test.width);
+		else
+			Pack2vuyRow(luma.data(), cb.data(), cr.data(), frame.data() + (size_t)y * rowBytes, test.width);
+	}
+}
+
+// Deinterlacing random video with the worker pool must match a single thread, for both field dominances.
+// Static video with samples increasing down the frame has no vertical detail to interpolate, so it must be
+// unchanged.  Fields of different flat levels in each of the previous, current and next frames are moving
+// video, where each output frame must have the level of its field, without the other field woven into it.
+static bool VerifyDeinterlacer(const DeinterlacerTest& test, std::mt19937& random)
+{
+	static const uint16_t kFieldLevels[6] = { 200, 400, 600, 800, 300, 500 };
+
+	uint32_t	rowBytes	= DeinterlacerRowBytes(test);
+	bool		matched		= true;
+
+	for (BMDFieldDominance fieldDominance : { bmdUpperFieldFirst, bmdLowerFieldFirst })
+	{
+		Deinterlacer			pooledDeinterlacer(test.width, test.height, test.pixelFormat, fieldDominance, kDeinterlacerDoubleRate, 4);
+		Deinterlacer			singleDeinterlacer(test.width, test.height, test.pixelFormat, fieldDominance, kDeinterlacerDoubleRate, 1);
+		uint32_t				firstFieldParity = (fieldDominance == bmdLowerFieldFirst) ? 1 : 0;
+		std::vector<uint8_t>	inputFrames[3];
+		std::vector<uint8_t>	pooled((size_t)rowBytes * test.height, 0);
+		std::vector<uint8_t>	single((size_t)rowBytes * test.height, 0);
+		std::vector<uint8_t>	expected;
+
+		for (std::vector<uint8_t>& inputFrame : inputFrames)
+			FillDeinterlacerFrame(test, inputFrame, [&](uint32_t, uint32_t) { return (uint16_t)(64 + random() % 877); });
+
+		for (uint32_t outputIndex = 0; outputIndex < 2; outputIndex++)
+		{
+			if ((pooledDeinterlacer.DeinterlaceFrame(inputFrames[0].data(), inputFrames[1].data(), inputFrames[2].data(), rowBytes, outputIndex, pooled.data(), rowBytes) != S_OK) ||
+				(singleDeinterlacer.DeinterlaceFrame(inputFrames[0].data(), inputFrames[1].data(), inputFrames[2].data(), rowBytes, outputIndex, single.data(), rowBytes) != S_OK) ||
+				(pooled != single))
+			{
+				fprintf(stderr, "Deinterlacer %ux%u field dominance %d output %u does not match single thread\n",
+						test.width, test.height, fieldDominance == bmdLowerFieldFirst, outputIndex);
+				matched = false;
+			}
+		}
+
+		FillDeinterlacerFrame(test, expected, [&](uint32_t x, uint32_t y) { return (uint16_t)(64 + (x + y) * 800 / (test.width + test.height)); });
+
+		for (uint32_t outputIndex = 0; outputIndex < 2; outputIndex++)
+		{
+			pooledDeinterlacer.DeinterlaceFrame(NULL, expected.data(), NULL, rowBytes, outputIndex, pooled.data(), rowBytes);
+
+			if (pooled != expected)
+			{
+				fprintf(stderr, "Deinterlacer %ux%u field dominance %d output %u does not leave static video unchanged\n",
+						test.width, test.height, fieldDominance == bmdLowerFieldFirst, outputIndex);
+				matched = false;
+			}
+		}
+
+		for (uint32_t frame = 0; frame < 3; frame++)
+		{
+			FillDeinterlacerFrame(test, inputFrames[frame], [&](uint32_t, uint32_t y)
+			{
+				return kFieldLevels[frame * 2 + (((y & 1) == firstFieldParity) ? 0 : 1)];
+			});
+		}
+
+		for (uint32_t outputIndex = 0; outputIndex < 2; outputIndex++)
+		{
+			pooledDeinterlacer.DeinterlaceFrame(inputFrames[0].data(), inputFrames[1].data(), inputFrames[2].data(), rowBytes, outputIndex, pooled.data(), rowBytes);
+			FillDeinterlacerFrame(test, expected, [&](uint32_t, uint32_t) { return kFieldLevels[2 + outputIndex]; });
+
+			if (pooled != expected)
+			{
+				fprintf(stderr, "Deinterlacer %ux%u field dominance %d output %u weaves moving fields\n",
+						test.width, test.height, fieldDominance == bmdLowerFieldFirst, outputIndex);
+				matched = false;
+			}
+		}
+	}
+
+	return matched;
+}
+
+static void BenchmarkDeinterlacer(int iterations, unsigned threadCount, std::mt19937& random)
+{
+	for (const DeinterlacerTest& test : kDeinterlacerTests)
+	{
+		if (test.width < 720)
+			continue;
+
+		Deinterlacer			deinterlacer(test.width, test.height, test.pixelFormat, bmdUpperFieldFirst, kDeinterlacerDoubleRate, threadCount);
+		Deinterlacer			singleDeinterlacer(test.width, test.height, test.pixelFormat, bmdUpperFieldFirst, kDeinterlacerDoubleRate, 1);
+		uint32_t				rowBytes = DeinterlacerRowBytes(test);
+		std::vector<uint8_t>	inputFrames[3];
+		std::vector<uint8_t>	destination((size_t)rowBytes * test.height, 0);
+		double					fieldTime[2];
+
+		for (std::vector<uint8_t>& inputFrame : inputFrames)
+			FillDeinterlacerFrame(test, inputFrame, [&](uint32_t, uint32_t) { return (uint16_t)(64 + random() % 877); });
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			Deinterlacer& passDeinterlacer = (pass == 0) ? deinterlacer : singleDeinterlacer;
+
+			passDeinterlacer.DeinterlaceFrame(inputFrames[0].data(), inputFrames[1].data(), inputFrames[2].data(), rowBytes, 0, destination.data(), rowBytes);
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < iterations; i++)
+			{
+				for (uint32_t outputIndex = 0; outputIndex < 2; outputIndex++)
+					passDeinterlacer.DeinterlaceFrame(inputFrames[0].data(), inputFrames[1].data(), inputFrames[2].data(), rowBytes, outputIndex, destination.data(), rowBytes);
+			}
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			fieldTime[pass] = elapsed.count() * 1000.0 / (iterations * 2);
+		}
+
+		printf("  %4ux%-4u %s %6.2f ms/field with %u threads, %6.2f ms/field with 1 thread\n",
+			   test.width, test.height, (test.pixelFormat == bmdFormat10BitYUV) ? "v210" : "2vuy",
+			   fieldTime[0], deinterlacer.GetThreadCount(), fieldTime[1]);
+	}
+}
+
+// v210 frame of grey, or random video if lumaFunction returns values beyond 10 bits
+template <typename LumaFunction>
+static void FillToneMapperFrame(uint32_t width, uint32_t height, std::vector<uint8_t>& frame, LumaFunction lumaFunction)
+{
+	std::vector<uint16_t>	luma(width);
+	std::vector<uint16_t>	cb((width + 1) / 2, 512);
+	std::vector<uint16_t>	cr((width + 1) / 2, 512);
+
+	frame.assign((size_t)V210RowBytes(width) * height, 0);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+			luma[x] = lumaFunction(x, y);
+
+		PackV210Row(luma.data(), cb.data(), cr.data(), frame.data() + (size_t)y * V210RowBytes(width), width);
+	}
+}
+
+// A 3D table of the identity must return its input, within the rounding of the grid points.  Tone mapping
+// with the worker pool must match a single thread, and the tables must be rebuilt only when the metadata
+// changes.  PQ at HDR reference white (203 cd/m2) maps to 75% HLG, and grey ramps stay grey and increasing
+// when mapped to SDR.
+static bool VerifyToneMapper(std::mt19937& random)
+{
+	static const uint32_t	kWidth			= 97;
+	static const uint32_t	kHeight			= 9;
+	static const uint32_t	kGridMax		= kLUT3DTestSize - 1;
+
+	std::vector<uint16_t>	identity((size_t)kLUT3DTestSize * kLUT3DTestSize * kLUT3DTestSize * 4);
+	std::vector<uint16_t>	rgb[3];
+	std::vector<uint16_t>	mapped[3];
+	LUT3D					identityLUT		= { kLUT3DTestSize, identity.data() };
+	uint32_t				rowBytes		= V210RowBytes(kWidth);
+	std::vector<uint8_t>	source;
+	std::vector<uint8_t>	pooled((size_t)rowBytes * kHeight, 0);
+	std::vector<uint8_t>	single((size_t)rowBytes * kHeight, 0);
+	std::vector<uint16_t>	luma(kWidth);
+	std::vector<uint16_t>	cb((kWidth + 1) / 2);
+	std::vector<uint16_t>	cr((kWidth + 1) / 2);
+	ToneMapMetadata			metadata		= { kTransferPQ, 1000.0, 0.005, 1000.0, 400.0 };
+	int						maxLUTError		= 0;
+	bool					verified		= true;
+
+	for (uint32_t i = 0; i < kLUT3DTestSize * kLUT3DTestSize * kLUT3DTestSize; i++)
+	{
+		uint32_t gridPoint[3] = { i % kLUT3DTestSize, (i / kLUT3DTestSize) % kLUT3DTestSize, i / (kLUT3DTestSize * kLUT3DTestSize) };
+
+		for (int c = 0; c < 3; c++)
+			identity[i * 4 + c] = (uint16_t)((gridPoint[c] * 65535 + kGridMax / 2) / kGridMax);
+		identity[i * 4 + 3] = 0;
+	}
+
+	for (int c = 0; c < 3; c++)
+	{
+		rgb[c].resize(10000);
+		mapped[c].resize(10000);
+		for (uint16_t& sample : rgb[c])
+			sample = random() & 0xFFFF;
+	}
+
+	ApplyLUT3DRow(rgb[0].data(), rgb[1].data(), rgb[2].data(), mapped[0].data(), mapped[1].data(), mapped[2].data(), 10000, identityLUT);
+
+	for (int c = 0; c < 3; c++)
+	{
+		for (size_t i = 0; i < rgb[c].size(); i++)
+			maxLUTError = std::max(maxLUTError, abs((int)mapped[c][i] - (int)rgb[c][i]));
+	}
+
+	if (maxLUTError > 2)
+	{
+		fprintf(stderr, "3D LUT of the identity has maximum error %d\n", maxLUTError);
+		verified = false;
+	}
+
+	for (TransferFunction output : { kTransferHLG, kTransferSDR })
+	{
+		ToneMapper pooledToneMapper(kWidth, kHeight, output, 4);
+		ToneMapper singleToneMapper(kWidth, kHeight, output, 1);
+
+		FillToneMapperFrame(kWidth, kHeight, source, [&](uint32_t, uint32_t) { return (uint16_t)(64 + random() % 877); });
+
+		pooledToneMapper.ToneMapV210(metadata, source.data(), rowBytes, pooled.data(), rowBytes);
+		singleToneMapper.ToneMapV210(metadata, source.data(), rowBytes, single.data(), rowBytes);
+		pooledToneMapper.ToneMapV210(metadata, source.data(), rowBytes, pooled.data(), rowBytes);
+
+		if ((pooled != single) || (pooledToneMapper.GetLUTBuildCount() != 1))
+		{
+			fprintf(stderr, "Tone mapper to %s does not match single thread or rebuilt its tables for the same metadata\n",
+					(output == kTransferHLG) ? "HLG" : "SDR");
+			verified = false;
+		}
+
+		ToneMapMetadata brighterMetadata = metadata;
+		brighterMetadata.maxContentLightLevel = 4000.0;
+
+		pooledToneMapper.ToneMapV210(brighterMetadata, source.data(), rowBytes, pooled.data(), rowBytes);
+
+		if (pooledToneMapper.GetLUTBuildCount() != 2)
+		{
+			fprintf(stderr, "Tone mapper to %s did not rebuild its tables when MaxCLL changed\n", (output == kTransferHLG) ? "HLG" : "SDR");
+			verified = false;
+		}
+	}
+
+	// PQ code of 203 cd/m2 is 0.5806, 75% HLG is luma code 721
+	{
+		ToneMapper toneMapper(kWidth, kHeight, kTransferHLG, 1);
+
+		FillToneMapperFrame(kWidth, kHeight, source, [](uint32_t, uint32_t) { return (uint16_t)573; });
+		toneMapper.ToneMapV210(metadata, source.data(), rowBytes, pooled.data(), rowBytes);
+		UnpackV210Row(pooled.data(), luma.data(), cb.data(), cr.data(), kWidth);
+
+		if ((abs((int)luma[0] - 721) > 6) || (abs((int)cb[0] - 512) > 2) || (abs((int)cr[0] - 512) > 2))
+		{
+			fprintf(stderr, "Tone mapper maps PQ reference white to HLG luma %u, Cb %u, Cr %u\n", luma[0], cb[0], cr[0]);
+			verified = false;
+		}
+	}
+
+	for (TransferFunction input : { kTransferPQ, kTransferHLG })
+	{
+		// Each row is a ramp over a ninth of the luma codes, each output pixel must be grey and no darker than the previous
+		ToneMapper		toneMapper(kWidth, kHeight, kTransferSDR, 1);
+		ToneMapMetadata	inputMetadata		= metadata;
+		uint16_t		previousLuma		= 0;
+
+		inputMetadata.transferFunction = input;
+
+		FillToneMapperFrame(kWidth, kHeight, source, [](uint32_t x, uint32_t y) { return (uint16_t)(64 + (y * kWidth + x) * 876 / (kWidth * kHeight - 1)); });
+		toneMapper.ToneMapV210(inputMetadata, source.data(), rowBytes, pooled.data(), rowBytes);
+
+		for (uint32_t y = 0; y < kHeight; y++)
+		{
+			UnpackV210Row(pooled.data() + (size_t)y * rowBytes, luma.data(), cb.data(), cr.data(), kWidth);
+
+			for (uint32_t x = 0; x < kWidth; x++)
+			{
+				if ((luma[x] < previousLuma) || (abs((int)cb[x / 2] - 512) > 2) || (abs((int)cr[x / 2] - 512) > 2))
+				{
+					fprintf(stderr, "Tone mapper from %s to SDR maps grey to luma %u, Cb %u, Cr %u after luma %u\n",
+							(input == kTransferPQ) ? "PQ" : "HLG", luma[x], cb[x / 2], cr[x / 2], previousLuma);
+					verified = false;
+					break;
+				}
+
+				previousLuma = luma[x];
+			}
+		}
+	}
+
+	return verified;
+}
+
+static void BenchmarkToneMapper(int iterations, unsigned threadCount, std::mt19937& random)
+{
+	ToneMapMetadata metadata = { kTransferPQ, 1000.0, 0.005, 1000.0, 400.0 };
+
+	for (auto& frameSize : std::vector<std::pair<uint32_t, uint32_t>>{ { 1920, 1080 }, { 3840, 2160 } })
+	{
+		ToneMapper				toneMapper(frameSize.first, frameSize.second, kTransferSDR, threadCount);
+		ToneMapper				singleToneMapper(frameSize.first, frameSize.second, kTransferSDR, 1);
+		uint32_t				rowBytes = V210RowBytes(frameSize.first);
+		std::vector<uint8_t>	source;
+		std::vector<uint8_t>	destination((size_t)rowBytes * frameSize.second, 0);
+		double					frameTime[2];
+
+		FillToneMapperFrame(frameSize.first, frameSize.second, source, [&](uint32_t, uint32_t) { return (uint16_t)(64 + random() % 877); });
+
+		for (int pass = 0; pass < 2; pass++)
+		{
+			ToneMapper& passToneMapper = (pass == 0) ? toneMapper : singleToneMapper;
+
+			passToneMapper.ToneMapV210(metadata, source.data(), rowBytes, destination.data(), rowBytes);
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < iterations; i++)
+				passToneMapper.ToneMapV210(metadata, source.data(), rowBytes, destination.data(), rowBytes);
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			frameTime[pass] = elapsed.count() * 1000.0 / iterations;
+		}
+
+		printf("  %4ux%-4u PQ -> SDR %6.2f ms/frame with %u threads, %6.2f ms/frame with 1 thread\n",
+			   frameSize.first, frameSize.second, frameTime[0], toneMapper.GetThreadCount(), frameTime[1]);
+	}
+}
+
+// Minimal frame in system memory for the software video conversion
+class BenchmarkVideoFrame : public IDeckLinkVideoFrame
+{
+public:
+	BenchmarkVideoFrame(long width, long height, BMDPixelFormat pixelFormat) :
+		m_width(width),
+		m_height(height),
+		m_rowBytes(GetPixelFormatRowBytes(pixelFormat, width)),
+		m_pixelFormat(pixelFormat),
+		m_buffer((size_t)m_rowBytes * height, 0)
+	{
+	}
+
+	std::vector<uint8_t>&	Buffer(void)	{ return m_buffer; }
+
+	// IDeckLinkVideoFrame interface
+	virtual long			STDMETHODCALLTYPE	GetWidth(void)			{ return m_width; }
+	virtual long			STDMETHODCALLTYPE	GetHeight(void)			{ return m_height; }
+	virtual long			STDMETHODCALLTYPE	GetRowBytes(void)		{ return m_rowBytes; }
+	virtual BMDPixelFormat	STDMETHODCALLTYPE	GetPixelFormat(void)	{ return m_pixelFormat; }
+	virtual BMDFrameFlags	STDMETHODCALLTYPE	GetFlags(void)			{ return bmdFrameFlagDefault; }
+	virtual HRESULT			STDMETHODCALLTYPE	GetBytes(void** buffer)	{ *buffer = m_buffer.data(); return S_OK; }
+
+	// Dummy implementations of remaining methods in IDeckLinkVideoFrame
+	virtual HRESULT			STDMETHODCALLTYPE	GetAncillaryData(IDeckLinkVideoFrameAncillary** ancillary) { return E_NOTIMPL; }
+	virtual HRESULT			STDMETHODCALLTYPE	GetTimecode(BMDTimecodeFormat format, IDeckLinkTimecode** timecode) { return E_NOTIMPL; }
+
+	// IUnknown interface, frames are owned by the benchmark
+	virtual HRESULT			STDMETHODCALLTYPE	QueryInterface(REFIID iid, LPVOID *ppv) { *ppv = NULL; return E_NOINTERFACE; }
+	virtual ULONG			STDMETHODCALLTYPE	AddRef(void)	{ return 1; }
+	virtual ULONG			STDMETHODCALLTYPE	Release(void)	{ return 1; }
+
+private:
+	long					m_width;
+	long					m_height;
+	long					m_rowBytes;
+	BMDPixelFormat			m_pixelFormat;
+	std::vector<uint8_t>	m_buffer;
+};
+
+static const struct
+{
+	BMDPixelFormat	pixelFormat;
+	const char*		name;
+	bool			isRGB;
+	bool			hasAlpha;
+	int				bitDepth;
+}
+kConversionFormats[] =
+{
+	{ bmdFormat8BitYUV,		"2vuy",	false,	false,	8 },
+	{ bmdFormat10BitYUV,	"v210",	false,	false,	10 },
+	{ bmdFormat10BitYUVA,	"Ay10",	false,	true,	10 },
+	{ bmdFormat8BitARGB,	"ARGB",	true,	true,	8 },
+	{ bmdFormat8BitBGRA,	"BGRA",	true,	true,	8 },
+	{ bmdFormat10BitRGB,	"r210",	true,	false,	10 },
+	{ bmdFormat12BitRGB,	"R12B",	true,	false,	12 },
+	{ bmdFormat12BitRGBLE,	"R12L",	true,	false,	12 },
+	{ bmdFormat10BitRGBXLE,	"R10l",	true,	false,	10 },
+	{ bmdFormat10BitRGBX,	"R10b",	true,	false,	10 },
+};
+
+static const int kConversionFormatCount = sizeof(kConversionFormats) / sizeof(kConversionFormats[0]);
+
+// Convert the frame of random bytes to and from each other format.  When the intermediate format has the
+// same colour model the frame must be unchanged by a second round trip, and by the first round trip when
+// the intermediate format also has at least the same bit depth and alpha.
+// Sliced conversion by the thread pool with the default kernels must match conversion by the calling
+// thread alone with the scalar kernels.
+static bool VerifyConversions(uint32_t width, uint32_t height, std::mt19937& random)
+{
+	VideoKernelsISA				defaultISA			= GetVideoKernelsISA();
+	IDeckLinkVideoConversion*	pooledConversion	= CreateSoftwareVideoConversionInstance(4);
+	IDeckLinkVideoConversion*	singleConversion	= CreateSoftwareVideoConversionInstance(1);
+	bool						matched				= true;
+
+	for (int src = 0; src < kConversionFormatCount; src++)
+	{
+		BenchmarkVideoFrame randomFrame(width, height, kConversionFormats[src].pixelFormat);
+		BenchmarkVideoFrame sourceFrame(width, height, kConversionFormats[src].pixelFormat);
+
+		for (uint8_t& byte : randomFrame.Buffer())
+			byte = random() & 0xFF;
+
+		// Normalise random bytes, such as unused bits, through the widest other format of the same colour model
+		BMDPixelFormat		normalizeFormat = kConversionFormats[src].isRGB ? bmdFormat12BitRGBLE : bmdFormat10BitYUVA;
+		if (normalizeFormat == kConversionFormats[src].pixelFormat)
+			normalizeFormat = bmdFormat12BitRGB;
+
+		BenchmarkVideoFrame	normalizeFrame(width, height, normalizeFormat);
+		pooledConversion->ConvertFrame(&randomFrame, &normalizeFrame);
+		pooledConversion->ConvertFrame(&normalizeFrame, &sourceFrame);
+
+		for (int dst = 0; dst < kConversionFormatCount; dst++)
+		{
+			BenchmarkVideoFrame	pooledFrame(width, height, kConversionFormats[dst].pixelFormat);
+			BenchmarkVideoFrame	singleFrame(width, height, kConversionFormats[dst].pixelFormat);
+			BenchmarkVideoFrame	returnFrame(width, height, kConversionFormats[src].pixelFormat);
+			BenchmarkVideoFrame	secondFrame(width, height, kConversionFormats[src].pixelFormat);
+			bool				sameModel	= (kConversionFormats[src].isRGB == kConversionFormats[dst].isRGB);
+			bool				lossless	= sameModel && (kConversionFormats[src].bitDepth <= kConversionFormats[dst].bitDepth) &&
+											  (kConversionFormats[dst].hasAlpha || !kConversionFormats[src].hasAlpha);
+			const char*			failure		= NULL;
+
+			HRESULT				pooledResult	= pooledConversion->ConvertFrame(&sourceFrame, &pooledFrame);
+			HRESULT				singleResult;
+
+			SetVideoKernelsISA(kVideoKernelsISAScalar);
+			singleResult = singleConversion->ConvertFrame(&sourceFrame, &singleFrame);
+			SetVideoKernelsISA(defaultISA);
+
+			if ((pooledResult != S_OK) || (singleResult != S_OK))
+				failure = "failed";
+			else if (pooledFrame.Buffer() != singleFrame.Buffer())
+				failure = "pooled conversion does not match single thread scalar conversion";
+			else if (pooledConversion->ConvertFrame(&pooledFrame, &returnFrame) != S_OK)
+				failure = "return conversion failed";
+			else if (lossless && (returnFrame.Buffer() != sourceFrame.Buffer()))
+				failure = "round trip is not lossless";
+			else if (sameModel && ((pooledConversion->ConvertFrame(&returnFrame, &pooledFrame) != S_OK) ||
+					 (pooledConversion->ConvertFrame(&pooledFrame, &secondFrame) != S_OK) ||
+					 (secondFrame.Buffer() != returnFrame.Buffer())))
+				failure = "round trip is not stable";
+
+			if (failure != NULL)
+			{
+				fprintf(stderr, "%s -> %s %s for %ux%u\n", kConversionFormats[src].name, kConversionFormats[dst].name, failure, width, height);
+				matched = false;
+			}
+		}
+	}
+
+	pooledConversion->Release();
+	singleConversion->Release();
+
+	return matched;
+}
+
+static void BenchmarkConversions(uint32_t width, uint32_t height, int iterations, unsigned threadCount, std::mt19937& random)
+{
+	IDeckLinkVideoConversion* conversion = CreateSoftwareVideoConversionInstance(threadCount);
+
+	for (int src = 0; src < kConversionFormatCount; src++)
+	{
+		BenchmarkVideoFrame sourceFrame(width, height, kConversionFormats[src].pixelFormat);
+
+		for (uint8_t& byte : sourceFrame.Buffer())
+			byte = random() & 0xFF;
+
+		printf("  %s ->", kConversionFormats[src].name);
+
+		for (int dst = 0; dst < kConversionFormatCount; dst++)
+		{
+			BenchmarkVideoFrame destinationFrame(width, height, kConversionFormats[dst].pixelFormat);
+
+			conversion->ConvertFrame(&sourceFrame, &destinationFrame);
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < iterations; i++)
+				conversion->ConvertFrame(&sourceFrame, &destinationFrame);
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			printf(" %s %5.1f", kConversionFormats[dst].name, elapsed.count() * 1000.0 / iterations);
+		}
+
+		printf("  ms/frame\n");
+	}
+
+	conversion->Release();
+}
+
+// .cube text of a table whose output is its input over the domain 0 to domainMax, clipped to 1, with red and
+// blue optionally swapped
+static std::string MakeCubeText(uint32_t size, float domainMax, bool swapRedBlue)
+{
+	std::ostringstream text;
+
+	text << "# Test table\nTITLE \"Test " << size << "\"\nLUT_3D_SIZE " << size << "\n";
+	text << "DOMAIN_MIN 0 0 0\nDOMAIN_MAX " << domainMax << " " << domainMax << " " << domainMax << "\n";
+	text.precision(9);
+
+	for (uint32_t b = 0; b < size; b++)
+	{
+		for (uint32_t g = 0; g < size; g++)
+		{
+			for (uint32_t r = 0; r < size; r++)
+			{
+				double	scale	= domainMax / (size - 1);
+				double	red		= std::min(r * scale, 1.0);
+				double	green	= std::min(g * scale, 1.0);
+				double	blue	= std::min(b * scale, 1.0);
+
+				if (swapRedBlue)
+					std::swap(red, blue);
+
+				text << red << " " << green << " " << blue << "\n";
+			}
+		}
+	}
+
+	return text.str();
+}
+
+// Fill a frame with random legal video through the row codecs: RGB within black to white, YUV with random luma
+// and chroma within the RGB gamut, constant along each row so that 4:2:2 chroma survives the conversion to RGB
+// and back
+static void FillLUTProcessorFrame(BenchmarkVideoFrame& frame, BMDPixelFormat pixelFormat, std::mt19937& random)
+{
+	uint32_t						width	= (uint32_t)frame.GetWidth();
+	uint32_t						height	= (uint32_t)frame.GetHeight();
+	VideoConversion::RowPlanes		planes;
+
+	planes.luma.resize(width);
+	planes.cb.resize((width + 1) / 2);
+	planes.cr.resize((width + 1) / 2);
+	planes.red.resize(width);
+	planes.green.resize(width);
+	planes.blue.resize(width);
+	planes.alpha.resize(width);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		uint16_t cb = (uint16_t)(472 + random() % 81);
+		uint16_t cr = (uint16_t)(472 + random() % 81);
+
+		for (uint32_t x = 0; x < width; x++)
+		{
+			planes.luma[x]	= (uint16_t)(200 + random() % 601);
+			planes.red[x]	= (uint16_t)(4096 + random() % 56065);
+			planes.green[x]	= (uint16_t)(4096 + random() % 56065);
+			planes.blue[x]	= (uint16_t)(4096 + random() % 56065);
+			planes.alpha[x]	= (uint16_t)random();
+		}
+		std::fill(planes.cb.begin(), planes.cb.end(), cb);
+		std::fill(planes.cr.begin(), planes.cr.end(), cr);
+
+		EncodePixelFormatRow(pixelFormat, planes, frame.Buffer().data() + (size_t)y * frame.GetRowBytes(), width);
+	}
+}
+
+// Tables of 17, 33 and 65 points whose output is their input, over the domain 0 to 1 and the wider domain 0 to
+// 2 which is mapped by the shaper, must return legal video of each pixel format within one code.  A table that
+// swaps red and blue must swap the planes of RGB formats.  Alpha must be preserved, and processing with the
+// worker pool must match a single thread.
+static bool VerifyLUTProcessor(std::mt19937& random)
+{
+	static const uint32_t	kWidth		= 98;		// Even, Ay10 has no Cr for the last pixel of an odd width
+	static const uint32_t	kHeight		= 9;
+
+	static const struct
+	{
+		uint32_t	size;
+		float		domainMax;
+		bool		swapRedBlue;
+	}
+	kLUTTests[] =
+	{
+		{ 17, 1.0f, false },
+		{ 33, 1.0f, false },
+		{ 65, 1.0f, false },
+		{ 17, 2.0f, false },
+		{ 33, 1.0f, true },
+	};
+
+	bool verified = true;
+
+	for (auto& test : kLUTTests)
+	{
+		CubeLUT				lut;
+		std::istringstream	text(MakeCubeText(test.size, test.domainMax, test.swapRedBlue));
+		LUTProcessor		pooledProcessor(kWidth, kHeight, 4);
+		LUTProcessor		singleProcessor(kWidth, kHeight, 1);
+
+		if ((lut.Load(text, "test") != S_OK) || (lut.GetSize() != test.size) ||
+			(pooledProcessor.SetLUT(lut) != S_OK) || (singleProcessor.SetLUT(lut) != S_OK))
+		{
+			fprintf(stderr, "Unable to load %u point table\n", test.size);
+			verified = false;
+			continue;
+		}
+
+		for (int format = 0; format < kConversionFormatCount; format++)
+		{
+			BMDPixelFormat				pixelFormat	= kConversionFormats[format].pixelFormat;
+			bool						isRGB		= kConversionFormats[format].isRGB;
+			// One code of the format, in the 10-bit YUV or 16-bit video level RGB planes
+			int							tolerance	= isRGB ? (1 << (16 - kConversionFormats[format].bitDepth)) : (1 << (10 - kConversionFormats[format].bitDepth));
+			BenchmarkVideoFrame			source(kWidth, kHeight, pixelFormat);
+			BenchmarkVideoFrame			pooled(kWidth, kHeight, pixelFormat);
+			BenchmarkVideoFrame			single(kWidth, kHeight, pixelFormat);
+			VideoConversion::RowPlanes	input;
+			VideoConversion::RowPlanes	output;
+			int							maxError	= 0;
+			bool						alphaKept	= true;
+
+			if (test.swapRedBlue && !isRGB)
+				continue;
+
+			FillLUTProcessorFrame(source, pixelFormat, random);
+
+			if ((pooledProcessor.ApplyLUT(pixelFormat, bmdColorspaceRec709, source.Buffer().data(), source.GetRowBytes(), pooled.Buffer().data(), pooled.GetRowBytes()) != S_OK) ||
+				(singleProcessor.ApplyLUT(pixelFormat, bmdColorspaceRec709, source.Buffer().data(), source.GetRowBytes(), single.Buffer().data(), single.GetRowBytes()) != S_OK))
+			{
+				fprintf(stderr, "%u point table failed for %s\n", test.size, kConversionFormats[format].name);
+				verified = false;
+				continue;
+			}
+
+			for (VideoConversion::RowPlanes* planes : { &input, &output })
+			{
+				planes->luma.resize(kWidth);
+				planes->cb.resize((kWidth + 1) / 2);
+				planes->cr.resize((kWidth + 1) / 2);
+				planes->red.resize(kWidth);
+				planes->green.resize(kWidth);
+				planes->blue.resize(kWidth);
+				planes->alpha.resize(kWidth);
+			}
+
+			for (uint32_t y = 0; y < kHeight; y++)
+			{
+				DecodePixelFormatRow(pixelFormat, source.Buffer().data() + (size_t)y * source.GetRowBytes(), input, kWidth);
+				DecodePixelFormatRow(pixelFormat, pooled.Buffer().data() + (size_t)y * pooled.GetRowBytes(), output, kWidth);
+
+				if (test.swapRedBlue)
+					std::swap(input.red, input.blue);
+
+				for (uint32_t x = 0; x < kWidth; x++)
+				{
+					if (isRGB)
+					{
+						maxError = std::max(maxError, abs(output.red[x] - input.red[x]));
+						maxError = std::max(maxError, abs(output.green[x] - input.green[x]));
+						maxError = std::max(maxError, abs(output.blue[x] - input.blue[x]));
+					}
+					else
+					{
+						maxError = std::max(maxError, abs(output.luma[x] - input.luma[x]));
+						if (x < (kWidth + 1) / 2)
+						{
+							maxError = std::max(maxError, abs(output.cb[x] - input.cb[x]));
+							maxError = std::max(maxError, abs(output.cr[x] - input.cr[x]));
+						}
+					}
+
+					if (kConversionFormats[format].hasAlpha && (output.alpha[x] != input.alpha[x]))
+						alphaKept = false;
+				}
+			}
+
+			if ((maxError > tolerance) || !alphaKept || (pooled.Buffer() != single.Buffer()))
+			{
+				fprintf(stderr, "%u point table%s to %g, %s: error %d, alpha %s, pooled %s single thread\n",
+						test.size, test.swapRedBlue ? " swapping red and blue" : "", test.domainMax, kConversionFormats[format].name,
+						maxError, alphaKept ? "kept" : "changed", (pooled.Buffer() == single.Buffer()) ? "matches" : "does not match");
+				verified = false;
+			}
+		}
+	}
+
+	return verified;
+}
+
+static void BenchmarkLUTProcessor(int iterations, unsigned threadCount, std::mt19937& random)
+{
+	CubeLUT				lut;
+	std::istringstream	text(MakeCubeText(33, 1.0f, false));
+
+	lut.Load(text, "benchmark");
+
+	for (auto& frameSize : std::vector<std::pair<uint32_t, uint32_t>>{ { 1920, 1080 }, { 3840, 2160 } })
+	{
+		for (BMDPixelFormat pixelFormat : { bmdFormat10BitYUV, bmdFormat12BitRGB })
+		{
+			LUTProcessor		processor(frameSize.first, frameSize.second, threadCount);
+			LUTProcessor		singleProcessor(frameSize.first, frameSize.second, 1);
+			BenchmarkVideoFrame	source(frameSize.first, frameSize.second, pixelFormat);
+			BenchmarkVideoFrame	destination(frameSize.first, frameSize.second, pixelFormat);
+			double				frameTime[2];
+
+			FillLUTProcessorFrame(source, pixelFormat, random);
+			processor.SetLUT(lut);
+			singleProcessor.SetLUT(lut);
+
+			for (int pass = 0; pass < 2; pass++)
+			{
+				LUTProcessor& passProcessor = (pass == 0) ? processor : singleProcessor;
+
+				passProcessor.ApplyLUT(pixelFormat, bmdColorspaceRec709, source.Buffer().data(), source.GetRowBytes(), destination.Buffer().data(), destination.GetRowBytes());
+
+				auto start = std::chrono::steady_clock::now();
+
+				for (int i = 0; i < iterations; i++)
+					passProcessor.ApplyLUT(pixelFormat, bmdColorspaceRec709, source.Buffer().data(), source.GetRowBytes(), destination.Buffer().data(), destination.GetRowBytes());
+
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				frameTime[pass] = elapsed.count() * 1000.0 / iterations;
+			}
+
+			printf("  %4ux%-4u %s %6.2f ms/frame with %u threads, %6.2f ms/frame with 1 thread\n",
+				   frameSize.first, frameSize.second, (pixelFormat == bmdFormat10BitYUV) ? "v210" : "R12B",
+				   frameTime[0], processor.GetThreadCount(), frameTime[1]);
+		}
+	}
+}
+
+static const char* kStereo3DLayoutNames[] = { "side-by-side", "top-bottom", "frame packed" };
+
+// Pixels of a filtered edge, which is extended by repeating the edge sample
+static const uint32_t kStereo3DEdgeMargin = 12;
+
+static void ResizeRowPlanes(VideoConversion::RowPlanes& planes, uint32_t width)
+{
+	planes.luma.resize(width);
+	planes.cb.resize((width + 1) / 2);
+	planes.cr.resize((width + 1) / 2);
+	planes.red.resize(width);
+	planes.green.resize(width);
+	planes.blue.resize(width);
+	planes.alpha.resize(width);
+}
+
+// Fill an eye frame with a pattern around a level from -1 to 1, that varies slowly enough across and down the
+// frame to pass through the half-band filters, or a flat field if the amplitude is 0
+static void FillStereo3DFrame(BenchmarkVideoFrame& frame, BMDPixelFormat pixelFormat, double level, double amplitude, double phase)
+{
+	uint32_t					width	= (uint32_t)frame.GetWidth();
+	uint32_t					height	= (uint32_t)frame.GetHeight();
+	VideoConversion::RowPlanes	planes;
+
+	ResizeRowPlanes(planes, width);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			double value = level + amplitude * sin(2.0 * M_PI * x / 24.0 + phase) * cos(2.0 * M_PI * y / 16.0 + phase);
+
+			planes.luma[x]	= (uint16_t)lrint(512.0 + 300.0 * value);
+			planes.red[x]	= (uint16_t)lrint(32768.0 + 20000.0 * value);
+			planes.green[x]	= (uint16_t)lrint(30000.0 - 20000.0 * value);
+			planes.blue[x]	= (uint16_t)lrint(36000.0 + 16000.0 * value);
+			planes.alpha[x]	= (uint16_t)lrint(32768.0 + 30000.0 * value);
+
+			if ((x % 2) == 0)
+			{
+				planes.cb[x / 2] = (uint16_t)lrint(512.0 + 100.0 * value);
+				planes.cr[x / 2] = (uint16_t)lrint(500.0 - 80.0 * value);
+			}
+		}
+
+		EncodePixelFormatRow(pixelFormat, planes, frame.Buffer().data() + (size_t)y * frame.GetRowBytes(), width);
+	}
+}
+
+// Largest difference between the planes of two frames of a pixel format, in 10-bit YUV or 16-bit RGB samples.
+// Filtered edges are excluded, the pixels within the margin of the edges of the frame and of the halves of the
+// packed layout.
+static int Stereo3DFrameError(BenchmarkVideoFrame& expected, BenchmarkVideoFrame& actual, BMDPixelFormat pixelFormat, bool hasAlpha, Stereo3DLayout layout)
+{
+	uint32_t					width		= (uint32_t)expected.GetWidth();
+	bool						isYUV		= IsYUVPixelFormat(pixelFormat);
+	VideoConversion::RowPlanes	a;
+	VideoConversion::RowPlanes	b;
+	int							maxError	= 0;
+
+	ResizeRowPlanes(a, width);
+	ResizeRowPlanes(b, width);
+
+	uint32_t					height		= (uint32_t)expected.GetHeight();
+	uint32_t					xMargin		= (layout == kStereo3DSideBySide) ? kStereo3DEdgeMargin : 0;
+	uint32_t					yMargin		= (layout == kStereo3DTopBottom) ? kStereo3DEdgeMargin : 0;
+
+	for (uint32_t y = yMargin; y < height - yMargin; y++)
+	{
+		DecodePixelFormatRow(pixelFormat, expected.Buffer().data() + (size_t)y * expected.GetRowBytes(), a, width);
+		DecodePixelFormatRow(pixelFormat, actual.Buffer().data() + (size_t)y * actual.GetRowBytes(), b, width);
+
+		for (uint32_t x = xMargin; x < width - xMargin; x++)
+		{
+			// Chroma of 4:2:2 formats is compared with its luma pixel
+			if ((x + xMargin >= width / 2) && (x < width / 2 + xMargin))
+				continue;
+
+			if (isYUV)
+			{
+				maxError = std::max(maxError, abs(a.luma[x] - b.luma[x]));
+				if ((x % 2) == 0)
+				{
+					maxError = std::max(maxError, abs(a.cb[x / 2] - b.cb[x / 2]));
+					maxError = std::max(maxError, abs(a.cr[x / 2] - b.cr[x / 2]));
+				}
+			}
+			else
+			{
+				maxError = std::max(maxError, abs(a.red[x] - b.red[x]));
+				maxError = std::max(maxError, abs(a.green[x] - b.green[x]));
+				maxError = std::max(maxError, abs(a.blue[x] - b.blue[x]));
+			}
+
+			// Alpha is compared on the scale of the colour planes
+			if (hasAlpha)
+				maxError = std::max(maxError, abs(a.alpha[x] - b.alpha[x]) >> (isYUV ? 6 : 0));
+		}
+	}
+
+	return maxError;
+}
+
+// Each layout of each pixel format must unpack flat fields exactly, and patterns well below the half-band cutoff
+// within 2% of their amplitude, and the rounding of the packed and unpacked frames, away from filtered edges.  Frame packed frames must unpack exactly, with black active space.  Packing with
+// the worker pool must match a single thread.
+static bool VerifyStereo3D(std::mt19937& random)
+{
+	static const uint32_t	kWidth		= 96;
+	static const uint32_t	kHeight		= 42;
+
+	bool verified = true;
+
+	for (int layout = kStereo3DSideBySide; layout <= kStereo3DFramePacked; layout++)
+	{
+		for (int format = 0; format < kConversionFormatCount; format++)
+		{
+			BMDPixelFormat		pixelFormat		= kConversionFormats[format].pixelFormat;
+			bool				isRGB			= kConversionFormats[format].isRGB;
+			Stereo3DPacker		pooledPacker(kWidth, kHeight, pixelFormat, (Stereo3DLayout)layout, 4);
+			Stereo3DPacker		singlePacker(kWidth, kHeight, pixelFormat, (Stereo3DLayout)layout, 1);
+			uint32_t			packedHeight	= pooledPacker.GetPackedHeight();
+
+			for (double amplitude : { 0.0, 1.0 })
+			{
+				BenchmarkVideoFrame	eyes[2]			= { { kWidth, kHeight, pixelFormat }, { kWidth, kHeight, pixelFormat } };
+				BenchmarkVideoFrame	unpacked[2]		= { { kWidth, kHeight, pixelFormat }, { kWidth, kHeight, pixelFormat } };
+				BenchmarkVideoFrame	pooled(kWidth, packedHeight, pixelFormat);
+				BenchmarkVideoFrame	single(kWidth, packedHeight, pixelFormat);
+				long				rowBytes		= pooled.GetRowBytes();
+				// 2% of the amplitude of the pattern and a code of the format for each of the packed and unpacked
+				// frames, or exact for flat fields and frame packing
+				int					code			= isRGB ? (1 << (16 - kConversionFormats[format].bitDepth)) : (1 << (10 - kConversionFormats[format].bitDepth));
+				int					tolerance		= 0;
+				int					maxError		= 0;
+				bool				blackKept		= true;
+
+				if ((amplitude != 0.0) && (layout != kStereo3DFramePacked))
+					tolerance = (isRGB ? 400 : 6) + code * 2;
+
+				// Flat fields are of a random level
+				for (int eye = 0; eye < 2; eye++)
+					FillStereo3DFrame(eyes[eye], pixelFormat, (amplitude == 0.0) ? (random() % 1001) / 1000.0 - 0.5 : 0.0, amplitude, eye * 0.7);
+
+				if ((pooledPacker.PackFrame(eyes[0].Buffer().data(), eyes[1].Buffer().data(), rowBytes, pooled.Buffer().data(), rowBytes) != S_OK) ||
+					(singlePacker.PackFrame(eyes[0].Buffer().data(), eyes[1].Buffer().data(), rowBytes, single.Buffer().data(), rowBytes) != S_OK) ||
+					(pooledPacker.UnpackFrame(pooled.Buffer().data(), rowBytes, unpacked[0].Buffer().data(), unpacked[1].Buffer().data(), rowBytes) != S_OK))
+				{
+					fprintf(stderr, "%s packing failed for %s\n", kStereo3DLayoutNames[layout], kConversionFormats[format].name);
+					verified = false;
+					continue;
+				}
+
+				for (int eye = 0; eye < 2; eye++)
+					maxError = std::max(maxError, Stereo3DFrameError(eyes[eye], unpacked[eye], pixelFormat, kConversionFormats[format].hasAlpha, (Stereo3DLayout)layout));
+
+				if (layout == kStereo3DFramePacked)
+				{
+					uint32_t			activeSpace = Stereo3DPacker::GetFramePackingActiveSpace(kHeight);
+
+					for (uint32_t y = kHeight; y < kHeight + activeSpace; y++)
+						blackKept &= (memcmp(pooled.Buffer().data() + (size_t)y * rowBytes, pooled.Buffer().data() + (size_t)kHeight * rowBytes, rowBytes) == 0);
+
+					if ((eyes[0].Buffer() != unpacked[0].Buffer()) || (eyes[1].Buffer() != unpacked[1].Buffer()))
+						maxError = std::max(maxError, 1);
+				}
+
+				if ((maxError > tolerance) || !blackKept || (pooled.Buffer() != single.Buffer()))
+				{
+					fprintf(stderr, "%s %s %s: error %d, %s, pooled %s single thread\n",
+							kStereo3DLayoutNames[layout], kConversionFormats[format].name, (amplitude == 0.0) ? "flat field" : "pattern",
+							maxError, blackKept ? "black active space" : "active space not black", (pooled.Buffer() == single.Buffer()) ? "matches" : "does not match");
+					verified = false;
+				}
+			}
+		}
+	}
+
+	// The active space of 1080p frame packing is 45 rows of black
+	{
+		Stereo3DPacker		packer(1920, 1080, bmdFormat10BitYUV, kStereo3DFramePacked, 1);
+		BenchmarkVideoFrame	eye(1920, 1080, bmdFormat10BitYUV);
+		BenchmarkVideoFrame	packed(1920, packer.GetPackedHeight(), bmdFormat10BitYUV);
+		uint16_t			luma[1920];
+		uint16_t			cb[960];
+		uint16_t			cr[960];
+
+		packer.PackFrame(eye.Buffer().data(), eye.Buffer().data(), eye.GetRowBytes(), packed.Buffer().data(), packed.GetRowBytes());
+		UnpackV210Row(packed.Buffer().data() + (size_t)1100 * packed.GetRowBytes(), luma, cb, cr, 1920);
+
+		if ((packer.GetPackedHeight() != 2205) || (luma[0] != 64) || (cb[0] != 512) || (cr[959] != 512))
+		{
+			fprintf(stderr, "1080p frame packing is %u rows, active space luma %u\n", packer.GetPackedHeight(), luma[0]);
+			verified = false;
+		}
+	}
+
+	return verified;
+}
+
+static void BenchmarkStereo3D(int iterations, unsigned threadCount, std::mt19937& random)
+{
+	for (int layout = kStereo3DSideBySide; layout <= kStereo3DFramePacked; layout++)
+	{
+		for (auto& frameSize : std::vector<std::pair<uint32_t, uint32_t>>{ { 1920, 1080 }, { 3840, 2160 } })
+		{
+			Stereo3DPacker		packer(frameSize.first, frameSize.second, bmdFormat10BitYUV, (Stereo3DLayout)layout, threadCount);
+			BenchmarkVideoFrame	eyes[2]		= { { frameSize.first, frameSize.second, bmdFormat10BitYUV }, { frameSize.first, frameSize.second, bmdFormat10BitYUV } };
+			BenchmarkVideoFrame	packed(frameSize.first, packer.GetPackedHeight(), bmdFormat10BitYUV);
+			long				rowBytes	= packed.GetRowBytes();
+			double				frameTime[2];
+
+			for (int eye = 0; eye < 2; eye++)
+				FillStereo3DFrame(eyes[eye], bmdFormat10BitYUV, 0.0, 1.0, eye + (random() % 8));
+
+			for (int pass = 0; pass < 2; pass++)
+			{
+				auto process = [&]()
+				{
+					if (pass == 0)
+						packer.PackFrame(eyes[0].Buffer().data(), eyes[1].Buffer().data(), rowBytes, packed.Buffer().data(), rowBytes);
+					else
+						packer.UnpackFrame(packed.Buffer().data(), rowBytes, eyes[0].Buffer().data(), eyes[1].Buffer().data(), rowBytes);
+				};
+
+				process();
+
+				auto start = std::chrono::steady_clock::now();
+
+				for (int i = 0; i < iterations; i++)
+					process();
+
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				frameTime[pass] = elapsed.count() * 1000.0 / iterations;
+			}
+
+			printf("  %4ux%-4u %-12s pack %6.2f ms/frame, unpack %6.2f ms/frame with %u threads\n",
+				   frameSize.first, frameSize.second, kStereo3DLayoutNames[layout], frameTime[0], frameTime[1], packer.GetThreadCount());
+		}
+	}
+}
+
+// Samples of bar x of colour bars of the width, at the level, with the Rec.601 matrix
+static void PatternBarSamples(uint32_t x, uint32_t width, double level, double samples[6])
+{
+	static const double	kBarComponents[8][3] = { { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 1 }, { 0, 1, 0 }, { 1, 0, 1 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, 0, 0 } };
+	const double*		rgb		= kBarComponents[((x & ~1u) * 8) / width];
+	double				scale	= (rgb == kBarComponents[0]) ? 1.0 : level;
+	double				luma	= (0.299 * rgb[0] + 0.587 * rgb[1] + 0.114 * rgb[2]) * scale;
+
+	samples[0] = 64.0 + 876.0 * luma;
+	samples[1] = 512.0 + 448.0 * (rgb[2] * scale - luma) / 0.886;
+	samples[2] = 512.0 + 448.0 * (rgb[0] * scale - luma) / 0.701;
+	for (int c = 0; c < 3; c++)
+		samples[3 + c] = 4096.0 + 56064.0 * rgb[c] * scale;
+}
+
+// Each pixel format must decode to the samples of each bar within a code of the format, and reversed bars must
+// mirror the bars.  Entries must be built once and shared, and must be read back from a cache file.
+static bool VerifyPatternCache(void)
+{
+	static const uint32_t	kWidth		= 64;
+	static const uint32_t	kHeight		= 6;
+
+	PatternCache			cache;
+	bool					verified	= true;
+
+	for (int format = 0; format < kConversionFormatCount; format++)
+	{
+		BMDPixelFormat				pixelFormat	= kConversionFormats[format].pixelFormat;
+		bool						isRGB		= kConversionFormats[format].isRGB;
+		int							code		= isRGB ? (1 << (16 - kConversionFormats[format].bitDepth)) : (1 << (10 - kConversionFormats[format].bitDepth));
+		VideoConversion::RowPlanes	planes;
+		VideoConversion::RowPlanes	reversedPlanes;
+		double						maxError	= 0.0;
+
+		ResizeRowPlanes(planes, kWidth);
+		ResizeRowPlanes(reversedPlanes, kWidth);
+
+		for (TestPatternType pattern : { kTestPatternBlack, kTestPatternColourBars100, kTestPatternColourBars75, kTestPatternWhite })
+		{
+			std::shared_ptr<const PatternFrame>	frame		= cache.GetFrame(bmdModeNTSC, kWidth, kHeight, pixelFormat, pattern);
+			BenchmarkVideoFrame					filled(kWidth, kHeight, pixelFormat);
+
+			if ((frame == nullptr) || (cache.GetFrame(bmdModeNTSC, kWidth, kHeight, pixelFormat, pattern) != frame) ||
+				(cache.FillFrame(bmdModeNTSC, pattern, &filled) != S_OK) ||
+				(memcmp(filled.Buffer().data(), frame->GetBytes(), filled.Buffer().size()) != 0))
+			{
+				fprintf(stderr, "%s pattern %d is not cached\n", kConversionFormats[format].name, pattern);
+				verified = false;
+				continue;
+			}
+
+			DecodePixelFormatRow(pixelFormat, frame->GetBytes() + (kHeight - 1) * frame->GetRowBytes(), planes, kWidth);
+
+			for (uint32_t x = 0; x < kWidth; x++)
+			{
+				double samples[6];
+
+				PatternBarSamples((pattern == kTestPatternBlack) ? kWidth - 1 : (pattern == kTestPatternWhite) ? 0 : x, kWidth, (pattern == kTestPatternColourBars75) ? 0.75 : 1.0, samples);
+
+				if (isRGB)
+				{
+					maxError = std::max(maxError, fabs(planes.red[x] - samples[3]));
+					maxError = std::max(maxError, fabs(planes.green[x] - samples[4]));
+					maxError = std::max(maxError, fabs(planes.blue[x] - samples[5]));
+				}
+				else
+				{
+					maxError = std::max(maxError, fabs(planes.luma[x] - samples[0]));
+					maxError = std::max(maxError, fabs(planes.cb[x / 2] - samples[1]));
+					maxError = std::max(maxError, fabs(planes.cr[x / 2] - samples[2]));
+				}
+
+				if (kConversionFormats[format].hasAlpha)
+					maxError = std::max(maxError, 65535.0 - planes.alpha[x]);
+			}
+		}
+
+		// Reversed bars of the 3D right eye
+		DecodePixelFormatRow(pixelFormat, cache.GetFrame(bmdModeNTSC, kWidth, kHeight, pixelFormat, kTestPatternColourBars100)->GetBytes(), planes, kWidth);
+		DecodePixelFormatRow(pixelFormat, cache.GetFrame(bmdModeNTSC, kWidth, kHeight, pixelFormat, kTestPatternColourBars100Reversed)->GetBytes(), reversedPlanes, kWidth);
+
+		for (uint32_t x = 0; x < kWidth; x++)
+		{
+			if (reversedPlanes.luma[x] != planes.luma[kWidth - 2 - (x & ~1u)] || reversedPlanes.red[x] != planes.red[kWidth - 2 - (x & ~1u)])
+				maxError = std::max(maxError, (double)code * 2);
+		}
+
+		if (maxError > code)
+		{
+			fprintf(stderr, "%s pattern error %.1f\n", kConversionFormats[format].name, maxError);
+			verified = false;
+		}
+	}
+
+	// A cache file is read instead of rendering the pattern, the change to the file shows that it was read
+	{
+		char		directory[]		= "/tmp/PatternCacheXXXXXX";
+		char		path[128];
+		FILE*		file;
+		uint8_t		firstByte		= 0;
+		bool		fileRead		= false;
+
+		if (mkdtemp(directory) == NULL)
+			return false;
+
+		PatternCache	writeCache;
+		PatternCache	readCache;
+
+		writeCache.SetDirectory(directory);
+		readCache.SetDirectory(directory);
+
+		std::shared_ptr<const PatternFrame> written = writeCache.GetFrame(bmdModeHD1080p25, 1920, 1080, bmdFormat10BitYUV, kTestPatternColourBars75);
+
+		snprintf(path, sizeof(path), "%s/%08x-%08x-%u.pattern", directory, (uint32_t)bmdModeHD1080p25, (uint32_t)bmdFormat10BitYUV, (uint32_t)kTestPatternColourBars75);
+		file = fopen(path, "r+b");
+		if (file != NULL)
+		{
+			// The first byte of the frame follows the 40 byte header
+			fseek(file, 40, SEEK_SET);
+			firstByte = ~written->GetBytes()[0];
+			fwrite(&firstByte, 1, 1, file);
+			fclose(file);
+
+			std::shared_ptr<const PatternFrame> read = readCache.GetFrame(bmdModeHD1080p25, 1920, 1080, bmdFormat10BitYUV, kTestPatternColourBars75);
+
+			fileRead = (read->GetBytes()[0] == firstByte) &&
+					   (memcmp(read->GetBytes() + 1, written->GetBytes() + 1, (size_t)written->GetRowBytes() * written->GetHeight() - 1) == 0);
+			remove(path);
+		}
+		rmdir(directory);
+
+		if (!fileRead)
+		{
+			fprintf(stderr, "Pattern cache file was not %s\n", (file == NULL) ? "written" : "read");
+			verified = false;
+		}
+	}
+
+	return verified;
+}
+
+// Colour bars filled in 2vuy and converted to the pixel format, as the signal generator samples did, compared with
+// building a cache entry, reading it from a cache file and filling a frame from it
+static void BenchmarkPatternCache(int iterations, unsigned threadCount)
+{
+	static const uint32_t	kWidth		= 3840;
+	static const uint32_t	kHeight		= 2160;
+
+	IDeckLinkVideoConversion*	conversion	= CreateSoftwareVideoConversionInstance(threadCount);
+	char						directory[]	= "/tmp/PatternCacheXXXXXX";
+
+	if (mkdtemp(directory) == NULL)
+		directory[0] = '\0';
+
+	for (BMDPixelFormat pixelFormat : { bmdFormat10BitYUV, bmdFormat12BitRGB })
+	{
+		BenchmarkVideoFrame	reference(kWidth, kHeight, bmdFormat8BitYUV);
+		BenchmarkVideoFrame	frame(kWidth, kHeight, pixelFormat);
+		double				frameTime[4];
+
+		for (int pass = 0; pass < 4; pass++)
+		{
+			auto process = [&]()
+			{
+				if (pass == 0)
+				{
+					uint32_t* word = (uint32_t*)reference.Buffer().data();
+
+					for (uint32_t y = 0; y < kHeight; y++)
+						for (uint32_t x = 0; x < kWidth; x += 2)
+							*(word++) = 0x10801080;
+
+					conversion->ConvertFrame(&reference, &frame);
+				}
+				else if (pass < 3)
+				{
+					PatternCache cache;
+
+					// The first pass renders the entry, the second reads the file written by the first
+					if (pass == 2)
+						cache.SetDirectory(directory);
+					cache.FillFrame(bmdMode4K2160p25, kTestPatternColourBars75, &frame);
+				}
+				else
+				{
+					PatternCache::GetSharedCache().FillFrame(bmdMode4K2160p25, kTestPatternColourBars75, &frame);
+				}
+			};
+
+			process();
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < iterations; i++)
+				process();
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			frameTime[pass] = elapsed.count() * 1000.0 / iterations;
+		}
+
+		printf("  %4ux%-4u %s convert %6.2f ms, build %6.2f ms, read %6.2f ms, fill %6.2f ms\n",
+			   kWidth, kHeight, (pixelFormat == bmdFormat10BitYUV) ? "v210" : "R12B", frameTime[0], frameTime[1], frameTime[2], frameTime[3]);
+	}
+
+	if (directory[0] != '\0')
+	{
+		char path[128];
+
+		for (BMDPixelFormat pixelFormat : { bmdFormat10BitYUV, bmdFormat12BitRGB })
+		{
+			snprintf(path, sizeof(path), "%s/%08x-%08x-%u.pattern", directory, (uint32_t)bmdMode4K2160p25, (uint32_t)pixelFormat, (uint32_t)kTestPatternColourBars75);
+			remove(path);
+		}
+		rmdir(directory);
+	}
+
+	conversion->Release();
+}
+
+static const char* kAnimatedPatternNames[] = { "zone plate", "scrolling ramp", "rotating sweep", "moving box" };
+
+// Rows of the 5x7 glyph of the digit 0, shown by the moving box in the first frame
+static const uint8_t kZeroGlyph[7] = { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E };
+
+// Level of the first frame of a pattern at a pixel, between black at 0 and white at 1.  The sinusoids and the box are
+// centred in the first frame, and the box is in the top left corner showing zeros in a 1 pixel font.
+static double ExpectedAnimatedPatternLevel(AnimatedPatternType pattern, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+	double dx = x - width / 2.0;
+	double dy = y - height / 2.0;
+
+	switch (pattern)
+	{
+		case kAnimatedPatternZonePlate:
+			return 0.5 + 0.5 * cos(M_PI / width * (dx * dx + dy * dy));
+		case kAnimatedPatternScrollingRamp:
+			return (double)x / (width - 1);
+		case kAnimatedPatternRotatingSweep:
+			return 0.5 + 0.5 * cos(2.0 * M_PI / 256.0 * dx);
+		case kAnimatedPatternMovingBox:
+		default:
+			if ((x >= kAnimatedPatternDigits * 6 + 1) || (y >= 9))
+				return 0.5;
+			if ((x < 1) || (y < 1) || (y > 7) || ((x - 1) % 6 == 5))
+				return 1.0;
+			return (kZeroGlyph[y - 1] & (0x10 >> ((x - 1) % 6))) ? 0.0 : 1.0;
+	}
+}
+
+// Rendering by the thread pool must match rendering by the calling thread alone, and each frame must differ from
+// the frame before it.  The first frame must be within a code of the format of the expected pattern, with neutral
+// chroma or equal R, G and B, and opaque alpha.  The ramp must scroll left by a sample each frame.
+static bool VerifyAnimatedPattern(void)
+{
+	static const uint32_t	kWidth		= 192;
+	static const uint32_t	kHeight		= 120;
+
+	bool					verified	= true;
+
+	for (int format = 0; format < kConversionFormatCount; format++)
+	{
+		BMDPixelFormat				pixelFormat	= kConversionFormats[format].pixelFormat;
+		bool						isRGB		= kConversionFormats[format].isRGB;
+		double						range		= isRGB ? 56064.0 : 876.0;
+		double						black		= isRGB ? 4096.0 : 64.0;
+		double						code		= isRGB ? (1 << (16 - kConversionFormats[format].bitDepth)) : (1 << (10 - kConversionFormats[format].bitDepth));
+		VideoConversion::RowPlanes	planes[2];
+
+		ResizeRowPlanes(planes[0], kWidth);
+		ResizeRowPlanes(planes[1], kWidth);
+
+		for (int pattern = kAnimatedPatternZonePlate; pattern <= kAnimatedPatternMovingBox; pattern++)
+		{
+			AnimatedPatternRenderer	pooledRenderer(kWidth, kHeight, pixelFormat, (AnimatedPatternType)pattern, 4);
+			AnimatedPatternRenderer	singleRenderer(kWidth, kHeight, pixelFormat, (AnimatedPatternType)pattern, 1);
+			BenchmarkVideoFrame		frames[2]	= { { kWidth, kHeight, pixelFormat }, { kWidth, kHeight, pixelFormat } };
+			BenchmarkVideoFrame		single(kWidth, kHeight, pixelFormat);
+			long					rowBytes	= single.GetRowBytes();
+			double					maxError	= 0.0;
+
+			for (uint64_t frameNumber = 0; frameNumber < 2; frameNumber++)
+			{
+				if ((pooledRenderer.RenderFrame(frameNumber, frames[frameNumber].Buffer().data(), rowBytes) != S_OK) ||
+					(singleRenderer.RenderFrame(frameNumber, single.Buffer().data(), rowBytes) != S_OK) ||
+					(frames[frameNumber].Buffer() != single.Buffer()))
+				{
+					fprintf(stderr, "%s %s pooled rendering does not match rendering by one thread\n", kConversionFormats[format].name, kAnimatedPatternNames[pattern]);
+					verified = false;
+				}
+			}
+
+			if (frames[0].Buffer() == frames[1].Buffer())
+			{
+				fprintf(stderr, "%s %s frame is repeated\n", kConversionFormats[format].name, kAnimatedPatternNames[pattern]);
+				verified = false;
+			}
+
+			for (uint32_t y = 0; y < kHeight; y++)
+			{
+				for (int frame = 0; frame < 2; frame++)
+					DecodePixelFormatRow(pixelFormat, frames[frame].Buffer().data() + (size_t)y * rowBytes, planes[frame], kWidth);
+
+				for (uint32_t x = 0; x < kWidth; x++)
+				{
+					const std::vector<uint16_t>&	samples		= isRGB ? planes[0].red : planes[0].luma;
+					double							expected	= ExpectedAnimatedPatternLevel((AnimatedPatternType)pattern, x, y, kWidth, kHeight);
+
+					maxError = std::max(maxError, fabs(samples[x] - (black + range * expected)));
+
+					if (pattern == kAnimatedPatternScrollingRamp)
+					{
+						const std::vector<uint16_t>& scrolled = isRGB ? planes[1].red : planes[1].luma;
+
+						maxError = std::max(maxError, fabs(scrolled[x] - (black + range * ExpectedAnimatedPatternLevel((AnimatedPatternType)pattern, (x + 1) % kWidth, y, kWidth, kHeight))));
+					}
+
+					if (isRGB)
+						maxError = std::max(maxError, (double)std::max(abs(planes[0].green[x] - planes[0].red[x]), abs(planes[0].blue[x] - planes[0].red[x])));
+					else
+						maxError = std::max(maxError, std::max(fabs(planes[0].cb[x / 2] - 512.0), fabs(planes[0].cr[x / 2] - 512.0)));
+
+					if (kConversionFormats[format].hasAlpha)
+						maxError = std::max(maxError, 65535.0 - planes[0].alpha[x]);
+				}
+			}
+
+			// The sinusoids are rendered from tables of 14-bit cosines and sines
+			if (maxError > code + range / 4096.0)
+			{
+				fprintf(stderr, "%s %s pattern error %.1f\n", kConversionFormats[format].name, kAnimatedPatternNames[pattern], maxError);
+				verified = false;
+			}
+		}
+	}
+
+	return verified;
+}
+
+// Frames of each pattern rendered at 8K, as an output renders a frame of a frame pool each frame period
+static void BenchmarkAnimatedPattern(int iterations, unsigned threadCount)
+{
+	static const uint32_t	kWidth		= 7680;
+	static const uint32_t	kHeight		= 4320;
+
+	for (BMDPixelFormat pixelFormat : { bmdFormat10BitYUV, bmdFormat12BitRGB })
+	{
+		BenchmarkVideoFrame	frame(kWidth, kHeight, pixelFormat);
+
+		for (int pattern = kAnimatedPatternZonePlate; pattern <= kAnimatedPatternMovingBox; pattern++)
+		{
+			AnimatedPatternRenderer	renderer(kWidth, kHeight, pixelFormat, (AnimatedPatternType)pattern, threadCount);
+			double					frameTime;
+
+			renderer.RenderFrame(0, frame.Buffer().data(), frame.GetRowBytes());
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 1; i <= iterations; i++)
+				renderer.RenderFrame(i, frame.Buffer().data(), frame.GetRowBytes());
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			frameTime = elapsed.count() * 1000.0 / iterations;
+
+			printf("  %4ux%-4u %s %-14s %6.2f ms/frame, %6.1f frames/s with %u threads\n",
+				   kWidth, kHeight, (pixelFormat == bmdFormat10BitYUV) ? "v210" : "R12B", kAnimatedPatternNames[pattern],
+				   frameTime, 1000.0 / frameTime, renderer.GetThreadCount());
+		}
+	}
+}
+
+// Text drawn by the overlay tests, in glyphs of the digit 0 and spaces, and its scale
+static const char*		kTextOverlayTestText	= "0 0\n00\n";
+static const uint32_t	kTextOverlayTestScale	= 2;
+
+// Whether a pixel of the test text's box is a pixel of a glyph
+static bool IsTestTextPixel(uint32_t x, uint32_t y)
+{
+	static const uint32_t	kColumns	= 3;
+
+	uint32_t	unitX	= x / kTextOverlayTestScale;
+	uint32_t	unitY	= y / kTextOverlayTestScale;
+	uint32_t	line	= unitY / 9;
+	uint32_t	row		= unitY % 9;
+	uint32_t	column	= unitX / 6;
+	uint32_t	cellX	= unitX % 6;
+	const char*	text	= (line == 0) ? "0 0" : (line == 1) ? "00" : "";
+
+	if ((column >= kColumns) || (column >= strlen(text)) || (text[column] != '0') || (row < 1) || (row > 7) || (cellX < 1))
+		return false;
+
+	return (kZeroGlyph[row - 1] & (0x20 >> cellX)) != 0;
+}
+
+// Text is drawn over a frame of random bytes, in the frame and clipped at its bottom right corner.  Glyph pixels
+// must be white and the box must halve the video to within a code of the format, and alpha and every pixel
+// outside the box must be unchanged.  Computed timecode must count drop frame.
+static bool VerifyTextOverlay(std::mt19937& random)
+{
+	static const uint32_t	kWidth		= 200;
+	static const uint32_t	kHeight		= 120;
+	static const struct { uint32_t x; uint32_t y; } kPositions[] = { { 37, 11 }, { 187, 101 } };
+	static const struct { uint64_t frameNumber; BMDTimeValue frameDuration; BMDTimeScale timeScale; const char* timecode; } kTimecodeTests[] =
+	{
+		{ 90000,	1000,	25000,	"TC 01:00:00:00 GEN" },
+		{ 1799,		1001,	30000,	"TC 00:00:59;29 GEN" },
+		{ 1800,		1001,	30000,	"TC 00:01:00;02 GEN" },
+		{ 17982,	1001,	30000,	"TC 00:10:00;00 GEN" },
+		{ 3600,		1001,	60000,	"TC 00:01:00;04 GEN" },
+		{ 86400,	1001,	24000,	"TC 01:00:00:00 GEN" },
+	};
+
+	TextOverlay	textOverlay(kTextOverlayTestScale);
+	bool		verified	= true;
+	uint32_t	boxWidth;
+	uint32_t	boxHeight;
+
+	textOverlay.GetTextSize(kTextOverlayTestText, boxWidth, boxHeight);
+
+	for (int format = 0; format < kConversionFormatCount; format++)
+	{
+		BMDPixelFormat				pixelFormat	= kConversionFormats[format].pixelFormat;
+		bool						isRGB		= kConversionFormats[format].isRGB;
+		double						code		= isRGB ? (1 << (16 - kConversionFormats[format].bitDepth)) : (1 << (10 - kConversionFormats[format].bitDepth));
+		double						tolerance	= isRGB ? code + 64.0 : code;		// RGB is blended at 10 bits
+		VideoConversion::RowPlanes	before;
+		VideoConversion::RowPlanes	after;
+
+		ResizeRowPlanes(before, kWidth);
+		ResizeRowPlanes(after, kWidth);
+
+		for (const auto& position : kPositions)
+		{
+			BenchmarkVideoFrame	source(kWidth, kHeight, pixelFormat);
+			BenchmarkVideoFrame	frame(kWidth, kHeight, pixelFormat);
+			long				rowBytes	= frame.GetRowBytes();
+			uint32_t			boxX		= position.x & ~1u;
+			double				maxError	= 0.0;
+			bool				unchanged	= true;
+
+			for (uint8_t& byte : source.Buffer())
+				byte = (uint8_t)random();
+
+			frame.Buffer() = source.Buffer();
+
+			if (textOverlay.DrawText(kTextOverlayTestText, position.x, position.y, pixelFormat, frame.Buffer().data(), rowBytes, kWidth, kHeight) != S_OK)
+			{
+				fprintf(stderr, "%s text overlay failed\n", kConversionFormats[format].name);
+				verified = false;
+				continue;
+			}
+
+			for (uint32_t y = 0; y < kHeight; y++)
+			{
+				const uint8_t*	sourceRow	= source.Buffer().data() + (size_t)y * rowBytes;
+				const uint8_t*	frameRow	= frame.Buffer().data() + (size_t)y * rowBytes;
+
+				if ((y < position.y) || (y >= position.y + boxHeight))
+				{
+					unchanged &= (memcmp(sourceRow, frameRow, rowBytes) == 0);
+					continue;
+				}
+
+				DecodePixelFormatRow(pixelFormat, sourceRow, before, kWidth);
+				DecodePixelFormatRow(pixelFormat, frameRow, after, kWidth);
+
+				for (uint32_t x = 0; x < kWidth; x++)
+				{
+					bool inBox		= (x >= boxX) && (x < boxX + boxWidth);
+					bool isText		= inBox && IsTestTextPixel(x - boxX, y - position.y);
+
+					if (kConversionFormats[format].hasAlpha)
+						unchanged &= (before.alpha[x] == after.alpha[x]);
+
+					if (isRGB)
+					{
+						const std::vector<uint16_t>* planes[2][3] = { { &before.red, &before.green, &before.blue }, { &after.red, &after.green, &after.blue } };
+
+						for (int plane = 0; plane < 3; plane++)
+						{
+							uint16_t	background	= (*planes[0][plane])[x];
+							uint16_t	output		= (*planes[1][plane])[x];
+
+							if (!inBox)
+								unchanged &= (background == output);
+							else
+								maxError = std::max(maxError, fabs(output - (isText ? 60160.0 : 2048.0 + background / 2.0)));
+						}
+					}
+					else if (!inBox)
+					{
+						unchanged &= (before.luma[x] == after.luma[x]) && (before.cb[x / 2] == after.cb[x / 2]) && (before.cr[x / 2] == after.cr[x / 2]);
+					}
+					else
+					{
+						maxError = std::max(maxError, fabs(after.luma[x] - (isText ? 940.0 : 32.0 + before.luma[x] / 2.0)));
+						maxError = std::max(maxError, fabs(after.cb[x / 2] - (isText ? 512.0 : 256.0 + before.cb[x / 2] / 2.0)));
+						maxError = std::max(maxError, fabs(after.cr[x / 2] - (isText ? 512.0 : 256.0 + before.cr[x / 2] / 2.0)));
+					}
+				}
+			}
+
+			if (!unchanged)
+			{
+				fprintf(stderr, "%s text overlay at %u,%u changed pixels outside its box\n", kConversionFormats[format].name, position.x, position.y);
+				verified = false;
+			}
+
+			if (maxError > tolerance)
+			{
+				fprintf(stderr, "%s text overlay at %u,%u error %.1f\n", kConversionFormats[format].name, position.x, position.y, maxError);
+				verified = false;
+			}
+		}
+	}
+
+	for (const auto& test : kTimecodeTests)
+	{
+		BenchmarkVideoFrame	frame(kWidth, kHeight, bmdFormat10BitYUV);
+		TimecodeBurnIn		burnIn("DeckLink", test.timeScale);
+		BurnInTimecode		timecode;
+		char				text[128];
+
+		TimecodeBurnIn::GetFrameTimecode(&frame, test.frameNumber * test.frameDuration, test.frameDuration, test.timeScale, timecode);
+		burnIn.FormatText(timecode, test.frameNumber * test.frameDuration, test.frameDuration, text, sizeof(text));
+
+		if ((strncmp(text, test.timecode, strlen(test.timecode)) != 0) ||
+			(burnIn.BurnIn(&frame, test.frameNumber * test.frameDuration, test.frameDuration) != S_OK))
+		{
+			fprintf(stderr, "Frame %llu at %lld/%lld burnt in \"%s\", expected \"%s\"\n", (unsigned long long)test.frameNumber,
+					(long long)test.timeScale, (long long)test.frameDuration, text, test.timecode);
+			verified = false;
+		}
+	}
+
+	return verified;
+}
+
+// Timecode, frame number, device name and stream time burnt into each frame
+static void BenchmarkTextOverlay(int iterations)
+{
+	for (auto frameSize : { std::make_pair(1920u, 1080u), std::make_pair(3840u, 2160u) })
+	{
+		for (BMDPixelFormat pixelFormat : { bmdFormat10BitYUV, bmdFormat8BitYUV, bmdFormat10BitRGB })
+		{
+			BenchmarkVideoFrame	frame(frameSize.first, frameSize.second, pixelFormat);
+			TimecodeBurnIn		burnIn("DeckLink 8K Pro (1)", 60000);
+			double				frameTime;
+
+			burnIn.BurnIn(&frame, 0, 1001);
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 1; i <= iterations; i++)
+				burnIn.BurnIn(&frame, (BMDTimeValue)i * 1001, 1001);
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			frameTime = elapsed.count() * 1000000.0 / iterations;
+
+			printf("  %4ux%-4u %s %7.1f us/frame\n", frameSize.first, frameSize.second,
+				   (pixelFormat == bmdFormat10BitYUV) ? "v210" : (pixelFormat == bmdFormat8BitYUV) ? "2vuy" : "r210", frameTime);
+		}
+	}
+}
+
+// A/V sync test signal at 29.97 fps, a flash and a beep each second
+static const BMDTimeValue	kAVSyncFrameDuration	= 1001;
+static const BMDTimeScale	kAVSyncTimeScale		= 30000;
+static const uint32_t		kAVSyncFramesPerPeriod	= 30;
+static const uint32_t		kAVSyncPeriodSamples	= 48048;
+
+// Audio of channels channels of the test signal, delayed by offset samples, from sample start
+static void FillAVSyncTestAudio(const std::vector<uint8_t>& period, uint32_t channels, uint32_t sampleDepth, int64_t offset, int64_t start,
+								uint32_t sampleFrames, std::vector<uint8_t>& audio)
+{
+	size_t	frameBytes = channels * sampleDepth / 8;
+
+	audio.resize(sampleFrames * frameBytes);
+	for (uint32_t i = 0; i < sampleFrames; i++)
+	{
+		int64_t	index = (((start + i - offset) % kAVSyncPeriodSamples) + kAVSyncPeriodSamples) % kAVSyncPeriodSamples;
+
+		memcpy(&audio[i * frameBytes], &period[index * frameBytes], frameBytes);
+	}
+}
+
+// Black and white frames of each pixel format must have the levels of black and white.  For audio offsets from a
+// few ms early to a frame late, the analyzer must pair each flash with its beep and measure the offset within a
+// sample, with audio in packets of a frame of samples.
+static bool VerifyAVSync(void)
+{
+	static const uint32_t	kWidth			= 64;
+	static const uint32_t	kHeight			= 36;
+	static const uint32_t	kChannels		= 8;
+	static const uint32_t	kBeepChannel	= 3;
+	static const uint32_t	kPeriods		= 5;
+	static const int64_t	kOffsets[]		= { 0, 37, -517, 1603, -4800 };
+
+	PatternCache			cache;
+	bool					verified		= true;
+
+	for (int format = 0; format < kConversionFormatCount; format++)
+	{
+		BMDPixelFormat				pixelFormat	= kConversionFormats[format].pixelFormat;
+		BenchmarkVideoFrame			black(kWidth, kHeight, pixelFormat);
+		BenchmarkVideoFrame			white(kWidth, kHeight, pixelFormat);
+		VideoConversion::RowPlanes	planes;
+		int							blackLevel;
+		int							whiteLevel;
+
+		cache.FillFrame(bmdModeNTSC, kTestPatternBlack, &black);
+		cache.FillFrame(bmdModeNTSC, kTestPatternWhite, &white);
+		blackLevel = AVSyncAnalyzer::GetFrameLevel(&black, planes);
+		whiteLevel = AVSyncAnalyzer::GetFrameLevel(&white, planes);
+
+		if ((abs(blackLevel - 64) > 1) || (abs(whiteLevel - 940) > 1))
+		{
+			fprintf(stderr, "%s A/V sync frame levels %d and %d, expected 64 and 940\n", kConversionFormats[format].name, blackLevel, whiteLevel);
+			verified = false;
+		}
+	}
+
+	for (uint32_t sampleDepth : { 16u, 32u })
+	{
+		BenchmarkVideoFrame		black(kWidth, kHeight, bmdFormat10BitYUV);
+		BenchmarkVideoFrame		white(kWidth, kHeight, bmdFormat10BitYUV);
+		std::vector<uint8_t>	period(kAVSyncPeriodSamples * kChannels * sampleDepth / 8);
+		std::vector<uint8_t>	audio;
+
+		cache.FillFrame(bmdModeNTSC, kTestPatternBlack, &black);
+		cache.FillFrame(bmdModeNTSC, kTestPatternWhite, &white);
+		FillAVSyncAudio(period.data(), kAVSyncPeriodSamples, kAVSyncPeriodSamples / kAVSyncFramesPerPeriod, kChannels, sampleDepth, (1 << kBeepChannel) | 1);
+
+		for (int64_t offset : kOffsets)
+		{
+			AVSyncAnalyzer		analyzer(kChannels, sampleDepth, kBeepChannel);
+			AVSyncMeasurement	measurement;
+			uint32_t			measurements	= 0;
+			double				maxError		= 0.0;
+
+			for (uint32_t frame = 0; frame < kPeriods * kAVSyncFramesPerPeriod; frame++)
+			{
+				int64_t		start	= ((int64_t)frame * kAVSyncPeriodSamples) / kAVSyncFramesPerPeriod;
+				int64_t		end		= ((int64_t)(frame + 1) * kAVSyncPeriodSamples) / kAVSyncFramesPerPeriod;
+
+				FillAVSyncTestAudio(period, kChannels, sampleDepth, offset, start, (uint32_t)(end - start), audio);
+				analyzer.AnalyzeVideoFrame(((frame % kAVSyncFramesPerPeriod) == 0) ? &white : &black, frame * kAVSyncFrameDuration, kAVSyncTimeScale);
+				analyzer.AnalyzeAudioSamples(audio.data(), (uint32_t)(end - start), start);
+
+				while (analyzer.GetMeasurement(measurement))
+				{
+					maxError = std::max(maxError, fabs(measurement.offset - offset * 1000.0 / kAVSyncSampleRate));
+					measurements++;
+				}
+			}
+
+			// The first beep is missed when there is no silence before it
+			if ((measurements < kPeriods - 1) || (maxError > 1000.0 / kAVSyncSampleRate))
+			{
+				fprintf(stderr, "%u-bit A/V sync offset of %lld samples, %u measurements with error %.3f ms\n", sampleDepth, (long long)offset, measurements, maxError);
+				verified = false;
+			}
+		}
+	}
+
+	return verified;
+}
+
+// Analysis of each frame and its audio packet, for 16 channels of 32-bit audio
+static void BenchmarkAVSync(int iterations)
+{
+	static const uint32_t	kChannels	= 16;
+
+	std::vector<uint8_t>	period(kAVSyncPeriodSamples * kChannels * 4);
+	std::vector<uint8_t>	audio;
+
+	FillAVSyncAudio(period.data(), kAVSyncPeriodSamples, kAVSyncPeriodSamples / kAVSyncFramesPerPeriod, kChannels, 32, 1);
+	FillAVSyncTestAudio(period, kChannels, 32, 0, 0, kAVSyncPeriodSamples, audio);
+
+	for (auto frameSize : { std::make_pair(1920u, 1080u), std::make_pair(3840u, 2160u) })
+	{
+		for (BMDPixelFormat pixelFormat : { bmdFormat10BitYUV, bmdFormat8BitYUV, bmdFormat10BitRGB })
+		{
+			BenchmarkVideoFrame	frame(frameSize.first, frameSize.second, pixelFormat);
+			AVSyncAnalyzer		analyzer(kChannels, 32, 0);
+			AVSyncMeasurement	measurement;
+			double				frameTime;
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < iterations; i++)
+			{
+				int64_t		audioStart	= ((int64_t)(i % kAVSyncFramesPerPeriod) * kAVSyncPeriodSamples) / kAVSyncFramesPerPeriod;
+				int64_t		audioEnd	= ((int64_t)(i % kAVSyncFramesPerPeriod + 1) * kAVSyncPeriodSamples) / kAVSyncFramesPerPeriod;
+
+				analyzer.AnalyzeVideoFrame(&frame, i * kAVSyncFrameDuration, kAVSyncTimeScale);
+				analyzer.AnalyzeAudioSamples(&audio[audioStart * kChannels * 4], (uint32_t)(audioEnd - audioStart), audioStart);
+				while (analyzer.GetMeasurement(measurement))
+					;
+			}
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			frameTime = elapsed.count() * 1000000.0 / iterations;
+
+			printf("  %4ux%-4u %s %7.1f us/frame\n", frameSize.first, frameSize.second,
+				   (pixelFormat == bmdFormat10BitYUV) ? "v210" : (pixelFormat == bmdFormat8BitYUV) ? "2vuy" : "r210", frameTime);
+		}
+	}
+}
+
+// Breaks of each channel in a cycle of each tone sequence, for 4 channels
+static const uint32_t	kToneTestChannels		= 4;
+static const uint32_t	kToneSequenceBreaks[kToneSequenceCount][kToneTestChannels] =
+{
+	{ 0, 0, 0, 0 },
+	{ 1, 2, 3, 4 },
+	{ 1, 0, 1, 0 },
+	{ 1, 2, 1, 2 }
+};
+
+static bool VerifyToneKernels(VideoKernelsISA isa, std::mt19937& random)
+{
+	std::uniform_int_distribution<uint32_t>	randomPhase;
+	std::uniform_real_distribution<float>	randomSample(-1.25f, 1.25f);
+	bool									verified = true;
+
+	for (uint32_t channels : { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 9u, 12u, 15u, 16u, 17u, 24u, 64u })
+	{
+		for (uint32_t frameCount : { 1u, 2u, 3u, 5u, 7u, 8u, 9u, 100u })
+		{
+			std::vector<uint32_t>	phases(channels);
+			std::vector<uint32_t>	increments(channels);
+			std::vector<float>		levels(channels);
+			std::vector<float>		expected((size_t)channels * frameCount);
+			std::vector<float>		output(expected.size());
+
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				phases[c]		= randomPhase(random);
+				increments[c]	= randomPhase(random);
+				levels[c]		= std::fabs(randomSample(random)) / 1.25f;
+			}
+
+			std::vector<uint32_t>	expectedPhases(phases);
+
+			SetVideoKernelsISA(kVideoKernelsISAScalar);
+			RenderToneFrames(expectedPhases.data(), increments.data(), levels.data(), channels, expected.data(), frameCount);
+			SetVideoKernelsISA(isa);
+			RenderToneFrames(phases.data(), increments.data(), levels.data(), channels, output.data(), frameCount);
+
+			// SIMD kernels may differ by a rounding, where a multiply and add are fused
+			for (size_t i = 0; i < output.size(); i++)
+			{
+				if (std::fabs(output[i] - expected[i]) <= 2.5e-7f)
+					continue;
+
+				fprintf(stderr, "%s tone kernel mismatch, %u channels, %u frames, sample %zu: %.9f expected %.9f\n",
+						GetVideoKernelsISAName(isa), channels, frameCount, i, output[i], expected[i]);
+				verified = false;
+				break;
+			}
+
+			if (phases != expectedPhases)
+			{
+				fprintf(stderr, "%s tone kernel phase mismatch, %u channels, %u frames\n", GetVideoKernelsISAName(isa), channels, frameCount);
+				verified = false;
+			}
+		}
+	}
+
+	for (uint32_t sampleDepth : { 16u, 32u })
+	{
+		for (uint32_t count : { 1u, 7u, 8u, 15u, 16u, 17u, 1000u })
+		{
+			std::vector<float>		input(count);
+			std::vector<int32_t>	expected(count);
+			std::vector<int32_t>	output(count);
+
+			for (uint32_t i = 0; i < count; i++)
+				input[i] = randomSample(random);
+
+			// Full scale, the clip points and a rounding tie
+			input[0] = (count > 1) ? 1.0f : -1.0f;
+			if (count > 2)
+				input[2] = (sampleDepth == 32) ? -1.0f : 2.5f / 32768.0f;
+
+			SetVideoKernelsISA(kVideoKernelsISAScalar);
+			QuantizeAudioSamples(input.data(), expected.data(), count, sampleDepth);
+			SetVideoKernelsISA(isa);
+			QuantizeAudioSamples(input.data(), output.data(), count, sampleDepth);
+
+			if (memcmp(output.data(), expected.data(), count * sampleDepth / 8) != 0)
+			{
+				fprintf(stderr, "%s audio quantize kernel mismatch, %u bit, %u samples\n", GetVideoKernelsISAName(isa), sampleDepth, count);
+				verified = false;
+			}
+		}
+	}
+
+	SetVideoKernelsISA(kVideoKernelsISAScalar);
+	return verified;
+}
+
+static bool VerifyToneGenerator(std::mt19937& random)
+{
+	const VideoKernelsISA	defaultISA	= GetVideoKernelsISA();
+	const uint32_t			stepFrames	= 48000 / 20;
+	bool					verified	= true;
+
+	// The scalar tone kernel against sin(), over phases across the whole turn
+	{
+		std::uniform_int_distribution<uint32_t>	randomPhase;
+		uint32_t								phase		= 0;
+		uint32_t								increment	= 0x9E3779B1;
+		float									level		= 1.0f;
+		std::vector<float>						output(4096);
+		double									maxError	= 0.0;
+
+		for (int block = 0; block < 64; block++)
+		{
+			uint32_t	startPhase = phase;
+
+			if (block > 0)
+				startPhase = phase = randomPhase(random);
+
+			RenderToneFrames(&phase, &increment, &level, 1, output.data(), (uint32_t)output.size());
+
+			for (size_t i = 0; i < output.size(); i++)
+				maxError = std::max(maxError, fabs(output[i] - sin(2.0 * M_PI * (uint32_t)(startPhase + i * increment) / 4294967296.0)));
+		}
+
+		if (maxError > 3e-7)
+		{
+			fprintf(stderr, "Tone kernel error %g against sin()\n", maxError);
+			verified = false;
+		}
+	}
+
+	// Level and samples of a continuous tone, rendered in uneven chunks and at once
+	{
+		ToneGenerator			generator(kToneTestChannels);
+		std::vector<float>		output(48000 * kToneTestChannels);
+		std::vector<int16_t>	whole(output.size());
+		std::vector<int16_t>	chunks(output.size());
+		float					peak = 0.0f;
+
+		generator.SetTone(2, 997.0, -6.0);
+		generator.RenderFloat(output.data(), 48000);
+		for (size_t i = 0; i < output.size(); i += kToneTestChannels)
+			peak = std::max(peak, output[i]);
+
+		if (fabs(20.0 * log10(peak) - kDefaultToneLevel) > 0.01)
+		{
+			fprintf(stderr, "Tone generator peak %.3f dBFS expected %.3f dBFS\n", 20.0 * log10(peak), kDefaultToneLevel);
+			verified = false;
+		}
+
+		generator.Reset();
+		generator.Render(whole.data(), 48000, 16);
+		generator.Reset();
+		for (uint32_t frame = 0, chunk = 1; frame < 48000; frame += chunk, chunk = chunk * 7 % 1009 + 1)
+			generator.Render(&chunks[frame * kToneTestChannels], std::min(chunk, 48000 - frame), 16);
+
+		if (whole != chunks)
+		{
+			fprintf(stderr, "Tone generator output rendered in chunks does not match\n");
+			verified = false;
+		}
+	}
+
+	// Breaks of each sequence, each 50ms step should be silent in a break and reach the tone peak otherwise
+	for (int sequence = kToneSequenceContinuous; sequence < kToneSequenceCount; sequence++)
+	{
+		ToneGenerator		generator(kToneTestChannels);
+		uint32_t			cycleSteps	= (sequence == kToneSequenceChannelIdent) ? kToneTestChannels * 4 + 20 : (sequence == kToneSequenceGLITS) ? 80 : 60;
+		std::vector<float>	output((size_t)stepFrames * kToneTestChannels);
+		uint32_t			breaks[kToneTestChannels] = { 0 };
+		bool				wasOn[kToneTestChannels];
+
+		generator.SetSequence((ToneSequence)sequence);
+		std::fill(wasOn, wasOn + kToneTestChannels, true);
+
+		for (uint32_t step = 0; step < cycleSteps; step++)
+		{
+			generator.RenderFloat(output.data(), stepFrames);
+
+			for (uint32_t c = 0; c < kToneTestChannels; c++)
+			{
+				float	peak	= 0.0f;
+				bool	on		= generator.IsToneOn(c, step);
+
+				for (uint32_t i = 0; i < stepFrames; i++)
+					peak = std::max(peak, std::fabs(output[(size_t)i * kToneTestChannels + c]));
+
+				if (on != (peak > 0.12f))
+				{
+					fprintf(stderr, "Tone sequence %d channel %u step %u peak %.3f\n", sequence, c, step, peak);
+					verified = false;
+				}
+
+				breaks[c] += (wasOn[c] && !on) ? 1 : 0;
+				wasOn[c] = on;
+			}
+		}
+
+		for (uint32_t c = 0; c < kToneTestChannels; c++)
+		{
+			if (breaks[c] != kToneSequenceBreaks[sequence][c])
+			{
+				fprintf(stderr, "Tone sequence %d channel %u has %u breaks, expected %u\n", sequence, c, breaks[c], kToneSequenceBreaks[sequence][c]);
+				verified = false;
+			}
+		}
+	}
+
+	for (int isa = kVideoKernelsISAScalar + 1; isa < kVideoKernelsISACount; isa++)
+	{
+		if (IsVideoKernelsISASupported((VideoKernelsISA)isa))
+			verified &= VerifyToneKernels((VideoKernelsISA)isa, random);
+	}
+
+	SetVideoKernelsISA(defaultISA);
+	return verified;
+}
+
+// Rendering of a second of line-up tone at 48kHz by each kernel implementation
+static void BenchmarkToneGenerator(int iterations)
+{
+	const VideoKernelsISA defaultISA = GetVideoKernelsISA();
+
+	for (int isa = kVideoKernelsISAScalar; isa < kVideoKernelsISACount; isa++)
+	{
+		if (!IsVideoKernelsISASupported((VideoKernelsISA)isa))
+			continue;
+
+		SetVideoKernelsISA((VideoKernelsISA)isa);
+
+		for (uint32_t channels : { 2u, 16u, 64u })
+		{
+			for (uint32_t sampleDepth : { 16u, 32u })
+			{
+				ToneGenerator			generator(channels);
+				std::vector<int32_t>	output((size_t)48000 * channels);
+
+				generator.SetSequence(kToneSequenceChannelIdent);
+
+				auto start = std::chrono::steady_clock::now();
+
+				for (int i = 0; i < iterations; i++)
+					generator.Render(output.data(), 48000, sampleDepth);
+
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+				printf("  %-8s %2u channels %2u bit %8.1f Msamples/s %7.0fx real time\n", GetVideoKernelsISAName((VideoKernelsISA)isa), channels, sampleDepth,
+					   iterations * 48000.0 * channels / elapsed.count() / 1000000.0, iterations / elapsed.count());
+			}
+		}
+	}
+
+	SetVideoKernelsISA(defaultISA);
+}
+
+// LTC tests start 2 seconds before a minute, to cross a drop frame minute
+struct LTCTest
+{
+	BMDTimeValue	frameDuration;
+	BMDTimeScale	timeScale;
+	uint32_t		sampleDepth;
+	uint32_t		delay;				// Samples of silence before the LTC
+};
+
+static const LTCTest	kLTCTests[] =
+{
+	{ 1000,	24000,	16,	0 },
+	{ 1001,	24000,	32,	3 },
+	{ 1000,	25000,	16,	11 },
+	{ 1001,	30000,	16,	5 },
+	{ 1000,	30000,	32,	0 },
+	{ 1000,	50000,	16,	7 },
+	{ 1001,	60000,	32,	2 }
+};
+
+static const uint32_t	kLTCTestChannels	= 3;
+static const uint32_t	kLTCTestChannel		= 1;
+static const uint32_t	kLTCTestSeconds		= 4;
+
+static bool VerifyLTC(std::mt19937& random)
+{
+	std::uniform_int_distribution<uint32_t>	randomPacket(1, 4000);
+	bool									verified = true;
+
+	for (const LTCTest& test : kLTCTests)
+	{
+		const uint32_t			sampleBytes		= test.sampleDepth / 8;
+		const uint32_t			sampleCount		= 48000 * kLTCTestSeconds;
+		LTCEncoder				encoder(test.frameDuration, test.timeScale);
+		LTCDecoder				decoder(kLTCTestChannels, test.sampleDepth, kLTCTestChannel);
+		BMDTimeValue			ltcFrameDuration	= test.frameDuration * ((test.timeScale / test.frameDuration > 30) ? 2 : 1);
+		double					samplesPerFrame		= 48000.0 * ltcFrameDuration / test.timeScale;
+		uint64_t				startFrame			= (uint64_t)encoder.GetFramesPerSecond() * 58;
+		std::vector<uint8_t>	audio((size_t)(sampleCount + test.delay) * kLTCTestChannels * sampleBytes, 0x5A);
+		std::vector<uint8_t>	reference(audio);
+		BurnInTimecode			expected;
+		LTCTimecode				start;
+		LTCFrame				frame;
+		uint64_t				frameIndex		= 0;
+		double					maxPhaseError	= 0.0;
+		const char*				failure			= NULL;
+
+		// Silence on the LTC channel before the LTC
+		for (uint32_t i = 0; i < test.delay; i++)
+			memset(&audio[((size_t)i * kLTCTestChannels + kLTCTestChannel) * sampleBytes], 0, sampleBytes);
+
+		ComputeTimecode(startFrame, ltcFrameDuration, test.timeScale, expected);
+		start = { expected.hours, expected.minutes, expected.seconds, expected.frames, false, 0x12345678 };
+		encoder.Reset(start);
+
+		// Encode and decode in packets of random lengths
+		for (uint32_t offset = 0; offset < sampleCount; )
+		{
+			uint32_t	count = std::min(randomPacket(random), sampleCount - offset);
+			uint8_t*	packet = &audio[(size_t)(offset + test.delay) * kLTCTestChannels * sampleBytes];
+
+			encoder.Encode(packet, count, kLTCTestChannels, kLTCTestChannel, test.sampleDepth);
+			decoder.Decode(packet, count, offset + test.delay);
+			offset += count;
+
+			while (decoder.GetFrame(frame) && (failure == NULL))
+			{
+				ComputeTimecode(startFrame + frameIndex, ltcFrameDuration, test.timeScale, expected);
+
+				if ((frame.timecode.hours != expected.hours) || (frame.timecode.minutes != expected.minutes) ||
+					(frame.timecode.seconds != expected.seconds) || (frame.timecode.frames != expected.frames) ||
+					(frame.timecode.dropFrame != expected.dropFrame) || (frame.timecode.userBits != start.userBits))
+					failure = "timecode does not match";
+
+				maxPhaseError = std::max(maxPhaseError, fabs(frame.startTime - test.delay - frameIndex * samplesPerFrame));
+				maxPhaseError = std::max(maxPhaseError, fabs(frame.duration - samplesPerFrame));
+				frameIndex++;
+			}
+		}
+
+		// The last word is not decoded, its end is the start of the next word
+		if ((failure == NULL) && (frameIndex + 1 < (uint64_t)(sampleCount / samplesPerFrame)))
+			failure = "frames were not decoded";
+
+		// Word starts are exact but for the rounding of samples
+		if ((failure == NULL) && (maxPhaseError > 0.01))
+			failure = "word start times are not exact";
+
+		for (size_t i = 0; (failure == NULL) && (i < (size_t)(sampleCount + test.delay) * kLTCTestChannels); i++)
+		{
+			if (((i % kLTCTestChannels) != kLTCTestChannel) && (memcmp(&audio[i * sampleBytes], &reference[i * sampleBytes], sampleBytes) != 0))
+				failure = "other channels were changed";
+		}
+
+		if (failure != NULL)
+		{
+			fprintf(stderr, "LTC at %g fps, %u bit: %s after %llu frames, phase error %.3f samples\n", (double)test.timeScale / test.frameDuration,
+					test.sampleDepth, failure, (unsigned long long)frameIndex, maxPhaseError);
+			verified = false;
+		}
+	}
+
+	return verified;
+}
+
+// Encoding and decoding a second of LTC in 16 channel 32-bit audio, in packets of a frame
+static void BenchmarkLTC(int iterations)
+{
+	static const uint32_t	kChannels	= 16;
+	static const uint32_t	kPacket		= 1601;
+
+	std::vector<int32_t>	audio((size_t)48000 * kChannels);
+
+	for (auto rate : { std::make_pair(1001, 30000), std::make_pair(1000, 25000) })
+	{
+		LTCEncoder	encoder(rate.first, rate.second);
+		LTCDecoder	decoder(kChannels, 32, 0);
+		LTCFrame	frame;
+		uint32_t	frames		= 0;
+		double		encodeTime	= 0.0;
+		double		decodeTime	= 0.0;
+
+		for (int i = 0; i < iterations; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			for (uint32_t offset = 0; offset < 48000; offset += kPacket)
+				encoder.Encode(&audio[(size_t)offset * kChannels], std::min(kPacket, 48000 - offset), kChannels, 0, 32);
+
+			auto encoded = std::chrono::steady_clock::now();
+
+			for (uint32_t offset = 0; offset < 48000; offset += kPacket)
+			{
+				decoder.Decode(&audio[(size_t)offset * kChannels], std::min(kPacket, 48000 - offset), (BMDTimeValue)i * 48000 + offset);
+
+				while (decoder.GetFrame(frame))
+					frames++;
+			}
+
+			auto decoded = std::chrono::steady_clock::now();
+
+			encodeTime += std::chrono::duration<double>(encoded - start).count();
+			decodeTime += std::chrono::duration<double>(decoded - encoded).count();
+		}
+
+		printf("  %5.2f fps encode %7.1f us/s decode %7.1f us/s, %u frames decoded\n", (double)rate.second / rate.first,
+			   encodeTime * 1000000.0 / iterations, decodeTime * 1000000.0 / iterations, frames);
+	}
+}
+
+// Captions are encoded as the ClosedCaptions sample sends them, with the caption text changed every second
+struct CaptionTest
+{
+	uint32_t		frameDuration;
+	uint32_t		timeScale;
+};
+
+static const CaptionTest	kCaptionTests[] =
+{
+	{ 1000,	24000 },
+	{ 1000,	25000 },
+	{ 1001,	30000 }
+};
+
+static const uint32_t	kCaptionTestSeconds	= 8;
+
+class CaptionTestListener : public CEA708::DecoderListener, public CEA608::DecoderListener
+{
+public:
+	uint32_t	changes = 0;
+	uint32_t	cea608Changes = 0;
+
+	void captionsChanged(uint8_t serviceNumber, const CEA708::ServiceDecoder& service) override
+	{
+		changes++;
+	}
+
+	void captionsChanged(CEA608::Channel channel, const CEA608::Decoder& decoder) override
+	{
+		cea608Changes++;
+	}
+};
+
+static void EncodeCaptionTestScript(CEA708::Encoder& cc, uint32_t second)
+{
+	using namespace CEA708;
+
+	char	text[32];
+
+	cc << DeleteWindows();
+	cc << DefineWindow(window_0, priority_Highest, anchor_BottomCenter, false, 27, 44, 2, 22, true, true, true, windowStyle_NTSCPopup, penStyle_NTSCProportionalSans);
+	cc << SetWindowAttributes(justify_Left, printDirection_LeftToRight, scrollDirection_BottomToTop, false, displayEffect_Snap, effectDirection_LeftToRight, 0, colour_Black, opacity_Translucent, borderType_None, colour_Black);
+	cc << SetPenLocation(0, 0) << "\r";
+
+	cc << SetPenAttributes(penSize_Standard, font_ProportionalSans, textTag_Dialog, textOffset_Normal, true, false, edgeType_None);
+	snprintf(text, sizeof(text), "Caption second %u", second);
+	cc << SetPenLocation(0, 0) << text;
+	cc << SetPenLocation(1, 0) << "Caf\xE9 \x7F";
+	cc << EndOfText();
+
+	cc << DisplayWindows(1 << window_0);
+	cc.flush();
+
+	// The same pop-on caption on CC1, 0x5C is an e acute in the CEA-608 character set
+	snprintf(text, sizeof(text), "Caption 608 second %u", second);
+	cc.push608(CEA608::ResumeCaptionLoading(CEA608::channel_CC1));
+	cc.push608(CEA608::EraseNonDisplayedMemory(CEA608::channel_CC1));
+	cc.push608(CEA608::PreambleAddress(CEA608::channel_CC1, 14, 0, false));
+	cc.push608(CEA608::channel_CC1, text);
+	cc.push608(CEA608::PreambleAddress(CEA608::channel_CC1, 15, 0, false));
+	cc.push608(CEA608::channel_CC1, "Caf\x5C");
+	cc.push608(CEA608::EndOfCaption(CEA608::channel_CC1));
+}
+
+// Captions are decoded from the CEA-708 encoder, the decoded window and CEA-608 rows are checked before the next
+// captions, and CDPs are corrupted in the third second to check that the decoder discards them and recovers
+static bool VerifyCaptions(std::mt19937& random)
+{
+	std::uniform_int_distribution<uint32_t>	randomByte(0, 255);
+	bool									verified = true;
+
+	for (const CaptionTest& test : kCaptionTests)
+	{
+		const uint32_t								framesPerSecond = (test.timeScale + test.frameDuration - 1) / test.frameDuration;
+		CEA708::Encoder								encoder(test.frameDuration, test.timeScale, true);
+		CaptionTestListener							listener;
+		CEA608::Decoder								cea608Decoder(&listener, CEA608::channel_CC1);
+		CEA708::Decoder								decoder(&listener, 1 << CEA708::serviceNumber_PrimaryCaptionService, &cea608Decoder);
+		CEA708::EncodedCaptionDistributionPacket	packet;
+		uint64_t									corrupted = 0;
+		const char*									failure = NULL;
+		uint32_t									frame;
+
+		for (frame = 0; (failure == NULL) && (frame < framesPerSecond * kCaptionTestSeconds); frame++)
+		{
+			const uint32_t	second = frame / framesPerSecond;
+
+			if ((frame % framesPerSecond) == 0)
+				EncodeCaptionTestScript(encoder, second);
+
+			if (encoder.empty())
+				encoder.flush();
+
+			encoder.pop(&packet);
+
+			if (second == 2)
+			{
+				// Any change to one byte fails the checksum
+				packet[std::uniform_int_distribution<size_t>(0, packet.size() - 1)(random)] ^= (uint8_t)(randomByte(random) | 1);
+				corrupted++;
+
+				if (decoder.decode(packet.data(), packet.size()))
+					failure = "corrupted CDP was decoded";
+				continue;
+			}
+
+			if (!decoder.decode(packet.data(), packet.size()))
+				failure = "CDP was not decoded";
+			else if (((frame + 1) % framesPerSecond) == 0)
+			{
+				const CEA708::ServiceDecoder&	service = decoder.service(CEA708::serviceNumber_PrimaryCaptionService);
+				const CEA708::DecodedWindow&	window = service.window(CEA708::window_0);
+				char							expected[32];
+				char							expected608[32];
+				char							firstRow[64];
+				char							secondRow[64];
+				char							row14[CEA608::Decoder::kColumns * 3 + 1];
+				char							row15[CEA608::Decoder::kColumns * 3 + 1];
+
+				snprintf(expected, sizeof(expected), "Caption second %u", second);
+				snprintf(expected608, sizeof(expected608), "Caption 608 second %u", second);
+				service.rowText(CEA708::window_0, 0, firstRow, sizeof(firstRow));
+				service.rowText(CEA708::window_0, 1, secondRow, sizeof(secondRow));
+				cea608Decoder.rowText(13, row14, sizeof(row14));
+				cea608Decoder.rowText(14, row15, sizeof(row15));
+
+				if (!window.defined || !window.visible || window.rowCount != 3 || window.columnCount != 23 || window.anchorPoint != CEA708::anchor_BottomCenter)
+					failure = "window definition";
+				else if (window.fillOpacity != CEA708::opacity_Translucent || window.pen.font != CEA708::font_ProportionalSans || !window.pen.italic)
+					failure = "window or pen attributes";
+				else if (strcmp(firstRow, expected) != 0)
+					failure = "first row text";
+				else if (strcmp(secondRow, "Caf\xC3\xA9 \xE2\x99\xAA") != 0)
+					failure = "second row text";
+				else if (decoder.frameRate() == CEA708::cdpFrameRate_Forbidden)
+					failure = "CDP frame rate";
+				else if (cea608Decoder.mode() != CEA608::Decoder::mode_PopOn || strcmp(row14, expected608) != 0)
+					failure = "CEA-608 row 14 text";
+				else if (strcmp(row15, "Caf\xC3\xA9") != 0)
+					failure = "CEA-608 row 15 text";
+			}
+		}
+
+		const CEA708::DecoderStatistics&	statistics = decoder.statistics();
+		const CEA608::DecoderStatistics&	statistics608 = cea608Decoder.statistics();
+
+		// Field 1 carries 29.97 pairs per second at 29.97 fps, and 30 per second at the other rates
+		const double	expected608Pairs = (double)(frame - corrupted) * 30.0 * (test.frameDuration == 1001 ? 1000 : test.frameDuration) / test.timeScale;
+
+		if ((failure == NULL) && (statistics.cdpErrors != corrupted || statistics.cdpDiscontinuities != 1 ||
+								  statistics.cdps + corrupted != frame || listener.changes < kCaptionTestSeconds - 1))
+			failure = "decoder statistics";
+		else if ((failure == NULL) && (fabs((double)statistics608.pairs - expected608Pairs) > 2.0 || statistics608.parityErrors != 0 ||
+									   listener.cea608Changes < kCaptionTestSeconds - 1))
+			failure = "CEA-608 decoder statistics";
+
+		if (failure != NULL)
+		{
+			fprintf(stderr, "Captions at %g fps: %s at frame %u\n", (double)test.timeScale / test.frameDuration, failure, frame - 1);
+			verified = false;
+		}
+	}
+
+	// Random service blocks must not leave the window state out of range
+	CEA708::ServiceDecoder	service;
+	uint8_t					block[31];
+
+	for (uint32_t i = 0; verified && i < 100000; i++)
+	{
+		uint8_t blockLength = (uint8_t)(randomByte(random) % 32);
+
+		for (uint8_t j = 0; j < blockLength; j++)
+			block[j] = (uint8_t)randomByte(random);
+
+		service.push(block, blockLength);
+
+		for (uint8_t w = 0; w < 8; w++)
+		{
+			const CEA708::DecodedWindow& window = service.window(w);
+
+			if (window.defined && (window.rowCount > CEA708::DecodedWindow::kMaxRows || window.columnCount > CEA708::DecodedWindow::kMaxColumns ||
+								   window.penRow >= window.rowCount || window.penColumn > window.columnCount))
+			{
+				fprintf(stderr, "Captions: window %u state out of range after random service block %u\n", w, i);
+				verified = false;
+				break;
+			}
+		}
+	}
+
+	// Random pairs must not leave the CEA-608 cursor or rows out of range
+	CEA608::Decoder	cea608Decoder(NULL, CEA608::channel_CC1);
+	char			row[CEA608::Decoder::kColumns * 3 + 1];
+
+	for (uint32_t i = 0; verified && i < 100000; i++)
+	{
+		cea608Decoder.push(CEA608::field_1, CEA608::AddOddParity((uint8_t)randomByte(random)), CEA608::AddOddParity((uint8_t)randomByte(random)));
+
+		for (uint8_t r = 0; r < CEA608::Decoder::kRows; r++)
+		{
+			if (cea608Decoder.rowText(r, row, sizeof(row)) != strlen(row))
+			{
+				fprintf(stderr, "Captions: CEA-608 row %u out of range after random pair %u\n", r, i);
+				verified = false;
+				break;
+			}
+		}
+	}
+
+	return verified;
+}
+
+// Decoding a second of captions, which change every second
+static void BenchmarkCaptions(int iterations)
+{
+	for (const CaptionTest& test : kCaptionTests)
+	{
+		const uint32_t										framesPerSecond = (test.timeScale + test.frameDuration - 1) / test.frameDuration;
+		CEA708::Encoder										encoder(test.frameDuration, test.timeScale, true);
+		CEA608::Decoder										cea608Decoder(NULL, CEA608::channel_CC1);
+		CEA708::Decoder										decoder(NULL, 1 << CEA708::serviceNumber_PrimaryCaptionService, &cea608Decoder);
+		std::vector<CEA708::EncodedCaptionDistributionPacket>	packets(framesPerSecond);
+		double												decodeTime = 0.0;
+
+		EncodeCaptionTestScript(encoder, 0);
+
+		for (CEA708::EncodedCaptionDistributionPacket& packet : packets)
+		{
+			if (encoder.empty())
+				encoder.flush();
+			encoder.pop(&packet);
+		}
+
+		for (int i = 0; i < iterations; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			for (const CEA708::EncodedCaptionDistributionPacket& packet : packets)
+				decoder.decode(packet.data(), packet.size());
+
+			decodeTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		printf("  %5.2f fps decode %7.2f us/s, %6.3f us per CDP\n", (double)test.timeScale / test.frameDuration,
+			   decodeTime * 1000000.0 / iterations, decodeTime * 1000000.0 / ((double)iterations * framesPerSecond));
+	}
+}
+
+static void DisplayUsage(void)
+{
+	fprintf(stderr,
+		"Usage: VideoKernelsBenchmark [OPTIONS]\n"
+		"\n"
+		"    -w <width>        Frame width (default 1920 and 3840)\n"
+		"    -h <height>       Frame height (default 1080 and 2160)\n"
+		"    -n <iterations>   Number of frames converted by each kernel (default 200)\n"
+		"    -c <iterations>   Number of frames converted between each pair of pixel formats (default 20)\n"
+		"    -t <threads>      Video conversion, scaling, deinterlacing, tone mapping, 3D LUT, 3D packing and animated pattern threads (default the\n"
+		"                      number of CPUs)\n"
+		"    -s                Skip verification against the scalar kernels, of the video conversion, scaler, deinterlacer, tone mapper, 3D LUT processor\n"
+		"                      stereoscopic 3D packer, pattern cache, animated patterns and text overlay\n"
+	);
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::pair<uint32_t, uint32_t>>	frameSizes		= { { 1920, 1080 }, { 3840, 2160 } };
+	uint32_t									width			= 0;
+	uint32_t									height			= 0;
+	int											iterations		= 200;
+	int											conversions		= 20;
+	unsigned									threadCount		= 0;
+	bool										verify			= true;
+	bool										verified		= true;
+	std::mt19937								random(1);
+	int											ch;
+
+	while ((ch = getopt(argc, argv, "w:h:n:c:t:s?")) != -1)
+	{
+		switch (ch)
+		{
+			case 'w':
+				width = atoi(optarg);
+				break;
+			case 'h':
+				height = atoi(optarg);
+				break;
+			case 'n':
+				iterations = atoi(optarg);
+				break;
+			case 'c':
+				conversions = atoi(optarg);
+				break;
+			case 't':
+				threadCount = atoi(optarg);
+				break;
+			case 's':
+				verify = false;
+				break;
+			case '?':
+			default:
+				DisplayUsage();
+				return 1;
+		}
+	}
+
+	if ((width != 0) || (height != 0))
+	{
+		if ((width == 0) || (height == 0) || (iterations <= 0) || (conversions <= 0))
+		{
+			DisplayUsage();
+			return 1;
+		}
+		frameSizes = { { width, height } };
+	}
+
+	printf("Default implementation: %s\n", GetVideoKernelsISAName(GetVideoKernelsISA()));
+
+	for (int isa = kVideoKernelsISAScalar + 1; (isa < kVideoKernelsISACount) && verify; isa++)
+	{
+		if (!IsVideoKernelsISASupported((VideoKernelsISA)isa))
+			continue;
+
+		bool matched = true;
+
+		// Cover every remainder of the SIMD loops and the 2vuy chunk size
+		for (uint32_t testWidth = 1; testWidth <= 100; testWidth++)
+			matched &= VerifyKernels((VideoKernelsISA)isa, testWidth, 4, random);
+		for (uint32_t testWidth : { 720u, 767u, 769u, 1280u, 1918u, 1919u, 1920u, 2048u, 4096u })
+			matched &= VerifyKernels((VideoKernelsISA)isa, testWidth, 2, random);
+
+		printf("%s kernels %s scalar kernels\n", GetVideoKernelsISAName((VideoKernelsISA)isa), matched ? "match" : "DO NOT MATCH");
+		verified &= matched;
+	}
+
+	if (verify)
+	{
+		bool matched = true;
+
+		verified &= VerifyColorimetryAccuracy(random);
+
+		for (auto& testSize : std::vector<std::pair<uint32_t, uint32_t>>{ { 7, 5 }, { 97, 9 }, { 721, 13 }, { 1920, 20 } })
+			matched &= VerifyCompositor(testSize.first, testSize.second, random);
+
+		printf("Keying compositor %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	for (auto& frameSize : frameSizes)
+	{
+		printf("\n%ux%u, %d frames\n", frameSize.first, frameSize.second, iterations);
+
+		for (int isa = kVideoKernelsISAScalar; isa < kVideoKernelsISACount; isa++)
+		{
+			if (IsVideoKernelsISASupported((VideoKernelsISA)isa))
+				BenchmarkKernels((VideoKernelsISA)isa, frameSize.first, frameSize.second, iterations, random);
+		}
+
+		BenchmarkCompositor(frameSize.first, frameSize.second, iterations, random);
+	}
+
+	if (verify)
+	{
+		bool matched = true;
+
+		// Odd widths and heights cover the 4:2:2 edge and partial R12 groups and slices
+		for (auto& testSize : std::vector<std::pair<uint32_t, uint32_t>>{ { 1, 1 }, { 7, 3 }, { 33, 5 }, { 721, 13 }, { 1920, 8 } })
+			matched &= VerifyConversions(testSize.first, testSize.second, random);
+
+		printf("\nVideo conversions %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	for (auto& frameSize : frameSizes)
+	{
+		printf("\n%ux%u video conversion, %d frames\n", frameSize.first, frameSize.second, conversions);
+		BenchmarkConversions(frameSize.first, frameSize.second, conversions, threadCount, random);
+	}
+
+	if (verify)
+	{
+		bool matched = true;
+
+		for (const ScalerTest& test : kScalerTests)
+			matched &= VerifyScaler(test, random);
+
+		printf("\nVideo scaler %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nLanczos3 scaling, %d frames\n", conversions);
+	BenchmarkScaler(conversions, threadCount, random);
+
+	if (verify)
+	{
+		bool matched = true;
+
+		for (const DeinterlacerTest& test : kDeinterlacerTests)
+			matched &= VerifyDeinterlacer(test, random);
+
+		printf("\nDeinterlacer %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nDouble rate deinterlacing, %d frames\n", conversions);
+	BenchmarkDeinterlacer(conversions, threadCount, random);
+
+	if (verify)
+	{
+		bool matched = VerifyToneMapper(random);
+
+		printf("\nTone mapper %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nTone mapping, %d frames\n", conversions);
+	BenchmarkToneMapper(conversions, threadCount, random);
+
+	if (verify)
+	{
+		bool matched = VerifyLUTProcessor(random);
+
+		printf("\n3D LUT processor %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\n33 point 3D LUT, %d frames\n", conversions);
+	BenchmarkLUTProcessor(conversions, threadCount, random);
+
+	if (verify)
+	{
+		bool matched = VerifyStereo3D(random);
+
+		printf("\nStereoscopic 3D packer %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nv210 stereoscopic 3D packing, %d frames\n", conversions);
+	BenchmarkStereo3D(conversions, threadCount, random);
+
+	if (verify)
+	{
+		bool matched = VerifyPatternCache();
+
+		printf("\nPattern cache %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nColour bars, %d frames\n", conversions);
+	BenchmarkPatternCache(conversions, threadCount);
+
+	if (verify)
+	{
+		bool matched = VerifyAnimatedPattern();
+
+		printf("\nAnimated patterns %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nAnimated patterns, %d frames\n", conversions);
+	BenchmarkAnimatedPattern(conversions, threadCount);
+
+	if (verify)
+	{
+		bool matched = VerifyTextOverlay(random);
+
+		printf("\nText overlay %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nTimecode burn-in, %d frames\n", iterations);
+	BenchmarkTextOverlay(iterations);
+
+	if (verify)
+	{
+		bool matched = VerifyAVSync();
+
+		printf("\nA/V sync analyzer %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nA/V sync analysis, %d frames\n", iterations);
+	BenchmarkAVSync(iterations);
+
+	if (verify)
+	{
+		bool matched = VerifyToneGenerator(random);
+
+		printf("\nTone generator %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nLine-up tone, %d seconds\n", conversions);
+	BenchmarkToneGenerator(conversions);
+
+	if (verify)
+	{
+		bool matched = VerifyLTC(random);
+
+		printf("\nLTC %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nLTC, %d seconds\n", conversions);
+	BenchmarkLTC(conversions);
+
+	if (verify)
+	{
+		bool matched = VerifyCaptions(random);
+
+		printf("\nCEA-708 and CEA-608 captions %s\n", matched ? "verified" : "FAILED VERIFICATION");
+		verified &= matched;
+	}
+
+	printf("\nCEA-708 and CEA-608 captions, %d seconds\n", conversions);
+	BenchmarkCaptions(conversions);
+
+	return verified ? 0 : 1;
+}
@@ -0,0 +1,638 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#if defined(__aarch64__)
+
+#include <algorithm>
+#include <arm_neon.h>
+#include "VideoKernelsPrivate.h"
+
+// The NEON kernels process one 6 pixel group per iteration with the same byte shuffles as the x86
+// kernels, using tbl which also selects zero for out of range indices.
+
+static inline uint16x8_t Shuffle(uint16x8_t value, const int8_t* mask)
+{
+	return vreinterpretq_u16_u8(vqtbl1q_u8(vreinterpretq_u8_u16(value), vreinterpretq_u8_s8(vld1q_s8(mask))));
+}
+
+static void UnpackV210RowNEON(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	const uint32x4_t	mask10 = vdupq_n_u32(0x3FF);
+	uint32_t			x;
+
+	// Each group writes 8 luma and 4 chroma samples, the last 2 and 1 are overwritten by the next group
+	for (x = 0; x + 8 <= width; x += 6)
+	{
+		uint32x4_t w	= vld1q_u32(v210Row + (x / 6) * 4);
+		uint16x8_t ab	= vcombine_u16(vmovn_u32(vandq_u32(w, mask10)), vmovn_u32(vandq_u32(vshrq_n_u32(w, 10), mask10)));
+		uint16x8_t cc	= vcombine_u16(vmovn_u32(vandq_u32(vshrq_n_u32(w, 20), mask10)), vdup_n_u16(0));
+
+		vst1q_u16(luma + x, vorrq_u16(Shuffle(ab, kV210LumaFromAB), Shuffle(cc, kV210LumaFromC)));
+		vst1_u16(cb + x / 2, vget_low_u16(vorrq_u16(Shuffle(ab, kV210CbFromAB), Shuffle(cc, kV210CbFromC))));
+		vst1_u16(cr + x / 2, vget_low_u16(vorrq_u16(Shuffle(ab, kV210CrFromAB), Shuffle(cc, kV210CrFromC))));
+	}
+
+	UnpackV210Scalar(v210Row, luma, cb, cr, x, width);
+}
+
+static void PackV210RowNEON(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t width)
+{
+	const uint16x8_t	mask10 = vdupq_n_u16(0x3FF);
+	uint32_t			x;
+
+	for (x = 0; x + 8 <= width; x += 6)
+	{
+		uint16x8_t l	= vandq_u16(vld1q_u16(luma + x), mask10);
+		uint16x8_t c	= vandq_u16(vcombine_u16(vld1_u16(cb + x / 2), vld1_u16(cr + x / 2)), mask10);
+		uint32x4_t a	= vreinterpretq_u32_u16(vorrq_u16(Shuffle(l, kV210AFromL), Shuffle(c, kV210AFromC)));
+		uint32x4_t b	= vreinterpretq_u32_u16(vorrq_u16(Shuffle(l, kV210BFromL), Shuffle(c, kV210BFromC)));
+		uint32x4_t hi	= vreinterpretq_u32_u16(vorrq_u16(Shuffle(l, kV210CFromL), Shuffle(c, kV210CFromC)));
+
+		vst1q_u32(v210Row + (x / 6) * 4, vorrq_u32(vorrq_u32(a, vshlq_n_u32(b, 10)), vshlq_n_u32(hi, 20)));
+	}
+
+	PackV210Scalar(luma, cb, cr, v210Row, x, width);
+}
+
+static void PlanarTo2vuyRowNEON(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t width)
+{
+	uint32_t x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		// Rounding narrow to 8 bits, saturating samples above 10 bits
+		uint8x16x2_t	uvy;
+		uint8x8x2_t		uv	= vzip_u8(vqrshrn_n_u16(vld1q_u16(cb + x / 2), 2), vqrshrn_n_u16(vld1q_u16(cr + x / 2), 2));
+
+		uvy.val[0] = vcombine_u8(uv.val[0], uv.val[1]);
+		uvy.val[1] = vcombine_u8(vqrshrn_n_u16(vld1q_u16(luma + x), 2), vqrshrn_n_u16(vld1q_u16(luma + x + 8), 2));
+		vst2q_u8(yuvRow + x * 2, uvy);
+	}
+
+	PlanarTo2vuyScalar(luma, cb, cr, yuvRow, x, width);
+}
+
+static void Unpack2vuyRowNEON(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	uint32_t x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		uint8x16x2_t	uvy	= vld2q_u8(yuvRow + x * 2);
+		uint8x8x2_t		uv	= vuzp_u8(vget_low_u8(uvy.val[0]), vget_high_u8(uvy.val[0]));
+
+		vst1q_u16(luma + x, vshll_n_u8(vget_low_u8(uvy.val[1]), 2));
+		vst1q_u16(luma + x + 8, vshll_n_u8(vget_high_u8(uvy.val[1]), 2));
+		vst1q_u16(cb + x / 2, vshll_n_u8(uv.val[0], 2));
+		vst1q_u16(cr + x / 2, vshll_n_u8(uv.val[1], 2));
+	}
+
+	Unpack2vuyScalar(yuvRow, luma, cb, cr, x, width);
+}
+
+static inline uint8x16_t LoadR12UnpackMask(const int8_t* mask, bool bigEndian)
+{
+	return veorq_u8(vreinterpretq_u8_s8(vld1q_s8(mask)), vdupq_n_u8(bigEndian ? 3 : 0));
+}
+
+static inline uint8x16_t LoadR12PackMask(const int8_t* mask, bool bigEndian)
+{
+	static const uint8_t	kSwapWords[16]	= { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+	uint8x16_t				littleEndian	= vreinterpretq_u8_s8(vld1q_s8(mask));
+
+	return bigEndian ? vqtbl1q_u8(littleEndian, vld1q_u8(kSwapWords)) : littleEndian;
+}
+
+static inline uint16x8_t ShuffleR12(uint8x16_t l0, uint8x16_t l1, uint8x16_t l2, uint8x16_t m0, uint8x16_t m1, uint8x16_t m2)
+{
+	return vreinterpretq_u16_u8(vorrq_u8(vorrq_u8(vqtbl1q_u8(l0, m0), vqtbl1q_u8(l1, m1)), vqtbl1q_u8(l2, m2)));
+}
+
+static void UnpackR12RowNEON(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian)
+{
+	static const uint16_t	kOddLanes[8]	= { 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF };
+	const uint16x8_t		oddLanes		= vld1q_u16(kOddLanes);
+	const uint16x8_t		mask12			= vdupq_n_u16(0xFFF);
+	const uint8x16_t		r0				= LoadR12UnpackMask(kR12RedFromLoad0, bigEndian);
+	const uint8x16_t		r1				= LoadR12UnpackMask(kR12RedFromLoad1, bigEndian);
+	const uint8x16_t		r2				= LoadR12UnpackMask(kR12RedFromLoad2, bigEndian);
+	const uint8x16_t		g0				= LoadR12UnpackMask(kR12GreenFromLoad0, bigEndian);
+	const uint8x16_t		g1				= LoadR12UnpackMask(kR12GreenFromLoad1, bigEndian);
+	const uint8x16_t		g2				= LoadR12UnpackMask(kR12GreenFromLoad2, bigEndian);
+	const uint8x16_t		b0				= LoadR12UnpackMask(kR12BlueFromLoad0, bigEndian);
+	const uint8x16_t		b1				= LoadR12UnpackMask(kR12BlueFromLoad1, bigEndian);
+	const uint8x16_t		b2				= LoadR12UnpackMask(kR12BlueFromLoad2, bigEndian);
+	uint32_t				x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		const uint8_t*	group	= r12Row + (x / 8) * 36;
+		uint8x16_t		l0		= vld1q_u8(group);
+		uint8x16_t		l1		= vld1q_u8(group + 12);
+		uint8x16_t		l2		= vld1q_u8(group + 20);
+		uint16x8_t		r		= ShuffleR12(l0, l1, l2, r0, r1, r2);
+		uint16x8_t		g		= ShuffleR12(l0, l1, l2, g0, g1, g2);
+		uint16x8_t		b		= ShuffleR12(l0, l1, l2, b0, b1, b2);
+
+		vst1q_u16(red + x, vbslq_u16(oddLanes, vshrq_n_u16(r, 4), vandq_u16(r, mask12)));
+		vst1q_u16(green + x, vbslq_u16(oddLanes, vandq_u16(g, mask12), vshrq_n_u16(g, 4)));
+		vst1q_u16(blue + x, vbslq_u16(oddLanes, vshrq_n_u16(b, 4), vandq_u16(b, mask12)));
+	}
+
+	UnpackR12Scalar(r12Row, red, green, blue, x, width, bigEndian);
+}
+
+static void PackR12RowNEON(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t width, bool bigEndian)
+{
+	static const uint16_t	kOddLanes[8]	= { 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF };
+	const uint16x8_t		oddLanes		= vld1q_u16(kOddLanes);
+	const uint16x8_t		mask12			= vdupq_n_u16(0xFFF);
+	const uint8x16_t		r0				= LoadR12PackMask(kR12Chunk0FromRed, bigEndian);
+	const uint8x16_t		g0				= LoadR12PackMask(kR12Chunk0FromGreen, bigEndian);
+	const uint8x16_t		b0				= LoadR12PackMask(kR12Chunk0FromBlue, bigEndian);
+	const uint8x16_t		r1				= LoadR12PackMask(kR12Chunk1FromRed, bigEndian);
+	const uint8x16_t		g1				= LoadR12PackMask(kR12Chunk1FromGreen, bigEndian);
+	const uint8x16_t		b1				= LoadR12PackMask(kR12Chunk1FromBlue, bigEndian);
+	const uint8x16_t		r2				= LoadR12PackMask(kR12Chunk2FromRed, bigEndian);
+	const uint8x16_t		g2				= LoadR12PackMask(kR12Chunk2FromGreen, bigEndian);
+	const uint8x16_t		b2				= LoadR12PackMask(kR12Chunk2FromBlue, bigEndian);
+	uint32_t				x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		uint8_t*	group	= r12Row + (x / 8) * 36;
+		uint16x8_t	r		= vandq_u16(vld1q_u16(red + x), mask12);
+		uint16x8_t	g		= vandq_u16(vld1q_u16(green + x), mask12);
+		uint16x8_t	b		= vandq_u16(vld1q_u16(blue + x), mask12);
+		uint8x16_t	rb		= vreinterpretq_u8_u16(vbslq_u16(oddLanes, vshlq_n_u16(r, 4), r));
+		uint8x16_t	gb		= vreinterpretq_u8_u16(vbslq_u16(oddLanes, g, vshlq_n_u16(g, 4)));
+		uint8x16_t	bb		= vreinterpretq_u8_u16(vbslq_u16(oddLanes, vshlq_n_u16(b, 4), b));
+
+		vst1q_u8(group, vorrq_u8(vorrq_u8(vqtbl1q_u8(rb, r0), vqtbl1q_u8(gb, g0)), vqtbl1q_u8(bb, b0)));
+		vst1q_u8(group + 16, vorrq_u8(vorrq_u8(vqtbl1q_u8(rb, r1), vqtbl1q_u8(gb, g1)), vqtbl1q_u8(bb, b1)));
+		vst1q_lane_u32((uint32_t*)(group + 32), vreinterpretq_u32_u8(vorrq_u8(vorrq_u8(vqtbl1q_u8(rb, r2), vqtbl1q_u8(gb, g2)), vqtbl1q_u8(bb, b2))), 0);
+	}
+
+	PackR12Scalar(red, green, blue, r12Row, x, width, bigEndian);
+}
+
+// Byte swap 4 r210 words and extract the 10-bit components, two loads are narrowed to 8 samples of each plane
+static void UnpackR210RowNEON(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width)
+{
+	const uint32x4_t	mask10	= vdupq_n_u32(0x3FF);
+	uint32_t			x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		uint32x4_t w0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8((const uint8_t*)(r210Row + x))));
+		uint32x4_t w1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8((const uint8_t*)(r210Row + x + 4))));
+
+		vst1q_u16(red + x, vcombine_u16(vmovn_u32(vandq_u32(vshrq_n_u32(w0, 20), mask10)), vmovn_u32(vandq_u32(vshrq_n_u32(w1, 20), mask10))));
+		vst1q_u16(green + x, vcombine_u16(vmovn_u32(vandq_u32(vshrq_n_u32(w0, 10), mask10)), vmovn_u32(vandq_u32(vshrq_n_u32(w1, 10), mask10))));
+		vst1q_u16(blue + x, vcombine_u16(vmovn_u32(vandq_u32(w0, mask10)), vmovn_u32(vandq_u32(w1, mask10))));
+	}
+
+	UnpackR210Scalar(r210Row, red, green, blue, x, width);
+}
+
+static void CompositeRowNEON(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		uint16x8_t	bg		= vld1q_u16(background + i);
+		uint16x8_t	key		= vld1q_u16(inverseKey + i);
+		uint16x4_t	lo		= vrshrn_n_u32(vmull_u16(vget_low_u16(bg), vget_low_u16(key)), kKeyShift);
+		uint16x4_t	hi		= vrshrn_n_u32(vmull_u16(vget_high_u16(bg), vget_high_u16(key)), kKeyShift);
+		uint16x8_t	value	= vaddq_u16(vcombine_u16(lo, hi), vld1q_u16(fill + i));
+
+		vst1q_u16(output + i, vmaxq_u16(vminq_u16(value, vdupq_n_u16(kMaxYUVCode)), vdupq_n_u16(kMinYUVCode)));
+	}
+
+	CompositeScalar(background, fill, inverseKey, output, i, count);
+}
+
+static inline int32x4_t FilterTapsNEON(const uint16_t* taps, const int16_t* weights, uint32_t tapStride)
+{
+	int32x4_t sum = vdupq_n_s32(0);
+
+	for (uint32_t t = 0; t < tapStride; t += 8)
+	{
+		int16x8_t samples	= vreinterpretq_s16_u16(vld1q_u16(taps + t));
+		int16x8_t w			= vld1q_s16(weights + t);
+
+		sum = vmlal_s16(sum, vget_low_s16(samples), vget_low_s16(w));
+		sum = vmlal_s16(sum, vget_high_s16(samples), vget_high_s16(w));
+	}
+
+	return sum;
+}
+
+static inline uint16x8_t LimitFilterNEON(int32x4_t lo, int32x4_t hi, uint16_t minValue, uint16_t maxValue)
+{
+	uint16x8_t value = vcombine_u16(vqmovun_s32(vrshrq_n_s32(lo, kFilterCoefficientShift)), vqmovun_s32(vrshrq_n_s32(hi, kFilterCoefficientShift)));
+
+	return vmaxq_u16(vminq_u16(value, vdupq_n_u16(maxValue)), vdupq_n_u16(minValue));
+}
+
+static void FilterRowHorizontalNEON(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+									uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		const int16_t*	weights = coefficients + (size_t)i * tapStride;
+		int32x4_t		sum[8];
+
+		for (uint32_t j = 0; j < 8; j++)
+			sum[j] = FilterTapsNEON(source + offsets[i + j], weights + j * tapStride, tapStride);
+
+		int32x4_t lo = vpaddq_s32(vpaddq_s32(sum[0], sum[1]), vpaddq_s32(sum[2], sum[3]));
+		int32x4_t hi = vpaddq_s32(vpaddq_s32(sum[4], sum[5]), vpaddq_s32(sum[6], sum[7]));
+
+		vst1q_u16(output + i, LimitFilterNEON(lo, hi, minValue, maxValue));
+	}
+
+	FilterHorizontalScalar(source, offsets, coefficients, tapStride, output, i, count, minValue, maxValue);
+}
+
+static void FilterRowsVerticalNEON(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+								   uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		int32x4_t lo = vdupq_n_s32(0);
+		int32x4_t hi = vdupq_n_s32(0);
+
+		for (uint32_t t = 0; t < tapCount; t++)
+		{
+			int16x8_t samples = vreinterpretq_s16_u16(vld1q_u16(sourceRows[t] + i));
+
+			lo = vmlal_n_s16(lo, vget_low_s16(samples), coefficients[t]);
+			hi = vmlal_n_s16(hi, vget_high_s16(samples), coefficients[t]);
+		}
+
+		vst1q_u16(output + i, LimitFilterNEON(lo, hi, minValue, maxValue));
+	}
+
+	FilterVerticalScalar(sourceRows, coefficients, tapCount, output, i, count, minValue, maxValue);
+}
+
+static inline int16x8_t LoadSamplesNEON(const uint16_t* samples)
+{
+	return vreinterpretq_s16_u16(vld1q_u16(samples));
+}
+
+// Sum of differences between the rows above and below along direction j, over 3 sample pairs
+static inline int16x8_t DirectionScoreNEON(const uint16_t* above, const uint16_t* below, int j)
+{
+	int16x8_t score = vabdq_s16(LoadSamplesNEON(above + j - 1), LoadSamplesNEON(below - j - 1));
+
+	score = vabaq_s16(score, LoadSamplesNEON(above + j), LoadSamplesNEON(below - j));
+	return vabaq_s16(score, LoadSamplesNEON(above + j + 1), LoadSamplesNEON(below - j + 1));
+}
+
+static void DeinterlaceRowNEON(const DeinterlaceRows& rows, uint16_t* output, uint32_t count)
+{
+	// As the SSE4.1 kernel, halving adds give the averages
+	uint32_t i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		const uint16_t*	above			= rows.above + i;
+		const uint16_t*	below			= rows.below + i;
+		int16x8_t		c				= LoadSamplesNEON(above);
+		int16x8_t		e				= LoadSamplesNEON(below);
+		int16x8_t		earlier			= LoadSamplesNEON(rows.earlier + i);
+		int16x8_t		later			= LoadSamplesNEON(rows.later + i);
+		int16x8_t		d				= vhaddq_s16(earlier, later);
+		int16x8_t		temporalDiff0	= vshrq_n_s16(vabdq_s16(earlier, later), 1);
+		int16x8_t		temporalDiff1	= vhaddq_s16(vabdq_s16(LoadSamplesNEON(rows.previousAbove + i), c), vabdq_s16(LoadSamplesNEON(rows.previousBelow + i), e));
+		int16x8_t		temporalDiff2	= vhaddq_s16(vabdq_s16(LoadSamplesNEON(rows.nextAbove + i), c), vabdq_s16(LoadSamplesNEON(rows.nextBelow + i), e));
+		int16x8_t		diff			= vmaxq_s16(vmaxq_s16(temporalDiff0, temporalDiff1), temporalDiff2);
+		int16x8_t		spatialPred		= vhaddq_s16(c, e);
+		int16x8_t		spatialScore	= vsubq_s16(DirectionScoreNEON(above, below, 0), vdupq_n_s16(1));
+
+		for (int side = -1; side <= 1; side += 2)
+		{
+			uint16x8_t selected = vdupq_n_u16(0xFFFF);
+
+			for (int j = side; (j == side) || (j == side * 2); j += side)
+			{
+				int16x8_t score	= DirectionScoreNEON(above, below, j);
+				int16x8_t pred	= vhaddq_s16(LoadSamplesNEON(above + j), LoadSamplesNEON(below - j));
+
+				selected		= vandq_u16(selected, vcltq_s16(score, spatialScore));
+				spatialScore	= vbslq_s16(selected, score, spatialScore);
+				spatialPred		= vbslq_s16(selected, pred, spatialPred);
+			}
+		}
+
+		int16x8_t b		= vhaddq_s16(LoadSamplesNEON(rows.earlierAbove + i), LoadSamplesNEON(rows.laterAbove + i));
+		int16x8_t f		= vhaddq_s16(LoadSamplesNEON(rows.earlierBelow + i), LoadSamplesNEON(rows.laterBelow + i));
+		int16x8_t de	= vsubq_s16(d, e);
+		int16x8_t dc	= vsubq_s16(d, c);
+		int16x8_t bc	= vsubq_s16(b, c);
+		int16x8_t fe	= vsubq_s16(f, e);
+		int16x8_t max	= vmaxq_s16(vmaxq_s16(de, dc), vminq_s16(bc, fe));
+		int16x8_t min	= vminq_s16(vminq_s16(de, dc), vmaxq_s16(bc, fe));
+
+		diff = vmaxq_s16(vmaxq_s16(diff, min), vnegq_s16(max));
+
+		vst1q_u16(output + i, vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(spatialPred, vsubq_s16(d, diff)), vaddq_s16(d, diff))));
+	}
+
+	DeinterlaceScalar(rows, output, i, count);
+}
+
+static inline uint16x4_t LimitHalfBandNEON(int32x4_t sum, uint16x4_t minValue, uint16x4_t maxValue)
+{
+	return vmax_u16(vmin_u16(vqmovun_s32(vrshrq_n_s32(sum, kFilterCoefficientShift)), maxValue), minValue);
+}
+
+static void DecimateRowHorizontalNEON(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// 8 samples per iteration, ld2 deinterleaves the even centre taps and the odd taps around them
+	const uint16x4_t	min		= vdup_n_u16(minValue);
+	const uint16x4_t	max		= vdup_n_u16(maxValue);
+	uint32_t			i		= std::min(kHalfBandEdgeSamples, count);
+
+	DecimateHorizontalScalar(input, output, 0, i, count, minValue, maxValue);
+
+	for (; i + 8 + kHalfBandEdgeSamples <= count; i += 8)
+	{
+		const uint16_t*	pairs	= input + (size_t)i * 2;
+		uint16x8_t		centre	= vld2q_u16(pairs).val[0];
+		int32x4_t		lo		= vmulq_n_s32(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(centre))), kHalfBandCentre);
+		int32x4_t		hi		= vmulq_n_s32(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(centre))), kHalfBandCentre);
+
+		for (int t = 0; t < 3; t++)
+		{
+			uint16x8_t	before	= vld2q_u16(pairs - (t + 1) * 2).val[1];
+			uint16x8_t	after	= vld2q_u16(pairs + t * 2).val[1];
+
+			lo = vmlaq_n_s32(lo, vreinterpretq_s32_u32(vaddl_u16(vget_low_u16(before), vget_low_u16(after))), kHalfBandTaps[t]);
+			hi = vmlaq_n_s32(hi, vreinterpretq_s32_u32(vaddl_u16(vget_high_u16(before), vget_high_u16(after))), kHalfBandTaps[t]);
+		}
+
+		vst1q_u16(output + i, vcombine_u16(LimitHalfBandNEON(lo, min, max), LimitHalfBandNEON(hi, min, max)));
+	}
+
+	DecimateHorizontalScalar(input, output, i, count, count, minValue, maxValue);
+}
+
+static void InterpolateRowHorizontalNEON(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// 8 input samples per iteration, st2 interleaves them with the interpolated samples
+	const uint16x4_t	min		= vdup_n_u16(minValue);
+	const uint16x4_t	max		= vdup_n_u16(maxValue);
+	uint32_t			i		= std::min(kHalfBandEdgeSamples, count);
+
+	InterpolateHorizontalScalar(input, output, 0, i, count, minValue, maxValue);
+
+	for (; i + 8 + kHalfBandEdgeSamples <= count; i += 8)
+	{
+		int32x4_t	lo = vdupq_n_s32(0);
+		int32x4_t	hi = vdupq_n_s32(0);
+		uint16x8x2_t	interleaved;
+
+		for (int t = 0; t < 3; t++)
+		{
+			uint16x8_t	before	= vld1q_u16(input + i - t);
+			uint16x8_t	after	= vld1q_u16(input + i + 1 + t);
+
+			lo = vmlaq_n_s32(lo, vreinterpretq_s32_u32(vaddl_u16(vget_low_u16(before), vget_low_u16(after))), kHalfBandTaps[t] * 2);
+			hi = vmlaq_n_s32(hi, vreinterpretq_s32_u32(vaddl_u16(vget_high_u16(before), vget_high_u16(after))), kHalfBandTaps[t] * 2);
+		}
+
+		interleaved.val[0] = vld1q_u16(input + i);
+		interleaved.val[1] = vcombine_u16(LimitHalfBandNEON(lo, min, max), LimitHalfBandNEON(hi, min, max));
+		vst2q_u16(output + (size_t)i * 2, interleaved);
+	}
+
+	InterpolateHorizontalScalar(input, output, i, count, count, minValue, maxValue);
+}
+
+static void FilterRowsHalfBandNEON(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	const int32_t		scale	= (rows.centre != NULL) ? 1 : 2;
+	const uint16x4_t	min		= vdup_n_u16(minValue);
+	const uint16x4_t	max		= vdup_n_u16(maxValue);
+	uint32_t			i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		int32x4_t lo = vdupq_n_s32(0);
+		int32x4_t hi = vdupq_n_s32(0);
+
+		if (rows.centre != NULL)
+		{
+			uint16x8_t centre = vld1q_u16(rows.centre + i);
+
+			lo = vmulq_n_s32(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(centre))), kHalfBandCentre);
+			hi = vmulq_n_s32(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(centre))), kHalfBandCentre);
+		}
+
+		for (int t = 0; t < 3; t++)
+		{
+			uint16x8_t	above	= vld1q_u16(rows.above[t] + i);
+			uint16x8_t	below	= vld1q_u16(rows.below[t] + i);
+
+			lo = vmlaq_n_s32(lo, vreinterpretq_s32_u32(vaddl_u16(vget_low_u16(above), vget_low_u16(below))), kHalfBandTaps[t] * scale);
+			hi = vmlaq_n_s32(hi, vreinterpretq_s32_u32(vaddl_u16(vget_high_u16(above), vget_high_u16(below))), kHalfBandTaps[t] * scale);
+		}
+
+		vst1q_u16(output + i, vcombine_u16(LimitHalfBandNEON(lo, min, max), LimitHalfBandNEON(hi, min, max)));
+	}
+
+	HalfBandVerticalScalar(rows, output, i, count, minValue, maxValue);
+}
+
+static void RenderSinusoidRowNEON(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count)
+{
+	// 8 samples per iteration, ld2 deinterleaves the cosines and sines of the table
+	const int32x4_t	offsets	= vdupq_n_s32(offset);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		int16x8x2_t	pairs	= vld2q_s16(phases + (size_t)i * 2);
+		int32x4_t	lo		= vmlal_n_s16(vmull_n_s16(vget_low_s16(pairs.val[0]), cosine), vget_low_s16(pairs.val[1]), sine);
+		int32x4_t	hi		= vmlal_n_s16(vmull_n_s16(vget_high_s16(pairs.val[0]), cosine), vget_high_s16(pairs.val[1]), sine);
+
+		lo = vaddq_s32(vrshrq_n_s32(lo, kSinusoidShift), offsets);
+		hi = vaddq_s32(vrshrq_n_s32(hi, kSinusoidShift), offsets);
+
+		vst1q_u16(output + i, vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi)));
+	}
+
+	SinusoidScalar(phases, cosine, sine, offset, output, i, count);
+}
+
+static inline float32x4_t ToneSineNEON(uint32x4_t phases)
+{
+	// Evaluated as the scalar kernel, abs leaves a phase of exactly a half turn unchanged as the scalar fold does
+	const int32x4_t	quarterTurn	= vdupq_n_s32((int32_t)kToneQuarterTurn);
+	int32x4_t		folded		= vabsq_s32(vaddq_s32(vreinterpretq_s32_u32(phases), quarterTurn));
+	float32x4_t		x			= vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(folded, quarterTurn)), kTonePhaseScale);
+	float32x4_t		x2			= vmulq_f32(x, x);
+	float32x4_t		sum			= vdupq_n_f32(kToneSineCoefficients[5]);
+
+	for (int i = 4; i >= 0; i--)
+		sum = vaddq_f32(vmulq_f32(sum, x2), vdupq_n_f32(kToneSineCoefficients[i]));
+
+	return vmulq_f32(sum, x);
+}
+
+static void RenderToneFramesNEON(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount)
+{
+	uint32_t c;
+
+	if ((channels == 1) || (channels == 2))
+	{
+		// Each vector holds 4 / channels frames, lane j is channel j % channels of frame j / channels
+		const uint32_t	framesPerVector = 4 / channels;
+		uint32_t		lanePhases[4];
+		uint32_t		laneSteps[4];
+		float			laneLevels[4];
+		uint32_t		f;
+
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			lanePhases[j]	= phases[j % channels] + (j / channels) * increments[j % channels];
+			laneSteps[j]	= framesPerVector * increments[j % channels];
+			laneLevels[j]	= levels[j % channels];
+		}
+
+		uint32x4_t			phase	= vld1q_u32(lanePhases);
+		const uint32x4_t	step	= vld1q_u32(laneSteps);
+		const float32x4_t	level	= vld1q_f32(laneLevels);
+
+		for (f = 0; f + framesPerVector <= frameCount; f += framesPerVector)
+		{
+			vst1q_f32(output + (size_t)f * channels, vmulq_f32(level, ToneSineNEON(phase)));
+			phase = vaddq_u32(phase, step);
+		}
+
+		// The first lanes hold the phases of frame f
+		vst1q_u32(lanePhases, phase);
+		for (uint32_t j = 0; j < channels; j++)
+			phases[j] = lanePhases[j];
+
+		ToneScalar(phases, increments, levels, channels, output + (size_t)f * channels, 0, frameCount - f);
+		return;
+	}
+
+	// Otherwise each vector holds 4 channels of a frame
+	for (c = 0; c + 4 <= channels; c += 4)
+	{
+		uint32x4_t			phase	= vld1q_u32(phases + c);
+		const uint32x4_t	step	= vld1q_u32(increments + c);
+		const float32x4_t	level	= vld1q_f32(levels + c);
+
+		for (uint32_t f = 0; f < frameCount; f++)
+		{
+			vst1q_f32(output + (size_t)f * channels + c, vmulq_f32(level, ToneSineNEON(phase)));
+			phase = vaddq_u32(phase, step);
+		}
+
+		vst1q_u32(phases + c, phase);
+	}
+
+	ToneScalar(phases, increments, levels, channels, output, c, frameCount);
+}
+
+static void QuantizeAudioNEON(const float* input, void* output, uint32_t count, uint32_t sampleDepth)
+{
+	// 8 samples per iteration, fcvtns rounds to nearest even as lrintf does
+	const float32x4_t	scale	= vdupq_n_f32((sampleDepth == 32) ? kAudioScale32 : kAudioScale16);
+	const float32x4_t	min		= vdupq_n_f32((sampleDepth == 32) ? -kAudioScale32 : -kAudioScale16);
+	const float32x4_t	max		= vdupq_n_f32((sampleDepth == 32) ? kAudioMax32 : kAudioMax16);
+	uint32_t			i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		int32x4_t lo = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(input + i), scale), min), max));
+		int32x4_t hi = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(input + i + 4), scale), min), max));
+
+		if (sampleDepth == 32)
+		{
+			vst1q_s32((int32_t*)output + i, lo);
+			vst1q_s32((int32_t*)output + i + 4, hi);
+		}
+		else
+		{
+			vst1q_s16((int16_t*)output + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+		}
+	}
+
+	QuantizeAudioScalar(input, output, i, count, sampleDepth);
+}
+
+const VideoKernelTable kNEONVideoKernels =
+{
+	UnpackV210RowNEON,
+	PackV210RowNEON,
+	PlanarTo2vuyRowNEON,
+	Unpack2vuyRowNEON,
+	ConvertYUV422ToRGBRowScalar,
+	ConvertRGBToYUV422RowScalar,
+	UnpackR12RowNEON,
+	PackR12RowNEON,
+	UnpackR210RowNEON,
+	CompositeRowNEON,
+	FilterRowHorizontalNEON,
+	FilterRowsVerticalNEON,
+	DeinterlaceRowNEON,
+	ApplyLUT1DRowScalar,
+	ApplyLUT3DRowScalar,
+	DecimateRowHorizontalNEON,
+	InterpolateRowHorizontalNEON,
+	FilterRowsHalfBandNEON,
+	RenderSinusoidRowNEON,
+	RenderToneFramesNEON,
+	QuantizeAudioNEON
+};
+
+#endif
@@ -0,0 +1,302 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "VideoKernels.h"
+
+// Kernel implementations for one instruction set.  SIMD kernels process whole groups of pixels and
+// call the scalar kernels, which take the first pixel to process, for the remainder of the row.
+struct VideoKernelTable
+{
+	void	(*unpackV210)(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width);
+	void	(*packV210)(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t width);
+	// 2vuy kernels require an even width
+	void	(*planarTo2vuy)(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t width);
+	void	(*unpack2vuy)(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width);
+	void	(*yuv422ToRGB)(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+						   uint32_t width, const ColorimetryCoefficients& coefficients);
+	void	(*rgbToYUV422)(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+						   uint32_t width, const ColorimetryCoefficients& coefficients);
+	void	(*unpackR12)(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian);
+	void	(*packR12)(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t width, bool bigEndian);
+	void	(*unpackR210)(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width);
+	void	(*composite)(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count);
+	void	(*filterHorizontal)(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+								uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+	void	(*filterVertical)(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+							  uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+	void	(*deinterlace)(const DeinterlaceRows& rows, uint16_t* output, uint32_t count);
+	void	(*lut1D)(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut);
+	void	(*lut3D)(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+					 uint32_t count, const LUT3D& lut);
+	void	(*decimateHorizontal)(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+	void	(*interpolateHorizontal)(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+	void	(*halfBandVertical)(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+	void	(*sinusoid)(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count);
+	void	(*tone)(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount);
+	void	(*quantizeAudio)(const float* input, void* output, uint32_t count, uint32_t sampleDepth);
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+extern const VideoKernelTable kSSE41VideoKernels;
+extern const VideoKernelTable kAVX2VideoKernels;
+extern const VideoKernelTable kAVX512VideoKernels;
+
+// 2vuy conversion is bound by memory bandwidth at SSE4.1 width, so the AVX2 and AVX-512 tables share these
+void	PlanarTo2vuyRowSSE41(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t width);
+void	Unpack2vuyRowSSE41(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width);
+
+// The AVX-512 table shares the AVX2 colorimetry, 12-bit and 10-bit RGB, composite, filter, deinterlace, lookup table,
+// half-band, sinusoid, tone and audio quantize kernels
+void	UnpackR12RowAVX2(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian);
+void	PackR12RowAVX2(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t width, bool bigEndian);
+void	UnpackR210RowAVX2(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width);
+void	ConvertYUV422ToRGBRowAVX2(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+								  uint32_t width, const ColorimetryCoefficients& coefficients);
+void	ConvertRGBToYUV422RowAVX2(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+								  uint32_t width, const ColorimetryCoefficients& coefficients);
+void	CompositeRowAVX2(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count);
+void	FilterRowHorizontalAVX2(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+								uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+void	FilterRowsVerticalAVX2(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+							   uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+void	DeinterlaceRowAVX2(const DeinterlaceRows& rows, uint16_t* output, uint32_t count);
+void	ApplyLUT1DRowAVX2(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut);
+void	ApplyLUT3DRowAVX2(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+						  uint32_t count, const LUT3D& lut);
+void	DecimateRowHorizontalAVX2(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+void	InterpolateRowHorizontalAVX2(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+void	FilterRowsHalfBandAVX2(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue);
+void	RenderSinusoidRowAVX2(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count);
+void	RenderToneFramesAVX2(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount);
+void	QuantizeAudioAVX2(const float* input, void* output, uint32_t count, uint32_t sampleDepth);
+#endif
+
+// Table lookups need a gather instruction, so the SSE4.1 and NEON tables share the scalar lookup table kernels
+void	ApplyLUT1DRowScalar(const uint16_t* input, uint16_t* output, uint32_t count, const uint16_t* lut);
+void	ApplyLUT3DRowScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+							uint32_t count, const LUT3D& lut);
+
+#if defined(__aarch64__)
+extern const VideoKernelTable kNEONVideoKernels;
+
+// The NEON table shares the scalar colorimetry kernels
+void	ConvertYUV422ToRGBRowScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+									uint32_t width, const ColorimetryCoefficients& coefficients);
+void	ConvertRGBToYUV422RowScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+									uint32_t width, const ColorimetryCoefficients& coefficients);
+#endif
+
+// startPixel must be a multiple of 6 for v210 and 2 for 2vuy
+void	UnpackV210Scalar(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t startPixel, uint32_t width);
+void	PackV210Scalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t startPixel, uint32_t width);
+void	PlanarTo2vuyScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t startPixel, uint32_t width);
+void	Unpack2vuyScalar(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t startPixel, uint32_t width);
+
+// startPixel must be a multiple of 8
+void	UnpackR12Scalar(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t startPixel, uint32_t width, bool bigEndian);
+void	PackR12Scalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t startPixel, uint32_t width, bool bigEndian);
+
+// startPixel may be any pixel
+void	UnpackR210Scalar(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t startPixel, uint32_t width);
+
+// Reference colorimetry kernels, startPixel must be even
+void	ConvertYUV422ToRGBScalar(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+								 uint32_t startPixel, uint32_t width, const ColorimetryCoefficients& coefficients);
+void	ConvertRGBToYUV422Scalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+								 uint32_t startPixel, uint32_t width, const ColorimetryCoefficients& coefficients);
+
+// Reference composite kernel, startSample may be any sample
+void	CompositeScalar(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t startSample, uint32_t count);
+
+// Reference filter kernels, startSample may be any sample
+void	FilterHorizontalScalar(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+							   uint16_t* output, uint32_t startSample, uint32_t count, uint16_t minValue, uint16_t maxValue);
+void	FilterVerticalScalar(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+							 uint16_t* output, uint32_t startSample, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Reference deinterlace kernel, startSample may be any sample
+void	DeinterlaceScalar(const DeinterlaceRows& rows, uint16_t* output, uint32_t startSample, uint32_t count);
+
+// Reference lookup table kernels, startSample and startPixel may be any sample
+void	ApplyLUT1DScalar(const uint16_t* input, uint16_t* output, uint32_t startSample, uint32_t count, const uint16_t* lut);
+void	ApplyLUT3DScalar(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* outRed, uint16_t* outGreen, uint16_t* outBlue,
+						 uint32_t startPixel, uint32_t count, const LUT3D& lut);
+
+// Reference half-band kernels.  The horizontal kernels filter output samples startSample to endSample of a row of
+// count samples, so that SIMD kernels can filter the samples near the edges with them.
+void	DecimateHorizontalScalar(const uint16_t* input, uint16_t* output, uint32_t startSample, uint32_t endSample, uint32_t count,
+								 uint16_t minValue, uint16_t maxValue);
+void	InterpolateHorizontalScalar(const uint16_t* input, uint16_t* output, uint32_t startSample, uint32_t endSample, uint32_t count,
+									uint16_t minValue, uint16_t maxValue);
+void	HalfBandVerticalScalar(const HalfBandRows& rows, uint16_t* output, uint32_t startSample, uint32_t count, uint16_t minValue, uint16_t maxValue);
+
+// Reference sinusoid kernel, startSample may be any sample
+void	SinusoidScalar(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t startSample, uint32_t count);
+
+// Reference tone kernel, renders channels startChannel to channels of each frame.  SIMD kernels render their
+// frames of the remaining channels with it.
+void	ToneScalar(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output,
+				   uint32_t startChannel, uint32_t frameCount);
+
+// Reference audio quantize kernel, startSample may be any sample
+void	QuantizeAudioScalar(const float* input, void* output, uint32_t startSample, uint32_t count, uint32_t sampleDepth);
+
+// Composite kernel key weights are scaled by 2^10
+static const int		kKeyShift			= 10;
+static const uint16_t	kKeyRound			= 1 << (kKeyShift - 1);
+
+static const int32_t	kFilterRound		= 1 << (kFilterCoefficientShift - 1);
+
+// 1D lookup table entries are 16 samples apart, interpolated by the low 4 bits of the sample
+static const int		kLUT1DIndexShift	= 4;
+static const int32_t	kLUT1DFractionMask	= (1 << kLUT1DIndexShift) - 1;
+static const int32_t	kLUT1DRound			= 1 << (kLUT1DIndexShift - 1);
+
+// 3D lookup table positions are scaled by 2^16, and interpolated with 15-bit fractions so that products
+// of fractions and differences of 16-bit samples fit 32 bits
+static const int		kLUT3DPositionShift	= 16;
+static const int		kLUT3DFractionShift	= 15;
+static const int32_t	kLUT3DRound			= 1 << (kLUT3DFractionShift - 1);
+
+// Position of a sample on the grid of a 3D lookup table with scale = size - 1.  v + (v >> 16) is
+// v * 65537 / 65536, which approximates v * 65536 / 65535, so sample 65535 is at the last grid point.
+static inline uint32_t LUT3DPosition(uint16_t sample, uint32_t scale)
+{
+	uint32_t v = (uint32_t)sample * scale;
+
+	return v + (v >> kLUT3DPositionShift);
+}
+
+// Half-band filter taps 1, 3 and 5 samples from the centre, with kFilterCoefficientShift fractional bits.  The
+// centre tap is half and the taps sum to 1.  Interpolated samples are the odd phase of the filter, with twice
+// these taps.  Sums of 16-bit samples fit 32 bits.
+static const int32_t	kHalfBandCentre		= 8192;
+static const int32_t	kHalfBandTaps[3]	= { 5009, -1113, 200 };
+
+// The taps of up to 3 samples at each end of a row cross its edges, the SIMD half-band kernels leave these to the
+// scalar kernels
+static const uint32_t	kHalfBandEdgeSamples	= 3;
+
+static const int32_t	kSinusoidRound		= 1 << (kSinusoidShift - 1);
+
+// Tone phases are folded to a quarter turn either side of zero: adding a quarter turn, the magnitude of the
+// phase as a signed number is the distance from a half turn, and subtracting a quarter turn gives a phase of the
+// same sine within -2^30 to 2^30.  kTonePhaseScale converts it to radians.
+static const uint32_t	kToneQuarterTurn	= 0x40000000;
+static const float		kTonePhaseScale		= 1.46291807926715968e-9f;		// 2 pi / 2^32
+
+// Taylor series of sin(x) / x in x^2, from the constant term, for x within -pi/2 to pi/2.  SIMD kernels evaluate
+// it in the same order without fused multiply-adds.
+static const float		kToneSineCoefficients[6] = { 1.0f, -1.0f / 6.0f, 1.0f / 120.0f, -1.0f / 5040.0f, 1.0f / 362880.0f, -1.0f / 39916800.0f };
+
+// Audio quantize scales, and the largest float below 2^31 for 32-bit samples
+static const float		kAudioScale16		= 32768.0f;
+static const float		kAudioMax16			= 32767.0f;
+static const float		kAudioScale32		= 2147483648.0f;
+static const float		kAudioMax32			= 2147483520.0f;
+
+// Colorimetry kernel constants
+static const int		kYUVToRGBShift		= 6;
+static const int		kRGBToYUVShift		= 20;
+static const uint16_t	kMinYUVCode			= 4;
+static const uint16_t	kMaxYUVCode			= 1019;
+static const uint16_t	kChromaZero			= 512;
+
+// Pair of 16-bit coefficients for a SIMD multiply-add, low multiplies even and high odd 16-bit lanes
+static inline int32_t MaddCoefficients(int32_t low, int32_t high)
+{
+	return (int32_t)((uint32_t)(uint16_t)low | ((uint32_t)(uint16_t)high << 16));
+}
+
+// v210 packs 6 pixels in 4 little-endian words {Cb0 Y0 Cr0} {Y1 Cb1 Y2} {Cr1 Y3 Cb2} {Y4 Cr2 Y5}, low bits first.
+//
+// To unpack, the low (a), middle (b) and high (c) 10-bit fields of the 4 words are narrowed to 16 bits as
+// ab = {a0 a1 a2 a3 b0 b1 b2 b3} and cc = {c0 c1 c2 c3 ...}.  A byte shuffle of each, ORed together, gives
+// the 6 luma or 3 chroma samples of the group.
+//
+// To pack, L = {Y0..Y7} and C = {Cb0 Cb1 Cb2 Cb3 Cr0 Cr1 Cr2 Cr3} are shuffled into the a, b and c fields
+// zero-extended to 32 bits, then the words are a | b << 10 | c << 20.
+//
+// Byte indices of -1 select zero with both x86 pshufb and AArch64 tbl.
+alignas(16) static const int8_t kV210LumaFromAB[16]	= { 8, 9, 2, 3, -1, -1, 12, 13, 6, 7, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210LumaFromC[16]	= { -1, -1, -1, -1, 2, 3, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210CbFromAB[16]	= { 0, 1, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210CbFromC[16]	= { -1, -1, -1, -1, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210CrFromAB[16]	= { -1, -1, 4, 5, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210CrFromC[16]	= { 0, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+
+alignas(16) static const int8_t kV210AFromL[16]		= { -1, -1, -1, -1, 2, 3, -1, -1, -1, -1, -1, -1, 8, 9, -1, -1 };
+alignas(16) static const int8_t kV210AFromC[16]		= { 0, 1, -1, -1, -1, -1, -1, -1, 10, 11, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210BFromL[16]		= { 0, 1, -1, -1, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kV210BFromC[16]		= { -1, -1, -1, -1, 2, 3, -1, -1, -1, -1, -1, -1, 12, 13, -1, -1 };
+alignas(16) static const int8_t kV210CFromL[16]		= { -1, -1, -1, -1, 4, 5, -1, -1, -1, -1, -1, -1, 10, 11, -1, -1 };
+alignas(16) static const int8_t kV210CFromC[16]		= { 8, 9, -1, -1, -1, -1, -1, -1, 4, 5, -1, -1, -1, -1, -1, -1 };
+
+// 12-bit RGB packs 8 pixels in 9 words, a little-endian stream of 12-bit R, G, B samples.  For R12B each
+// word is big-endian, so the byte indices of the little-endian shuffles below are XORed with 3.
+//
+// To unpack, the three 12 byte chunks of a group are loaded from byte offsets 0, 12 and 20.  A byte shuffle
+// of each, ORed together, gives each 16-bit sample of a plane from its two bytes.  Samples at even stream
+// positions are then in bits 0-11 and at odd positions in bits 4-15: lanes alternate starting with bit 0
+// for R and B and bit 4 for G.
+//
+// To pack, samples at odd stream positions are shifted left by 4, then a byte shuffle of each plane, ORed
+// together, gives each 16 byte chunk of the group, the last chunk has 4 bytes.
+alignas(16) static const int8_t kR12RedFromLoad0[16]		= { 0, 1, 4, 5, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12RedFromLoad1[16]		= { -1, -1, -1, -1, -1, -1, 1, 2, 6, 7, 10, 11, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12RedFromLoad2[16]		= { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 7, 8, 11, 12 };
+alignas(16) static const int8_t kR12GreenFromLoad0[16]		= { 1, 2, 6, 7, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12GreenFromLoad1[16]		= { -1, -1, -1, -1, -1, -1, 3, 4, 7, 8, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12GreenFromLoad2[16]		= { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 4, 5, 8, 9, 13, 14 };
+alignas(16) static const int8_t kR12BlueFromLoad0[16]		= { 3, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12BlueFromLoad1[16]		= { -1, -1, -1, -1, 0, 1, 4, 5, 9, 10, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12BlueFromLoad2[16]		= { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5, 6, 10, 11, 14, 15 };
+alignas(16) static const int8_t kR12Chunk0FromRed[16]		= { 0, 1, -1, -1, 2, 3, -1, -1, -1, 4, 5, -1, -1, 6, 7, -1 };
+alignas(16) static const int8_t kR12Chunk0FromGreen[16]		= { -1, 0, 1, -1, -1, -1, 2, 3, -1, -1, 4, 5, -1, -1, -1, 6 };
+alignas(16) static const int8_t kR12Chunk0FromBlue[16]		= { -1, -1, -1, 0, 1, -1, -1, 2, 3, -1, -1, -1, 4, 5, -1, -1 };
+alignas(16) static const int8_t kR12Chunk1FromRed[16]		= { -1, -1, 8, 9, -1, -1, 10, 11, -1, -1, -1, 12, 13, -1, -1, 14 };
+alignas(16) static const int8_t kR12Chunk1FromGreen[16]		= { 7, -1, -1, 8, 9, -1, -1, -1, 10, 11, -1, -1, 12, 13, -1, -1 };
+alignas(16) static const int8_t kR12Chunk1FromBlue[16]		= { 6, 7, -1, -1, -1, 8, 9, -1, -1, 10, 11, -1, -1, -1, 12, 13 };
+alignas(16) static const int8_t kR12Chunk2FromRed[16]		= { 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12Chunk2FromGreen[16]		= { -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+alignas(16) static const int8_t kR12Chunk2FromBlue[16]		= { -1, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
@@ -0,0 +1,807 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <algorithm>
+#include <smmintrin.h>
+#include "VideoKernelsPrivate.h"
+
+#define TARGET_SSE41	__attribute__((target("sse4.1")))
+
+// Unpack one 6 pixel v210 group.  Writes 8 luma and 4 chroma samples, the last 2 and 1 are overwritten
+// by the next group.
+TARGET_SSE41
+static inline void UnpackV210Group(const uint32_t* words, uint16_t* luma, uint16_t* cb, uint16_t* cr)
+{
+	const __m128i	mask10	= _mm_set1_epi32(0x3FF);
+	__m128i			w		= _mm_loadu_si128((const __m128i*)words);
+	__m128i			ab		= _mm_packus_epi32(_mm_and_si128(w, mask10), _mm_and_si128(_mm_srli_epi32(w, 10), mask10));
+	__m128i			cc		= _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w, 20), mask10), _mm_setzero_si128());
+
+	_mm_storeu_si128((__m128i*)luma, _mm_or_si128(_mm_shuffle_epi8(ab, _mm_load_si128((const __m128i*)kV210LumaFromAB)),
+												  _mm_shuffle_epi8(cc, _mm_load_si128((const __m128i*)kV210LumaFromC))));
+	_mm_storel_epi64((__m128i*)cb, _mm_or_si128(_mm_shuffle_epi8(ab, _mm_load_si128((const __m128i*)kV210CbFromAB)),
+												_mm_shuffle_epi8(cc, _mm_load_si128((const __m128i*)kV210CbFromC))));
+	_mm_storel_epi64((__m128i*)cr, _mm_or_si128(_mm_shuffle_epi8(ab, _mm_load_si128((const __m128i*)kV210CrFromAB)),
+												_mm_shuffle_epi8(cc, _mm_load_si128((const __m128i*)kV210CrFromC))));
+}
+
+// Pack one 6 pixel v210 group, reading 8 luma and 4 of each chroma samples
+TARGET_SSE41
+static inline void PackV210Group(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* words)
+{
+	const __m128i	mask10	= _mm_set1_epi16(0x3FF);
+	__m128i			l		= _mm_and_si128(_mm_loadu_si128((const __m128i*)luma), mask10);
+	__m128i			c		= _mm_and_si128(_mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)cb), _mm_loadl_epi64((const __m128i*)cr)), mask10);
+	__m128i			a		= _mm_or_si128(_mm_shuffle_epi8(l, _mm_load_si128((const __m128i*)kV210AFromL)),
+										   _mm_shuffle_epi8(c, _mm_load_si128((const __m128i*)kV210AFromC)));
+	__m128i			b		= _mm_or_si128(_mm_shuffle_epi8(l, _mm_load_si128((const __m128i*)kV210BFromL)),
+										   _mm_shuffle_epi8(c, _mm_load_si128((const __m128i*)kV210BFromC)));
+	__m128i			hi		= _mm_or_si128(_mm_shuffle_epi8(l, _mm_load_si128((const __m128i*)kV210CFromL)),
+										   _mm_shuffle_epi8(c, _mm_load_si128((const __m128i*)kV210CFromC)));
+
+	_mm_storeu_si128((__m128i*)words, _mm_or_si128(_mm_or_si128(a, _mm_slli_epi32(b, 10)), _mm_slli_epi32(hi, 20)));
+}
+
+TARGET_SSE41
+static void UnpackV210RowSSE41(const uint32_t* v210Row, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	uint32_t x;
+
+	for (x = 0; x + 8 <= width; x += 6)
+		UnpackV210Group(v210Row + (x / 6) * 4, luma + x, cb + x / 2, cr + x / 2);
+
+	UnpackV210Scalar(v210Row, luma, cb, cr, x, width);
+}
+
+TARGET_SSE41
+static void PackV210RowSSE41(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint32_t* v210Row, uint32_t width)
+{
+	uint32_t x;
+
+	for (x = 0; x + 8 <= width; x += 6)
+		PackV210Group(luma + x, cb + x / 2, cr + x / 2, v210Row + (x / 6) * 4);
+
+	PackV210Scalar(luma, cb, cr, v210Row, x, width);
+}
+
+TARGET_SSE41
+void PlanarTo2vuyRowSSE41(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint8_t* yuvRow, uint32_t width)
+{
+	const __m128i	round	= _mm_set1_epi16(2);
+	uint32_t		x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		// Round to 8 bits, saturating samples above 10 bits
+		__m128i y0	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(luma + x)), round), 2);
+		__m128i y1	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(luma + x + 8)), round), 2);
+		__m128i u	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(cb + x / 2)), round), 2);
+		__m128i v	= _mm_srli_epi16(_mm_adds_epu16(_mm_loadu_si128((const __m128i*)(cr + x / 2)), round), 2);
+		__m128i y	= _mm_packus_epi16(y0, y1);
+		__m128i uv	= _mm_unpacklo_epi8(_mm_packus_epi16(u, u), _mm_packus_epi16(v, v));
+
+		_mm_storeu_si128((__m128i*)(yuvRow + x * 2), _mm_unpacklo_epi8(uv, y));
+		_mm_storeu_si128((__m128i*)(yuvRow + x * 2 + 16), _mm_unpackhi_epi8(uv, y));
+	}
+
+	PlanarTo2vuyScalar(luma, cb, cr, yuvRow, x, width);
+}
+
+TARGET_SSE41
+void Unpack2vuyRowSSE41(const uint8_t* yuvRow, uint16_t* luma, uint16_t* cb, uint16_t* cr, uint32_t width)
+{
+	const __m128i	lowByte		= _mm_set1_epi16(0xFF);
+	const __m128i	lowWord		= _mm_set1_epi32(0xFFFF);
+	uint32_t		x;
+
+	for (x = 0; x + 16 <= width; x += 16)
+	{
+		__m128i p0	= _mm_loadu_si128((const __m128i*)(yuvRow + x * 2));
+		__m128i p1	= _mm_loadu_si128((const __m128i*)(yuvRow + x * 2 + 16));
+		__m128i uv0	= _mm_and_si128(p0, lowByte);
+		__m128i uv1	= _mm_and_si128(p1, lowByte);
+
+		_mm_storeu_si128((__m128i*)(luma + x), _mm_slli_epi16(_mm_srli_epi16(p0, 8), 2));
+		_mm_storeu_si128((__m128i*)(luma + x + 8), _mm_slli_epi16(_mm_srli_epi16(p1, 8), 2));
+		_mm_storeu_si128((__m128i*)(cb + x / 2), _mm_slli_epi16(_mm_packus_epi32(_mm_and_si128(uv0, lowWord), _mm_and_si128(uv1, lowWord)), 2));
+		_mm_storeu_si128((__m128i*)(cr + x / 2), _mm_slli_epi16(_mm_packus_epi32(_mm_srli_epi32(uv0, 16), _mm_srli_epi32(uv1, 16)), 2));
+	}
+
+	Unpack2vuyScalar(yuvRow, luma, cb, cr, x, width);
+}
+
+TARGET_SSE41
+static inline __m128i LoadR12UnpackMask(const int8_t* mask, bool bigEndian)
+{
+	return _mm_xor_si128(_mm_load_si128((const __m128i*)mask), _mm_set1_epi8(bigEndian ? 3 : 0));
+}
+
+TARGET_SSE41
+static inline __m128i LoadR12PackMask(const int8_t* mask, bool bigEndian)
+{
+	const __m128i swapWords = bigEndian ? _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+										: _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+	return _mm_shuffle_epi8(_mm_load_si128((const __m128i*)mask), swapWords);
+}
+
+TARGET_SSE41
+static void UnpackR12RowSSE41(const uint8_t* r12Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width, bool bigEndian)
+{
+	const __m128i	mask12	= _mm_set1_epi16(0xFFF);
+	const __m128i	r0		= LoadR12UnpackMask(kR12RedFromLoad0, bigEndian);
+	const __m128i	r1		= LoadR12UnpackMask(kR12RedFromLoad1, bigEndian);
+	const __m128i	r2		= LoadR12UnpackMask(kR12RedFromLoad2, bigEndian);
+	const __m128i	g0		= LoadR12UnpackMask(kR12GreenFromLoad0, bigEndian);
+	const __m128i	g1		= LoadR12UnpackMask(kR12GreenFromLoad1, bigEndian);
+	const __m128i	g2		= LoadR12UnpackMask(kR12GreenFromLoad2, bigEndian);
+	const __m128i	b0		= LoadR12UnpackMask(kR12BlueFromLoad0, bigEndian);
+	const __m128i	b1		= LoadR12UnpackMask(kR12BlueFromLoad1, bigEndian);
+	const __m128i	b2		= LoadR12UnpackMask(kR12BlueFromLoad2, bigEndian);
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		const uint8_t*	group	= r12Row + (x / 8) * 36;
+		__m128i			l0		= _mm_loadu_si128((const __m128i*)group);
+		__m128i			l1		= _mm_loadu_si128((const __m128i*)(group + 12));
+		__m128i			l2		= _mm_loadu_si128((const __m128i*)(group + 20));
+
+		__m128i r	= _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(l0, r0), _mm_shuffle_epi8(l1, r1)), _mm_shuffle_epi8(l2, r2));
+		__m128i g	= _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(l0, g0), _mm_shuffle_epi8(l1, g1)), _mm_shuffle_epi8(l2, g2));
+		__m128i b	= _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(l0, b0), _mm_shuffle_epi8(l1, b1)), _mm_shuffle_epi8(l2, b2));
+
+		_mm_storeu_si128((__m128i*)(red + x), _mm_blend_epi16(_mm_and_si128(r, mask12), _mm_srli_epi16(r, 4), 0xAA));
+		_mm_storeu_si128((__m128i*)(green + x), _mm_blend_epi16(_mm_and_si128(g, mask12), _mm_srli_epi16(g, 4), 0x55));
+		_mm_storeu_si128((__m128i*)(blue + x), _mm_blend_epi16(_mm_and_si128(b, mask12), _mm_srli_epi16(b, 4), 0xAA));
+	}
+
+	UnpackR12Scalar(r12Row, red, green, blue, x, width, bigEndian);
+}
+
+TARGET_SSE41
+static void PackR12RowSSE41(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint8_t* r12Row, uint32_t width, bool bigEndian)
+{
+	const __m128i	mask12	= _mm_set1_epi16(0xFFF);
+	const __m128i	r0		= LoadR12PackMask(kR12Chunk0FromRed, bigEndian);
+	const __m128i	g0		= LoadR12PackMask(kR12Chunk0FromGreen, bigEndian);
+	const __m128i	b0		= LoadR12PackMask(kR12Chunk0FromBlue, bigEndian);
+	const __m128i	r1		= LoadR12PackMask(kR12Chunk1FromRed, bigEndian);
+	const __m128i	g1		= LoadR12PackMask(kR12Chunk1FromGreen, bigEndian);
+	const __m128i	b1		= LoadR12PackMask(kR12Chunk1FromBlue, bigEndian);
+	const __m128i	r2		= LoadR12PackMask(kR12Chunk2FromRed, bigEndian);
+	const __m128i	g2		= LoadR12PackMask(kR12Chunk2FromGreen, bigEndian);
+	const __m128i	b2		= LoadR12PackMask(kR12Chunk2FromBlue, bigEndian);
+	uint32_t		x;
+
+	// The last group is packed by the scalar kernel, which truncates it to a whole word
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		uint8_t*	group	= r12Row + (x / 8) * 36;
+		__m128i		r		= _mm_and_si128(_mm_loadu_si128((const __m128i*)(red + x)), mask12);
+		__m128i		g		= _mm_and_si128(_mm_loadu_si128((const __m128i*)(green + x)), mask12);
+		__m128i		b		= _mm_and_si128(_mm_loadu_si128((const __m128i*)(blue + x)), mask12);
+
+		r = _mm_blend_epi16(r, _mm_slli_epi16(r, 4), 0xAA);
+		g = _mm_blend_epi16(g, _mm_slli_epi16(g, 4), 0x55);
+		b = _mm_blend_epi16(b, _mm_slli_epi16(b, 4), 0xAA);
+
+		int32_t lastWord = _mm_cvtsi128_si32(_mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)), _mm_shuffle_epi8(b, b2)));
+
+		_mm_storeu_si128((__m128i*)group, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)), _mm_shuffle_epi8(b, b0)));
+		_mm_storeu_si128((__m128i*)(group + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)), _mm_shuffle_epi8(b, b1)));
+		memcpy(group + 32, &lastWord, 4);
+	}
+
+	PackR12Scalar(red, green, blue, r12Row, x, width, bigEndian);
+}
+
+// Byte swap 4 r210 words and extract the 10-bit components, two loads are packed to 8 samples of each plane
+TARGET_SSE41
+static void UnpackR210RowSSE41(const uint32_t* r210Row, uint16_t* red, uint16_t* green, uint16_t* blue, uint32_t width)
+{
+	const __m128i	swapWords	= _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m128i	mask10		= _mm_set1_epi32(0x3FF);
+	uint32_t		x;
+
+	for (x = 0; x + 8 <= width; x += 8)
+	{
+		__m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(r210Row + x)), swapWords);
+		__m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(r210Row + x + 4)), swapWords);
+
+		_mm_storeu_si128((__m128i*)(red + x), _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w0, 20), mask10), _mm_and_si128(_mm_srli_epi32(w1, 20), mask10)));
+		_mm_storeu_si128((__m128i*)(green + x), _mm_packus_epi32(_mm_and_si128(_mm_srli_epi32(w0, 10), mask10), _mm_and_si128(_mm_srli_epi32(w1, 10), mask10)));
+		_mm_storeu_si128((__m128i*)(blue + x), _mm_packus_epi32(_mm_and_si128(w0, mask10), _mm_and_si128(w1, mask10)));
+	}
+
+	UnpackR210Scalar(r210Row, red, green, blue, x, width);
+}
+
+// Chroma of 8 pixels from the 4 samples of pixel x onwards, upsampled as UpsampleChroma()
+TARGET_SSE41
+static inline __m128i UpsampleChromaSSE41(const uint16_t* chroma, uint32_t x, ChromaSiting siting)
+{
+	__m128i c		= _mm_loadl_epi64((const __m128i*)(chroma + x / 2));
+	__m128i next	= _mm_loadl_epi64((const __m128i*)(chroma + x / 2 + 1));
+
+	if (siting == kChromaSitingCosited)
+		return _mm_unpacklo_epi16(c, _mm_avg_epu16(c, next));
+
+	// The first sample of a row is its own left neighbour
+	__m128i prev	= (x > 0) ? _mm_loadl_epi64((const __m128i*)(chroma + x / 2 - 1)) : _mm_insert_epi16(_mm_slli_si128(c, 2), chroma[0], 0);
+	__m128i c3		= _mm_add_epi16(_mm_add_epi16(c, c), _mm_add_epi16(c, _mm_set1_epi16(2)));
+
+	return _mm_unpacklo_epi16(_mm_srli_epi16(_mm_add_epi16(c3, prev), 2), _mm_srli_epi16(_mm_add_epi16(c3, next), 2));
+}
+
+TARGET_SSE41
+static void ConvertYUV422ToRGBRowSSE41(const uint16_t* luma, const uint16_t* cb, const uint16_t* cr, uint16_t* red, uint16_t* green, uint16_t* blue,
+									   uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	const uint32_t	chromaCount	= (width + 1) / 2;
+	const __m128i	chromaZero	= _mm_set1_epi16(kChromaZero);
+	const __m128i	offset		= _mm_set1_epi32(coefficients.rgbOffset);
+	const __m128i	redCoeffs	= _mm_set1_epi32(MaddCoefficients(coefficients.yToRGB, coefficients.crToRed));
+	const __m128i	greenCoeffs	= _mm_set1_epi32(MaddCoefficients(coefficients.yToRGB, coefficients.cbToGreen));
+	const __m128i	crGreen		= _mm_set1_epi32(MaddCoefficients(coefficients.crToGreen, 0));
+	const __m128i	blueCoeffs	= _mm_set1_epi32(MaddCoefficients(coefficients.yToRGB, coefficients.cbToBlue));
+	uint32_t		x;
+
+	// Interpolation reads one chroma sample beyond each group
+	for (x = 0; (x + 8 <= width) && (x / 2 + 4 < chromaCount); x += 8)
+	{
+		__m128i y		= _mm_loadu_si128((const __m128i*)(luma + x));
+		__m128i u		= _mm_sub_epi16(UpsampleChromaSSE41(cb, x, coefficients.chromaSiting), chromaZero);
+		__m128i v		= _mm_sub_epi16(UpsampleChromaSSE41(cr, x, coefficients.chromaSiting), chromaZero);
+
+		__m128i yvLo	= _mm_unpacklo_epi16(y, v);
+		__m128i yvHi	= _mm_unpackhi_epi16(y, v);
+		__m128i yuLo	= _mm_unpacklo_epi16(y, u);
+		__m128i yuHi	= _mm_unpackhi_epi16(y, u);
+		__m128i vLo		= _mm_unpacklo_epi16(v, _mm_setzero_si128());
+		__m128i vHi		= _mm_unpackhi_epi16(v, _mm_setzero_si128());
+
+		__m128i rLo		= _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvLo, redCoeffs), offset), kYUVToRGBShift);
+		__m128i rHi		= _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvHi, redCoeffs), offset), kYUVToRGBShift);
+		__m128i gLo		= _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, greenCoeffs), _mm_madd_epi16(vLo, crGreen)), offset), kYUVToRGBShift);
+		__m128i gHi		= _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, greenCoeffs), _mm_madd_epi16(vHi, crGreen)), offset), kYUVToRGBShift);
+		__m128i bLo		= _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, blueCoeffs), offset), kYUVToRGBShift);
+		__m128i bHi		= _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, blueCoeffs), offset), kYUVToRGBShift);
+
+		_mm_storeu_si128((__m128i*)(red + x), _mm_packus_epi32(rLo, rHi));
+		_mm_storeu_si128((__m128i*)(green + x), _mm_packus_epi32(gLo, gHi));
+		_mm_storeu_si128((__m128i*)(blue + x), _mm_packus_epi32(bLo, bHi));
+	}
+
+	ConvertYUV422ToRGBScalar(luma, cb, cr, red, green, blue, x, width, coefficients);
+}
+
+TARGET_SSE41
+static inline __m128i MultiplyAdd3SSE41(__m128i r, __m128i g, __m128i b, const int32_t* coeffs, int32_t offset)
+{
+	__m128i sum = _mm_add_epi32(_mm_mullo_epi32(r, _mm_set1_epi32(coeffs[0])), _mm_mullo_epi32(g, _mm_set1_epi32(coeffs[1])));
+
+	sum = _mm_add_epi32(sum, _mm_mullo_epi32(b, _mm_set1_epi32(coeffs[2])));
+	return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(offset)), kRGBToYUVShift);
+}
+
+// RGB samples at the chroma positions of the 4 pixel pairs from pixel x, as DownsampleRGB(), in 32-bit lanes
+TARGET_SSE41
+static inline __m128i DownsampleRGBSSE41(const uint16_t* samples, uint32_t x, ChromaSiting siting)
+{
+	__m128i s		= _mm_loadu_si128((const __m128i*)(samples + x));
+	__m128i next	= _mm_loadu_si128((const __m128i*)(samples + x + 1));
+	__m128i filtered;
+
+	if (siting == kChromaSitingCosited)
+	{
+		__m128i prev = (x > 0) ? _mm_loadu_si128((const __m128i*)(samples + x - 1)) : _mm_insert_epi16(_mm_slli_si128(s, 2), samples[0], 0);
+		filtered = _mm_avg_epu16(_mm_avg_epu16(prev, next), s);
+	}
+	else
+	{
+		filtered = _mm_avg_epu16(s, next);
+	}
+
+	return _mm_and_si128(filtered, _mm_set1_epi32(0xFFFF));
+}
+
+TARGET_SSE41
+static inline __m128i ClampYUVSSE41(__m128i lo, __m128i hi)
+{
+	return _mm_max_epu16(_mm_min_epu16(_mm_packus_epi32(lo, hi), _mm_set1_epi16(kMaxYUVCode)), _mm_set1_epi16(kMinYUVCode));
+}
+
+TARGET_SSE41
+static void ConvertRGBToYUV422RowSSE41(const uint16_t* red, const uint16_t* green, const uint16_t* blue, uint16_t* luma, uint16_t* cb, uint16_t* cr,
+									   uint32_t width, const ColorimetryCoefficients& coefficients)
+{
+	const __m128i	zero = _mm_setzero_si128();
+	uint32_t		x;
+
+	// Chroma filtering reads one pixel beyond each group
+	for (x = 0; x + 9 <= width; x += 8)
+	{
+		__m128i r		= _mm_loadu_si128((const __m128i*)(red + x));
+		__m128i g		= _mm_loadu_si128((const __m128i*)(green + x));
+		__m128i b		= _mm_loadu_si128((const __m128i*)(blue + x));
+
+		__m128i yLo		= MultiplyAdd3SSE41(_mm_cvtepu16_epi32(r), _mm_cvtepu16_epi32(g), _mm_cvtepu16_epi32(b), coefficients.rgbToY, coefficients.yOffset);
+		__m128i yHi		= MultiplyAdd3SSE41(_mm_unpackhi_epi16(r, zero), _mm_unpackhi_epi16(g, zero), _mm_unpackhi_epi16(b, zero),
+											coefficients.rgbToY, coefficients.yOffset);
+
+		_mm_storeu_si128((__m128i*)(luma + x), ClampYUVSSE41(yLo, yHi));
+
+		__m128i rc		= DownsampleRGBSSE41(red, x, coefficients.chromaSiting);
+		__m128i gc		= DownsampleRGBSSE41(green, x, coefficients.chromaSiting);
+		__m128i bc		= DownsampleRGBSSE41(blue, x, coefficients.chromaSiting);
+		__m128i u		= MultiplyAdd3SSE41(rc, gc, bc, coefficients.rgbToCb, coefficients.cbOffset);
+		__m128i v		= MultiplyAdd3SSE41(rc, gc, bc, coefficients.rgbToCr, coefficients.crOffset);
+
+		_mm_storel_epi64((__m128i*)(cb + x / 2), ClampYUVSSE41(u, u));
+		_mm_storel_epi64((__m128i*)(cr + x / 2), ClampYUVSSE41(v, v));
+	}
+
+	ConvertRGBToYUV422Scalar(red, green, blue, luma, cb, cr, x, width, coefficients);
+}
+
+TARGET_SSE41
+static void CompositeRowSSE41(const uint16_t* background, const uint16_t* fill, const uint16_t* inverseKey, uint16_t* output, uint32_t count)
+{
+	// Multiply-add of {background, 1} by {inverseKey, round} pairs
+	const __m128i	one		= _mm_set1_epi16(1);
+	const __m128i	round	= _mm_set1_epi16(kKeyRound);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m128i bg		= _mm_loadu_si128((const __m128i*)(background + i));
+		__m128i key		= _mm_loadu_si128((const __m128i*)(inverseKey + i));
+		__m128i lo		= _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(bg, one), _mm_unpacklo_epi16(key, round)), kKeyShift);
+		__m128i hi		= _mm_srli_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(bg, one), _mm_unpackhi_epi16(key, round)), kKeyShift);
+		__m128i value	= _mm_add_epi16(_mm_packus_epi32(lo, hi), _mm_loadu_si128((const __m128i*)(fill + i)));
+
+		_mm_storeu_si128((__m128i*)(output + i), _mm_max_epu16(_mm_min_epu16(value, _mm_set1_epi16(kMaxYUVCode)), _mm_set1_epi16(kMinYUVCode)));
+	}
+
+	CompositeScalar(background, fill, inverseKey, output, i, count);
+}
+
+TARGET_SSE41
+static inline __m128i FilterTapsSSE41(const uint16_t* taps, const int16_t* weights, uint32_t tapStride)
+{
+	__m128i sum = _mm_setzero_si128();
+
+	for (uint32_t t = 0; t < tapStride; t += 8)
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(taps + t)), _mm_loadu_si128((const __m128i*)(weights + t))));
+
+	return sum;
+}
+
+TARGET_SSE41
+static void FilterRowHorizontalSSE41(const uint16_t* source, const uint32_t* offsets, const int16_t* coefficients, uint32_t tapStride,
+									 uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// Each output sample is a multiply-add of 8 taps at a time, the partial sums of 4 samples are reduced
+	// together by horizontal adds
+	const __m128i	round	= _mm_set1_epi32(kFilterRound);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		const int16_t*	weights = coefficients + (size_t)i * tapStride;
+		__m128i			sum[8];
+
+		for (uint32_t j = 0; j < 8; j++)
+			sum[j] = FilterTapsSSE41(source + offsets[i + j], weights + j * tapStride, tapStride);
+
+		__m128i lo		= _mm_hadd_epi32(_mm_hadd_epi32(sum[0], sum[1]), _mm_hadd_epi32(sum[2], sum[3]));
+		__m128i hi		= _mm_hadd_epi32(_mm_hadd_epi32(sum[4], sum[5]), _mm_hadd_epi32(sum[6], sum[7]));
+		__m128i value	= _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, round), kFilterCoefficientShift),
+										  _mm_srai_epi32(_mm_add_epi32(hi, round), kFilterCoefficientShift));
+
+		_mm_storeu_si128((__m128i*)(output + i), _mm_max_epi16(_mm_min_epi16(value, _mm_set1_epi16(maxValue)), _mm_set1_epi16(minValue)));
+	}
+
+	FilterHorizontalScalar(source, offsets, coefficients, tapStride, output, i, count, minValue, maxValue);
+}
+
+TARGET_SSE41
+static void FilterRowsVerticalSSE41(const uint16_t* const* sourceRows, const int16_t* coefficients, uint32_t tapCount,
+									uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// Rows are interleaved in pairs for a multiply-add by each pair of coefficients, an odd last row is
+	// paired with zero
+	const __m128i	round = _mm_set1_epi32(kFilterRound);
+	__m128i			pairCoefficients[kMaxFilterTaps / 2];
+	uint32_t		pairCount = (tapCount + 1) / 2;
+	uint32_t		i;
+
+	for (uint32_t p = 0; p < pairCount; p++)
+		pairCoefficients[p] = _mm_set1_epi32(MaddCoefficients(coefficients[p * 2], (p * 2 + 1 < tapCount) ? coefficients[p * 2 + 1] : 0));
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m128i lo = round;
+		__m128i hi = round;
+
+		for (uint32_t p = 0; p < pairCount; p++)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(sourceRows[p * 2] + i));
+			__m128i b = (p * 2 + 1 < tapCount) ? _mm_loadu_si128((const __m128i*)(sourceRows[p * 2 + 1] + i)) : _mm_setzero_si128();
+
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pairCoefficients[p]));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pairCoefficients[p]));
+		}
+
+		__m128i value = _mm_packs_epi32(_mm_srai_epi32(lo, kFilterCoefficientShift), _mm_srai_epi32(hi, kFilterCoefficientShift));
+
+		_mm_storeu_si128((__m128i*)(output + i), _mm_max_epi16(_mm_min_epi16(value, _mm_set1_epi16(maxValue)), _mm_set1_epi16(minValue)));
+	}
+
+	FilterVerticalScalar(sourceRows, coefficients, tapCount, output, i, count, minValue, maxValue);
+}
+
+// Sum of differences between the rows above and below along direction j, over 3 sample pairs
+TARGET_SSE41
+static inline __m128i DirectionScoreSSE41(const uint16_t* above, const uint16_t* below, int j)
+{
+	__m128i score = _mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(above + j - 1)), _mm_loadu_si128((const __m128i*)(below - j - 1))));
+
+	score = _mm_add_epi16(score, _mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(above + j)), _mm_loadu_si128((const __m128i*)(below - j)))));
+	return _mm_add_epi16(score, _mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(above + j + 1)), _mm_loadu_si128((const __m128i*)(below - j + 1)))));
+}
+
+TARGET_SSE41
+static inline __m128i AverageSSE41(__m128i a, __m128i b)
+{
+	return _mm_srai_epi16(_mm_add_epi16(a, b), 1);
+}
+
+TARGET_SSE41
+static void DeinterlaceRowSSE41(const DeinterlaceRows& rows, uint16_t* output, uint32_t count)
+{
+	// 10-bit samples, their sums and the direction scores fit signed 16-bit lanes.  The edge directed
+	// search selects by mask, a steeper direction only where the shallower one was selected.
+	uint32_t i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		const uint16_t*	above			= rows.above + i;
+		const uint16_t*	below			= rows.below + i;
+		__m128i			c				= _mm_loadu_si128((const __m128i*)above);
+		__m128i			e				= _mm_loadu_si128((const __m128i*)below);
+		__m128i			earlier			= _mm_loadu_si128((const __m128i*)(rows.earlier + i));
+		__m128i			later			= _mm_loadu_si128((const __m128i*)(rows.later + i));
+		__m128i			d				= AverageSSE41(earlier, later);
+		__m128i			temporalDiff0	= _mm_srai_epi16(_mm_abs_epi16(_mm_sub_epi16(earlier, later)), 1);
+		__m128i			temporalDiff1	= _mm_srai_epi16(_mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(rows.previousAbove + i)), c)),
+																	   _mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(rows.previousBelow + i)), e))), 1);
+		__m128i			temporalDiff2	= _mm_srai_epi16(_mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(rows.nextAbove + i)), c)),
+																	   _mm_abs_epi16(_mm_sub_epi16(_mm_loadu_si128((const __m128i*)(rows.nextBelow + i)), e))), 1);
+		__m128i			diff			= _mm_max_epi16(_mm_max_epi16(temporalDiff0, temporalDiff1), temporalDiff2);
+		__m128i			spatialPred		= AverageSSE41(c, e);
+		__m128i			spatialScore	= _mm_sub_epi16(DirectionScoreSSE41(above, below, 0), _mm_set1_epi16(1));
+
+		for (int side = -1; side <= 1; side += 2)
+		{
+			__m128i selected = _mm_set1_epi16(-1);
+
+			for (int j = side; (j == side) || (j == side * 2); j += side)
+			{
+				__m128i score	= DirectionScoreSSE41(above, below, j);
+				__m128i pred	= AverageSSE41(_mm_loadu_si128((const __m128i*)(above + j)), _mm_loadu_si128((const __m128i*)(below - j)));
+
+				selected		= _mm_and_si128(selected, _mm_cmplt_epi16(score, spatialScore));
+				spatialScore	= _mm_blendv_epi8(spatialScore, score, selected);
+				spatialPred		= _mm_blendv_epi8(spatialPred, pred, selected);
+			}
+		}
+
+		__m128i b	= AverageSSE41(_mm_loadu_si128((const __m128i*)(rows.earlierAbove + i)), _mm_loadu_si128((const __m128i*)(rows.laterAbove + i)));
+		__m128i f	= AverageSSE41(_mm_loadu_si128((const __m128i*)(rows.earlierBelow + i)), _mm_loadu_si128((const __m128i*)(rows.laterBelow + i)));
+		__m128i de	= _mm_sub_epi16(d, e);
+		__m128i dc	= _mm_sub_epi16(d, c);
+		__m128i bc	= _mm_sub_epi16(b, c);
+		__m128i fe	= _mm_sub_epi16(f, e);
+		__m128i max	= _mm_max_epi16(_mm_max_epi16(de, dc), _mm_min_epi16(bc, fe));
+		__m128i min	= _mm_min_epi16(_mm_min_epi16(de, dc), _mm_max_epi16(bc, fe));
+
+		diff = _mm_max_epi16(_mm_max_epi16(diff, min), _mm_sub_epi16(_mm_setzero_si128(), max));
+
+		_mm_storeu_si128((__m128i*)(output + i), _mm_min_epi16(_mm_max_epi16(spatialPred, _mm_sub_epi16(d, diff)), _mm_add_epi16(d, diff)));
+	}
+
+	DeinterlaceScalar(rows, output, i, count);
+}
+
+TARGET_SSE41
+static inline __m128i LoadSamplesSSE41(const uint16_t* samples)
+{
+	return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)samples));
+}
+
+TARGET_SSE41
+static inline __m128i LimitHalfBandSSE41(__m128i sum, __m128i minValue, __m128i maxValue)
+{
+	__m128i value = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(kFilterRound)), kFilterCoefficientShift);
+
+	return _mm_max_epi32(_mm_min_epi32(value, maxValue), minValue);
+}
+
+TARGET_SSE41
+static void DecimateRowHorizontalSSE41(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// 4 samples per iteration, as the AVX2 kernel
+	const __m128i	lowMask	= _mm_set1_epi32(0xFFFF);
+	const __m128i	min		= _mm_set1_epi32(minValue);
+	const __m128i	max		= _mm_set1_epi32(maxValue);
+	uint32_t		i		= std::min(kHalfBandEdgeSamples, count);
+
+	DecimateHorizontalScalar(input, output, 0, i, count, minValue, maxValue);
+
+	for (; i + 4 + kHalfBandEdgeSamples <= count; i += 4)
+	{
+		const uint16_t*	pairs	= input + (size_t)i * 2;
+		__m128i			sum		= _mm_mullo_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)pairs), lowMask), _mm_set1_epi32(kHalfBandCentre));
+
+		for (int t = 0; t < 3; t++)
+		{
+			__m128i before	= _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(pairs - (t + 1) * 2)), 16);
+			__m128i after	= _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(pairs + t * 2)), 16);
+
+			sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_add_epi32(before, after), _mm_set1_epi32(kHalfBandTaps[t])));
+		}
+
+		__m128i value = LimitHalfBandSSE41(sum, min, max);
+
+		_mm_storel_epi64((__m128i*)(output + i), _mm_packus_epi32(value, value));
+	}
+
+	DecimateHorizontalScalar(input, output, i, count, count, minValue, maxValue);
+}
+
+TARGET_SSE41
+static void InterpolateRowHorizontalSSE41(const uint16_t* input, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	// 4 input samples per iteration, as the AVX2 kernel
+	const __m128i	min		= _mm_set1_epi32(minValue);
+	const __m128i	max		= _mm_set1_epi32(maxValue);
+	uint32_t		i		= std::min(kHalfBandEdgeSamples, count);
+
+	InterpolateHorizontalScalar(input, output, 0, i, count, minValue, maxValue);
+
+	for (; i + 4 + kHalfBandEdgeSamples <= count; i += 4)
+	{
+		__m128i samples	= LoadSamplesSSE41(input + i);
+		__m128i sum		= _mm_setzero_si128();
+
+		for (int t = 0; t < 3; t++)
+		{
+			__m128i pair = _mm_add_epi32(LoadSamplesSSE41(input + i - t), LoadSamplesSSE41(input + i + 1 + t));
+
+			sum = _mm_add_epi32(sum, _mm_mullo_epi32(pair, _mm_set1_epi32(kHalfBandTaps[t] * 2)));
+		}
+
+		_mm_storeu_si128((__m128i*)(output + (size_t)i * 2), _mm_or_si128(samples, _mm_slli_epi32(LimitHalfBandSSE41(sum, min, max), 16)));
+	}
+
+	InterpolateHorizontalScalar(input, output, i, count, count, minValue, maxValue);
+}
+
+TARGET_SSE41
+static void FilterRowsHalfBandSSE41(const HalfBandRows& rows, uint16_t* output, uint32_t count, uint16_t minValue, uint16_t maxValue)
+{
+	const int32_t	scale	= (rows.centre != NULL) ? 1 : 2;
+	const __m128i	min		= _mm_set1_epi32(minValue);
+	const __m128i	max		= _mm_set1_epi32(maxValue);
+	__m128i			taps[3];
+	uint32_t		i;
+
+	for (int t = 0; t < 3; t++)
+		taps[t] = _mm_set1_epi32(kHalfBandTaps[t] * scale);
+
+	for (i = 0; i + 4 <= count; i += 4)
+	{
+		__m128i sum = (rows.centre != NULL) ? _mm_mullo_epi32(LoadSamplesSSE41(rows.centre + i), _mm_set1_epi32(kHalfBandCentre)) : _mm_setzero_si128();
+
+		for (int t = 0; t < 3; t++)
+			sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_add_epi32(LoadSamplesSSE41(rows.above[t] + i), LoadSamplesSSE41(rows.below[t] + i)), taps[t]));
+
+		__m128i value = LimitHalfBandSSE41(sum, min, max);
+
+		_mm_storel_epi64((__m128i*)(output + i), _mm_packus_epi32(value, value));
+	}
+
+	HalfBandVerticalScalar(rows, output, i, count, minValue, maxValue);
+}
+
+TARGET_SSE41
+static void RenderSinusoidRowSSE41(const int16_t* phases, int16_t cosine, int16_t sine, uint16_t offset, uint16_t* output, uint32_t count)
+{
+	// 4 samples per iteration, as the AVX2 kernel
+	const __m128i	coefficients	= _mm_set1_epi32(MaddCoefficients(cosine, sine));
+	const __m128i	round			= _mm_set1_epi32(kSinusoidRound);
+	const __m128i	offsets			= _mm_set1_epi32(offset);
+	uint32_t		i;
+
+	for (i = 0; i + 4 <= count; i += 4)
+	{
+		__m128i sum		= _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(phases + (size_t)i * 2)), coefficients);
+		__m128i value	= _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, round), kSinusoidShift), offsets);
+
+		_mm_storel_epi64((__m128i*)(output + i), _mm_packus_epi32(value, value));
+	}
+
+	SinusoidScalar(phases, cosine, sine, offset, output, i, count);
+}
+
+TARGET_SSE41
+static inline __m128 ToneSineSSE41(__m128i phases)
+{
+	// Evaluated as the scalar kernel, pabsd leaves a phase of exactly a half turn unchanged as the scalar fold does
+	const __m128i	quarterTurn	= _mm_set1_epi32((int32_t)kToneQuarterTurn);
+	__m128i			folded		= _mm_abs_epi32(_mm_add_epi32(phases, quarterTurn));
+	__m128			x			= _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(folded, quarterTurn)), _mm_set1_ps(kTonePhaseScale));
+	__m128			x2			= _mm_mul_ps(x, x);
+	__m128			sum			= _mm_set1_ps(kToneSineCoefficients[5]);
+
+	for (int i = 4; i >= 0; i--)
+		sum = _mm_add_ps(_mm_mul_ps(sum, x2), _mm_set1_ps(kToneSineCoefficients[i]));
+
+	return _mm_mul_ps(sum, x);
+}
+
+TARGET_SSE41
+static void RenderToneFramesSSE41(uint32_t* phases, const uint32_t* increments, const float* levels, uint32_t channels, float* output, uint32_t frameCount)
+{
+	uint32_t c = 0;
+
+	if ((channels == 1) || (channels == 2))
+	{
+		// Each vector holds 4 / channels frames, lane j is channel j % channels of frame j / channels
+		const uint32_t	framesPerVector = 4 / channels;
+		alignas(16) uint32_t	lanePhases[4];
+		alignas(16) uint32_t	laneSteps[4];
+		alignas(16) float		laneLevels[4];
+		uint32_t		f;
+
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			lanePhases[j]	= phases[j % channels] + (j / channels) * increments[j % channels];
+			laneSteps[j]	= framesPerVector * increments[j % channels];
+			laneLevels[j]	= levels[j % channels];
+		}
+
+		__m128i			phase	= _mm_load_si128((const __m128i*)lanePhases);
+		const __m128i	step	= _mm_load_si128((const __m128i*)laneSteps);
+		const __m128	level	= _mm_load_ps(laneLevels);
+
+		for (f = 0; f + framesPerVector <= frameCount; f += framesPerVector)
+		{
+			_mm_storeu_ps(output + (size_t)f * channels, _mm_mul_ps(level, ToneSineSSE41(phase)));
+			phase = _mm_add_epi32(phase, step);
+		}
+
+		// The first lanes hold the phases of frame f
+		_mm_store_si128((__m128i*)lanePhases, phase);
+		for (uint32_t j = 0; j < channels; j++)
+			phases[j] = lanePhases[j];
+
+		ToneScalar(phases, increments, levels, channels, output + (size_t)f * channels, 0, frameCount - f);
+		return;
+	}
+
+	// Otherwise each vector holds 4 channels of a frame
+	for (c = 0; c + 4 <= channels; c += 4)
+	{
+		__m128i			phase	= _mm_loadu_si128((const __m128i*)(phases + c));
+		const __m128i	step	= _mm_loadu_si128((const __m128i*)(increments + c));
+		const __m128	level	= _mm_loadu_ps(levels + c);
+
+		for (uint32_t f = 0; f < frameCount; f++)
+		{
+			_mm_storeu_ps(output + (size_t)f * channels + c, _mm_mul_ps(level, ToneSineSSE41(phase)));
+			phase = _mm_add_epi32(phase, step);
+		}
+
+		_mm_storeu_si128((__m128i*)(phases + c), phase);
+	}
+
+	ToneScalar(phases, increments, levels, channels, output, c, frameCount);
+}
+
+TARGET_SSE41
+static void QuantizeAudioSSE41(const float* input, void* output, uint32_t count, uint32_t sampleDepth)
+{
+	// 8 samples per iteration, cvtps2dq rounds to nearest even as lrintf does
+	const __m128	scale	= _mm_set1_ps((sampleDepth == 32) ? kAudioScale32 : kAudioScale16);
+	const __m128	min		= _mm_set1_ps((sampleDepth == 32) ? -kAudioScale32 : -kAudioScale16);
+	const __m128	max		= _mm_set1_ps((sampleDepth == 32) ? kAudioMax32 : kAudioMax16);
+	uint32_t		i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		__m128i lo = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i), scale), min), max));
+		__m128i hi = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i + 4), scale), min), max));
+
+		if (sampleDepth == 32)
+		{
+			_mm_storeu_si128((__m128i*)((int32_t*)output + i), lo);
+			_mm_storeu_si128((__m128i*)((int32_t*)output + i + 4), hi);
+		}
+		else
+		{
+			_mm_storeu_si128((__m128i*)((int16_t*)output + i), _mm_packs_epi32(lo, hi));
+		}
+	}
+
+	QuantizeAudioScalar(input, output, i, count, sampleDepth);
+}
+
+const VideoKernelTable kSSE41VideoKernels =
+{
+	UnpackV210RowSSE41,
+	PackV210RowSSE41,
+	PlanarTo2vuyRowSSE41,
+	Unpack2vuyRowSSE41,
+	ConvertYUV422ToRGBRowSSE41,
+	ConvertRGBToYUV422RowSSE41,
+	UnpackR12RowSSE41,
+	PackR12RowSSE41,
+	UnpackR210RowSSE41,
+	CompositeRowSSE41,
+	FilterRowHorizontalSSE41,
+	FilterRowsVerticalSSE41,
+	DeinterlaceRowSSE41,
+	ApplyLUT1DRowScalar,
+	ApplyLUT3DRowScalar,
+	DecimateRowHorizontalSSE41,
+	InterpolateRowHorizontalSSE41,
+	FilterRowsHalfBandSSE41,
+	RenderSinusoidRowSSE41,
+	RenderToneFramesSSE41,
+	QuantizeAudioSSE41
+};
+
+#endif
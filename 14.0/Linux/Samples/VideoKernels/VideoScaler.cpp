@@ -0,0 +1,312 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#include <math.h>
+#include <algorithm>
+#include "VideoScaler.h"
+
+// Filtered samples are limited to the 10-bit YUV codes, filters with negative lobes overshoot at edges
+static const uint16_t	kMinCode			= 4;
+static const uint16_t	kMaxCode			= 1019;
+
+static const int32_t	kCoefficientScale	= 1 << kFilterCoefficientShift;
+
+// Planes are padded to whole v210 blocks of 48 pixels for the unpack and pack kernels
+static const uint32_t	kV210BlockPixels	= 48;
+
+static const double		kPi					= 3.14159265358979323846;
+
+static inline uint32_t PaddedSampleCount(uint32_t count)
+{
+	return ((count + kV210BlockPixels - 1) / kV210BlockPixels) * kV210BlockPixels;
+}
+
+static uint32_t FilterRadius(VideoScalerFilter filter)
+{
+	return (filter == kVideoScalerLanczos3) ? 3 : 2;
+}
+
+static double FilterKernel(VideoScalerFilter filter, double x)
+{
+	x = fabs(x);
+
+	if (filter == kVideoScalerLanczos3)
+	{
+		if (x < 1e-9)
+			return 1.0;
+		if (x >= 3.0)
+			return 0.0;
+
+		return 3.0 * sin(kPi * x) * sin(kPi * x / 3.0) / (kPi * kPi * x * x);
+	}
+
+	// Catmull-Rom, cubic convolution with a = -0.5
+	if (x < 1.0)
+		return (1.5 * x - 2.5) * x * x + 1.0;
+	if (x < 2.0)
+		return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+
+	return 0.0;
+}
+
+// Input samples under the filter, widened by filterScale when downscaling
+static uint32_t FilterTapCount(VideoScalerFilter filter, double filterScale, uint32_t srcCount)
+{
+	uint32_t tapCount = (uint32_t)ceil(FilterRadius(filter) * filterScale) * 2;
+
+	return std::max(std::min(std::min(tapCount, kMaxFilterTaps), srcCount), 1u);
+}
+
+// Compute the coefficients of output samples centred at input positions centers.  Taps beyond the edges
+// of the input repeat the edge sample, their weights are folded into the first or last tap.
+static void BuildFilter(VideoScalerFilter filter, uint32_t srcCount, const std::vector<double>& centers, double filterScale,
+						uint32_t tapCount, uint32_t tapAlignment, std::vector<uint32_t>& offsets, std::vector<int16_t>& coefficients)
+{
+	uint32_t tapStride = ((tapCount + tapAlignment - 1) / tapAlignment) * tapAlignment;
+
+	// The kernel support is limited by the tap count
+	filterScale = std::min(filterScale, (double)tapCount / (2 * FilterRadius(filter)));
+	filterScale = std::max(filterScale, 1.0);
+
+	offsets.resize(centers.size());
+	coefficients.assign(centers.size() * tapStride, 0);
+
+	for (size_t i = 0; i < centers.size(); i++)
+	{
+		double		weights[kMaxFilterTaps] = {};
+		double		totalWeight				= 0.0;
+		int32_t		firstTap				= (int32_t)floor(centers[i]) - (int32_t)tapCount / 2 + 1;
+		int32_t		start					= std::max(std::min(firstTap, (int32_t)(srcCount - tapCount)), 0);
+		int16_t*	tapCoefficients			= &coefficients[i * tapStride];
+		int32_t		coefficientSum			= 0;
+		uint32_t	largestTap				= 0;
+
+		for (uint32_t t = 0; t < tapCount; t++)
+		{
+			int32_t	srcIndex	= std::max(std::min(firstTap + (int32_t)t, (int32_t)srcCount - 1), 0);
+			double	weight		= FilterKernel(filter, (firstTap + (int32_t)t - centers[i]) / filterScale);
+
+			weights[srcIndex - start]	+= weight;
+			totalWeight					+= weight;
+		}
+
+		// Quantize the normalized weights, the rounding error is added to the largest so they sum to unity
+		for (uint32_t t = 0; t < tapCount; t++)
+		{
+			tapCoefficients[t]	= (int16_t)lround(weights[t] / totalWeight * kCoefficientScale);
+			coefficientSum		+= tapCoefficients[t];
+
+			if (tapCoefficients[t] > tapCoefficients[largestTap])
+				largestTap = t;
+		}
+
+		tapCoefficients[largestTap]	+= (int16_t)(kCoefficientScale - coefficientSum);
+		offsets[i]					= (uint32_t)start;
+	}
+}
+
+VideoScaler::VideoScaler(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight, VideoScalerFilter filter, bool interlaced, unsigned threadCount) :
+	m_srcWidth(srcWidth),
+	m_srcHeight(srcHeight),
+	m_dstWidth(dstWidth),
+	m_dstHeight(dstHeight),
+	m_srcChromaWidth((srcWidth + 1) / 2),
+	m_dstChromaWidth((dstWidth + 1) / 2),
+	m_workerPool(threadCount)
+{
+	double				scaleX = (double)srcWidth / dstWidth;
+	double				scaleY = (double)srcHeight / dstHeight;
+	std::vector<double>	centers;
+
+	// Luma sample centres are aligned, chroma samples are co-sited with even luma samples
+	centers.resize(dstWidth);
+	for (uint32_t x = 0; x < dstWidth; x++)
+		centers[x] = (x + 0.5) * scaleX - 0.5;
+
+	m_lumaFilter.tapCount	= FilterTapCount(filter, std::max(scaleX, 1.0), srcWidth);
+	m_lumaFilter.tapStride	= ((m_lumaFilter.tapCount + 7) / 8) * 8;
+	m_lumaFilter.offsetStep	= 1;
+	BuildFilter(filter, srcWidth, centers, std::max(scaleX, 1.0), m_lumaFilter.tapCount, 8, m_lumaFilter.offsets, m_lumaFilter.coefficients);
+
+	centers.resize(m_dstChromaWidth);
+	for (uint32_t x = 0; x < m_dstChromaWidth; x++)
+		centers[x] = ((x * 2 + 0.5) * scaleX - 0.5) / 2;
+
+	m_chromaFilter.tapCount		= FilterTapCount(filter, std::max(scaleX, 1.0), m_srcChromaWidth);
+	m_chromaFilter.tapStride	= ((m_chromaFilter.tapCount + 7) / 8) * 8;
+	m_chromaFilter.offsetStep	= 1;
+	BuildFilter(filter, m_srcChromaWidth, centers, std::max(scaleX, 1.0), m_chromaFilter.tapCount, 8, m_chromaFilter.offsets, m_chromaFilter.coefficients);
+
+	if (!interlaced || (srcHeight < 2) || (dstHeight < 2))
+	{
+		centers.resize(dstHeight);
+		for (uint32_t y = 0; y < dstHeight; y++)
+			centers[y] = (y + 0.5) * scaleY - 0.5;
+
+		m_verticalFilter.tapCount	= FilterTapCount(filter, std::max(scaleY, 1.0), srcHeight);
+		m_verticalFilter.offsetStep	= 1;
+		BuildFilter(filter, srcHeight, centers, std::max(scaleY, 1.0), m_verticalFilter.tapCount, 1, m_verticalFilter.offsets, m_verticalFilter.coefficients);
+	}
+	else
+	{
+		// Each field is filtered from the input field of the same parity, row y of the frame is row y / 2 of its field
+		m_verticalFilter.tapCount	= FilterTapCount(filter, std::max(scaleY, 1.0), srcHeight / 2);
+		m_verticalFilter.offsetStep	= 2;
+		m_verticalFilter.offsets.resize(dstHeight);
+		m_verticalFilter.coefficients.resize((size_t)dstHeight * m_verticalFilter.tapCount);
+
+		for (uint32_t field = 0; field < 2; field++)
+		{
+			std::vector<uint32_t>	fieldOffsets;
+			std::vector<int16_t>	fieldCoefficients;
+			uint32_t				srcFieldHeight = (srcHeight + 1 - field) / 2;
+			uint32_t				dstFieldHeight = (dstHeight + 1 - field) / 2;
+
+			centers.resize(dstFieldHeight);
+			for (uint32_t y = 0; y < dstFieldHeight; y++)
+				centers[y] = ((y * 2 + field + 0.5) * scaleY - 0.5 - field) / 2;
+
+			BuildFilter(filter, srcFieldHeight, centers, std::max(scaleY, 1.0), m_verticalFilter.tapCount, 1, fieldOffsets, fieldCoefficients);
+
+			for (uint32_t y = 0; y < dstFieldHeight; y++)
+			{
+				m_verticalFilter.offsets[y * 2 + field] = fieldOffsets[y] * 2 + field;
+				std::copy(fieldCoefficients.begin() + (size_t)y * m_verticalFilter.tapCount, fieldCoefficients.begin() + (size_t)(y + 1) * m_verticalFilter.tapCount,
+						  m_verticalFilter.coefficients.begin() + (size_t)(y * 2 + field) * m_verticalFilter.tapCount);
+			}
+		}
+	}
+
+	m_verticalFilter.tapStride = m_verticalFilter.tapCount;
+
+	// The rows of each field in the window of the vertical filter map to distinct rows of the ring
+	m_ringRowCount = m_verticalFilter.tapCount * m_verticalFilter.offsetStep;
+
+	m_threadRows.resize(m_workerPool.GetThreadCount());
+	for (ThreadRows& rows : m_threadRows)
+	{
+		rows.srcLuma.resize(PaddedSampleCount(srcWidth) + m_lumaFilter.tapStride);
+		rows.srcCb.resize(PaddedSampleCount(srcWidth) / 2 + m_chromaFilter.tapStride);
+		rows.srcCr.resize(PaddedSampleCount(srcWidth) / 2 + m_chromaFilter.tapStride);
+		rows.filteredRows.resize((size_t)m_ringRowCount * (dstWidth + m_dstChromaWidth * 2));
+		rows.filteredRowIndex.resize(m_ringRowCount);
+		rows.dstLuma.resize(PaddedSampleCount(dstWidth));
+		rows.dstCb.resize(PaddedSampleCount(dstWidth) / 2);
+		rows.dstCr.resize(PaddedSampleCount(dstWidth) / 2);
+	}
+}
+
+HRESULT VideoScaler::ScaleV210(const void* srcFrame, long srcRowBytes, void* dstFrame, long dstRowBytes)
+{
+	if ((srcFrame == NULL) || (dstFrame == NULL))
+		return E_POINTER;
+
+	if ((srcRowBytes < (long)V210RowBytes(m_srcWidth)) || (dstRowBytes < (long)V210RowBytes(m_dstWidth)))
+		return E_INVALIDARG;
+
+	// Each slice filters the rows in the window of its first output row again, so there are fewer slices
+	// per thread than for a conversion
+	uint32_t sliceCount		= std::min<uint32_t>(m_dstHeight, m_workerPool.GetThreadCount() * 2);
+	uint32_t rowsPerSlice	= (m_dstHeight + sliceCount - 1) / sliceCount;
+	sliceCount				= (m_dstHeight + rowsPerSlice - 1) / rowsPerSlice;
+
+	m_workerPool.Run(sliceCount, [&](uint32_t slice, unsigned threadIndex)
+	{
+		uint32_t firstRow = slice * rowsPerSlice;
+		ScaleRows(m_threadRows[threadIndex], (const uint8_t*)srcFrame, srcRowBytes, (uint8_t*)dstFrame, dstRowBytes,
+				  firstRow, std::min(rowsPerSlice, m_dstHeight - firstRow));
+	});
+
+	return S_OK;
+}
+
+const uint16_t* VideoScaler::FilterInputRow(ThreadRows& rows, const uint8_t* srcFrame, long srcRowBytes, uint32_t srcRow)
+{
+	uint32_t	ringRow		= srcRow % m_ringRowCount;
+	uint16_t*	filtered	= rows.filteredRows.data() + (size_t)ringRow * (m_dstWidth + m_dstChromaWidth * 2);
+
+	if (rows.filteredRowIndex[ringRow] != (int32_t)srcRow)
+	{
+		UnpackV210Row(srcFrame + (size_t)srcRow * srcRowBytes, rows.srcLuma.data(), rows.srcCb.data(), rows.srcCr.data(), m_srcWidth);
+
+		FilterRowHorizontal(rows.srcLuma.data(), m_lumaFilter.offsets.data(), m_lumaFilter.coefficients.data(), m_lumaFilter.tapStride,
+							filtered, m_dstWidth, kMinCode, kMaxCode);
+		FilterRowHorizontal(rows.srcCb.data(), m_chromaFilter.offsets.data(), m_chromaFilter.coefficients.data(), m_chromaFilter.tapStride,
+							filtered + m_dstWidth, m_dstChromaWidth, kMinCode, kMaxCode);
+		FilterRowHorizontal(rows.srcCr.data(), m_chromaFilter.offsets.data(), m_chromaFilter.coefficients.data(), m_chromaFilter.tapStride,
+							filtered + m_dstWidth + m_dstChromaWidth, m_dstChromaWidth, kMinCode, kMaxCode);
+
+		rows.filteredRowIndex[ringRow] = (int32_t)srcRow;
+	}
+
+	return filtered;
+}
+
+void VideoScaler::ScaleRows(ThreadRows& rows, const uint8_t* srcFrame, long srcRowBytes, uint8_t* dstFrame, long dstRowBytes,
+							uint32_t firstRow, uint32_t rowCount)
+{
+	const uint16_t*	lumaRows[kMaxFilterTaps];
+	const uint16_t*	cbRows[kMaxFilterTaps];
+	const uint16_t*	crRows[kMaxFilterTaps];
+
+	// Rows filtered for a previous frame are stale
+	std::fill(rows.filteredRowIndex.begin(), rows.filteredRowIndex.end(), -1);
+
+	for (uint32_t y = firstRow; y < firstRow + rowCount; y++)
+	{
+		const int16_t*	coefficients	= &m_verticalFilter.coefficients[(size_t)y * m_verticalFilter.tapStride];
+		uint32_t		srcRow			= m_verticalFilter.offsets[y];
+
+		for (uint32_t t = 0; t < m_verticalFilter.tapCount; t++, srcRow += m_verticalFilter.offsetStep)
+		{
+			const uint16_t* filtered = FilterInputRow(rows, srcFrame, srcRowBytes, srcRow);
+
+			lumaRows[t]	= filtered;
+			cbRows[t]	= filtered + m_dstWidth;
+			crRows[t]	= filtered + m_dstWidth + m_dstChromaWidth;
+		}
+
+		FilterRowsVertical(lumaRows, coefficients, m_verticalFilter.tapCount, rows.dstLuma.data(), m_dstWidth, kMinCode, kMaxCode);
+		FilterRowsVertical(cbRows, coefficients, m_verticalFilter.tapCount, rows.dstCb.data(), m_dstChromaWidth, kMinCode, kMaxCode);
+		FilterRowsVertical(crRows, coefficients, m_verticalFilter.tapCount, rows.dstCr.data(), m_dstChromaWidth, kMinCode, kMaxCode);
+
+		PackV210Row(rows.dstLuma.data(), rows.dstCb.data(), rows.dstCr.data(), dstFrame + (size_t)y * dstRowBytes, m_dstWidth);
+	}
+}
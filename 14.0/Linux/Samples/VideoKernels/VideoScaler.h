@@ -0,0 +1,127 @@
+/* -LICENSE-START-
+** Copyright (c) 2024 Blackmagic Design
+**  
+** Permission is hereby granted, free of charge, to any person or organization 
+** obtaining a copy of the software and accompanying documentation (the 
+** "Software") to use, reproduce, display, distribute, sub-license, execute, 
+** and transmit the Software, and to prepare derivative works of the Software, 
+** and to permit third-parties to whom the Software is furnished to do so, in 
+** accordance with:
+** 
+** (1) if the Software is obtained from Blackmagic Design, the End User License 
+** Agreement for the Software Development Kit (“EULA”) available at 
+** https://www.blackmagicdesign.com/EULA/DeckLinkSDK; or
+** 
+** (2) if the Software is obtained from any third party, such licensing terms 
+** as notified by that third party,
+** 
+** and all subject to the following:
+** 
+** (3) the copyright notices in the Software and this entire statement, 
+** including the above license grant, this restriction and the following 
+** disclaimer, must be included in all copies of the Software, in whole or in 
+** part, and all derivative works of the Software, unless such copies or 
+** derivative works are solely in the form of machine-executable object code 
+** generated by a source language processor.
+** 
+** (4) THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS 
+** OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+** FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+** SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+** FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+** ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+** DEALINGS IN THE SOFTWARE.
+** 
+** A copy of the Software is available free of charge at 
+** https://www.blackmagicdesign.com/desktopvideo_sdk under the EULA.
+** 
+** -LICENSE-END-
+*/
+
+#pragma once
+
+#include <vector>
+#include "DeckLinkAPI.h"
+#include "SliceWorkerPool.h"
+#include "VideoKernels.h"
+
+// VideoScaler scales v210 frames between display mode sizes, for up, down and cross conversion.
+//
+// Scaling is a separable polyphase filter applied natively to 4:2:2: luma and each chroma plane are
+// filtered horizontally to the output width, keeping chroma co-sited with even luma samples, then
+// vertically to the output height.  The filter coefficients of each output column and row are computed
+// once when the scaler is created.  When downscaling the filter is widened by the scale factor, so it
+// also limits the bandwidth of the output.
+//
+// Interlaced frames are scaled as two fields, each filtered from the rows of the same field with the
+// vertical offset between fields preserved.  Scaling between interlaced and progressive modes of the same
+// frame rate filters the frame, the fields are not deinterlaced.
+//
+// Each frame is split into slices of output rows which are scaled in parallel by a SliceWorkerPool.  A
+// thread keeps the rows it has filtered horizontally while they are in the vertical filter's window, so
+// each input row is filtered horizontally once per slice.
+
+enum VideoScalerFilter
+{
+	kVideoScalerBicubic = 0,		// Catmull-Rom cubic, 4 taps
+	kVideoScalerLanczos3			// Lanczos windowed sinc, 6 taps
+};
+
+class VideoScaler
+{
+public:
+	// threadCount includes the calling thread, 0 selects the number of CPUs
+	VideoScaler(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight, VideoScalerFilter filter, bool interlaced, unsigned threadCount = 0);
+
+	uint32_t	GetSrcWidth(void) const { return m_srcWidth; }
+	uint32_t	GetSrcHeight(void) const { return m_srcHeight; }
+	uint32_t	GetDstWidth(void) const { return m_dstWidth; }
+	uint32_t	GetDstHeight(void) const { return m_dstHeight; }
+	unsigned	GetThreadCount(void) const { return m_workerPool.GetThreadCount(); }
+
+	// Scale a v210 frame, calls from multiple threads are serialized
+	HRESULT		ScaleV210(const void* srcFrame, long srcRowBytes, void* dstFrame, long dstRowBytes);
+
+private:
+	// Coefficients of each output sample, applied to tapCount input samples from its offset
+	struct FilterTable
+	{
+		uint32_t				tapCount;
+		uint32_t				tapStride;			// tapCount padded to a multiple of 8 for the horizontal kernel
+		uint32_t				offsetStep;			// Input rows between taps, 2 for interlaced vertical filters
+		std::vector<uint32_t>	offsets;
+		std::vector<int16_t>	coefficients;		// tapStride coefficients for each output sample
+	};
+
+	// Working rows of one thread
+	struct ThreadRows
+	{
+		std::vector<uint16_t>	srcLuma;			// Unpacked input row, padded for the horizontal kernel
+		std::vector<uint16_t>	srcCb;
+		std::vector<uint16_t>	srcCr;
+		std::vector<uint16_t>	filteredRows;		// Horizontally filtered input rows, ring of window rows
+		std::vector<int32_t>	filteredRowIndex;	// Input row held by each row of the ring, -1 if none
+		std::vector<uint16_t>	dstLuma;
+		std::vector<uint16_t>	dstCb;
+		std::vector<uint16_t>	dstCr;
+	};
+
+	uint32_t					m_srcWidth;
+	uint32_t					m_srcHeight;
+	uint32_t					m_dstWidth;
+	uint32_t					m_dstHeight;
+	uint32_t					m_srcChromaWidth;
+	uint32_t					m_dstChromaWidth;
+
+	FilterTable					m_lumaFilter;
+	FilterTable					m_chromaFilter;
+	FilterTable					m_verticalFilter;
+	uint32_t					m_ringRowCount;
+
+	SliceWorkerPool				m_workerPool;
+	std::vector<ThreadRows>		m_threadRows;			// Indexed by pool thread
+
+	const uint16_t*				FilterInputRow(ThreadRows& rows, const uint8_t* srcFrame, long srcRowBytes, uint32_t srcRow);
+	void						ScaleRows(ThreadRows& rows, const uint8_t* srcFrame, long srcRowBytes, uint8_t* dstFrame, long dstRowBytes,
+										  uint32_t firstRow, uint32_t rowCount);
+};